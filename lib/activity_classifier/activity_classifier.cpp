@@ -0,0 +1,240 @@
+/**
+ * @file activity_classifier.cpp
+ * @brief Implementation of the fixed-point activity classifier.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "activity_classifier.h"
+
+#include <string.h>
+
+#if defined(ESP_PLATFORM) && __has_include(<dsps_dotprod.h>)
+#include <dsps_dotprod.h>
+#define ACTIVITY_USE_ESP_DSP
+#endif
+
+// ============================================================================
+// Filter
+// ============================================================================
+
+// Symmetric Hamming-windowed sinc low-pass, 12 Hz at 100 Hz, Q15 (gain ~1.0)
+alignas(16) static const int16_t FIR_COEFFS[ACTIVITY_FIR_TAPS] = {
+    -66, -189, -372, -229, 844, 3055, 5738, 7602,
+    7602, 5738, 3055, 844, -229, -372, -189, -66
+};
+
+/**
+ * @brief One FIR output: Q15 dot product of TAPS magnitudes and the coefficients.
+ */
+static inline int16_t firDot(const int16_t* x) {
+#ifdef ACTIVITY_USE_ESP_DSP
+    int16_t out = 0;
+    dsps_dotprod_s16(x, FIR_COEFFS, &out, ACTIVITY_FIR_TAPS, 0);
+    return out;
+#else
+    int32_t acc = 1 << 14;  // Round to nearest
+    for (size_t k = 0; k < ACTIVITY_FIR_TAPS; k++) {
+        acc += static_cast<int32_t>(x[k]) * FIR_COEFFS[k];
+    }
+    return static_cast<int16_t>(acc >> 15);
+#endif
+}
+
+uint32_t activityIsqrt(uint32_t value) {
+    uint32_t result = 0;
+    uint32_t bit = 1u << 30;
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
+
+static int16_t magnitude(const MotionSample& s) {
+    uint32_t sq = static_cast<uint32_t>(static_cast<int32_t>(s.x) * s.x) +
+                  static_cast<uint32_t>(static_cast<int32_t>(s.y) * s.y) +
+                  static_cast<uint32_t>(static_cast<int32_t>(s.z) * s.z);
+    uint32_t m = activityIsqrt(sq);
+    return static_cast<int16_t>(m > 0x7FFF ? 0x7FFF : m);
+}
+
+// ============================================================================
+// Constructor
+// ============================================================================
+
+ActivityClassifier::ActivityClassifier(ActivityState& state, const ActivityConfig& config)
+    : _state(state)
+    , _config(config)
+    , _historyCount(0)
+    , _windowCount(0) {
+    _last.activity = Activity::REST;
+    _last.crossings = 0;
+    _last.energy = 0;
+}
+
+// ============================================================================
+// Public Methods
+// ============================================================================
+
+void ActivityClassifier::beginStream() {
+    _historyCount = 0;
+    _windowCount = 0;
+}
+
+size_t ActivityClassifier::process(const MotionSample* samples, size_t count, uint32_t nowSec) {
+    if (samples == nullptr) {
+        return 0;
+    }
+
+    rollPeriod(nowSec);
+
+    const size_t historyLen = ACTIVITY_FIR_TAPS - 1;
+    size_t windows = 0;
+
+    while (count > 0) {
+        size_t n = count < ACTIVITY_BLOCK ? count : ACTIVITY_BLOCK;
+
+        for (size_t i = 0; i < n; i++) {
+            _buffer[historyLen + i] = magnitude(samples[i]);
+        }
+
+        // Outputs need TAPS valid inputs; until the history is full the
+        // first outputs of a stream are skipped
+        size_t validStart = historyLen - _historyCount;
+        size_t first = validStart + historyLen;
+        for (size_t j = first; j < historyLen + n; j++) {
+            _window[_windowCount++] = firDot(&_buffer[j - historyLen]);
+            if (_windowCount == ACTIVITY_WINDOW) {
+                finishWindow();
+                windows++;
+            }
+        }
+
+        // Keep the newest TAPS - 1 magnitudes as history for the next block
+        memmove(_buffer, &_buffer[n], historyLen * sizeof(int16_t));
+        _historyCount = _historyCount + n > historyLen ? historyLen : _historyCount + n;
+
+        samples += n;
+        count -= n;
+    }
+
+    return windows;
+}
+
+const ActivityWindow& ActivityClassifier::lastWindow() const {
+    return _last;
+}
+
+Activity ActivityClassifier::classify(const ActivityConfig& config, uint32_t energy, uint8_t crossings) {
+    if (energy < config.restEnergy) {
+        return Activity::REST;
+    }
+    if (crossings >= config.shakeCrossings && energy >= config.shakeEnergy) {
+        return Activity::SHAKE;
+    }
+    if (energy >= config.runEnergy || crossings >= config.runCrossings) {
+        return Activity::RUN;
+    }
+    return Activity::WALK;
+}
+
+// ============================================================================
+// Private Methods
+// ============================================================================
+
+void ActivityClassifier::rollPeriod(uint32_t nowSec) {
+    ActivitySummary& current = _state.current;
+
+    if (current.startSec != 0 && nowSec - current.startSec >= _config.periodSec) {
+        // Oldest completed period is dropped when the ring is full
+        size_t slot = (_state.historyHead + _state.historyCount) % ACTIVITY_HISTORY_PERIODS;
+        _state.history[slot] = current;
+        if (_state.historyCount < ACTIVITY_HISTORY_PERIODS) {
+            _state.historyCount++;
+        } else {
+            _state.historyHead = (_state.historyHead + 1) % ACTIVITY_HISTORY_PERIODS;
+        }
+        memset(&current, 0, sizeof(current));
+    }
+
+    if (current.startSec == 0) {
+        current.startSec = nowSec == 0 ? 1 : nowSec;
+    }
+}
+
+void ActivityClassifier::finishWindow() {
+    int32_t sum = 0;
+    int64_t sumSq = 0;
+    for (size_t i = 0; i < ACTIVITY_WINDOW; i++) {
+        sum += _window[i];
+        sumSq += static_cast<int32_t>(_window[i]) * _window[i];
+    }
+
+    // Variance without losing precision to an integer mean
+    int64_t n = ACTIVITY_WINDOW;
+    int64_t variance = (n * sumSq - static_cast<int64_t>(sum) * sum) / (n * n);
+    uint32_t energy = variance > 0xFFFFFFFF ? 0xFFFFFFFF : static_cast<uint32_t>(variance);
+
+    // Zero crossings around the mean with hysteresis
+    int32_t mean = sum / static_cast<int32_t>(ACTIVITY_WINDOW);
+    int32_t hyst = _config.hysteresisMg;
+    int8_t side = 0;
+    uint8_t crossings = 0;
+    for (size_t i = 0; i < ACTIVITY_WINDOW; i++) {
+        int32_t d = _window[i] - mean;
+        if (d > hyst) {
+            if (side < 0) {
+                crossings++;
+            }
+            side = 1;
+        } else if (d < -hyst) {
+            if (side > 0) {
+                crossings++;
+            }
+            side = -1;
+        }
+    }
+
+    _last.energy = energy;
+    _last.crossings = crossings;
+    _last.activity = classify(_config, energy, crossings);
+
+    ActivitySummary& current = _state.current;
+    uint8_t index = static_cast<uint8_t>(_last.activity);
+    if (current.windows[index] < 0xFFFF) {
+        current.windows[index]++;
+    }
+    if (_last.activity == Activity::WALK || _last.activity == Activity::RUN) {
+        uint32_t strides = current.strides + (crossings + 1) / 2;
+        current.strides = strides > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(strides);
+    }
+
+    _windowCount = 0;
+}
+
+// ============================================================================
+// Summary Functions
+// ============================================================================
+
+size_t activityTakeSummaries(ActivityState& state, ActivitySummary* out, size_t max) {
+    if (out == nullptr) {
+        return 0;
+    }
+
+    size_t taken = 0;
+    while (taken < max && state.historyCount > 0) {
+        out[taken++] = state.history[state.historyHead];
+        state.historyHead = (state.historyHead + 1) % ACTIVITY_HISTORY_PERIODS;
+        state.historyCount--;
+    }
+    return taken;
+}
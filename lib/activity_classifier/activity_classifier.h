@@ -0,0 +1,186 @@
+/**
+ * @file activity_classifier.h
+ * @brief Streaming fixed-point activity classifier (rest / walk / run / shake).
+ *
+ * Accelerometer samples from the IMU FIFO are processed in blocks:
+ *
+ * 1. Magnitude of each sample (integer square root, mg), so the result
+ *    does not depend on how the collar sits on the neck.
+ * 2. 16-tap Q15 low-pass FIR (~12 Hz at 100 Hz) against sensor jitter.
+ * 3. Per 64-sample window: variance of the filtered magnitude (motion
+ *    energy, mg^2) and zero crossings around the window mean with
+ *    hysteresis (step cadence).
+ * 4. Threshold rules map energy and cadence to an activity.
+ *
+ * Window results are accumulated into per-period summaries kept in RTC
+ * memory until they are uplinked.
+ *
+ * The FIR dot product uses esp-dsp on ESP32 targets, which selects the
+ * fastest kernel for the chip. Other builds use a portable C loop.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef ACTIVITY_CLASSIFIER_H
+#define ACTIVITY_CLASSIFIER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../motion_gate/motion_gate.h"
+
+// ============================================
+// CONSTANTS
+// ============================================
+
+// Designed for the IMU output rate used by the collar
+constexpr uint16_t ACTIVITY_SAMPLE_RATE_HZ = 100;
+
+constexpr size_t ACTIVITY_FIR_TAPS = 16;      // Multiple of 8 for SIMD kernels
+constexpr size_t ACTIVITY_WINDOW = 64;        // Samples per classification (0.64 s)
+constexpr size_t ACTIVITY_BLOCK = 32;         // Samples filtered per kernel pass
+constexpr size_t ACTIVITY_HISTORY_PERIODS = 8;
+
+// ============================================
+// TYPES
+// ============================================
+
+/**
+ * @brief Activity classes.
+ */
+enum class Activity : uint8_t {
+    REST = 0,
+    WALK,
+    RUN,
+    SHAKE
+};
+
+constexpr size_t ACTIVITY_CLASSES = 4;
+
+/**
+ * @brief Classification thresholds.
+ */
+struct ActivityConfig {
+    uint32_t restEnergy;       ///< Variance (mg^2) below which the dog is at rest
+    uint32_t runEnergy;        ///< Variance at or above which the dog is running
+    uint32_t shakeEnergy;      ///< Minimum variance for a shake
+    uint8_t runCrossings;      ///< Crossings per window at or above which moving counts as running
+    uint8_t shakeCrossings;    ///< Crossings per window at or above which high energy is a shake
+    uint16_t hysteresisMg;     ///< Crossing hysteresis around the window mean
+    uint32_t periodSec;        ///< Length of one summary period
+};
+
+// Defaults for a collar-mounted IMU at 100 Hz
+constexpr ActivityConfig DEFAULT_ACTIVITY_CONFIG = {
+    4000,     // restEnergy (~63 mg RMS)
+    100000,   // runEnergy (~316 mg RMS)
+    10000,    // shakeEnergy
+    6,        // runCrossings (~4.7 Hz cadence)
+    9,        // shakeCrossings (~7 Hz)
+    40,       // hysteresisMg
+    900       // periodSec (15 minutes)
+};
+
+/**
+ * @brief Activity totals for one period.
+ */
+struct ActivitySummary {
+    uint32_t startSec;                    ///< Start of the period (0 = unused)
+    uint16_t windows[ACTIVITY_CLASSES];   ///< Classified windows per activity
+    uint16_t strides;                     ///< Estimated gait cycles while walking or running
+    uint16_t reserved;
+};
+
+/**
+ * @brief Persistent summaries (POD, intended for RTC memory).
+ *
+ * Zero-initialized state is valid.
+ */
+struct ActivityState {
+    ActivitySummary current;                              ///< Period in progress
+    ActivitySummary history[ACTIVITY_HISTORY_PERIODS];    ///< Completed periods (ring)
+    uint8_t historyHead;                                  ///< Index of the oldest completed period
+    uint8_t historyCount;                                 ///< Completed periods not yet taken
+};
+
+/**
+ * @brief Features and result of one window.
+ */
+struct ActivityWindow {
+    Activity activity;
+    uint8_t crossings;
+    uint32_t energy;
+};
+
+// ============================================
+// CLASSIFIER CLASS
+// ============================================
+
+/**
+ * @brief Streaming classifier. Filter and window state live in RAM and
+ *        restart with each contiguous stream (normally once per wake).
+ */
+class ActivityClassifier {
+public:
+    /**
+     * @param state  Persistent summaries, normally a RTC_DATA_ATTR variable.
+     * @param config Classification thresholds.
+     */
+    ActivityClassifier(ActivityState& state, const ActivityConfig& config = DEFAULT_ACTIVITY_CONFIG);
+
+    /**
+     * @brief Start a new contiguous stream (drops filter and window state).
+     */
+    void beginStream();
+
+    /**
+     * @brief Process consecutive samples.
+     *
+     * @param samples Samples at ACTIVITY_SAMPLE_RATE_HZ, oldest first.
+     * @param count   Number of samples.
+     * @param nowSec  Wake clock, used to roll summary periods.
+     * @return Number of windows classified.
+     */
+    size_t process(const MotionSample* samples, size_t count, uint32_t nowSec);
+
+    /**
+     * @brief Result of the most recent window (REST before the first one).
+     */
+    const ActivityWindow& lastWindow() const;
+
+    /**
+     * @brief Classify precomputed window features (exposed for testing).
+     */
+    static Activity classify(const ActivityConfig& config, uint32_t energy, uint8_t crossings);
+
+private:
+    ActivityState& _state;
+    ActivityConfig _config;
+    ActivityWindow _last;
+
+    // Magnitudes: FIR history followed by the current block
+    alignas(16) int16_t _buffer[ACTIVITY_FIR_TAPS - 1 + ACTIVITY_BLOCK];
+    size_t _historyCount;
+
+    int16_t _window[ACTIVITY_WINDOW];
+    size_t _windowCount;
+
+    void rollPeriod(uint32_t nowSec);
+    void finishWindow();
+};
+
+// ============================================
+// SUMMARY FUNCTIONS
+// ============================================
+
+/**
+ * @brief Remove completed periods for uplink, oldest first.
+ * @return Number of summaries written to out.
+ */
+size_t activityTakeSummaries(ActivityState& state, ActivitySummary* out, size_t max);
+
+/**
+ * @brief Integer square root (floor).
+ */
+uint32_t activityIsqrt(uint32_t value);
+
+#endif // ACTIVITY_CLASSIFIER_H
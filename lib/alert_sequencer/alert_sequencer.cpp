@@ -0,0 +1,148 @@
+/**
+ * @file alert_sequencer.cpp
+ * @brief Implementation of the alert pattern sequencer and pattern tables.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "alert_sequencer.h"
+
+// ============================================================================
+// Pattern Tables
+// ============================================================================
+
+// Piezo beepers are loudest near resonance (~2.7 kHz for common 12 mm parts)
+static const uint16_t TONE_LOW_HZ = 2700;
+static const uint16_t TONE_HIGH_HZ = 3400;
+
+// Level 1: three quiet beeps
+static const AlertStep EXIT_1_STEPS[] = {
+    {TONE_LOW_HZ, 30, 0, 200},
+    {0, 0, 0, 200},
+};
+
+// Level 2: louder, faster, alternating pitch, with vibration
+static const AlertStep EXIT_2_STEPS[] = {
+    {TONE_LOW_HZ, 60, 50, 150},
+    {0, 0, 0, 100},
+    {TONE_HIGH_HZ, 60, 50, 150},
+    {0, 0, 0, 100},
+};
+
+// Level 3: full-volume warble with full vibration
+static const AlertStep EXIT_3_STEPS[] = {
+    {TONE_LOW_HZ, 100, 100, 100},
+    {TONE_HIGH_HZ, 100, 100, 100},
+    {TONE_LOW_HZ, 100, 100, 100},
+    {TONE_HIGH_HZ, 100, 100, 100},
+    {0, 0, 0, 100},
+};
+
+// Back inside: short rising chirp
+static const AlertStep RETURN_STEPS[] = {
+    {2000, 30, 0, 80},
+    {0, 0, 0, 40},
+    {3000, 30, 0, 120},
+};
+
+#define ALERT_STEPS(table) table, static_cast<uint8_t>(sizeof(table) / sizeof(table[0]))
+
+const AlertPattern ALERT_PATTERN_EXIT_1 = {ALERT_STEPS(EXIT_1_STEPS), 3};
+const AlertPattern ALERT_PATTERN_EXIT_2 = {ALERT_STEPS(EXIT_2_STEPS), 4};
+const AlertPattern ALERT_PATTERN_EXIT_3 = {ALERT_STEPS(EXIT_3_STEPS), 6};
+const AlertPattern ALERT_PATTERN_RETURN = {ALERT_STEPS(RETURN_STEPS), 1};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+const AlertPattern* alertPatternFor(FenceAlertEvent event, uint8_t escalationLevel) {
+    switch (event) {
+        case FenceAlertEvent::EXITED:
+        case FenceAlertEvent::ESCALATED:
+            if (escalationLevel >= 3) {
+                return &ALERT_PATTERN_EXIT_3;
+            }
+            return escalationLevel == 2 ? &ALERT_PATTERN_EXIT_2 : &ALERT_PATTERN_EXIT_1;
+        case FenceAlertEvent::RETURNED:
+            return &ALERT_PATTERN_RETURN;
+        case FenceAlertEvent::NONE:
+            break;
+    }
+    return nullptr;
+}
+
+void alertSequencerStart(AlertSequencerState& state, const AlertPattern* pattern, uint32_t nowMs) {
+    if (pattern == nullptr || pattern->steps == nullptr ||
+        pattern->stepCount == 0 || pattern->repeatCount == 0) {
+        alertSequencerStop(state);
+        return;
+    }
+    state.pattern = pattern;
+    state.stepStartMs = nowMs;
+    state.step = 0;
+    state.repetition = 0;
+    state.changed = 1;
+}
+
+void alertSequencerStop(AlertSequencerState& state) {
+    state.pattern = nullptr;
+    state.step = 0;
+    state.repetition = 0;
+    state.changed = 1;
+}
+
+bool alertSequencerUpdate(AlertSequencerState& state, uint32_t nowMs, AlertOutput& output) {
+    output.toneHz = 0;
+    output.volumePercent = 0;
+    output.vibrationPercent = 0;
+
+    // Skip every step that has fully elapsed
+    while (state.pattern != nullptr) {
+        uint16_t duration = state.pattern->steps[state.step].durationMs;
+        if (nowMs - state.stepStartMs < duration) {
+            break;
+        }
+        state.stepStartMs += duration;
+        state.changed = 1;
+        if (++state.step >= state.pattern->stepCount) {
+            state.step = 0;
+            if (++state.repetition >= state.pattern->repeatCount) {
+                state.pattern = nullptr;
+                state.repetition = 0;
+            }
+        }
+    }
+
+    if (state.pattern != nullptr) {
+        const AlertStep& step = state.pattern->steps[state.step];
+        output.toneHz = step.toneHz;
+        output.volumePercent = step.toneHz != 0 ? step.volumePercent : 0;
+        output.vibrationPercent = step.vibrationPercent;
+    }
+
+    bool changed = state.changed != 0;
+    state.changed = 0;
+    return changed;
+}
+
+uint32_t alertSequencerNextChangeMs(const AlertSequencerState& state, uint32_t nowMs) {
+    if (state.pattern == nullptr) {
+        return ALERT_IDLE;
+    }
+    uint32_t elapsed = nowMs - state.stepStartMs;
+    uint16_t duration = state.pattern->steps[state.step].durationMs;
+    return elapsed < duration ? duration - elapsed : 0;
+}
+
+bool alertSequencerActive(const AlertSequencerState& state) {
+    return state.pattern != nullptr;
+}
+
+uint32_t alertPatternDurationMs(const AlertPattern& pattern) {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < pattern.stepCount; i++) {
+        total += pattern.steps[i].durationMs;
+    }
+    return total * pattern.repeatCount;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file alert_sequencer.h
+ * @brief Beeper and vibration alert patterns, stepped by time instead of
+ *        delay().
+ *
+ * A pattern is a table of steps (tone, volume, vibration, duration). The
+ * sequencer only decides what the outputs should be at a given time and
+ * when they next change; the firmware programs LEDC PWM with each step
+ * and light-sleeps until the next change, while the LEDC hardware keeps
+ * driving the beeper. A tone()/delay() loop would instead keep the CPU
+ * awake for the whole alert.
+ *
+ * Patterns escalate with the fence alert level: louder, faster and longer,
+ * with vibration added at higher levels.
+ *
+ * The sequencer is pure and tested natively.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef ALERT_SEQUENCER_H
+#define ALERT_SEQUENCER_H
+
+#include <stdint.h>
+#include "../fence_alert/fence_alert.h"
+
+// ============================================
+// CONSTANTS
+// ============================================
+
+// Returned by alertSequencerNextChangeMs() when no pattern is playing
+constexpr uint32_t ALERT_IDLE = 0xFFFFFFFF;
+
+// ============================================
+// TYPES
+// ============================================
+
+/**
+ * @brief One step of a pattern. A step with toneHz 0 is silent.
+ */
+struct AlertStep {
+    uint16_t toneHz;             ///< Beeper frequency, 0 for silence
+    uint8_t volumePercent;       ///< Beeper drive, 0..100
+    uint8_t vibrationPercent;    ///< Vibration motor drive, 0..100
+    uint16_t durationMs;
+};
+
+/**
+ * @brief A step table, played repeatCount times.
+ */
+struct AlertPattern {
+    const AlertStep* steps;
+    uint8_t stepCount;
+    uint8_t repeatCount;
+};
+
+/**
+ * @brief Output levels to apply.
+ */
+struct AlertOutput {
+    uint16_t toneHz;
+    uint8_t volumePercent;
+    uint8_t vibrationPercent;
+};
+
+/**
+ * @brief Playback position. Zero-initialized state is idle.
+ */
+struct AlertSequencerState {
+    const AlertPattern* pattern;    ///< nullptr while idle
+    uint32_t stepStartMs;
+    uint8_t step;
+    uint8_t repetition;
+    uint8_t changed;                ///< Outputs not yet reported by an update
+};
+
+// Built-in patterns: exit levels 1..3 and the return chirp
+extern const AlertPattern ALERT_PATTERN_EXIT_1;
+extern const AlertPattern ALERT_PATTERN_EXIT_2;
+extern const AlertPattern ALERT_PATTERN_EXIT_3;
+extern const AlertPattern ALERT_PATTERN_RETURN;
+
+// ============================================
+// FUNCTIONS
+// ============================================
+
+/**
+ * @brief Pattern for a fence alert event.
+ *
+ * EXITED and ESCALATED use the exit pattern of the escalation level
+ * (levels above 3 use level 3); RETURNED uses the return chirp.
+ *
+ * @return The pattern, or nullptr for FenceAlertEvent::NONE.
+ */
+const AlertPattern* alertPatternFor(FenceAlertEvent event, uint8_t escalationLevel);
+
+/**
+ * @brief Start playing a pattern, replacing any pattern in progress.
+ */
+void alertSequencerStart(AlertSequencerState& state, const AlertPattern* pattern, uint32_t nowMs);
+
+/**
+ * @brief Stop playback (outputs off).
+ */
+void alertSequencerStop(AlertSequencerState& state);
+
+/**
+ * @brief Advance to the step current at nowMs.
+ *
+ * Steps that were missed entirely (late call) are skipped.
+ *
+ * @param output Set to the outputs for nowMs (off once the pattern ends).
+ * @return true if the outputs changed since the previous call (or since
+ *         a start or stop).
+ */
+bool alertSequencerUpdate(AlertSequencerState& state, uint32_t nowMs, AlertOutput& output);
+
+/**
+ * @brief Milliseconds from nowMs until the outputs next change.
+ * @return 0 if a change is due, ALERT_IDLE if nothing is playing.
+ */
+uint32_t alertSequencerNextChangeMs(const AlertSequencerState& state, uint32_t nowMs);
+
+/**
+ * @brief Check whether a pattern is playing.
+ */
+bool alertSequencerActive(const AlertSequencerState& state);
+
+/**
+ * @brief Total length of a pattern, all repetitions.
+ */
+uint32_t alertPatternDurationMs(const AlertPattern& pattern);
+
+#endif // ALERT_SEQUENCER_H
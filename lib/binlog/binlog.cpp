@@ -0,0 +1,289 @@
+/**
+ * @file binlog.cpp
+ * @brief Implementation of the binary log ring and its host-side decoder.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "binlog.h"
+
+#include <stdio.h>
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+// head/tail are shared between producer and consumer (possibly on
+// different cores); publish them with release/acquire ordering
+static inline uint32_t loadAcquire(const uint32_t& value) {
+    return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+}
+
+static inline void storeRelease(uint32_t& value, uint32_t newValue) {
+    __atomic_store_n(&value, newValue, __ATOMIC_RELEASE);
+}
+
+static void writeBytes(BinLogState& state, uint32_t pos, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        state.data[(pos + i) & (BINLOG_CAPACITY - 1)] = data[i];
+    }
+}
+
+static void putLE32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+    out[2] = static_cast<uint8_t>(value >> 16);
+    out[3] = static_cast<uint8_t>(value >> 24);
+}
+
+static uint32_t getLE32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) |
+           (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) |
+           (static_cast<uint32_t>(in[3]) << 24);
+}
+
+static bool appendRecord(BinLogState& state, uint32_t head, uint8_t id, uint32_t timeMs,
+                         const uint32_t* args, uint8_t argc) {
+    size_t size = BINLOG_HEADER_SIZE + 4 * argc;
+    if (BINLOG_CAPACITY - (head - loadAcquire(state.tail)) < size) {
+        return false;
+    }
+
+    uint8_t record[BINLOG_MAX_RECORD_SIZE];
+    record[0] = BINLOG_SYNC;
+    record[1] = id;
+    record[2] = argc;
+    putLE32(&record[3], timeMs);
+    for (uint8_t i = 0; i < argc; i++) {
+        putLE32(&record[BINLOG_HEADER_SIZE + 4 * i], args[i]);
+    }
+
+    writeBytes(state, head, record, size);
+    storeRelease(state.head, head + static_cast<uint32_t>(size));
+    return true;
+}
+
+// ============================================================================
+// Ring Functions
+// ============================================================================
+
+void binlogInit(BinLogState& state) {
+    if (state.magic != BINLOG_MAGIC || state.head - state.tail > BINLOG_CAPACITY) {
+        state.head = 0;
+        state.tail = 0;
+        state.dropped = 0;
+        state.magic = BINLOG_MAGIC;
+    }
+}
+
+bool binlogWrite(BinLogState& state, uint8_t id, uint32_t timeMs,
+                 const uint32_t* args, uint8_t argc) {
+    if (argc > BINLOG_MAX_ARGS || (argc > 0 && args == nullptr)) {
+        return false;
+    }
+
+    // Report earlier drops first, so the gap shows up in order
+    if (state.dropped > 0) {
+        if (!appendRecord(state, state.head, BINLOG_DROPPED_ID, timeMs, &state.dropped, 1)) {
+            state.dropped++;
+            return false;
+        }
+        state.dropped = 0;
+    }
+
+    if (!appendRecord(state, state.head, id, timeMs, args, argc)) {
+        state.dropped++;
+        return false;
+    }
+    return true;
+}
+
+size_t binlogPending(const BinLogState& state) {
+    return loadAcquire(state.head) - state.tail;
+}
+
+size_t binlogPeek(const BinLogState& state, const uint8_t** data) {
+    uint32_t pending = loadAcquire(state.head) - state.tail;
+    uint32_t offset = state.tail & (BINLOG_CAPACITY - 1);
+    uint32_t contiguous = BINLOG_CAPACITY - offset;
+
+    if (data != nullptr) {
+        *data = &state.data[offset];
+    }
+    return pending < contiguous ? pending : contiguous;
+}
+
+void binlogConsume(BinLogState& state, size_t count) {
+    uint32_t pending = loadAcquire(state.head) - state.tail;
+    if (count > pending) {
+        count = pending;
+    }
+    storeRelease(state.tail, state.tail + static_cast<uint32_t>(count));
+}
+
+// ============================================================================
+// Default Log
+// ============================================================================
+
+static BinLogState* defaultState = nullptr;
+static uint32_t (*defaultClock)() = nullptr;
+
+void binlogAttach(BinLogState* state, uint32_t (*clockMs)()) {
+    defaultState = state;
+    defaultClock = clockMs;
+}
+
+bool binlogPost(uint8_t id, const uint32_t* args, uint8_t argc) {
+    if (defaultState == nullptr) {
+        return false;
+    }
+    uint32_t now = defaultClock != nullptr ? defaultClock() : 0;
+    return binlogWrite(*defaultState, id, now, args, argc);
+}
+
+// ============================================================================
+// Decoder
+// ============================================================================
+
+size_t binlogParse(const uint8_t* data, size_t len, BinLogRecord& record, bool& found) {
+    found = false;
+    if (data == nullptr) {
+        return 0;
+    }
+
+    size_t pos = 0;
+    while (pos < len) {
+        if (data[pos] != BINLOG_SYNC) {
+            pos++;
+            continue;
+        }
+        if (len - pos < 3) {
+            return pos;
+        }
+
+        uint8_t argc = data[pos + 2];
+        if (argc > BINLOG_MAX_ARGS) {
+            pos++;
+            continue;
+        }
+
+        size_t size = BINLOG_HEADER_SIZE + 4 * argc;
+        if (len - pos < size) {
+            return pos;
+        }
+
+        const uint8_t* p = &data[pos];
+        record.id = p[1];
+        record.argc = argc;
+        record.timeMs = getLE32(&p[3]);
+        for (uint8_t i = 0; i < argc; i++) {
+            record.args[i] = getLE32(&p[BINLOG_HEADER_SIZE + 4 * i]);
+        }
+        found = true;
+        return pos + size;
+    }
+    return pos;
+}
+
+static void appendText(char* out, size_t outSize, size_t& used, const char* text, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (used + 1 < outSize) {
+            out[used] = text[i];
+        }
+        used++;
+    }
+}
+
+static void appendArg(char* out, size_t outSize, size_t& used, const char* spec, size_t specLen,
+                      char conversion, uint32_t arg) {
+    char format[16];
+    char text[48];
+    if (specLen >= sizeof(format)) {
+        appendText(out, outSize, used, spec, specLen);
+        return;
+    }
+    memcpy(format, spec, specLen);
+    format[specLen] = '\0';
+
+    int n;
+    switch (conversion) {
+        case 'd':
+        case 'i':
+        case 'c':
+            n = snprintf(text, sizeof(text), format, static_cast<int>(static_cast<int32_t>(arg)));
+            break;
+        case 'f':
+        case 'e':
+        case 'g': {
+            float value;
+            memcpy(&value, &arg, sizeof(value));
+            n = snprintf(text, sizeof(text), format, static_cast<double>(value));
+            break;
+        }
+        case 'u':
+        case 'x':
+        case 'X':
+            n = snprintf(text, sizeof(text), format, static_cast<unsigned int>(arg));
+            break;
+        default:
+            // Unsupported conversion (e.g. %s): keep the text as written
+            appendText(out, outSize, used, spec, specLen);
+            return;
+    }
+    if (n > 0) {
+        size_t textLen = static_cast<size_t>(n) < sizeof(text) ? static_cast<size_t>(n) : sizeof(text) - 1;
+        appendText(out, outSize, used, text, textLen);
+    }
+}
+
+size_t binlogFormat(const BinLogRecord& record, const char* const* formats, size_t formatCount,
+                    char* out, size_t outSize) {
+    if (out == nullptr || outSize == 0) {
+        return 0;
+    }
+
+    size_t used = 0;
+    const char* format = (formats != nullptr && record.id < formatCount) ? formats[record.id] : nullptr;
+
+    if (format == nullptr) {
+        char text[24];
+        int n = snprintf(text, sizeof(text), "<unknown id %u>", static_cast<unsigned int>(record.id));
+        appendText(out, outSize, used, text, static_cast<size_t>(n));
+        for (uint8_t i = 0; i < record.argc; i++) {
+            appendArg(out, outSize, used, " 0x%08x", 7, 'x', record.args[i]);
+        }
+    } else {
+        uint8_t argIndex = 0;
+        const char* p = format;
+        while (*p != '\0') {
+            if (*p != '%') {
+                appendText(out, outSize, used, p, 1);
+                p++;
+                continue;
+            }
+            if (p[1] == '%') {
+                appendText(out, outSize, used, "%", 1);
+                p += 2;
+                continue;
+            }
+
+            // Flags, width and precision up to the conversion character
+            const char* spec = p++;
+            while (*p != '\0' && strchr("-+ #0123456789.", *p) != nullptr) {
+                p++;
+            }
+            if (*p == '\0') {
+                appendText(out, outSize, used, spec, static_cast<size_t>(p - spec));
+                break;
+            }
+            char conversion = *p++;
+            uint32_t arg = argIndex < record.argc ? record.args[argIndex] : 0;
+            argIndex++;
+            appendArg(out, outSize, used, spec, static_cast<size_t>(p - spec), conversion, arg);
+        }
+    }
+
+    out[used < outSize ? used : outSize - 1] = '\0';
+    return used < outSize ? used : outSize - 1;
+}
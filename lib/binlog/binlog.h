@@ -0,0 +1,207 @@
+/**
+ * @file binlog.h
+ * @brief Deferred binary logging into an RTC-memory ring buffer.
+ *
+ * A log call stores a compact record (message ID, timestamp and up to
+ * four 32-bit arguments) instead of formatting text, so logging costs
+ * about a microsecond and never waits on the serial port. Format strings
+ * stay out of the firmware: they live in the message catalogue
+ * (log_messages.h) and are only applied by the host-side decoder.
+ *
+ * The ring is a single-producer, single-consumer queue. The firmware
+ * writes; a drain (normally a background task, only while USB is
+ * attached) reads raw bytes and sends them to the host. The state is POD
+ * and meant for RTC memory, so records survive deep sleep until drained.
+ * When the ring is full new records are dropped and counted; the count
+ * is logged as a LOG_DROPPED record once there is room again.
+ *
+ * Record layout (little-endian):
+ *   [0]    BINLOG_SYNC
+ *   [1]    message ID
+ *   [2]    argument count (0..BINLOG_MAX_ARGS)
+ *   [3..6] timestamp (ms)
+ *   [7..]  arguments, 4 bytes each (floats as IEEE-754 bits)
+ *
+ * The decoder half (binlogParse, binlogFormat) is portable and unused by
+ * the firmware; the linker drops it there.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ============================================
+// CONSTANTS
+// ============================================
+
+constexpr size_t BINLOG_CAPACITY = 1024;     // Ring size in bytes (power of two)
+constexpr size_t BINLOG_MAX_ARGS = 4;
+constexpr size_t BINLOG_HEADER_SIZE = 7;
+constexpr size_t BINLOG_MAX_RECORD_SIZE = BINLOG_HEADER_SIZE + 4 * BINLOG_MAX_ARGS;
+
+constexpr uint8_t BINLOG_SYNC = 0xB1;
+constexpr uint32_t BINLOG_MAGIC = 0x424C4F47;  // "BLOG"
+
+// Message ID reserved for the dropped-records counter
+constexpr uint8_t BINLOG_DROPPED_ID = 0;
+
+static_assert((BINLOG_CAPACITY & (BINLOG_CAPACITY - 1)) == 0,
+              "BINLOG_CAPACITY must be a power of two");
+
+// ============================================
+// TYPES
+// ============================================
+
+/**
+ * @brief Ring buffer state (POD, intended for RTC memory).
+ *
+ * head and tail are free-running byte counters; only the producer
+ * writes head and dropped, only the consumer writes tail.
+ */
+struct BinLogState {
+    uint32_t magic;
+    uint32_t head;       ///< Bytes ever written
+    uint32_t tail;       ///< Bytes ever consumed
+    uint32_t dropped;    ///< Records dropped since the last LOG_DROPPED
+    uint8_t data[BINLOG_CAPACITY];
+};
+
+/**
+ * @brief A decoded record.
+ */
+struct BinLogRecord {
+    uint8_t id;
+    uint8_t argc;
+    uint32_t timeMs;
+    uint32_t args[BINLOG_MAX_ARGS];
+};
+
+// ============================================
+// RING FUNCTIONS
+// ============================================
+
+/**
+ * @brief Initialize the ring, keeping records from before deep sleep.
+ *
+ * The ring is reset when the magic does not match (power-on, where RTC
+ * memory is undefined or zero) or the counters are inconsistent.
+ */
+void binlogInit(BinLogState& state);
+
+/**
+ * @brief Append one record.
+ *
+ * @param timeMs Timestamp in milliseconds.
+ * @param args   argc raw 32-bit arguments.
+ * @return false if the record was dropped (ring full or too many args).
+ */
+bool binlogWrite(BinLogState& state, uint8_t id, uint32_t timeMs,
+                 const uint32_t* args, uint8_t argc);
+
+/**
+ * @brief Bytes written but not yet consumed.
+ */
+size_t binlogPending(const BinLogState& state);
+
+/**
+ * @brief Contiguous run of unconsumed bytes (may be shorter than
+ *        binlogPending() when the data wraps).
+ *
+ * @param data Set to the first unconsumed byte.
+ * @return Number of bytes readable at data.
+ */
+size_t binlogPeek(const BinLogState& state, const uint8_t** data);
+
+/**
+ * @brief Mark bytes returned by binlogPeek() as consumed.
+ */
+void binlogConsume(BinLogState& state, size_t count);
+
+// ============================================
+// ARGUMENT ENCODING
+// ============================================
+
+inline uint32_t binlogArg(int value) { return static_cast<uint32_t>(value); }
+inline uint32_t binlogArg(unsigned int value) { return value; }
+inline uint32_t binlogArg(long value) { return static_cast<uint32_t>(value); }
+inline uint32_t binlogArg(unsigned long value) { return static_cast<uint32_t>(value); }
+inline uint32_t binlogArg(bool value) { return value ? 1 : 0; }
+
+inline uint32_t binlogArg(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline uint32_t binlogArg(double value) {
+    return binlogArg(static_cast<float>(value));
+}
+
+// ============================================
+// DEFAULT LOG
+// ============================================
+
+/**
+ * @brief Route binlog() calls to a ring with the given clock.
+ *
+ * @param state   Ring to write (normally a RTC_DATA_ATTR variable), or
+ *                nullptr to discard records.
+ * @param clockMs Timestamp source.
+ */
+void binlogAttach(BinLogState* state, uint32_t (*clockMs)());
+
+/**
+ * @brief Append a record to the attached ring.
+ * @return false if no ring is attached or the record was dropped.
+ */
+bool binlogPost(uint8_t id, const uint32_t* args, uint8_t argc);
+
+/**
+ * @brief Log a catalogue message with its arguments.
+ *
+ * Arguments are integers, bools or floats, matching the conversions in
+ * the message's format string.
+ */
+template <typename... Args>
+inline void binlog(uint8_t id, Args... args) {
+    static_assert(sizeof...(Args) <= BINLOG_MAX_ARGS, "Too many log arguments");
+    const uint32_t values[] = {binlogArg(args)..., 0u};
+    binlogPost(id, values, static_cast<uint8_t>(sizeof...(Args)));
+}
+
+// ============================================
+// DECODER (host side)
+// ============================================
+
+/**
+ * @brief Find and decode the next record in a byte stream.
+ *
+ * Bytes that cannot start a record (noise, boot messages on the same
+ * port) are skipped.
+ *
+ * @param found Set to true if record holds a decoded record.
+ * @return Number of bytes consumed. Returns 0 with found == false when
+ *         more data is needed to complete the next record.
+ */
+size_t binlogParse(const uint8_t* data, size_t len, BinLogRecord& record, bool& found);
+
+/**
+ * @brief Format a record with its catalogue format string.
+ *
+ * Supports the printf conversions d, i, u, x, X, c and f/e/g (argument
+ * is a float) with flags, width and precision. Records with an unknown
+ * ID are printed as raw values.
+ *
+ * @param formats     Format strings indexed by message ID.
+ * @param formatCount Number of entries in formats.
+ * @return Length of the formatted text (truncated to fit out).
+ */
+size_t binlogFormat(const BinLogRecord& record, const char* const* formats, size_t formatCount,
+                    char* out, size_t outSize);
+
+#endif // BINLOG_H
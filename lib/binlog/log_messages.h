@@ -0,0 +1,93 @@
+/**
+ * @file log_messages.h
+ * @brief Message catalogue for the collar firmware's binary log.
+ *
+ * Each entry is X(id, format). The ID of a message is its position in the
+ * list, so new messages are appended and existing ones are never
+ * reordered; otherwise logs recorded by older firmware decode wrongly.
+ *
+ * The firmware only uses the LogId enum. Format strings are applied by
+ * the host decoder (tools/binlog_decode.cpp) and never reach flash.
+ * Arguments are 32-bit: %d/%u/%x for integers, %f for floats.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef LOG_MESSAGES_H
+#define LOG_MESSAGES_H
+
+#include <stdint.h>
+
+#define LOG_MESSAGES(X) \
+    X(LOG_DROPPED, "(%u log records dropped)") \
+    X(LOG_BOOT, "Uncollar GPS Collar - Power Optimized (wake cause %u)") \
+    X(LOG_CONFIG_INIT_FAILED, "Failed to initialize config manager!") \
+    X(LOG_TRACK_LOG_UNAVAILABLE, "Track log unavailable") \
+    X(LOG_RADIOS_DISABLED, "WiFi and Bluetooth disabled") \
+    X(LOG_GPS_SLEEP, "GPS put to sleep") \
+    X(LOG_GPS_WAKE, "GPS woken up") \
+    X(LOG_POSITION_STORED, "Position stored: %.6f, %.6f") \
+    X(LOG_FENCE_DISTANCE, "Fence distance: %.1f m") \
+    X(LOG_FENCE_EXITED, "ALERT: Left bounds") \
+    X(LOG_FENCE_ESCALATED, "ALERT: Still outside, level %u") \
+    X(LOG_FENCE_RETURNED, "Returned inside bounds") \
+    X(LOG_FENCE_INSIDE, "Inside bounds") \
+    X(LOG_FENCE_OUTSIDE, "Outside bounds") \
+    X(LOG_FENCE_LOADED, "Fence loaded from partition: %u vertices") \
+    X(LOG_FENCE_UPDATED, "Fence updated to version %08X") \
+    X(LOG_FENCE_UPDATE_FAILED, "Fence update failed: version %08X") \
+    X(LOG_WAKES_SKIPPED, "Wakes skipped since last boot: %u") \
+    X(LOG_WAKE_BUDGET, "Next wakes to skip: %u") \
+    X(LOG_ACTIVITY, "Activity: %u (energy %u, crossings %u)") \
+    X(LOG_MOTION_ACQUIRE, "Motion score: %u - acquiring GPS") \
+    X(LOG_MOTION_STATIONARY, "Motion score: %u - stationary, skipping GPS") \
+    X(LOG_DEEP_SLEEP, "Entering deep sleep for %u seconds...") \
+    X(LOG_GPS_INIT, "Initializing GPS...") \
+    X(LOG_GPS_WAITING, "Waiting for GPS fix...") \
+    X(LOG_TRACK_BATCH_READY, "Track batch ready: %u fixes pending uplink") \
+    X(LOG_FIX_ACQUIRED, "Fix acquired: %.6f, %.6f") \
+    X(LOG_REUSING_POSITION, "Stationary - reusing last position") \
+    X(LOG_NO_FIX, "No GPS fix - using last known position %.6f, %.6f") \
+    X(LOG_LOOP_REACHED, "ERROR: Loop executed - this should not happen!") \
+    X(LOG_NVS_OPEN_FAILED, "Failed to open NVS namespace") \
+    X(LOG_CONFIG_LOAD_FAILED, "Failed to load configuration") \
+    X(LOG_CONFIG_DEFAULTS, "No config found in NVS, loading defaults") \
+    X(LOG_CONFIG_INVALID_COUNT, "Invalid boundary count in NVS, loading defaults") \
+    X(LOG_CONFIG_LOADED, "Configuration loaded from NVS: %.6f, %.6f, %u boundary vertices") \
+    X(LOG_CONFIG_SAVED, "Configuration saved to NVS") \
+    X(LOG_BOUNDARY_INVALID_COUNT, "Invalid boundary vertex count: %u") \
+    X(LOG_BOUNDARY_NULL, "Null vertices pointer") \
+    X(LOG_BOUNDARY_UPDATED, "Boundary vertices updated: %u") \
+    X(LOG_IMU_NOT_FOUND, "ICM-20948 not found") \
+    X(LOG_IMU_SETUP_FAILED, "ICM-20948 wake-on-motion setup failed") \
+    X(LOG_GPS_RATE, "GPS update rate set to %u Hz") \
+    X(LOG_GPS_BURST_START, "Burst mode: %.1f m from fence") \
+    X(LOG_GPS_BURST_END, "Burst mode ended after %u fixes, %.1f m from fence") \
+    X(LOG_FIX_QUALITY, "Fix after %u ms: HDOP %.2f, %u satellites") \
+    X(LOG_FIX_TIMEOUT, "No fix within %u ms, skipping the next %u attempts") \
+    X(LOG_FIX_BACKOFF, "Fix search backed off, %u attempts left to skip") \
+    X(LOG_GPS_NO_ACK, "GPS did not acknowledge PMTK%u") \
+    X(LOG_GPS_PIPELINE_DROPPED, "GPS pipeline dropped %u fixes") \
+    X(LOG_RADIO_NOT_FOUND, "RFM95W not found") \
+    X(LOG_TRACK_UPLINK, "Uplinked %u fixes: %u bytes, %u ms on air") \
+    X(LOG_RADIO_DOWNLINK, "Downlink frame: %u bytes") \
+    X(LOG_BOUNDARY_REJECTED, "Boundary rejected: verdict %u") \
+    X(LOG_BOUNDARY_REPAIRED, "Boundary repaired: %u vertices dropped, reversed %u") \
+    X(LOG_FENCE_INVALID, "Active fence failed validation (verdict %u), fence disabled") \
+    X(LOG_CONFIG_FENCE_CORRUPT, "Fence record %u in NVS is corrupt, using the other") \
+    X(LOG_CONFIG_SAVE_FAILED, "Fence record did not verify, configuration not saved")
+
+/**
+ * @brief Message IDs, in catalogue order.
+ */
+enum LogId : uint8_t {
+#define LOG_MESSAGE_ID(id, format) id,
+    LOG_MESSAGES(LOG_MESSAGE_ID)
+#undef LOG_MESSAGE_ID
+    LOG_MESSAGE_COUNT
+};
+
+static_assert(LOG_DROPPED == 0, "LOG_DROPPED must match BINLOG_DROPPED_ID");
+static_assert(LOG_MESSAGE_COUNT <= 256, "Message IDs are 8 bits");
+
+#endif // LOG_MESSAGES_H
@@ -0,0 +1,60 @@
+/**
+ * @file checksum.cpp
+ * @brief Implementation of nibble-table checksums.
+ * 
+ * @copyright Apache 2.0 License
+ */
+
+#include "checksum.h"
+
+// CRC-32 nibble table for the reflected polynomial 0xEDB88320
+static const uint32_t CRC32_NIBBLE_TABLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t crc32(const void* data, size_t len, uint32_t crc) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= bytes[i];
+        crc = CRC32_NIBBLE_TABLE[crc & 0x0F] ^ (crc >> 4);
+        crc = CRC32_NIBBLE_TABLE[crc & 0x0F] ^ (crc >> 4);
+    }
+
+    return ~crc;
+}
+
+// CRC-16/CCITT nibble table for the polynomial 0x1021
+static const uint16_t CRC16_NIBBLE_TABLE[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t crc16(const void* data, size_t len, uint16_t crc) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    for (size_t i = 0; i < len; i++) {
+        crc = static_cast<uint16_t>(CRC16_NIBBLE_TABLE[(crc >> 12) ^ (bytes[i] >> 4)] ^ (crc << 4));
+        crc = static_cast<uint16_t>(CRC16_NIBBLE_TABLE[(crc >> 12) ^ (bytes[i] & 0x0F)] ^ (crc << 4));
+    }
+
+    return crc;
+}
+
+uint8_t crc8(const void* data, size_t len, uint8_t crc) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= bytes[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07)
+                               : static_cast<uint8_t>(crc << 1);
+        }
+    }
+
+    return crc;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file checksum.h
+ * @brief Small, table-light checksums shared by the storage and radio code.
+ * 
+ * All functions are incremental: pass the previous return value as the
+ * seed to continue a checksum across several buffers. No dynamic
+ * allocation and no 256-entry tables, so flash usage stays negligible.
+ * 
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief CRC-32 (IEEE 802.3, reflected, poly 0xEDB88320).
+ * 
+ * @param data Pointer to data to checksum.
+ * @param len  Number of bytes.
+ * @param crc  Previous CRC to continue from (0 to start a new checksum).
+ * @return Updated CRC-32 value.
+ */
+uint32_t crc32(const void* data, size_t len, uint32_t crc = 0);
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF, no reflection).
+ * 
+ * Used for framing radio messages.
+ * 
+ * @param data Pointer to data to checksum.
+ * @param len  Number of bytes.
+ * @param crc  Previous CRC to continue from (0xFFFF to start a new checksum).
+ * @return Updated CRC-16 value.
+ */
+uint16_t crc16(const void* data, size_t len, uint16_t crc = 0xFFFF);
+
+/**
+ * @brief CRC-8 (poly 0x07, init 0x00, no reflection).
+ * 
+ * Used for small fixed-size records where a byte of overhead matters.
+ * 
+ * @param data Pointer to data to checksum.
+ * @param len  Number of bytes.
+ * @param crc  Previous CRC to continue from (0 to start a new checksum).
+ * @return Updated CRC-8 value.
+ */
+uint8_t crc8(const void* data, size_t len, uint8_t crc = 0);
+
+#endif // CHECKSUM_H
@@ -4,18 +4,59 @@
  */
 
 #include "config_manager.h"
+#include "../binlog/binlog.h"
+#include "../binlog/log_messages.h"
+#include "../checksum/checksum.h"
+
+#include <stddef.h>
+#include <string.h>
+
+// ============================================
+// FENCE RECORDS
+// ============================================
+
+namespace {
+
+/**
+ * @brief The fence as one NVS blob, so it is never half written.
+ */
+struct FenceRecord {
+    uint32_t version;
+    uint8_t vertexCount;
+    uint8_t verdict;
+    uint8_t verdictSource;
+    uint8_t reserved;
+    uint32_t verdictCrc;
+    GeoPoint vertices[MAX_BOUNDARY_VERTICES];
+    uint32_t crc;           ///< CRC-32 of the fields above
+};
+
+uint32_t fenceRecordCrc(const FenceRecord& record) {
+    return crc32(&record, offsetof(FenceRecord, crc));
+}
+
+const char* fenceRecordKey(uint8_t slot) {
+    return slot == 0 ? KEY_FENCE_RECORD_A : KEY_FENCE_RECORD_B;
+}
+
+}  // namespace
 
 // ============================================
 // CONSTRUCTOR / DESTRUCTOR
 // ============================================
 
 ConfigManager::ConfigManager()
-    : _initialized(false) {
+    : _initialized(false)
+    , _fenceSlot(1) {  // Nothing saved yet: the first save() goes to record A
     // Initialize config with null values
     _config.defaultLatitude = 0.0f;
     _config.defaultLongitude = 0.0f;
     _config.boundaryVertices = nullptr;
     _config.boundaryVertexCount = 0;
+    _config.fenceVersion = 0;
+    _config.fenceVerdict = FenceVerdict::UNCHECKED;
+    _config.fenceVerdictSource = FenceSource::NVS;
+    _config.fenceVerdictCrc = 0;
 }
 
 ConfigManager::~ConfigManager() {
@@ -33,17 +74,13 @@ bool ConfigManager::begin() {
 
     // Try to open NVS partition
     if (!_prefs.begin(NVS_NAMESPACE, false)) {
-        #ifdef DEBUG_SERIAL
-        Serial.println("Failed to open NVS namespace");
-        #endif
+        binlog(LOG_NVS_OPEN_FAILED);
         return false;
     }
 
     // Load configuration
     if (!load()) {
-        #ifdef DEBUG_SERIAL
-        Serial.println("Failed to load configuration");
-        #endif
+        binlog(LOG_CONFIG_LOAD_FAILED);
         return false;
     }
 
@@ -65,6 +102,11 @@ void ConfigManager::loadDefaults() {
     _config.defaultLatitude = DEFAULT_LATITUDE;
     _config.defaultLongitude = DEFAULT_LONGITUDE;
     _config.boundaryVertexCount = DEFAULT_BOUNDARY_VERTEX_COUNT;
+    _config.fenceVersion = 0;
+    // Version 0 may also be a fence in the partition; checked when loaded
+    _config.fenceVerdict = FenceVerdict::UNCHECKED;
+    _config.fenceVerdictSource = FenceSource::NVS;
+    _config.fenceVerdictCrc = 0;
 
     // Allocate and copy default boundary vertices
     _config.boundaryVertices = new GeoPoint[DEFAULT_BOUNDARY_VERTEX_COUNT];
@@ -77,9 +119,7 @@ bool ConfigManager::load() {
     // Check if configuration exists in NVS
     // We'll check if the latitude key exists
     if (!_prefs.isKey(KEY_LATITUDE)) {
-        #ifdef DEBUG_SERIAL
-        Serial.println("No config found in NVS, loading defaults");
-        #endif
+        binlog(LOG_CONFIG_DEFAULTS);
         
         // Load defaults
         loadDefaults();
@@ -88,45 +128,85 @@ bool ConfigManager::load() {
         return save();
     }
 
-    // Load from NVS
+    // Load from NVS (freeing first: it also clears the vertex count)
+    freeBoundaryMemory();
     _config.defaultLatitude = _prefs.getFloat(KEY_LATITUDE, DEFAULT_LATITUDE);
     _config.defaultLongitude = _prefs.getFloat(KEY_LONGITUDE, DEFAULT_LONGITUDE);
-    _config.boundaryVertexCount = _prefs.getUChar(KEY_BOUNDARY_COUNT, DEFAULT_BOUNDARY_VERTEX_COUNT);
 
-    // Validate count
-    if (_config.boundaryVertexCount < MIN_BOUNDARY_VERTICES || 
-        _config.boundaryVertexCount > MAX_BOUNDARY_VERTICES) {
-        #ifdef DEBUG_SERIAL
-        Serial.println("Invalid boundary count in NVS, loading defaults");
-        #endif
+    bool loaded;
+    if (_prefs.isKey(KEY_FENCE_SLOT)) {
+        uint8_t slot = _prefs.getUChar(KEY_FENCE_SLOT, 0) != 0 ? 1 : 0;
+        loaded = loadFenceRecord(slot);
+        if (!loaded) {
+            // save() verifies a record before flipping to it, so only NVS
+            // corruption gets here; the other record is the previous fence
+            binlog(LOG_CONFIG_FENCE_CORRUPT, slot);
+            loaded = loadFenceRecord(slot ^ 1);
+        }
+    } else {
+        loaded = loadLegacyFence();
+    }
+
+    if (!loaded) {
+        binlog(LOG_CONFIG_INVALID_COUNT);
         loadDefaults();
         return save();
     }
 
-    // Allocate memory for boundary vertices
+    binlog(LOG_CONFIG_LOADED, _config.defaultLatitude, _config.defaultLongitude,
+           _config.boundaryVertexCount);
+
+    return true;
+}
+
+bool ConfigManager::loadFenceRecord(uint8_t slot) {
+    FenceRecord record;
+    const char* key = fenceRecordKey(slot);
+    if (_prefs.getBytesLength(key) != sizeof(record) ||
+        _prefs.getBytes(key, &record, sizeof(record)) != sizeof(record) ||
+        record.crc != fenceRecordCrc(record) ||
+        record.vertexCount < MIN_BOUNDARY_VERTICES ||
+        record.vertexCount > MAX_BOUNDARY_VERTICES) {
+        return false;
+    }
+
+    freeBoundaryMemory();
+    _config.boundaryVertices = new GeoPoint[record.vertexCount];
+    for (size_t i = 0; i < record.vertexCount; i++) {
+        _config.boundaryVertices[i] = record.vertices[i];
+    }
+    _config.boundaryVertexCount = record.vertexCount;
+    _config.fenceVersion = record.version;
+    _config.fenceVerdict = static_cast<FenceVerdict>(record.verdict);
+    _config.fenceVerdictSource = static_cast<FenceSource>(record.verdictSource);
+    _config.fenceVerdictCrc = record.verdictCrc;
+    _fenceSlot = slot;
+    return true;
+}
+
+bool ConfigManager::loadLegacyFence() {
+    size_t count = _prefs.getUChar(KEY_BOUNDARY_COUNT, DEFAULT_BOUNDARY_VERTEX_COUNT);
+    if (count < MIN_BOUNDARY_VERTICES || count > MAX_BOUNDARY_VERTICES) {
+        return false;
+    }
+
     freeBoundaryMemory();
-    _config.boundaryVertices = new GeoPoint[_config.boundaryVertexCount];
+    _config.boundaryVertices = new GeoPoint[count];
+    _config.boundaryVertexCount = count;
+    _config.fenceVersion = _prefs.getUInt(KEY_FENCE_VERSION, 0);
+    _config.fenceVerdict = FenceVerdict::UNCHECKED;
+    _config.fenceVerdictSource = FenceSource::NVS;
+    _config.fenceVerdictCrc = 0;
 
     // Load each vertex
     char keyBuffer[32];
-    for (size_t i = 0; i < _config.boundaryVertexCount; i++) {
-        snprintf(keyBuffer, sizeof(keyBuffer), "%s%u_lat", KEY_BOUNDARY_PREFIX, i);
+    for (size_t i = 0; i < count; i++) {
+        snprintf(keyBuffer, sizeof(keyBuffer), "%s%u_lat", KEY_BOUNDARY_PREFIX, static_cast<unsigned>(i));
         _config.boundaryVertices[i].lat = _prefs.getFloat(keyBuffer, 0.0f);
         
-        snprintf(keyBuffer, sizeof(keyBuffer), "%s%u_lon", KEY_BOUNDARY_PREFIX, i);
+        snprintf(keyBuffer, sizeof(keyBuffer), "%s%u_lon", KEY_BOUNDARY_PREFIX, static_cast<unsigned>(i));
         _config.boundaryVertices[i].lon = _prefs.getFloat(keyBuffer, 0.0f);
     }
-
-    #ifdef DEBUG_SERIAL
-    Serial.println("Configuration loaded from NVS");
-    Serial.print("Latitude: ");
-    Serial.println(_config.defaultLatitude, 6);
-    Serial.print("Longitude: ");
-    Serial.println(_config.defaultLongitude, 6);
-    Serial.print("Boundary vertices: ");
-    Serial.println(_config.boundaryVertexCount);
-    #endif
-
     return true;
 }
 
@@ -134,21 +214,35 @@ bool ConfigManager::save() {
     // Save latitude and longitude
     _prefs.putFloat(KEY_LATITUDE, _config.defaultLatitude);
     _prefs.putFloat(KEY_LONGITUDE, _config.defaultLongitude);
-    _prefs.putUChar(KEY_BOUNDARY_COUNT, _config.boundaryVertexCount);
 
-    // Save each boundary vertex
-    char keyBuffer[32];
-    for (size_t i = 0; i < _config.boundaryVertexCount; i++) {
-        snprintf(keyBuffer, sizeof(keyBuffer), "%s%u_lat", KEY_BOUNDARY_PREFIX, i);
-        _prefs.putFloat(keyBuffer, _config.boundaryVertices[i].lat);
-        
-        snprintf(keyBuffer, sizeof(keyBuffer), "%s%u_lon", KEY_BOUNDARY_PREFIX, i);
-        _prefs.putFloat(keyBuffer, _config.boundaryVertices[i].lon);
+    FenceRecord record;
+    memset(&record, 0, sizeof(record));
+    record.version = _config.fenceVersion;
+    record.vertexCount = static_cast<uint8_t>(_config.boundaryVertexCount);
+    record.verdict = static_cast<uint8_t>(_config.fenceVerdict);
+    record.verdictSource = static_cast<uint8_t>(_config.fenceVerdictSource);
+    record.verdictCrc = _config.fenceVerdictCrc;
+    for (size_t i = 0; i < _config.boundaryVertexCount && i < MAX_BOUNDARY_VERTICES; i++) {
+        record.vertices[i] = _config.boundaryVertices[i];
     }
+    record.crc = fenceRecordCrc(record);
+
+    // Stage into the inactive record and read it back; flipping the slot
+    // key is the commit point
+    uint8_t slot = _fenceSlot ^ 1;
+    const char* key = fenceRecordKey(slot);
+    FenceRecord check;
+    bool ok = _prefs.putBytes(key, &record, sizeof(record)) == sizeof(record) &&
+              _prefs.getBytes(key, &check, sizeof(check)) == sizeof(check) &&
+              check.crc == fenceRecordCrc(check) && check.crc == record.crc &&
+              _prefs.putUChar(KEY_FENCE_SLOT, slot) == sizeof(slot);
+    if (!ok) {
+        binlog(LOG_CONFIG_SAVE_FAILED);
+        return false;
+    }
+    _fenceSlot = slot;
 
-    #ifdef DEBUG_SERIAL
-    Serial.println("Configuration saved to NVS");
-    #endif
+    binlog(LOG_CONFIG_SAVED);
 
     return true;
 }
@@ -178,6 +272,21 @@ size_t ConfigManager::getBoundaryVertexCount() const {
     return _config.boundaryVertexCount;
 }
 
+uint32_t ConfigManager::getFenceVersion() const {
+    return _config.fenceVersion;
+}
+
+uint32_t ConfigManager::getBoundaryCrc() const {
+    return crc32(_config.boundaryVertices, _config.boundaryVertexCount * sizeof(GeoPoint));
+}
+
+FenceVerdict ConfigManager::getFenceVerdict(FenceSource source, uint32_t crc) const {
+    if (source != _config.fenceVerdictSource || crc != _config.fenceVerdictCrc) {
+        return FenceVerdict::UNCHECKED;
+    }
+    return _config.fenceVerdict;
+}
+
 const Config& ConfigManager::getConfig() const {
     return _config;
 }
@@ -194,41 +303,51 @@ void ConfigManager::setDefaultLongitude(float lon) {
     _config.defaultLongitude = lon;
 }
 
+void ConfigManager::setFenceVersion(uint32_t version) {
+    _config.fenceVersion = version;
+}
+
+void ConfigManager::setFenceVerdict(FenceVerdict verdict, FenceSource source, uint32_t crc) {
+    _config.fenceVerdict = verdict;
+    _config.fenceVerdictSource = source;
+    _config.fenceVerdictCrc = crc;
+}
+
 bool ConfigManager::setBoundaryVertices(const GeoPoint* vertices, size_t count) {
     // Validate count
     if (count < MIN_BOUNDARY_VERTICES || count > MAX_BOUNDARY_VERTICES) {
-        #ifdef DEBUG_SERIAL
-        Serial.print("Invalid boundary vertex count: ");
-        Serial.println(count);
-        #endif
+        binlog(LOG_BOUNDARY_INVALID_COUNT, count);
         return false;
     }
 
     // Validate pointer
     if (vertices == nullptr) {
-        #ifdef DEBUG_SERIAL
-        Serial.println("Null vertices pointer");
-        #endif
+        binlog(LOG_BOUNDARY_NULL);
         return false;
     }
 
-    // Reallocate if count changed
-    if (count != _config.boundaryVertexCount) {
-        freeBoundaryMemory();
-        _config.boundaryVertices = new GeoPoint[count];
+    // Repair a copy: the caller's array may be the current boundary
+    GeoPoint* repaired = new GeoPoint[count];
+    for (size_t i = 0; i < count; i++) {
+        repaired[i] = vertices[i];
     }
 
-    // Copy vertices
-    for (size_t i = 0; i < count; i++) {
-        _config.boundaryVertices[i] = vertices[i];
+    FenceValidation validation = fenceValidateRepair(repaired, count);
+    if (!fenceVerdictUsable(validation.verdict)) {
+        delete[] repaired;
+        binlog(LOG_BOUNDARY_REJECTED, static_cast<uint8_t>(validation.verdict));
+        return false;
+    }
+    if (validation.verdict == FenceVerdict::REPAIRED) {
+        binlog(LOG_BOUNDARY_REPAIRED, validation.removed, validation.reversed);
     }
 
+    freeBoundaryMemory();
+    _config.boundaryVertices = repaired;
     _config.boundaryVertexCount = count;
+    setFenceVerdict(validation.verdict, FenceSource::NVS, getBoundaryCrc());
 
-    #ifdef DEBUG_SERIAL
-    Serial.print("Boundary vertices updated: ");
-    Serial.println(count);
-    #endif
+    binlog(LOG_BOUNDARY_UPDATED, count);
 
     return true;
 }
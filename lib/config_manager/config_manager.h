@@ -15,6 +15,7 @@
 #include <Arduino.h>
 #include <Preferences.h>
 #include "../point_in_polygon/point_in_polygon.h"
+#include "../fence_validate/fence_validate.h"
 
 // ============================================
 // DEFAULT CONFIGURATION VALUES
@@ -44,13 +45,30 @@ constexpr size_t DEFAULT_BOUNDARY_VERTEX_COUNT =
 constexpr char NVS_NAMESPACE[] = "uncollar_cfg";
 constexpr char KEY_LATITUDE[] = "cfg_lat";
 constexpr char KEY_LONGITUDE[] = "cfg_lon";
+
+// The fence (vertices, version, verdict) is one record in each of two
+// slots; the slot key, written last, names the active one
+constexpr char KEY_FENCE_SLOT[] = "cfg_fence_slot";
+constexpr char KEY_FENCE_RECORD_A[] = "cfg_fence_a";
+constexpr char KEY_FENCE_RECORD_B[] = "cfg_fence_b";
+
+// Written by older firmware, read once to migrate
 constexpr char KEY_BOUNDARY_COUNT[] = "cfg_bnd_cnt";
 constexpr char KEY_BOUNDARY_PREFIX[] = "cfg_bnd_";
+constexpr char KEY_FENCE_VERSION[] = "cfg_fence_ver";
 
 // ============================================
 // CONFIG STRUCT
 // ============================================
 
+/**
+ * @brief Where the active fence is kept. Stored in NVS: never renumbered.
+ */
+enum class FenceSource : uint8_t {
+    NVS = 0,        ///< Config boundary vertices
+    PARTITION = 1   ///< A FenceStore slot
+};
+
 /**
  * @brief Configuration data structure.
  * 
@@ -62,6 +80,10 @@ struct Config {
     float defaultLongitude;
     GeoPoint* boundaryVertices;
     size_t boundaryVertexCount;
+    uint32_t fenceVersion;  ///< (fence ID << 16) | revision; 0 for the default fence
+    FenceVerdict fenceVerdict;  ///< Validation of the fence below; UNCHECKED until validated
+    FenceSource fenceVerdictSource;  ///< Store of the fence the verdict describes
+    uint32_t fenceVerdictCrc;   ///< CRC-32 of that fence (FenceStore blob CRC, or getBoundaryCrc())
 };
 
 // ============================================
@@ -116,8 +138,12 @@ public:
      * @brief Save current configuration to NVS.
      * 
      * Persists all current configuration values to non-volatile storage.
+     * The fence is staged into the inactive record, read back and
+     * CRC-checked, and only then made active by flipping the slot key, so
+     * a reset during save() leaves the previous fence and version intact.
      * 
-     * @return true if saved successfully, false on error
+     * @return true if saved successfully, false on error (the previous
+     *         fence then stays the saved one)
      */
     bool save();
 
@@ -158,6 +184,36 @@ public:
      */
     size_t getBoundaryVertexCount() const;
 
+    /**
+     * @brief Get the version of the active fence.
+     * 
+     * Also identifies which fence in the fence partition (if any) is active.
+     * 
+     * @return (fence ID << 16) | revision, or 0 for the default fence.
+     */
+    uint32_t getFenceVersion() const;
+
+    /**
+     * @brief Get the CRC-32 of the boundary vertices.
+     * 
+     * Identifies the NVS fence for getFenceVerdict().
+     */
+    uint32_t getBoundaryCrc() const;
+
+    /**
+     * @brief Get the cached validation verdict of a fence.
+     * 
+     * Fences are validated once, when set, so the wake-time path only
+     * reads this. The cache holds one verdict, for one fence: asking about
+     * any other fence (another store, or other contents) gives UNCHECKED.
+     * 
+     * @param source Store the fence was loaded from.
+     * @param crc    CRC-32 of the fence: the FenceStore blob CRC for the
+     *               partition, getBoundaryCrc() for NVS.
+     * @return The verdict, or UNCHECKED if this fence was never validated.
+     */
+    FenceVerdict getFenceVerdict(FenceSource source, uint32_t crc) const;
+
     /**
      * @brief Get the complete configuration struct.
      * @return Reference to the Config struct.
@@ -183,14 +239,35 @@ public:
     /**
      * @brief Set the boundary vertices.
      * 
-     * Allocates new memory for vertices if count differs from current.
+     * Validates the fence and stores its repaired form (duplicate and
+     * collinear vertices dropped, counter-clockwise; see fenceValidate()).
+     * The verdict becomes the cached fence verdict, for the NVS fence.
      * 
      * @param vertices Pointer to array of GeoPoint vertices.
      * @param count Number of vertices (must be >= MIN_BOUNDARY_VERTICES).
-     * @return true if set successfully, false on invalid count.
+     * @return true if set successfully, false on invalid count or a fence
+     *         that is not a simple polygon (the boundary is then unchanged).
      */
     bool setBoundaryVertices(const GeoPoint* vertices, size_t count);
 
+    /**
+     * @brief Set the version of the active fence.
+     * @param version (fence ID << 16) | revision.
+     */
+    void setFenceVersion(uint32_t version);
+
+    /**
+     * @brief Cache the validation verdict of a fence.
+     * 
+     * For fences validated outside the config: the fence partition, or an
+     * NVS fence from older firmware.
+     * 
+     * @param verdict Verdict from fenceValidate().
+     * @param source  Store the fence is kept in.
+     * @param crc     CRC-32 of the fence, as for getFenceVerdict().
+     */
+    void setFenceVerdict(FenceVerdict verdict, FenceSource source, uint32_t crc);
+
     /**
      * @brief Check if configuration has been initialized.
      * @return true if begin() has been called successfully.
@@ -201,12 +278,25 @@ private:
     Preferences _prefs;
     Config _config;
     bool _initialized;
+    uint8_t _fenceSlot;     ///< Record holding the saved fence; save() writes the other
 
     /**
      * @brief Load defaults into config.
      */
     void loadDefaults();
 
+    /**
+     * @brief Load the fence from one record slot.
+     * @return false if the record is missing or fails its CRC.
+     */
+    bool loadFenceRecord(uint8_t slot);
+
+    /**
+     * @brief Load the fence from the per-vertex keys of older firmware.
+     * @return false if the stored count is out of range.
+     */
+    bool loadLegacyFence();
+
     /**
      * @brief Free allocated boundary memory.
      */
@@ -0,0 +1,411 @@
+/**
+ * @file containment_fuzz.cpp
+ * @brief Implementation of the containment kernel differential fuzzer.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "containment_fuzz.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+// Header bytes: vertex count, grid step, centre latitude and longitude
+static const size_t HEADER_SIZE = 6;
+static const size_t VERTEX_SIZE = 3;
+static const size_t POINT_SIZE = 3;
+
+// Grid steps 2^-2 to 2^-27 degrees; the finest are below a float ulp
+static const int MIN_STEP_SHIFT = 2;
+static const int STEP_SHIFTS = 26;
+
+enum PointKind : uint8_t {
+    POINT_GRID,             ///< On the half-step grid, so often on an edge
+    POINT_VERTEX,
+    POINT_NUDGED_VERTEX,    ///< A vertex moved by a few ulps
+    POINT_VERTEX_LATITUDE,  ///< The ray runs through a vertex
+    POINT_MIDPOINT,         ///< Midpoint of an edge, rounded to float
+    POINT_KINDS
+};
+
+// ============================================================================
+// Kernels
+// ============================================================================
+
+static bool polygonContains(const GeoPoint& point, const GeoPoint* vertices, size_t count) {
+    return Polygon(vertices, count).contains(point);
+}
+
+const ContainmentKernelInfo CONTAINMENT_KERNELS[] = {
+    {"Polygon::contains()", "Polygon(fence, %lu).contains(point)", polygonContains},
+    {"pointInPolygon()", "pointInPolygon(point, fence, %lu)", pointInPolygon},
+};
+
+const size_t CONTAINMENT_KERNEL_COUNT = sizeof(CONTAINMENT_KERNELS) / sizeof(CONTAINMENT_KERNELS[0]);
+
+// ============================================================================
+// Reference
+// ============================================================================
+
+// Spacing of floats around a magnitude
+static double floatUlp(double magnitude) {
+    if (magnitude < 1.1754943508222875e-38) {
+        return ldexp(1.0, -149);
+    }
+    int exponent;
+    frexp(magnitude, &exponent);
+    return ldexp(1.0, exponent - 24);
+}
+
+ContainmentTruth containmentReference(const GeoPoint& point, const GeoPoint* vertices, size_t count) {
+    if (vertices == nullptr || count < 3) {
+        return ContainmentTruth::OUTSIDE;
+    }
+    double px = point.lon;
+    double py = point.lat;
+    bool inside = false;
+    bool uncertain = false;
+    for (size_t i = 0, j = count - 1; i < count; j = i++) {
+        const GeoPoint& a = vertices[i];
+        const GeoPoint& b = vertices[j];
+        if ((a.lat > point.lat) == (b.lat > point.lat)) {
+            continue;
+        }
+        double ax = a.lon;
+        double ay = a.lat;
+        double bx = b.lon;
+        double by = b.lat;
+        double slope = (bx - ax) / (by - ay);
+        double crossing = ax + (py - ay) * slope;
+
+        // How far the float kernels' crossing can be off: rounding of the
+        // longitudes, and of the latitude difference scaled by the slope
+        double band = CONTAINMENT_BAND_ULPS *
+                      (floatUlp(std::max(std::max(fabs(ax), fabs(bx)), fabs(px))) +
+                       fabs(slope) * floatUlp(std::max(std::max(fabs(ay), fabs(by)), fabs(py))));
+        if (fabs(px - crossing) <= band) {
+            uncertain = true;
+        } else if (px < crossing) {
+            inside = !inside;
+        }
+    }
+    if (uncertain) {
+        return ContainmentTruth::UNCERTAIN;
+    }
+    return inside ? ContainmentTruth::INSIDE : ContainmentTruth::OUTSIDE;
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+static float nudge(float value, int ulps) {
+    for (; ulps > 0; ulps--) {
+        value = nextafterf(value, INFINITY);
+    }
+    for (; ulps < 0; ulps++) {
+        value = nextafterf(value, -INFINITY);
+    }
+    return value;
+}
+
+static GeoPoint gridPoint(double lat, double lon) {
+    GeoPoint point = {static_cast<float>(std::max(-90.0, std::min(90.0, lat))),
+                      static_cast<float>(std::max(-180.0, std::min(180.0, lon)))};
+    return point;
+}
+
+// Two ulp offsets from -1 to +2, from the low four bits
+static GeoPoint nudgePoint(GeoPoint point, uint8_t bits) {
+    point.lat = nudge(point.lat, (bits & 3) - 1);
+    point.lon = nudge(point.lon, ((bits >> 2) & 3) - 1);
+    return point;
+}
+
+bool containmentDecode(const uint8_t* data, size_t size, ContainmentCase& out) {
+    out.vertices.clear();
+    out.points.clear();
+    if (data == nullptr || size < HEADER_SIZE) {
+        return false;
+    }
+    size_t count = 3 + data[0] % (CONTAINMENT_MAX_VERTICES - 2);
+    if (size < HEADER_SIZE + count * VERTEX_SIZE + POINT_SIZE) {
+        return false;
+    }
+    double step = ldexp(1.0, -(MIN_STEP_SHIFT + data[1] % STEP_SHIFTS));
+    double lat0 = static_cast<int16_t>(data[2] | (data[3] << 8)) / 32768.0 * 85.0;
+    double lon0 = static_cast<int16_t>(data[4] | (data[5] << 8)) / 32768.0 * 180.0;
+
+    const uint8_t* in = data + HEADER_SIZE;
+    for (size_t i = 0; i < count; i++, in += VERTEX_SIZE) {
+        GeoPoint vertex = gridPoint(lat0 + static_cast<int8_t>(in[0]) * step, lon0 + static_cast<int8_t>(in[1]) * step);
+        // Most vertices stay on the grid
+        out.vertices.push_back(in[2] >= 0xC0 ? nudgePoint(vertex, in[2]) : vertex);
+    }
+
+    size_t points = std::min((size - HEADER_SIZE - count * VERTEX_SIZE) / POINT_SIZE, CONTAINMENT_MAX_POINTS);
+    for (size_t i = 0; i < points; i++, in += POINT_SIZE) {
+        const GeoPoint& vertex = out.vertices[in[1] % count];
+        const GeoPoint& next = out.vertices[(in[1] + 1) % count];
+        GeoPoint point;
+        switch (in[0] % POINT_KINDS) {
+            case POINT_GRID:
+                point = gridPoint(lat0 + static_cast<int8_t>(in[1]) * step / 2,
+                                  lon0 + static_cast<int8_t>(in[2]) * step / 2);
+                break;
+            case POINT_VERTEX:
+                point = vertex;
+                break;
+            case POINT_NUDGED_VERTEX:
+                point = nudgePoint(vertex, in[2]);
+                break;
+            case POINT_VERTEX_LATITUDE:
+                point = gridPoint(vertex.lat, lon0 + static_cast<int8_t>(in[2]) * step / 2);
+                point.lat = vertex.lat;
+                break;
+            default:
+                point = gridPoint((static_cast<double>(vertex.lat) + next.lat) / 2,
+                                  (static_cast<double>(vertex.lon) + next.lon) / 2);
+                break;
+        }
+        out.points.push_back(point);
+    }
+    return true;
+}
+
+// ============================================================================
+// Seed Corpus
+// ============================================================================
+
+enum SeedFamily : uint8_t {
+    SEED_STAR,
+    SEED_COMB,          ///< Rectilinear: horizontal edges at shared latitudes
+    SEED_RANDOM,        ///< Usually self-intersecting
+    SEED_NEEDLE,        ///< A long spike on a grid finer than a float ulp
+    SEED_FAMILIES
+};
+
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static void pushVertex(std::vector<uint8_t>& out, int lat, int lon, uint8_t nudgeBits) {
+    out.push_back(static_cast<uint8_t>(static_cast<int8_t>(lat)));
+    out.push_back(static_cast<uint8_t>(static_cast<int8_t>(lon)));
+    out.push_back(nudgeBits);
+}
+
+void containmentSeed(uint32_t seed, std::vector<uint8_t>& out) {
+    uint32_t state = seed * 2654435761u + 0x9E3779B9u;
+    if (state == 0) {
+        state = 1;
+    }
+    SeedFamily family = static_cast<SeedFamily>(seed % SEED_FAMILIES);
+    out.clear();
+
+    size_t count;
+    size_t teeth = 0;
+    switch (family) {
+        case SEED_STAR:
+            count = 3 + nextRandom(state) % 46;
+            break;
+        case SEED_COMB:
+            teeth = 1 + nextRandom(state) % 15;
+            count = 4 * teeth + 2;
+            break;
+        case SEED_RANDOM:
+            count = 3 + nextRandom(state) % 14;
+            break;
+        default:
+            count = 4 + nextRandom(state) % 9;
+            break;
+    }
+    int shift = family == SEED_NEEDLE ? 16 + nextRandom(state) % 12 : 4 + nextRandom(state) % 13;
+    uint32_t centre = nextRandom(state);
+    out.push_back(static_cast<uint8_t>(count - 3));
+    out.push_back(static_cast<uint8_t>(shift - MIN_STEP_SHIFT));
+    out.push_back(static_cast<uint8_t>(centre));
+    out.push_back(static_cast<uint8_t>(centre >> 8));
+    out.push_back(static_cast<uint8_t>(centre >> 16));
+    out.push_back(static_cast<uint8_t>(centre >> 24));
+
+    if (family == SEED_COMB) {
+        // Base, then the top edge from right to left, teeth and gaps alternating
+        int width = 240 / static_cast<int>(2 * teeth);
+        pushVertex(out, -100, -120, 0);
+        pushVertex(out, -100, -120 + static_cast<int>(2 * teeth) * width, 0);
+        for (int i = static_cast<int>(2 * teeth); i >= 1; i--) {
+            int height = i % 2 == 0 ? 100 : 20;
+            pushVertex(out, height, -120 + i * width, 0);
+            pushVertex(out, height, -120 + (i - 1) * width, 0);
+        }
+    } else if (family == SEED_RANDOM) {
+        for (size_t i = 0; i < count; i++) {
+            uint32_t r = nextRandom(state);
+            pushVertex(out, static_cast<int8_t>(r), static_cast<int8_t>(r >> 8), static_cast<uint8_t>(r >> 16));
+        }
+    } else {
+        // Vertices around a circle at sorted angles; the needle has one far out
+        std::vector<double> angles;
+        for (size_t i = 0; i < count; i++) {
+            angles.push_back((nextRandom(state) % 36000) * M_PI / 18000.0);
+        }
+        std::sort(angles.begin(), angles.end());
+        for (size_t i = 0; i < count; i++) {
+            double radius = family == SEED_NEEDLE ? (i == 0 ? 127.0 : 4.0 + nextRandom(state) % 9)
+                                                  : 16.0 + nextRandom(state) % 112;
+            uint8_t nudgeBits = nextRandom(state) % 4 == 0 ? static_cast<uint8_t>(0xC0 | nextRandom(state)) : 0;
+            pushVertex(out, static_cast<int>(lround(radius * sin(angles[i]))),
+                       static_cast<int>(lround(radius * cos(angles[i]))), nudgeBits);
+        }
+    }
+
+    size_t points = 32 + nextRandom(state) % 97;
+    for (size_t i = 0; i < points; i++) {
+        uint32_t r = nextRandom(state);
+        out.push_back(static_cast<uint8_t>(r));
+        out.push_back(static_cast<uint8_t>(r >> 8));
+        out.push_back(static_cast<uint8_t>(r >> 16));
+    }
+}
+
+// ============================================================================
+// Checking
+// ============================================================================
+
+// The kernel still disagrees with a certain reference
+static bool reproduces(const ContainmentMismatch& mismatch) {
+    ContainmentTruth truth = containmentReference(mismatch.point, mismatch.vertices.data(), mismatch.vertices.size());
+    if (truth == ContainmentTruth::UNCERTAIN) {
+        return false;
+    }
+    bool got = mismatch.kernel->kernel(mismatch.point, mismatch.vertices.data(), mismatch.vertices.size());
+    return got != (truth == ContainmentTruth::INSIDE);
+}
+
+bool containmentCheck(const ContainmentCase& testCase, const ContainmentKernelInfo* kernels, size_t kernelCount,
+                      ContainmentMismatch& mismatch) {
+    const GeoPoint* vertices = testCase.vertices.data();
+    size_t count = testCase.vertices.size();
+    for (const GeoPoint& point : testCase.points) {
+        ContainmentTruth truth = containmentReference(point, vertices, count);
+        if (truth == ContainmentTruth::UNCERTAIN) {
+            continue;
+        }
+        for (size_t k = 0; k < kernelCount; k++) {
+            bool got = kernels[k].kernel(point, vertices, count);
+            if (got != (truth == ContainmentTruth::INSIDE)) {
+                mismatch.kernel = &kernels[k];
+                mismatch.vertices = testCase.vertices;
+                mismatch.point = point;
+                mismatch.got = got;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static float roundTo(float value, int decimals) {
+    double scale = pow(10.0, decimals);
+    return static_cast<float>(round(value * scale) / scale);
+}
+
+// Replace one coordinate with the fewest decimals that still fail
+static void roundCoordinate(ContainmentMismatch& mismatch, float& coordinate) {
+    float original = coordinate;
+    for (int decimals = 0; decimals <= 7; decimals++) {
+        coordinate = roundTo(original, decimals);
+        if (coordinate == original || reproduces(mismatch)) {
+            return;
+        }
+    }
+    coordinate = original;
+}
+
+void containmentMinimize(ContainmentMismatch& mismatch) {
+    if (mismatch.kernel == nullptr || !reproduces(mismatch)) {
+        return;
+    }
+
+    // Drop vertices until none can go
+    bool shrunk = true;
+    while (shrunk && mismatch.vertices.size() > 3) {
+        shrunk = false;
+        for (size_t i = mismatch.vertices.size(); i-- > 0 && mismatch.vertices.size() > 3;) {
+            GeoPoint removed = mismatch.vertices[i];
+            mismatch.vertices.erase(mismatch.vertices.begin() + static_cast<ptrdiff_t>(i));
+            if (reproduces(mismatch)) {
+                shrunk = true;
+            } else {
+                mismatch.vertices.insert(mismatch.vertices.begin() + static_cast<ptrdiff_t>(i), removed);
+            }
+        }
+    }
+
+    for (GeoPoint& vertex : mismatch.vertices) {
+        roundCoordinate(mismatch, vertex.lat);
+        roundCoordinate(mismatch, vertex.lon);
+    }
+    roundCoordinate(mismatch, mismatch.point.lat);
+    roundCoordinate(mismatch, mismatch.point.lon);
+    mismatch.got = mismatch.kernel->kernel(mismatch.point, mismatch.vertices.data(), mismatch.vertices.size());
+}
+
+// A float literal that reads back as the same float
+static void formatFloat(float value, char* buffer, size_t size) {
+    snprintf(buffer, size, "%.9g", value);
+    if (strpbrk(buffer, ".eEn") == nullptr) {
+        strncat(buffer, ".0", size - strlen(buffer) - 1);
+    }
+    strncat(buffer, "f", size - strlen(buffer) - 1);
+}
+
+size_t containmentFormat(const ContainmentMismatch& mismatch, char* buffer, size_t size) {
+    if (mismatch.kernel == nullptr) {
+        return 0;
+    }
+    std::vector<char> text;
+    char line[160];
+    char lat[24];
+    char lon[24];
+    unsigned long count = static_cast<unsigned long>(mismatch.vertices.size());
+
+    auto append = [&text](const char* piece) { text.insert(text.end(), piece, piece + strlen(piece)); };
+    snprintf(line, sizeof(line), "// %s says %s, the reference says %s\n", mismatch.kernel->name,
+             mismatch.got ? "inside" : "outside", mismatch.got ? "outside" : "inside");
+    append(line);
+    append("GeoPoint fence[] = {\n");
+    for (size_t i = 0; i < mismatch.vertices.size(); i++) {
+        formatFloat(mismatch.vertices[i].lat, lat, sizeof(lat));
+        formatFloat(mismatch.vertices[i].lon, lon, sizeof(lon));
+        snprintf(line, sizeof(line), "    {%s, %s}%s\n", lat, lon, i + 1 < mismatch.vertices.size() ? "," : "");
+        append(line);
+    }
+    formatFloat(mismatch.point.lat, lat, sizeof(lat));
+    formatFloat(mismatch.point.lon, lon, sizeof(lon));
+    snprintf(line, sizeof(line), "};\nGeoPoint point = {%s, %s};\n", lat, lon);
+    append(line);
+    char call[96];
+    snprintf(call, sizeof(call), mismatch.kernel->call, count);
+    snprintf(line, sizeof(line), "TEST_ASSERT_%s(%s);\n", mismatch.got ? "FALSE" : "TRUE", call);
+    append(line);
+
+    return static_cast<size_t>(snprintf(buffer, size, "%.*s", static_cast<int>(text.size()), text.data()));
+}
+
+bool containmentFuzzOne(const uint8_t* data, size_t size, ContainmentMismatch& mismatch) {
+    ContainmentCase testCase;
+    if (!containmentDecode(data, size, testCase)) {
+        return true;
+    }
+    if (containmentCheck(testCase, CONTAINMENT_KERNELS, CONTAINMENT_KERNEL_COUNT, mismatch)) {
+        return true;
+    }
+    containmentMinimize(mismatch);
+    return false;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file containment_fuzz.h
+ * @brief Differential fuzzing of the containment kernels against a reference.
+ *
+ * Every fence decision goes through Polygon::contains() or pointInPolygon().
+ * These are float ray-casting kernels, tuned for the ESP32 FPU. This
+ * library checks them (and any faster replacement) against a
+ * double-precision reference, on polygons built to be awkward: horizontal
+ * edges, repeated and nearly collinear vertices, self-intersections,
+ * needles, and points placed on vertices, at vertex latitudes and on edges.
+ *
+ * The float kernels cannot agree with any reference on points within
+ * rounding of an edge. The reference reports those as UNCERTAIN, using a
+ * band of a few float ulps widened by the edge's slope, and either answer
+ * is accepted there. Anywhere else a disagreement is a bug. It is shrunk
+ * to a small polygon and a single point, and printed as a test case.
+ *
+ * The same byte format drives libFuzzer (tools/fuzz_containment.cpp) and
+ * the deterministic seed corpus run by the native tests.
+ *
+ * Host only (std::vector); not part of the firmware.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef CONTAINMENT_FUZZ_H
+#define CONTAINMENT_FUZZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "../point_in_polygon/point_in_polygon.h"
+
+// ============================================
+// CONSTANTS
+// ============================================
+
+// Float ulps either side of an edge where either answer is accepted
+constexpr double CONTAINMENT_BAND_ULPS = 8.0;
+
+// Polygon size and points per input
+constexpr size_t CONTAINMENT_MAX_VERTICES = 64;
+constexpr size_t CONTAINMENT_MAX_POINTS = 256;
+
+// ============================================
+// TYPES
+// ============================================
+
+enum class ContainmentTruth : uint8_t {
+    OUTSIDE,
+    INSIDE,
+    UNCERTAIN       ///< On or within rounding of an edge
+};
+
+/**
+ * @brief A containment kernel under test, with the pointInPolygon() signature.
+ */
+typedef bool (*ContainmentKernel)(const GeoPoint& point, const GeoPoint* vertices, size_t count);
+
+struct ContainmentKernelInfo {
+    const char* name;
+    const char* call;           ///< printf format of a call, given the vertex count
+    ContainmentKernel kernel;
+};
+
+/**
+ * @brief A polygon and the points to test against it.
+ */
+struct ContainmentCase {
+    std::vector<GeoPoint> vertices;
+    std::vector<GeoPoint> points;
+};
+
+/**
+ * @brief A kernel disagreeing with the reference on one point.
+ */
+struct ContainmentMismatch {
+    const ContainmentKernelInfo* kernel;
+    std::vector<GeoPoint> vertices;
+    GeoPoint point;
+    bool got;                   ///< The kernel's answer; the reference says the opposite
+};
+
+// The kernels the firmware uses: Polygon::contains() and pointInPolygon()
+extern const ContainmentKernelInfo CONTAINMENT_KERNELS[];
+extern const size_t CONTAINMENT_KERNEL_COUNT;
+
+// ============================================
+// FUNCTIONS
+// ============================================
+
+/**
+ * @brief Even-odd containment in double precision.
+ *
+ * Uses the same half-open rule for edges at the point's latitude as the
+ * kernels, so a ray through a vertex is counted once.
+ */
+ContainmentTruth containmentReference(const GeoPoint& point, const GeoPoint* vertices, size_t count);
+
+/**
+ * @brief Build a case from fuzzer bytes.
+ *
+ * Header: vertex count, grid step, centre. Then 3 bytes per vertex (grid
+ * offsets and ulp nudges) and 3 bytes per point (kind and arguments: grid
+ * point, vertex, nudged vertex, vertex latitude, edge midpoint). The
+ * coarse grid makes shared latitudes, collinear and repeated vertices
+ * common.
+ *
+ * @return false if there are too few bytes for a polygon and a point.
+ */
+bool containmentDecode(const uint8_t* data, size_t size, ContainmentCase& out);
+
+/**
+ * @brief Seed corpus input number seed (replaced into out).
+ *
+ * Cycles through star polygons, rectilinear combs, random (usually
+ * self-intersecting) polygons and needles on a sub-ulp grid.
+ */
+void containmentSeed(uint32_t seed, std::vector<uint8_t>& out);
+
+/**
+ * @brief Check every point of a case with every kernel.
+ *
+ * @param mismatch Receives the first disagreement.
+ * @return false on a disagreement.
+ */
+bool containmentCheck(const ContainmentCase& testCase, const ContainmentKernelInfo* kernels, size_t kernelCount,
+                      ContainmentMismatch& mismatch);
+
+/**
+ * @brief Shrink a disagreement while it still reproduces.
+ *
+ * Drops vertices one at a time, then rounds coordinates to as few
+ * decimals as still fail.
+ */
+void containmentMinimize(ContainmentMismatch& mismatch);
+
+/**
+ * @brief Print a disagreement as a ready-to-paste Unity test body.
+ *
+ * Coordinates are printed with 9 significant digits, which round-trip
+ * exactly through float.
+ *
+ * @return Length written (snprintf semantics).
+ */
+size_t containmentFormat(const ContainmentMismatch& mismatch, char* buffer, size_t size);
+
+/**
+ * @brief One fuzzer input against the firmware kernels.
+ *
+ * @param mismatch Receives the minimized disagreement.
+ * @return false on a disagreement; true otherwise, including for inputs
+ *         too short to decode.
+ */
+bool containmentFuzzOne(const uint8_t* data, size_t size, ContainmentMismatch& mismatch);
+
+#endif // CONTAINMENT_FUZZ_H
@@ -0,0 +1,283 @@
+/**
+ * @file dwell_map.cpp
+ * @brief Implementation of the incremental dwell map.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "dwell_map.h"
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+// floor(value / 2^shift), also for negative values
+static int32_t floorShift(int32_t value, int shift) {
+    return value >= 0 ? value >> shift : ~(~value >> shift);
+}
+
+static uint64_t tileKey(int32_t tileLat, int32_t tileLon) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(tileLat)) << 32) | static_cast<uint32_t>(tileLon);
+}
+
+static int cellShift(uint8_t level) {
+    return DWELL_CELL_SHIFT + level;
+}
+
+// ============================================================================
+// DwellMap Class Implementation
+// ============================================================================
+
+DwellMap::DwellMap(const Polygon* fences, size_t fenceCount, uint32_t maxGapSeconds)
+    : _fences(fences)
+    , _fenceCount(fenceCount < DWELL_MAX_FENCES ? fenceCount : DWELL_MAX_FENCES)
+    , _maxGapSeconds(maxGapSeconds)
+{
+}
+
+int32_t DwellMap::cellSizeE6(uint8_t level) {
+    return static_cast<int32_t>(1) << cellShift(level);
+}
+
+uint32_t DwellMap::insideMask(const PositionFix& fix) const {
+    GeoPoint point = {e6ToDegrees(fix.latE6), e6ToDegrees(fix.lonE6)};
+    uint32_t mask = 0;
+    for (size_t f = 0; f < _fenceCount; f++) {
+        if (_fences[f].contains(point)) {
+            mask |= 1u << f;
+        }
+    }
+    return mask;
+}
+
+// The collar clock can restart, which counts as no time
+uint32_t DwellMap::gapSeconds(uint32_t from, uint32_t to) const {
+    if (to < from) {
+        return 0;
+    }
+    return to - from < _maxGapSeconds ? to - from : _maxGapSeconds;
+}
+
+const DwellMap::CollarState* DwellMap::findCollar(uint32_t collarId) const {
+    std::unordered_map<uint32_t, CollarState>::const_iterator it = _collars.find(collarId);
+    return it != _collars.end() ? &it->second : nullptr;
+}
+
+DwellCell* DwellMap::cellFor(CollarState& collar, uint8_t level, const PositionFix& fix) {
+    int32_t latCell = floorShift(fix.latE6, cellShift(level));
+    int32_t lonCell = floorShift(fix.lonE6, cellShift(level));
+    // operator[] value-initializes new tiles: all cells zero
+    DwellTile& tile = collar.levels[level][tileKey(floorShift(latCell, DWELL_TILE_SHIFT),
+                                                   floorShift(lonCell, DWELL_TILE_SHIFT))];
+    return &tile.cells[(latCell & (DWELL_TILE_SIZE - 1)) * DWELL_TILE_SIZE + (lonCell & (DWELL_TILE_SIZE - 1))];
+}
+
+void DwellMap::cellsFor(CollarState& collar, const PositionFix& fix, DwellCell** cells) {
+    for (uint8_t level = 0; level < DWELL_LEVELS; level++) {
+        cells[level] = cellFor(collar, level, fix);
+    }
+}
+
+void DwellMap::credit(CollarState& collar, DwellCell* const* cells, uint32_t mask, uint32_t seconds) {
+    if (seconds == 0) {
+        return;
+    }
+    for (uint8_t level = 0; level < DWELL_LEVELS; level++) {
+        cells[level]->seconds += seconds;
+    }
+    for (size_t f = 0; f < _fenceCount; f++) {
+        if (mask & (1u << f)) {
+            collar.fenceSeconds[f] += seconds;
+        }
+    }
+    collar.totals.seconds += seconds;
+}
+
+void DwellMap::add(uint32_t collarId, const PositionFix& fix) {
+    CollarState& collar = _collars[collarId];
+    uint32_t mask = insideMask(fix);
+
+    if (!collar.started) {
+        collar.started = true;
+        collar.first = fix;
+        collar.firstMask = mask;
+        cellsFor(collar, fix, collar.lastCells);
+    } else {
+        // The previous fix dwelt until this one
+        credit(collar, collar.lastCells, collar.lastMask, gapSeconds(collar.last.timestamp, fix.timestamp));
+
+        // Cells nest: once a level's cell is unchanged, so are all above it
+        for (uint8_t level = 0; level < DWELL_LEVELS; level++) {
+            int shift = cellShift(level);
+            if (floorShift(fix.latE6, shift) == floorShift(collar.last.latE6, shift) &&
+                floorShift(fix.lonE6, shift) == floorShift(collar.last.lonE6, shift)) {
+                break;
+            }
+            collar.lastCells[level] = cellFor(collar, level, fix);
+        }
+    }
+
+    for (uint8_t level = 0; level < DWELL_LEVELS; level++) {
+        collar.lastCells[level]->fixes++;
+    }
+    collar.last = fix;
+    collar.lastMask = mask;
+    collar.totals.fixes++;
+}
+
+bool DwellMap::merge(const DwellMap& other) {
+    if (&other == this || other._fences != _fences || other._fenceCount != _fenceCount ||
+        other._maxGapSeconds != _maxGapSeconds) {
+        return false;
+    }
+
+    for (std::unordered_map<uint32_t, CollarState>::const_iterator it = other._collars.begin();
+         it != other._collars.end(); ++it) {
+        const CollarState& theirs = it->second;
+        if (!theirs.started) {
+            continue;
+        }
+        CollarState& ours = _collars[it->first];
+
+        for (uint8_t level = 0; level < DWELL_LEVELS; level++) {
+            for (TileMap::const_iterator tile = theirs.levels[level].begin();
+                 tile != theirs.levels[level].end(); ++tile) {
+                DwellTile& target = ours.levels[level][tile->first];
+                for (int i = 0; i < DWELL_TILE_SIZE * DWELL_TILE_SIZE; i++) {
+                    target.cells[i].fixes += tile->second.cells[i].fixes;
+                    target.cells[i].seconds += tile->second.cells[i].seconds;
+                }
+            }
+        }
+        for (size_t f = 0; f < _fenceCount; f++) {
+            ours.fenceSeconds[f] += theirs.fenceSeconds[f];
+        }
+        ours.totals.fixes += theirs.totals.fixes;
+        ours.totals.seconds += theirs.totals.seconds;
+
+        if (!ours.started) {
+            ours.started = true;
+            ours.first = theirs.first;
+            ours.firstMask = theirs.firstMask;
+            ours.last = theirs.last;
+            ours.lastMask = theirs.lastMask;
+            cellsFor(ours, ours.last, ours.lastCells);
+        } else if (ours.last.timestamp <= theirs.first.timestamp) {
+            // Theirs follows ours: our last fix dwelt until their first
+            credit(ours, ours.lastCells, ours.lastMask, gapSeconds(ours.last.timestamp, theirs.first.timestamp));
+            ours.last = theirs.last;
+            ours.lastMask = theirs.lastMask;
+            cellsFor(ours, ours.last, ours.lastCells);
+        } else if (theirs.last.timestamp <= ours.first.timestamp) {
+            // Theirs precedes ours: their last fix dwelt until our first
+            DwellCell* cells[DWELL_LEVELS];
+            cellsFor(ours, theirs.last, cells);
+            credit(ours, cells, theirs.lastMask, gapSeconds(theirs.last.timestamp, ours.first.timestamp));
+            ours.first = theirs.first;
+            ours.firstMask = theirs.firstMask;
+        }
+        // Overlapping stretches have no single gap to credit: totals only
+    }
+    return true;
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+DwellCell DwellMap::cell(uint32_t collarId, uint8_t level, int32_t latE6, int32_t lonE6) const {
+    DwellCell empty = {0, 0};
+    const CollarState* collar = findCollar(collarId);
+    if (collar == nullptr || level >= DWELL_LEVELS) {
+        return empty;
+    }
+    int32_t latCell = floorShift(latE6, cellShift(level));
+    int32_t lonCell = floorShift(lonE6, cellShift(level));
+    TileMap::const_iterator tile = collar->levels[level].find(
+        tileKey(floorShift(latCell, DWELL_TILE_SHIFT), floorShift(lonCell, DWELL_TILE_SHIFT)));
+    if (tile == collar->levels[level].end()) {
+        return empty;
+    }
+    return tile->second.cells[(latCell & (DWELL_TILE_SIZE - 1)) * DWELL_TILE_SIZE +
+                              (lonCell & (DWELL_TILE_SIZE - 1))];
+}
+
+size_t DwellMap::heatmap(uint32_t collarId, uint8_t level, int32_t minLatE6, int32_t minLonE6,
+                         int32_t maxLatE6, int32_t maxLonE6, std::vector<DwellHeatCell>& out) const {
+    const CollarState* collar = findCollar(collarId);
+    if (collar == nullptr || level >= DWELL_LEVELS || minLatE6 > maxLatE6 || minLonE6 > maxLonE6) {
+        return 0;
+    }
+    const TileMap& tiles = collar->levels[level];
+    int shift = cellShift(level);
+    int32_t cellSize = cellSizeE6(level);
+    int32_t latLow = floorShift(minLatE6, shift);
+    int32_t latHigh = floorShift(maxLatE6, shift);
+    int32_t lonLow = floorShift(minLonE6, shift);
+    int32_t lonHigh = floorShift(maxLonE6, shift);
+    size_t before = out.size();
+
+    // Look the box's tiles up, or walk the collar's tiles if there are fewer
+    int32_t tileLatLow = floorShift(latLow, DWELL_TILE_SHIFT);
+    int32_t tileLonLow = floorShift(lonLow, DWELL_TILE_SHIFT);
+    uint64_t boxTiles = static_cast<uint64_t>(floorShift(latHigh, DWELL_TILE_SHIFT) - tileLatLow + 1) *
+                        static_cast<uint64_t>(floorShift(lonHigh, DWELL_TILE_SHIFT) - tileLonLow + 1);
+    std::vector<std::pair<uint64_t, const DwellTile*> > visit;
+    if (boxTiles <= tiles.size()) {
+        for (int32_t tileLat = tileLatLow; tileLat <= floorShift(latHigh, DWELL_TILE_SHIFT); tileLat++) {
+            for (int32_t tileLon = tileLonLow; tileLon <= floorShift(lonHigh, DWELL_TILE_SHIFT); tileLon++) {
+                TileMap::const_iterator it = tiles.find(tileKey(tileLat, tileLon));
+                if (it != tiles.end()) {
+                    visit.push_back(std::make_pair(it->first, &it->second));
+                }
+            }
+        }
+    } else {
+        for (TileMap::const_iterator it = tiles.begin(); it != tiles.end(); ++it) {
+            visit.push_back(std::make_pair(it->first, &it->second));
+        }
+    }
+
+    for (size_t t = 0; t < visit.size(); t++) {
+        int32_t tileLat = static_cast<int32_t>(static_cast<uint32_t>(visit[t].first >> 32));
+        int32_t tileLon = static_cast<int32_t>(static_cast<uint32_t>(visit[t].first));
+        for (int row = 0; row < DWELL_TILE_SIZE; row++) {
+            int32_t latCell = tileLat * DWELL_TILE_SIZE + row;
+            if (latCell < latLow || latCell > latHigh) {
+                continue;
+            }
+            for (int col = 0; col < DWELL_TILE_SIZE; col++) {
+                int32_t lonCell = tileLon * DWELL_TILE_SIZE + col;
+                const DwellCell& value = visit[t].second->cells[row * DWELL_TILE_SIZE + col];
+                if (lonCell < lonLow || lonCell > lonHigh || (value.fixes == 0 && value.seconds == 0)) {
+                    continue;
+                }
+                DwellHeatCell heat = {latCell * cellSize, lonCell * cellSize, value};
+                out.push_back(heat);
+            }
+        }
+    }
+    return out.size() - before;
+}
+
+uint64_t DwellMap::fenceSeconds(uint32_t collarId, size_t fence) const {
+    const CollarState* collar = findCollar(collarId);
+    return collar != nullptr && fence < _fenceCount ? collar->fenceSeconds[fence] : 0;
+}
+
+DwellTotals DwellMap::totals(uint32_t collarId) const {
+    DwellTotals empty = {0, 0};
+    const CollarState* collar = findCollar(collarId);
+    return collar != nullptr ? collar->totals : empty;
+}
+
+size_t DwellMap::tileCount() const {
+    size_t count = 0;
+    for (std::unordered_map<uint32_t, CollarState>::const_iterator it = _collars.begin();
+         it != _collars.end(); ++it) {
+        for (uint8_t level = 0; level < DWELL_LEVELS; level++) {
+            count += it->second.levels[level].size();
+        }
+    }
+    return count;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file dwell_map.h
+ * @brief Incremental per-collar heatmaps and fence dwell times.
+ *
+ * Answers "where does the dog spend its time?" without rescanning the
+ * track history: every fix updates running totals as it arrives.
+ *
+ *  - Occupancy grids: per collar, fixes and dwell seconds per cell, at
+ *    DWELL_LEVELS zoom levels. Level 0 cells are 64 microdegrees (about
+ *    7 m); each level up doubles the cell size, up to about 3.6 km. All
+ *    levels are kept up to date, so a zoomed-out heatmap is read, not
+ *    summed. Cells are stored in 16 x 16 tiles, created only where the
+ *    dog has been.
+ *  - Fence dwell: per collar, seconds spent inside each fence, tested
+ *    with the same Polygon code the collar runs.
+ *
+ * A fix is credited with the time until the next fix, capped at
+ * maxGapSeconds so a collar that went quiet does not "dwell" for hours.
+ * The cells of the last fix are cached, so a resting dog costs no table
+ * lookups: each fix is a fixed amount of work, however long the history.
+ *
+ * Maps built on separate threads, for different collars or for
+ * consecutive stretches of the same tracks, merge into the map a single
+ * pass would have built, including the time across stretch boundaries.
+ *
+ * Host only (std::unordered_map); runs on the base station.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef DWELL_MAP_H
+#define DWELL_MAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include "../point_in_polygon/point_in_polygon.h"
+#include "../position_codec/position_codec.h"
+
+// ============================================
+// CONSTANTS
+// ============================================
+
+// Fence membership of a fix is kept as a bitmask
+constexpr size_t DWELL_MAX_FENCES = 32;
+
+// Zoom levels; level 0 cells are 1 << DWELL_CELL_SHIFT microdegrees
+constexpr uint8_t DWELL_LEVELS = 10;
+constexpr int DWELL_CELL_SHIFT = 6;
+
+// Cells per tile side
+constexpr int DWELL_TILE_SHIFT = 4;
+constexpr int DWELL_TILE_SIZE = 1 << DWELL_TILE_SHIFT;
+
+// Default cap on the time credited to one fix
+constexpr uint32_t DWELL_DEFAULT_MAX_GAP_SEC = 300;
+
+// ============================================
+// TYPES
+// ============================================
+
+struct DwellCell {
+    uint32_t fixes;
+    uint32_t seconds;
+};
+
+/**
+ * @brief One non-empty cell of a heatmap.
+ */
+struct DwellHeatCell {
+    int32_t latE6;          ///< South-west corner of the cell
+    int32_t lonE6;
+    DwellCell value;
+};
+
+/**
+ * @brief Whole-history totals of one collar.
+ */
+struct DwellTotals {
+    uint64_t fixes;
+    uint64_t seconds;
+};
+
+// ============================================
+// DWELL MAP CLASS
+// ============================================
+
+class DwellMap {
+public:
+    /**
+     * @param fences        Fences to accumulate dwell for (must stay valid).
+     * @param fenceCount    Number of fences, at most DWELL_MAX_FENCES.
+     * @param maxGapSeconds Most time credited to one fix.
+     */
+    DwellMap(const Polygon* fences, size_t fenceCount,
+             uint32_t maxGapSeconds = DWELL_DEFAULT_MAX_GAP_SEC);
+
+    DwellMap(const DwellMap&) = delete;
+    DwellMap& operator=(const DwellMap&) = delete;
+
+    /**
+     * @brief Add one fix of a collar.
+     *
+     * Fixes of a collar should arrive in time order; one older than the
+     * previous fix is counted but credited no time.
+     */
+    void add(uint32_t collarId, const PositionFix& fix);
+
+    /**
+     * @brief Add another map's totals into this one.
+     *
+     * Where both maps hold the same collar over adjacent stretches of
+     * time, the gap between the stretches is credited as a single pass
+     * would have. Merge stretches so each one borders what is already
+     * merged; between non-adjacent ones the wrong gap would be credited.
+     *
+     * @return false if the maps were built with different fences or gap
+     *         caps, or other is this map.
+     */
+    bool merge(const DwellMap& other);
+
+    /**
+     * @brief Totals of the cell holding a position.
+     */
+    DwellCell cell(uint32_t collarId, uint8_t level, int32_t latE6, int32_t lonE6) const;
+
+    /**
+     * @brief Append the non-empty cells overlapping a box.
+     *
+     * @param level Zoom level, 0..DWELL_LEVELS-1.
+     * @return Number of cells appended.
+     */
+    size_t heatmap(uint32_t collarId, uint8_t level, int32_t minLatE6, int32_t minLonE6,
+                   int32_t maxLatE6, int32_t maxLonE6, std::vector<DwellHeatCell>& out) const;
+
+    /**
+     * @brief Seconds a collar has spent inside a fence.
+     */
+    uint64_t fenceSeconds(uint32_t collarId, size_t fence) const;
+
+    DwellTotals totals(uint32_t collarId) const;
+
+    size_t collarCount() const { return _collars.size(); }
+
+    /**
+     * @brief Tiles allocated, over all collars and levels (memory use).
+     */
+    size_t tileCount() const;
+
+    /**
+     * @brief Cell size of a level in microdegrees.
+     */
+    static int32_t cellSizeE6(uint8_t level);
+
+private:
+    struct DwellTile {
+        DwellCell cells[DWELL_TILE_SIZE * DWELL_TILE_SIZE];
+    };
+
+    typedef std::unordered_map<uint64_t, DwellTile> TileMap;
+
+    struct CollarState {
+        bool started;
+        PositionFix first;
+        PositionFix last;
+        uint32_t firstMask;
+        uint32_t lastMask;
+        DwellTotals totals;
+        uint64_t fenceSeconds[DWELL_MAX_FENCES];
+        TileMap levels[DWELL_LEVELS];
+        DwellCell* lastCells[DWELL_LEVELS];     ///< Cells of last, one per level
+    };
+
+    const Polygon* _fences;
+    size_t _fenceCount;
+    uint32_t _maxGapSeconds;
+    std::unordered_map<uint32_t, CollarState> _collars;
+
+    uint32_t insideMask(const PositionFix& fix) const;
+    uint32_t gapSeconds(uint32_t from, uint32_t to) const;
+    const CollarState* findCollar(uint32_t collarId) const;
+    void credit(CollarState& collar, DwellCell* const* cells, uint32_t mask, uint32_t seconds);
+    static DwellCell* cellFor(CollarState& collar, uint8_t level, const PositionFix& fix);
+    static void cellsFor(CollarState& collar, const PositionFix& fix, DwellCell** cells);
+};
+
+#endif // DWELL_MAP_H
@@ -0,0 +1,145 @@
+/**
+ * @file energy_model.cpp
+ * @brief Implementation of the per-peripheral current model.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "energy_model.h"
+
+#include <string.h>
+
+// ============================================================================
+// Config Field Table
+// ============================================================================
+
+struct EnergyModelField {
+    const char* name;
+    float EnergyModelConfig::*field;
+};
+
+static const EnergyModelField ENERGY_MODEL_FIELDS[] = {
+    {"socActiveMa", &EnergyModelConfig::socActiveMa},
+    {"socLightSleepMa", &EnergyModelConfig::socLightSleepMa},
+    {"socDeepSleepMa", &EnergyModelConfig::socDeepSleepMa},
+    {"gpsAcquiringMa", &EnergyModelConfig::gpsAcquiringMa},
+    {"gpsTrackingMa", &EnergyModelConfig::gpsTrackingMa},
+    {"gpsStandbyMa", &EnergyModelConfig::gpsStandbyMa},
+    {"radioTxMa", &EnergyModelConfig::radioTxMa},
+    {"radioRxMa", &EnergyModelConfig::radioRxMa},
+    {"radioStandbyMa", &EnergyModelConfig::radioStandbyMa},
+    {"radioSleepMa", &EnergyModelConfig::radioSleepMa},
+    {"beeperMa", &EnergyModelConfig::beeperMa},
+    {"vibrationMa", &EnergyModelConfig::vibrationMa},
+    {"boardMa", &EnergyModelConfig::boardMa},
+};
+
+static const char* const ENERGY_RAIL_NAMES[ENERGY_RAIL_COUNT] = {
+    "soc", "gps", "radio", "alert", "board"
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+float energyRailCurrentMa(const EnergyModelConfig& config, const PowerStates& states,
+                          EnergyRail rail) {
+    switch (rail) {
+        case ENERGY_RAIL_SOC:
+            switch (states.soc) {
+                case SocPower::ACTIVE:
+                    return config.socActiveMa;
+                case SocPower::LIGHT_SLEEP:
+                    return config.socLightSleepMa;
+                case SocPower::DEEP_SLEEP:
+                    return config.socDeepSleepMa;
+            }
+            break;
+        case ENERGY_RAIL_GPS:
+            switch (states.gps) {
+                case GpsPower::ACQUIRING:
+                    return config.gpsAcquiringMa;
+                case GpsPower::TRACKING:
+                    return config.gpsTrackingMa;
+                case GpsPower::STANDBY:
+                    return config.gpsStandbyMa;
+                case GpsPower::OFF:
+                    return 0.0f;
+            }
+            break;
+        case ENERGY_RAIL_RADIO:
+            switch (states.radio) {
+                case RadioPower::SLEEP:
+                    return config.radioSleepMa;
+                case RadioPower::STANDBY:
+                    return config.radioStandbyMa;
+                case RadioPower::RX:
+                    return config.radioRxMa;
+                case RadioPower::TX:
+                    return config.radioTxMa;
+            }
+            break;
+        case ENERGY_RAIL_ALERT:
+            return (config.beeperMa * states.beeperPercent +
+                    config.vibrationMa * states.vibrationPercent) / 100.0f;
+        case ENERGY_RAIL_BOARD:
+            return config.boardMa;
+        case ENERGY_RAIL_COUNT:
+            break;
+    }
+    return 0.0f;
+}
+
+float energyCurrentMa(const EnergyModelConfig& config, const PowerStates& states) {
+    float total = 0.0f;
+    for (uint8_t rail = 0; rail < ENERGY_RAIL_COUNT; rail++) {
+        total += energyRailCurrentMa(config, states, static_cast<EnergyRail>(rail));
+    }
+    return total;
+}
+
+void energyAccumulate(EnergyTotals& totals, const EnergyModelConfig& config,
+                      const PowerStates& states, uint64_t durationUs) {
+    double seconds = static_cast<double>(durationUs) / 1e6;
+    for (uint8_t rail = 0; rail < ENERGY_RAIL_COUNT; rail++) {
+        totals.chargeMas[rail] += energyRailCurrentMa(config, states, static_cast<EnergyRail>(rail)) * seconds;
+    }
+    totals.elapsedUs += durationUs;
+    totals.socUs[static_cast<uint8_t>(states.soc)] += durationUs;
+}
+
+double energyTotalMah(const EnergyTotals& totals) {
+    double total = 0.0;
+    for (uint8_t rail = 0; rail < ENERGY_RAIL_COUNT; rail++) {
+        total += totals.chargeMas[rail];
+    }
+    return total / 3600.0;
+}
+
+double energyAverageMa(const EnergyTotals& totals) {
+    if (totals.elapsedUs == 0) {
+        return 0.0;
+    }
+    return energyTotalMah(totals) * 3600.0 / (static_cast<double>(totals.elapsedUs) / 1e6);
+}
+
+double energyMahPerDay(const EnergyTotals& totals) {
+    return energyAverageMa(totals) * 24.0;
+}
+
+bool energyModelSet(EnergyModelConfig& config, const char* name, float valueMa) {
+    if (name == nullptr || valueMa < 0.0f) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(ENERGY_MODEL_FIELDS) / sizeof(ENERGY_MODEL_FIELDS[0]); i++) {
+        if (strcmp(ENERGY_MODEL_FIELDS[i].name, name) == 0) {
+            config.*ENERGY_MODEL_FIELDS[i].field = valueMa;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* energyRailName(EnergyRail rail) {
+    return rail < ENERGY_RAIL_COUNT ? ENERGY_RAIL_NAMES[rail] : "?";
+}
@@ -0,0 +1,166 @@
+/**
+ * @file energy_model.h
+ * @brief Per-peripheral current model for estimating battery use.
+ *
+ * Each power consumer (SoC, GPS, radio, beeper and vibration motor, board
+ * overhead) is in one of a few power states at any time. The model gives
+ * a current for every state; integrating it over time in the state the
+ * hardware was actually in gives the charge drawn, per rail, and from
+ * that an average current and mAh per day.
+ *
+ * Used by the wake-cycle simulator (tools/wake_sim) to compare power
+ * optimizations against recorded walks. The default currents are typical
+ * datasheet values; replace them with measurements of a real collar.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef ENERGY_MODEL_H
+#define ENERGY_MODEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================
+// TYPES
+// ============================================
+
+enum class SocPower : uint8_t {
+    ACTIVE,         ///< CPU running (or idling in FreeRTOS)
+    LIGHT_SLEEP,
+    DEEP_SLEEP
+};
+
+enum class GpsPower : uint8_t {
+    ACQUIRING,      ///< Awake, no fix yet
+    TRACKING,       ///< Awake with a fix
+    STANDBY,        ///< PMTK161 standby
+    OFF
+};
+
+enum class RadioPower : uint8_t {
+    SLEEP,
+    STANDBY,
+    RX,
+    TX
+};
+
+/**
+ * @brief Rails the charge is reported on.
+ */
+enum EnergyRail : uint8_t {
+    ENERGY_RAIL_SOC,
+    ENERGY_RAIL_GPS,
+    ENERGY_RAIL_RADIO,
+    ENERGY_RAIL_ALERT,      ///< Beeper and vibration motor
+    ENERGY_RAIL_BOARD,      ///< Regulator quiescent current and other fixed loads
+    ENERGY_RAIL_COUNT
+};
+
+/**
+ * @brief What every consumer is doing right now.
+ */
+struct PowerStates {
+    SocPower soc;
+    GpsPower gps;
+    RadioPower radio;
+    uint8_t beeperPercent;      ///< Beeper drive, 100 = full volume
+    uint8_t vibrationPercent;   ///< Vibration motor drive
+};
+
+/**
+ * @brief Current per power state, in mA.
+ */
+struct EnergyModelConfig {
+    float socActiveMa;
+    float socLightSleepMa;
+    float socDeepSleepMa;
+    float gpsAcquiringMa;
+    float gpsTrackingMa;
+    float gpsStandbyMa;
+    float radioTxMa;
+    float radioRxMa;
+    float radioStandbyMa;
+    float radioSleepMa;
+    float beeperMa;             ///< At full volume
+    float vibrationMa;          ///< At full drive
+    float boardMa;              ///< Always drawn
+};
+
+// ESP32-S3 at 240 MHz, PA1010D, RFM95W at +17 dBm (PA_BOOST), 12 mm
+// piezo, coin vibration motor, LDO quiescent current
+constexpr EnergyModelConfig DEFAULT_ENERGY_MODEL_CONFIG = {
+    45.0f,      // socActiveMa
+    0.25f,      // socLightSleepMa
+    0.01f,      // socDeepSleepMa
+    27.0f,      // gpsAcquiringMa
+    23.0f,      // gpsTrackingMa
+    1.0f,       // gpsStandbyMa
+    87.0f,      // radioTxMa
+    10.8f,      // radioRxMa
+    1.6f,       // radioStandbyMa
+    0.0002f,    // radioSleepMa
+    8.0f,       // beeperMa
+    70.0f,      // vibrationMa
+    0.055f      // boardMa
+};
+
+/**
+ * @brief Accumulated charge and time.
+ *
+ * Zero-initialized totals are empty.
+ */
+struct EnergyTotals {
+    double chargeMas[ENERGY_RAIL_COUNT];   ///< Charge per rail, mA*s
+    uint64_t elapsedUs;
+    uint64_t socUs[3];                     ///< Time per SocPower state
+};
+
+// ============================================
+// FUNCTIONS
+// ============================================
+
+/**
+ * @brief Current drawn on one rail in the given states, in mA.
+ */
+float energyRailCurrentMa(const EnergyModelConfig& config, const PowerStates& states,
+                          EnergyRail rail);
+
+/**
+ * @brief Total current drawn in the given states, in mA.
+ */
+float energyCurrentMa(const EnergyModelConfig& config, const PowerStates& states);
+
+/**
+ * @brief Add durationUs spent in the given states.
+ */
+void energyAccumulate(EnergyTotals& totals, const EnergyModelConfig& config,
+                      const PowerStates& states, uint64_t durationUs);
+
+/**
+ * @brief Total charge over all rails, in mAh.
+ */
+double energyTotalMah(const EnergyTotals& totals);
+
+/**
+ * @brief Average current over the accumulated time, in mA (0 if empty).
+ */
+double energyAverageMa(const EnergyTotals& totals);
+
+/**
+ * @brief Charge per day at the average current, in mAh.
+ */
+double energyMahPerDay(const EnergyTotals& totals);
+
+/**
+ * @brief Set a config field by name (e.g. "gpsStandbyMa").
+ * @return false if the name is unknown.
+ */
+bool energyModelSet(EnergyModelConfig& config, const char* name, float valueMa);
+
+/**
+ * @brief Short rail name for reports ("soc", "gps", ...).
+ */
+const char* energyRailName(EnergyRail rail);
+
+#endif // ENERGY_MODEL_H
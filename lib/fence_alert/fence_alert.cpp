@@ -0,0 +1,114 @@
+/**
+ * @file fence_alert.cpp
+ * @brief Implementation of the boundary-crossing alert state machine.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "fence_alert.h"
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+/**
+ * @brief Escalation level for the time spent outside since confirmation.
+ */
+static uint8_t escalationFor(const FenceAlertConfig& config, uint32_t outsideSec) {
+    uint32_t level = 1;
+    if (config.escalationIntervalSec > 0) {
+        level += outsideSec / config.escalationIntervalSec;
+    }
+
+    uint8_t maxLevel = config.maxEscalationLevel > 0 ? config.maxEscalationLevel : 1;
+    return level > maxLevel ? maxLevel : static_cast<uint8_t>(level);
+}
+
+/**
+ * @brief Re-evaluate escalation while confirmed outside.
+ */
+static FenceAlertEvent updateEscalation(FenceAlertContext& ctx,
+                                        const FenceAlertConfig& config,
+                                        uint32_t nowSec) {
+    uint8_t level = escalationFor(config, nowSec - ctx.outsideSinceSec);
+    if (level > ctx.escalationLevel) {
+        ctx.escalationLevel = level;
+        return FenceAlertEvent::ESCALATED;
+    }
+    return FenceAlertEvent::NONE;
+}
+
+// ============================================================================
+// State Machine
+// ============================================================================
+
+void fenceAlertReset(FenceAlertContext& ctx) {
+    ctx.state = FenceAlertState::INSIDE;
+    ctx.escalationLevel = 0;
+    ctx.pendingSinceSec = 0;
+    ctx.outsideSinceSec = 0;
+}
+
+FenceAlertEvent fenceAlertUpdate(FenceAlertContext& ctx,
+                                 const FenceAlertConfig& config,
+                                 float signedDistanceM,
+                                 uint32_t nowSec) {
+    // Beyond the outer margin: clearly outside. Beyond the inner margin:
+    // clearly inside. Anything in between is the hysteresis band and never
+    // starts a new transition.
+    bool clearlyOutside = signedDistanceM < -config.outerMarginM;
+    bool clearlyInside = signedDistanceM > config.innerMarginM;
+
+    switch (ctx.state) {
+        case FenceAlertState::INSIDE:
+            if (!clearlyOutside) {
+                return FenceAlertEvent::NONE;
+            }
+            ctx.state = FenceAlertState::EXIT_PENDING;
+            ctx.pendingSinceSec = nowSec;
+            // Falls through - a zero dwell time confirms immediately
+
+        case FenceAlertState::EXIT_PENDING:
+            if (!clearlyOutside) {
+                // Back within the band: treat the excursion as noise
+                ctx.state = FenceAlertState::INSIDE;
+                return FenceAlertEvent::NONE;
+            }
+            if (nowSec - ctx.pendingSinceSec < config.exitDwellSec) {
+                return FenceAlertEvent::NONE;
+            }
+            ctx.state = FenceAlertState::OUTSIDE;
+            ctx.outsideSinceSec = nowSec;
+            ctx.escalationLevel = 1;
+            return FenceAlertEvent::EXITED;
+
+        case FenceAlertState::OUTSIDE:
+            if (!clearlyInside) {
+                return updateEscalation(ctx, config, nowSec);
+            }
+            ctx.state = FenceAlertState::RETURN_PENDING;
+            ctx.pendingSinceSec = nowSec;
+            // Falls through
+
+        case FenceAlertState::RETURN_PENDING:
+            if (!clearlyInside) {
+                ctx.state = FenceAlertState::OUTSIDE;
+                return updateEscalation(ctx, config, nowSec);
+            }
+            if (nowSec - ctx.pendingSinceSec < config.returnDwellSec) {
+                return FenceAlertEvent::NONE;
+            }
+            ctx.state = FenceAlertState::INSIDE;
+            ctx.escalationLevel = 0;
+            return FenceAlertEvent::RETURNED;
+    }
+
+    // Corrupted state (e.g. uninitialized RTC memory): start over
+    fenceAlertReset(ctx);
+    return FenceAlertEvent::NONE;
+}
+
+bool fenceAlertIsOutside(const FenceAlertContext& ctx) {
+    return ctx.state == FenceAlertState::OUTSIDE ||
+           ctx.state == FenceAlertState::RETURN_PENDING;
+}
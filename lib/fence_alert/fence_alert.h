@@ -0,0 +1,113 @@
+/**
+ * @file fence_alert.h
+ * @brief Boundary-crossing alert state machine with hysteresis and dwell time.
+ *
+ * GPS noise of 3-5 m makes a dog standing near the fence flip between
+ * inside and outside on consecutive fixes. This state machine only reports
+ * a crossing once the dog is clearly past the fence (by a configurable
+ * margin) for a configurable dwell time, and escalates the alert level the
+ * longer the dog stays out.
+ *
+ * The state is a plain struct so the firmware can keep it in RTC memory
+ * across deep sleep. The logic is pure and has no Arduino dependencies.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef FENCE_ALERT_H
+#define FENCE_ALERT_H
+
+#include <stdint.h>
+
+// ============================================
+// TYPES
+// ============================================
+
+/**
+ * @brief Confirmed or pending alert state.
+ */
+enum class FenceAlertState : uint8_t {
+    INSIDE = 0,       ///< Confirmed inside the fence
+    EXIT_PENDING,     ///< Beyond the outer margin, waiting for dwell time
+    OUTSIDE,          ///< Confirmed outside the fence
+    RETURN_PENDING    ///< Beyond the inner margin, waiting for dwell time
+};
+
+/**
+ * @brief Transition reported by fenceAlertUpdate().
+ *
+ * Only confirmed changes are reported; pending states never emit events.
+ */
+enum class FenceAlertEvent : uint8_t {
+    NONE = 0,   ///< Nothing to act on
+    EXITED,     ///< Crossing out confirmed (escalation level 1)
+    ESCALATED,  ///< Still outside, escalation level increased
+    RETURNED    ///< Return inside confirmed
+};
+
+/**
+ * @brief Tunable thresholds for the state machine.
+ */
+struct FenceAlertConfig {
+    float innerMarginM;              ///< Distance inside the fence required to count as returned
+    float outerMarginM;              ///< Distance outside the fence required to count as exited
+    uint32_t exitDwellSec;           ///< Time beyond outer margin before an exit is confirmed
+    uint32_t returnDwellSec;         ///< Time beyond inner margin before a return is confirmed
+    uint32_t escalationIntervalSec;  ///< Time outside per additional escalation level
+    uint8_t maxEscalationLevel;      ///< Highest escalation level (>= 1)
+};
+
+// Defaults sized for 3-5 m GPS noise and a 5 s wake interval
+constexpr FenceAlertConfig DEFAULT_FENCE_ALERT_CONFIG = {
+    3.0f,   // innerMarginM
+    5.0f,   // outerMarginM
+    10,     // exitDwellSec
+    15,     // returnDwellSec
+    30,     // escalationIntervalSec
+    3       // maxEscalationLevel
+};
+
+/**
+ * @brief Persistent state (POD, safe to place in RTC memory).
+ *
+ * Zero-initialized state is a valid "confirmed inside" state.
+ */
+struct FenceAlertContext {
+    FenceAlertState state;        ///< Current state
+    uint8_t escalationLevel;      ///< 0 while inside, 1..max while outside
+    uint32_t pendingSinceSec;     ///< When the current pending condition began
+    uint32_t outsideSinceSec;     ///< When the current exit was confirmed
+};
+
+// ============================================
+// FUNCTIONS
+// ============================================
+
+/**
+ * @brief Reset the context to "confirmed inside".
+ */
+void fenceAlertReset(FenceAlertContext& ctx);
+
+/**
+ * @brief Feed one position fix into the state machine.
+ *
+ * @param ctx             Persistent context (updated in place).
+ * @param config          Thresholds to apply.
+ * @param signedDistanceM Distance to the fence in meters: positive inside,
+ *                        negative outside.
+ * @param nowSec          Monotonic time in seconds (must survive deep sleep).
+ * @return The confirmed transition, or FenceAlertEvent::NONE.
+ */
+FenceAlertEvent fenceAlertUpdate(FenceAlertContext& ctx,
+                                 const FenceAlertConfig& config,
+                                 float signedDistanceM,
+                                 uint32_t nowSec);
+
+/**
+ * @brief Check whether the context is in a confirmed-outside state.
+ *
+ * RETURN_PENDING still counts as outside: the return is not yet confirmed.
+ */
+bool fenceAlertIsOutside(const FenceAlertContext& ctx);
+
+#endif // FENCE_ALERT_H
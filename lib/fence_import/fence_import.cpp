@@ -0,0 +1,642 @@
+/**
+ * @file fence_import.cpp
+ * @brief Implementation of the streaming GeoJSON / KML fence importer.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "fence_import.h"
+#include <fcntl.h>
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include "../fence_store/fence_store.h"
+
+// Exact powers of ten for the usual coordinate precisions
+static const double POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool isNumberChar(char c) {
+    return isDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+static bool samePoint(const GeoPoint& a, const GeoPoint& b) {
+    return a.lat == b.lat && a.lon == b.lon;
+}
+
+static bool nameIs(const char* name, size_t length, const char* expected) {
+    return length == strlen(expected) && memcmp(name, expected, length) == 0;
+}
+
+// Tag name without its namespace prefix ("kml:Polygon" -> "Polygon")
+static bool tagIs(const char* name, size_t length, const char* expected) {
+    const char* colon = static_cast<const char*>(memchr(name, ':', length));
+    if (colon != nullptr) {
+        length -= static_cast<size_t>(colon + 1 - name);
+        name = colon + 1;
+    }
+    return nameIs(name, length, expected);
+}
+
+// ============================================================================
+// Ring Functions
+// ============================================================================
+
+bool fenceImportNormalize(std::vector<GeoPoint>& ring, bool& reversed) {
+    reversed = false;
+    ring.erase(std::unique(ring.begin(), ring.end(), samePoint), ring.end());
+    if (ring.size() > 1 && samePoint(ring.front(), ring.back())) {
+        ring.pop_back();
+    }
+    if (ring.size() < 3) {
+        return false;
+    }
+
+    // Shoelace with lon as x: positive is counter-clockwise
+    double area = 0.0;
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+        area += (static_cast<double>(ring[j].lon) - ring[i].lon) * (static_cast<double>(ring[j].lat) + ring[i].lat);
+    }
+    if (area == 0.0) {
+        return false;
+    }
+    if (area < 0.0) {
+        std::reverse(ring.begin(), ring.end());
+        reversed = true;
+    }
+    return true;
+}
+
+size_t fenceImportEncode(const ImportedFence& fence, uint32_t fenceId, std::vector<uint8_t>& out) {
+    size_t count = fence.vertices.size();
+    if (count > FENCE_STORE_MAX_VERTICES) {
+        out.clear();
+        return 0;
+    }
+    out.resize(fenceBlobSize(count));
+    size_t size = fenceBlobEncode(fence.vertices.data(), count, fenceId, out.data(), out.size());
+    out.resize(size);
+    return size;
+}
+
+bool fenceImportFile(const char* path, FenceImporter& importer) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    std::vector<char> buffer(FENCE_IMPORT_READ_SIZE);
+    bool ok = true;
+    for (;;) {
+        ssize_t got = read(fd, buffer.data(), buffer.size());
+        if (got <= 0) {
+            ok = got == 0;
+            break;
+        }
+        if (!importer.feed(buffer.data(), static_cast<size_t>(got))) {
+            break;
+        }
+    }
+    close(fd);
+    return importer.finish() && ok;
+}
+
+// ============================================================================
+// FenceImporter Class Implementation
+// ============================================================================
+
+FenceImporter::FenceImporter(FenceImportFormat format)
+    : _format(format)
+    , _lex(Lex::TEXT)
+    , _failed(false)
+    , _errorOffset(0)
+    , _stats()
+    , _tokenLength(0)
+    , _quote(0)
+    , _valueCount(0)
+    , _tupleOffset(0)
+    , _ringIsHole(false)
+    , _depth(0)
+    , _keyIsCoordinates(false)
+    , _expectCoordinates(false)
+    , _coordNesting(0)
+    , _leafDepth(0)
+    , _ringInPolygon(0)
+    , _polygonDepth(0)
+    , _innerDepth(0)
+    , _inCoordinates(false)
+    , _tupleBreak(false)
+    , _closingTag(false)
+    , _selfClosing(false)
+{
+}
+
+bool FenceImporter::feed(const char* data, size_t length) {
+    for (size_t i = 0; i < length && !_failed; i++) {
+        _errorOffset = _stats.bytes + i;
+        consume(data[i]);
+    }
+    _stats.bytes += length;
+    return !_failed;
+}
+
+bool FenceImporter::finish() {
+    if (_failed) {
+        return false;
+    }
+    _errorOffset = _stats.bytes;
+    if (_lex == Lex::NUMBER) {
+        consume(' ');       // End of input ends a number
+    }
+
+    bool complete = false;
+    if (_format == FenceImportFormat::GEOJSON) {
+        complete = _lex == Lex::TEXT && _depth == 0;
+    } else if (_format == FenceImportFormat::KML) {
+        complete = _lex == Lex::TEXT && !_inCoordinates;
+    }
+    if (!complete) {
+        fail();
+    }
+    return !_failed;
+}
+
+void FenceImporter::fail() {
+    _failed = true;
+}
+
+void FenceImporter::consume(char c) {
+    if (_format == FenceImportFormat::AUTO) {
+        // Skip leading whitespace and a UTF-8 byte order mark
+        if (isSpace(c) || c == '\xEF' || c == '\xBB' || c == '\xBF') {
+            return;
+        }
+        if (c == '{' || c == '[') {
+            _format = FenceImportFormat::GEOJSON;
+        } else if (c == '<') {
+            _format = FenceImportFormat::KML;
+        } else {
+            fail();
+            return;
+        }
+    }
+
+    if (_format == FenceImportFormat::GEOJSON) {
+        jsonChar(c);
+    } else {
+        kmlChar(c);
+    }
+}
+
+bool FenceImporter::parseNumber(double& value) {
+    const char* p = _token;
+    const char* end = _token + _tokenLength;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p++ == '-';
+    }
+
+    // Up to 19 significant digits in an integer, the rest as exponent
+    uint64_t mantissa = 0;
+    int significant = 0;
+    int exponent = 0;
+    bool digits = false;
+    for (; p < end && isDigit(*p); p++, digits = true) {
+        if (significant < 19) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            significant += mantissa > 0 ? 1 : 0;
+        } else {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && isDigit(*p); p++, digits = true) {
+            if (significant < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                significant += mantissa > 0 ? 1 : 0;
+                exponent--;
+            }
+        }
+    }
+    if (!digits) {
+        return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p++ == '-';
+        }
+        if (p == end) {
+            return false;
+        }
+        int e = 0;
+        for (; p < end && isDigit(*p); p++) {
+            e = std::min(e * 10 + (*p - '0'), 1000);
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+    if (p != end) {
+        return false;
+    }
+
+    value = static_cast<double>(mantissa);
+    if (exponent >= 0 && exponent <= 22) {
+        value *= POWERS_OF_TEN[exponent];
+    } else if (exponent < 0 && exponent >= -22) {
+        value /= POWERS_OF_TEN[-exponent];
+    } else {
+        value *= pow(10.0, exponent);
+    }
+    if (negative) {
+        value = -value;
+    }
+    return true;
+}
+
+void FenceImporter::beginRing(bool hole) {
+    _ring.clear();
+    _ringIsHole = hole;
+    _valueCount = 0;
+}
+
+void FenceImporter::endRing() {
+    if (_ringIsHole) {
+        _stats.holes++;
+    } else {
+        _stats.polygons++;
+        bool reversed;
+        if (fenceImportNormalize(_ring, reversed)) {
+            _fences.push_back(ImportedFence());
+            _fences.back().vertices.assign(_ring.begin(), _ring.end());
+            _fences.back().polygon = _stats.polygons - 1;
+            _stats.reversed += reversed ? 1 : 0;
+        } else {
+            _stats.degenerate++;
+        }
+    }
+    _ringInPolygon++;
+}
+
+// Projected exports (state plane, web mercator) are numbers in metres,
+// not degrees: refuse them rather than encode a fence the collar rejects
+bool FenceImporter::addPosition() {
+    double lon = _values[0];
+    double lat = _values[1];
+    if (!(fabs(lat) <= 90.0) || !(fabs(lon) <= 180.0)) {
+        _errorOffset = _tupleOffset;
+        fail();
+        return false;
+    }
+    GeoPoint point = {static_cast<float>(lat), static_cast<float>(lon)};
+    _ring.push_back(point);
+    return true;
+}
+
+// ============================================================================
+// GeoJSON
+// ============================================================================
+//
+// Only the nesting of "coordinates" values matters. Their first number
+// gives the depth of positions (2 for a LineString, 3 for a Polygon, 4
+// for a MultiPolygon); arrays one level up are rings, two up polygons.
+
+void FenceImporter::jsonChar(char c) {
+    switch (_lex) {
+        case Lex::STRING:
+            if (c == '\\') {
+                _lex = Lex::STRING_ESCAPE;
+            } else if (c == '"') {
+                _lex = Lex::TEXT;
+                _keyIsCoordinates = nameIs(_token, _tokenLength, "coordinates");
+            } else if (_tokenLength < FENCE_IMPORT_TOKEN_MAX) {
+                _token[_tokenLength++] = c;
+            }
+            return;
+
+        case Lex::STRING_ESCAPE:
+            _lex = Lex::STRING;
+            if (_tokenLength < FENCE_IMPORT_TOKEN_MAX) {
+                _token[_tokenLength++] = '\\';
+            }
+            return;
+
+        case Lex::NUMBER:
+            if (isNumberChar(c)) {
+                if (_tokenLength == FENCE_IMPORT_TOKEN_MAX) {
+                    fail();
+                    return;
+                }
+                _token[_tokenLength++] = c;
+                return;
+            }
+            _lex = Lex::TEXT;
+            double value;
+            if (!parseNumber(value)) {
+                fail();
+                return;
+            }
+            jsonNumber(value);
+            break;      // c ends the number; handle it below
+
+        default:
+            break;
+    }
+
+    if (isSpace(c)) {
+        return;
+    }
+    bool key = _keyIsCoordinates;
+    bool expect = _expectCoordinates;
+    _keyIsCoordinates = false;
+    _expectCoordinates = false;
+
+    switch (c) {
+        case '"':
+            _lex = Lex::STRING;
+            _tokenLength = 0;
+            break;
+        case ':':
+            _expectCoordinates = key;
+            break;
+        case ',':
+            break;
+        case '{':
+            if (_coordNesting > 0) {
+                fail();
+            }
+            _depth++;
+            break;
+        case '[':
+            _depth++;
+            if (expect || _coordNesting > 0) {
+                jsonOpenArray();
+            }
+            break;
+        case '}':
+        case ']':
+            if (_depth == 0) {
+                fail();
+                return;
+            }
+            _depth--;
+            if (c == ']' && _coordNesting > 0) {
+                jsonCloseArray();
+            }
+            break;
+        default:
+            if (c == '-' || isDigit(c)) {
+                if (_valueCount == 0) {
+                    _tupleOffset = _errorOffset;
+                }
+                _lex = Lex::NUMBER;
+                _token[0] = c;
+                _tokenLength = 1;
+            } else if (c < 'a' || c > 'z' || _coordNesting > 0) {
+                fail();     // Letters are true, false and null, never coordinates
+            }
+            break;
+    }
+}
+
+void FenceImporter::jsonOpenArray() {
+    if (_coordNesting == 0) {
+        _leafDepth = 0;
+        _ringInPolygon = 0;
+        _valueCount = 0;
+    }
+    _coordNesting++;
+    if (_leafDepth == 0) {
+        return;
+    }
+    if (_coordNesting > _leafDepth) {
+        fail();
+    } else if (_coordNesting == _leafDepth) {
+        _valueCount = 0;
+    } else if (_coordNesting == _leafDepth - 1 && _leafDepth >= 3) {
+        beginRing(_ringInPolygon > 0);
+    }
+}
+
+void FenceImporter::jsonNumber(double value) {
+    if (_coordNesting == 0) {
+        return;     // A number elsewhere, e.g. in properties
+    }
+    if (_leafDepth == 0) {
+        // The first position: now the rings' depth is known
+        _leafDepth = _coordNesting;
+        if (_leafDepth >= 3) {
+            beginRing(false);
+        }
+    }
+    if (_coordNesting != _leafDepth) {
+        fail();
+        return;
+    }
+    if (_valueCount < 2) {
+        _values[_valueCount] = value;
+    }
+    _valueCount++;
+}
+
+void FenceImporter::jsonCloseArray() {
+    uint32_t nesting = _coordNesting--;
+    if (_leafDepth == 0) {
+        return;
+    }
+    if (nesting == _leafDepth) {
+        if (_valueCount < 2) {
+            fail();
+        } else if (_leafDepth >= 3 && !addPosition()) {
+            return;
+        }
+        _valueCount = 0;
+    } else if (nesting == _leafDepth - 1 && _leafDepth >= 3) {
+        endRing();
+    } else if (nesting == _leafDepth - 2) {
+        _ringInPolygon = 0;
+    }
+}
+
+// ============================================================================
+// KML
+// ============================================================================
+
+void FenceImporter::kmlChar(char c) {
+    switch (_lex) {
+        case Lex::COMMENT:
+            // _quote is '-' for <!-- -->, '>' for declarations
+            if (c == '>' && (_quote == '>' || (_tokenLength >= 2 && _token[0] == '-' && _token[1] == '-'))) {
+                _lex = Lex::TEXT;
+            }
+            _token[0] = _token[1];
+            _token[1] = c;
+            _tokenLength = 2;
+            return;
+
+        case Lex::TAG:
+            if (_tokenLength == 0 && c == '/' && !_closingTag) {
+                _closingTag = true;
+                return;
+            }
+            if (_tokenLength == 0 && (c == '?' || c == '!')) {
+                _token[_tokenLength++] = c;
+                if (c == '?') {
+                    _lex = Lex::COMMENT;
+                    _quote = '>';
+                }
+                return;
+            }
+            if (_tokenLength > 0 && _token[0] == '!') {
+                _token[_tokenLength++] = c;
+                if (_tokenLength == 3) {
+                    _lex = Lex::COMMENT;
+                    _quote = (_token[1] == '-' && _token[2] == '-') ? '-' : '>';
+                    _token[0] = _token[1] = 0;
+                }
+                return;
+            }
+            if (c == '>') {
+                _lex = Lex::TEXT;
+                kmlTag(false);
+            } else if (c == '/') {
+                _lex = Lex::TAG_REST;
+                _selfClosing = true;
+            } else if (isSpace(c)) {
+                _lex = Lex::TAG_REST;
+            } else if (_tokenLength < FENCE_IMPORT_TOKEN_MAX) {
+                _token[_tokenLength++] = c;
+            }
+            return;
+
+        case Lex::TAG_REST:
+            if (c == '>') {
+                _lex = Lex::TEXT;
+                kmlTag(_selfClosing);
+            } else if (c == '"' || c == '\'') {
+                _lex = Lex::TAG_QUOTE;
+                _quote = c;
+            } else if (!isSpace(c)) {
+                _selfClosing = c == '/';
+            }
+            return;
+
+        case Lex::TAG_QUOTE:
+            if (c == _quote) {
+                _lex = Lex::TAG_REST;
+                _selfClosing = false;
+            }
+            return;
+
+        case Lex::NUMBER:
+            if (isNumberChar(c)) {
+                if (_tokenLength == FENCE_IMPORT_TOKEN_MAX) {
+                    fail();
+                    return;
+                }
+                _token[_tokenLength++] = c;
+                return;
+            }
+            _lex = Lex::TEXT;
+            double value;
+            if (!parseNumber(value)) {
+                fail();
+                return;
+            }
+            kmlNumber(value);
+            break;      // c ends the number; handle it below
+
+        default:
+            break;
+    }
+
+    if (c == '<') {
+        _lex = Lex::TAG;
+        _tokenLength = 0;
+        _closingTag = false;
+        _selfClosing = false;
+        return;
+    }
+    if (!_inCoordinates) {
+        return;     // Other element text
+    }
+
+    // "lon,lat[,alt]" tuples separated by whitespace
+    if (isSpace(c)) {
+        _tupleBreak = _valueCount > 0;
+    } else if (c == ',') {
+        _tupleBreak = false;
+    } else if (c == '-' || c == '+' || c == '.' || isDigit(c)) {
+        if (_tupleBreak) {
+            kmlEndTuple();
+            _tupleBreak = false;
+        }
+        if (_valueCount == 0) {
+            _tupleOffset = _errorOffset;
+        }
+        _lex = Lex::NUMBER;
+        _token[0] = c;
+        _tokenLength = 1;
+    } else {
+        fail();
+    }
+}
+
+void FenceImporter::kmlNumber(double value) {
+    if (_valueCount < 2) {
+        _values[_valueCount] = value;
+    }
+    _valueCount++;
+}
+
+void FenceImporter::kmlEndTuple() {
+    if (_valueCount == 0) {
+        return;
+    }
+    if (_valueCount < 2 || !addPosition()) {
+        fail();
+        return;
+    }
+    _valueCount = 0;
+}
+
+void FenceImporter::kmlTag(bool selfClosing) {
+    if (selfClosing) {
+        return;     // An empty element opens nothing
+    }
+    int step = _closingTag ? -1 : 1;
+
+    if (tagIs(_token, _tokenLength, "Polygon")) {
+        if (step > 0 || _polygonDepth > 0) {
+            _polygonDepth += step;
+        }
+    } else if (tagIs(_token, _tokenLength, "innerBoundaryIs")) {
+        if (step > 0 || _innerDepth > 0) {
+            _innerDepth += step;
+        }
+    } else if (tagIs(_token, _tokenLength, "coordinates")) {
+        if (!_closingTag && _polygonDepth > 0) {
+            _inCoordinates = true;
+            _tupleBreak = false;
+            beginRing(_innerDepth > 0);
+        } else if (_closingTag && _inCoordinates) {
+            kmlEndTuple();
+            endRing();
+            _inCoordinates = false;
+        }
+    }
+}
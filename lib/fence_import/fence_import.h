@@ -0,0 +1,201 @@
+/**
+ * @file fence_import.h
+ * @brief Streaming GeoJSON / KML fence importer for the host.
+ *
+ * Turns fences drawn in a mapping tool (or a county parcel export) into
+ * collar-ready vertex rings without building a document tree: input is
+ * fed in chunks of any size, including one byte at a time, and only the
+ * polygon coordinates are kept.
+ *
+ *  - GeoJSON: every "coordinates" value nested deeply enough to hold
+ *    rings (Polygon, MultiPolygon, in Features, FeatureCollections or
+ *    GeometryCollections). Positions are [lon, lat, ...].
+ *  - KML: <coordinates> inside <Polygon>, as "lon,lat[,alt]" tuples.
+ *
+ * Ring positions must be WGS 84 degrees: a position outside ±90 / ±180
+ * (e.g. a projected parcel export in metres) fails the import.
+ *
+ * Each ring is normalized for Polygon: the closing vertex (repeated
+ * first vertex) and consecutive duplicates are removed, and the ring is
+ * turned counter-clockwise. Inner rings (holes) are skipped, since
+ * Polygon has none, and counted. fenceImportEncode() packs a ring into
+ * the CRC-checked FenceStore blob, ready for the collar's fence partition.
+ *
+ * Host only (std::vector); not part of the firmware.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef FENCE_IMPORT_H
+#define FENCE_IMPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "../point_in_polygon/point_in_polygon.h"
+
+// ============================================
+// CONSTANTS
+// ============================================
+
+// Longest number or tag name the tokenizer buffers
+constexpr size_t FENCE_IMPORT_TOKEN_MAX = 40;
+
+// Read size of fenceImportFile()
+constexpr size_t FENCE_IMPORT_READ_SIZE = 64 * 1024;
+
+// ============================================
+// TYPES
+// ============================================
+
+enum class FenceImportFormat : uint8_t {
+    AUTO,       ///< From the first character: '{' or '[' GeoJSON, '<' KML
+    GEOJSON,
+    KML
+};
+
+/**
+ * @brief One imported fence: the outer ring of a source polygon.
+ */
+struct ImportedFence {
+    std::vector<GeoPoint> vertices;     ///< Counter-clockwise, not closed
+    uint32_t polygon;                   ///< Index of the polygon in the source
+};
+
+struct FenceImportStats {
+    uint64_t bytes;         ///< Input bytes fed
+    uint32_t polygons;      ///< Polygons seen (outer rings)
+    uint32_t holes;         ///< Inner rings skipped
+    uint32_t degenerate;    ///< Outer rings with under 3 distinct vertices, dropped
+    uint32_t reversed;      ///< Rings turned counter-clockwise
+};
+
+// ============================================
+// FUNCTIONS
+// ============================================
+
+/**
+ * @brief Make a ring usable by Polygon.
+ *
+ * Removes consecutive duplicate vertices and the closing vertex, and
+ * reverses a clockwise ring.
+ *
+ * @param reversed Set to whether the ring was reversed.
+ * @return false if fewer than 3 distinct vertices remain or the ring has
+ *         no area.
+ */
+bool fenceImportNormalize(std::vector<GeoPoint>& ring, bool& reversed);
+
+/**
+ * @brief Encode a fence as a FenceStore blob.
+ *
+ * @param out Receives the blob (replaced).
+ * @return Blob size, or 0 if the fence has too many vertices for the store.
+ */
+size_t fenceImportEncode(const ImportedFence& fence, uint32_t fenceId, std::vector<uint8_t>& out);
+
+// ============================================
+// IMPORTER CLASS
+// ============================================
+
+class FenceImporter {
+public:
+    explicit FenceImporter(FenceImportFormat format = FenceImportFormat::AUTO);
+
+    /**
+     * @brief Parse the next piece of the input.
+     *
+     * @return false once the input is found malformed; later calls are ignored.
+     */
+    bool feed(const char* data, size_t length);
+
+    /**
+     * @brief End of input.
+     *
+     * @return false if the input was malformed or ended mid-document.
+     */
+    bool finish();
+
+    const std::vector<ImportedFence>& fences() const { return _fences; }
+    const FenceImportStats& stats() const { return _stats; }
+    FenceImportFormat format() const { return _format; }
+
+    bool failed() const { return _failed; }
+
+    /**
+     * @brief Byte offset of the first malformed input (if failed()).
+     */
+    uint64_t errorOffset() const { return _errorOffset; }
+
+private:
+    enum class Lex : uint8_t {
+        TEXT,           ///< Between tokens (JSON) or in element text (KML)
+        STRING,         ///< JSON string
+        STRING_ESCAPE,  ///< After a backslash in a JSON string
+        NUMBER,
+        TAG,            ///< KML tag name
+        TAG_REST,       ///< KML attributes, up to '>'
+        TAG_QUOTE,      ///< Quoted attribute value
+        COMMENT         ///< KML comment or declaration
+    };
+
+    FenceImportFormat _format;
+    Lex _lex;
+    bool _failed;
+    uint64_t _errorOffset;
+    FenceImportStats _stats;
+    std::vector<ImportedFence> _fences;
+    std::vector<GeoPoint> _ring;
+
+    char _token[FENCE_IMPORT_TOKEN_MAX];
+    size_t _tokenLength;
+    char _quote;
+
+    // Position being read: up to lon, lat
+    double _values[2];
+    uint32_t _valueCount;
+    uint64_t _tupleOffset;          ///< Where the position's first number starts
+    bool _ringIsHole;
+
+    // GeoJSON
+    uint32_t _depth;                ///< Open objects and arrays
+    bool _keyIsCoordinates;         ///< Last string was "coordinates"
+    bool _expectCoordinates;        ///< After "coordinates":
+    uint32_t _coordNesting;         ///< Arrays open inside coordinates; 0 outside
+    uint32_t _leafDepth;            ///< Nesting of positions; 0 until the first number
+    uint32_t _ringInPolygon;
+
+    // KML
+    uint32_t _polygonDepth;
+    uint32_t _innerDepth;
+    bool _inCoordinates;
+    bool _tupleBreak;               ///< Whitespace after a number, no comma since
+    bool _closingTag;
+    bool _selfClosing;
+
+    void fail();
+    void consume(char c);
+    bool parseNumber(double& value);
+    void beginRing(bool hole);
+    void endRing();
+    bool addPosition();
+
+    void jsonChar(char c);
+    void jsonNumber(double value);
+    void jsonOpenArray();
+    void jsonCloseArray();
+
+    void kmlChar(char c);
+    void kmlTag(bool selfClosing);
+    void kmlNumber(double value);
+    void kmlEndTuple();
+};
+
+/**
+ * @brief Feed a whole file to an importer and finish it.
+ *
+ * @return false if the file cannot be read or the importer fails.
+ */
+bool fenceImportFile(const char* path, FenceImporter& importer);
+
+#endif // FENCE_IMPORT_H
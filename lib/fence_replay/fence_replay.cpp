@@ -0,0 +1,361 @@
+/**
+ * @file fence_replay.cpp
+ * @brief Implementation of the fence replay engine.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "fence_replay.h"
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+// Seconds from a to b; the collar clock can restart, which counts as no time
+static uint32_t elapsedSec(uint32_t a, uint32_t b) {
+    return b >= a ? b - a : 0;
+}
+
+static uint32_t insideMask(const Polygon* fences, size_t fenceCount, const PositionFix& fix) {
+    GeoPoint point = {e6ToDegrees(fix.latE6), e6ToDegrees(fix.lonE6)};
+    uint32_t mask = 0;
+    for (size_t f = 0; f < fenceCount; f++) {
+        if (fences[f].contains(point)) {
+            mask |= 1u << f;
+        }
+    }
+    return mask;
+}
+
+static void raise(uint32_t& value, uint32_t candidate) {
+    if (candidate > value) {
+        value = candidate;
+    }
+}
+
+static void countCrossing(FenceReplayStats& stats, FenceCrossing type) {
+    if (type == FenceCrossing::ENTRY) {
+        stats.entries++;
+    } else {
+        stats.exits++;
+    }
+}
+
+// ============================================================================
+// Chunk Evaluation
+// ============================================================================
+
+void fenceReplayEvaluate(const Polygon* fences, size_t fenceCount,
+                         const PositionFix* fixes, size_t count, FenceReplayChunk& chunk) {
+    if (fenceCount > FENCE_REPLAY_MAX_FENCES) {
+        fenceCount = FENCE_REPLAY_MAX_FENCES;
+    }
+    chunk.fixCount = count;
+    chunk.events.clear();
+    chunk.fences.assign(fenceCount, FenceChunkStats());
+    chunk.firstInside = chunk.lastInside = chunk.everInside = 0;
+    if (count == 0) {
+        return;
+    }
+
+    chunk.firstFix = fixes[0];
+    chunk.lastFix = fixes[count - 1];
+
+    // Start of the current excursion per fence; one starting at the first
+    // fix is the chunk's prefix and is handed to the merge
+    uint32_t runStart[FENCE_REPLAY_MAX_FENCES];
+    uint32_t prefixOpen = 0;
+
+    uint32_t prev = insideMask(fences, fenceCount, fixes[0]);
+    uint32_t allFences = fenceCount == 32 ? 0xFFFFFFFFu : (1u << fenceCount) - 1;
+    for (size_t f = 0; f < fenceCount; f++) {
+        runStart[f] = fixes[0].timestamp;
+        if (prev & (1u << f)) {
+            chunk.fences[f].insideFixes++;
+        }
+    }
+    prefixOpen = ~prev & allFences;
+    chunk.firstInside = prev;
+    chunk.everInside = prev;
+
+    for (size_t i = 1; i < count; i++) {
+        const PositionFix& fix = fixes[i];
+        uint32_t mask = insideMask(fences, fenceCount, fix);
+        uint32_t dt = elapsedSec(fixes[i - 1].timestamp, fix.timestamp);
+        uint32_t changed = mask ^ prev;
+
+        for (size_t f = 0; f < fenceCount; f++) {
+            uint32_t bit = 1u << f;
+            FenceChunkStats& stats = chunk.fences[f];
+            if (mask & bit) {
+                stats.insideFixes++;
+            }
+            if (!(prev & bit)) {
+                stats.outsideSec += dt;
+            }
+            if (!(changed & bit)) {
+                continue;
+            }
+
+            FenceCrossingEvent event = {i, fix, static_cast<uint8_t>(f),
+                                        (mask & bit) ? FenceCrossing::ENTRY : FenceCrossing::EXIT};
+            chunk.events.push_back(event);
+
+            if (event.type == FenceCrossing::EXIT) {
+                runStart[f] = fix.timestamp;
+            } else if (prefixOpen & bit) {
+                stats.prefixEndTime = fix.timestamp;
+                prefixOpen &= ~bit;
+            } else {
+                raise(stats.longestSec, elapsedSec(runStart[f], fix.timestamp));
+            }
+        }
+
+        chunk.everInside |= mask;
+        prev = mask;
+    }
+
+    chunk.lastInside = prev;
+    for (size_t f = 0; f < fenceCount; f++) {
+        if (!(prev & (1u << f))) {
+            chunk.fences[f].suffixStartTime = runStart[f];
+        }
+    }
+}
+
+// ============================================================================
+// CSV Parsing
+// ============================================================================
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static void skipSpaces(const char*& p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+}
+
+// Decimal degrees to rounded microdegrees, without going through float
+static bool parseE6(const char*& p, const char* end, int32_t& value) {
+    skipSpaces(p, end);
+    bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        p++;
+    }
+    if (p >= end || !isDigit(*p)) {
+        return false;
+    }
+
+    int64_t whole = 0;
+    while (p < end && isDigit(*p)) {
+        whole = whole * 10 + (*p++ - '0');
+        if (whole > 180) {
+            return false;
+        }
+    }
+
+    int64_t micro = 0;
+    int digits = 0;
+    bool roundUp = false;
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && isDigit(*p)) {
+            if (digits < 6) {
+                micro = micro * 10 + (*p - '0');
+            } else if (digits == 6) {
+                roundUp = *p >= '5';
+            }
+            digits++;
+            p++;
+        }
+    }
+    for (; digits < 6; digits++) {
+        micro *= 10;
+    }
+
+    int64_t e6 = whole * 1000000 + micro + (roundUp ? 1 : 0);
+    value = static_cast<int32_t>(negative ? -e6 : e6);
+    skipSpaces(p, end);
+    return true;
+}
+
+static bool parseTimestamp(const char*& p, const char* end, uint32_t& value) {
+    uint64_t seconds = 0;
+    if (p >= end || !isDigit(*p)) {
+        return false;
+    }
+    while (p < end && isDigit(*p)) {
+        seconds = seconds * 10 + (*p++ - '0');
+        if (seconds > 0xFFFFFFFFu) {
+            return false;
+        }
+    }
+    // Fractional seconds are dropped
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && isDigit(*p)) {
+            p++;
+        }
+    }
+    skipSpaces(p, end);
+    value = static_cast<uint32_t>(seconds);
+    return true;
+}
+
+static bool parseLine(const char* p, const char* end, PositionFix& fix) {
+    return parseTimestamp(p, end, fix.timestamp) &&
+           p < end && *p++ == ',' && parseE6(p, end, fix.latE6) &&
+           p < end && *p++ == ',' && parseE6(p, end, fix.lonE6) &&
+           (p == end || *p == ',');  // Further columns are ignored
+}
+
+size_t fenceReplayParseCsv(const char* text, size_t length, std::vector<PositionFix>& fixes) {
+    const char* p = text;
+    const char* end = text + length;
+    size_t malformed = 0;
+
+    while (p < end) {
+        const char* lineEnd = p;
+        while (lineEnd < end && *lineEnd != '\n') {
+            lineEnd++;
+        }
+        const char* contentEnd = lineEnd;
+        if (contentEnd > p && contentEnd[-1] == '\r') {
+            contentEnd--;
+        }
+
+        const char* start = p;
+        skipSpaces(start, contentEnd);
+        if (start < contentEnd && isDigit(*start)) {
+            PositionFix fix;
+            if (parseLine(start, contentEnd, fix)) {
+                fixes.push_back(fix);
+            } else {
+                malformed++;
+            }
+        }
+        p = lineEnd + 1;
+    }
+    return malformed;
+}
+
+// ============================================================================
+// FenceReplay Class Implementation
+// ============================================================================
+
+FenceReplay::FenceReplay(const Polygon* fences, size_t fenceCount)
+    : _fences(fences)
+    , _fenceCount(fenceCount > FENCE_REPLAY_MAX_FENCES ? FENCE_REPLAY_MAX_FENCES : fenceCount)
+    , _fixCount(0)
+    , _lastFix()
+    , _lastInside(0)
+    , _stats(_fenceCount, FenceReplayStats())
+    , _openSince(_fenceCount, 0)
+{
+}
+
+void FenceReplay::replay(WorkStealingPool& pool, const PositionFix* fixes, size_t count,
+                         std::vector<FenceCrossingEvent>* events) {
+    size_t chunkCount = (count + FENCE_REPLAY_CHUNK_FIXES - 1) / FENCE_REPLAY_CHUNK_FIXES;
+    if (_chunks.size() < chunkCount) {
+        _chunks.resize(chunkCount);
+    }
+
+    pool.run(chunkCount, [&](size_t i) {
+        size_t first = i * FENCE_REPLAY_CHUNK_FIXES;
+        size_t length = count - first < FENCE_REPLAY_CHUNK_FIXES ? count - first : FENCE_REPLAY_CHUNK_FIXES;
+        fenceReplayEvaluate(_fences, _fenceCount, fixes + first, length, _chunks[i]);
+    });
+
+    for (size_t i = 0; i < chunkCount; i++) {
+        merge(_chunks[i], events);
+    }
+}
+
+void FenceReplay::merge(const FenceReplayChunk& chunk, std::vector<FenceCrossingEvent>* events) {
+    if (chunk.fixCount == 0) {
+        return;
+    }
+
+    bool first = _fixCount == 0;
+    uint32_t boundary = first ? 0 : (_lastInside ^ chunk.firstInside);
+
+    for (size_t f = 0; f < _fenceCount && f < chunk.fences.size(); f++) {
+        uint32_t bit = 1u << f;
+        const FenceChunkStats& part = chunk.fences[f];
+        FenceReplayStats& stats = _stats[f];
+
+        stats.insideFixes += part.insideFixes;
+        stats.outsideFixes += chunk.fixCount - part.insideFixes;
+        stats.outsideSec += part.outsideSec;
+        if (!first && !(_lastInside & bit)) {
+            stats.outsideSec += elapsedSec(_lastFix.timestamp, chunk.firstFix.timestamp);
+        }
+
+        // Crossing between the previous chunk's last fix and this one's first
+        if (boundary & bit) {
+            FenceCrossingEvent event = {_fixCount, chunk.firstFix, static_cast<uint8_t>(f),
+                                        (chunk.firstInside & bit) ? FenceCrossing::ENTRY
+                                                                  : FenceCrossing::EXIT};
+            countCrossing(stats, event.type);
+            if (events != nullptr) {
+                events->push_back(event);
+            }
+        }
+
+        // Excursions: the open one (if any) continues into the chunk's prefix
+        bool open = !first && !(_lastInside & bit);
+        uint32_t start = open ? _openSince[f] : chunk.firstFix.timestamp;
+        if (!(chunk.firstInside & bit)) {
+            if (!(chunk.everInside & bit)) {
+                _openSince[f] = start;   // Outside for the whole chunk
+                continue;
+            }
+            raise(stats.longestExcursionSec, elapsedSec(start, part.prefixEndTime));
+        } else if (open) {
+            raise(stats.longestExcursionSec, elapsedSec(start, chunk.firstFix.timestamp));
+        }
+        raise(stats.longestExcursionSec, part.longestSec);
+        if (!(chunk.lastInside & bit)) {
+            _openSince[f] = part.suffixStartTime;
+        }
+    }
+
+    for (const FenceCrossingEvent& local : chunk.events) {
+        countCrossing(_stats[local.fence], local.type);
+        if (events != nullptr) {
+            FenceCrossingEvent event = local;
+            event.index += _fixCount;
+            events->push_back(event);
+        }
+    }
+
+    _fixCount += chunk.fixCount;
+    _lastFix = chunk.lastFix;
+    _lastInside = chunk.lastInside;
+}
+
+void FenceReplay::finish() {
+    if (_fixCount == 0) {
+        return;
+    }
+    for (size_t f = 0; f < _fenceCount; f++) {
+        if (!(_lastInside & (1u << f))) {
+            raise(_stats[f].longestExcursionSec, elapsedSec(_openSince[f], _lastFix.timestamp));
+        }
+    }
+}
+
+const FenceReplayStats& FenceReplay::stats(size_t fence) const {
+    return _stats[fence];
+}
+
+uint64_t FenceReplay::fixCount() const {
+    return _fixCount;
+}
+
+size_t FenceReplay::fenceCount() const {
+    return _fenceCount;
+}
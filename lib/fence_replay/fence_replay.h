@@ -0,0 +1,185 @@
+/**
+ * @file fence_replay.h
+ * @brief Replays recorded tracks against one or more fences on the host.
+ *
+ * Answers "how would this track have behaved with that fence?" for
+ * tracks of millions of fixes: every fix is tested against every fence
+ * with the same Polygon code the collar runs, and the replay reports each
+ * crossing plus per-fence statistics.
+ *
+ * The track is cut into chunks that are evaluated independently (in
+ * parallel) and then merged in track order. A chunk only knows its own
+ * fixes, so it records what the merge needs to stitch it to its
+ * neighbours: the fence states of its first and last fix, and the open
+ * ends of any excursion outside. Merging is cheap (per chunk, not per
+ * fix), so the replay scales with the number of cores.
+ *
+ * Host only (std::vector, std::thread); not part of the firmware.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef FENCE_REPLAY_H
+#define FENCE_REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "../point_in_polygon/point_in_polygon.h"
+#include "../position_codec/position_codec.h"
+#include "../work_pool/work_pool.h"
+
+// ============================================
+// CONSTANTS
+// ============================================
+
+// Fence states of a fix are kept as a bitmask
+constexpr size_t FENCE_REPLAY_MAX_FENCES = 32;
+
+// Fixes per chunk: large enough that scheduling and merging are noise
+constexpr size_t FENCE_REPLAY_CHUNK_FIXES = 65536;
+
+// ============================================
+// TYPES
+// ============================================
+
+enum class FenceCrossing : uint8_t {
+    EXIT,       ///< Inside to outside
+    ENTRY       ///< Outside to inside
+};
+
+/**
+ * @brief One fence crossing, at the first fix on the new side.
+ */
+struct FenceCrossingEvent {
+    uint64_t index;         ///< Fix index in the track
+    PositionFix fix;
+    uint8_t fence;          ///< Index into the fence list
+    FenceCrossing type;
+};
+
+/**
+ * @brief Totals for one fence over the whole track.
+ *
+ * Time between two fixes counts as outside when the earlier one is. An
+ * excursion runs from the first fix outside to the first fix back inside
+ * (or to the last fix if the track ends outside).
+ */
+struct FenceReplayStats {
+    uint64_t insideFixes;
+    uint64_t outsideFixes;
+    uint32_t exits;
+    uint32_t entries;
+    uint64_t outsideSec;
+    uint32_t longestExcursionSec;
+};
+
+/**
+ * @brief Per-fence summary of one chunk (filled by fenceReplayEvaluate).
+ */
+struct FenceChunkStats {
+    uint64_t insideFixes;
+    uint64_t outsideSec;        ///< Between fixes of this chunk
+    uint32_t prefixEndTime;     ///< First fix inside, if the chunk starts outside
+    uint32_t suffixStartTime;   ///< Start of the excursion still open at the end
+    uint32_t longestSec;        ///< Longest excursion that starts and ends in the chunk
+};
+
+/**
+ * @brief Result of evaluating one chunk.
+ *
+ * Event indices are relative to the chunk until merged.
+ */
+struct FenceReplayChunk {
+    size_t fixCount;
+    PositionFix firstFix;
+    PositionFix lastFix;
+    uint32_t firstInside;       ///< Bit per fence: first fix inside
+    uint32_t lastInside;        ///< Bit per fence: last fix inside
+    uint32_t everInside;        ///< Bit per fence: any fix inside
+    std::vector<FenceChunkStats> fences;
+    std::vector<FenceCrossingEvent> events;
+};
+
+// ============================================
+// FUNCTIONS
+// ============================================
+
+/**
+ * @brief Test a run of fixes against the fences (thread-safe, no shared state).
+ *
+ * @param fences     Fences to test, at most FENCE_REPLAY_MAX_FENCES.
+ * @param fenceCount Number of fences.
+ * @param fixes      Fixes in track order.
+ * @param count      Number of fixes.
+ * @param chunk      Receives the result; its buffers are reused.
+ */
+void fenceReplayEvaluate(const Polygon* fences, size_t fenceCount,
+                         const PositionFix* fixes, size_t count, FenceReplayChunk& chunk);
+
+/**
+ * @brief Parse "timestamp,lat,lon" lines (decimal degrees) into fixes.
+ *
+ * Blank lines, '#' comments and lines that do not start with a digit
+ * (a header) are skipped.
+ *
+ * @return Number of malformed lines.
+ */
+size_t fenceReplayParseCsv(const char* text, size_t length, std::vector<PositionFix>& fixes);
+
+// ============================================
+// REPLAY CLASS
+// ============================================
+
+/**
+ * @brief Merges chunk results in track order into events and statistics.
+ *
+ * Feed a track as any number of batches; chunk boundaries do not change
+ * the result.
+ */
+class FenceReplay {
+public:
+    /**
+     * @param fences     Fences to replay against (must stay valid).
+     * @param fenceCount Number of fences, at most FENCE_REPLAY_MAX_FENCES.
+     */
+    FenceReplay(const Polygon* fences, size_t fenceCount);
+
+    /**
+     * @brief Evaluate a batch of fixes on the pool and merge it.
+     *
+     * @param events Crossings of this batch are appended here (may be nullptr).
+     */
+    void replay(WorkStealingPool& pool, const PositionFix* fixes, size_t count,
+                std::vector<FenceCrossingEvent>* events);
+
+    /**
+     * @brief Merge the next chunk of the track.
+     *
+     * @param events Crossings of this chunk are appended here (may be nullptr).
+     */
+    void merge(const FenceReplayChunk& chunk, std::vector<FenceCrossingEvent>* events);
+
+    /**
+     * @brief Close excursions still open at the end of the track.
+     *
+     * Call once after the last chunk, before reading the statistics.
+     */
+    void finish();
+
+    const FenceReplayStats& stats(size_t fence) const;
+    uint64_t fixCount() const;
+    size_t fenceCount() const;
+
+private:
+    const Polygon* _fences;
+    size_t _fenceCount;
+    uint64_t _fixCount;
+    PositionFix _lastFix;
+    uint32_t _lastInside;
+    std::vector<FenceReplayStats> _stats;
+    std::vector<uint32_t> _openSince;   ///< Start of the open excursion per fence
+    std::vector<FenceReplayChunk> _chunks;
+};
+
+#endif // FENCE_REPLAY_H
@@ -0,0 +1,522 @@
+/**
+ * @file fence_simplify.cpp
+ * @brief Implementation of the error-bounded fence simplifier.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "fence_simplify.h"
+#include <math.h>
+#include <algorithm>
+#include <functional>
+
+typedef FenceSimplifier::Point Point;
+
+// Stands in for the collapse point, which has no vertex index yet
+static const size_t NEW_POINT = static_cast<size_t>(-1);
+
+// ============================================================================
+// Geometry
+// ============================================================================
+
+// Twice the signed area of o, a, b: positive when b is left of o->a
+static double cross(const Point& o, const Point& a, const Point& b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+static int sign(double value) {
+    return (value > 0.0) - (value < 0.0);
+}
+
+// For p collinear with a-b: whether it lies on the segment
+static bool withinBox(const Point& p, const Point& a, const Point& b) {
+    return std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x) &&
+           std::min(a.y, b.y) <= p.y && p.y <= std::max(a.y, b.y);
+}
+
+// Segments a-b and c-d share at least one point
+static bool segmentsMeet(const Point& a, const Point& b, const Point& c, const Point& d) {
+    int abc = sign(cross(a, b, c));
+    int abd = sign(cross(a, b, d));
+    int cda = sign(cross(c, d, a));
+    int cdb = sign(cross(c, d, b));
+    if (abc * abd < 0 && cda * cdb < 0) {
+        return true;
+    }
+    return (abc == 0 && withinBox(c, a, b)) || (abd == 0 && withinBox(d, a, b)) ||
+           (cda == 0 && withinBox(a, c, d)) || (cdb == 0 && withinBox(b, c, d));
+}
+
+// Segments a-b and c-d cross at a point inside both
+static bool segmentsCross(const Point& a, const Point& b, const Point& c, const Point& d) {
+    return sign(cross(a, b, c)) * sign(cross(a, b, d)) < 0 && sign(cross(c, d, a)) * sign(cross(c, d, b)) < 0;
+}
+
+// Segments o-a and o-b, sharing the end o, run along each other
+static bool segmentsFold(const Point& o, const Point& a, const Point& b) {
+    return cross(o, a, b) == 0.0 && (a.x - o.x) * (b.x - o.x) + (a.y - o.y) * (b.y - o.y) > 0.0;
+}
+
+static double segmentDistance(const Point& p, const Point& a, const Point& b) {
+    double dx = b.x - a.x;
+    double dy = b.y - a.y;
+    double lengthSquared = dx * dx + dy * dy;
+    double t = lengthSquared > 0.0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSquared : 0.0;
+    t = std::max(0.0, std::min(1.0, t));
+    double ex = a.x + t * dx - p.x;
+    double ey = a.y + t * dy - p.y;
+    return sqrt(ex * ex + ey * ey);
+}
+
+// Even-odd test that counts the boundary as inside
+static bool insideOrOn(const Point& p, const Point* polygon, size_t count) {
+    bool inside = false;
+    for (size_t i = 0, j = count - 1; i < count; j = i++) {
+        const Point& a = polygon[j];
+        const Point& b = polygon[i];
+        if (cross(a, b, p) == 0.0 && withinBox(p, a, b)) {
+            return true;
+        }
+        if ((a.y > p.y) != (b.y > p.y) && p.x < a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y)) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+// Twice the signed area; positive is counter-clockwise
+static double polygonArea(const Point* polygon, size_t count) {
+    double area = 0.0;
+    for (size_t i = 0, j = count - 1; i < count; j = i++) {
+        area += polygon[j].x * polygon[i].y - polygon[i].x * polygon[j].y;
+    }
+    return area;
+}
+
+// ============================================================================
+// Simplification
+// ============================================================================
+
+FenceSimplifier::FenceSimplifier()
+    : _mode(FenceSimplifyMode::ANY),
+      _stats(),
+      _originals(0),
+      _count(0),
+      _lat0(0.0),
+      _lon0(0.0),
+      _metersPerLon(0.0) {
+}
+
+bool FenceSimplifier::simplify(const GeoPoint* ring, size_t count, const FenceSimplifyOptions& options,
+                               std::vector<GeoPoint>& out) {
+    _stats = FenceSimplifyStats();
+    _stats.inputVertices = count;
+    out.clear();
+    if (ring == nullptr || count < 3 || (options.maxVertices != 0 && options.maxVertices < 3)) {
+        return false;
+    }
+
+    _mode = options.mode;
+    _lat0 = ring[0].lat;
+    _lon0 = ring[0].lon;
+    _metersPerLon = METERS_PER_DEGREE * cos(_lat0 * M_PI / 180.0);
+    _geo.clear();
+    _points.clear();
+    _origin.clear();
+    _prev.clear();
+    _next.clear();
+    _version.clear();
+    _alive.clear();
+    _heap.clear();
+    _blocked.clear();
+
+    // Worked on counter-clockwise, so the inside is always on the left
+    double area = 0.0;
+    for (size_t i = 0, j = count - 1; i < count; j = i++) {
+        area += (static_cast<double>(ring[j].lon) - ring[i].lon) * (static_cast<double>(ring[j].lat) + ring[i].lat);
+    }
+    bool reversed = area < 0.0;
+    for (size_t i = 0; i < count; i++) {
+        addVertex(ring[reversed ? count - 1 - i : i], i);
+        _prev[i] = (i + count - 1) % count;
+        _next[i] = (i + 1) % count;
+    }
+    _originals = count;
+    _count = count;
+    if (area == 0.0 || !ringIsSimple()) {
+        out.assign(ring, ring + count);
+        _stats.outputVertices = count;
+        return false;
+    }
+
+    for (size_t v = 0; v < count; v++) {
+        evaluate(v);
+    }
+
+    bool progress = false;
+    while (_count > 3) {
+        bool overBudget = options.maxVertices != 0 && _count > options.maxVertices;
+        if (_heap.empty() || (!overBudget && _heap.front().error > options.toleranceMeters)) {
+            // Steps refused earlier may be clear now that the ring has changed
+            if (!progress || _blocked.empty()) {
+                break;
+            }
+            for (const Candidate& candidate : _blocked) {
+                _heap.push_back(candidate);
+                std::push_heap(_heap.begin(), _heap.end(), std::greater<Candidate>());
+            }
+            _blocked.clear();
+            progress = false;
+            continue;
+        }
+
+        std::pop_heap(_heap.begin(), _heap.end(), std::greater<Candidate>());
+        Candidate candidate = _heap.back();
+        _heap.pop_back();
+        if (!_alive[candidate.vertex] || _version[candidate.vertex] != candidate.version) {
+            continue;
+        }
+        if (!valid(candidate)) {
+            _stats.refused++;
+            _blocked.push_back(candidate);
+            continue;
+        }
+        apply(candidate);
+        progress = true;
+    }
+
+    size_t start = 0;
+    while (!_alive[start]) {
+        start++;
+    }
+    size_t v = start;
+    do {
+        out.push_back(_geo[v]);
+        v = _next[v];
+    } while (v != start);
+    if (reversed) {
+        std::reverse(out.begin(), out.end());
+    }
+    _stats.outputVertices = _count;
+    return options.maxVertices == 0 || _count <= options.maxVertices;
+}
+
+// ============================================================================
+// Ring
+// ============================================================================
+
+Point FenceSimplifier::toPoint(const GeoPoint& geo) const {
+    Point point = {(geo.lon - _lon0) * _metersPerLon, (geo.lat - _lat0) * METERS_PER_DEGREE};
+    return point;
+}
+
+size_t FenceSimplifier::addVertex(const GeoPoint& geo, size_t origin) {
+    _geo.push_back(geo);
+    _points.push_back(toPoint(geo));
+    _origin.push_back(origin);
+    _prev.push_back(0);
+    _next.push_back(0);
+    _version.push_back(0);
+    _alive.push_back(true);
+    return _geo.size() - 1;
+}
+
+bool FenceSimplifier::ringIsSimple() const {
+    size_t count = _count;
+    for (size_t i = 0; i < count; i++) {
+        const Point& a = _points[i];
+        const Point& b = _points[(i + 1) % count];
+        if (a.x == b.x && a.y == b.y) {
+            return false;
+        }
+        if (segmentsFold(b, a, _points[(i + 2) % count])) {
+            return false;
+        }
+        // Edges not next to edge i
+        for (size_t j = i + 2; j < count && (i != 0 || j != count - 1); j++) {
+            if (segmentsMeet(a, b, _points[j], _points[(j + 1) % count])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Candidates
+// ============================================================================
+
+bool FenceSimplifier::modeAllows(double area) const {
+    switch (_mode) {
+        case FenceSimplifyMode::INNER:
+            return area <= 0.0;
+        case FenceSimplifyMode::OUTER:
+            return area >= 0.0;
+        default:
+            return true;
+    }
+}
+
+double FenceSimplifier::ownedError(size_t from, size_t to, const Point& a, const Point& b) const {
+    double error = 0.0;
+    size_t last = _origin[to];
+    for (size_t k = _origin[from]; k != last; k = (k + 1) % _originals) {
+        error = std::max(error, segmentDistance(_points[k], a, b));
+    }
+    return error;
+}
+
+double FenceSimplifier::originalDistance(size_t from, size_t to, const Point& point) const {
+    double distance = INFINITY;
+    size_t last = _origin[to];
+    for (size_t k = _origin[from]; k != last; k = (k + 1) % _originals) {
+        distance = std::min(distance, segmentDistance(point, _points[k], _points[(k + 1) % _originals]));
+    }
+    return distance;
+}
+
+/**
+ * Where the edges before and after a-b meet, rounded to a float GeoPoint.
+ * Rounding moves the point by up to half a meter, so the rounded point is
+ * kept only if the region p, x, n, b, a still lies on one side: a and b on
+ * the side of the new edges the mode needs, x on the other side of a-b,
+ * and no edge of the region crossing another.
+ */
+bool FenceSimplifier::collapsePoint(size_t a, GeoPoint& point) const {
+    size_t b = _next[a];
+    const Point& pa = _points[a];
+    const Point& pb = _points[b];
+    const Point& pp = _points[_prev[a]];
+    const Point& pn = _points[_next[b]];
+
+    // p + t (a - p) = n + s (b - n), beyond a and beyond b
+    double d1x = pa.x - pp.x;
+    double d1y = pa.y - pp.y;
+    double d2x = pb.x - pn.x;
+    double d2y = pb.y - pn.y;
+    double denominator = d1x * d2y - d1y * d2x;
+    if (denominator == 0.0) {
+        return false;
+    }
+    double wx = pn.x - pp.x;
+    double wy = pn.y - pp.y;
+    double t = (wx * d2y - wy * d2x) / denominator;
+    double s = (wx * d1y - wy * d1x) / denominator;
+    if (!(t > 1.0 && s > 1.0)) {
+        return false;
+    }
+    double lat = _lat0 + (pp.y + t * d1y) / METERS_PER_DEGREE;
+    double lon = _lon0 + (pp.x + t * d1x) / _metersPerLon;
+    if (!(fabs(lat) <= 90.0 && fabs(lon) <= 180.0)) {
+        return false;
+    }
+
+    float lats[3] = {static_cast<float>(lat), 0.0f, 0.0f};
+    float lons[3] = {static_cast<float>(lon), 0.0f, 0.0f};
+    lats[1] = nextafterf(lats[0], -INFINITY);
+    lats[2] = nextafterf(lats[0], INFINITY);
+    lons[1] = nextafterf(lons[0], -INFINITY);
+    lons[2] = nextafterf(lons[0], INFINITY);
+    double best = INFINITY;
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            GeoPoint candidate = {lats[i], lons[j]};
+            Point x = toPoint(candidate);
+            double sideA = cross(pp, x, pa);
+            double sideB = cross(x, pn, pb);
+            double sideX = cross(pa, pb, x);
+            bool sides = _mode == FenceSimplifyMode::OUTER ? sideA >= 0.0 && sideB >= 0.0 && sideX <= 0.0
+                                                           : sideA <= 0.0 && sideB <= 0.0 && sideX >= 0.0;
+            sides = sides && !segmentsCross(pp, x, pn, pb) && !segmentsCross(pp, x, pb, pa) &&
+                    !segmentsCross(x, pn, pb, pa) && !segmentsCross(x, pn, pa, pp);
+            double offset = fabs(candidate.lat - lat) + fabs(candidate.lon - lon);
+            if (sides && offset < best) {
+                best = offset;
+                point = candidate;
+            }
+        }
+    }
+    return best != INFINITY;
+}
+
+void FenceSimplifier::evaluate(size_t vertex) {
+    if (_count <= 3) {
+        return;
+    }
+    size_t p = _prev[vertex];
+    size_t n = _next[vertex];
+
+    // Removal changes the triangle p, n, vertex
+    if (modeAllows(cross(_points[p], _points[n], _points[vertex]))) {
+        Candidate candidate = {ownedError(p, n, _points[p], _points[n]), vertex, _version[vertex],
+                               Step::REMOVE, _geo[vertex], 0};
+        _heap.push_back(candidate);
+        std::push_heap(_heap.begin(), _heap.end(), std::greater<Candidate>());
+    }
+
+    GeoPoint point;
+    if (_mode != FenceSimplifyMode::ANY && collapsePoint(vertex, point)) {
+        size_t b = _next[vertex];
+        size_t after = _next[b];
+        Point x = toPoint(point);
+        Point region[] = {_points[p], x, _points[after], _points[b], _points[vertex]};
+        if (modeAllows(polygonArea(region, 5))) {
+            size_t split;
+            double error = std::max(collapseError(vertex, x, split), originalDistance(p, after, x));
+            Candidate candidate = {error, vertex, _version[vertex], Step::COLLAPSE, point, split};
+            _heap.push_back(candidate);
+            std::push_heap(_heap.begin(), _heap.end(), std::greater<Candidate>());
+        }
+    }
+}
+
+/**
+ * Error of collapsing the edge from a into x. The originals a-b owned go
+ * to p-x up to the split and to x-n from it; the split is the one with
+ * the least error.
+ */
+double FenceSimplifier::collapseError(size_t a, const Point& x, size_t& split) {
+    size_t p = _prev[a];
+    size_t b = _next[a];
+    size_t n = _next[b];
+    const Point& pp = _points[p];
+    const Point& pn = _points[n];
+    double error = std::max(ownedError(p, a, pp, x), ownedError(b, n, x, pn));
+
+    // Suffix maxima over a's originals against x-n, then sweep the split
+    _scratch.clear();
+    for (size_t k = _origin[a]; k != _origin[b]; k = (k + 1) % _originals) {
+        _scratch.push_back(segmentDistance(_points[k], x, pn));
+    }
+    for (size_t i = _scratch.size(); i-- > 1;) {
+        _scratch[i - 1] = std::max(_scratch[i - 1], _scratch[i]);
+    }
+    double head = 0.0;
+    double best = _scratch.empty() ? 0.0 : _scratch[0];
+    split = _origin[a];
+    size_t k = _origin[a];
+    for (size_t i = 0; i < _scratch.size(); i++) {
+        head = std::max(head, segmentDistance(_points[k], pp, x));
+        k = (k + 1) % _originals;
+        double cost = std::max(head, i + 1 < _scratch.size() ? _scratch[i + 1] : 0.0);
+        if (cost < best) {
+            best = cost;
+            split = k;
+        }
+    }
+    return std::max(error, best);
+}
+
+void FenceSimplifier::refresh(size_t vertex) {
+    _version[vertex]++;
+    evaluate(vertex);
+}
+
+// ============================================================================
+// Steps
+// ============================================================================
+
+/**
+ * Whether a step keeps the ring simple: its new edges meet no other edge,
+ * and the region between the old and new edges holds no other vertex.
+ * Since the old edges already meet nothing, no other edge can then reach
+ * into the region either.
+ */
+bool FenceSimplifier::valid(const Candidate& candidate) const {
+    size_t first = _prev[candidate.vertex];
+    size_t last;
+    Point region[5];
+    size_t regionCount;
+    size_t ends[3];         // New edges run ends[0] -> ends[1] (-> ends[2])
+    size_t endCount;
+    Point x = toPoint(candidate.point);
+
+    if (candidate.step == Step::REMOVE) {
+        last = _next[candidate.vertex];
+        region[0] = _points[first];
+        region[1] = _points[last];
+        region[2] = _points[candidate.vertex];
+        regionCount = 3;
+        ends[0] = first;
+        ends[1] = last;
+        endCount = 2;
+    } else {
+        size_t b = _next[candidate.vertex];
+        last = _next[b];
+        region[0] = _points[first];
+        region[1] = x;
+        region[2] = _points[last];
+        region[3] = _points[b];
+        region[4] = _points[candidate.vertex];
+        regionCount = 5;
+        ends[0] = first;
+        ends[1] = NEW_POINT;
+        ends[2] = last;
+        endCount = 3;
+        if (segmentsFold(x, _points[first], _points[last])) {
+            return false;
+        }
+    }
+
+    // The rest of the ring: edges from last round to first
+    for (size_t w = last; w != first; w = _next[w]) {
+        size_t w2 = _next[w];
+        const Point& pw = _points[w];
+        const Point& pw2 = _points[w2];
+        if (w != last && insideOrOn(pw, region, regionCount)) {
+            return false;
+        }
+        for (size_t e = 0; e + 1 < endCount; e++) {
+            const Point& s = ends[e] == NEW_POINT ? x : _points[ends[e]];
+            const Point& t = ends[e + 1] == NEW_POINT ? x : _points[ends[e + 1]];
+            bool meet;
+            if (w2 == ends[e]) {
+                meet = segmentsFold(s, pw, t);
+            } else if (w == ends[e + 1]) {
+                meet = segmentsFold(t, s, pw2);
+            } else {
+                meet = segmentsMeet(s, t, pw, pw2);
+            }
+            if (meet) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void FenceSimplifier::apply(const Candidate& candidate) {
+    size_t p = _prev[candidate.vertex];
+    size_t n;
+    size_t added = NEW_POINT;
+    if (candidate.step == Step::REMOVE) {
+        n = _next[candidate.vertex];
+        _alive[candidate.vertex] = false;
+        _next[p] = n;
+        _prev[n] = p;
+        _stats.removals++;
+    } else {
+        size_t b = _next[candidate.vertex];
+        n = _next[b];
+        added = addVertex(candidate.point, candidate.split);
+        _alive[candidate.vertex] = false;
+        _alive[b] = false;
+        _next[p] = added;
+        _prev[added] = p;
+        _next[added] = n;
+        _prev[n] = added;
+        _stats.collapses++;
+    }
+    _count--;
+    _stats.errorMeters = std::max(_stats.errorMeters, static_cast<float>(candidate.error));
+
+    // Candidates that read the changed stretch: a collapse reads up to two
+    // vertices ahead, a removal one either side
+    size_t touched[] = {_prev[_prev[p]], _prev[p], p, n};
+    for (size_t vertex : touched) {
+        refresh(vertex);
+    }
+    if (added != NEW_POINT) {
+        refresh(added);
+    }
+}
@@ -0,0 +1,152 @@
+/**
+ * @file fence_simplify.h
+ * @brief Error-bounded, topology-preserving fence simplification for the host.
+ *
+ * Surveyed boundaries and parcel exports have hundreds of vertices, while
+ * the collar holds a few (MAX_BOUNDARY_VERTICES) and Polygon::contains()
+ * is linear in the vertex count. The simplifier reduces a ring to a
+ * vertex budget, or as far as a tolerance in meters allows, taking the
+ * cheapest step first:
+ *
+ *  - Vertex removal: p, v, n becomes p, n.
+ *  - Edge collapse (conservative modes): the edge a-b is replaced by the
+ *    point where the edges before and after it meet, so p, a, b, n
+ *    becomes p, x, n without cutting a corner.
+ *
+ * A step's error is how far the original boundary ends up from the new
+ * one. Steps that would make the ring touch or cross itself are refused,
+ * so the result is always a simple ring.
+ *
+ * The conservative modes only take steps that shrink (INNER) or grow
+ * (OUTER) the fence, so the result lies entirely inside, or entirely
+ * contains, the original. With INNER an escape is never reported late.
+ *
+ * Host only (std::vector); not part of the firmware.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef FENCE_SIMPLIFY_H
+#define FENCE_SIMPLIFY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "../point_in_polygon/point_in_polygon.h"
+
+// ============================================
+// TYPES
+// ============================================
+
+enum class FenceSimplifyMode : uint8_t {
+    ANY,        ///< Smallest error; the boundary may move either way
+    INNER,      ///< Inside the original: alerts fire early, never late
+    OUTER       ///< Contains the original: no alerts from inside it
+};
+
+struct FenceSimplifyOptions {
+    size_t maxVertices;         ///< Vertex budget (at least 3); 0 for none
+    float toleranceMeters;      ///< Keep simplifying while the error stays within this
+    FenceSimplifyMode mode;
+};
+
+struct FenceSimplifyStats {
+    size_t inputVertices;
+    size_t outputVertices;
+    float errorMeters;          ///< Farthest an original vertex is from the result
+    uint32_t removals;          ///< Vertex removals taken
+    uint32_t collapses;         ///< Edge collapses taken
+    uint32_t refused;           ///< Steps refused as they would break the ring
+};
+
+// ============================================
+// SIMPLIFIER CLASS
+// ============================================
+
+/**
+ * @brief Ring simplifier; reuse one to simplify many fences.
+ */
+class FenceSimplifier {
+public:
+    FenceSimplifier();
+
+    /**
+     * @brief Simplify one ring.
+     *
+     * Simplifies while the ring is over the vertex budget, then while the
+     * next step stays within the tolerance. The result keeps the input's
+     * orientation and, except for collapse points, its vertices.
+     *
+     * @param ring  A simple ring, not closed (see fenceImportNormalize()).
+     * @param out   Receives the simplified ring (replaced).
+     * @return false if the ring is not simple (out is then the input) or
+     *         the budget could not be met (out is the smallest ring reached).
+     */
+    bool simplify(const GeoPoint* ring, size_t count, const FenceSimplifyOptions& options,
+                  std::vector<GeoPoint>& out);
+
+    const FenceSimplifyStats& stats() const { return _stats; }
+
+    /**
+     * @brief Working coordinates: meters east and north of the first vertex.
+     */
+    struct Point {
+        double x;
+        double y;
+    };
+
+private:
+    enum class Step : uint8_t {
+        REMOVE,     ///< Remove the vertex
+        COLLAPSE    ///< Collapse the edge from the vertex to the next
+    };
+
+    struct Candidate {
+        double error;
+        size_t vertex;
+        uint32_t version;
+        Step step;
+        GeoPoint point;         ///< Collapse point
+        size_t split;           ///< First original the collapse point owns
+
+        bool operator>(const Candidate& other) const { return error > other.error; }
+    };
+
+    FenceSimplifyMode _mode;
+    FenceSimplifyStats _stats;
+    size_t _originals;
+    size_t _count;
+    double _lat0;
+    double _lon0;
+    double _metersPerLon;
+
+    // One entry per vertex: the originals, then collapse points
+    std::vector<GeoPoint> _geo;
+    std::vector<Point> _points;     ///< _geo in meters from the first vertex
+    std::vector<size_t> _origin;    ///< Original index; the edge from here owns originals up to the next vertex's
+    std::vector<size_t> _prev;
+    std::vector<size_t> _next;
+    std::vector<uint32_t> _version;
+    std::vector<bool> _alive;
+
+    std::vector<Candidate> _heap;
+    std::vector<Candidate> _blocked;
+    std::vector<double> _scratch;
+
+    Point toPoint(const GeoPoint& geo) const;
+    size_t addVertex(const GeoPoint& geo, size_t origin);
+    bool ringIsSimple() const;
+
+    bool modeAllows(double area) const;
+    double ownedError(size_t from, size_t to, const Point& a, const Point& b) const;
+    double originalDistance(size_t from, size_t to, const Point& point) const;
+    bool collapsePoint(size_t a, GeoPoint& point) const;
+    double collapseError(size_t a, const Point& x, size_t& split);
+    void evaluate(size_t vertex);
+    void refresh(size_t vertex);
+
+    bool valid(const Candidate& candidate) const;
+    void apply(const Candidate& candidate);
+};
+
+#endif // FENCE_SIMPLIFY_H
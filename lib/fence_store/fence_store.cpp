@@ -0,0 +1,393 @@
+/**
+ * @file fence_store.cpp
+ * @brief Implementation of the memory-mapped geofence store.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "fence_store.h"
+#include "../checksum/checksum.h"
+
+#include <string.h>
+
+#ifndef ESP_PLATFORM
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// Blob Helpers
+// ============================================================================
+
+size_t fenceBlobSize(size_t vertexCount) {
+    return sizeof(FenceBlobHeader) + vertexCount * sizeof(GeoPoint);
+}
+
+bool fenceBlobMakeHeader(const GeoPoint* vertices, size_t count,
+                         uint32_t fenceId, FenceBlobHeader& header) {
+    if (vertices == nullptr || count < 3 || count > FENCE_STORE_MAX_VERTICES) {
+        return false;
+    }
+
+    header.magic = FENCE_BLOB_MAGIC;
+    header.version = FENCE_BLOB_VERSION;
+    header.headerSize = sizeof(FenceBlobHeader);
+    header.fenceId = fenceId;
+    header.vertexCount = static_cast<uint32_t>(count);
+
+    // CRC covers the identifying fields and the vertex payload
+    uint32_t crc = crc32(&header.fenceId, sizeof(header.fenceId) + sizeof(header.vertexCount));
+    header.crc = crc32(vertices, count * sizeof(GeoPoint), crc);
+    return true;
+}
+
+size_t fenceBlobEncode(const GeoPoint* vertices, size_t count, uint32_t fenceId,
+                       uint8_t* out, size_t capacity) {
+    FenceBlobHeader header;
+    if (out == nullptr || !fenceBlobMakeHeader(vertices, count, fenceId, header)) {
+        return 0;
+    }
+
+    size_t size = fenceBlobSize(count);
+    if (capacity < size) {
+        return 0;
+    }
+
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), vertices, count * sizeof(GeoPoint));
+    return size;
+}
+
+const FenceBlobHeader* fenceBlobValidate(const uint8_t* blob, size_t size) {
+    if (blob == nullptr || size < sizeof(FenceBlobHeader)) {
+        return nullptr;
+    }
+
+    // Blob must be aligned so vertices can be read in place
+    if ((reinterpret_cast<uintptr_t>(blob) & 0x3) != 0) {
+        return nullptr;
+    }
+
+    const FenceBlobHeader* header = reinterpret_cast<const FenceBlobHeader*>(blob);
+    if (header->magic != FENCE_BLOB_MAGIC ||
+        header->version != FENCE_BLOB_VERSION ||
+        header->headerSize != sizeof(FenceBlobHeader)) {
+        return nullptr;
+    }
+
+    if (header->vertexCount < 3 || header->vertexCount > FENCE_STORE_MAX_VERTICES ||
+        fenceBlobSize(header->vertexCount) > size) {
+        return nullptr;
+    }
+
+    uint32_t crc = crc32(&header->fenceId, sizeof(header->fenceId) + sizeof(header->vertexCount));
+    crc = crc32(blob + sizeof(FenceBlobHeader), header->vertexCount * sizeof(GeoPoint), crc);
+    if (crc != header->crc) {
+        return nullptr;
+    }
+
+    return header;
+}
+
+const GeoPoint* fenceBlobVertices(const FenceBlobHeader* header) {
+    if (header == nullptr) {
+        return nullptr;
+    }
+    return reinterpret_cast<const GeoPoint*>(
+        reinterpret_cast<const uint8_t*>(header) + header->headerSize);
+}
+
+// ============================================================================
+// FenceStore Class Implementation
+// ============================================================================
+
+FenceStore::FenceStore()
+    : _mapped(nullptr)
+    , _mappedSize(0)
+    , _slots()
+    , _header(nullptr)
+    , _slotCount(0)
+#ifdef ESP_PLATFORM
+    , _partition(nullptr)
+    , _mmapHandle(0)
+#endif
+{
+#ifndef ESP_PLATFORM
+    _path[0] = '\0';
+#endif
+}
+
+FenceStore::~FenceStore() {
+    end();
+}
+
+bool FenceStore::begin(const char* location) {
+    if (location == nullptr) {
+        return false;
+    }
+
+    end();
+
+#ifdef ESP_PLATFORM
+    _partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                          ESP_PARTITION_SUBTYPE_ANY, location);
+    if (_partition == nullptr) {
+        return false;
+    }
+    // A partition from an older table has room for one slot, updated in place
+    _slotCount = _partition->size >= FENCE_STORE_SLOTS * FENCE_STORE_SLOT_SIZE ? FENCE_STORE_SLOTS : 1;
+#else
+    if (strlen(location) >= sizeof(_path)) {
+        return false;
+    }
+    strcpy(_path, location);
+    _slotCount = FENCE_STORE_SLOTS;
+#endif
+
+    map();
+    return true;
+}
+
+void FenceStore::end() {
+    unmap();
+    _slotCount = 0;
+#ifdef ESP_PLATFORM
+    _partition = nullptr;
+#else
+    _path[0] = '\0';
+#endif
+}
+
+bool FenceStore::isValid() const {
+    return _header != nullptr;
+}
+
+const GeoPoint* FenceStore::getVertices() const {
+    return fenceBlobVertices(_header);
+}
+
+size_t FenceStore::getVertexCount() const {
+    return _header != nullptr ? _header->vertexCount : 0;
+}
+
+uint32_t FenceStore::getFenceId() const {
+    return _header != nullptr ? _header->fenceId : 0;
+}
+
+uint32_t FenceStore::getCrc() const {
+    return _header != nullptr ? _header->crc : 0;
+}
+
+bool FenceStore::write(const GeoPoint* vertices, size_t count, uint32_t fenceId) {
+    FenceBlobHeader header;
+    if (_slotCount == 0 || !fenceBlobMakeHeader(vertices, count, fenceId, header)) {
+        return false;
+    }
+
+    size_t slot = stagingSlot();
+    size_t selected = selectedSlot();
+    bool ok = writeSlot(slot, header, vertices);
+
+    // Read back: the staged slot must hold exactly this fence
+    ok = ok && _slots[slot] != nullptr && _slots[slot]->crc == header.crc &&
+         _slots[slot]->fenceId == fenceId;
+    if (ok) {
+        _header = _slots[slot];
+    } else {
+        _header = selected < FENCE_STORE_SLOTS ? _slots[selected] : nullptr;
+    }
+    return ok;
+}
+
+bool FenceStore::selectFence(uint32_t fenceId) {
+    _header = nullptr;
+    if (fenceId == 0) {
+        _header = _slots[0];
+        return _header != nullptr;
+    }
+
+    for (size_t slot = 0; slot < FENCE_STORE_SLOTS; slot++) {
+        if (_slots[slot] != nullptr && _slots[slot]->fenceId == fenceId) {
+            _header = _slots[slot];
+            break;
+        }
+    }
+    return _header != nullptr;
+}
+
+void FenceStore::validateSlots() {
+    _header = nullptr;
+    for (size_t slot = 0; slot < FENCE_STORE_SLOTS; slot++) {
+        size_t offset = slot * FENCE_STORE_SLOT_SIZE;
+        _slots[slot] = nullptr;
+        if (slot < _slotCount && offset < _mappedSize) {
+            size_t size = _mappedSize - offset;
+            if (size > FENCE_STORE_SLOT_SIZE) {
+                size = FENCE_STORE_SLOT_SIZE;
+            }
+            _slots[slot] = fenceBlobValidate(_mapped + offset, size);
+        }
+        if (_header == nullptr) {
+            _header = _slots[slot];
+        }
+    }
+}
+
+size_t FenceStore::selectedSlot() const {
+    for (size_t slot = 0; slot < FENCE_STORE_SLOTS; slot++) {
+        if (_header != nullptr && _header == _slots[slot]) {
+            return slot;
+        }
+    }
+    return FENCE_STORE_SLOTS;
+}
+
+size_t FenceStore::stagingSlot() const {
+    if (_slotCount < FENCE_STORE_SLOTS) {
+        return 0;
+    }
+    // Never the selected slot; slot 0 only when slot 1 is in use
+    return selectedSlot() == 1 ? 0 : 1;
+}
+
+// ============================================================================
+// ESP32 Backend (esp_partition)
+// ============================================================================
+
+#ifdef ESP_PLATFORM
+
+bool FenceStore::map() {
+    unmap();
+    if (_partition == nullptr) {
+        return false;
+    }
+
+    const void* ptr = nullptr;
+    if (esp_partition_mmap(_partition, 0, _partition->size, SPI_FLASH_MMAP_DATA,
+                           &ptr, &_mmapHandle) != ESP_OK) {
+        return false;
+    }
+
+    _mapped = static_cast<const uint8_t*>(ptr);
+    _mappedSize = _partition->size;
+    validateSlots();
+    return _header != nullptr;
+}
+
+void FenceStore::unmap() {
+    if (_mapped != nullptr) {
+        spi_flash_munmap(_mmapHandle);
+    }
+    _mapped = nullptr;
+    _mappedSize = 0;
+    for (size_t slot = 0; slot < FENCE_STORE_SLOTS; slot++) {
+        _slots[slot] = nullptr;
+    }
+    _header = nullptr;
+}
+
+bool FenceStore::writeSlot(size_t slot, const FenceBlobHeader& header, const GeoPoint* vertices) {
+    if (_partition == nullptr) {
+        return false;
+    }
+
+    size_t offset = slot * FENCE_STORE_SLOT_SIZE;
+    size_t size = fenceBlobSize(header.vertexCount);
+    if (offset + size > _partition->size) {
+        return false;
+    }
+
+    // Drop the mapping so readers never see a half-written fence
+    unmap();
+
+    // Vertices first, header last: the header completes the slot
+    size_t eraseSize = (size + SPI_FLASH_SEC_SIZE - 1) & ~(SPI_FLASH_SEC_SIZE - 1);
+    bool ok = esp_partition_erase_range(_partition, offset, eraseSize) == ESP_OK &&
+              esp_partition_write(_partition, offset + sizeof(header), vertices,
+                                  header.vertexCount * sizeof(GeoPoint)) == ESP_OK &&
+              esp_partition_write(_partition, offset, &header, sizeof(header)) == ESP_OK;
+
+    map();
+    return ok;
+}
+
+// ============================================================================
+// Native Backend (POSIX file + mmap)
+// ============================================================================
+
+#else
+
+bool FenceStore::map() {
+    unmap();
+    if (_path[0] == '\0') {
+        return false;
+    }
+
+    int fd = open(_path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    void* ptr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // Mapping stays valid after the descriptor is closed
+    if (ptr == MAP_FAILED) {
+        return false;
+    }
+
+    _mapped = static_cast<const uint8_t*>(ptr);
+    _mappedSize = static_cast<size_t>(st.st_size);
+    validateSlots();
+    return _header != nullptr;
+}
+
+void FenceStore::unmap() {
+    if (_mapped != nullptr) {
+        munmap(const_cast<uint8_t*>(_mapped), _mappedSize);
+    }
+    _mapped = nullptr;
+    _mappedSize = 0;
+    for (size_t slot = 0; slot < FENCE_STORE_SLOTS; slot++) {
+        _slots[slot] = nullptr;
+    }
+    _header = nullptr;
+}
+
+bool FenceStore::writeSlot(size_t slot, const FenceBlobHeader& header, const GeoPoint* vertices) {
+    if (_path[0] == '\0') {
+        return false;
+    }
+
+    unmap();
+
+    int fd = open(_path, O_RDWR | O_CREAT, 0644);
+    bool ok = fd >= 0;
+    if (ok) {
+        off_t offset = static_cast<off_t>(slot * FENCE_STORE_SLOT_SIZE);
+        size_t dataSize = header.vertexCount * sizeof(GeoPoint);
+
+        // Blank the header first, as the erase does on flash; vertices
+        // next, header last: the header completes the slot
+        FenceBlobHeader blank;
+        memset(&blank, 0xFF, sizeof(blank));
+        ok = pwrite(fd, &blank, sizeof(blank), offset) == static_cast<ssize_t>(sizeof(blank)) &&
+             pwrite(fd, vertices, dataSize, offset + static_cast<off_t>(sizeof(header))) ==
+                 static_cast<ssize_t>(dataSize) &&
+             fsync(fd) == 0 &&
+             pwrite(fd, &header, sizeof(header), offset) == static_cast<ssize_t>(sizeof(header)) &&
+             fsync(fd) == 0;
+        close(fd);
+    }
+
+    map();
+    return ok;
+}
+
+#endif
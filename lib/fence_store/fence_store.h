@@ -0,0 +1,260 @@
+/**
+ * @file fence_store.h
+ * @brief Zero-copy geofence storage in a dedicated raw flash partition.
+ *
+ * Large geofences do not fit the one-NVS-key-per-vertex scheme used by
+ * ConfigManager. FenceStore keeps the fence as a single compact binary
+ * blob and memory-maps it, so a Polygon can point directly at the mapped
+ * vertex data without copying anything into heap.
+ *
+ * The storage is split into two slots. A new fence is staged into the
+ * slot that is not in use, so the active fence survives a write that is
+ * interrupted or fails; the caller commits it by recording its fence ID.
+ *
+ * Backends:
+ * - ESP32: raw data partition read through esp_partition_mmap().
+ * - Native: regular file read through POSIX mmap() (used by unit tests).
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef FENCE_STORE_H
+#define FENCE_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../point_in_polygon/point_in_polygon.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_partition.h>
+#endif
+
+// ============================================
+// BLOB FORMAT
+// ============================================
+//
+// Little-endian, 4-byte aligned so the vertex array can be used in place:
+//
+//   offset  size  field
+//   0       4     magic ("UCFS")
+//   4       2     format version
+//   6       2     header size in bytes
+//   8       4     fence ID (versioned by the sender, opaque here)
+//   12      4     vertex count
+//   16      4     CRC-32 over bytes 8..15 followed by the vertex data
+//   20      8*n   GeoPoint vertices (float lat, float lon)
+//
+// Slot 0 starts at offset 0 of the partition, slot 1 at
+// FENCE_STORE_SLOT_SIZE. A blob flashed from the host lands in slot 0.
+
+constexpr uint32_t FENCE_BLOB_MAGIC = 0x53464355;  // "UCFS"
+constexpr uint16_t FENCE_BLOB_VERSION = 1;
+
+// Upper bound on stored fence size (32 KB of vertex data)
+constexpr size_t FENCE_STORE_MAX_VERTICES = 4096;
+
+// Size of one slot; the partition holds FENCE_STORE_SLOTS of them
+constexpr size_t FENCE_STORE_SLOT_SIZE = 0x10000;
+constexpr size_t FENCE_STORE_SLOTS = 2;
+
+// Partition label (ESP32) used by the collar firmware
+constexpr char FENCE_STORE_PARTITION_LABEL[] = "fence";
+
+/**
+ * @brief On-flash header preceding the vertex array.
+ */
+struct FenceBlobHeader {
+    uint32_t magic;         ///< FENCE_BLOB_MAGIC
+    uint16_t version;       ///< FENCE_BLOB_VERSION
+    uint16_t headerSize;    ///< sizeof(FenceBlobHeader)
+    uint32_t fenceId;       ///< Sender-assigned fence ID
+    uint32_t vertexCount;   ///< Number of GeoPoint entries that follow
+    uint32_t crc;           ///< CRC-32 of fenceId, vertexCount and vertices
+};
+
+static_assert(sizeof(FenceBlobHeader) == 20, "FenceBlobHeader layout changed");
+static_assert(sizeof(GeoPoint) == 8, "GeoPoint must be two packed floats");
+static_assert(sizeof(FenceBlobHeader) + FENCE_STORE_MAX_VERTICES * sizeof(GeoPoint) <=
+              FENCE_STORE_SLOT_SIZE, "The largest fence must fit one slot");
+
+// ============================================
+// BLOB HELPERS (platform independent)
+// ============================================
+
+/**
+ * @brief Size in bytes of a blob holding the given number of vertices.
+ */
+size_t fenceBlobSize(size_t vertexCount);
+
+/**
+ * @brief Build the header for a vertex array.
+ *
+ * @param vertices Vertex array to describe.
+ * @param count    Number of vertices.
+ * @param fenceId  Fence ID to record.
+ * @param header   Output header.
+ * @return true on success, false if count is out of range or vertices is null.
+ */
+bool fenceBlobMakeHeader(const GeoPoint* vertices, size_t count,
+                         uint32_t fenceId, FenceBlobHeader& header);
+
+/**
+ * @brief Serialize a fence into a caller-provided buffer.
+ *
+ * @return Number of bytes written, or 0 if the buffer is too small or the
+ *         fence is invalid.
+ */
+size_t fenceBlobEncode(const GeoPoint* vertices, size_t count, uint32_t fenceId,
+                       uint8_t* out, size_t capacity);
+
+/**
+ * @brief Validate a blob in memory (magic, version, bounds and CRC).
+ *
+ * @param blob Pointer to the start of the blob (must be 4-byte aligned).
+ * @param size Number of readable bytes at blob.
+ * @return Pointer to the header if valid, nullptr otherwise.
+ */
+const FenceBlobHeader* fenceBlobValidate(const uint8_t* blob, size_t size);
+
+/**
+ * @brief Get the vertex array of a validated blob.
+ */
+const GeoPoint* fenceBlobVertices(const FenceBlobHeader* header);
+
+// ============================================
+// FENCE STORE CLASS
+// ============================================
+
+/**
+ * @brief Memory-mapped, read-mostly geofence store.
+ *
+ * One slot is selected at a time, and the accessors describe the fence in
+ * it. After begin(), getVertices() points straight into mapped flash (or
+ * the mapped file on native builds). The pointer stays valid until
+ * write(), selectFence() or end() is called, so a Polygon built from it
+ * must be rebuilt after any of them.
+ *
+ * @note write() erases and reprograms a slot; it is intended for rare
+ *       fence updates, not for the wake-time hot path.
+ */
+class FenceStore {
+public:
+    FenceStore();
+    ~FenceStore();
+
+    /**
+     * @brief Open and map the backing storage.
+     *
+     * Selects the first slot that holds a valid fence.
+     *
+     * @param location Partition label on ESP32, file path on native builds.
+     * @return true if the storage was opened, even if it holds no valid fence.
+     */
+    bool begin(const char* location);
+
+    /**
+     * @brief Unmap and release the backing storage.
+     */
+    void end();
+
+    /**
+     * @brief Stage a fence into the slot that is not selected.
+     *
+     * Slot 1 is used if no slot is selected, as slot 0 is where the host
+     * flashes a fence. The vertex data is written before the header and the
+     * slot is read back and CRC-checked, then selected. A power loss during
+     * the write leaves that slot invalid and the other one untouched.
+     *
+     * Nothing records which slot is active: the caller commits the fence by
+     * storing its ID, and selects it with selectFence() on the next boot.
+     *
+     * @param vertices Vertex array (min 3, max FENCE_STORE_MAX_VERTICES).
+     * @param count    Number of vertices.
+     * @param fenceId  Fence ID to store alongside the vertices.
+     * @return true if written, verified and selected.
+     */
+    bool write(const GeoPoint* vertices, size_t count, uint32_t fenceId);
+
+    /**
+     * @brief Select the slot that holds a fence.
+     *
+     * @param fenceId Fence ID to look for, or 0 for the fence flashed from
+     *                the host (slot 0, whatever its ID).
+     * @return true if a valid fence was found; otherwise nothing is selected.
+     */
+    bool selectFence(uint32_t fenceId);
+
+    /**
+     * @brief Check whether a valid fence is selected.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Get the mapped vertex array (nullptr if not valid).
+     */
+    const GeoPoint* getVertices() const;
+
+    /**
+     * @brief Get the number of mapped vertices (0 if not valid).
+     */
+    size_t getVertexCount() const;
+
+    /**
+     * @brief Get the stored fence ID (0 if not valid).
+     */
+    uint32_t getFenceId() const;
+
+    /**
+     * @brief Get the blob CRC of the selected fence (0 if not valid).
+     *
+     * Covers the fence ID and every vertex, so it identifies the fence.
+     */
+    uint32_t getCrc() const;
+
+private:
+    const uint8_t* _mapped;          ///< Start of mapped region
+    size_t _mappedSize;              ///< Size of mapped region
+    const FenceBlobHeader* _slots[FENCE_STORE_SLOTS];  ///< Validated header per slot, or nullptr
+    const FenceBlobHeader* _header;  ///< Selected slot's header, or nullptr
+    size_t _slotCount;               ///< Slots the storage has room for
+
+#ifdef ESP_PLATFORM
+    const esp_partition_t* _partition;
+    spi_flash_mmap_handle_t _mmapHandle;
+#else
+    char _path[256];
+#endif
+
+    /**
+     * @brief Map the backing storage and validate each slot.
+     */
+    bool map();
+
+    /**
+     * @brief Validate the slots of the current mapping and select the first
+     *        valid one.
+     */
+    void validateSlots();
+
+    /**
+     * @brief Index of the selected slot, or FENCE_STORE_SLOTS if none.
+     */
+    size_t selectedSlot() const;
+
+    /**
+     * @brief Slot the next write() goes to.
+     */
+    size_t stagingSlot() const;
+
+    /**
+     * @brief Erase and program one slot, then map the storage again.
+     */
+    bool writeSlot(size_t slot, const FenceBlobHeader& header, const GeoPoint* vertices);
+
+    /**
+     * @brief Release the current mapping, if any.
+     */
+    void unmap();
+};
+
+#endif // FENCE_STORE_H
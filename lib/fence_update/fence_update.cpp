@@ -0,0 +1,424 @@
+/**
+ * @file fence_update.cpp
+ * @brief Implementation of the chunked geofence update protocol.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "fence_update.h"
+#include "../checksum/checksum.h"
+
+#include <string.h>
+
+// ============================================================================
+// Byte Helpers
+// ============================================================================
+
+static void put16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+}
+
+static void put32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+
+static uint16_t get16(const uint8_t* data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+static uint32_t get32(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) |
+           (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) |
+           (static_cast<uint32_t>(data[3]) << 24);
+}
+
+static void putFloat(uint8_t* out, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put32(out, bits);
+}
+
+static float getFloat(const uint8_t* data) {
+    uint32_t bits = get32(data);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Append the CRC-16 trailer over the first length bytes.
+ * @return Total message length including the trailer.
+ */
+static size_t sealMessage(uint8_t* msg, size_t length) {
+    put16(msg + length, crc16(msg, length));
+    return length + 2;
+}
+
+/**
+ * @brief Check the CRC-16 trailer of a received message.
+ */
+static bool messageIntact(const uint8_t* msg, size_t length) {
+    if (length < 3) {
+        return false;
+    }
+    return crc16(msg, length - 2) == get16(msg + length - 2);
+}
+
+static uint8_t chunksFor(size_t vertexCount) {
+    return static_cast<uint8_t>((vertexCount + FENCE_CHUNK_VERTICES - 1) / FENCE_CHUNK_VERTICES);
+}
+
+static uint32_t fullMask(uint8_t chunkCount) {
+    return chunkCount >= 32 ? 0xFFFFFFFFu : ((1u << chunkCount) - 1);
+}
+
+static size_t chunkVertexCount(size_t vertexCount, uint8_t index) {
+    size_t first = static_cast<size_t>(index) * FENCE_CHUNK_VERTICES;
+    size_t remaining = vertexCount - first;
+    return remaining < FENCE_CHUNK_VERTICES ? remaining : FENCE_CHUNK_VERTICES;
+}
+
+static size_t buildStatus(uint32_t version, FenceUpdateStatus status, uint32_t mask,
+                          uint8_t* out, size_t capacity) {
+    if (out == nullptr || capacity < FENCE_MSG_STATUS_SIZE) {
+        return 0;
+    }
+    out[0] = FENCE_MSG_STATUS;
+    put32(out + 1, version);
+    out[5] = static_cast<uint8_t>(status);
+    put32(out + 6, mask);
+    return sealMessage(out, 10);
+}
+
+// ============================================================================
+// Receiver
+// ============================================================================
+
+FenceUpdateReceiver::FenceUpdateReceiver(FenceUpdateState& state, FenceUpdateTarget& target)
+    : _state(state)
+    , _target(target) {
+}
+
+size_t FenceUpdateReceiver::handle(const uint8_t* msg, size_t length,
+                                   uint8_t* reply, size_t replyCapacity) {
+    if (msg == nullptr || !messageIntact(msg, length)) {
+        return 0;
+    }
+
+    switch (msg[0]) {
+        case FENCE_MSG_BEGIN:
+            return handleBegin(msg, length, reply, replyCapacity);
+        case FENCE_MSG_CHUNK:
+            return handleChunk(msg, length, reply, replyCapacity);
+        case FENCE_MSG_PATCH:
+            return handlePatch(msg, length, reply, replyCapacity);
+        default:
+            return 0;
+    }
+}
+
+bool FenceUpdateReceiver::isReceiving() const {
+    return _state.version != 0;
+}
+
+size_t FenceUpdateReceiver::handleBegin(const uint8_t* msg, size_t length,
+                                        uint8_t* reply, size_t capacity) {
+    if (length != FENCE_MSG_BEGIN_SIZE) {
+        return 0;
+    }
+
+    uint32_t version = get32(msg + 1);
+    uint16_t vertexCount = get16(msg + 5);
+    uint8_t chunkCount = msg[7];
+    uint32_t fenceCrc = get32(msg + 8);
+
+    if (version == 0) {
+        return 0;
+    }
+
+    // Already applied: the base station missed our COMPLETE
+    if (version == _target.currentVersion()) {
+        return buildStatus(version, FenceUpdateStatus::COMPLETE, 0, reply, capacity);
+    }
+
+    if (vertexCount < 3 || vertexCount > FENCE_UPDATE_MAX_VERTICES ||
+        chunkCount != chunksFor(vertexCount)) {
+        return buildStatus(version, FenceUpdateStatus::REJECTED, 0, reply, capacity);
+    }
+
+    // Same transfer as the one in progress: keep the chunks we already have
+    bool resume = _state.version == version &&
+                  _state.vertexCount == vertexCount &&
+                  _state.fenceCrc == fenceCrc;
+    if (!resume) {
+        _state.version = version;
+        _state.fenceCrc = fenceCrc;
+        _state.vertexCount = vertexCount;
+        _state.chunkCount = chunkCount;
+        _state.receivedMask = 0;
+    }
+
+    return buildStatus(version, FenceUpdateStatus::RECEIVING, _state.receivedMask,
+                       reply, capacity);
+}
+
+size_t FenceUpdateReceiver::handleChunk(const uint8_t* msg, size_t length,
+                                        uint8_t* reply, size_t capacity) {
+    if (length < 8) {
+        return 0;
+    }
+
+    uint32_t version = get32(msg + 1);
+    uint8_t index = msg[5];
+
+    // Stray chunk from a transfer we are not (or no longer) part of
+    if (version == 0 || version != _state.version || index >= _state.chunkCount) {
+        return 0;
+    }
+
+    size_t count = chunkVertexCount(_state.vertexCount, index);
+    if (length != 8 + count * sizeof(GeoPoint)) {
+        return 0;
+    }
+
+    GeoPoint* dest = &_state.staging[static_cast<size_t>(index) * FENCE_CHUNK_VERTICES];
+    const uint8_t* src = msg + 6;
+    for (size_t i = 0; i < count; i++) {
+        dest[i].lat = getFloat(src);
+        dest[i].lon = getFloat(src + 4);
+        src += sizeof(GeoPoint);
+    }
+    _state.receivedMask |= 1u << index;
+
+    if (_state.receivedMask == fullMask(_state.chunkCount)) {
+        return finish(reply, capacity);
+    }
+
+    // End of a round: tell the base station what is still missing
+    if (index == _state.chunkCount - 1) {
+        return buildStatus(version, FenceUpdateStatus::RECEIVING, _state.receivedMask,
+                           reply, capacity);
+    }
+    return 0;
+}
+
+size_t FenceUpdateReceiver::handlePatch(const uint8_t* msg, size_t length,
+                                        uint8_t* reply, size_t capacity) {
+    if (length != FENCE_MSG_PATCH_SIZE) {
+        return 0;
+    }
+
+    uint32_t newVersion = get32(msg + 1);
+    uint32_t baseVersion = get32(msg + 5);
+    FencePatchOp op = static_cast<FencePatchOp>(msg[9]);
+    uint16_t index = get16(msg + 10);
+    GeoPoint vertex = { getFloat(msg + 12), getFloat(msg + 16) };
+
+    if (newVersion == 0) {
+        return 0;
+    }
+
+    // Retransmitted patch that was already applied
+    if (newVersion == _target.currentVersion()) {
+        return buildStatus(newVersion, FenceUpdateStatus::COMPLETE, 0, reply, capacity);
+    }
+
+    const GeoPoint* current = _target.currentVertices();
+    size_t count = _target.currentVertexCount();
+    if (baseVersion != _target.currentVersion() || current == nullptr ||
+        count > FENCE_UPDATE_MAX_VERTICES) {
+        return buildStatus(newVersion, FenceUpdateStatus::REJECTED, 0, reply, capacity);
+    }
+
+    // The patch is assembled in the staging area, which abandons any
+    // partially received transfer
+    GeoPoint* staging = _state.staging;
+    memmove(staging, current, count * sizeof(GeoPoint));
+    _state.version = 0;
+    _state.receivedMask = 0;
+
+    bool valid = false;
+    switch (op) {
+        case FencePatchOp::SET:
+            if (index < count) {
+                staging[index] = vertex;
+                valid = true;
+            }
+            break;
+        case FencePatchOp::INSERT:
+            if (index <= count && count < FENCE_UPDATE_MAX_VERTICES) {
+                memmove(&staging[index + 1], &staging[index], (count - index) * sizeof(GeoPoint));
+                staging[index] = vertex;
+                count++;
+                valid = true;
+            }
+            break;
+        case FencePatchOp::REMOVE:
+            if (index < count && count > 3) {
+                memmove(&staging[index], &staging[index + 1], (count - index - 1) * sizeof(GeoPoint));
+                count--;
+                valid = true;
+            }
+            break;
+    }
+
+    if (!valid || !_target.commit(staging, count, newVersion)) {
+        return buildStatus(newVersion, FenceUpdateStatus::REJECTED, 0, reply, capacity);
+    }
+
+    return buildStatus(newVersion, FenceUpdateStatus::COMPLETE, 0, reply, capacity);
+}
+
+size_t FenceUpdateReceiver::finish(uint8_t* reply, size_t capacity) {
+    uint32_t version = _state.version;
+    size_t count = _state.vertexCount;
+
+    bool ok = crc32(_state.staging, count * sizeof(GeoPoint)) == _state.fenceCrc &&
+              _target.commit(_state.staging, count, version);
+
+    // Either way this transfer is over; a rejected fence must be resent in full
+    _state.version = 0;
+    _state.receivedMask = 0;
+
+    return buildStatus(version, ok ? FenceUpdateStatus::COMPLETE : FenceUpdateStatus::REJECTED,
+                       0, reply, capacity);
+}
+
+// ============================================================================
+// Sender
+// ============================================================================
+
+FenceUpdateSender::FenceUpdateSender()
+    : _vertices(nullptr)
+    , _count(0)
+    , _version(0)
+    , _fenceCrc(0)
+    , _confirmedMask(0)
+    , _chunkCount(0)
+    , _nextChunk(0)
+    , _beginSent(false)
+    , _complete(false)
+    , _rejected(false) {
+}
+
+bool FenceUpdateSender::begin(const GeoPoint* vertices, size_t count, uint32_t version) {
+    if (vertices == nullptr || count < 3 || count > FENCE_UPDATE_MAX_VERTICES || version == 0) {
+        return false;
+    }
+
+    _vertices = vertices;
+    _count = count;
+    _version = version;
+    _fenceCrc = crc32(vertices, count * sizeof(GeoPoint));
+    _chunkCount = chunksFor(count);
+    _confirmedMask = 0;
+    _complete = false;
+    _rejected = false;
+    startRound();
+    return true;
+}
+
+void FenceUpdateSender::startRound() {
+    _beginSent = false;
+    _nextChunk = 0;
+}
+
+size_t FenceUpdateSender::nextMessage(uint8_t* out, size_t capacity) {
+    if (_vertices == nullptr || _complete || _rejected || out == nullptr) {
+        return 0;
+    }
+
+    if (!_beginSent) {
+        if (capacity < FENCE_MSG_BEGIN_SIZE) {
+            return 0;
+        }
+        out[0] = FENCE_MSG_BEGIN;
+        put32(out + 1, _version);
+        put16(out + 5, static_cast<uint16_t>(_count));
+        out[7] = _chunkCount;
+        put32(out + 8, _fenceCrc);
+        _beginSent = true;
+        return sealMessage(out, 12);
+    }
+
+    // Skip chunks the collar already confirmed
+    while (_nextChunk < _chunkCount && (_confirmedMask & (1u << _nextChunk))) {
+        _nextChunk++;
+    }
+    if (_nextChunk >= _chunkCount) {
+        return 0;
+    }
+
+    uint8_t index = _nextChunk;
+    size_t count = chunkVertexCount(_count, index);
+    if (capacity < 8 + count * sizeof(GeoPoint)) {
+        return 0;
+    }
+
+    out[0] = FENCE_MSG_CHUNK;
+    put32(out + 1, _version);
+    out[5] = index;
+    const GeoPoint* src = &_vertices[static_cast<size_t>(index) * FENCE_CHUNK_VERTICES];
+    uint8_t* dest = out + 6;
+    for (size_t i = 0; i < count; i++) {
+        putFloat(dest, src[i].lat);
+        putFloat(dest + 4, src[i].lon);
+        dest += sizeof(GeoPoint);
+    }
+    _nextChunk++;
+    return sealMessage(out, 6 + count * sizeof(GeoPoint));
+}
+
+bool FenceUpdateSender::handleStatus(const uint8_t* msg, size_t length) {
+    if (msg == nullptr || length != FENCE_MSG_STATUS_SIZE || !messageIntact(msg, length) ||
+        msg[0] != FENCE_MSG_STATUS || get32(msg + 1) != _version) {
+        return false;
+    }
+
+    switch (static_cast<FenceUpdateStatus>(msg[5])) {
+        case FenceUpdateStatus::RECEIVING:
+            _confirmedMask = get32(msg + 6) & fullMask(_chunkCount);
+            return true;
+        case FenceUpdateStatus::COMPLETE:
+            _confirmedMask = fullMask(_chunkCount);
+            _complete = true;
+            return true;
+        case FenceUpdateStatus::REJECTED:
+            _rejected = true;
+            return true;
+    }
+    return false;
+}
+
+bool FenceUpdateSender::isComplete() const {
+    return _complete;
+}
+
+bool FenceUpdateSender::isRejected() const {
+    return _rejected;
+}
+
+uint8_t FenceUpdateSender::chunkCount() const {
+    return _chunkCount;
+}
+
+size_t FenceUpdateSender::buildPatch(uint32_t baseVersion, uint32_t newVersion,
+                                     FencePatchOp op, uint16_t index, const GeoPoint& vertex,
+                                     uint8_t* out, size_t capacity) {
+    if (out == nullptr || capacity < FENCE_MSG_PATCH_SIZE) {
+        return 0;
+    }
+    out[0] = FENCE_MSG_PATCH;
+    put32(out + 1, newVersion);
+    put32(out + 5, baseVersion);
+    out[9] = static_cast<uint8_t>(op);
+    put16(out + 10, index);
+    putFloat(out + 12, vertex.lat);
+    putFloat(out + 16, vertex.lon);
+    return sealMessage(out, 20);
+}
@@ -0,0 +1,221 @@
+/**
+ * @file fence_update.h
+ * @brief Chunked, resumable over-the-air geofence update protocol.
+ *
+ * A fence larger than a few vertices does not fit in one LoRa frame. The
+ * base station splits it into fixed-size chunks, each message carrying a
+ * CRC-16. The collar tracks received chunks in a bitmap kept in RTC
+ * memory, so an interrupted transfer resumes with only the missing chunks.
+ * The new fence is handed to the FenceUpdateTarget in one step, and only
+ * after the whole-fence CRC-32 matches.
+ *
+ * Small edits do not need a full transfer: a PATCH message sets, inserts
+ * or deletes a single vertex against a known base version.
+ *
+ * The protocol is portable C++ with no Arduino dependencies, so both ends
+ * are tested natively over a lossy in-process link.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef FENCE_UPDATE_H
+#define FENCE_UPDATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../point_in_polygon/point_in_polygon.h"
+
+// ============================================
+// PROTOCOL CONSTANTS
+// ============================================
+//
+// All messages are little-endian and end with a CRC-16/CCITT over all
+// preceding bytes.
+//
+//   BEGIN  (base -> collar): type, fenceVersion(4), vertexCount(2),
+//                            chunkCount(1), fenceCrc32(4), crc16
+//   CHUNK  (base -> collar): type, fenceVersion(4), index(1),
+//                            vertices(8 * n, n <= 8), crc16
+//   PATCH  (base -> collar): type, newVersion(4), baseVersion(4), op(1),
+//                            index(2), lat(4), lon(4), crc16
+//   STATUS (collar -> base): type, fenceVersion(4), status(1),
+//                            receivedMask(4), crc16
+//
+// fenceVersion is (fence ID << 16) | revision. Version 0 is reserved for
+// the built-in default fence and is never sent.
+
+constexpr uint8_t FENCE_MSG_BEGIN = 0x10;
+constexpr uint8_t FENCE_MSG_CHUNK = 0x11;
+constexpr uint8_t FENCE_MSG_PATCH = 0x12;
+constexpr uint8_t FENCE_MSG_STATUS = 0x13;
+
+constexpr size_t FENCE_CHUNK_VERTICES = 8;
+constexpr size_t FENCE_UPDATE_MAX_CHUNKS = 32;  // One bit each in a uint32_t
+constexpr size_t FENCE_UPDATE_MAX_VERTICES = FENCE_CHUNK_VERTICES * FENCE_UPDATE_MAX_CHUNKS;
+
+constexpr size_t FENCE_MSG_BEGIN_SIZE = 14;
+constexpr size_t FENCE_MSG_CHUNK_MAX_SIZE = 8 + FENCE_CHUNK_VERTICES * sizeof(GeoPoint);
+constexpr size_t FENCE_MSG_PATCH_SIZE = 22;
+constexpr size_t FENCE_MSG_STATUS_SIZE = 12;
+constexpr size_t FENCE_MSG_MAX_SIZE = FENCE_MSG_CHUNK_MAX_SIZE;
+
+/**
+ * @brief Status reported by the collar.
+ */
+enum class FenceUpdateStatus : uint8_t {
+    RECEIVING = 0,  ///< Transfer in progress, see receivedMask
+    COMPLETE = 1,   ///< Fence is active on the collar
+    REJECTED = 2    ///< Invalid fence, failed CRC, or patch base mismatch
+};
+
+/**
+ * @brief Vertex operation carried by a PATCH message.
+ */
+enum class FencePatchOp : uint8_t {
+    SET = 0,     ///< Replace vertex at index
+    INSERT = 1,  ///< Insert vertex before index (index == count appends)
+    REMOVE = 2   ///< Remove vertex at index (lat/lon ignored)
+};
+
+/**
+ * @brief Compose a fence version from an ID and a revision.
+ */
+inline uint32_t fenceVersionMake(uint16_t fenceId, uint16_t revision) {
+    return (static_cast<uint32_t>(fenceId) << 16) | revision;
+}
+
+// ============================================
+// COLLAR SIDE
+// ============================================
+
+/**
+ * @brief Where a completed fence goes (implemented by the firmware).
+ *
+ * commit() is called exactly once per completed update, with the fully
+ * assembled and CRC-checked vertex array. It must apply the fence as a
+ * whole or not at all.
+ */
+class FenceUpdateTarget {
+public:
+    virtual ~FenceUpdateTarget() {}
+
+    virtual uint32_t currentVersion() const = 0;
+    virtual const GeoPoint* currentVertices() const = 0;
+    virtual size_t currentVertexCount() const = 0;
+    virtual bool commit(const GeoPoint* vertices, size_t count, uint32_t version) = 0;
+};
+
+/**
+ * @brief Receiver state (POD, intended for RTC memory so transfers resume
+ *        across deep sleep).
+ */
+struct FenceUpdateState {
+    uint32_t version;        ///< Version being received (0 = idle)
+    uint32_t fenceCrc;       ///< Expected CRC-32 of the assembled vertices
+    uint32_t receivedMask;   ///< Bit i set when chunk i has been received
+    uint16_t vertexCount;    ///< Vertices in the incoming fence
+    uint8_t chunkCount;      ///< Chunks in the incoming fence
+    GeoPoint staging[FENCE_UPDATE_MAX_VERTICES];
+};
+
+/**
+ * @brief Collar-side protocol handler.
+ */
+class FenceUpdateReceiver {
+public:
+    /**
+     * @param state  Persistent receiver state (zero-initialized = idle).
+     * @param target Destination for completed fences.
+     */
+    FenceUpdateReceiver(FenceUpdateState& state, FenceUpdateTarget& target);
+
+    /**
+     * @brief Handle one downlink message.
+     *
+     * @param msg           Received message.
+     * @param length        Message length.
+     * @param reply         Buffer for a STATUS reply (FENCE_MSG_STATUS_SIZE).
+     * @param replyCapacity Size of reply.
+     * @return Length of the reply to send, or 0 for no reply.
+     */
+    size_t handle(const uint8_t* msg, size_t length, uint8_t* reply, size_t replyCapacity);
+
+    /**
+     * @brief Check whether a transfer is in progress.
+     */
+    bool isReceiving() const;
+
+private:
+    FenceUpdateState& _state;
+    FenceUpdateTarget& _target;
+
+    size_t handleBegin(const uint8_t* msg, size_t length, uint8_t* reply, size_t capacity);
+    size_t handleChunk(const uint8_t* msg, size_t length, uint8_t* reply, size_t capacity);
+    size_t handlePatch(const uint8_t* msg, size_t length, uint8_t* reply, size_t capacity);
+    size_t finish(uint8_t* reply, size_t capacity);
+};
+
+// ============================================
+// BASE STATION SIDE
+// ============================================
+
+/**
+ * @brief Base-station-side sender for full fence transfers.
+ *
+ * Each round starts with BEGIN and then sends every chunk the collar has
+ * not confirmed. After a round, wait for a STATUS (or a timeout) and call
+ * startRound() again until isComplete().
+ */
+class FenceUpdateSender {
+public:
+    FenceUpdateSender();
+
+    /**
+     * @brief Prepare a transfer. The vertex array must outlive the transfer.
+     * @return false if the fence is too small, too large or version is 0.
+     */
+    bool begin(const GeoPoint* vertices, size_t count, uint32_t version);
+
+    /**
+     * @brief Restart sending from BEGIN, skipping chunks already confirmed.
+     */
+    void startRound();
+
+    /**
+     * @brief Produce the next message of the current round.
+     * @return Message length, or 0 when the round is finished.
+     */
+    size_t nextMessage(uint8_t* out, size_t capacity);
+
+    /**
+     * @brief Process a STATUS reply from the collar.
+     * @return false if the message is not a valid STATUS for this transfer.
+     */
+    bool handleStatus(const uint8_t* msg, size_t length);
+
+    bool isComplete() const;
+    bool isRejected() const;
+    uint8_t chunkCount() const;
+
+    /**
+     * @brief Build a single-vertex PATCH message.
+     * @return Message length, or 0 if the buffer is too small.
+     */
+    static size_t buildPatch(uint32_t baseVersion, uint32_t newVersion,
+                             FencePatchOp op, uint16_t index, const GeoPoint& vertex,
+                             uint8_t* out, size_t capacity);
+
+private:
+    const GeoPoint* _vertices;
+    size_t _count;
+    uint32_t _version;
+    uint32_t _fenceCrc;
+    uint32_t _confirmedMask;
+    uint8_t _chunkCount;
+    uint8_t _nextChunk;
+    bool _beginSent;
+    bool _complete;
+    bool _rejected;
+};
+
+#endif // FENCE_UPDATE_H
@@ -0,0 +1,434 @@
+/**
+ * @file fence_validate.cpp
+ * @brief Implementation of fence validation and repair.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "fence_validate.h"
+
+#include <math.h>
+#include <algorithm>
+#include <new>
+
+// Treap link for "no node"
+static const uint16_t NONE = 0xFFFF;
+
+// ============================================================================
+// Geometry
+// ============================================================================
+
+// Twice the signed area of a, b, c: positive when c is left of a->b (x = lon,
+// y = lat). Exact unless the coordinates span very different magnitudes.
+static double orient(const GeoPoint& a, const GeoPoint& b, const GeoPoint& c) {
+    return (static_cast<double>(b.lon) - a.lon) * (static_cast<double>(c.lat) - a.lat) -
+           (static_cast<double>(b.lat) - a.lat) * (static_cast<double>(c.lon) - a.lon);
+}
+
+// Sweep order: west to east, then south to north
+static bool before(const GeoPoint& a, const GeoPoint& b) {
+    return a.lon < b.lon || (a.lon == b.lon && a.lat < b.lat);
+}
+
+static bool validCoordinate(const GeoPoint& point) {
+    return isfinite(point.lat) && isfinite(point.lon) &&
+           fabsf(point.lat) <= 90.0f && fabsf(point.lon) <= 180.0f;
+}
+
+// ============================================================================
+// Validator
+// ============================================================================
+
+namespace {
+
+/**
+ * Works on the kept vertices as indices into the caller's array, so the
+ * fence itself is only read. Edge e runs from ring[e] to ring[e + 1].
+ */
+class Validator {
+public:
+    Validator(const GeoPoint* vertices, uint16_t* workspace, size_t count)
+        : _vertices(vertices)
+        , _ring(workspace)
+        , _events(workspace + count)
+        , _left(workspace + 3 * count)
+        , _right(workspace + 4 * count)
+        , _parent(workspace + 5 * count)
+        , _edges(0)
+        , _root(NONE)
+    {}
+
+    size_t clean(size_t count);
+    bool reversed() const;
+    bool simple();
+
+    const uint16_t* ring() const { return _ring; }
+
+private:
+    const GeoPoint* _vertices;
+    uint16_t* _ring;        ///< Kept vertex indices, in order
+    uint16_t* _events;      ///< Edge * 2, plus 1 for the end
+    uint16_t* _left;
+    uint16_t* _right;
+    uint16_t* _parent;
+    size_t _edges;
+    uint16_t _root;
+
+    const GeoPoint& vertex(size_t position) const { return _vertices[_ring[position]]; }
+    const GeoPoint& from(uint16_t edge) const { return vertex(edge); }
+    const GeoPoint& to(uint16_t edge) const { return vertex(edge + 1u == _edges ? 0 : edge + 1u); }
+    const GeoPoint& west(uint16_t edge) const { return before(to(edge), from(edge)) ? to(edge) : from(edge); }
+    const GeoPoint& east(uint16_t edge) const { return before(to(edge), from(edge)) ? from(edge) : to(edge); }
+    const GeoPoint& eventPoint(uint16_t event) const { return event & 1 ? east(event >> 1) : west(event >> 1); }
+
+    bool adjacent(uint16_t a, uint16_t b) const;
+    bool meet(uint16_t a, uint16_t b) const;
+    int compare(uint16_t edge, uint16_t other) const;
+
+    bool insert(uint16_t edge);
+    void remove(uint16_t edge);
+    void rotateUp(uint16_t node);
+    uint16_t previous(uint16_t node) const;
+    uint16_t next(uint16_t node) const;
+};
+
+}  // namespace
+
+/**
+ * Drops duplicates, collinear vertices and spikes in one pass: a vertex is
+ * pushed, and popped again while it is in line with the two before it.
+ * Then the same is done across the seam between the last vertex and the
+ * first. Returns the number of vertices kept, at the front of _ring.
+ */
+size_t Validator::clean(size_t count) {
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        while (kept >= 2 && orient(_vertices[_ring[kept - 2]], _vertices[_ring[kept - 1]], _vertices[i]) == 0.0) {
+            kept--;
+        }
+        _ring[kept++] = static_cast<uint16_t>(i);
+    }
+
+    size_t first = 0;
+    bool changed = true;
+    while (changed && kept - first >= 3) {
+        changed = false;
+        if (orient(_vertices[_ring[kept - 2]], _vertices[_ring[kept - 1]], _vertices[_ring[first]]) == 0.0) {
+            kept--;
+            changed = true;
+        } else if (orient(_vertices[_ring[kept - 1]], _vertices[_ring[first]], _vertices[_ring[first + 1]]) == 0.0) {
+            first++;
+            changed = true;
+        }
+    }
+
+    for (size_t i = first; i < kept; i++) {
+        _ring[i - first] = _ring[i];
+    }
+    _edges = kept - first;
+    return _edges;
+}
+
+bool Validator::reversed() const {
+    // Shoelace around the first vertex, which keeps the products small
+    const GeoPoint& origin = vertex(0);
+    double area = 0.0;
+    for (size_t i = 1; i + 1 < _edges; i++) {
+        area += orient(origin, vertex(i), vertex(i + 1));
+    }
+    return area < 0.0;
+}
+
+bool Validator::adjacent(uint16_t a, uint16_t b) const {
+    return a + 1u == b || b + 1u == a || (a == 0 && b + 1u == _edges) || (b == 0 && a + 1u == _edges);
+}
+
+// Closed segments: touching counts. Adjacent edges only share their vertex,
+// as no two of them are collinear after clean().
+bool Validator::meet(uint16_t a, uint16_t b) const {
+    if (adjacent(a, b)) {
+        return false;
+    }
+    const GeoPoint& p = from(a);
+    const GeoPoint& q = to(a);
+    const GeoPoint& r = from(b);
+    const GeoPoint& s = to(b);
+    double o1 = orient(p, q, r);
+    double o2 = orient(p, q, s);
+    double o3 = orient(r, s, p);
+    double o4 = orient(r, s, q);
+    if ((o1 > 0.0 && o2 > 0.0) || (o1 < 0.0 && o2 < 0.0) || (o3 > 0.0 && o4 > 0.0) || (o3 < 0.0 && o4 < 0.0)) {
+        return false;
+    }
+    if (o1 == 0.0 && o2 == 0.0) {
+        // Collinear: they meet if their sweep ranges overlap
+        return !before(east(a), west(b)) && !before(east(b), west(a));
+    }
+    return true;
+}
+
+/**
+ * Order of an edge being inserted relative to one in the sweep: +1 above,
+ * -1 below, 0 if its west end lies on the other (the two edges meet).
+ * Every edge in the sweep spans the current sweep point.
+ */
+int Validator::compare(uint16_t edge, uint16_t other) const {
+    const GeoPoint& point = west(edge);
+    double side = orient(west(other), east(other), point);
+    if (side == 0.0) {
+        if (!adjacent(edge, other)) {
+            return 0;
+        }
+        // The shared vertex: order by where the new edge heads
+        side = orient(west(other), east(other), east(edge));
+    }
+    return side > 0.0 ? 1 : -1;
+}
+
+// ============================================================================
+// Sweep Status (treap keyed by sweep order, with parent links)
+// ============================================================================
+
+// Hashed, so the tree stays balanced whatever order edges arrive in
+static uint32_t priority(uint16_t node) {
+    return (node + 1u) * 2654435761u;
+}
+
+void Validator::rotateUp(uint16_t node) {
+    uint16_t parent = _parent[node];
+    uint16_t grandparent = _parent[parent];
+    if (_left[parent] == node) {
+        _left[parent] = _right[node];
+        if (_right[node] != NONE) {
+            _parent[_right[node]] = parent;
+        }
+        _right[node] = parent;
+    } else {
+        _right[parent] = _left[node];
+        if (_left[node] != NONE) {
+            _parent[_left[node]] = parent;
+        }
+        _left[node] = parent;
+    }
+    _parent[parent] = node;
+    _parent[node] = grandparent;
+    if (grandparent == NONE) {
+        _root = node;
+    } else if (_left[grandparent] == parent) {
+        _left[grandparent] = node;
+    } else {
+        _right[grandparent] = node;
+    }
+}
+
+// Returns false if the edge meets one already in the sweep
+bool Validator::insert(uint16_t edge) {
+    _left[edge] = NONE;
+    _right[edge] = NONE;
+    _parent[edge] = NONE;
+    if (_root == NONE) {
+        _root = edge;
+        return true;
+    }
+    uint16_t node = _root;
+    for (;;) {
+        int side = compare(edge, node);
+        if (side == 0) {
+            return false;
+        }
+        uint16_t& child = side > 0 ? _right[node] : _left[node];
+        if (child == NONE) {
+            child = edge;
+            _parent[edge] = node;
+            break;
+        }
+        node = child;
+    }
+    while (_parent[edge] != NONE && priority(edge) > priority(_parent[edge])) {
+        rotateUp(edge);
+    }
+    return true;
+}
+
+void Validator::remove(uint16_t edge) {
+    // Rotate down to a leaf, then unlink
+    while (_left[edge] != NONE || _right[edge] != NONE) {
+        uint16_t child;
+        if (_left[edge] == NONE) {
+            child = _right[edge];
+        } else if (_right[edge] == NONE) {
+            child = _left[edge];
+        } else {
+            child = priority(_left[edge]) > priority(_right[edge]) ? _left[edge] : _right[edge];
+        }
+        rotateUp(child);
+    }
+    uint16_t parent = _parent[edge];
+    if (parent == NONE) {
+        _root = NONE;
+    } else if (_left[parent] == edge) {
+        _left[parent] = NONE;
+    } else {
+        _right[parent] = NONE;
+    }
+}
+
+uint16_t Validator::previous(uint16_t node) const {
+    if (_left[node] != NONE) {
+        node = _left[node];
+        while (_right[node] != NONE) {
+            node = _right[node];
+        }
+        return node;
+    }
+    while (_parent[node] != NONE && _left[_parent[node]] == node) {
+        node = _parent[node];
+    }
+    return _parent[node];
+}
+
+uint16_t Validator::next(uint16_t node) const {
+    if (_right[node] != NONE) {
+        node = _right[node];
+        while (_left[node] != NONE) {
+            node = _left[node];
+        }
+        return node;
+    }
+    while (_parent[node] != NONE && _right[_parent[node]] == node) {
+        node = _parent[node];
+    }
+    return _parent[node];
+}
+
+/**
+ * Shamos-Hoey: sweep west to east keeping the edges under the sweep in
+ * order. The first place two edges meet is found between neighbours in
+ * that order, so only neighbours are tested. At a shared point, edges
+ * start before others end, so a vertex touching an edge end is seen.
+ */
+bool Validator::simple() {
+    size_t eventCount = 2 * _edges;
+    for (size_t i = 0; i < eventCount; i++) {
+        _events[i] = static_cast<uint16_t>(i);
+    }
+    std::sort(_events, _events + eventCount, [this](uint16_t a, uint16_t b) {
+        const GeoPoint& p = eventPoint(a);
+        const GeoPoint& q = eventPoint(b);
+        if (before(p, q) || before(q, p)) {
+            return before(p, q);
+        }
+        if ((a & 1) != (b & 1)) {
+            return (a & 1) == 0;
+        }
+        return a < b;
+    });
+
+    _root = NONE;
+    for (size_t i = 0; i < eventCount; i++) {
+        uint16_t edge = _events[i] >> 1;
+        if ((_events[i] & 1) == 0) {
+            if (!insert(edge)) {
+                return false;
+            }
+            uint16_t below = previous(edge);
+            uint16_t above = next(edge);
+            if ((below != NONE && meet(edge, below)) || (above != NONE && meet(edge, above))) {
+                return false;
+            }
+        } else {
+            uint16_t below = previous(edge);
+            uint16_t above = next(edge);
+            remove(edge);
+            if (below != NONE && above != NONE && meet(below, above)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+const char* fenceVerdictName(FenceVerdict verdict) {
+    switch (verdict) {
+        case FenceVerdict::UNCHECKED:         return "unchecked";
+        case FenceVerdict::CLEAN:             return "clean";
+        case FenceVerdict::REPAIRED:          return "repaired";
+        case FenceVerdict::TOO_FEW_VERTICES:  return "too few vertices";
+        case FenceVerdict::TOO_MANY_VERTICES: return "too many vertices";
+        case FenceVerdict::BAD_COORDINATE:    return "bad coordinate";
+        case FenceVerdict::ZERO_AREA:         return "zero area";
+        case FenceVerdict::SELF_INTERSECTING: return "self-intersecting";
+        case FenceVerdict::NO_MEMORY:         return "out of memory";
+    }
+    return "unknown";
+}
+
+// Validate, and with output set, write the repaired ring there
+static FenceValidation validate(const GeoPoint* vertices, size_t count, GeoPoint* output) {
+    FenceValidation result = {FenceVerdict::UNCHECKED, count, 0, false};
+    if (vertices == nullptr || count < 3) {
+        result.verdict = FenceVerdict::TOO_FEW_VERTICES;
+        return result;
+    }
+    if (count > FENCE_VALIDATE_MAX_VERTICES) {
+        result.verdict = FenceVerdict::TOO_MANY_VERTICES;
+        return result;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!validCoordinate(vertices[i])) {
+            result.verdict = FenceVerdict::BAD_COORDINATE;
+            return result;
+        }
+    }
+
+    uint16_t* workspace = new (std::nothrow) uint16_t[6 * count];
+    if (workspace == nullptr) {
+        result.verdict = FenceVerdict::NO_MEMORY;
+        return result;
+    }
+
+    Validator validator(vertices, workspace, count);
+    size_t kept = validator.clean(count);
+    result.vertexCount = kept;
+    result.removed = count - kept;
+    if (kept < 3) {
+        result.verdict = FenceVerdict::ZERO_AREA;
+    } else if (!validator.simple()) {
+        result.verdict = FenceVerdict::SELF_INTERSECTING;
+    } else {
+        result.reversed = validator.reversed();
+        bool changed = result.removed > 0 || result.reversed;
+        result.verdict = changed ? FenceVerdict::REPAIRED : FenceVerdict::CLEAN;
+
+        if (output != nullptr && changed) {
+            // Kept indices only increase, so copying forward never reads a
+            // vertex already overwritten
+            const uint16_t* ring = validator.ring();
+            for (size_t i = 0; i < kept; i++) {
+                output[i] = vertices[ring[i]];
+            }
+            if (result.reversed) {
+                std::reverse(output + 1, output + kept);
+            }
+        }
+    }
+
+    delete[] workspace;
+    return result;
+}
+
+FenceValidation fenceValidate(const GeoPoint* vertices, size_t count) {
+    return validate(vertices, count, nullptr);
+}
+
+FenceValidation fenceValidateRepair(GeoPoint* vertices, size_t& count) {
+    FenceValidation result = validate(vertices, count, vertices);
+    if (fenceVerdictUsable(result.verdict)) {
+        count = result.vertexCount;
+    }
+    return result;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file fence_validate.h
+ * @brief Fence validation and repair, run once when a fence is set.
+ *
+ * Polygon accepts any vertex array of three or more points, but the
+ * even-odd rule only gives a well-defined inside for a simple ring: one
+ * whose edges cross or touch each other nowhere but at shared vertices.
+ * This library checks a fence before it reaches the wake-time hot path:
+ *
+ *  - Coordinates are finite and within range.
+ *  - Duplicate and collinear vertices, and zero-width spikes, are dropped.
+ *    None of them changes which points are inside.
+ *  - What is left has three or more vertices (otherwise it has no area).
+ *  - No two edges cross or touch (Shamos-Hoey sweep line, O(n log n)).
+ *  - Clockwise rings are reversed to counter-clockwise (lat up, lon right).
+ *
+ * The verdict is meant to be stored with the fence (see Config), so code
+ * downstream can assume a simple ring without checking again.
+ *
+ * Validation needs 12 bytes per vertex of workspace, allocated for the
+ * call and freed before it returns.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef FENCE_VALIDATE_H
+#define FENCE_VALIDATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../point_in_polygon/point_in_polygon.h"
+
+// ============================================
+// CONSTANTS
+// ============================================
+
+// The largest fence FenceStore holds (FENCE_STORE_MAX_VERTICES)
+constexpr size_t FENCE_VALIDATE_MAX_VERTICES = 4096;
+
+// ============================================
+// TYPES
+// ============================================
+
+/**
+ * @brief Outcome of validating a fence.
+ *
+ * Stored in NVS with the fence: values are never renumbered.
+ */
+enum class FenceVerdict : uint8_t {
+    UNCHECKED = 0,          ///< Not validated yet
+    CLEAN = 1,              ///< Simple, counter-clockwise, nothing to drop
+    REPAIRED = 2,           ///< Simple once vertices are dropped and the winding normalized
+    TOO_FEW_VERTICES = 3,
+    TOO_MANY_VERTICES = 4,  ///< Over FENCE_VALIDATE_MAX_VERTICES
+    BAD_COORDINATE = 5,     ///< NaN, infinite or out of range
+    ZERO_AREA = 6,          ///< Fewer than three vertices left after dropping
+    SELF_INTERSECTING = 7,  ///< Two edges cross or touch
+    NO_MEMORY = 8           ///< Workspace allocation failed; the fence is unknown
+};
+
+/**
+ * @brief Verdict and the repairs it implies.
+ */
+struct FenceValidation {
+    FenceVerdict verdict;
+    size_t vertexCount;     ///< Vertices after repair
+    size_t removed;         ///< Duplicate, collinear and spike vertices to drop
+    bool reversed;          ///< The ring is clockwise
+};
+
+// ============================================
+// FUNCTIONS
+// ============================================
+
+/**
+ * @brief Whether a fence with this verdict gives a well-defined inside.
+ */
+inline bool fenceVerdictUsable(FenceVerdict verdict) {
+    return verdict == FenceVerdict::CLEAN || verdict == FenceVerdict::REPAIRED;
+}
+
+/**
+ * @brief Short name of a verdict, for logs and tools.
+ */
+const char* fenceVerdictName(FenceVerdict verdict);
+
+/**
+ * @brief Validate a fence without changing it.
+ *
+ * Used for fences that cannot be rewritten, such as the mapped fence
+ * partition. A REPAIRED ring gives the same containment results as its
+ * repaired form, except for points exactly on a dropped spike.
+ */
+FenceValidation fenceValidate(const GeoPoint* vertices, size_t count);
+
+/**
+ * @brief Validate a fence and repair it in place.
+ *
+ * For a usable fence, drops the vertices counted in removed, reverses a
+ * clockwise ring (keeping the first kept vertex first) and updates count.
+ * An unusable fence is left as it was. Repairing a repaired fence changes
+ * nothing, so a sender can repair a fence first to keep vertex indices
+ * in step with the collar.
+ */
+FenceValidation fenceValidateRepair(GeoPoint* vertices, size_t& count);
+
+#endif // FENCE_VALIDATE_H
@@ -0,0 +1,101 @@
+/**
+ * @file fix_policy.cpp
+ * @brief Implementation of the GPS fix acquisition policy.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "fix_policy.h"
+
+#include <math.h>
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+bool fixPolicyAccept(const FixPolicyConfig& config, float hdop, uint8_t satellites,
+                     float fenceDistanceM) {
+    if (satellites < config.minSatellites || !(hdop > 0.0f)) {
+        return false;
+    }
+
+    float acceptableM = fabsf(fenceDistanceM) * config.errorFraction;
+    if (acceptableM < config.minErrorM) {
+        acceptableM = config.minErrorM;
+    } else if (acceptableM > config.maxErrorM) {
+        acceptableM = config.maxErrorM;
+    }
+
+    return hdop * config.rangeErrorM <= acceptableM;
+}
+
+bool fixPolicySearchAddFix(FixSearch& search, const FixPolicyConfig& config, uint32_t elapsedMs,
+                           float hdop, uint8_t satellites, float fenceDistanceM) {
+    if (!search.sawFix) {
+        search.sawFix = true;
+        search.firstFixMs = elapsedMs;
+    }
+    search.accepted = fixPolicyAccept(config, hdop, satellites, fenceDistanceM);
+    return search.accepted;
+}
+
+void fixPolicyRecordSearch(FixPolicyState& state, const FixPolicyConfig& config,
+                           const FixSearch& search) {
+    if (search.sawFix) {
+        fixPolicyRecordSuccess(state, search.firstFixMs);
+    } else {
+        fixPolicyRecordFailure(state, config);
+    }
+}
+
+bool fixPolicyShouldAttempt(FixPolicyState& state) {
+    if (state.backoffWakes == 0) {
+        return true;
+    }
+    state.backoffWakes--;
+    return false;
+}
+
+uint32_t fixPolicyTimeoutMs(const FixPolicyState& state, const FixPolicyConfig& config) {
+    if (state.failures > 0) {
+        return config.maxTimeoutMs;
+    }
+    if (state.historyCount == 0) {
+        return config.initialTimeoutMs;
+    }
+
+    uint32_t slowest = 0;
+    for (size_t i = 0; i < state.historyCount; i++) {
+        if (state.fixTimeMs[i] > slowest) {
+            slowest = state.fixTimeMs[i];
+        }
+    }
+
+    uint32_t timeout = slowest * config.marginPercent / 100;
+    if (timeout < config.minTimeoutMs) {
+        timeout = config.minTimeoutMs;
+    } else if (timeout > config.maxTimeoutMs) {
+        timeout = config.maxTimeoutMs;
+    }
+    return timeout;
+}
+
+void fixPolicyRecordSuccess(FixPolicyState& state, uint32_t fixTimeMs) {
+    state.fixTimeMs[state.historyHead] = static_cast<uint16_t>(fixTimeMs > 0xFFFF ? 0xFFFF : fixTimeMs);
+    state.historyHead = (state.historyHead + 1) % FIX_POLICY_HISTORY;
+    if (state.historyCount < FIX_POLICY_HISTORY) {
+        state.historyCount++;
+    }
+    state.failures = 0;
+    state.backoffWakes = 0;
+}
+
+void fixPolicyRecordFailure(FixPolicyState& state, const FixPolicyConfig& config) {
+    if (state.failures < 0xFF) {
+        state.failures++;
+    }
+
+    // Skip 0, 1, 3, 7, ... wakes after 1, 2, 3, 4, ... consecutive failures
+    uint32_t backoff = state.failures >= 8 ? 0xFF : (1u << (state.failures - 1)) - 1;
+    state.backoffWakes = static_cast<uint8_t>(backoff > config.maxBackoffWakes ? config.maxBackoffWakes : backoff);
+}
@@ -0,0 +1,145 @@
+/**
+ * @file fix_policy.h
+ * @brief GPS fix acquisition policy: quality-based early exit, learned
+ *        timeout and backoff after failures.
+ *
+ * - Accept: a fix is taken as soon as its estimated error (HDOP times the
+ *   receiver's range error) is small compared to the distance to the
+ *   fence, with enough satellites. Far from the fence a rough fix is
+ *   enough; at the fence line the collar waits for a good one.
+ * - Timeout: learned from the time to first fix of recent successful
+ *   wakes (kept in RTC memory), with a margin, instead of a fixed value.
+ *   Waiting for a better fix is not counted, so a rough sky does not
+ *   stretch the timeout of every later wake.
+ * - Backoff: after consecutive failures (tree cover, indoors) wakes skip
+ *   the attempt with exponential backoff. The attempt after a backoff uses
+ *   the longest timeout, since one long search is more likely to succeed
+ *   than many short ones.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef FIX_POLICY_H
+#define FIX_POLICY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================
+// CONSTANTS
+// ============================================
+
+constexpr size_t FIX_POLICY_HISTORY = 8;
+
+// ============================================
+// TYPES
+// ============================================
+
+/**
+ * @brief Policy tunables.
+ */
+struct FixPolicyConfig {
+    float rangeErrorM;          ///< Receiver range error; estimated error = HDOP * this
+    float errorFraction;        ///< Acceptable error as a fraction of the fence distance
+    float minErrorM;            ///< Acceptable error at the fence line
+    float maxErrorM;            ///< Acceptable error far from the fence
+    uint8_t minSatellites;      ///< Satellites required for any accepted fix
+    uint8_t marginPercent;      ///< Timeout = slowest recent fix * margin / 100
+    uint8_t maxBackoffWakes;    ///< Longest run of skipped attempts
+    uint8_t reserved;
+    uint16_t initialTimeoutMs;  ///< Timeout without history
+    uint16_t minTimeoutMs;
+    uint16_t maxTimeoutMs;
+};
+
+// PA1010D hot starts from standby take ~1 s; a minute of backoff at most
+constexpr FixPolicyConfig DEFAULT_FIX_POLICY_CONFIG = {
+    4.0f,    // rangeErrorM
+    0.25f,   // errorFraction
+    5.0f,    // minErrorM (HDOP 1.25 at the fence)
+    40.0f,   // maxErrorM (HDOP 10 far away)
+    4,       // minSatellites
+    150,     // marginPercent
+    11,      // maxBackoffWakes
+    0,       // reserved
+    3000,    // initialTimeoutMs
+    1000,    // minTimeoutMs
+    10000    // maxTimeoutMs
+};
+
+/**
+ * @brief Persistent state (POD, intended for RTC memory).
+ *
+ * Zero-initialized state is valid.
+ */
+struct FixPolicyState {
+    uint16_t fixTimeMs[FIX_POLICY_HISTORY];  ///< Recent times to fix (ring)
+    uint8_t historyHead;                     ///< Next slot to write
+    uint8_t historyCount;
+    uint8_t failures;                        ///< Consecutive failed attempts
+    uint8_t backoffWakes;                    ///< Attempts still to skip
+};
+
+/**
+ * @brief One search for a fix, on one wake. Zero-initialize to begin.
+ */
+struct FixSearch {
+    bool sawFix;            ///< Any fix seen
+    bool accepted;          ///< A fix met fixPolicyAccept()
+    uint32_t firstFixMs;    ///< Time to first fix, once sawFix
+};
+
+// ============================================
+// FUNCTIONS
+// ============================================
+
+/**
+ * @brief Whether a fix is good enough to stop waiting.
+ *
+ * @param hdop            Horizontal dilution of precision.
+ * @param satellites      Satellites used in the fix.
+ * @param fenceDistanceM  Distance to the fence (either side); 0 if unknown.
+ */
+bool fixPolicyAccept(const FixPolicyConfig& config, float hdop, uint8_t satellites,
+                     float fenceDistanceM);
+
+/**
+ * @brief Feed a fix parsed during a search.
+ *
+ * The first fix sets the time to first fix.
+ *
+ * @param elapsedMs Time since the search started.
+ * @return true if the fix is good enough to stop searching.
+ */
+bool fixPolicySearchAddFix(FixSearch& search, const FixPolicyConfig& config, uint32_t elapsedMs,
+                           float hdop, uint8_t satellites, float fenceDistanceM);
+
+/**
+ * @brief Record a finished search: its time to first fix if any fix was
+ *        seen (accepted or not), a failure otherwise.
+ */
+void fixPolicyRecordSearch(FixPolicyState& state, const FixPolicyConfig& config,
+                           const FixSearch& search);
+
+/**
+ * @brief Whether this wake should try for a fix. Spends one backoff wake
+ *        if not.
+ */
+bool fixPolicyShouldAttempt(FixPolicyState& state);
+
+/**
+ * @brief How long to search for a fix on this wake.
+ */
+uint32_t fixPolicyTimeoutMs(const FixPolicyState& state, const FixPolicyConfig& config);
+
+/**
+ * @brief Record a successful attempt and its time to fix.
+ */
+void fixPolicyRecordSuccess(FixPolicyState& state, uint32_t fixTimeMs);
+
+/**
+ * @brief Record a failed attempt and plan the backoff.
+ */
+void fixPolicyRecordFailure(FixPolicyState& state, const FixPolicyConfig& config);
+
+#endif // FIX_POLICY_H
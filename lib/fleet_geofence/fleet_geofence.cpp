@@ -0,0 +1,326 @@
+/**
+ * @file fleet_geofence.cpp
+ * @brief Implementation of the base-station fleet geofence service.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "fleet_geofence.h"
+#include <math.h>
+#include <algorithm>
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static bool validFence(const GeoPoint* vertices, size_t count) {
+    if (vertices == nullptr || count < 3) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        // Written to reject NaN as well
+        if (!(vertices[i].lat >= -90.0f && vertices[i].lat <= 90.0f &&
+              vertices[i].lon >= -180.0f && vertices[i].lon <= 180.0f)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Sort-Tile-Recursive order of boxes: vertical slices by longitude, each
+ * slice sorted by latitude, so every run of FLEET_NODE_CAPACITY items is
+ * a compact tile
+ */
+template <typename Box>
+static void strOrder(std::vector<uint32_t>& order, const std::vector<Box>& boxes) {
+    size_t count = order.size();
+    size_t nodes = (count + FLEET_NODE_CAPACITY - 1) / FLEET_NODE_CAPACITY;
+    size_t slices = static_cast<size_t>(ceil(sqrt(static_cast<double>(nodes))));
+    size_t sliceItems = slices * FLEET_NODE_CAPACITY;
+
+    // Centres are compared as sums to skip the halving
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return boxes[a].minLon + boxes[a].maxLon < boxes[b].minLon + boxes[b].maxLon;
+    });
+    for (size_t first = 0; first < count; first += sliceItems) {
+        size_t last = std::min(first + sliceItems, count);
+        std::sort(order.begin() + first, order.begin() + last, [&](uint32_t a, uint32_t b) {
+            return boxes[a].minLat + boxes[a].maxLat < boxes[b].minLat + boxes[b].maxLat;
+        });
+    }
+}
+
+// ============================================================================
+// FleetFenceIndex Class Implementation
+// ============================================================================
+
+FleetFenceIndex::FleetFenceIndex(std::vector<FleetFence> fences)
+    : _leafNodes(0)
+    , _depth(0)
+{
+    // Order the fences spatially first; the polygons point into the
+    // vertex vectors, so they are only made once _fences is final
+    std::vector<Box> boxes;
+    boxes.reserve(fences.size());
+    for (const FleetFence& fence : fences) {
+        Polygon polygon(fence.vertices.data(), fence.vertices.size());
+        Box box = {polygon.minLat(), polygon.maxLat(), polygon.minLon(), polygon.maxLon()};
+        boxes.push_back(box);
+    }
+
+    std::vector<uint32_t> order(fences.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    strOrder(order, boxes);
+
+    _fences.reserve(fences.size());
+    _fenceBoxes.reserve(fences.size());
+    _polygons.reserve(fences.size());
+    for (uint32_t i : order) {
+        _fences.push_back(std::move(fences[i]));
+        _fenceBoxes.push_back(boxes[i]);
+    }
+    for (size_t i = 0; i < _fences.size(); i++) {
+        const FleetFence& fence = _fences[i];
+        _polygons.push_back(Polygon(fence.vertices.data(), fence.vertices.size()));
+        _byId[fence.id] = static_cast<uint32_t>(i);
+        _households[fence.household]++;
+    }
+
+    pack();
+}
+
+void FleetFenceIndex::pack() {
+    if (_fences.empty()) {
+        return;
+    }
+
+    // Leaf level: runs of fences, already in STR order
+    for (size_t first = 0; first < _fences.size(); first += FLEET_NODE_CAPACITY) {
+        size_t last = std::min(first + FLEET_NODE_CAPACITY, _fences.size());
+        Node node = {_fenceBoxes[first], static_cast<uint32_t>(first),
+                     static_cast<uint32_t>(last - first)};
+        for (size_t i = first + 1; i < last; i++) {
+            node.box.minLat = std::min(node.box.minLat, _fenceBoxes[i].minLat);
+            node.box.maxLat = std::max(node.box.maxLat, _fenceBoxes[i].maxLat);
+            node.box.minLon = std::min(node.box.minLon, _fenceBoxes[i].minLon);
+            node.box.maxLon = std::max(node.box.maxLon, _fenceBoxes[i].maxLon);
+        }
+        _nodes.push_back(node);
+    }
+    _leafNodes = _nodes.size();
+    _depth = 1;
+
+    // Upper levels: STR-order the level below, then group it, until one
+    // root is left
+    size_t levelStart = 0;
+    while (_nodes.size() - levelStart > 1) {
+        size_t levelEnd = _nodes.size();
+        std::vector<Node> level(_nodes.begin() + levelStart, _nodes.end());
+        std::vector<Box> boxes;
+        for (const Node& node : level) {
+            boxes.push_back(node.box);
+        }
+        std::vector<uint32_t> order(level.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = static_cast<uint32_t>(i);
+        }
+        strOrder(order, boxes);
+        for (size_t i = 0; i < order.size(); i++) {
+            _nodes[levelStart + i] = level[order[i]];
+        }
+
+        for (size_t first = levelStart; first < levelEnd; first += FLEET_NODE_CAPACITY) {
+            size_t last = std::min(first + FLEET_NODE_CAPACITY, levelEnd);
+            Node node = {_nodes[first].box, static_cast<uint32_t>(first),
+                         static_cast<uint32_t>(last - first)};
+            for (size_t i = first + 1; i < last; i++) {
+                node.box.minLat = std::min(node.box.minLat, _nodes[i].box.minLat);
+                node.box.maxLat = std::max(node.box.maxLat, _nodes[i].box.maxLat);
+                node.box.minLon = std::min(node.box.minLon, _nodes[i].box.minLon);
+                node.box.maxLon = std::max(node.box.maxLon, _nodes[i].box.maxLon);
+            }
+            _nodes.push_back(node);
+        }
+        levelStart = levelEnd;
+        _depth++;
+    }
+}
+
+/**
+ * Call visitor(fenceIndex) for each fence containing the point, until it
+ * returns false
+ */
+template <typename Visitor>
+void FleetFenceIndex::visit(const GeoPoint& point, Visitor& visitor) const {
+    if (_nodes.empty()) {
+        return;
+    }
+
+    uint32_t stack[FLEET_QUERY_STACK];
+    size_t top = 0;
+    stack[top++] = static_cast<uint32_t>(_nodes.size() - 1);
+
+    while (top > 0) {
+        uint32_t index = stack[--top];
+        const Node& node = _nodes[index];
+        if (index < _leafNodes) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                const Box& box = _fenceBoxes[i];
+                if (point.lat >= box.minLat && point.lat <= box.maxLat &&
+                    point.lon >= box.minLon && point.lon <= box.maxLon &&
+                    _polygons[i].contains(point) && !visitor(i)) {
+                    return;
+                }
+            }
+            continue;
+        }
+        for (uint32_t i = node.first; i < node.first + node.count; i++) {
+            const Box& box = _nodes[i].box;
+            if (point.lat >= box.minLat && point.lat <= box.maxLat &&
+                point.lon >= box.minLon && point.lon <= box.maxLon) {
+                stack[top++] = i;
+            }
+        }
+    }
+}
+
+size_t FleetFenceIndex::query(const GeoPoint& point, const FleetFence** hits, size_t maxHits) const {
+    size_t found = 0;
+    auto collect = [&](uint32_t i) {
+        hits[found++] = &_fences[i];
+        return found < maxHits;
+    };
+    if (maxHits > 0) {
+        visit(point, collect);
+    }
+    return found;
+}
+
+FleetCheck FleetFenceIndex::check(uint32_t household, const GeoPoint& point) const {
+    FleetCheck result = {_households.count(household) > 0, false, 0};
+    if (!result.hasFences) {
+        return result;
+    }
+
+    auto ownFence = [&](uint32_t i) {
+        if (_fences[i].household != household) {
+            return true;
+        }
+        result.inside = true;
+        result.fenceId = _fences[i].id;
+        return false;
+    };
+    visit(point, ownFence);
+    return result;
+}
+
+const FleetFence* FleetFenceIndex::find(uint32_t id) const {
+    std::map<uint32_t, uint32_t>::const_iterator it = _byId.find(id);
+    return it != _byId.end() ? &_fences[it->second] : nullptr;
+}
+
+const std::vector<FleetFence>& FleetFenceIndex::fences() const {
+    return _fences;
+}
+
+size_t FleetFenceIndex::fenceCount() const {
+    return _fences.size();
+}
+
+size_t FleetFenceIndex::depth() const {
+    return _depth;
+}
+
+// ============================================================================
+// FleetGeofence Class Implementation
+// ============================================================================
+
+FleetGeofence::FleetGeofence()
+    : _index(std::make_shared<const FleetFenceIndex>(std::vector<FleetFence>()))
+    , _version(0)
+{
+}
+
+void FleetGeofence::publish(std::vector<FleetFence> fences) {
+    std::shared_ptr<const FleetFenceIndex> index =
+        std::make_shared<const FleetFenceIndex>(std::move(fences));
+    std::atomic_store(&_index, index);
+    _version++;
+}
+
+bool FleetGeofence::upsertFence(uint32_t id, uint32_t household,
+                                const GeoPoint* vertices, size_t count) {
+    if (!validFence(vertices, count)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_updateMutex);
+    std::vector<FleetFence> fences = snapshot()->fences();
+    FleetFence fence = {id, household, std::vector<GeoPoint>(vertices, vertices + count)};
+
+    std::vector<FleetFence>::iterator it = std::find_if(
+        fences.begin(), fences.end(), [id](const FleetFence& f) { return f.id == id; });
+    if (it != fences.end()) {
+        *it = std::move(fence);
+    } else {
+        fences.push_back(std::move(fence));
+    }
+    publish(std::move(fences));
+    return true;
+}
+
+bool FleetGeofence::removeFence(uint32_t id) {
+    std::lock_guard<std::mutex> lock(_updateMutex);
+    std::vector<FleetFence> fences = snapshot()->fences();
+    std::vector<FleetFence>::iterator it = std::remove_if(
+        fences.begin(), fences.end(), [id](const FleetFence& f) { return f.id == id; });
+    if (it == fences.end()) {
+        return false;
+    }
+    fences.erase(it, fences.end());
+    publish(std::move(fences));
+    return true;
+}
+
+size_t FleetGeofence::removeHousehold(uint32_t household) {
+    std::lock_guard<std::mutex> lock(_updateMutex);
+    std::vector<FleetFence> fences = snapshot()->fences();
+    std::vector<FleetFence>::iterator it = std::remove_if(
+        fences.begin(), fences.end(),
+        [household](const FleetFence& f) { return f.household == household; });
+    size_t removed = static_cast<size_t>(fences.end() - it);
+    if (removed > 0) {
+        fences.erase(it, fences.end());
+        publish(std::move(fences));
+    }
+    return removed;
+}
+
+bool FleetGeofence::loadFences(std::vector<FleetFence> fences) {
+    std::map<uint32_t, bool> ids;
+    for (const FleetFence& fence : fences) {
+        if (!validFence(fence.vertices.data(), fence.vertices.size()) || ids[fence.id]) {
+            return false;   // Invalid, or a duplicate id
+        }
+        ids[fence.id] = true;
+    }
+
+    std::lock_guard<std::mutex> lock(_updateMutex);
+    publish(std::move(fences));
+    return true;
+}
+
+std::shared_ptr<const FleetFenceIndex> FleetGeofence::snapshot() const {
+    return std::atomic_load(&_index);
+}
+
+FleetCheck FleetGeofence::check(uint32_t household, const GeoPoint& point) const {
+    return snapshot()->check(household, point);
+}
+
+uint32_t FleetGeofence::version() const {
+    return _version.load();
+}
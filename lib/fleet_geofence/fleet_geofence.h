@@ -0,0 +1,221 @@
+/**
+ * @file fleet_geofence.h
+ * @brief Base-station geofence service for a fleet of collars.
+ *
+ * The base station holds the fences of every household it serves and
+ * checks each collar's fixes against them. Testing a fix against every
+ * fence does not scale to a kennel with thousands of fences, so the
+ * fences are kept in a bounding-volume hierarchy: their bounding boxes
+ * (Polygon::minLat() .. maxLon()) are packed bottom-up with the
+ * Sort-Tile-Recursive (STR) method into nodes of FLEET_NODE_CAPACITY
+ * children. A fix only descends into nodes whose box contains it, so a
+ * query costs O(log F) box tests plus contains() on the few fences whose
+ * box contains the fix.
+ *
+ * The packed index is immutable. Fence updates build a new one and
+ * publish it atomically, so any number of reader threads keep querying
+ * (the snapshot they hold stays valid) while the radio or MQTT side
+ * changes fences.
+ *
+ * Host only (std::shared_ptr, std::mutex): runs on the base station, not
+ * the collar.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef FLEET_GEOFENCE_H
+#define FLEET_GEOFENCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "../point_in_polygon/point_in_polygon.h"
+
+// ============================================
+// CONSTANTS
+// ============================================
+
+// Children per index node; the boxes of a node are scanned linearly, and
+// 16 keeps 10k fences within 4 levels
+constexpr size_t FLEET_NODE_CAPACITY = 16;
+
+// Traversal stack: (capacity - 1) siblings per level, 8 levels (16^8 fences)
+constexpr size_t FLEET_QUERY_STACK = 8 * (FLEET_NODE_CAPACITY - 1) + 1;
+
+// ============================================
+// TYPES
+// ============================================
+
+/**
+ * @brief One fence of one household.
+ */
+struct FleetFence {
+    uint32_t id;                    ///< Unique across the fleet
+    uint32_t household;             ///< Collars of this household are checked against it
+    std::vector<GeoPoint> vertices;
+};
+
+/**
+ * @brief Result of checking a collar's fix against its household's fences.
+ */
+struct FleetCheck {
+    bool hasFences;     ///< The household has at least one fence
+    bool inside;        ///< Inside at least one of them
+    uint32_t fenceId;   ///< A fence containing the fix (when inside)
+};
+
+// ============================================
+// INDEX CLASS
+// ============================================
+
+/**
+ * @brief Immutable STR-packed bounding-volume hierarchy over fences.
+ *
+ * Safe to query from any number of threads.
+ */
+class FleetFenceIndex {
+public:
+    /**
+     * @brief Pack the fences into a new index (O(F log F)).
+     *
+     * @param fences Fences to index; taken over by the index.
+     */
+    explicit FleetFenceIndex(std::vector<FleetFence> fences);
+
+    FleetFenceIndex(const FleetFenceIndex&) = delete;
+    FleetFenceIndex& operator=(const FleetFenceIndex&) = delete;
+
+    /**
+     * @brief Find the fences containing a point.
+     *
+     * @param point   Point to test.
+     * @param hits    Receives up to maxHits containing fences.
+     * @param maxHits Size of the hits array.
+     * @return Number of containing fences found (at most maxHits).
+     */
+    size_t query(const GeoPoint& point, const FleetFence** hits, size_t maxHits) const;
+
+    /**
+     * @brief Check a household's fix: inside any of its fences?
+     */
+    FleetCheck check(uint32_t household, const GeoPoint& point) const;
+
+    /**
+     * @brief Fence by id, or nullptr.
+     */
+    const FleetFence* find(uint32_t id) const;
+
+    /**
+     * @brief All fences, in packed (spatial) order.
+     */
+    const std::vector<FleetFence>& fences() const;
+
+    size_t fenceCount() const;
+
+    /**
+     * @brief Levels of index nodes above the fences (0 when empty).
+     */
+    size_t depth() const;
+
+private:
+    struct Box {
+        float minLat;
+        float maxLat;
+        float minLon;
+        float maxLon;
+    };
+
+    struct Node {
+        Box box;
+        uint32_t first;     ///< First child: a node, or a fence on the leaf level
+        uint32_t count;
+    };
+
+    std::vector<FleetFence> _fences;
+    std::vector<Polygon> _polygons;             ///< Parallel to _fences
+    std::vector<Box> _fenceBoxes;               ///< Parallel to _fences
+    std::vector<Node> _nodes;                   ///< Level by level, root last
+    size_t _leafNodes;                          ///< Nodes [0, _leafNodes) point at fences
+    size_t _depth;
+    std::map<uint32_t, uint32_t> _byId;         ///< Fence id -> index in _fences
+    std::map<uint32_t, uint32_t> _households;   ///< Household -> fence count
+
+    void pack();
+
+    template <typename Visitor>
+    void visit(const GeoPoint& point, Visitor& visitor) const;
+};
+
+// ============================================
+// SERVICE CLASS
+// ============================================
+
+/**
+ * @brief Fleet-wide fence set with lock-free readers.
+ *
+ * Readers take a snapshot (or call the query helpers, which do) and use
+ * it without locking. Updates are serialised, rebuild the index from the
+ * current fence set and publish it in one atomic store; a reader sees
+ * either the old or the new fence set, never a mix.
+ */
+class FleetGeofence {
+public:
+    FleetGeofence();
+
+    /**
+     * @brief Add a fence, or replace the fence with the same id.
+     *
+     * @return false if the fence has fewer than 3 vertices or a vertex
+     *         outside -90..90 / -180..180.
+     */
+    bool upsertFence(uint32_t id, uint32_t household, const GeoPoint* vertices, size_t count);
+
+    /**
+     * @brief Remove a fence.
+     *
+     * @return false if there is no fence with this id.
+     */
+    bool removeFence(uint32_t id);
+
+    /**
+     * @brief Remove every fence of a household.
+     *
+     * @return Number of fences removed.
+     */
+    size_t removeHousehold(uint32_t household);
+
+    /**
+     * @brief Replace the whole fence set in one update (e.g. at start-up).
+     *
+     * @return false if any fence is invalid; the set is then unchanged.
+     */
+    bool loadFences(std::vector<FleetFence> fences);
+
+    /**
+     * @brief Current index; stays valid for as long as the caller holds it.
+     */
+    std::shared_ptr<const FleetFenceIndex> snapshot() const;
+
+    /**
+     * @brief Check a collar's fix against its household's fences.
+     */
+    FleetCheck check(uint32_t household, const GeoPoint& point) const;
+
+    /**
+     * @brief Number of published updates since construction.
+     */
+    uint32_t version() const;
+
+private:
+    std::mutex _updateMutex;                        ///< Serialises writers
+    std::shared_ptr<const FleetFenceIndex> _index;  ///< Only via std::atomic_load/store
+    std::atomic<uint32_t> _version;
+
+    void publish(std::vector<FleetFence> fences);
+};
+
+#endif // FLEET_GEOFENCE_H
@@ -0,0 +1,45 @@
+/**
+ * @file gps_burst.cpp
+ * @brief Implementation of the GPS burst mode decision.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "gps_burst.h"
+
+#include <math.h>
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+bool gpsBurstUpdate(GpsBurstState& state, const GpsBurstConfig& config,
+                    float signedDistanceM, uint32_t nowSec) {
+    float distance = fabsf(signedDistanceM);
+
+    if (state.active != 0) {
+        if (distance >= config.exitDistanceM) {
+            state.active = 0;
+        } else if (nowSec - state.startSec >= config.maxBurstSec) {
+            state.active = 0;
+            state.cooldownUntilSec = nowSec + config.cooldownSec;
+        }
+        return state.active != 0;
+    }
+
+    // Signed comparison so the cooldown also survives clock wrap-around
+    bool coolingDown = static_cast<int32_t>(state.cooldownUntilSec - nowSec) > 0;
+    if (distance <= config.enterDistanceM && !coolingDown) {
+        state.active = 1;
+        state.startSec = nowSec;
+    }
+    return state.active != 0;
+}
+
+void gpsBurstAbort(GpsBurstState& state) {
+    state.active = 0;
+}
+
+uint8_t gpsBurstRateHz(const GpsBurstState& state, const GpsBurstConfig& config) {
+    return state.active != 0 ? config.burstRateHz : config.normalRateHz;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file gps_burst.h
+ * @brief High-rate GPS burst mode near the fence.
+ *
+ * A normal wake takes one 1 Hz fix and goes back to sleep. When the dog is
+ * within a few meters of the fence, the collar instead stays awake and
+ * streams fixes at a higher rate through the boundary alert, so a crossing
+ * is seen within a fraction of a second. Once the dog is clear of the
+ * fence again (with hysteresis), the GPS drops back to 1 Hz and the collar
+ * sleeps.
+ *
+ * A burst is capped in length, followed by a cooldown, so a dog lying on
+ * the fence line cannot keep the collar awake indefinitely.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef GPS_BURST_H
+#define GPS_BURST_H
+
+#include <stdint.h>
+
+// ============================================
+// TYPES
+// ============================================
+
+/**
+ * @brief Burst mode tunables.
+ */
+struct GpsBurstConfig {
+    float enterDistanceM;    ///< Start a burst within this distance of the fence
+    float exitDistanceM;     ///< End the burst beyond this distance (> enterDistanceM)
+    uint8_t burstRateHz;     ///< GPS update rate during a burst
+    uint8_t normalRateHz;    ///< GPS update rate otherwise
+    uint16_t maxBurstSec;    ///< Longest burst before a forced cooldown
+    uint16_t cooldownSec;    ///< Time after a capped burst before the next one
+};
+
+// PA1010D: 5 Hz keeps the RMC + GGA stream light enough for I2C
+constexpr GpsBurstConfig DEFAULT_GPS_BURST_CONFIG = {
+    8.0f,    // enterDistanceM
+    15.0f,   // exitDistanceM
+    5,       // burstRateHz
+    1,       // normalRateHz
+    120,     // maxBurstSec
+    60       // cooldownSec
+};
+
+/**
+ * @brief Persistent state (POD, intended for RTC memory).
+ *
+ * Zero-initialized state is valid: no burst.
+ */
+struct GpsBurstState {
+    uint8_t active;             ///< Non-zero during a burst
+    uint8_t reserved[3];
+    uint32_t startSec;          ///< Start of the current burst
+    uint32_t cooldownUntilSec;  ///< No new burst before this time
+};
+
+// ============================================
+// FUNCTIONS
+// ============================================
+
+/**
+ * @brief Feed a fix's fence distance and decide whether to burst.
+ *
+ * Starts a burst when the dog is within enterDistanceM of the fence (on
+ * either side) and no cooldown is pending. A running burst ends once the
+ * dog is beyond exitDistanceM, or after maxBurstSec (then a cooldown
+ * starts).
+ *
+ * @param signedDistanceM Distance to the fence, positive inside.
+ * @param nowSec          Wake clock.
+ * @return true if the collar should be (or stay) in burst mode.
+ */
+bool gpsBurstUpdate(GpsBurstState& state, const GpsBurstConfig& config,
+                    float signedDistanceM, uint32_t nowSec);
+
+/**
+ * @brief End a running burst without a cooldown (e.g. the fix was lost).
+ */
+void gpsBurstAbort(GpsBurstState& state);
+
+/**
+ * @brief GPS update rate for the current mode.
+ */
+uint8_t gpsBurstRateHz(const GpsBurstState& state, const GpsBurstConfig& config);
+
+#endif // GPS_BURST_H
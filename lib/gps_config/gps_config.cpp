@@ -0,0 +1,163 @@
+/**
+ * @file gps_config.cpp
+ * @brief Implementation of GPS settings tracking and PMTK sentences.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "gps_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static uint8_t nmeaChecksum(const char* begin, const char* end) {
+    uint8_t sum = 0;
+    for (const char* p = begin; p < end; p++) {
+        sum ^= static_cast<uint8_t>(*p);
+    }
+    return sum;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// ============================================================================
+// Settings Tracking
+// ============================================================================
+
+uint8_t gpsConfigPending(const GpsConfigState& state, const GpsSettings& settings) {
+    if (state.magic != GPS_CONFIG_MAGIC) {
+        return GPS_CONFIG_ALL;
+    }
+
+    uint8_t pending = 0;
+    if (!(state.applied & GPS_CONFIG_OUTPUT) || state.sentences != settings.sentences) {
+        pending |= GPS_CONFIG_OUTPUT;
+    }
+    if (!(state.applied & GPS_CONFIG_RATE) || state.updateIntervalMs != settings.updateIntervalMs) {
+        pending |= GPS_CONFIG_RATE;
+    }
+    return pending;
+}
+
+void gpsConfigApplied(GpsConfigState& state, uint8_t item, const GpsSettings& settings) {
+    if (state.magic != GPS_CONFIG_MAGIC) {
+        gpsConfigInvalidate(state);
+        state.magic = GPS_CONFIG_MAGIC;
+    }
+
+    if (item & GPS_CONFIG_OUTPUT) {
+        state.sentences = settings.sentences;
+        state.applied |= GPS_CONFIG_OUTPUT;
+    }
+    if (item & GPS_CONFIG_RATE) {
+        state.updateIntervalMs = settings.updateIntervalMs;
+        state.applied |= GPS_CONFIG_RATE;
+    }
+}
+
+void gpsConfigInvalidate(GpsConfigState& state) {
+    memset(&state, 0, sizeof(state));
+}
+
+// ============================================================================
+// PMTK Sentences
+// ============================================================================
+
+size_t pmtkFormat(const char* body, char* out, size_t outSize) {
+    if (body == nullptr || out == nullptr) {
+        return 0;
+    }
+
+    size_t bodyLen = strlen(body);
+    uint8_t checksum = nmeaChecksum(body, body + bodyLen);
+    int n = snprintf(out, outSize, "$%s*%02X", body, checksum);
+    if (n < 0 || static_cast<size_t>(n) >= outSize) {
+        return 0;
+    }
+    return static_cast<size_t>(n);
+}
+
+uint16_t gpsConfigCommandId(uint8_t item) {
+    switch (item) {
+        case GPS_CONFIG_OUTPUT:
+            return 314;
+        case GPS_CONFIG_RATE:
+            return 220;
+        default:
+            return 0;
+    }
+}
+
+size_t gpsConfigCommand(uint8_t item, const GpsSettings& settings, char* out, size_t outSize) {
+    char body[GPS_CONFIG_MAX_COMMAND];
+
+    switch (item) {
+        case GPS_CONFIG_OUTPUT:
+            // Fields: GLL, RMC, VTG, GGA, GSA, GSV, 13 reserved/other
+            snprintf(body, sizeof(body), "PMTK314,0,%d,0,%d,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0",
+                     (settings.sentences & GPS_NMEA_RMC) ? 1 : 0,
+                     (settings.sentences & GPS_NMEA_GGA) ? 1 : 0);
+            break;
+        case GPS_CONFIG_RATE:
+            snprintf(body, sizeof(body), "PMTK220,%u", static_cast<unsigned int>(settings.updateIntervalMs));
+            break;
+        default:
+            return 0;
+    }
+
+    return pmtkFormat(body, out, outSize);
+}
+
+PmtkAck pmtkParseAck(const char* sentence, uint16_t commandId) {
+    static const char PREFIX[] = "$PMTK001,";
+    while (sentence != nullptr && (*sentence == '\r' || *sentence == '\n')) {
+        sentence++;
+    }
+    if (sentence == nullptr || strncmp(sentence, PREFIX, sizeof(PREFIX) - 1) != 0) {
+        return PmtkAck::NONE;
+    }
+
+    const char* star = strchr(sentence, '*');
+    if (star == nullptr || hexValue(star[1]) < 0 || hexValue(star[2]) < 0) {
+        return PmtkAck::NONE;
+    }
+    uint8_t expected = static_cast<uint8_t>(hexValue(star[1]) << 4 | hexValue(star[2]));
+    if (nmeaChecksum(sentence + 1, star) != expected) {
+        return PmtkAck::NONE;
+    }
+
+    char* end;
+    unsigned long command = strtoul(sentence + sizeof(PREFIX) - 1, &end, 10);
+    if (*end != ',' || command != commandId) {
+        return PmtkAck::NONE;
+    }
+
+    switch (end[1]) {
+        case '0':
+            return PmtkAck::INVALID;
+        case '1':
+            return PmtkAck::UNSUPPORTED;
+        case '2':
+            return PmtkAck::FAILED;
+        case '3':
+            return PmtkAck::SUCCESS;
+        default:
+            return PmtkAck::NONE;
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ * @file gps_config.h
+ * @brief Track which PA1010D settings are applied, and build and check
+ *        the PMTK commands that apply them.
+ *
+ * The GPS keeps its settings in standby, and it stays powered while the
+ * ESP32 is in deep sleep. This state, kept in RTC memory, records what
+ * the module has acknowledged. A wake then only sends the commands whose
+ * setting changed, and waits for the module's PMTK_ACK instead of a fixed
+ * delay. After a power-on reset (RTC memory lost) every setting is sent
+ * once again.
+ *
+ * Only the portable parts live here (settings tracking, sentence
+ * building, ACK parsing); the firmware does the I/O.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef GPS_CONFIG_H
+#define GPS_CONFIG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================
+// CONSTANTS
+// ============================================
+
+constexpr uint32_t GPS_CONFIG_MAGIC = 0x47504346;  // "GPCF"
+
+// NMEA sentences enabled in the output (PMTK314)
+constexpr uint8_t GPS_NMEA_RMC = 0x01;
+constexpr uint8_t GPS_NMEA_GGA = 0x02;
+
+// Settings, as a bitmask of what needs to be sent
+constexpr uint8_t GPS_CONFIG_OUTPUT = 0x01;   ///< NMEA output (PMTK314)
+constexpr uint8_t GPS_CONFIG_RATE = 0x02;     ///< Update interval (PMTK220)
+constexpr uint8_t GPS_CONFIG_ALL = GPS_CONFIG_OUTPUT | GPS_CONFIG_RATE;
+
+// Longest PMTK sentence built here, including the terminator
+constexpr size_t GPS_CONFIG_MAX_COMMAND = 64;
+
+// ============================================
+// TYPES
+// ============================================
+
+/**
+ * @brief Desired module settings.
+ */
+struct GpsSettings {
+    uint8_t sentences;           ///< GPS_NMEA_* mask
+    uint16_t updateIntervalMs;   ///< 100..10000 ms
+};
+
+/**
+ * @brief Settings the module has acknowledged (POD, intended for RTC memory).
+ *
+ * Zero-initialized state has nothing applied.
+ */
+struct GpsConfigState {
+    uint32_t magic;               ///< GPS_CONFIG_MAGIC once anything was applied
+    uint16_t updateIntervalMs;
+    uint8_t sentences;
+    uint8_t applied;              ///< GPS_CONFIG_* mask of valid fields
+};
+
+/**
+ * @brief Result of matching a sentence against an expected PMTK_ACK.
+ */
+enum class PmtkAck : uint8_t {
+    NONE = 0,       ///< Not an ACK for this command
+    INVALID,        ///< Command not recognized
+    UNSUPPORTED,    ///< Command not supported
+    FAILED,         ///< Valid command, action failed
+    SUCCESS
+};
+
+// ============================================
+// SETTINGS TRACKING
+// ============================================
+
+/**
+ * @brief Settings that differ from what the module has applied.
+ * @return GPS_CONFIG_* mask of commands to send.
+ */
+uint8_t gpsConfigPending(const GpsConfigState& state, const GpsSettings& settings);
+
+/**
+ * @brief Record that the module acknowledged a setting.
+ *
+ * @param item GPS_CONFIG_OUTPUT or GPS_CONFIG_RATE.
+ */
+void gpsConfigApplied(GpsConfigState& state, uint8_t item, const GpsSettings& settings);
+
+/**
+ * @brief Forget all applied settings (e.g. the module lost power).
+ */
+void gpsConfigInvalidate(GpsConfigState& state);
+
+// ============================================
+// PMTK SENTENCES
+// ============================================
+
+/**
+ * @brief Build the command sentence for one setting, with checksum
+ *        (without line ending; Adafruit_GPS::sendCommand() adds it).
+ *
+ * @param item GPS_CONFIG_OUTPUT or GPS_CONFIG_RATE.
+ * @return Sentence length, or 0 if item is unknown or out does not fit.
+ */
+size_t gpsConfigCommand(uint8_t item, const GpsSettings& settings, char* out, size_t outSize);
+
+/**
+ * @brief PMTK command number of a setting (314 or 220), 0 if unknown.
+ */
+uint16_t gpsConfigCommandId(uint8_t item);
+
+/**
+ * @brief Wrap a sentence body ("PMTK220,1000") as "$<body>*<XX>".
+ * @return Sentence length, or 0 if out does not fit.
+ */
+size_t pmtkFormat(const char* body, char* out, size_t outSize);
+
+/**
+ * @brief Check whether a received sentence is the ACK for a command.
+ *
+ * Expects "$PMTK001,<command>,<flag>*<XX>" with a valid checksum.
+ * Leading line-ending characters are skipped.
+ */
+PmtkAck pmtkParseAck(const char* sentence, uint16_t commandId);
+
+#endif // GPS_CONFIG_H
@@ -0,0 +1,258 @@
+/**
+ * @file icm20948.cpp
+ * @brief Implementation of the minimal ICM-20948 wake-on-motion driver.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "icm20948.h"
+#include "../binlog/binlog.h"
+#include "../binlog/log_messages.h"
+
+// ============================================================================
+// Register Map (subset)
+// ============================================================================
+
+// Bank 0
+constexpr uint8_t REG_WHO_AM_I = 0x00;
+constexpr uint8_t REG_USER_CTRL = 0x03;
+constexpr uint8_t REG_LP_CONFIG = 0x05;
+constexpr uint8_t REG_PWR_MGMT_1 = 0x06;
+constexpr uint8_t REG_PWR_MGMT_2 = 0x07;
+constexpr uint8_t REG_INT_PIN_CFG = 0x0F;
+constexpr uint8_t REG_INT_ENABLE = 0x10;
+constexpr uint8_t REG_INT_STATUS = 0x19;
+constexpr uint8_t REG_ACCEL_XOUT_H = 0x2D;
+constexpr uint8_t REG_FIFO_EN_2 = 0x67;
+constexpr uint8_t REG_FIFO_RST = 0x68;
+constexpr uint8_t REG_FIFO_MODE = 0x69;
+constexpr uint8_t REG_FIFO_COUNTH = 0x70;
+constexpr uint8_t REG_FIFO_R_W = 0x72;
+
+// Bank 2
+constexpr uint8_t REG_ACCEL_SMPLRT_DIV_1 = 0x10;
+constexpr uint8_t REG_ACCEL_SMPLRT_DIV_2 = 0x11;
+constexpr uint8_t REG_ACCEL_INTEL_CTRL = 0x12;
+constexpr uint8_t REG_ACCEL_WOM_THR = 0x13;
+constexpr uint8_t REG_ACCEL_CONFIG = 0x14;
+
+// All banks
+constexpr uint8_t REG_BANK_SEL = 0x7F;
+
+constexpr uint8_t WHO_AM_I_VALUE = 0xEA;
+
+constexpr uint8_t PWR_MGMT_1_RESET = 0x80;
+constexpr uint8_t PWR_MGMT_1_LP_EN = 0x20;
+constexpr uint8_t PWR_MGMT_1_CLKSEL_AUTO = 0x01;
+constexpr uint8_t PWR_MGMT_2_GYRO_OFF = 0x07;
+constexpr uint8_t LP_CONFIG_ACCEL_CYCLE = 0x20;
+constexpr uint8_t INT_PIN_CFG_LATCH = 0x20;
+constexpr uint8_t INT_WOM = 0x08;
+constexpr uint8_t ACCEL_INTEL_EN_COMPARE_PREVIOUS = 0x03;
+constexpr uint8_t ACCEL_CONFIG_2G_DLPF = 0x09;
+constexpr uint8_t USER_CTRL_FIFO_EN = 0x40;
+constexpr uint8_t FIFO_EN_2_ACCEL = 0x10;
+constexpr uint8_t FIFO_RST_ALL = 0x1F;
+constexpr uint8_t FIFO_MODE_STREAM = 0x00;
+
+// FIFO bytes per read transaction (fits the Wire buffer, whole samples)
+constexpr size_t FIFO_CHUNK_BYTES = 120;
+
+// Accelerometer base rate for the sample rate divider
+constexpr uint32_t ACCEL_BASE_RATE_HZ = 1125;
+
+// +-2 g full scale: 16384 LSB per g
+constexpr int32_t ACCEL_LSB_PER_G = 16384;
+
+// ============================================================================
+// Constructor
+// ============================================================================
+
+Icm20948::Icm20948(TwoWire& wire, uint8_t address)
+    : _wire(wire)
+    , _address(address)
+    , _bank(0xFF)
+    , _samplePeriodMs(10) {
+}
+
+// ============================================================================
+// Public Methods
+// ============================================================================
+
+bool Icm20948::begin() {
+    _bank = 0xFF;
+
+    uint8_t id = 0;
+    if (!readRegisters(0, REG_WHO_AM_I, &id, 1) || id != WHO_AM_I_VALUE) {
+        binlog(LOG_IMU_NOT_FOUND);
+        return false;
+    }
+    return true;
+}
+
+bool Icm20948::enableWakeOnMotion(uint16_t thresholdMg, uint16_t sampleRateHz) {
+    if (sampleRateHz == 0) {
+        return false;
+    }
+
+    uint32_t divider = ACCEL_BASE_RATE_HZ / sampleRateHz;
+    divider = divider == 0 ? 0 : divider - 1;
+    if (divider > 0x0FFF) {
+        divider = 0x0FFF;
+    }
+    _samplePeriodMs = static_cast<uint16_t>((1000 * (divider + 1) + ACCEL_BASE_RATE_HZ - 1) /
+                                            ACCEL_BASE_RATE_HZ);
+
+    uint16_t threshold = thresholdMg / 4;
+    if (threshold > 0xFF) {
+        threshold = 0xFF;
+    }
+
+    // Reset, then wake with gyro off
+    if (!writeRegister(0, REG_PWR_MGMT_1, PWR_MGMT_1_RESET)) {
+        return false;
+    }
+    delay(10);
+    _bank = 0xFF;
+
+    bool ok = writeRegister(0, REG_PWR_MGMT_1, PWR_MGMT_1_CLKSEL_AUTO) &&
+              writeRegister(0, REG_PWR_MGMT_2, PWR_MGMT_2_GYRO_OFF) &&
+              writeRegister(2, REG_ACCEL_CONFIG, ACCEL_CONFIG_2G_DLPF) &&
+              writeRegister(2, REG_ACCEL_SMPLRT_DIV_1, static_cast<uint8_t>(divider >> 8)) &&
+              writeRegister(2, REG_ACCEL_SMPLRT_DIV_2, static_cast<uint8_t>(divider & 0xFF)) &&
+              writeRegister(2, REG_ACCEL_WOM_THR, static_cast<uint8_t>(threshold)) &&
+              writeRegister(2, REG_ACCEL_INTEL_CTRL, ACCEL_INTEL_EN_COMPARE_PREVIOUS) &&
+              writeRegister(0, REG_INT_PIN_CFG, INT_PIN_CFG_LATCH) &&
+              writeRegister(0, REG_INT_ENABLE, INT_WOM) &&
+              writeRegister(0, REG_LP_CONFIG, LP_CONFIG_ACCEL_CYCLE) &&
+              writeRegister(0, REG_PWR_MGMT_1, PWR_MGMT_1_CLKSEL_AUTO | PWR_MGMT_1_LP_EN);
+
+    if (!ok) {
+        binlog(LOG_IMU_SETUP_FAILED);
+    }
+    return ok;
+}
+
+bool Icm20948::enableFifo() {
+    return writeRegister(0, REG_FIFO_MODE, FIFO_MODE_STREAM) &&
+           writeRegister(0, REG_FIFO_RST, FIFO_RST_ALL) &&
+           writeRegister(0, REG_FIFO_RST, 0x00) &&
+           writeRegister(0, REG_FIFO_EN_2, FIFO_EN_2_ACCEL) &&
+           writeRegister(0, REG_USER_CTRL, USER_CTRL_FIFO_EN);
+}
+
+size_t Icm20948::readFifo(MotionSample* samples, size_t max) {
+    uint8_t countBytes[2];
+    if (samples == nullptr || !readRegisters(0, REG_FIFO_COUNTH, countBytes, sizeof(countBytes))) {
+        return 0;
+    }
+
+    size_t available = (static_cast<size_t>(countBytes[0] & 0x1F) << 8 | countBytes[1]) / 6;
+    size_t count = available < max ? available : max;
+
+    uint8_t chunk[FIFO_CHUNK_BYTES];
+    size_t read = 0;
+    while (read < count) {
+        size_t n = count - read;
+        if (n > FIFO_CHUNK_BYTES / 6) {
+            n = FIFO_CHUNK_BYTES / 6;
+        }
+        if (!readRegisters(0, REG_FIFO_R_W, chunk, n * 6)) {
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            toMilliG(&chunk[i * 6], samples[read + i]);
+        }
+        read += n;
+    }
+    return read;
+}
+
+bool Icm20948::takeMotionInterrupt() {
+    uint8_t status = 0;
+    if (!readRegisters(0, REG_INT_STATUS, &status, 1)) {
+        return false;
+    }
+    return (status & INT_WOM) != 0;
+}
+
+bool Icm20948::readAccel(MotionSample& sample) {
+    uint8_t data[6];
+    if (!readRegisters(0, REG_ACCEL_XOUT_H, data, sizeof(data))) {
+        return false;
+    }
+
+    toMilliG(data, sample);
+    return true;
+}
+
+size_t Icm20948::readAccelBurst(MotionSample* samples, size_t count) {
+    size_t read = 0;
+    while (read < count) {
+        if (read > 0) {
+            delay(_samplePeriodMs);
+        }
+        if (!readAccel(samples[read])) {
+            break;
+        }
+        read++;
+    }
+    return read;
+}
+
+// ============================================================================
+// Register Access
+// ============================================================================
+
+void Icm20948::toMilliG(const uint8_t* data, MotionSample& sample) {
+    int16_t raw[3];
+    for (int i = 0; i < 3; i++) {
+        raw[i] = static_cast<int16_t>((data[2 * i] << 8) | data[2 * i + 1]);
+    }
+    sample.x = static_cast<int16_t>(static_cast<int32_t>(raw[0]) * 1000 / ACCEL_LSB_PER_G);
+    sample.y = static_cast<int16_t>(static_cast<int32_t>(raw[1]) * 1000 / ACCEL_LSB_PER_G);
+    sample.z = static_cast<int16_t>(static_cast<int32_t>(raw[2]) * 1000 / ACCEL_LSB_PER_G);
+}
+
+bool Icm20948::selectBank(uint8_t bank) {
+    if (bank == _bank) {
+        return true;
+    }
+    _wire.beginTransmission(_address);
+    _wire.write(REG_BANK_SEL);
+    _wire.write(static_cast<uint8_t>(bank << 4));
+    if (_wire.endTransmission() != 0) {
+        _bank = 0xFF;
+        return false;
+    }
+    _bank = bank;
+    return true;
+}
+
+bool Icm20948::writeRegister(uint8_t bank, uint8_t reg, uint8_t value) {
+    if (!selectBank(bank)) {
+        return false;
+    }
+    _wire.beginTransmission(_address);
+    _wire.write(reg);
+    _wire.write(value);
+    return _wire.endTransmission() == 0;
+}
+
+bool Icm20948::readRegisters(uint8_t bank, uint8_t reg, uint8_t* data, size_t len) {
+    if (!selectBank(bank)) {
+        return false;
+    }
+    _wire.beginTransmission(_address);
+    _wire.write(reg);
+    if (_wire.endTransmission(false) != 0) {
+        return false;
+    }
+    if (_wire.requestFrom(_address, static_cast<uint8_t>(len)) != len) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        data[i] = static_cast<uint8_t>(_wire.read());
+    }
+    return true;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file icm20948.h
+ * @brief Minimal ICM-20948 accelerometer driver for wake-on-motion.
+ *
+ * Only what the collar needs for motion gating and activity detection:
+ * the accelerometer in low-power cycle mode, the wake-on-motion (WOM)
+ * interrupt on INT1, and reads of acceleration in milli-g, either directly
+ * or from the FIFO that keeps sampling while the ESP32 sleeps. Gyro and
+ * magnetometer stay off.
+ *
+ * INT1 is configured active-high and latched until INT_STATUS is read,
+ * so it can be used directly as an esp_sleep ext0 wakeup source.
+ *
+ * Requires the Arduino framework (Wire).
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef ICM20948_H
+#define ICM20948_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "../motion_gate/motion_gate.h"
+
+// I2C address with AD0 high (Adafruit breakout default); 0x68 with AD0 low
+constexpr uint8_t ICM20948_DEFAULT_ADDRESS = 0x69;
+
+// Accelerometer samples held by the 512-byte FIFO (6 bytes each)
+constexpr size_t ICM20948_FIFO_SAMPLES = 512 / 6;
+
+/**
+ * @brief ICM-20948 accelerometer with wake-on-motion interrupt.
+ */
+class Icm20948 {
+public:
+    /**
+     * @brief Construct a driver instance.
+     *
+     * @param wire    Initialized I2C bus.
+     * @param address 7-bit I2C address.
+     */
+    explicit Icm20948(TwoWire& wire, uint8_t address = ICM20948_DEFAULT_ADDRESS);
+
+    /**
+     * @brief Probe the device (WHO_AM_I).
+     * @return true if an ICM-20948 responded.
+     */
+    bool begin();
+
+    /**
+     * @brief Configure low-power accelerometer sampling and the WOM interrupt.
+     *
+     * @param thresholdMg  Sample-to-sample change that triggers the interrupt
+     *                     (4 mg resolution, max 1020 mg).
+     * @param sampleRateHz Accelerometer output rate in low-power mode.
+     * @return true on success.
+     */
+    bool enableWakeOnMotion(uint16_t thresholdMg, uint16_t sampleRateHz);
+
+    /**
+     * @brief Record accelerometer samples in the FIFO (stream mode, the
+     *        oldest samples are overwritten once it is full).
+     * @return true on success.
+     */
+    bool enableFifo();
+
+    /**
+     * @brief Drain the FIFO, oldest sample first.
+     * @return Number of samples read.
+     */
+    size_t readFifo(MotionSample* samples, size_t max);
+
+    /**
+     * @brief Read and clear the interrupt status.
+     * @return true if a wake-on-motion interrupt was pending.
+     */
+    bool takeMotionInterrupt();
+
+    /**
+     * @brief Read the latest acceleration sample.
+     * @return true on success.
+     */
+    bool readAccel(MotionSample& sample);
+
+    /**
+     * @brief Read consecutive samples, waiting one sample period between reads.
+     * @return Number of samples read.
+     */
+    size_t readAccelBurst(MotionSample* samples, size_t count);
+
+private:
+    TwoWire& _wire;
+    uint8_t _address;
+    uint8_t _bank;
+    uint16_t _samplePeriodMs;
+
+    bool selectBank(uint8_t bank);
+    bool writeRegister(uint8_t bank, uint8_t reg, uint8_t value);
+    bool readRegisters(uint8_t bank, uint8_t reg, uint8_t* data, size_t len);
+    static void toMilliG(const uint8_t* data, MotionSample& sample);
+};
+
+#endif // ICM20948_H
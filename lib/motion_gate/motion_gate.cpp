@@ -0,0 +1,96 @@
+/**
+ * @file motion_gate.cpp
+ * @brief Implementation of the motion-gated GPS decision logic.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "motion_gate.h"
+
+// ============================================================================
+// Internal Helpers
+// ============================================================================
+
+static uint32_t absDiff(int16_t a, int16_t b) {
+    int32_t d = static_cast<int32_t>(a) - static_cast<int32_t>(b);
+    return static_cast<uint32_t>(d < 0 ? -d : d);
+}
+
+/**
+ * @brief Halve the score once per elapsed half-life.
+ *
+ * Only whole half-lives are consumed, so frequent calls do not stall the decay.
+ */
+static void decay(MotionGateState& state, const MotionGateConfig& config, uint32_t nowSec) {
+    if (state.score == 0 || config.halfLifeSec == 0 || nowSec <= state.lastDecaySec) {
+        state.lastDecaySec = nowSec;
+        return;
+    }
+
+    uint32_t halvings = (nowSec - state.lastDecaySec) / config.halfLifeSec;
+    if (halvings == 0) {
+        return;
+    }
+
+    state.score = halvings >= 16 ? 0 : static_cast<uint16_t>(state.score >> halvings);
+    state.lastDecaySec += halvings * config.halfLifeSec;
+}
+
+static void addScore(MotionGateState& state, const MotionGateConfig& config,
+                     uint32_t amount, uint32_t nowSec) {
+    decay(state, config, nowSec);
+
+    uint32_t score = state.score + amount;
+    state.score = score > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(score);
+
+    // Only fresh motion counts; a score still decaying from earlier does not
+    if (amount > 0 && state.score >= config.movingScore) {
+        state.lastMovingSec = nowSec;
+    }
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void motionGateAddEvent(MotionGateState& state, const MotionGateConfig& config,
+                        uint32_t nowSec) {
+    addScore(state, config, config.wakeEventScore, nowSec);
+}
+
+void motionGateAddSamples(MotionGateState& state, const MotionGateConfig& config,
+                          const MotionSample* samples, size_t count, uint32_t nowSec) {
+    if (samples == nullptr || count < 2) {
+        return;
+    }
+
+    uint32_t total = 0;
+    for (size_t i = 1; i < count; i++) {
+        uint32_t change = absDiff(samples[i].x, samples[i - 1].x) +
+                          absDiff(samples[i].y, samples[i - 1].y) +
+                          absDiff(samples[i].z, samples[i - 1].z);
+        if (change > config.noiseFloorMg) {
+            total += change - config.noiseFloorMg;
+        }
+    }
+
+    addScore(state, config, total, nowSec);
+}
+
+MotionGateDecision motionGateDecide(MotionGateState& state, const MotionGateConfig& config,
+                                    uint32_t nowSec) {
+    decay(state, config, nowSec);
+
+    if (!state.hasFix ||
+        state.score >= config.movingScore ||
+        nowSec - state.lastMovingSec < config.stillDwellSec ||
+        nowSec - state.lastFixSec >= config.maxFixAgeSec) {
+        return MotionGateDecision::ACQUIRE;
+    }
+    return MotionGateDecision::REUSE;
+}
+
+void motionGateFixAcquired(MotionGateState& state, uint32_t nowSec) {
+    state.hasFix = 1;
+    state.lastFixSec = nowSec;
+}
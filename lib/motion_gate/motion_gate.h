@@ -0,0 +1,110 @@
+/**
+ * @file motion_gate.h
+ * @brief Skip GPS acquisition while the dog is stationary.
+ *
+ * GPS is the largest power draw on the collar, and a sleeping dog needs no
+ * new fix. The optional ICM-20948 IMU wakes the collar on motion and
+ * provides a short burst of accelerometer samples on each wake. This
+ * module turns both into a decaying motion score kept in RTC memory, and
+ * decides whether the next wake acquires a fix or reuses the last one.
+ *
+ * The logic is pure and has no Arduino dependencies; it is tested natively
+ * against recorded IMU traces.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef MOTION_GATE_H
+#define MOTION_GATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================
+// TYPES
+// ============================================
+
+/**
+ * @brief One accelerometer sample in milli-g.
+ */
+struct MotionSample {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+};
+
+/**
+ * @brief Outcome of motionGateDecide().
+ */
+enum class MotionGateDecision : uint8_t {
+    ACQUIRE = 0,  ///< Acquire a new GPS fix
+    REUSE         ///< Dog is stationary, reuse the last position
+};
+
+/**
+ * @brief Tunable thresholds.
+ */
+struct MotionGateConfig {
+    uint16_t noiseFloorMg;    ///< Sample-to-sample change (L1, mg) treated as sensor noise
+    uint16_t wakeEventScore;  ///< Score added for each wake-on-motion interrupt
+    uint16_t movingScore;     ///< Score at or above which the dog counts as moving
+    uint32_t halfLifeSec;     ///< Time for the score to halve
+    uint32_t stillDwellSec;   ///< Time below movingScore before fixes are skipped
+    uint32_t maxFixAgeSec;    ///< Acquire a fix at least this often regardless
+};
+
+// Defaults for 100 Hz samples from a collar-mounted IMU
+constexpr MotionGateConfig DEFAULT_MOTION_GATE_CONFIG = {
+    50,    // noiseFloorMg
+    100,   // wakeEventScore
+    100,   // movingScore
+    30,    // halfLifeSec
+    60,    // stillDwellSec
+    600    // maxFixAgeSec
+};
+
+/**
+ * @brief Persistent state (POD, safe to place in RTC memory).
+ *
+ * Zero-initialized state acquires a fix on the first wake.
+ */
+struct MotionGateState {
+    uint16_t score;          ///< Decaying motion score
+    uint8_t hasFix;          ///< Non-zero once a fix was acquired
+    uint8_t reserved;
+    uint32_t lastDecaySec;   ///< When the score was last decayed
+    uint32_t lastMovingSec;  ///< Last time the score reached movingScore
+    uint32_t lastFixSec;     ///< When the last GPS fix was acquired
+};
+
+// ============================================
+// FUNCTIONS
+// ============================================
+
+/**
+ * @brief Record a wake-on-motion interrupt.
+ */
+void motionGateAddEvent(MotionGateState& state, const MotionGateConfig& config,
+                        uint32_t nowSec);
+
+/**
+ * @brief Score a burst of consecutive accelerometer samples.
+ *
+ * Gravity and orientation cancel out: only the change between consecutive
+ * samples beyond the noise floor adds to the score.
+ */
+void motionGateAddSamples(MotionGateState& state, const MotionGateConfig& config,
+                          const MotionSample* samples, size_t count, uint32_t nowSec);
+
+/**
+ * @brief Decide whether this wake needs a GPS fix.
+ */
+MotionGateDecision motionGateDecide(MotionGateState& state, const MotionGateConfig& config,
+                                    uint32_t nowSec);
+
+/**
+ * @brief Record that a GPS fix was acquired.
+ */
+void motionGateFixAcquired(MotionGateState& state, uint32_t nowSec);
+
+#endif // MOTION_GATE_H
@@ -0,0 +1,308 @@
+/**
+ * @file mqtt_publisher.cpp
+ * @brief Implementation of the base-station MQTT publishing stage.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "mqtt_publisher.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Meters per microdegree of latitude
+static const float METERS_PER_E6 = 0.11132f;
+
+static const uint32_t MILLI_TOKENS_PER_MESSAGE = 1000;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+// Microdegrees as decimal degrees, exactly (no float round trip)
+static void formatE6(char* out, size_t size, int32_t e6) {
+    int64_t value = e6;
+    const char* sign = value < 0 ? "-" : "";
+    value = llabs(value);
+    snprintf(out, size, "%s%ld.%06ld", sign, (long)(value / 1000000), (long)(value % 1000000));
+}
+
+static const char* fenceStateName(PacketFenceState state) {
+    switch (state) {
+        case PacketFenceState::INSIDE:  return "inside";
+        case PacketFenceState::OUTSIDE: return "outside";
+        case PacketFenceState::ALERT:   return "alert";
+        default:                        return "unknown";
+    }
+}
+
+static float metersPerE6Lon(int32_t latE6) {
+    return METERS_PER_E6 * cosf(static_cast<float>(latE6) * 1e-6f * 0.017453292f);
+}
+
+// ============================================================================
+// MqttPublisher Class Implementation
+// ============================================================================
+
+MqttPublisher::MqttPublisher(MqttSink& sink, const MqttPublisherConfig& config, size_t maxCollars)
+    : _sink(sink)
+    , _config(config)
+    , _collarCount(0)
+    , _maxCollars(maxCollars)
+    , _cursor(0)
+    , _milliTokens(static_cast<uint64_t>(config.burstMessages) * MILLI_TOKENS_PER_MESSAGE)
+    , _lastRefillMs(0)
+    , _stats()
+{
+    // Power-of-two table at most half full keeps probe runs short
+    size_t size = 4;
+    while (size < maxCollars * 2) {
+        size *= 2;
+    }
+    _slots.assign(size, CollarSlot());
+}
+
+MqttPublisher::CollarSlot* MqttPublisher::findSlot(uint32_t collarId, bool create) {
+    size_t mask = _slots.size() - 1;
+    for (size_t i = (collarId * 2654435761u) & mask;; i = (i + 1) & mask) {
+        CollarSlot& slot = _slots[i];
+        if (slot.used && slot.latest.collarId == collarId) {
+            return &slot;
+        }
+        if (!slot.used) {
+            if (!create || _collarCount >= _maxCollars) {
+                return nullptr;
+            }
+            slot = CollarSlot();
+            slot.used = true;
+            slot.latest.collarId = collarId;
+            _collarCount++;
+            return &slot;
+        }
+    }
+}
+
+bool MqttPublisher::update(const CollarUpdate& update, uint32_t nowMs) {
+    CollarSlot* slot = findSlot(update.collarId, true);
+    if (slot == nullptr) {
+        _stats.tableFull++;
+        return false;
+    }
+
+    if (slot->pending) {
+        _stats.coalesced++;
+    } else {
+        slot->pending = true;
+        slot->pendingSinceMs = nowMs;
+    }
+    slot->latest = update;
+    slot->attributesSent = false;
+    _stats.updates++;
+    return true;
+}
+
+size_t MqttPublisher::poll(uint32_t nowMs) {
+    refill(nowMs);
+
+    size_t published = 0;
+    size_t mask = _slots.size() - 1;
+    for (size_t n = 0; n < _slots.size(); n++) {
+        size_t i = (_cursor + n) & mask;
+        if (_slots[i].used && !serve(_slots[i], nowMs, published)) {
+            // Out of budget (or the broker is away): start here next time
+            _cursor = i;
+            _stats.deferred++;
+            break;
+        }
+    }
+    return published;
+}
+
+size_t MqttPublisher::pendingCount() const {
+    size_t count = 0;
+    for (const CollarSlot& slot : _slots) {
+        if (slot.used && slot.pending) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool MqttPublisher::serve(CollarSlot& slot, uint32_t nowMs, size_t& published) {
+    if (!slot.discovered) {
+        if (!publishDiscovery(slot)) {
+            return false;
+        }
+        slot.discovered = true;
+        _stats.discoveries++;
+        published++;
+    }
+    if (!slot.pending) {
+        return true;
+    }
+
+    const CollarUpdate& latest = slot.latest;
+    bool stateChanged = !slot.published || latest.fenceState != slot.sent.fenceState;
+    if (!stateChanged && nowMs - slot.pendingSinceMs < _config.windowMs) {
+        return true;    // Window still open
+    }
+
+    if (!stateChanged && !movedEnough(slot) && latest.battery == slot.sent.battery &&
+        nowMs - slot.lastPublishMs < _config.heartbeatMs) {
+        _stats.suppressed++;
+        slot.pending = false;
+        return true;
+    }
+
+    // Budget for both messages up front, so a state change is not split
+    // by the rate limit
+    bool sendState = stateChanged && latest.fenceState != PacketFenceState::UNKNOWN;
+    uint64_t cost = ((slot.attributesSent ? 0 : 1) + (sendState ? 1 : 0)) * MILLI_TOKENS_PER_MESSAGE;
+    if (_config.maxMessagesPerSec > 0 && _milliTokens < cost) {
+        return false;
+    }
+    if (!slot.attributesSent) {
+        if (!publishAttributes(slot)) {
+            return false;
+        }
+        slot.attributesSent = true;
+        published++;
+    }
+    if (sendState) {
+        if (!publishState(slot)) {
+            return false;   // Attributes went out; only the state is retried
+        }
+        published++;
+    }
+
+    slot.sent = latest;
+    slot.published = true;
+    slot.pending = false;
+    slot.attributesSent = false;
+    slot.lastPublishMs = nowMs;
+    slot.metersPerE6Lon = metersPerE6Lon(latest.fix.latE6);
+    return true;
+}
+
+bool MqttPublisher::movedEnough(const CollarSlot& slot) const {
+    float north = static_cast<float>(static_cast<int64_t>(slot.latest.fix.latE6) - slot.sent.fix.latE6) *
+                  METERS_PER_E6;
+    float east = static_cast<float>(static_cast<int64_t>(slot.latest.fix.lonE6) - slot.sent.fix.lonE6) *
+                 slot.metersPerE6Lon;
+    return north * north + east * east >= _config.minMoveMeters * _config.minMoveMeters;
+}
+
+// ============================================================================
+// Rate Limit
+// ============================================================================
+
+void MqttPublisher::refill(uint32_t nowMs) {
+    if (_config.maxMessagesPerSec == 0) {
+        return;
+    }
+    uint64_t capacity = static_cast<uint64_t>(_config.burstMessages) * MILLI_TOKENS_PER_MESSAGE;
+    _milliTokens += static_cast<uint64_t>(nowMs - _lastRefillMs) * _config.maxMessagesPerSec;
+    if (_milliTokens > capacity) {
+        _milliTokens = capacity;
+    }
+    _lastRefillMs = nowMs;
+}
+
+// ============================================================================
+// Messages
+// ============================================================================
+
+bool MqttPublisher::send(bool retain, size_t length) {
+    if (length >= MQTT_PAYLOAD_MAX) {
+        _stats.sinkErrors++;    // Prefixes too long for the buffers
+        return false;
+    }
+    if (_config.maxMessagesPerSec > 0 && _milliTokens < MILLI_TOKENS_PER_MESSAGE) {
+        return false;
+    }
+    if (!_sink.publish(_topic, _payload, length, retain)) {
+        _stats.sinkErrors++;
+        return false;
+    }
+    if (_config.maxMessagesPerSec > 0) {
+        _milliTokens -= MILLI_TOKENS_PER_MESSAGE;
+    }
+    _stats.messages++;
+    return true;
+}
+
+bool MqttPublisher::publishDiscovery(const CollarSlot& slot) {
+    uint32_t id = slot.latest.collarId;
+    int topic = snprintf(_topic, sizeof(_topic), "%s/device_tracker/uncollar_%lu/config",
+                         _config.discoveryPrefix, (unsigned long)id);
+    int length = snprintf(_payload, sizeof(_payload),
+                          "{\"name\":\"Collar %lu\",\"unique_id\":\"uncollar_%lu\","
+                          "\"state_topic\":\"%s/%lu/state\","
+                          "\"json_attributes_topic\":\"%s/%lu/attributes\","
+                          "\"payload_home\":\"home\",\"payload_not_home\":\"not_home\","
+                          "\"source_type\":\"gps\","
+                          "\"device\":{\"identifiers\":[\"uncollar_%lu\"],"
+                          "\"name\":\"Uncollar %lu\",\"manufacturer\":\"Uncollar\"}}",
+                          (unsigned long)id, (unsigned long)id,
+                          _config.topicPrefix, (unsigned long)id,
+                          _config.topicPrefix, (unsigned long)id,
+                          (unsigned long)id, (unsigned long)id);
+    return topic > 0 && static_cast<size_t>(topic) < sizeof(_topic) && length > 0 &&
+           send(true, static_cast<size_t>(length));
+}
+
+bool MqttPublisher::publishState(const CollarSlot& slot) {
+    int topic = snprintf(_topic, sizeof(_topic), "%s/%lu/state", _config.topicPrefix,
+                         (unsigned long)slot.latest.collarId);
+    int length = snprintf(_payload, sizeof(_payload), "%s",
+                          slot.latest.fenceState == PacketFenceState::INSIDE ? "home" : "not_home");
+    return topic > 0 && static_cast<size_t>(topic) < sizeof(_topic) && length > 0 &&
+           send(true, static_cast<size_t>(length));
+}
+
+bool MqttPublisher::publishAttributes(const CollarSlot& slot) {
+    const CollarUpdate& update = slot.latest;
+    char lat[16];
+    char lon[16];
+    formatE6(lat, sizeof(lat), update.fix.latE6);
+    formatE6(lon, sizeof(lon), update.fix.lonE6);
+
+    int topic = snprintf(_topic, sizeof(_topic), "%s/%lu/attributes", _config.topicPrefix,
+                         (unsigned long)update.collarId);
+    int length = snprintf(_payload, sizeof(_payload),
+                          "{\"latitude\":%s,\"longitude\":%s,\"fence\":\"%s\","
+                          "\"battery_level\":%u,\"fix_time\":%lu}",
+                          lat, lon, fenceStateName(update.fenceState),
+                          (unsigned)(update.battery * 100 / POSITION_BATTERY_MAX),
+                          (unsigned long)update.fix.timestamp);
+    return topic > 0 && static_cast<size_t>(topic) < sizeof(_topic) && length > 0 &&
+           send(true, static_cast<size_t>(length));
+}
+
+// ============================================================================
+// MemoryMqttBroker Class Implementation
+// ============================================================================
+
+MemoryMqttBroker::MemoryMqttBroker()
+    : _messages(0)
+    , _retained(0)
+    , _bytes(0)
+    , _offline(false)
+{
+}
+
+bool MemoryMqttBroker::publish(const char* topic, const char* payload, size_t length, bool retain) {
+    if (_offline) {
+        return false;
+    }
+    _messages++;
+    _retained += retain ? 1 : 0;
+    _bytes += length;
+    _topics[topic].assign(payload, length);
+    return true;
+}
+
+const std::string* MemoryMqttBroker::lastPayload(const std::string& topic) const {
+    std::map<std::string, std::string>::const_iterator it = _topics.find(topic);
+    return it != _topics.end() ? &it->second : nullptr;
+}
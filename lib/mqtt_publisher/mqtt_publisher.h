@@ -0,0 +1,228 @@
+/**
+ * @file mqtt_publisher.h
+ * @brief Base-station MQTT publishing stage with per-collar coalescing.
+ *
+ * Every LoRa position packet could become an MQTT message, but Home
+ * Assistant's recorder stores each one and most are "the dog is still
+ * lying in the yard". The publisher sits between the radio and the
+ * broker:
+ *
+ *  - Updates for a collar are coalesced for windowMs; only the latest is
+ *    published when the window ends.
+ *  - A window ends in silence unless the collar moved at least
+ *    minMoveMeters, its battery level changed or heartbeatMs passed
+ *    since its last message. A fence state change skips the window and
+ *    is published on the next poll.
+ *  - Location, fence state and battery go out together as one
+ *    attributes message per collar; Home Assistant discovery for new
+ *    collars is sent in the same polls, retained, once per collar.
+ *  - A token bucket caps the total message rate. Collars left over are
+ *    served first on the next poll, so none starves.
+ *
+ * Topics and payloads are formatted into two fixed buffers and collar
+ * state lives in a table sized at construction: publishing allocates
+ * nothing. The broker connection is an MqttSink; MemoryMqttBroker is an
+ * in-process stand-in for tests and benchmarks.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef MQTT_PUBLISHER_H
+#define MQTT_PUBLISHER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "../position_codec/position_codec.h"
+
+// ============================================
+// CONSTANTS
+// ============================================
+
+constexpr size_t MQTT_TOPIC_MAX = 96;
+constexpr size_t MQTT_PAYLOAD_MAX = 512;
+
+// ============================================
+// CONFIGURATION
+// ============================================
+
+struct MqttPublisherConfig {
+    const char* topicPrefix;        ///< Collar topics: <prefix>/<id>/state, /attributes
+    const char* discoveryPrefix;    ///< Home Assistant discovery prefix
+    uint32_t windowMs;              ///< Coalescing window per collar
+    float minMoveMeters;            ///< Smaller moves are not published
+    uint32_t heartbeatMs;           ///< Publish at least this often while updates arrive
+    uint32_t maxMessagesPerSec;     ///< Total rate limit; 0 for none
+    uint32_t burstMessages;         ///< Token bucket depth
+};
+
+constexpr MqttPublisherConfig DEFAULT_MQTT_PUBLISHER_CONFIG = {
+    "uncollar",         // topicPrefix
+    "homeassistant",    // discoveryPrefix
+    10000,              // windowMs
+    15.0f,              // minMoveMeters (about GPS noise)
+    300000,             // heartbeatMs
+    50,                 // maxMessagesPerSec
+    100                 // burstMessages
+};
+
+// ============================================
+// TYPES
+// ============================================
+
+/**
+ * @brief Latest known state of one collar (decoded from its uplink).
+ */
+struct CollarUpdate {
+    uint32_t collarId;
+    PositionFix fix;
+    PacketFenceState fenceState;
+    uint8_t battery;            ///< 0..POSITION_BATTERY_MAX
+};
+
+struct MqttPublisherStats {
+    uint32_t updates;           ///< update() calls accepted
+    uint32_t coalesced;         ///< Updates replaced by a newer one before publishing
+    uint32_t suppressed;        ///< Windows that ended without a change worth publishing
+    uint32_t messages;          ///< Messages published (all topics)
+    uint32_t discoveries;       ///< Of which discovery configs
+    uint32_t deferred;          ///< Polls that hit the rate limit with work left
+    uint32_t sinkErrors;        ///< Publishes the sink refused (retried next poll)
+    uint32_t tableFull;         ///< Updates dropped: more collars than the table holds
+};
+
+/**
+ * @brief Connection to a broker.
+ */
+class MqttSink {
+public:
+    virtual ~MqttSink() {}
+
+    /**
+     * @brief Publish one message (QoS 0).
+     *
+     * @return false if it could not be sent; the publisher retries later.
+     */
+    virtual bool publish(const char* topic, const char* payload, size_t length, bool retain) = 0;
+};
+
+// ============================================
+// PUBLISHER CLASS
+// ============================================
+
+class MqttPublisher {
+public:
+    /**
+     * @param sink       Broker connection (must outlive the publisher).
+     * @param config     Topics, windows and limits (strings must stay valid).
+     * @param maxCollars Collar table size; allocated once, here.
+     */
+    MqttPublisher(MqttSink& sink, const MqttPublisherConfig& config, size_t maxCollars);
+
+    /**
+     * @brief Record a collar's latest state (nothing is published here).
+     *
+     * @param nowMs Base-station clock in ms.
+     * @return false if the collar is new and the table is full.
+     */
+    bool update(const CollarUpdate& update, uint32_t nowMs);
+
+    /**
+     * @brief Publish whatever is due, within the rate limit.
+     *
+     * Call often (every loop iteration or every ~100 ms).
+     *
+     * @return Number of messages published.
+     */
+    size_t poll(uint32_t nowMs);
+
+    /**
+     * @brief Collars waiting for their window to end or for rate budget.
+     */
+    size_t pendingCount() const;
+
+    const MqttPublisherStats& stats() const { return _stats; }
+
+private:
+    struct CollarSlot {
+        bool used;
+        bool discovered;            ///< Discovery config published
+        bool pending;               ///< latest not yet handled
+        bool attributesSent;        ///< latest's attributes are out, its state is not
+        bool published;             ///< sent has been published at least once
+        uint32_t pendingSinceMs;    ///< First update of the current window
+        uint32_t lastPublishMs;
+        float metersPerE6Lon;       ///< At the last published latitude
+        CollarUpdate latest;
+        CollarUpdate sent;
+    };
+
+    MqttSink& _sink;
+    MqttPublisherConfig _config;
+    std::vector<CollarSlot> _slots;     ///< Open addressing on collarId
+    size_t _collarCount;
+    size_t _maxCollars;
+    size_t _cursor;                     ///< Poll resumes here after a deferral
+    uint64_t _milliTokens;              ///< Token bucket, 1000 per message
+    uint32_t _lastRefillMs;
+    MqttPublisherStats _stats;
+    char _topic[MQTT_TOPIC_MAX];
+    char _payload[MQTT_PAYLOAD_MAX];
+
+    CollarSlot* findSlot(uint32_t collarId, bool create);
+    void refill(uint32_t nowMs);
+    bool send(bool retain, size_t length);
+    bool publishDiscovery(const CollarSlot& slot);
+    bool publishState(const CollarSlot& slot);
+    bool publishAttributes(const CollarSlot& slot);
+    bool movedEnough(const CollarSlot& slot) const;
+
+    /**
+     * Publish what one collar needs; false if out of tokens or the sink
+     * refused, with the slot left as it was for the next poll
+     */
+    bool serve(CollarSlot& slot, uint32_t nowMs, size_t& published);
+};
+
+// ============================================
+// IN-PROCESS BROKER
+// ============================================
+
+/**
+ * @brief Broker stand-in for tests and benchmarks.
+ *
+ * Keeps the last message per topic (like retained messages on a real
+ * broker) and counts everything it is sent.
+ */
+class MemoryMqttBroker : public MqttSink {
+public:
+    MemoryMqttBroker();
+
+    bool publish(const char* topic, const char* payload, size_t length, bool retain) override;
+
+    /**
+     * @brief Last payload on a topic, or nullptr.
+     */
+    const std::string* lastPayload(const std::string& topic) const;
+
+    /**
+     * @brief Make publish() fail (a dropped connection) or succeed again.
+     */
+    void setOffline(bool offline) { _offline = offline; }
+
+    uint32_t messageCount() const { return _messages; }
+    uint32_t retainedCount() const { return _retained; }
+    size_t topicCount() const { return _topics.size(); }
+    uint64_t payloadBytes() const { return _bytes; }
+
+private:
+    std::map<std::string, std::string> _topics;
+    uint32_t _messages;
+    uint32_t _retained;
+    uint64_t _bytes;
+    bool _offline;
+};
+
+#endif // MQTT_PUBLISHER_H
@@ -7,6 +7,8 @@
 
 #include "point_in_polygon.h"
 
+#include <math.h>
+
 // ============================================================================
 // Polygon Class Implementation
 // ============================================================================
@@ -103,6 +105,54 @@ bool Polygon::contains(const GeoPoint& point) const {
     return inside;
 }
 
+float Polygon::distanceToBoundary(const GeoPoint& point) const {
+    // Invalid polygon check
+    if (_vertices == nullptr || _count < 3) {
+        return -1.0f;
+    }
+
+    // Project vertices into a local planar frame (meters) centered on the point.
+    // Longitude degrees shrink with cos(latitude).
+    const float kLat = METERS_PER_DEGREE;
+    const float kLon = METERS_PER_DEGREE * cosf(point.lat * 0.017453292f);
+
+    float minDistSq = -1.0f;
+    size_t j = _count - 1;
+
+    for (size_t i = 0; i < _count; i++) {
+        // Edge from vj to vi, relative to the point
+        float ax = (_vertices[j].lon - point.lon) * kLon;
+        float ay = (_vertices[j].lat - point.lat) * kLat;
+        float bx = (_vertices[i].lon - point.lon) * kLon;
+        float by = (_vertices[i].lat - point.lat) * kLat;
+
+        // Closest point on segment AB to the origin
+        float dx = bx - ax;
+        float dy = by - ay;
+        float lenSq = dx * dx + dy * dy;
+        float t = 0.0f;
+        if (lenSq > 0.0f) {
+            t = -(ax * dx + ay * dy) / lenSq;
+            if (t < 0.0f) {
+                t = 0.0f;
+            } else if (t > 1.0f) {
+                t = 1.0f;
+            }
+        }
+
+        float cx = ax + t * dx;
+        float cy = ay + t * dy;
+        float distSq = cx * cx + cy * cy;
+        if (minDistSq < 0.0f || distSq < minDistSq) {
+            minDistSq = distSq;
+        }
+
+        j = i;
+    }
+
+    return sqrtf(minDistSq);
+}
+
 size_t Polygon::vertexCount() const {
     return _count;
 }
@@ -14,6 +14,11 @@
 
 #include <stddef.h>
 
+/**
+ * @brief Approximate meters per degree of latitude (and of longitude at the equator).
+ */
+constexpr float METERS_PER_DEGREE = 111320.0f;
+
 /**
  * @brief Represents a geographic coordinate in decimal degrees.
  * 
@@ -66,6 +71,20 @@ public:
      */
     bool contains(const GeoPoint& point) const;
 
+    /**
+     * @brief Get the distance from a point to the nearest polygon edge.
+     * 
+     * Uses a local equirectangular projection around the point, which is
+     * accurate to well under a meter at geofence scales (< a few km).
+     * 
+     * @param point The geographic point to measure from.
+     * @return Distance in meters (always >= 0), or a negative value if the
+     *         polygon is invalid.
+     * 
+     * @note Combine with contains() to get a signed distance to the fence.
+     */
+    float distanceToBoundary(const GeoPoint& point) const;
+
     /**
      * @brief Get the number of vertices in the polygon.
      */
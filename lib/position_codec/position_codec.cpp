@@ -0,0 +1,198 @@
+/**
+ * @file position_codec.cpp
+ * @brief Implementation of the compact position packet codec.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "position_codec.h"
+
+#include <math.h>
+
+// ============================================================================
+// Varint Helpers
+// ============================================================================
+
+/**
+ * @brief Map a signed value to unsigned so small magnitudes stay small.
+ */
+static uint32_t zigzagEncode(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+static int32_t zigzagDecode(uint32_t value) {
+    return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+/**
+ * @brief Append an unsigned LEB128 varint. Returns false on overflow.
+ */
+static bool writeVarint(uint8_t* out, size_t capacity, size_t& pos, uint32_t value) {
+    do {
+        if (pos >= capacity) {
+            return false;
+        }
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if (value != 0) {
+            byte |= 0x80;
+        }
+        out[pos++] = byte;
+    } while (value != 0);
+    return true;
+}
+
+/**
+ * @brief Read an unsigned LEB128 varint (max 5 bytes). Returns false if malformed.
+ */
+static bool readVarint(const uint8_t* data, size_t length, size_t& pos, uint32_t& value) {
+    value = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        if (pos >= length) {
+            return false;
+        }
+        uint8_t byte = data[pos++];
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool writeInt32(uint8_t* out, size_t capacity, size_t& pos, int32_t value) {
+    if (pos + 4 > capacity) {
+        return false;
+    }
+    uint32_t v = static_cast<uint32_t>(value);
+    out[pos++] = v & 0xFF;
+    out[pos++] = (v >> 8) & 0xFF;
+    out[pos++] = (v >> 16) & 0xFF;
+    out[pos++] = (v >> 24) & 0xFF;
+    return true;
+}
+
+static bool readInt32(const uint8_t* data, size_t length, size_t& pos, int32_t& value) {
+    if (pos + 4 > length) {
+        return false;
+    }
+    uint32_t v = static_cast<uint32_t>(data[pos]) |
+                 (static_cast<uint32_t>(data[pos + 1]) << 8) |
+                 (static_cast<uint32_t>(data[pos + 2]) << 16) |
+                 (static_cast<uint32_t>(data[pos + 3]) << 24);
+    pos += 4;
+    value = static_cast<int32_t>(v);
+    return true;
+}
+
+// ============================================================================
+// Conversion Helpers
+// ============================================================================
+
+int32_t degreesToE6(float degrees) {
+    return static_cast<int32_t>(lroundf(degrees * 1000000.0f));
+}
+
+float e6ToDegrees(int32_t e6) {
+    return static_cast<float>(e6 / 1000000.0);
+}
+
+uint8_t batteryPercentToLevel(uint8_t percent) {
+    if (percent >= 100) {
+        return POSITION_BATTERY_MAX;
+    }
+    return static_cast<uint8_t>((percent * POSITION_BATTERY_MAX + 50) / 100);
+}
+
+// ============================================================================
+// Encode / Decode
+// ============================================================================
+
+size_t positionPacketEncode(const PositionPacket& packet, uint8_t* out, size_t capacity) {
+    if (out == nullptr || packet.fixCount == 0 ||
+        packet.fixCount > POSITION_PACKET_MAX_FIXES ||
+        capacity < POSITION_PACKET_HEADER_SIZE) {
+        return 0;
+    }
+
+    // Header
+    uint16_t seq = packet.sequence & POSITION_SEQUENCE_MASK;
+    uint8_t battery = packet.battery > POSITION_BATTERY_MAX ? POSITION_BATTERY_MAX : packet.battery;
+    out[0] = static_cast<uint8_t>((POSITION_CODEC_VERSION << 6) |
+                                  ((static_cast<uint8_t>(packet.fenceState) & 0x03) << 4) |
+                                  ((packet.fixCount - 1) & 0x0F));
+    out[1] = static_cast<uint8_t>((battery << 4) | (seq >> 8));
+    out[2] = static_cast<uint8_t>(seq & 0xFF);
+    size_t pos = POSITION_PACKET_HEADER_SIZE;
+
+    // Keyframe
+    const PositionFix& key = packet.fixes[0];
+    if (!writeInt32(out, capacity, pos, key.latE6) ||
+        !writeInt32(out, capacity, pos, key.lonE6) ||
+        !writeVarint(out, capacity, pos, key.timestamp)) {
+        return 0;
+    }
+
+    // Deltas against the previous fix
+    for (uint8_t i = 1; i < packet.fixCount; i++) {
+        const PositionFix& prev = packet.fixes[i - 1];
+        const PositionFix& fix = packet.fixes[i];
+        if (fix.timestamp < prev.timestamp) {
+            return 0;
+        }
+
+        // Wrapping subtraction in unsigned space avoids signed overflow
+        int32_t dLat = static_cast<int32_t>(static_cast<uint32_t>(fix.latE6) - static_cast<uint32_t>(prev.latE6));
+        int32_t dLon = static_cast<int32_t>(static_cast<uint32_t>(fix.lonE6) - static_cast<uint32_t>(prev.lonE6));
+
+        if (!writeVarint(out, capacity, pos, zigzagEncode(dLat)) ||
+            !writeVarint(out, capacity, pos, zigzagEncode(dLon)) ||
+            !writeVarint(out, capacity, pos, fix.timestamp - prev.timestamp)) {
+            return 0;
+        }
+    }
+
+    return pos;
+}
+
+bool positionPacketDecode(const uint8_t* data, size_t length, PositionPacket& packet) {
+    if (data == nullptr || length < POSITION_PACKET_HEADER_SIZE) {
+        return false;
+    }
+
+    // Header
+    if ((data[0] >> 6) != POSITION_CODEC_VERSION) {
+        return false;
+    }
+    packet.fenceState = static_cast<PacketFenceState>((data[0] >> 4) & 0x03);
+    packet.fixCount = static_cast<uint8_t>((data[0] & 0x0F) + 1);
+    packet.battery = data[1] >> 4;
+    packet.sequence = static_cast<uint16_t>(((data[1] & 0x0F) << 8) | data[2]);
+    size_t pos = POSITION_PACKET_HEADER_SIZE;
+
+    // Keyframe
+    PositionFix& key = packet.fixes[0];
+    if (!readInt32(data, length, pos, key.latE6) ||
+        !readInt32(data, length, pos, key.lonE6) ||
+        !readVarint(data, length, pos, key.timestamp)) {
+        return false;
+    }
+
+    // Deltas
+    for (uint8_t i = 1; i < packet.fixCount; i++) {
+        const PositionFix& prev = packet.fixes[i - 1];
+        PositionFix& fix = packet.fixes[i];
+        uint32_t zLat, zLon, dt;
+        if (!readVarint(data, length, pos, zLat) ||
+            !readVarint(data, length, pos, zLon) ||
+            !readVarint(data, length, pos, dt)) {
+            return false;
+        }
+        fix.latE6 = static_cast<int32_t>(static_cast<uint32_t>(prev.latE6) + static_cast<uint32_t>(zigzagDecode(zLat)));
+        fix.lonE6 = static_cast<int32_t>(static_cast<uint32_t>(prev.lonE6) + static_cast<uint32_t>(zigzagDecode(zLon)));
+        fix.timestamp = prev.timestamp + dt;
+    }
+
+    // Trailing bytes mean the packet is not what we think it is
+    return pos == length;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file position_codec.h
+ * @brief Compact binary LoRa position packet codec with delta encoding.
+ *
+ * Bytes on air are transmit time and battery, so position uplinks are
+ * packed instead of sent as JSON. A packet carries a 3-byte header
+ * followed by one keyframe fix (absolute int32 microdegrees) and up to
+ * 15 delta fixes (zigzag varints relative to the previous fix).
+ *
+ * The codec is portable C++ with no Arduino dependencies: the collar
+ * encodes, the base station decodes, and both sides are tested natively.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef POSITION_CODEC_H
+#define POSITION_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================
+// PACKET FORMAT
+// ============================================
+//
+// Header (3 bytes):
+//   byte 0: [7:6] codec version  [5:4] fence state  [3:0] fix count - 1
+//   byte 1: [7:4] battery level  [3:0] sequence bits 11..8
+//   byte 2: sequence bits 7..0
+//
+// Keyframe (first fix):
+//   int32 latitude (microdegrees, little-endian)
+//   int32 longitude (microdegrees, little-endian)
+//   uvarint timestamp (seconds)
+//
+// Each following fix:
+//   zigzag varint latitude delta
+//   zigzag varint longitude delta
+//   uvarint timestamp delta
+
+constexpr uint8_t POSITION_CODEC_VERSION = 1;
+constexpr size_t POSITION_PACKET_HEADER_SIZE = 3;
+constexpr size_t POSITION_PACKET_MAX_FIXES = 16;
+constexpr uint16_t POSITION_SEQUENCE_MASK = 0x0FFF;
+constexpr uint8_t POSITION_BATTERY_MAX = 15;
+
+// Worst case: header + keyframe (8 + 5) + 15 deltas of 5 + 5 + 5 bytes
+constexpr size_t POSITION_PACKET_MAX_SIZE =
+    POSITION_PACKET_HEADER_SIZE + 13 + (POSITION_PACKET_MAX_FIXES - 1) * 15;
+
+/**
+ * @brief Fence state carried in the packet header (2 bits).
+ */
+enum class PacketFenceState : uint8_t {
+    UNKNOWN = 0,  ///< No fence configured or no fix yet
+    INSIDE = 1,   ///< Confirmed inside
+    OUTSIDE = 2,  ///< Confirmed outside
+    ALERT = 3     ///< Outside and escalated
+};
+
+/**
+ * @brief A single position fix in integer microdegrees.
+ */
+struct PositionFix {
+    int32_t latE6;       ///< Latitude in microdegrees
+    int32_t lonE6;       ///< Longitude in microdegrees
+    uint32_t timestamp;  ///< Seconds (collar wake clock)
+};
+
+/**
+ * @brief Decoded form of a position packet.
+ */
+struct PositionPacket {
+    uint16_t sequence;           ///< Rolling sequence number (12 bits on air)
+    PacketFenceState fenceState; ///< Fence state at time of sending
+    uint8_t battery;             ///< Battery level 0..15 (~6.7% per step)
+    uint8_t fixCount;            ///< Number of valid entries in fixes (1..16)
+    PositionFix fixes[POSITION_PACKET_MAX_FIXES];
+};
+
+// ============================================
+// CONVERSION HELPERS
+// ============================================
+
+/**
+ * @brief Convert decimal degrees to rounded integer microdegrees.
+ */
+int32_t degreesToE6(float degrees);
+
+/**
+ * @brief Convert integer microdegrees to decimal degrees.
+ */
+float e6ToDegrees(int32_t e6);
+
+/**
+ * @brief Map a battery percentage (0-100) to the 4-bit level.
+ */
+uint8_t batteryPercentToLevel(uint8_t percent);
+
+// ============================================
+// ENCODE / DECODE
+// ============================================
+
+/**
+ * @brief Encode a packet.
+ *
+ * Timestamps must be non-decreasing across the fixes.
+ *
+ * @param packet   Packet to encode (fixCount 1..POSITION_PACKET_MAX_FIXES).
+ * @param out      Output buffer.
+ * @param capacity Size of the output buffer.
+ * @return Number of bytes written, or 0 if the packet is invalid or the
+ *         buffer is too small.
+ */
+size_t positionPacketEncode(const PositionPacket& packet, uint8_t* out, size_t capacity);
+
+/**
+ * @brief Decode a packet.
+ *
+ * @param data   Received bytes.
+ * @param length Number of received bytes.
+ * @param packet Output packet.
+ * @return true if the packet was well-formed and fully consumed.
+ */
+bool positionPacketDecode(const uint8_t* data, size_t length, PositionPacket& packet);
+
+#endif // POSITION_CODEC_H
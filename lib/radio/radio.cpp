@@ -0,0 +1,194 @@
+/**
+ * @file radio.cpp
+ * @brief Implementation of the queued radio layer and the loopback radio.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "radio.h"
+
+#include <string.h>
+
+// ============================================================================
+// Airtime
+// ============================================================================
+
+uint32_t loraAirtimeUs(const LoraModemConfig& modem, size_t payloadLength) {
+    if (modem.bandwidthKhz == 0 || modem.spreadingFactor < 6 || modem.spreadingFactor > 12) {
+        return 0;
+    }
+
+    int32_t sf = modem.spreadingFactor;
+    uint32_t symbolUs = (1000u << sf) / modem.bandwidthKhz;
+    int32_t lowDataRate = symbolUs > 16000 ? 1 : 0;
+
+    // Payload symbols: 8 + ceil((8PL - 4SF + 28 + 16CRC) / 4(SF - 2DE)) * CR
+    int32_t bits = 8 * static_cast<int32_t>(payloadLength) - 4 * sf + 28 + (modem.crc ? 16 : 0);
+    int32_t perBlock = 4 * (sf - 2 * lowDataRate);
+    int32_t blocks = bits > 0 ? (bits + perBlock - 1) / perBlock : 0;
+    uint32_t payloadSymbols = 8 + static_cast<uint32_t>(blocks) * modem.codingRate;
+
+    // Preamble: n + 4.25 symbols
+    uint32_t preambleQuarterSymbols = 4u * modem.preambleLength + 17;
+
+    return preambleQuarterSymbols * symbolUs / 4 + payloadSymbols * symbolUs;
+}
+
+// ============================================================================
+// Radio
+// ============================================================================
+
+Radio::Radio(const LoraModemConfig& modem, uint32_t (*clockUs)())
+    : _modem(modem), _clockUs(clockUs), _transmitting(false), _listening(false),
+      _txStartUs(0), _txAirtimeUs(0), _queuedAirtimeUs(0),
+      _framesSent(0), _framesReceived(0), _framesDropped(0) {}
+
+bool Radio::send(const uint8_t* data, size_t length) {
+    if (data == nullptr || length == 0 || length > RADIO_MAX_FRAME) {
+        return false;
+    }
+
+    RadioFrame frame;
+    frame.length = static_cast<uint8_t>(length);
+    memcpy(frame.data, data, length);
+    if (!_txQueue.push(frame)) {
+        return false;
+    }
+    _queuedAirtimeUs += loraAirtimeUs(_modem, length);
+
+    if (!_transmitting) {
+        startNext();
+    }
+    return true;
+}
+
+void Radio::poll() {
+    RadioFrame received;
+    uint8_t events = takeEvents(received);
+
+    if (events & RADIO_EVENT_RX_DONE) {
+        if (_rxQueue.push(received)) {
+            _framesReceived++;
+        } else {
+            _framesDropped++;
+        }
+    }
+
+    if ((events & RADIO_EVENT_TX_DONE) && _transmitting) {
+        _transmitting = false;
+        _framesSent++;
+        startNext();
+    }
+}
+
+size_t Radio::receive(uint8_t* out, size_t capacity) {
+    RadioFrame frame;
+    if (out == nullptr || !_rxQueue.pop(frame)) {
+        return 0;
+    }
+    if (frame.length > capacity) {
+        _framesDropped++;
+        return 0;
+    }
+    memcpy(out, frame.data, frame.length);
+    return frame.length;
+}
+
+void Radio::listen(bool enable) {
+    _listening = enable;
+    if (_transmitting) {
+        return;  // Applied when the queue drains
+    }
+    if (enable) {
+        beginReceive();
+    } else {
+        standby();
+    }
+}
+
+bool Radio::isTransmitting() const {
+    return _transmitting;
+}
+
+uint32_t Radio::remainingAirtimeUs() const {
+    if (!_transmitting) {
+        return 0;
+    }
+    uint32_t elapsed = _clockUs() - _txStartUs;
+    uint32_t current = elapsed < _txAirtimeUs ? _txAirtimeUs - elapsed : 0;
+    return current + _queuedAirtimeUs;
+}
+
+void Radio::startNext() {
+    RadioFrame frame;
+    if (!_txQueue.pop(frame)) {
+        if (_listening) {
+            beginReceive();
+        } else {
+            standby();
+        }
+        return;
+    }
+
+    _txAirtimeUs = loraAirtimeUs(_modem, frame.length);
+    _queuedAirtimeUs -= _txAirtimeUs;
+    _txStartUs = _clockUs();
+    _transmitting = true;
+    beginTransmit(frame);
+}
+
+// ============================================================================
+// Loopback Radio
+// ============================================================================
+
+LoopbackRadio::LoopbackRadio(const LoraModemConfig& modem, uint32_t (*clockUs)())
+    : Radio(modem, clockUs), _peer(nullptr), _txActive(false), _txEndUs(0),
+      _rxEnabled(false), _rxPending(false), _linkDown(false) {}
+
+void LoopbackRadio::connect(LoopbackRadio& peer) {
+    _peer = &peer;
+    peer._peer = this;
+}
+
+void LoopbackRadio::beginTransmit(const RadioFrame& frame) {
+    // Half duplex: receiving stops while transmitting
+    _rxEnabled = false;
+    _onAir = frame;
+    _txActive = true;
+    _txEndUs = now() + loraAirtimeUs(_modem, frame.length);
+}
+
+void LoopbackRadio::beginReceive() {
+    _rxEnabled = true;
+}
+
+void LoopbackRadio::standby() {
+    _rxEnabled = false;
+}
+
+uint8_t LoopbackRadio::takeEvents(RadioFrame& received) {
+    uint8_t events = 0;
+
+    if (_txActive && static_cast<int32_t>(now() - _txEndUs) >= 0) {
+        _txActive = false;
+        if (_peer != nullptr && !_linkDown) {
+            _peer->deliver(_onAir);
+        }
+        events |= RADIO_EVENT_TX_DONE;
+    }
+
+    if (_rxPending) {
+        _rxPending = false;
+        received = _rxFrame;
+        events |= RADIO_EVENT_RX_DONE;
+    }
+    return events;
+}
+
+void LoopbackRadio::deliver(const RadioFrame& frame) {
+    // Like the radio's FIFO: an unread frame is overwritten by the next
+    if (_rxEnabled) {
+        _rxFrame = frame;
+        _rxPending = true;
+    }
+}
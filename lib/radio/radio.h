@@ -0,0 +1,225 @@
+/**
+ * @file radio.h
+ * @brief Non-blocking packet radio layer: queued TX that completes
+ *        through the radio's interrupt line, plus an in-process loopback.
+ *
+ * A LoRa frame at SF9/125 kHz is on air for ~100-300 ms; at SF12 well over
+ * a second. A blocking send keeps the CPU spinning at full clock for all
+ * of it. Here send() only queues the frame and starts the transmitter;
+ * the radio signals TX done (and RX done) on its interrupt line (DIO0 on
+ * the RFM95W), and poll() picks up the completion and starts the next
+ * queued frame. In between the caller is free to do other work (put the
+ * GPS in standby, flush logs) or light-sleep for remainingAirtimeUs().
+ *
+ * Radio holds the queues and the TX/RX sequencing; a hardware driver only
+ * implements the protected hooks (start TX, start RX, standby, report
+ * events). LoopbackRadio connects two instances in process, so the
+ * firmware logic and the base-station receive path run in native tests.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef RADIO_H
+#define RADIO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../spsc_queue/spsc_queue.h"
+
+// ============================================
+// CONSTANTS
+// ============================================
+
+constexpr size_t RADIO_MAX_FRAME = 255;         // LoRa payload limit
+constexpr size_t RADIO_TX_QUEUE_DEPTH = 4;
+constexpr size_t RADIO_RX_QUEUE_DEPTH = 4;
+
+// Events reported by a driver's takeEvents()
+constexpr uint8_t RADIO_EVENT_TX_DONE = 0x01;
+constexpr uint8_t RADIO_EVENT_RX_DONE = 0x02;
+
+// ============================================
+// TYPES
+// ============================================
+
+/**
+ * @brief LoRa modem settings (explicit header mode).
+ */
+struct LoraModemConfig {
+    uint8_t spreadingFactor;    ///< 6..12
+    uint16_t bandwidthKhz;      ///< 125, 250 or 500
+    uint8_t codingRate;         ///< Denominator of 4/x: 5..8
+    uint16_t preambleLength;    ///< Symbols (8 is the LoRaWAN default)
+    bool crc;                   ///< Payload CRC on
+};
+
+// SF9, 125 kHz, 4/5: ~100-300 ms on air per position packet
+constexpr LoraModemConfig DEFAULT_LORA_MODEM_CONFIG = {9, 125, 5, 8, true};
+
+/**
+ * @brief A queued or received frame.
+ */
+struct RadioFrame {
+    uint8_t length;
+    uint8_t data[RADIO_MAX_FRAME];
+};
+
+/**
+ * @brief Time on air of one frame (Semtech SX127x formula).
+ *
+ * Low data rate optimization is assumed on when a symbol exceeds 16 ms
+ * (SF11/SF12 at 125 kHz), as the driver configures it.
+ *
+ * @return Airtime in microseconds.
+ */
+uint32_t loraAirtimeUs(const LoraModemConfig& modem, size_t payloadLength);
+
+// ============================================
+// RADIO
+// ============================================
+
+/**
+ * @brief Queued, interrupt-completed packet radio.
+ *
+ * Single-threaded: send(), poll() and receive() are called from one task.
+ * A driver's interrupt handler only records that its line fired; the
+ * radio is serviced in poll().
+ */
+class Radio {
+public:
+    /**
+     * @param modem   Modem settings, used for airtime estimates.
+     * @param clockUs Microsecond clock (wraps; only differences are used).
+     */
+    Radio(const LoraModemConfig& modem, uint32_t (*clockUs)());
+    virtual ~Radio() {}
+
+    /**
+     * @brief Queue a frame; starts transmitting at once if idle.
+     * @return false if the frame is empty, too long, or the queue is full.
+     */
+    bool send(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Service the radio: collect completed TX/RX and start the
+     *        next queued frame. Cheap when nothing happened.
+     */
+    void poll();
+
+    /**
+     * @brief Next received frame, oldest first.
+     * @return Frame length, or 0 if none (or out is too small).
+     */
+    size_t receive(uint8_t* out, size_t capacity);
+
+    /**
+     * @brief Listen for frames whenever no TX is pending (or go to
+     *        standby when disabled).
+     */
+    void listen(bool enable);
+
+    /**
+     * @brief Frames queued or on air.
+     */
+    bool isTransmitting() const;
+
+    /**
+     * @brief Estimated time until every queued frame has been sent.
+     */
+    uint32_t remainingAirtimeUs() const;
+
+    uint32_t framesSent() const { return _framesSent; }
+    uint32_t framesReceived() const { return _framesReceived; }
+    uint32_t framesDropped() const { return _framesDropped; }
+
+protected:
+    /**
+     * @brief Load a frame and start transmitting (must not block).
+     */
+    virtual void beginTransmit(const RadioFrame& frame) = 0;
+
+    /**
+     * @brief Enter continuous receive.
+     */
+    virtual void beginReceive() = 0;
+
+    /**
+     * @brief Stop transmitting/receiving (low-power idle).
+     */
+    virtual void standby() = 0;
+
+    /**
+     * @brief Report events since the last call.
+     *
+     * @param received Filled when RADIO_EVENT_RX_DONE is returned.
+     * @return RADIO_EVENT_* mask.
+     */
+    virtual uint8_t takeEvents(RadioFrame& received) = 0;
+
+    uint32_t now() const { return _clockUs(); }
+
+    const LoraModemConfig _modem;
+
+private:
+    uint32_t (*_clockUs)();
+    SpscQueue<RadioFrame, RADIO_TX_QUEUE_DEPTH> _txQueue;
+    SpscQueue<RadioFrame, RADIO_RX_QUEUE_DEPTH> _rxQueue;
+    bool _transmitting;
+    bool _listening;
+    uint32_t _txStartUs;
+    uint32_t _txAirtimeUs;
+    uint32_t _queuedAirtimeUs;
+    uint32_t _framesSent;
+    uint32_t _framesReceived;
+    uint32_t _framesDropped;
+
+    void startNext();
+};
+
+// ============================================
+// LOOPBACK RADIO
+// ============================================
+
+/**
+ * @brief In-process radio for native tests.
+ *
+ * A frame is on air for its computed airtime on the shared clock; once
+ * the sender's poll() sees it complete, it is delivered to the connected
+ * peer if that peer is listening (otherwise it is lost, as on air).
+ */
+class LoopbackRadio : public Radio {
+public:
+    LoopbackRadio(const LoraModemConfig& modem, uint32_t (*clockUs)());
+
+    /**
+     * @brief Link two radios both ways.
+     */
+    void connect(LoopbackRadio& peer);
+
+    /**
+     * @brief Drop every frame this radio sends from now on (out of range).
+     */
+    void setLinkDown(bool down) { _linkDown = down; }
+
+    bool isListening() const { return _rxEnabled; }
+
+protected:
+    void beginTransmit(const RadioFrame& frame) override;
+    void beginReceive() override;
+    void standby() override;
+    uint8_t takeEvents(RadioFrame& received) override;
+
+private:
+    LoopbackRadio* _peer;
+    RadioFrame _onAir;
+    bool _txActive;
+    uint32_t _txEndUs;
+    bool _rxEnabled;
+    bool _rxPending;
+    RadioFrame _rxFrame;
+    bool _linkDown;
+
+    void deliver(const RadioFrame& frame);
+};
+
+#endif // RADIO_H
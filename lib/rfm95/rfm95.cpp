@@ -0,0 +1,261 @@
+/**
+ * @file rfm95.cpp
+ * @brief Implementation of the minimal RFM95W (SX1276) LoRa driver.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "rfm95.h"
+
+// ============================================================================
+// Register Map (LoRa mode subset)
+// ============================================================================
+
+constexpr uint8_t REG_FIFO = 0x00;
+constexpr uint8_t REG_OP_MODE = 0x01;
+constexpr uint8_t REG_FRF_MSB = 0x06;
+constexpr uint8_t REG_FRF_MID = 0x07;
+constexpr uint8_t REG_FRF_LSB = 0x08;
+constexpr uint8_t REG_PA_CONFIG = 0x09;
+constexpr uint8_t REG_OCP = 0x0B;
+constexpr uint8_t REG_LNA = 0x0C;
+constexpr uint8_t REG_FIFO_ADDR_PTR = 0x0D;
+constexpr uint8_t REG_FIFO_TX_BASE_ADDR = 0x0E;
+constexpr uint8_t REG_FIFO_RX_BASE_ADDR = 0x0F;
+constexpr uint8_t REG_FIFO_RX_CURRENT_ADDR = 0x10;
+constexpr uint8_t REG_IRQ_FLAGS = 0x12;
+constexpr uint8_t REG_RX_NB_BYTES = 0x13;
+constexpr uint8_t REG_MODEM_CONFIG_1 = 0x1D;
+constexpr uint8_t REG_MODEM_CONFIG_2 = 0x1E;
+constexpr uint8_t REG_PREAMBLE_MSB = 0x20;
+constexpr uint8_t REG_PREAMBLE_LSB = 0x21;
+constexpr uint8_t REG_PAYLOAD_LENGTH = 0x22;
+constexpr uint8_t REG_MODEM_CONFIG_3 = 0x26;
+constexpr uint8_t REG_SYNC_WORD = 0x39;
+constexpr uint8_t REG_DIO_MAPPING_1 = 0x40;
+constexpr uint8_t REG_VERSION = 0x42;
+
+constexpr uint8_t VERSION_SX1276 = 0x12;
+
+constexpr uint8_t MODE_LONG_RANGE = 0x80;
+constexpr uint8_t MODE_SLEEP = 0x00;
+constexpr uint8_t MODE_STDBY = 0x01;
+constexpr uint8_t MODE_TX = 0x03;
+constexpr uint8_t MODE_RX_CONTINUOUS = 0x05;
+
+constexpr uint8_t IRQ_RX_DONE = 0x40;
+constexpr uint8_t IRQ_PAYLOAD_CRC_ERROR = 0x20;
+constexpr uint8_t IRQ_TX_DONE = 0x08;
+constexpr uint8_t IRQ_ALL = 0xFF;
+
+constexpr uint8_t DIO0_RX_DONE = 0x00;
+constexpr uint8_t DIO0_TX_DONE = 0x40;
+
+constexpr uint8_t PA_BOOST = 0x80;
+constexpr uint8_t OCP_100MA = 0x2B;
+constexpr uint8_t LNA_BOOST_HF = 0x03;
+constexpr uint8_t MODEM_CONFIG_2_CRC_ON = 0x04;
+constexpr uint8_t MODEM_CONFIG_3_AGC_AUTO = 0x04;
+constexpr uint8_t MODEM_CONFIG_3_LOW_DATA_RATE = 0x08;
+constexpr uint8_t SYNC_WORD_PRIVATE = 0x12;
+
+constexpr uint8_t SPI_WRITE = 0x80;
+constexpr uint32_t SPI_CLOCK_HZ = 8000000;
+
+// SX1276 crystal: Frf = frequency * 2^19 / 32 MHz
+constexpr uint64_t FXOSC_HZ = 32000000;
+
+// ============================================================================
+// Interrupt
+// ============================================================================
+
+volatile bool Rfm95::_dio0Fired = false;
+
+void IRAM_ATTR Rfm95::onDio0() {
+    _dio0Fired = true;
+}
+
+// ============================================================================
+// Constructor
+// ============================================================================
+
+Rfm95::Rfm95(SPIClass& spi, int8_t csPin, int8_t resetPin, int8_t dio0Pin,
+             const LoraModemConfig& modem, uint32_t (*clockUs)())
+    : Radio(modem, clockUs)
+    , _spi(spi)
+    , _csPin(csPin)
+    , _resetPin(resetPin)
+    , _dio0Pin(dio0Pin) {
+}
+
+// ============================================================================
+// Public Methods
+// ============================================================================
+
+bool Rfm95::begin(uint32_t frequencyHz, int8_t txPowerDbm) {
+    pinMode(_csPin, OUTPUT);
+    digitalWrite(_csPin, HIGH);
+
+    if (_resetPin >= 0) {
+        pinMode(_resetPin, OUTPUT);
+        digitalWrite(_resetPin, LOW);
+        delayMicroseconds(200);
+        digitalWrite(_resetPin, HIGH);
+        delay(5);
+    }
+
+    if (readRegister(REG_VERSION) != VERSION_SX1276) {
+        return false;
+    }
+
+    // LoRa mode can only be selected in sleep
+    setMode(MODE_SLEEP);
+
+    uint64_t frf = (static_cast<uint64_t>(frequencyHz) << 19) / FXOSC_HZ;
+    writeRegister(REG_FRF_MSB, static_cast<uint8_t>(frf >> 16));
+    writeRegister(REG_FRF_MID, static_cast<uint8_t>(frf >> 8));
+    writeRegister(REG_FRF_LSB, static_cast<uint8_t>(frf));
+
+    // The whole 256-byte FIFO for one frame in either direction
+    writeRegister(REG_FIFO_TX_BASE_ADDR, 0);
+    writeRegister(REG_FIFO_RX_BASE_ADDR, 0);
+
+    uint8_t bandwidth;
+    switch (_modem.bandwidthKhz) {
+        case 250:
+            bandwidth = 8;
+            break;
+        case 500:
+            bandwidth = 9;
+            break;
+        default:
+            bandwidth = 7;  // 125 kHz
+            break;
+    }
+    uint8_t codingRate = _modem.codingRate >= 5 && _modem.codingRate <= 8 ? _modem.codingRate - 4 : 1;
+    bool lowDataRate = ((1000u << _modem.spreadingFactor) / _modem.bandwidthKhz) > 16000;
+
+    writeRegister(REG_MODEM_CONFIG_1, (bandwidth << 4) | (codingRate << 1));
+    writeRegister(REG_MODEM_CONFIG_2, (_modem.spreadingFactor << 4) |
+                                      (_modem.crc ? MODEM_CONFIG_2_CRC_ON : 0));
+    writeRegister(REG_MODEM_CONFIG_3, MODEM_CONFIG_3_AGC_AUTO |
+                                      (lowDataRate ? MODEM_CONFIG_3_LOW_DATA_RATE : 0));
+    writeRegister(REG_PREAMBLE_MSB, static_cast<uint8_t>(_modem.preambleLength >> 8));
+    writeRegister(REG_PREAMBLE_LSB, static_cast<uint8_t>(_modem.preambleLength));
+    writeRegister(REG_SYNC_WORD, SYNC_WORD_PRIVATE);
+    writeRegister(REG_LNA, readRegister(REG_LNA) | LNA_BOOST_HF);
+
+    if (txPowerDbm < 2) {
+        txPowerDbm = 2;
+    } else if (txPowerDbm > 17) {
+        txPowerDbm = 17;
+    }
+    writeRegister(REG_PA_CONFIG, PA_BOOST | static_cast<uint8_t>(txPowerDbm - 2));
+    writeRegister(REG_OCP, OCP_100MA);
+
+    writeRegister(REG_IRQ_FLAGS, IRQ_ALL);
+    _dio0Fired = false;
+    pinMode(_dio0Pin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(_dio0Pin), onDio0, RISING);
+
+    return true;
+}
+
+// ============================================================================
+// Radio Hooks
+// ============================================================================
+
+void Rfm95::beginTransmit(const RadioFrame& frame) {
+    setMode(MODE_STDBY);
+    writeRegister(REG_DIO_MAPPING_1, DIO0_TX_DONE);
+    writeRegister(REG_FIFO_ADDR_PTR, 0);
+    writeFifo(frame.data, frame.length);
+    writeRegister(REG_PAYLOAD_LENGTH, frame.length);
+    setMode(MODE_TX);
+}
+
+void Rfm95::beginReceive() {
+    setMode(MODE_STDBY);
+    writeRegister(REG_DIO_MAPPING_1, DIO0_RX_DONE);
+    writeRegister(REG_FIFO_ADDR_PTR, 0);
+    setMode(MODE_RX_CONTINUOUS);
+}
+
+void Rfm95::standby() {
+    // Sleep rather than standby: ~1 uA, registers are kept
+    setMode(MODE_SLEEP);
+}
+
+uint8_t Rfm95::takeEvents(RadioFrame& received) {
+    // DIO0 stays high until the flags are cleared, which also covers an
+    // edge missed while interrupts were off (e.g. during light sleep)
+    if (!_dio0Fired && digitalRead(_dio0Pin) != HIGH) {
+        return 0;
+    }
+    _dio0Fired = false;
+
+    uint8_t flags = readRegister(REG_IRQ_FLAGS);
+    writeRegister(REG_IRQ_FLAGS, IRQ_ALL);
+
+    uint8_t events = 0;
+    if (flags & IRQ_TX_DONE) {
+        events |= RADIO_EVENT_TX_DONE;
+    }
+    if ((flags & IRQ_RX_DONE) && !(flags & IRQ_PAYLOAD_CRC_ERROR)) {
+        uint8_t length = readRegister(REG_RX_NB_BYTES);
+        writeRegister(REG_FIFO_ADDR_PTR, readRegister(REG_FIFO_RX_CURRENT_ADDR));
+        readFifo(received.data, length);
+        received.length = length;
+        events |= RADIO_EVENT_RX_DONE;
+    }
+    return events;
+}
+
+// ============================================================================
+// Private Methods
+// ============================================================================
+
+void Rfm95::setMode(uint8_t mode) {
+    writeRegister(REG_OP_MODE, MODE_LONG_RANGE | mode);
+}
+
+uint8_t Rfm95::readRegister(uint8_t reg) {
+    _spi.beginTransaction(SPISettings(SPI_CLOCK_HZ, MSBFIRST, SPI_MODE0));
+    digitalWrite(_csPin, LOW);
+    _spi.transfer(reg & ~SPI_WRITE);
+    uint8_t value = _spi.transfer(0x00);
+    digitalWrite(_csPin, HIGH);
+    _spi.endTransaction();
+    return value;
+}
+
+void Rfm95::writeRegister(uint8_t reg, uint8_t value) {
+    _spi.beginTransaction(SPISettings(SPI_CLOCK_HZ, MSBFIRST, SPI_MODE0));
+    digitalWrite(_csPin, LOW);
+    _spi.transfer(reg | SPI_WRITE);
+    _spi.transfer(value);
+    digitalWrite(_csPin, HIGH);
+    _spi.endTransaction();
+}
+
+void Rfm95::readFifo(uint8_t* data, size_t len) {
+    _spi.beginTransaction(SPISettings(SPI_CLOCK_HZ, MSBFIRST, SPI_MODE0));
+    digitalWrite(_csPin, LOW);
+    _spi.transfer(REG_FIFO);
+    for (size_t i = 0; i < len; i++) {
+        data[i] = _spi.transfer(0x00);
+    }
+    digitalWrite(_csPin, HIGH);
+    _spi.endTransaction();
+}
+
+void Rfm95::writeFifo(const uint8_t* data, size_t len) {
+    _spi.beginTransaction(SPISettings(SPI_CLOCK_HZ, MSBFIRST, SPI_MODE0));
+    digitalWrite(_csPin, LOW);
+    _spi.transfer(REG_FIFO | SPI_WRITE);
+    for (size_t i = 0; i < len; i++) {
+        _spi.transfer(data[i]);
+    }
+    digitalWrite(_csPin, HIGH);
+    _spi.endTransaction();
+}
@@ -0,0 +1,74 @@
+/**
+ * @file rfm95.h
+ * @brief Minimal RFM95W (SX1276) LoRa driver for the non-blocking Radio layer.
+ *
+ * Only what the collar needs: LoRa mode in explicit header mode, one
+ * frame in the FIFO at a time, and DIO0 as the TX done / RX done
+ * interrupt. The interrupt handler only records that DIO0 fired; the
+ * registers are read in Radio::poll(), outside interrupt context.
+ *
+ * Requires the Arduino framework (SPI).
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef RFM95_H
+#define RFM95_H
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "../radio/radio.h"
+
+/**
+ * @brief RFM95W transceiver on SPI with DIO0 as its interrupt line.
+ *
+ * Only one instance is supported (the interrupt flag is shared).
+ */
+class Rfm95 : public Radio {
+public:
+    /**
+     * @brief Construct a driver instance.
+     *
+     * @param spi      SPI bus (begun by the caller).
+     * @param csPin    Chip select.
+     * @param resetPin Reset line, or -1 if not connected.
+     * @param dio0Pin  DIO0 (TX done / RX done).
+     * @param modem    LoRa modem settings.
+     * @param clockUs  Microsecond clock for airtime tracking.
+     */
+    Rfm95(SPIClass& spi, int8_t csPin, int8_t resetPin, int8_t dio0Pin,
+          const LoraModemConfig& modem, uint32_t (*clockUs)());
+
+    /**
+     * @brief Reset and probe the radio, apply the modem settings and
+     *        leave it asleep.
+     *
+     * @param frequencyHz Carrier frequency (915 MHz band for the RFM95W).
+     * @param txPowerDbm  PA_BOOST output power, 2..17 dBm.
+     * @return true if an SX1276 responded.
+     */
+    bool begin(uint32_t frequencyHz, int8_t txPowerDbm);
+
+protected:
+    void beginTransmit(const RadioFrame& frame) override;
+    void beginReceive() override;
+    void standby() override;
+    uint8_t takeEvents(RadioFrame& received) override;
+
+private:
+    SPIClass& _spi;
+    int8_t _csPin;
+    int8_t _resetPin;
+    int8_t _dio0Pin;
+
+    static volatile bool _dio0Fired;
+    static void IRAM_ATTR onDio0();
+
+    void setMode(uint8_t mode);
+    uint8_t readRegister(uint8_t reg);
+    void writeRegister(uint8_t reg, uint8_t value);
+    void readFifo(uint8_t* data, size_t len);
+    void writeFifo(const uint8_t* data, size_t len);
+};
+
+#endif // RFM95_H
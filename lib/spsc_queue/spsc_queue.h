@@ -0,0 +1,115 @@
+/**
+ * @file spsc_queue.h
+ * @brief Lock-free single-producer, single-consumer ring for passing
+ *        items between two tasks (or two cores).
+ *
+ * One task only pushes, one task only pops; neither ever blocks or
+ * disables interrupts. Head and tail are free-running counters published
+ * with release/acquire ordering, so an item is fully written before the
+ * consumer can see it. Each side keeps a private copy of the other side's
+ * counter and only re-reads the shared one when the ring looks full
+ * (producer) or empty (consumer), which keeps cross-core cache traffic to
+ * a minimum.
+ *
+ * Items are copied in and out, so T should be small and trivially
+ * copyable (a parsed GPS fix, a radio frame descriptor). Waiting for data
+ * is left to the caller (e.g. a FreeRTOS task notification).
+ *
+ * Header-only and portable: used by the firmware's GPS pipeline and
+ * stress-tested natively with std::thread.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// Producer and consumer counters on separate cache lines (32 bytes on
+// the ESP32-S3, 64 on most hosts)
+constexpr size_t SPSC_CACHE_LINE = 64;
+
+/**
+ * @brief Bounded lock-free SPSC queue.
+ *
+ * @tparam T        Item type (trivially copyable).
+ * @tparam Capacity Number of slots (power of two); all slots are usable.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : _head(0), _tailCache(0), _tail(0), _headCache(0) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Append an item (producer only).
+     * @return false if the queue is full; the item is not stored.
+     */
+    bool push(const T& item) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tailCache >= Capacity) {
+            _tailCache = _tail.load(std::memory_order_acquire);
+            if (head - _tailCache >= Capacity) {
+                return false;
+            }
+        }
+        _slots[head & (Capacity - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest item (consumer only).
+     * @return false if the queue is empty; item is left unchanged.
+     */
+    bool pop(T& item) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _headCache) {
+            _headCache = _head.load(std::memory_order_acquire);
+            if (tail == _headCache) {
+                return false;
+            }
+        }
+        item = _slots[tail & (Capacity - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Number of queued items. Exact when called from either end
+     *        while the other is idle, a snapshot otherwise.
+     */
+    size_t size() const {
+        size_t tail = _tail.load(std::memory_order_acquire);
+        return _head.load(std::memory_order_acquire) - tail;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+
+private:
+    // Producer side
+    alignas(SPSC_CACHE_LINE) std::atomic<size_t> _head;   ///< Items ever pushed
+    size_t _tailCache;                                    ///< Last tail seen by the producer
+
+    // Consumer side
+    alignas(SPSC_CACHE_LINE) std::atomic<size_t> _tail;   ///< Items ever popped
+    size_t _headCache;                                    ///< Last head seen by the consumer
+
+    alignas(SPSC_CACHE_LINE) T _slots[Capacity];
+};
+
+#endif // SPSC_QUEUE_H
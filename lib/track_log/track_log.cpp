@@ -0,0 +1,530 @@
+/**
+ * @file track_log.cpp
+ * @brief Implementation of the flash-backed track log.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "track_log.h"
+#include "../checksum/checksum.h"
+
+#include <string.h>
+
+#ifndef ESP_PLATFORM
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// Record Helpers
+// ============================================================================
+
+static const uint32_t ERASED_WORD = 0xFFFFFFFF;
+static const size_t RECORD_SIZE = sizeof(TrackRecord);
+
+/**
+ * @brief CRC-8 over the 24-bit sequence number and the record payload.
+ */
+static uint8_t recordCrc(const TrackRecord& record, uint32_t seq) {
+    uint8_t seqBytes[3] = {
+        static_cast<uint8_t>(seq >> 16),
+        static_cast<uint8_t>(seq >> 8),
+        static_cast<uint8_t>(seq)
+    };
+    uint8_t crc = crc8(seqBytes, sizeof(seqBytes));
+    return crc8(&record.timestamp, RECORD_SIZE - sizeof(record.seqCrc), crc);
+}
+
+static TrackRecord makeRecord(uint32_t seq, uint32_t timestamp, int32_t latE6, int32_t lonE6) {
+    TrackRecord record;
+    record.timestamp = timestamp;
+    record.latE6 = latE6;
+    record.lonE6 = lonE6;
+    record.seqCrc = (seq << 8) | recordCrc(record, seq);
+    return record;
+}
+
+static bool isMarker(const TrackRecord& record) {
+    return record.latE6 == TRACK_LOG_ACK_MARKER;
+}
+
+// ============================================================================
+// TrackLog Class Implementation
+// ============================================================================
+
+TrackLog::TrackLog(TrackLogStorage& storage, TrackLogState& state)
+    : _storage(storage)
+    , _state(state)
+{
+}
+
+bool TrackLog::begin() {
+    size_t size = _storage.size();
+    if (size < 2 * TRACK_LOG_SECTOR_SIZE) {
+        return false;
+    }
+
+    // RTC state survives deep sleep; only rescan flash after a cold boot
+    // or if the state does not describe this storage.
+    if (_state.magic == TRACK_LOG_STATE_MAGIC &&
+        _state.writeOffset < size && _state.cursorOffset < size &&
+        _state.stagedCount <= TRACK_LOG_STAGING_RECORDS &&
+        _state.nextSeq > 0 && _state.nextSeq <= TRACK_LOG_SEQ_MAX + 1) {
+        return true;
+    }
+
+    return recover();
+}
+
+bool TrackLog::recover() {
+    size_t size = _storage.size();
+
+    bool found = false;
+    uint32_t maxSeq = 0;
+    size_t maxOffset = 0;
+    uint32_t maxAck = 0;
+
+    // Pass 1: find the newest record and the newest acknowledgement
+    TrackRecord record;
+    uint32_t seq;
+    for (size_t offset = 0; offset < size; offset += RECORD_SIZE) {
+        if (!readRecord(offset, record, seq)) {
+            continue;
+        }
+        if (!found || seq > maxSeq) {
+            found = true;
+            maxSeq = seq;
+            maxOffset = offset;
+        }
+        if (isMarker(record) && static_cast<uint32_t>(record.lonE6) > maxAck) {
+            maxAck = static_cast<uint32_t>(record.lonE6);
+        }
+    }
+
+    _state.stagedCount = 0;
+    _state.ackedSeq = maxAck;
+
+    if (!found) {
+        _state.nextSeq = 1;
+        _state.writeOffset = 0;
+        _state.cursorOffset = 0;
+        _state.pendingFixes = 0;
+        _state.magic = TRACK_LOG_STATE_MAGIC;
+        return true;
+    }
+
+    _state.nextSeq = maxSeq + 1;
+
+    // Resume after the newest record, skipping any torn (non-erased) slots
+    size_t offset = nextOffset(maxOffset);
+    while (offset % TRACK_LOG_SECTOR_SIZE != 0) {
+        uint32_t word;
+        if (!_storage.read(offset, &word, sizeof(word))) {
+            return false;
+        }
+        if (word == ERASED_WORD) {
+            break;
+        }
+        offset = nextOffset(offset);
+    }
+    _state.writeOffset = static_cast<uint32_t>(offset);
+
+    // Pass 2: locate the oldest unacknowledged fix and count pending fixes
+    bool pendingFound = false;
+    uint32_t minPendingSeq = 0;
+    _state.pendingFixes = 0;
+    _state.cursorOffset = _state.writeOffset;
+    for (size_t scan = 0; scan < size; scan += RECORD_SIZE) {
+        if (!readRecord(scan, record, seq) || isMarker(record) || seq <= maxAck) {
+            continue;
+        }
+        _state.pendingFixes++;
+        if (!pendingFound || seq < minPendingSeq) {
+            pendingFound = true;
+            minPendingSeq = seq;
+            _state.cursorOffset = static_cast<uint32_t>(scan);
+        }
+    }
+
+    _state.magic = TRACK_LOG_STATE_MAGIC;
+    return true;
+}
+
+bool TrackLog::format() {
+    size_t size = _storage.size();
+    for (size_t offset = 0; offset < size; offset += TRACK_LOG_SECTOR_SIZE) {
+        if (!_storage.eraseSector(offset)) {
+            return false;
+        }
+    }
+
+    _state.nextSeq = 1;
+    _state.ackedSeq = 0;
+    _state.writeOffset = 0;
+    _state.cursorOffset = 0;
+    _state.pendingFixes = 0;
+    _state.stagedCount = 0;
+    _state.magic = TRACK_LOG_STATE_MAGIC;
+    return true;
+}
+
+bool TrackLog::append(const PositionFix& fix) {
+    // 24-bit sequence space exhausted (years of fixes): start over
+    if (_state.nextSeq > TRACK_LOG_SEQ_MAX && !format()) {
+        return false;
+    }
+
+    TrackRecord record = makeRecord(_state.nextSeq, fix.timestamp, fix.latE6, fix.lonE6);
+    _state.nextSeq++;
+    _state.pendingFixes++;
+    return stage(record);
+}
+
+bool TrackLog::acknowledge(uint32_t seq) {
+    if (seq >= _state.nextSeq) {
+        seq = _state.nextSeq - 1;
+    }
+    if (seq <= _state.ackedSeq) {
+        return true;
+    }
+    if (_state.nextSeq > TRACK_LOG_SEQ_MAX) {
+        return format();
+    }
+
+    uint32_t oldAcked = _state.ackedSeq;
+    _state.ackedSeq = seq;
+
+    // Newly acknowledged fixes still in staging no longer count as pending
+    for (uint8_t i = 0; i < _state.stagedCount; i++) {
+        const TrackRecord& staged = _state.staged[i];
+        uint32_t stagedSeq = staged.seqCrc >> 8;
+        if (!isMarker(staged) && stagedSeq > oldAcked && stagedSeq <= seq) {
+            _state.pendingFixes--;
+        }
+    }
+
+    advanceCursor(oldAcked);
+
+    TrackRecord marker = makeRecord(_state.nextSeq, 0, TRACK_LOG_ACK_MARKER, static_cast<int32_t>(seq));
+    _state.nextSeq++;
+    return stage(marker);
+}
+
+bool TrackLog::stage(const TrackRecord& record) {
+    if (_state.stagedCount >= TRACK_LOG_STAGING_RECORDS && !flush()) {
+        return false;
+    }
+
+    _state.staged[_state.stagedCount++] = record;
+
+    // A full page is written in one go
+    if (_state.stagedCount >= TRACK_LOG_STAGING_RECORDS) {
+        return flush();
+    }
+    return true;
+}
+
+bool TrackLog::flush() {
+    size_t size = _storage.size();
+    uint8_t written = 0;
+
+    while (written < _state.stagedCount) {
+        size_t offset = _state.writeOffset;
+
+        // Entering a sector: it holds the oldest data in the ring. Drop it.
+        if (offset % TRACK_LOG_SECTOR_SIZE == 0) {
+            TrackRecord record;
+            uint32_t seq;
+            uint32_t dropped = 0;
+            for (size_t scan = offset; scan < offset + TRACK_LOG_SECTOR_SIZE; scan += RECORD_SIZE) {
+                if (readRecord(scan, record, seq) && !isMarker(record) && seq > _state.ackedSeq) {
+                    dropped++;
+                }
+            }
+
+            if (!_storage.eraseSector(offset)) {
+                return false;
+            }
+
+            // Unacknowledged fixes in this sector are gone; the next oldest
+            // ones start at the following sector.
+            if (dropped > 0) {
+                _state.pendingFixes = _state.pendingFixes > dropped ? _state.pendingFixes - dropped : 0;
+                if (_state.cursorOffset / TRACK_LOG_SECTOR_SIZE == offset / TRACK_LOG_SECTOR_SIZE) {
+                    _state.cursorOffset = static_cast<uint32_t>((offset + TRACK_LOG_SECTOR_SIZE) % size);
+                }
+            }
+        }
+
+        // Write as many records as fit before the sector boundary
+        size_t slotsLeft = (TRACK_LOG_SECTOR_SIZE - offset % TRACK_LOG_SECTOR_SIZE) / RECORD_SIZE;
+        size_t count = _state.stagedCount - written;
+        if (count > slotsLeft) {
+            count = slotsLeft;
+        }
+
+        if (!_storage.write(offset, &_state.staged[written], count * RECORD_SIZE)) {
+            // Keep the unwritten records staged so a later flush can retry
+            memmove(&_state.staged[0], &_state.staged[written],
+                    (_state.stagedCount - written) * RECORD_SIZE);
+            _state.stagedCount -= written;
+            return false;
+        }
+
+        written += static_cast<uint8_t>(count);
+        _state.writeOffset = static_cast<uint32_t>((offset + count * RECORD_SIZE) % size);
+    }
+
+    _state.stagedCount = 0;
+    return true;
+}
+
+size_t TrackLog::readPending(TrackEntry* out, size_t max) {
+    size_t count = 0;
+    if (out == nullptr) {
+        return 0;
+    }
+
+    // Flash: from the cursor up to the write offset, in ring order
+    TrackRecord record;
+    uint32_t seq;
+    size_t offset = _state.cursorOffset;
+    while (offset != _state.writeOffset && count < max) {
+        if (readRecord(offset, record, seq) && !isMarker(record) && seq > _state.ackedSeq) {
+            out[count].seq = seq;
+            out[count].fix.latE6 = record.latE6;
+            out[count].fix.lonE6 = record.lonE6;
+            out[count].fix.timestamp = record.timestamp;
+            count++;
+        }
+        offset = nextOffset(offset);
+    }
+
+    // Staging: newest fixes, not yet flushed
+    for (uint8_t i = 0; i < _state.stagedCount && count < max; i++) {
+        const TrackRecord& staged = _state.staged[i];
+        seq = staged.seqCrc >> 8;
+        if (!isMarker(staged) && seq > _state.ackedSeq) {
+            out[count].seq = seq;
+            out[count].fix.latE6 = staged.latE6;
+            out[count].fix.lonE6 = staged.lonE6;
+            out[count].fix.timestamp = staged.timestamp;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+uint32_t TrackLog::pendingCount() const {
+    return _state.pendingFixes;
+}
+
+uint32_t TrackLog::nextSeq() const {
+    return _state.nextSeq;
+}
+
+uint32_t TrackLog::ackedSeq() const {
+    return _state.ackedSeq;
+}
+
+uint8_t TrackLog::stagedCount() const {
+    return _state.stagedCount;
+}
+
+// ============================================================================
+// Private Helpers
+// ============================================================================
+
+bool TrackLog::readRecord(size_t offset, TrackRecord& record, uint32_t& seq) {
+    if (!_storage.read(offset, &record, RECORD_SIZE) || record.seqCrc == ERASED_WORD) {
+        return false;
+    }
+
+    seq = record.seqCrc >> 8;
+    return seq != 0 && (record.seqCrc & 0xFF) == recordCrc(record, seq);
+}
+
+size_t TrackLog::nextOffset(size_t offset) const {
+    offset += RECORD_SIZE;
+    return offset >= _storage.size() ? 0 : offset;
+}
+
+void TrackLog::advanceCursor(uint32_t oldAcked) {
+    TrackRecord record;
+    uint32_t seq;
+    size_t offset = _state.cursorOffset;
+
+    // Skip past everything acknowledged; stop at the first pending fix
+    while (offset != _state.writeOffset) {
+        if (readRecord(offset, record, seq) && !isMarker(record)) {
+            if (seq > _state.ackedSeq) {
+                break;
+            }
+            if (seq > oldAcked && _state.pendingFixes > 0) {
+                _state.pendingFixes--;
+            }
+        }
+        offset = nextOffset(offset);
+    }
+
+    _state.cursorOffset = static_cast<uint32_t>(offset);
+}
+
+// ============================================================================
+// ESP32 Storage Backend (esp_partition)
+// ============================================================================
+
+#ifdef ESP_PLATFORM
+
+TrackLogStorage::TrackLogStorage()
+    : _size(0)
+    , _partition(nullptr)
+{
+}
+
+TrackLogStorage::~TrackLogStorage() {
+    end();
+}
+
+bool TrackLogStorage::begin(const char* location, size_t size) {
+    (void)size;  // Partition size is authoritative on the device
+    if (location == nullptr) {
+        return false;
+    }
+
+    _partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                          ESP_PARTITION_SUBTYPE_ANY, location);
+    if (_partition == nullptr) {
+        return false;
+    }
+
+    _size = _partition->size - (_partition->size % TRACK_LOG_SECTOR_SIZE);
+    return true;
+}
+
+void TrackLogStorage::end() {
+    _partition = nullptr;
+    _size = 0;
+}
+
+bool TrackLogStorage::read(size_t offset, void* data, size_t len) {
+    return _partition != nullptr && offset + len <= _size &&
+           esp_partition_read(_partition, offset, data, len) == ESP_OK;
+}
+
+bool TrackLogStorage::write(size_t offset, const void* data, size_t len) {
+    return _partition != nullptr && offset + len <= _size &&
+           esp_partition_write(_partition, offset, data, len) == ESP_OK;
+}
+
+bool TrackLogStorage::eraseSector(size_t offset) {
+    return _partition != nullptr && offset + TRACK_LOG_SECTOR_SIZE <= _size &&
+           esp_partition_erase_range(_partition, offset, TRACK_LOG_SECTOR_SIZE) == ESP_OK;
+}
+
+// ============================================================================
+// Native Storage Backend (file with NOR flash semantics)
+// ============================================================================
+
+#else
+
+TrackLogStorage::TrackLogStorage()
+    : _size(0)
+    , _fd(-1)
+{
+}
+
+TrackLogStorage::~TrackLogStorage() {
+    end();
+}
+
+bool TrackLogStorage::begin(const char* location, size_t size) {
+    end();
+    if (location == nullptr) {
+        return false;
+    }
+
+    _fd = open(location, O_RDWR | O_CREAT, 0644);
+    if (_fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(_fd, &st) != 0) {
+        end();
+        return false;
+    }
+
+    if (st.st_size > 0) {
+        // Existing file: its size wins (simulates re-opening the same flash)
+        _size = static_cast<size_t>(st.st_size);
+    } else {
+        // New file: starts fully erased, like fresh flash
+        if (size == 0 || size % TRACK_LOG_SECTOR_SIZE != 0) {
+            end();
+            return false;
+        }
+        _size = size;
+        for (size_t offset = 0; offset < _size; offset += TRACK_LOG_SECTOR_SIZE) {
+            if (!eraseSector(offset)) {
+                end();
+                return false;
+            }
+        }
+    }
+
+    return _size % TRACK_LOG_SECTOR_SIZE == 0;
+}
+
+void TrackLogStorage::end() {
+    if (_fd >= 0) {
+        close(_fd);
+    }
+    _fd = -1;
+    _size = 0;
+}
+
+bool TrackLogStorage::read(size_t offset, void* data, size_t len) {
+    if (_fd < 0 || offset + len > _size) {
+        return false;
+    }
+    return pread(_fd, data, len, static_cast<off_t>(offset)) == static_cast<ssize_t>(len);
+}
+
+bool TrackLogStorage::write(size_t offset, const void* data, size_t len) {
+    if (_fd < 0 || offset + len > _size || len > TRACK_LOG_SECTOR_SIZE) {
+        return false;
+    }
+
+    // NOR flash can only clear bits: AND the new data into what is there
+    uint8_t buffer[TRACK_LOG_SECTOR_SIZE];
+    if (!read(offset, buffer, len)) {
+        return false;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < len; i++) {
+        buffer[i] &= bytes[i];
+    }
+
+    return pwrite(_fd, buffer, len, static_cast<off_t>(offset)) == static_cast<ssize_t>(len);
+}
+
+bool TrackLogStorage::eraseSector(size_t offset) {
+    if (_fd < 0 || offset % TRACK_LOG_SECTOR_SIZE != 0 ||
+        offset + TRACK_LOG_SECTOR_SIZE > _size) {
+        return false;
+    }
+
+    uint8_t erased[TRACK_LOG_SECTOR_SIZE];
+    memset(erased, 0xFF, sizeof(erased));
+    return pwrite(_fd, erased, sizeof(erased), static_cast<off_t>(offset)) ==
+           static_cast<ssize_t>(sizeof(erased));
+}
+
+#endif
+
+size_t TrackLogStorage::size() const {
+    return _size;
+}
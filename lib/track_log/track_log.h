@@ -0,0 +1,235 @@
+/**
+ * @file track_log.h
+ * @brief Append-only, power-loss-safe track log in a flash ring.
+ *
+ * Every fix is recorded cheaply into an RTC-memory staging buffer, which is
+ * flushed to flash in page-sized batches. The flash area is used as a ring
+ * of erase sectors: when the writer reaches a sector it erases it, dropping
+ * the oldest fixes. A cursor tracks which fixes the base station has
+ * acknowledged, so they can be radioed in batches instead of one uplink per
+ * wake.
+ *
+ * Power-loss safety: each 16-byte record carries a sequence number and a
+ * CRC-8. After a cold boot (RTC state lost) the log is recovered by scanning
+ * flash; torn or partially written records fail their CRC and are skipped.
+ *
+ * Backends:
+ * - ESP32: raw data partition accessed through esp_partition_*().
+ * - Native: regular file with NOR flash semantics (used by unit tests).
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef TRACK_LOG_H
+#define TRACK_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../position_codec/position_codec.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_partition.h>
+#endif
+
+// ============================================
+// CONSTANTS
+// ============================================
+
+// Partition label (ESP32) used by the collar firmware
+constexpr char TRACK_LOG_PARTITION_LABEL[] = "tracklog";
+
+// Flash geometry
+constexpr size_t TRACK_LOG_SECTOR_SIZE = 4096;
+constexpr size_t TRACK_LOG_PAGE_SIZE = 256;
+
+// Sequence numbers are 24 bits; 0 is never used and 0xFFFFFF means erased
+constexpr uint32_t TRACK_LOG_SEQ_MAX = 0xFFFFFE;
+
+// Marker records use a latitude no real fix can have
+constexpr int32_t TRACK_LOG_ACK_MARKER = INT32_MIN;
+
+// ============================================
+// RECORD FORMAT
+// ============================================
+
+/**
+ * @brief One 16-byte record as stored on flash.
+ *
+ * seqCrc holds the 24-bit sequence number in bits 31..8 and a CRC-8 over
+ * the sequence number and the remaining 12 bytes in bits 7..0. An ACK
+ * marker has latE6 == TRACK_LOG_ACK_MARKER and the acknowledged sequence
+ * number in lonE6.
+ */
+struct TrackRecord {
+    uint32_t seqCrc;     ///< [31:8] sequence, [7:0] CRC-8
+    uint32_t timestamp;  ///< Seconds (collar wake clock)
+    int32_t latE6;       ///< Latitude in microdegrees (or marker)
+    int32_t lonE6;       ///< Longitude in microdegrees (or marker payload)
+};
+
+static_assert(sizeof(TrackRecord) == 16, "TrackRecord must be 16 bytes");
+
+// Records per staging batch: one flash page
+constexpr size_t TRACK_LOG_STAGING_RECORDS = TRACK_LOG_PAGE_SIZE / sizeof(TrackRecord);
+
+/**
+ * @brief A fix read back from the log together with its sequence number.
+ */
+struct TrackEntry {
+    uint32_t seq;       ///< Sequence number to acknowledge
+    PositionFix fix;    ///< The recorded fix
+};
+
+/**
+ * @brief Log state and staging buffer (POD, intended for RTC memory).
+ *
+ * If the magic does not match (cold boot), TrackLog::begin() rebuilds the
+ * state by scanning flash.
+ */
+struct TrackLogState {
+    uint32_t magic;          ///< TRACK_LOG_STATE_MAGIC when valid
+    uint32_t nextSeq;        ///< Sequence number for the next record
+    uint32_t ackedSeq;       ///< Highest sequence acknowledged by the base station
+    uint32_t writeOffset;    ///< Flash offset of the next record slot
+    uint32_t cursorOffset;   ///< Flash offset at or before the first unacked fix
+    uint32_t pendingFixes;   ///< Fixes recorded but not yet acknowledged
+    uint8_t stagedCount;     ///< Number of records in staged[]
+    TrackRecord staged[TRACK_LOG_STAGING_RECORDS];
+};
+
+constexpr uint32_t TRACK_LOG_STATE_MAGIC = 0x544C4F47;  // "TLOG"
+
+// ============================================
+// STORAGE CLASS
+// ============================================
+
+/**
+ * @brief Raw flash area with erase-sector granularity.
+ *
+ * The native backend emulates NOR flash: erase sets bytes to 0xFF and
+ * write can only clear bits, so tests see the same failure modes.
+ */
+class TrackLogStorage {
+public:
+    TrackLogStorage();
+    ~TrackLogStorage();
+
+    /**
+     * @brief Open the backing storage.
+     *
+     * @param location Partition label on ESP32, file path on native builds.
+     * @param size     Size in bytes for a new file (native only; ignored on
+     *                 ESP32). Must be a multiple of TRACK_LOG_SECTOR_SIZE.
+     * @return true if opened successfully.
+     */
+    bool begin(const char* location, size_t size = 0);
+
+    /**
+     * @brief Release the backing storage.
+     */
+    void end();
+
+    /**
+     * @brief Total size in bytes (multiple of TRACK_LOG_SECTOR_SIZE).
+     */
+    size_t size() const;
+
+    bool read(size_t offset, void* data, size_t len);
+    bool write(size_t offset, const void* data, size_t len);
+    bool eraseSector(size_t offset);
+
+private:
+    size_t _size;
+#ifdef ESP_PLATFORM
+    const esp_partition_t* _partition;
+#else
+    int _fd;
+#endif
+};
+
+// ============================================
+// TRACK LOG CLASS
+// ============================================
+
+/**
+ * @brief Append-only track log with staging, ring wraparound and ACK cursor.
+ */
+class TrackLog {
+public:
+    /**
+     * @brief Construct a track log.
+     *
+     * @param storage Opened flash storage (at least two sectors).
+     * @param state   Persistent state, normally a RTC_DATA_ATTR variable.
+     */
+    TrackLog(TrackLogStorage& storage, TrackLogState& state);
+
+    /**
+     * @brief Validate the state, recovering it from flash after a cold boot.
+     * @return true if the log is ready.
+     */
+    bool begin();
+
+    /**
+     * @brief Record a fix in the staging buffer.
+     *
+     * Flushes automatically when a full page has been staged.
+     *
+     * @return true if recorded (and flushed, if a flush was needed).
+     */
+    bool append(const PositionFix& fix);
+
+    /**
+     * @brief Write all staged records to flash.
+     * @return true on success (also when nothing was staged).
+     */
+    bool flush();
+
+    /**
+     * @brief Read unacknowledged fixes, oldest first, without consuming them.
+     *
+     * Includes fixes that are still staged in RTC memory.
+     *
+     * @param out Output array.
+     * @param max Capacity of out.
+     * @return Number of entries written.
+     */
+    size_t readPending(TrackEntry* out, size_t max);
+
+    /**
+     * @brief Mark all fixes up to and including seq as received.
+     *
+     * The cursor is persisted to flash with the next flush as a marker record.
+     *
+     * @return true if the acknowledgement was recorded.
+     */
+    bool acknowledge(uint32_t seq);
+
+    /**
+     * @brief Erase the whole log and reset the state.
+     */
+    bool format();
+
+    /**
+     * @brief Number of fixes recorded but not yet acknowledged.
+     *
+     * Fixes dropped by ring wraparound are not counted.
+     */
+    uint32_t pendingCount() const;
+
+    uint32_t nextSeq() const;
+    uint32_t ackedSeq() const;
+    uint8_t stagedCount() const;
+
+private:
+    TrackLogStorage& _storage;
+    TrackLogState& _state;
+
+    bool recover();
+    bool stage(const TrackRecord& record);
+    bool readRecord(size_t offset, TrackRecord& record, uint32_t& seq);
+    size_t nextOffset(size_t offset) const;
+    void advanceCursor(uint32_t oldAcked);
+};
+
+#endif // TRACK_LOG_H
@@ -0,0 +1,553 @@
+/**
+ * @file track_store.cpp
+ * @brief Implementation of the columnar track store.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "track_store.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include "../checksum/checksum.h"
+
+// Header field offsets (see BLOCK FORMAT in the header)
+static const size_t OFFSET_COUNT = 4;
+static const size_t OFFSET_FIRST_TIME = 8;
+static const size_t OFFSET_LAST_TIME = 12;
+static const size_t OFFSET_FIRST_LAT = 16;
+static const size_t OFFSET_FIRST_LON = 20;
+static const size_t OFFSET_BOX = 24;
+static const size_t OFFSET_TIME_BYTES = 40;
+static const size_t OFFSET_LAT_BYTES = 44;
+static const size_t OFFSET_LON_BYTES = 48;
+static const size_t OFFSET_CRC = 52;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static void put32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+    out[2] = static_cast<uint8_t>(value >> 16);
+    out[3] = static_cast<uint8_t>(value >> 24);
+}
+
+static uint32_t get32(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+// Time deltas can differ by more than int32 allows, so zigzag is 64-bit
+static uint64_t zigzagEncode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t zigzagDecode(uint64_t value) {
+    return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+static void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static bool readVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p >= end) {
+            return false;
+        }
+        uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Wrapping difference, as the position codec does
+static int32_t coordinateDelta(int32_t value, int32_t previous) {
+    return static_cast<int32_t>(static_cast<uint32_t>(value) - static_cast<uint32_t>(previous));
+}
+
+static size_t planeBytes(uint32_t count) {
+    return (count + 7) / 8;
+}
+
+static uint32_t fenceBit(PacketFenceState state, int bit) {
+    return (static_cast<uint32_t>(state) >> bit) & 1;
+}
+
+// ============================================================================
+// Block Codec
+// ============================================================================
+
+bool trackBlockEncode(const StoredFix* fixes, size_t count, std::vector<uint8_t>& out) {
+    if (count == 0 || count > TRACK_STORE_BLOCK_FIXES) {
+        return false;
+    }
+    for (size_t i = 1; i < count; i++) {
+        if (fixes[i].fix.timestamp < fixes[i - 1].fix.timestamp) {
+            return false;
+        }
+    }
+
+    out.assign(TRACK_STORE_HEADER_SIZE, 0);
+    const PositionFix& first = fixes[0].fix;
+    int32_t box[4] = {first.latE6, first.latE6, first.lonE6, first.lonE6};
+
+    // Time: delta of delta
+    int64_t prevDelta = 0;
+    for (size_t i = 1; i < count; i++) {
+        int64_t delta = static_cast<int64_t>(fixes[i].fix.timestamp) - fixes[i - 1].fix.timestamp;
+        writeVarint(out, zigzagEncode(delta - prevDelta));
+        prevDelta = delta;
+    }
+    size_t timeBytes = out.size() - TRACK_STORE_HEADER_SIZE;
+
+    for (size_t i = 1; i < count; i++) {
+        const PositionFix& fix = fixes[i].fix;
+        writeVarint(out, zigzagEncode(coordinateDelta(fix.latE6, fixes[i - 1].fix.latE6)));
+        box[0] = std::min(box[0], fix.latE6);
+        box[1] = std::max(box[1], fix.latE6);
+    }
+    size_t latBytes = out.size() - TRACK_STORE_HEADER_SIZE - timeBytes;
+
+    for (size_t i = 1; i < count; i++) {
+        const PositionFix& fix = fixes[i].fix;
+        writeVarint(out, zigzagEncode(coordinateDelta(fix.lonE6, fixes[i - 1].fix.lonE6)));
+        box[2] = std::min(box[2], fix.lonE6);
+        box[3] = std::max(box[3], fix.lonE6);
+    }
+    size_t lonBytes = out.size() - TRACK_STORE_HEADER_SIZE - timeBytes - latBytes;
+
+    // Fence state: one bit-plane per state bit
+    size_t plane = planeBytes(static_cast<uint32_t>(count));
+    size_t fenceStart = out.size();
+    out.resize(fenceStart + 2 * plane, 0);
+    for (size_t i = 0; i < count; i++) {
+        for (int bit = 0; bit < 2; bit++) {
+            out[fenceStart + bit * plane + i / 8] |=
+                static_cast<uint8_t>(fenceBit(fixes[i].fenceState, bit) << (i % 8));
+        }
+    }
+
+    uint8_t* header = out.data();
+    put32(header, TRACK_STORE_BLOCK_MAGIC);
+    put32(header + OFFSET_COUNT, static_cast<uint32_t>(count));
+    put32(header + OFFSET_FIRST_TIME, first.timestamp);
+    put32(header + OFFSET_LAST_TIME, fixes[count - 1].fix.timestamp);
+    put32(header + OFFSET_FIRST_LAT, static_cast<uint32_t>(first.latE6));
+    put32(header + OFFSET_FIRST_LON, static_cast<uint32_t>(first.lonE6));
+    for (int i = 0; i < 4; i++) {
+        put32(header + OFFSET_BOX + 4 * i, static_cast<uint32_t>(box[i]));
+    }
+    put32(header + OFFSET_TIME_BYTES, static_cast<uint32_t>(timeBytes));
+    put32(header + OFFSET_LAT_BYTES, static_cast<uint32_t>(latBytes));
+    put32(header + OFFSET_LON_BYTES, static_cast<uint32_t>(lonBytes));
+
+    uint32_t crc = crc32(header, OFFSET_CRC);
+    crc = crc32(header + TRACK_STORE_HEADER_SIZE, out.size() - TRACK_STORE_HEADER_SIZE, crc);
+    put32(header + OFFSET_CRC, crc);
+    return true;
+}
+
+size_t trackBlockCheck(const uint8_t* data, size_t length, TrackBlockInfo& info) {
+    if (length < TRACK_STORE_HEADER_SIZE || get32(data) != TRACK_STORE_BLOCK_MAGIC) {
+        return 0;
+    }
+    uint32_t count = get32(data + OFFSET_COUNT);
+    if (count == 0 || count > TRACK_STORE_BLOCK_FIXES) {
+        return 0;
+    }
+
+    // 64-bit sum: a corrupt header must not wrap around to a small size
+    uint64_t size = TRACK_STORE_HEADER_SIZE + static_cast<uint64_t>(get32(data + OFFSET_TIME_BYTES)) +
+                    get32(data + OFFSET_LAT_BYTES) + get32(data + OFFSET_LON_BYTES) +
+                    2 * planeBytes(count);
+    if (size > length) {
+        return 0;
+    }
+    uint32_t crc = crc32(data, OFFSET_CRC);
+    crc = crc32(data + TRACK_STORE_HEADER_SIZE, static_cast<size_t>(size) - TRACK_STORE_HEADER_SIZE, crc);
+    if (crc != get32(data + OFFSET_CRC)) {
+        return 0;
+    }
+
+    info.fixCount = count;
+    info.firstTime = get32(data + OFFSET_FIRST_TIME);
+    info.lastTime = get32(data + OFFSET_LAST_TIME);
+    info.minLatE6 = static_cast<int32_t>(get32(data + OFFSET_BOX));
+    info.maxLatE6 = static_cast<int32_t>(get32(data + OFFSET_BOX + 4));
+    info.minLonE6 = static_cast<int32_t>(get32(data + OFFSET_BOX + 8));
+    info.maxLonE6 = static_cast<int32_t>(get32(data + OFFSET_BOX + 12));
+    return static_cast<size_t>(size);
+}
+
+bool trackBlockDecode(const uint8_t* data, StoredFix* out) {
+    uint32_t count = get32(data + OFFSET_COUNT);
+    const uint8_t* p = data + TRACK_STORE_HEADER_SIZE;
+    const uint8_t* timeEnd = p + get32(data + OFFSET_TIME_BYTES);
+    const uint8_t* latEnd = timeEnd + get32(data + OFFSET_LAT_BYTES);
+    const uint8_t* lonEnd = latEnd + get32(data + OFFSET_LON_BYTES);
+    uint64_t value;
+
+    out[0].fix.timestamp = get32(data + OFFSET_FIRST_TIME);
+    out[0].fix.latE6 = static_cast<int32_t>(get32(data + OFFSET_FIRST_LAT));
+    out[0].fix.lonE6 = static_cast<int32_t>(get32(data + OFFSET_FIRST_LON));
+
+    int64_t delta = 0;
+    for (uint32_t i = 1; i < count; i++) {
+        if (!readVarint(p, timeEnd, value)) {
+            return false;
+        }
+        delta += zigzagDecode(value);
+        out[i].fix.timestamp = static_cast<uint32_t>(out[i - 1].fix.timestamp + delta);
+    }
+    for (uint32_t i = 1; i < count; i++) {
+        if (!readVarint(p, latEnd, value)) {
+            return false;
+        }
+        out[i].fix.latE6 = static_cast<int32_t>(static_cast<uint32_t>(out[i - 1].fix.latE6) +
+                                                static_cast<uint32_t>(zigzagDecode(value)));
+    }
+    for (uint32_t i = 1; i < count; i++) {
+        if (!readVarint(p, lonEnd, value)) {
+            return false;
+        }
+        out[i].fix.lonE6 = static_cast<int32_t>(static_cast<uint32_t>(out[i - 1].fix.lonE6) +
+                                                static_cast<uint32_t>(zigzagDecode(value)));
+    }
+
+    const uint8_t* plane0 = lonEnd;
+    const uint8_t* plane1 = lonEnd + planeBytes(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t state = static_cast<uint8_t>(((plane0[i / 8] >> (i % 8)) & 1) |
+                                             (((plane1[i / 8] >> (i % 8)) & 1) << 1));
+        out[i].fenceState = static_cast<PacketFenceState>(state);
+    }
+    return p == lonEnd;
+}
+
+// ============================================================================
+// TrackStoreWriter Class Implementation
+// ============================================================================
+
+TrackStoreWriter::TrackStoreWriter()
+    : _hasLast(false)
+    , _lastTime(0)
+    , _bytesWritten(0)
+{
+}
+
+bool TrackStoreWriter::begin(const char* path) {
+    _path = path;
+    _pending.clear();
+    _pending.reserve(TRACK_STORE_BLOCK_FIXES);
+    _hasLast = false;
+    _lastTime = 0;
+    _bytesWritten = 0;
+
+    int fd = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // Walk the blocks to the last good one; anything after it is a torn append
+    size_t size = static_cast<size_t>(st.st_size);
+    size_t offset = 0;
+    std::vector<uint8_t> block;
+    while (offset + TRACK_STORE_HEADER_SIZE <= size) {
+        uint8_t header[TRACK_STORE_HEADER_SIZE];
+        if (pread(fd, header, sizeof(header), static_cast<off_t>(offset)) != static_cast<ssize_t>(sizeof(header))) {
+            break;
+        }
+        uint32_t count = get32(header + OFFSET_COUNT);
+        size_t blockSize = TRACK_STORE_HEADER_SIZE + get32(header + OFFSET_TIME_BYTES) +
+                           get32(header + OFFSET_LAT_BYTES) + get32(header + OFFSET_LON_BYTES) +
+                           2 * planeBytes(count);
+        if (get32(header) != TRACK_STORE_BLOCK_MAGIC || offset + blockSize > size) {
+            break;
+        }
+
+        // Only the last block can be torn, so only it is fully checked
+        TrackBlockInfo info;
+        if (offset + blockSize == size) {
+            block.resize(blockSize);
+            if (pread(fd, block.data(), blockSize, static_cast<off_t>(offset)) != static_cast<ssize_t>(blockSize) ||
+                trackBlockCheck(block.data(), blockSize, info) == 0) {
+                break;
+            }
+        }
+        _lastTime = get32(header + OFFSET_LAST_TIME);
+        _hasLast = true;
+        offset += blockSize;
+    }
+
+    bool ok = offset == size || ftruncate(fd, static_cast<off_t>(offset)) == 0;
+    ::close(fd);
+    return ok;
+}
+
+bool TrackStoreWriter::append(const PositionFix& fix, PacketFenceState fenceState) {
+    if (_hasLast && fix.timestamp < _lastTime) {
+        return false;
+    }
+    StoredFix stored = {fix, fenceState};
+    _pending.push_back(stored);
+    _lastTime = fix.timestamp;
+    _hasLast = true;
+
+    return _pending.size() < TRACK_STORE_BLOCK_FIXES || flush();
+}
+
+bool TrackStoreWriter::flush() {
+    if (_pending.empty()) {
+        return true;
+    }
+    if (!trackBlockEncode(_pending.data(), _pending.size(), _encoded)) {
+        return false;
+    }
+
+    int fd = ::open(_path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    const uint8_t* p = _encoded.data();
+    size_t remaining = _encoded.size();
+    while (remaining > 0) {
+        ssize_t written = write(fd, p, remaining);
+        if (written <= 0) {
+            ::close(fd);
+            return false;
+        }
+        p += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    ::close(fd);
+
+    _bytesWritten += _encoded.size();
+    _pending.clear();
+    return true;
+}
+
+// ============================================================================
+// TrackStoreReader Class Implementation
+// ============================================================================
+
+TrackStoreReader::TrackStoreReader()
+    : _data(nullptr)
+    , _size(0)
+    , _fixCount(0)
+    , _truncated(false)
+{
+}
+
+TrackStoreReader::~TrackStoreReader() {
+    close();
+}
+
+bool TrackStoreReader::open(const char* path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    _size = static_cast<size_t>(st.st_size);
+    if (_size > 0) {
+        void* map = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd);
+            _size = 0;
+            return false;
+        }
+        _data = static_cast<const uint8_t*>(map);
+    }
+    ::close(fd);    // The mapping stays valid
+
+    size_t offset = 0;
+    while (offset < _size) {
+        TrackBlockInfo info;
+        size_t blockSize = trackBlockCheck(_data + offset, _size - offset, info);
+        if (blockSize == 0) {
+            _truncated = true;
+            break;
+        }
+        info.offset = offset;
+        _blocks.push_back(info);
+        _fixCount += info.fixCount;
+        offset += blockSize;
+    }
+    return true;
+}
+
+void TrackStoreReader::close() {
+    if (_data != nullptr) {
+        munmap(const_cast<uint8_t*>(_data), _size);
+    }
+    _data = nullptr;
+    _size = 0;
+    _blocks.clear();
+    _fixCount = 0;
+    _truncated = false;
+}
+
+size_t TrackStoreReader::firstBlockEnding(uint32_t from) const {
+    // Blocks are in time order, so their last timestamps are sorted
+    return static_cast<size_t>(std::lower_bound(_blocks.begin(), _blocks.end(), from,
+                                                [](const TrackBlockInfo& block, uint32_t time) {
+                                                    return block.lastTime < time;
+                                                }) - _blocks.begin());
+}
+
+size_t TrackStoreReader::query(uint32_t from, uint32_t to, std::vector<StoredFix>& out) const {
+    size_t before = out.size();
+    std::vector<StoredFix> partial;
+
+    for (size_t b = firstBlockEnding(from); b < _blocks.size() && _blocks[b].firstTime <= to; b++) {
+        const TrackBlockInfo& block = _blocks[b];
+        if (block.firstTime >= from && block.lastTime <= to) {
+            // Whole block: decode straight into the result
+            size_t at = out.size();
+            out.resize(at + block.fixCount);
+            if (!trackBlockDecode(_data + block.offset, &out[at])) {
+                out.resize(at);
+            }
+            continue;
+        }
+
+        partial.resize(block.fixCount);
+        if (trackBlockDecode(_data + block.offset, partial.data())) {
+            for (const StoredFix& fix : partial) {
+                if (fix.fix.timestamp >= from && fix.fix.timestamp <= to) {
+                    out.push_back(fix);
+                }
+            }
+        }
+    }
+    return out.size() - before;
+}
+
+uint64_t TrackStoreReader::countOutside(uint32_t from, uint32_t to) const {
+    uint64_t outside = 0;
+    std::vector<StoredFix> partial;
+
+    for (size_t b = firstBlockEnding(from); b < _blocks.size() && _blocks[b].firstTime <= to; b++) {
+        const TrackBlockInfo& block = _blocks[b];
+        const uint8_t* header = _data + block.offset;
+        if (block.firstTime >= from && block.lastTime <= to) {
+            // OUTSIDE and ALERT both have bit 1 set: popcount plane 1
+            const uint8_t* plane1 = header + TRACK_STORE_HEADER_SIZE + get32(header + OFFSET_TIME_BYTES) +
+                                    get32(header + OFFSET_LAT_BYTES) + get32(header + OFFSET_LON_BYTES) +
+                                    planeBytes(block.fixCount);
+            for (size_t i = 0; i < planeBytes(block.fixCount); i++) {
+                outside += static_cast<uint64_t>(__builtin_popcount(plane1[i]));
+            }
+            continue;
+        }
+
+        partial.resize(block.fixCount);
+        if (trackBlockDecode(header, partial.data())) {
+            for (const StoredFix& fix : partial) {
+                if (fix.fix.timestamp >= from && fix.fix.timestamp <= to &&
+                    fenceBit(fix.fenceState, 1)) {
+                    outside++;
+                }
+            }
+        }
+    }
+    return outside;
+}
+
+bool TrackStoreReader::decodeBlock(size_t block, std::vector<StoredFix>& out) const {
+    if (block >= _blocks.size()) {
+        return false;
+    }
+    out.resize(_blocks[block].fixCount);
+    return trackBlockDecode(_data + _blocks[block].offset, out.data());
+}
+
+// ============================================================================
+// TrackStore Class Implementation
+// ============================================================================
+
+TrackStore::TrackStore(const char* directory)
+    : _directory(directory)
+{
+}
+
+std::string TrackStore::collarPath(uint32_t collarId, uint32_t segment) const {
+    char name[40];
+    if (segment == 0) {
+        snprintf(name, sizeof(name), "/%08lx.uct", (unsigned long)collarId);
+    } else {
+        snprintf(name, sizeof(name), "/%08lx.%lu.uct", (unsigned long)collarId, (unsigned long)segment);
+    }
+    return _directory + name;
+}
+
+uint32_t TrackStore::segmentCount(uint32_t collarId) const {
+    uint32_t count = 0;
+    struct stat st;
+    while (stat(collarPath(collarId, count).c_str(), &st) == 0) {
+        count++;
+    }
+    return count;
+}
+
+bool TrackStore::append(uint32_t collarId, const PositionFix& fix, PacketFenceState fenceState) {
+    std::map<uint32_t, CollarTrack>::iterator it = _collars.find(collarId);
+    if (it == _collars.end()) {
+        // Carry on in the newest segment written before a restart
+        CollarTrack track;
+        uint32_t segments = segmentCount(collarId);
+        track.segment = segments > 0 ? segments - 1 : 0;
+        it = _collars.insert(std::make_pair(collarId, track)).first;
+        if (!it->second.writer.begin(collarPath(collarId, it->second.segment).c_str())) {
+            _collars.erase(it);
+            return false;
+        }
+    }
+
+    CollarTrack& track = it->second;
+    if (track.writer.hasLast() && fix.timestamp < track.writer.lastTime()) {
+        // The collar rebooted: close this segment and start the next
+        if (!track.writer.flush()) {
+            return false;
+        }
+        track.segment++;
+        if (!track.writer.begin(collarPath(collarId, track.segment).c_str())) {
+            return false;
+        }
+    }
+    return track.writer.append(fix, fenceState);
+}
+
+bool TrackStore::flush() {
+    bool ok = true;
+    for (std::map<uint32_t, CollarTrack>::iterator it = _collars.begin(); it != _collars.end(); ++it) {
+        ok = it->second.writer.flush() && ok;
+    }
+    return ok;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file wake_gate.cpp
+ * @brief Skip budget planning for the deep-sleep wake stub.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include "wake_gate.h"
+
+uint16_t wakeGatePlan(WakeGateState& state, const WakeGateConfig& config,
+                      float insideDistanceM, bool allowSkip) {
+    state.magic = WAKE_GATE_MAGIC;
+    state.motion = 0;
+    state.skippedWakes = 0;
+    state.skipBudget = 0;
+
+    if (!allowSkip || config.wakeIntervalSec == 0 || config.maxSpeedMps <= 0.0f) {
+        return 0;
+    }
+
+    float reserve = insideDistanceM - config.safetyMarginM;
+    if (reserve <= 0.0f) {
+        return 0;
+    }
+
+    // Every wake (skipped or not) gives the dog one more interval to move;
+    // the wake that follows the budget must still be in time
+    float travelPerWake = config.maxSpeedMps * static_cast<float>(config.wakeIntervalSec);
+    float wakes = reserve / travelPerWake - 1.0f;
+    if (wakes < 1.0f) {
+        return 0;
+    }
+
+    uint16_t budget = wakes >= config.maxSkippedWakes
+                          ? config.maxSkippedWakes
+                          : static_cast<uint16_t>(wakes);
+    state.skipBudget = budget;
+    return budget;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file wake_gate.h
+ * @brief Decide on wake whether a full boot is needed at all.
+ *
+ * A dog asleep in the middle of the yard cannot reach the fence within a
+ * few wake intervals. After every full boot the firmware computes a skip
+ * budget from the distance to the fence and a worst-case running speed;
+ * on the following timer wakes a deep-sleep wake stub spends one unit of
+ * the budget and goes straight back to sleep, without starting the app.
+ *
+ * The skip check runs from the wake stub, before flash and the C runtime
+ * are available. It is therefore header-only, forced inline, and only
+ * touches the state struct, which must live in RTC memory.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_GATE_H
+#define WAKE_GATE_H
+
+#include <stdint.h>
+
+// Force inlining so the check is compiled into the (RTC IRAM) wake stub
+#define WAKE_GATE_INLINE inline __attribute__((always_inline))
+
+// ============================================
+// TYPES
+// ============================================
+
+/**
+ * @brief Tunables for the skip budget.
+ */
+struct WakeGateConfig {
+    uint32_t wakeIntervalSec;    ///< Deep sleep interval between wakes
+    float maxSpeedMps;           ///< Worst-case dog speed used to bound travel
+    float safetyMarginM;         ///< Distance kept in reserve (GPS error, alert margin)
+    uint16_t maxSkippedWakes;    ///< Upper bound so fixes are still logged regularly
+};
+
+// A dog sprints at ~10 m/s; at most one fix per minute is skipped over
+constexpr WakeGateConfig DEFAULT_WAKE_GATE_CONFIG = {
+    5,      // wakeIntervalSec
+    10.0f,  // maxSpeedMps
+    10.0f,  // safetyMarginM
+    11      // maxSkippedWakes
+};
+
+/**
+ * @brief Persistent state (POD, must be placed in RTC memory).
+ *
+ * Zero-initialized state never skips a wake.
+ */
+struct WakeGateState {
+    uint32_t magic;          ///< WAKE_GATE_MAGIC once planned by a full boot
+    uint16_t skipBudget;     ///< Timer wakes that may still be skipped
+    uint8_t motion;          ///< Non-zero when motion was reported since planning
+    uint8_t reserved;
+    uint32_t skippedWakes;   ///< Wakes skipped since the last full boot
+};
+
+constexpr uint32_t WAKE_GATE_MAGIC = 0x57474154;  // "WGAT"
+
+// ============================================
+// WAKE STUB SIDE
+// ============================================
+
+/**
+ * @brief Try to spend one skipped wake.
+ *
+ * Safe to call from a deep-sleep wake stub.
+ *
+ * @return true if this wake may go straight back to sleep.
+ */
+WAKE_GATE_INLINE bool wakeGateTrySkip(WakeGateState& state) {
+    if (state.magic != WAKE_GATE_MAGIC || state.motion != 0 || state.skipBudget == 0) {
+        return false;
+    }
+    state.skipBudget--;
+    state.skippedWakes++;
+    return true;
+}
+
+/**
+ * @brief Report motion, cancelling the remaining skip budget.
+ *
+ * Safe to call from a deep-sleep wake stub.
+ */
+WAKE_GATE_INLINE void wakeGateReportMotion(WakeGateState& state) {
+    state.motion = 1;
+}
+
+// ============================================
+// FULL BOOT SIDE
+// ============================================
+
+/**
+ * @brief Plan the skip budget after a full boot.
+ *
+ * Resets the motion flag and the skipped-wake counter.
+ *
+ * @param state           Persistent state.
+ * @param config          Tunables.
+ * @param insideDistanceM Distance to the fence, positive inside.
+ * @param allowSkip       false forces the next wake to boot (alert active,
+ *                        no fix, pending radio traffic, ...).
+ * @return Number of wakes that may be skipped.
+ */
+uint16_t wakeGatePlan(WakeGateState& state, const WakeGateConfig& config,
+                      float insideDistanceM, bool allowSkip);
+
+#endif // WAKE_GATE_H
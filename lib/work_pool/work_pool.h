@@ -0,0 +1,195 @@
+/**
+ * @file work_pool.h
+ * @brief Work-stealing thread pool for host-side batch jobs.
+ *
+ * run(taskCount, fn) calls fn(task) once for every task index and returns
+ * when all have finished. Each worker starts with its own contiguous
+ * block of indices in a deque and takes from the front, so neighbouring
+ * tasks (neighbouring chunks of a track) run on one thread in order. A
+ * worker whose deque runs dry steals from the back of another's, which
+ * evens out uneven chunks without a shared queue every task goes through.
+ *
+ * Tasks should be coarse (a chunk of thousands of items): each deque is
+ * guarded by its own mutex, taken once per task.
+ *
+ * Header-only, host only (std::thread): used by the fence replay engine
+ * and its tools, never by the firmware.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed set of worker threads running batches of indexed tasks.
+ */
+class WorkStealingPool {
+public:
+    typedef std::function<void(size_t task)> TaskFunction;
+
+    /**
+     * @param threads Worker count; 0 uses the number of hardware threads.
+     */
+    explicit WorkStealingPool(size_t threads = 0)
+        : _queues(threads > 0 ? threads : defaultThreads()),
+          _task(nullptr),
+          _idleWorkers(0),
+          _generation(0),
+          _stopping(false),
+          _steals(0) {
+        for (size_t i = 0; i < _queues.size(); i++) {
+            _threads.emplace_back(&WorkStealingPool::workerMain, this, i);
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _start.notify_all();
+        for (std::thread& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Run fn(0) .. fn(taskCount - 1) on the workers and wait.
+     *
+     * Not reentrant: call from one thread at a time, never from a task.
+     */
+    void run(size_t taskCount, const TaskFunction& fn) {
+        if (taskCount == 0) {
+            return;
+        }
+
+        // Deal out contiguous blocks, the remainder one each to the first workers
+        size_t workers = _queues.size();
+        size_t next = 0;
+        for (size_t i = 0; i < workers; i++) {
+            size_t count = taskCount / workers + (i < taskCount % workers ? 1 : 0);
+            std::lock_guard<std::mutex> lock(_queues[i].mutex);
+            for (size_t j = 0; j < count; j++) {
+                _queues[i].tasks.push_back(next++);
+            }
+        }
+
+        // Every worker takes part in every batch and reports back idle, so
+        // none can still be looking for work when the next batch is dealt
+        std::unique_lock<std::mutex> lock(_mutex);
+        _task = &fn;
+        _idleWorkers = 0;
+        _generation++;
+        _start.notify_all();
+        _done.wait(lock, [this] { return _idleWorkers == _queues.size(); });
+        _task = nullptr;
+    }
+
+    /**
+     * @brief Number of worker threads.
+     */
+    size_t threadCount() const {
+        return _queues.size();
+    }
+
+    /**
+     * @brief Tasks taken from another worker's deque since construction.
+     */
+    size_t stealCount() const {
+        return _steals.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Hardware threads, at least 1.
+     */
+    static size_t defaultThreads() {
+        unsigned count = std::thread::hardware_concurrency();
+        return count > 0 ? count : 1;
+    }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<WorkerQueue> _queues;
+    std::vector<std::thread> _threads;
+
+    std::mutex _mutex;
+    std::condition_variable _start;
+    std::condition_variable _done;
+    const TaskFunction* _task;      ///< Batch in progress (guarded by _mutex)
+    size_t _idleWorkers;            ///< Workers done with the current batch
+    size_t _generation;             ///< Incremented for every batch
+    bool _stopping;
+    std::atomic<size_t> _steals;
+
+    bool popOwn(size_t worker, size_t& task) {
+        WorkerQueue& queue = _queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        task = queue.tasks.front();
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    bool steal(size_t worker, size_t& task) {
+        for (size_t i = 1; i < _queues.size(); i++) {
+            WorkerQueue& victim = _queues[(worker + i) % _queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.back();
+                victim.tasks.pop_back();
+                _steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerMain(size_t worker) {
+        size_t seen = 0;
+        for (;;) {
+            const TaskFunction* fn;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _start.wait(lock, [this, seen] { return _stopping || _generation != seen; });
+                if (_stopping) {
+                    return;
+                }
+                seen = _generation;
+                fn = _task;
+            }
+
+            // All tasks are dealt out before the batch starts, so once
+            // every deque is empty there is nothing left to take
+            size_t task;
+            while (popOwn(worker, task) || steal(worker, task)) {
+                (*fn)(task);
+            }
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (++_idleWorkers == _queues.size()) {
+                _done.notify_all();
+            }
+        }
+    }
+};
+
+#endif // WORK_POOL_H
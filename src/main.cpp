@@ -1,16 +1,65 @@
 #include <Arduino.h>
 #include <Wire.h>
+#include <SPI.h>
 #include <WiFi.h>
 #include "esp_bt.h"
 #include "I2C_LCD.h"
 #include <Adafruit_GPS.h>
 #include <esp_sleep.h>
+#include <driver/ledc.h>
+#include <driver/gpio.h>
+#include <sys/time.h>
+#include <atomic>
+#include <new>
 #include "../lib/point_in_polygon/point_in_polygon.h"
 #include "../lib/config_manager/config_manager.h"
+#include "../lib/fence_store/fence_store.h"
+#include "../lib/fence_validate/fence_validate.h"
+#include "../lib/fence_alert/fence_alert.h"
+#include "../lib/track_log/track_log.h"
+#include "../lib/fence_update/fence_update.h"
+#include "../lib/wake_gate/wake_gate.h"
+#include "../lib/motion_gate/motion_gate.h"
+#include "../lib/icm20948/icm20948.h"
+#include "../lib/activity_classifier/activity_classifier.h"
+#include "../lib/gps_burst/gps_burst.h"
+#include "../lib/fix_policy/fix_policy.h"
+#include "../lib/gps_config/gps_config.h"
+#include "../lib/spsc_queue/spsc_queue.h"
+#include "../lib/radio/radio.h"
+#include "../lib/rfm95/rfm95.h"
+#include "../lib/alert_sequencer/alert_sequencer.h"
+#include "../lib/binlog/binlog.h"
+#include "../lib/binlog/log_messages.h"
 
-// Uncomment to enable serial debugging output
+// Wake stub helpers (ESP-IDF 5.1+). Without them, uneventful wakes are
+// still cut short at the very start of setup().
+#if __has_include(<esp_wake_stub.h>)
+#include <esp_wake_stub.h>
+#include <soc/rtc.h>
+#define HAVE_WAKE_STUB
+#endif
+
+// Alert PWM runs from the fast RC oscillator, which (unlike the APB clock
+// behind the default LEDC setup) keeps running in light sleep
+#if ESP_IDF_VERSION_MAJOR >= 5
+#define ALERT_LEDC_CLOCK LEDC_USE_RC_FAST_CLK
+#define ALERT_LEDC_PD_DOMAIN ESP_PD_DOMAIN_RC_FAST
+#else
+#define ALERT_LEDC_CLOCK LEDC_USE_RTC8M_CLK
+#define ALERT_LEDC_PD_DOMAIN ESP_PD_DOMAIN_RTC8M
+#endif
+
+// Uncomment to stream the binary debug log over USB serial while a host
+// is attached (decode with tools/binlog_decode.cpp). Logging itself is
+// always on and does not block.
 #define DEBUG_SERIAL
 
+// The wake simulator (tools/wake_sim) models the deployed build
+#ifdef WAKE_SIM
+#undef DEBUG_SERIAL
+#endif
+
 // Uncomment to enable LCD debugging output
 // #define DEBUG_LCD
 
@@ -22,19 +71,120 @@
 // On first boot, defaults are used and saved to NVS.
 
 constexpr uint32_t GPS_UPDATE_INTERVAL_SEC = 5;
-constexpr uint32_t GPS_FIX_TIMEOUT_SEC = 3;
+
+// Fix acquisition: quality needed per fence distance, learned timeout
+// and backoff after failed attempts
+constexpr FixPolicyConfig FIX_POLICY_CONFIG = DEFAULT_FIX_POLICY_CONFIG;
+
+// GPS responses: PMTK_ACK after a command, first sentence after waking
+constexpr uint32_t GPS_ACK_TIMEOUT_MS = 250;
+constexpr uint32_t GPS_WAKE_TIMEOUT_MS = 100;
+
+// RMC for position, GGA for HDOP and satellite count
+constexpr uint8_t GPS_SENTENCES = GPS_NMEA_RMC | GPS_NMEA_GGA;
+
+// Near the fence: stream fixes at a higher rate until the dog is clear
+constexpr GpsBurstConfig GPS_BURST_CONFIG = DEFAULT_GPS_BURST_CONFIG;
+constexpr uint32_t GPS_BURST_FIX_TIMEOUT_MS = 2000;
+
+// Burst pipeline: parsed fixes in flight from core 0 to core 1, and how
+// many bytes the parser reads before letting core 0's idle task run
+constexpr size_t GPS_PIPELINE_DEPTH = 8;
+constexpr uint32_t GPS_PARSE_YIELD_BYTES = 32;
+constexpr UBaseType_t GPS_PARSE_TASK_PRIORITY = 2;
+
+// Number of unacknowledged track fixes that triggers a batched uplink
+constexpr uint32_t TRACK_UPLINK_BATCH = 8;
+
+// RFM95W on the default SPI pins (SCK 36, MISO 37, MOSI 35)
+constexpr int8_t RADIO_CS_PIN = 9;       // A2
+constexpr int8_t RADIO_RESET_PIN = 8;    // A3
+constexpr int8_t RADIO_DIO0_PIN = 17;    // A1
+constexpr uint32_t RADIO_FREQUENCY_HZ = 915000000;
+constexpr int8_t RADIO_TX_POWER_DBM = 17;
+constexpr LoraModemConfig RADIO_MODEM_CONFIG = DEFAULT_LORA_MODEM_CONFIG;
+
+// After an uplink: how long to listen for downlinks (extended by each
+// frame received), the light-sleep slice while listening, and the slack
+// on top of the computed airtime before a TX is given up on
+constexpr uint32_t RADIO_RX_WINDOW_MS = 300;
+constexpr uint32_t RADIO_RX_SLICE_US = 10000;
+constexpr uint32_t RADIO_TX_MARGIN_MS = 50;
+
+// Boundary alert hysteresis: margins (m), dwell times and escalation (s)
+constexpr FenceAlertConfig FENCE_ALERT_CONFIG = DEFAULT_FENCE_ALERT_CONFIG;
+
+// Passive piezo beeper and optional vibration motor (via a transistor),
+// both on LEDC PWM. Beeper volume is its duty cycle, up to 50%.
+constexpr gpio_num_t BEEPER_PIN = GPIO_NUM_5;      // TX
+constexpr gpio_num_t VIBRATION_PIN = GPIO_NUM_16;  // RX
+constexpr uint32_t VIBRATION_PWM_HZ = 200;
+constexpr uint32_t ALERT_PWM_MAX_DUTY = 1023;      // 10-bit resolution
+constexpr uint32_t BEEPER_MAX_DUTY = ALERT_PWM_MAX_DUTY / 2;
+
+// Wakes skipped while deep inside the fence: worst-case speed and margin
+constexpr WakeGateConfig WAKE_GATE_CONFIG = {
+    GPS_UPDATE_INTERVAL_SEC,
+    DEFAULT_WAKE_GATE_CONFIG.maxSpeedMps,
+    DEFAULT_WAKE_GATE_CONFIG.safetyMarginM,
+    DEFAULT_WAKE_GATE_CONFIG.maxSkippedWakes
+};
+
+// Optional ICM-20948: wake-on-motion interrupt on INT1 (RTC-capable pin A0)
+constexpr gpio_num_t IMU_INT_PIN = GPIO_NUM_18;
+constexpr uint16_t IMU_WOM_THRESHOLD_MG = 60;
+constexpr uint16_t IMU_SAMPLE_RATE_HZ = 100;
+constexpr size_t IMU_BURST_SAMPLES = 16;
+constexpr size_t IMU_FIFO_SAMPLES = ICM20948_FIFO_SAMPLES;
+
+// Motion score thresholds for skipping GPS while the dog is stationary
+constexpr MotionGateConfig MOTION_GATE_CONFIG = DEFAULT_MOTION_GATE_CONFIG;
+
+// Debug log drain: poll period, and how long to wait for pending records
+// before deep sleep (only while a host is attached)
+constexpr uint32_t LOG_DRAIN_PERIOD_MS = 20;
+constexpr uint32_t LOG_FLUSH_TIMEOUT_MS = 50;
 
 // ConfigManager instance - handles NVS persistence
 extern ConfigManager configManager;
 
-// Geofence polygon instance (initialized in setup after config loads)
+// Memory-mapped fence partition - preferred over NVS for large fences
+FenceStore fenceStore;
+
+// Geofence polygon instance (initialized in setup after config loads;
+// stays null while the active fence is not a simple polygon)
 Polygon* boundary = nullptr;
 
+// Vertices behind the polygon: mapped flash or the NVS config
+const GeoPoint* fenceVertices = nullptr;
+size_t fenceVertexCount = 0;
+
 // Constructor: (I2C Address, Pointer to Wire interface)
 I2C_LCD lcd(0x27, &Wire1);
 
 // Connect to the GPS on the hardware I2C port
 Adafruit_GPS GPS(&Wire1);
+bool gpsAwake = false;
+
+// Optional IMU on the same I2C port
+Icm20948 imu(Wire1);
+bool imuReady = false;
+
+// Alert playback; patterns finish within the wake
+AlertSequencerState alertState = {};
+bool alertOutputReady = false;
+
+// LoRa radio, brought up on the first uplink of a wake
+uint32_t radioClockUs() {
+    return micros();
+}
+Rfm95 radio(SPI, RADIO_CS_PIN, RADIO_RESET_PIN, RADIO_DIO0_PIN, RADIO_MODEM_CONFIG, radioClockUs);
+bool radioReady = false;
+bool radioUsed = false;
+
+// Last track fix in the uplink on air, acknowledged once TX completes
+bool uplinkAckPending = false;
+uint32_t uplinkAckSeq = 0;
 
 // ============================================
 // RTC MEMORY - Persists across deep sleep
@@ -51,6 +201,50 @@ RTC_DATA_ATTR struct PositionData {
     false
 };
 
+// Boundary alert state machine - only confirmed crossings are acted on
+RTC_DATA_ATTR FenceAlertContext fenceAlert = {};
+
+// Track log: fixes are staged in RTC memory and flushed to flash per page
+RTC_DATA_ATTR TrackLogState trackLogState = {};
+TrackLogStorage trackLogStorage;
+TrackLog trackLog(trackLogStorage, trackLogState);
+bool trackLogReady = false;
+
+// Over-the-air fence update: received chunks survive deep sleep, so an
+// interrupted transfer resumes where it stopped
+RTC_DATA_ATTR FenceUpdateState fenceUpdateState = {};
+
+// GPS settings the module has acknowledged; kept while it is in standby
+RTC_DATA_ATTR GpsConfigState gpsConfig = {};
+
+// Recent times to fix and failure backoff
+RTC_DATA_ATTR FixPolicyState fixPolicy = {};
+
+// Burst mode state
+RTC_DATA_ATTR GpsBurstState gpsBurst = {};
+
+// Rolling sequence number of position uplinks
+RTC_DATA_ATTR uint16_t uplinkSequence = 0;
+
+// Skip budget spent by the wake stub on uneventful wakes
+RTC_DATA_ATTR WakeGateState wakeGate = {};
+
+// Wake-on-motion and the FIFO were configured and keep running in sleep
+RTC_DATA_ATTR bool imuConfigured = false;
+
+// Wake-on-motion was armed for the deep sleep in progress
+RTC_DATA_ATTR bool imuWakeArmed = false;
+
+// Decaying motion score from the IMU
+RTC_DATA_ATTR MotionGateState motionGate = {};
+
+// Binary debug log, kept until a host drains it over USB
+RTC_DATA_ATTR BinLogState binlogState;
+
+// Activity summaries per period, classified from the IMU FIFO
+RTC_DATA_ATTR ActivityState activityState = {};
+ActivityClassifier activity(activityState);
+
 uint32_t timer = millis();
 
 // ============================================
@@ -73,9 +267,25 @@ void disableUnusedPeripherals() {
     // btStop() should be sufficient for most use cases
     // esp_bt_controller_disable();
     
+    binlog(LOG_RADIOS_DISABLED);
+}
+
+/**
+ * Light-sleep for a while. With a USB host attached, only delay (light
+ * sleep would drop the USB connection the log drains over).
+ */
+void lightSleepUs(uint32_t durationUs) {
+    if (durationUs == 0) {
+        return;
+    }
     #ifdef DEBUG_SERIAL
-    Serial.println("WiFi and Bluetooth disabled");
+    if (Serial) {
+        delayMicroseconds(durationUs);
+        return;
+    }
     #endif
+    esp_sleep_enable_timer_wakeup(durationUs);
+    esp_light_sleep_start();
 }
 
 /**
@@ -83,9 +293,33 @@ void disableUnusedPeripherals() {
  */
 void gpsSleep() {
     GPS.sendCommand(PMTK_STANDBY);
-    #ifdef DEBUG_SERIAL
-    Serial.println("GPS put to sleep");
-    #endif
+    gpsAwake = false;
+    binlog(LOG_GPS_SLEEP);
+}
+
+/**
+ * Poll the GPS until it answers, instead of a fixed delay.
+ * With commandId 0 any sentence counts (module awake); otherwise waits
+ * for the PMTK_ACK of that command.
+ * Returns true on a response (a successful ACK for commands).
+ */
+bool gpsWaitForResponse(uint16_t commandId, uint32_t timeoutMs) {
+    uint32_t startTime = millis();
+
+    while (millis() - startTime < timeoutMs) {
+        GPS.read();
+        if (!GPS.newNMEAreceived()) {
+            continue;
+        }
+        if (commandId == 0) {
+            return true;
+        }
+        PmtkAck ack = pmtkParseAck(GPS.lastNMEA(), commandId);
+        if (ack != PmtkAck::NONE) {
+            return ack == PmtkAck::SUCCESS;
+        }
+    }
+    return false;
 }
 
 /**
@@ -93,68 +327,944 @@ void gpsSleep() {
  */
 void gpsWake() {
     GPS.sendCommand(PMTK_AWAKE);
-    #ifdef DEBUG_SERIAL
-    Serial.println("GPS woken up");
-    #endif
+    gpsAwake = true;
+    gpsWaitForResponse(0, GPS_WAKE_TIMEOUT_MS);
+    binlog(LOG_GPS_WAKE);
+}
+
+/**
+ * Configure NMEA output and update rate. Only settings the module has
+ * not acknowledged yet are sent; unacknowledged ones are retried on the
+ * next call.
+ */
+void gpsApplyRate(uint8_t rateHz) {
+    GpsSettings settings = {GPS_SENTENCES, static_cast<uint16_t>(1000 / (rateHz > 0 ? rateHz : 1))};
+    uint8_t pending = gpsConfigPending(gpsConfig, settings);
+    const uint8_t items[] = {GPS_CONFIG_OUTPUT, GPS_CONFIG_RATE};
+
+    for (uint8_t item : items) {
+        if (!(pending & item)) {
+            continue;
+        }
+
+        char command[GPS_CONFIG_MAX_COMMAND];
+        if (gpsConfigCommand(item, settings, command, sizeof(command)) == 0) {
+            continue;
+        }
+        GPS.sendCommand(command);
+
+        uint16_t commandId = gpsConfigCommandId(item);
+        if (gpsWaitForResponse(commandId, GPS_ACK_TIMEOUT_MS)) {
+            gpsConfigApplied(gpsConfig, item, settings);
+            if (item == GPS_CONFIG_RATE) {
+                binlog(LOG_GPS_RATE, rateHz);
+            }
+        } else {
+            binlog(LOG_GPS_NO_ACK, commandId);
+        }
+    }
+}
+
+/**
+ * Current GPS position in decimal degrees (GPS.fix must be set)
+ */
+GeoPoint gpsPosition() {
+    // Convert latitude from DDMM.MMMMM to decimal degrees
+    int lat_degrees = (int)(GPS.latitude / 100);
+    float lat_minutes = GPS.latitude - (lat_degrees * 100);
+    float lat_decimal = lat_degrees + (lat_minutes / 60.0);
+    if (GPS.lat == 'S') lat_decimal = -lat_decimal;
+    
+    // Convert longitude from DDMM.MMMMM to decimal degrees
+    int lon_degrees = (int)(GPS.longitude / 100);
+    float lon_minutes = GPS.longitude - (lon_degrees * 100);
+    float lon_decimal = lon_degrees + (lon_minutes / 60.0);
+    if (GPS.lon == 'W') lon_decimal = -lon_decimal;
+
+    GeoPoint position = {lat_decimal, lon_decimal};
+    return position;
+}
+
+/**
+ * Seconds since first boot. System time is kept by the RTC timer across
+ * deep sleep, unlike millis() which restarts on every wake.
+ */
+uint32_t wakeClockSec() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return static_cast<uint32_t>(tv.tv_sec);
 }
 
 /**
- * Store current GPS position to RTC memory for hot-start
+ * Log timestamps: milliseconds on the same clock as wakeClockSec()
+ */
+uint32_t logClockMs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return static_cast<uint32_t>(tv.tv_sec * 1000ULL + tv.tv_usec / 1000);
+}
+
+#ifdef DEBUG_SERIAL
+/**
+ * Background log drain: copies binary log records to USB serial, only
+ * while a host is connected. Runs at low priority on the other core, so
+ * the wake path never waits on the port; undrained records stay in RTC
+ * memory for the next wake.
+ */
+void logDrainTask(void* param) {
+    for (;;) {
+        const uint8_t* data;
+        size_t pending = binlogPeek(binlogState, &data);
+        size_t room = Serial ? Serial.availableForWrite() : 0;
+
+        if (pending > 0 && room > 0) {
+            size_t written = Serial.write(data, pending < room ? pending : room);
+            binlogConsume(binlogState, written);
+        } else {
+            vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_PERIOD_MS));
+        }
+    }
+}
+
+void logDrainBegin() {
+    Serial.begin(115200);
+    xTaskCreatePinnedToCore(logDrainTask, "logDrain", 2048, nullptr, 1, nullptr, 0);
+}
+
+/**
+ * Give the drain a moment to send what is pending before deep sleep.
+ * Returns immediately when no host is attached.
+ */
+void logDrainFlush() {
+    uint32_t start = millis();
+    while (Serial && binlogPending(binlogState) > 0 && millis() - start < LOG_FLUSH_TIMEOUT_MS) {
+        delay(1);
+    }
+}
+#endif
+
+/**
+ * Store current GPS position to RTC memory for hot-start,
+ * and record it in the track log for batched uplink
  */
 void storePosition(float lat, float lon) {
     lastPosition.latitude = lat;
     lastPosition.longitude = lon;
     lastPosition.timestamp = millis();
     lastPosition.hasValidFix = true;
+
+    if (trackLogReady) {
+        PositionFix fix = {degreesToE6(lat), degreesToE6(lon), wakeClockSec()};
+        trackLog.append(fix);
+    }
     
-    #ifdef DEBUG_SERIAL
-    Serial.print("Position stored: ");
-    Serial.print(lat, 6);
-    Serial.print(", ");
-    Serial.println(lon, 6);
-    #endif
+    binlog(LOG_POSITION_STORED, lat, lon);
+}
+
+/**
+ * Distance from a position to the fence, positive inside.
+ */
+float fenceDistance(const GeoPoint& position) {
+    if (boundary == nullptr) {
+        return 0.0f;
+    }
+    float distance = boundary->distanceToBoundary(position);
+    return boundary->contains(position) ? distance : -distance;
+}
+
+// ============================================
+// ALERT OUTPUT
+// ============================================
+
+/**
+ * Set up LEDC for the beeper and vibration motor, clocked so the PWM
+ * keeps running while the CPU light-sleeps between pattern steps.
+ */
+void alertOutputBegin() {
+    ledc_timer_config_t timer = {};
+    timer.speed_mode = LEDC_LOW_SPEED_MODE;
+    timer.duty_resolution = LEDC_TIMER_10_BIT;
+    timer.timer_num = LEDC_TIMER_0;
+    timer.freq_hz = 2700;
+    timer.clk_cfg = ALERT_LEDC_CLOCK;
+    ledc_timer_config(&timer);
+
+    timer.timer_num = LEDC_TIMER_1;
+    timer.freq_hz = VIBRATION_PWM_HZ;
+    ledc_timer_config(&timer);
+
+    ledc_channel_config_t channel = {};
+    channel.speed_mode = LEDC_LOW_SPEED_MODE;
+    channel.gpio_num = BEEPER_PIN;
+    channel.channel = LEDC_CHANNEL_0;
+    channel.timer_sel = LEDC_TIMER_0;
+    channel.duty = 0;
+    ledc_channel_config(&channel);
+
+    channel.gpio_num = VIBRATION_PIN;
+    channel.channel = LEDC_CHANNEL_1;
+    channel.timer_sel = LEDC_TIMER_1;
+    ledc_channel_config(&channel);
+
+    // Pins keep their PWM function, and the oscillator stays on, in light sleep
+    gpio_sleep_sel_dis(BEEPER_PIN);
+    gpio_sleep_sel_dis(VIBRATION_PIN);
+    esp_sleep_pd_config(ALERT_LEDC_PD_DOMAIN, ESP_PD_OPTION_ON);
+
+    alertOutputReady = true;
+}
+
+void alertApply(const AlertOutput& output) {
+    if (output.toneHz > 0) {
+        ledc_set_freq(LEDC_LOW_SPEED_MODE, LEDC_TIMER_0, output.toneHz);
+    }
+    ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, output.volumePercent * BEEPER_MAX_DUTY / 100);
+    ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0);
+    ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, output.vibrationPercent * ALERT_PWM_MAX_DUTY / 100);
+    ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1);
+}
+
+/**
+ * Apply the current pattern step. Called whenever the CPU wakes while a
+ * pattern plays; cheap otherwise.
+ */
+void alertService() {
+    AlertOutput output;
+    if (alertOutputReady && alertSequencerUpdate(alertState, millis(), output)) {
+        alertApply(output);
+    }
+}
+
+/**
+ * Start an alert pattern (replacing any pattern in progress)
+ */
+void alertStart(const AlertPattern* pattern) {
+    if (pattern == nullptr) {
+        return;
+    }
+    if (!alertOutputReady) {
+        alertOutputBegin();
+    }
+    alertSequencerStart(alertState, pattern, millis());
+    alertService();
+}
+
+/**
+ * Time until the alert outputs next change, in microseconds (UINT32_MAX
+ * when no pattern is playing)
+ */
+uint32_t alertNextChangeUs() {
+    uint32_t ms = alertSequencerNextChangeMs(alertState, millis());
+    return ms == ALERT_IDLE ? UINT32_MAX : ms * 1000;
+}
+
+/**
+ * Play the rest of the pattern before deep sleep, light-sleeping from
+ * one step to the next, then release the oscillator so it does not stay
+ * powered in deep sleep.
+ */
+void alertFinish() {
+    if (!alertOutputReady) {
+        return;
+    }
+    while (alertSequencerActive(alertState)) {
+        lightSleepUs(alertNextChangeUs());
+        alertService();
+    }
+    esp_sleep_pd_config(ALERT_LEDC_PD_DOMAIN, ESP_PD_OPTION_AUTO);
+}
+
+/**
+ * Feed a fix into the boundary alert state machine.
+ * Only confirmed transitions produce output: an alert pattern, and the
+ * fence state carried by the next uplink.
+ * Returns the distance to the fence, positive inside.
+ */
+float updateFenceAlert(const GeoPoint& position) {
+    if (boundary == nullptr) {
+        return 0.0f;
+    }
+
+    float signedDistance = fenceDistance(position);
+
+    FenceAlertEvent event = fenceAlertUpdate(fenceAlert, FENCE_ALERT_CONFIG,
+                                             signedDistance, wakeClockSec());
+
+    binlog(LOG_FENCE_DISTANCE, signedDistance);
+    switch (event) {
+        case FenceAlertEvent::EXITED:
+            binlog(LOG_FENCE_EXITED);
+            break;
+        case FenceAlertEvent::ESCALATED:
+            binlog(LOG_FENCE_ESCALATED, fenceAlert.escalationLevel);
+            break;
+        case FenceAlertEvent::RETURNED:
+            binlog(LOG_FENCE_RETURNED);
+            break;
+        case FenceAlertEvent::NONE:
+            binlog(fenceAlertIsOutside(fenceAlert) ? LOG_FENCE_OUTSIDE : LOG_FENCE_INSIDE);
+            break;
+    }
+
+    // Beeps play from LEDC while the rest of the wake continues
+    alertStart(alertPatternFor(event, fenceAlert.escalationLevel));
+
+    return signedDistance;
+}
+
+// ============================================
+// GEOFENCE MANAGEMENT
+// ============================================
+
+/**
+ * (Re)build the geofence polygon from the active fence source.
+ * The fence partition is used when one of its slots holds the version
+ * recorded in NVS (or, if no fence was ever received over the air, when
+ * the host flashed one into slot 0). Vertices are read in place, nothing
+ * is copied.
+ *
+ * Fences are validated when they are set and the verdict is kept in NVS
+ * with the store and CRC of the fence it describes. This only validates a
+ * fence the cached verdict is not about (one from older firmware, a
+ * partition flashed from the host, or the NVS fence when the partition
+ * one is missing), and then caches the new verdict.
+ * A fence that is not a simple polygon leaves the boundary disabled.
+ */
+void loadBoundary() {
+    uint32_t version = configManager.getFenceVersion();
+    FenceSource source;
+    uint32_t crc;
+
+    if (fenceStore.selectFence(version)) {
+        fenceVertices = fenceStore.getVertices();
+        fenceVertexCount = fenceStore.getVertexCount();
+        source = FenceSource::PARTITION;
+        crc = fenceStore.getCrc();
+        binlog(LOG_FENCE_LOADED, fenceVertexCount);
+    } else {
+        const Config& cfg = configManager.getConfig();
+        fenceVertices = cfg.boundaryVertices;
+        fenceVertexCount = cfg.boundaryVertexCount;
+        source = FenceSource::NVS;
+        crc = configManager.getBoundaryCrc();
+    }
+
+    FenceVerdict verdict = configManager.getFenceVerdict(source, crc);
+    if (verdict == FenceVerdict::UNCHECKED) {
+        verdict = fenceValidate(fenceVertices, fenceVertexCount).verdict;
+        // Out of memory says nothing about the fence: try again next boot
+        if (verdict != FenceVerdict::NO_MEMORY) {
+            configManager.setFenceVerdict(verdict, source, crc);
+            configManager.save();
+        }
+    }
+
+    delete boundary;
+    boundary = nullptr;
+    if (fenceVerdictUsable(verdict) || verdict == FenceVerdict::NO_MEMORY) {
+        boundary = new Polygon(fenceVertices, fenceVertexCount);
+    } else {
+        binlog(LOG_FENCE_INVALID, static_cast<uint8_t>(verdict));
+    }
+}
+
+/**
+ * Write a fence too large for NVS to the fence partition, validated and
+ * repaired like setBoundaryVertices() does for NVS, and cache its verdict.
+ */
+bool writeFenceStore(const GeoPoint* vertices, size_t count, uint32_t version) {
+    GeoPoint* repaired = new (std::nothrow) GeoPoint[count];
+    if (repaired == nullptr) {
+        return false;
+    }
+    memcpy(repaired, vertices, count * sizeof(GeoPoint));
+
+    FenceValidation validation = fenceValidateRepair(repaired, count);
+    bool ok = false;
+    if (!fenceVerdictUsable(validation.verdict)) {
+        binlog(LOG_BOUNDARY_REJECTED, static_cast<uint8_t>(validation.verdict));
+    } else {
+        if (validation.verdict == FenceVerdict::REPAIRED) {
+            binlog(LOG_BOUNDARY_REPAIRED, validation.removed, validation.reversed);
+        }
+        ok = fenceStore.write(repaired, count, version);
+    }
+    delete[] repaired;
+
+    if (ok) {
+        // The written slot is selected now
+        configManager.setFenceVerdict(validation.verdict, FenceSource::PARTITION, fenceStore.getCrc());
+    }
+    return ok;
+}
+
+/**
+ * Applies completed fence updates. Fences that fit go to NVS, larger ones
+ * to the fence partition, both validated and repaired on the way; a fence
+ * that is not a simple polygon is rejected.
+ *
+ * Neither store overwrites the active fence: the partition stages into its
+ * other slot and ConfigManager into its other record, each read back and
+ * CRC-checked. Flipping ConfigManager's record slot, which carries the new
+ * version, is the commit point. Until then the previous fence stays active,
+ * after a reboot too, and a failed commit rolls the config back to it.
+ */
+class CollarFenceTarget : public FenceUpdateTarget {
+public:
+    uint32_t currentVersion() const override {
+        return configManager.getFenceVersion();
+    }
+
+    const GeoPoint* currentVertices() const override {
+        return fenceVertices;
+    }
+
+    size_t currentVertexCount() const override {
+        return fenceVertexCount;
+    }
+
+    bool commit(const GeoPoint* vertices, size_t count, uint32_t version) override {
+        bool ok;
+        if (count <= MAX_BOUNDARY_VERTICES) {
+            ok = configManager.setBoundaryVertices(vertices, count);
+        } else {
+            ok = writeFenceStore(vertices, count, version);
+        }
+
+        if (ok) {
+            configManager.setFenceVersion(version);
+            ok = configManager.save();
+        }
+        if (!ok) {
+            // Back to the fence and version NVS still holds
+            configManager.load();
+        }
+
+        // Vertex storage may have moved or been unmapped either way
+        loadBoundary();
+
+        binlog(ok ? LOG_FENCE_UPDATED : LOG_FENCE_UPDATE_FAILED, version);
+        return ok;
+    }
+};
+
+CollarFenceTarget fenceUpdateTarget;
+FenceUpdateReceiver fenceUpdate(fenceUpdateState, fenceUpdateTarget);
+
+// ============================================
+// RADIO
+// ============================================
+
+/**
+ * Bring up the radio once per wake. It sleeps (registers kept) between
+ * wakes, so this is only a reset and a few register writes.
+ */
+bool radioBegin() {
+    if (!radioReady) {
+        SPI.begin();
+        radioReady = radio.begin(RADIO_FREQUENCY_HZ, RADIO_TX_POWER_DBM);
+        if (!radioReady) {
+            binlog(LOG_RADIO_NOT_FOUND);
+        }
+    }
+    return radioReady;
+}
+
+/**
+ * Fence state for the uplink header
+ */
+PacketFenceState packetFenceState() {
+    if (boundary == nullptr || !lastPosition.hasValidFix) {
+        return PacketFenceState::UNKNOWN;
+    }
+    if (!fenceAlertIsOutside(fenceAlert)) {
+        return PacketFenceState::INSIDE;
+    }
+    return fenceAlert.escalationLevel > 1 ? PacketFenceState::ALERT : PacketFenceState::OUTSIDE;
+}
+
+/**
+ * Queue the oldest pending track fixes as one position packet. Returns as
+ * soon as the radio is transmitting; the airtime overlaps with the rest
+ * of the wake (GPS standby, log flush) and ends in radioFinish().
+ *
+ * There is no uplink ACK yet: fixes count as delivered once radioFinish()
+ * has seen the frame go out. The wake clock restarts after a reboot, so a
+ * batch ends at the first fix older than the one before it; the rest goes
+ * out in the next packet.
+ */
+bool uplinkTrackBatch() {
+    if (!trackLogReady || trackLog.pendingCount() < TRACK_UPLINK_BATCH || !radioBegin()) {
+        return false;
+    }
+
+    TrackEntry entries[POSITION_PACKET_MAX_FIXES];
+    size_t count = trackLog.readPending(entries, POSITION_PACKET_MAX_FIXES);
+    if (count == 0) {
+        return false;
+    }
+    for (size_t i = 1; i < count; i++) {
+        if (entries[i].fix.timestamp < entries[i - 1].fix.timestamp) {
+            count = i;
+            break;
+        }
+    }
+
+    PositionPacket packet = {};
+    packet.sequence = uplinkSequence & POSITION_SEQUENCE_MASK;
+    packet.fenceState = packetFenceState();
+    packet.battery = 0;  // Not measured yet
+    packet.fixCount = static_cast<uint8_t>(count);
+    for (size_t i = 0; i < count; i++) {
+        packet.fixes[i] = entries[i].fix;
+    }
+
+    uint8_t frame[POSITION_PACKET_MAX_SIZE];
+    size_t length = positionPacketEncode(packet, frame, sizeof(frame));
+    if (length == 0 || !radio.send(frame, length)) {
+        return false;
+    }
+
+    uplinkSequence++;
+    radioUsed = true;
+    uplinkAckPending = true;
+    uplinkAckSeq = entries[count - 1].seq;
+    binlog(LOG_TRACK_UPLINK, count, length, loraAirtimeUs(RADIO_MODEM_CONFIG, length) / 1000);
+    return true;
+}
+
+/**
+ * Light-sleep for up to timeoutUs while waiting on the radio, waking
+ * early for the next alert pattern step.
+ */
+void radioIdle(uint32_t timeoutUs) {
+    uint32_t alertUs = alertNextChangeUs();
+    lightSleepUs(alertUs < timeoutUs ? alertUs : timeoutUs);
+    alertService();
+}
+
+/**
+ * Let queued frames finish. The CPU light-sleeps for the computed
+ * airtime; DIO0 then marks each frame done.
+ */
+void radioWaitForTx() {
+    uint32_t limitMs = radio.remainingAirtimeUs() / 1000 + RADIO_TX_MARGIN_MS;
+    uint32_t startTime = millis();
+
+    radio.poll();
+    while (radio.isTransmitting() && millis() - startTime < limitMs) {
+        uint32_t remainingUs = radio.remainingAirtimeUs();
+        radioIdle(remainingUs > 1000 ? remainingUs : 1000);
+        radio.poll();
+    }
+}
+
+/**
+ * Finish a radio exchange before deep sleep: wait out the uplink, then
+ * listen briefly for downlinks (fence updates) and answer them. The
+ * radio sleeps afterwards.
+ */
+void radioFinish() {
+    if (!radioUsed) {
+        return;
+    }
+
+    radioWaitForTx();
+
+    // A frame still queued when the wait timed out was never sent; its
+    // fixes stay pending for the next uplink
+    if (uplinkAckPending && !radio.isTransmitting()) {
+        trackLog.acknowledge(uplinkAckSeq);
+    }
+    uplinkAckPending = false;
+
+    radio.listen(true);
+
+    uint8_t frame[RADIO_MAX_FRAME];
+    uint8_t reply[FENCE_MSG_STATUS_SIZE];
+    uint32_t windowStart = millis();
+
+    while (millis() - windowStart < RADIO_RX_WINDOW_MS) {
+        radioIdle(RADIO_RX_SLICE_US);
+        radio.poll();
+
+        size_t length;
+        while ((length = radio.receive(frame, sizeof(frame))) > 0) {
+            binlog(LOG_RADIO_DOWNLINK, length);
+            size_t replyLength = fenceUpdate.handle(frame, length, reply, sizeof(reply));
+            if (replyLength > 0) {
+                radio.send(reply, replyLength);
+                radioWaitForTx();
+            }
+            windowStart = millis();
+        }
+    }
+
+    radio.listen(false);
+}
+
+// ============================================
+// WAKE GATING
+// ============================================
+
+#ifdef HAVE_WAKE_STUB
+/**
+ * Deep sleep wake stub, runs from RTC fast memory before the bootloader.
+ * Spends one unit of the skip budget and goes back to sleep without
+ * booting. Only timer wakes are skipped; any other wake source boots,
+ * and a motion wake cancels what is left of the budget.
+ */
+void RTC_IRAM_ATTR esp_wake_deep_sleep(void) {
+    uint32_t cause = esp_wake_stub_get_wakeup_cause();
+    if (cause & RTC_EXT0_TRIG_EN) {
+        wakeGateReportMotion(wakeGate);
+    } else if ((cause & RTC_TIMER_TRIG_EN) && wakeGateTrySkip(wakeGate)) {
+        // The stub sleeps again with the wake sources already armed,
+        // including wake-on-motion
+        esp_wake_stub_set_wakeup_time(GPS_UPDATE_INTERVAL_SEC * 1000000ULL);
+        esp_wake_stub_sleep(&esp_wake_deep_sleep);
+    }
+    esp_default_wake_deep_sleep();
+}
+#endif
+
+/**
+ * Plan how many of the next wakes can be skipped. Only a calm, confirmed
+ * inside state with a current position earns a budget.
+ */
+void planWakeGate(bool havePosition, float insideDistanceM) {
+    bool allowSkip = havePosition &&
+                     fenceAlert.state == FenceAlertState::INSIDE &&
+                     !fenceUpdate.isReceiving();
+
+    if (wakeGate.skippedWakes > 0) {
+        binlog(LOG_WAKES_SKIPPED, wakeGate.skippedWakes);
+    }
+
+    uint16_t budget = wakeGatePlan(wakeGate, WAKE_GATE_CONFIG, insideDistanceM, allowSkip);
+    binlog(LOG_WAKE_BUDGET, budget);
+}
+
+// ============================================
+// MOTION GATING
+// ============================================
+
+/**
+ * Bring up the optional IMU. Wake-on-motion and the FIFO are configured
+ * once; across deep sleep the IMU keeps running on its own. A wake after
+ * a failed (or never attempted) configuration tries again.
+ */
+void imuBegin() {
+    if (!imu.begin()) {
+        imuConfigured = false;
+        return;
+    }
+    if (!imuConfigured) {
+        imuConfigured = imu.enableWakeOnMotion(IMU_WOM_THRESHOLD_MG, IMU_SAMPLE_RATE_HZ) &&
+                        imu.enableFifo();
+    }
+    imuReady = imuConfigured;
+}
+
+/**
+ * Drain the samples the IMU recorded while asleep into the motion score
+ * and the activity classifier.
+ */
+void processImu(esp_sleep_wakeup_cause_t wakeCause) {
+    if (!imuReady) {
+        return;
+    }
+
+    uint32_t now = wakeClockSec();
+
+    // Reading the status also releases the latched INT1 line
+    if (imu.takeMotionInterrupt() || wakeCause == ESP_SLEEP_WAKEUP_EXT0) {
+        motionGateAddEvent(motionGate, MOTION_GATE_CONFIG, now);
+    }
+
+    // The FIFO already holds the last ~0.85 s; fall back to a live burst
+    // if it is empty (e.g. right after a cold boot)
+    MotionSample samples[IMU_FIFO_SAMPLES];
+    size_t count = imu.readFifo(samples, IMU_FIFO_SAMPLES);
+    if (count == 0) {
+        count = imu.readAccelBurst(samples, IMU_BURST_SAMPLES);
+    }
+    motionGateAddSamples(motionGate, MOTION_GATE_CONFIG, samples, count, now);
+
+    activity.beginStream();
+    if (activity.process(samples, count, now) > 0) {
+        const ActivityWindow& window = activity.lastWindow();
+        binlog(LOG_ACTIVITY, static_cast<uint8_t>(window.activity), window.energy, window.crossings);
+    }
+}
+
+/**
+ * Decide whether this wake needs a GPS fix. Without an IMU (or without
+ * any previous fix) a fix is always acquired.
+ */
+bool motionNeedsFix() {
+    if (!imuReady || !lastPosition.hasValidFix) {
+        return true;
+    }
+
+    uint32_t now = wakeClockSec();
+    bool needFix = motionGateDecide(motionGate, MOTION_GATE_CONFIG, now) == MotionGateDecision::ACQUIRE;
+
+    binlog(needFix ? LOG_MOTION_ACQUIRE : LOG_MOTION_STATIONARY, motionGate.score);
+
+    return needFix;
+}
+
+/**
+ * Arm the deep sleep wake sources: the wake interval timer and, if it was
+ * set up, wake-on-motion from the IMU.
+ */
+void armWakeSources(bool motionWake) {
+    esp_sleep_enable_timer_wakeup(GPS_UPDATE_INTERVAL_SEC * 1000000ULL);
+
+    // Motion wakes the collar early
+    if (motionWake) {
+        esp_sleep_enable_ext0_wakeup(IMU_INT_PIN, 1);
+    }
 }
 
 /**
  * Enter deep sleep for configured interval
  */
 void enterDeepSleep() {
-    #ifdef DEBUG_SERIAL
-    Serial.print("Entering deep sleep for ");
-    Serial.print(GPS_UPDATE_INTERVAL_SEC);
-    Serial.println(" seconds...");
-    #endif
+    binlog(LOG_DEEP_SLEEP, GPS_UPDATE_INTERVAL_SEC);
     
-    // Put GPS to sleep before ESP32 sleeps
-    gpsSleep();
+    // Put GPS to sleep before ESP32 sleeps (left in standby if never woken)
+    if (gpsAwake) {
+        gpsSleep();
+    }
+
+    // Any uplink has been on air since it was queued; finish it (light
+    // sleep) before the deep sleep wake sources are set up
+    radioFinish();
+
+    // Let an alert pattern play out (light sleep between steps)
+    alertFinish();
     
-    // Configure timer wakeup
-    esp_sleep_enable_timer_wakeup(GPS_UPDATE_INTERVAL_SEC * 1000000ULL);
+    // Configure timer and motion wakeup
+    imuWakeArmed = imuReady;
+    armWakeSources(imuWakeArmed);
+
+    #ifdef DEBUG_SERIAL
+    logDrainFlush();
+    #endif
     
     // Enter deep sleep
     esp_deep_sleep_start();
 }
 
 /**
- * Wait for GPS fix with timeout
- * Returns true if fix acquired, false if timeout
+ * Search for a fix under the acquisition policy: stop as soon as a fix is
+ * good enough for the distance to the fence. At the (learned) timeout the
+ * latest fix is used even if it is rough. Records the outcome, which
+ * drives the next timeout and the failure backoff.
+ *
+ * @param fenceDistanceM Expected distance to the fence, 0 if unknown.
+ * @return true if any fix was obtained.
  */
-bool waitForGpsFix(uint32_t timeoutMs) {
+bool acquireGpsFix(float fenceDistanceM) {
+    uint32_t timeoutMs = fixPolicyTimeoutMs(fixPolicy, FIX_POLICY_CONFIG);
     uint32_t startTime = millis();
-    
+    FixSearch search = {};
+
     while (millis() - startTime < timeoutMs) {
-        char c = GPS.read();
+        GPS.read();
+        if (!GPS.newNMEAreceived() || !GPS.parse(GPS.lastNMEA()) || !GPS.fix) {
+            continue;
+        }
+        if (fixPolicySearchAddFix(search, FIX_POLICY_CONFIG, millis() - startTime,
+                                  GPS.HDOP, GPS.satellites, fenceDistanceM)) {
+            break;
+        }
+    }
+
+    // The time to first fix is learned, not the time spent waiting for a
+    // good one
+    fixPolicyRecordSearch(fixPolicy, FIX_POLICY_CONFIG, search);
+    if (search.sawFix) {
+        binlog(LOG_FIX_QUALITY, millis() - startTime, GPS.HDOP, GPS.satellites);
+    } else {
+        binlog(LOG_FIX_TIMEOUT, timeoutMs, fixPolicy.backoffWakes);
+    }
+    return search.sawFix;
+}
+
+// ============================================
+// GPS BURST MODE
+// ============================================
+
+/**
+ * A parsed fix, handed from the GPS task to the main task
+ */
+struct GpsSample {
+    GeoPoint position;
+    float hdop;
+    uint8_t satellites;
+};
+
+// Core 0 (GPS task) pushes, core 1 (main task) pops
+SpscQueue<GpsSample, GPS_PIPELINE_DEPTH> gpsSamples;
+std::atomic<bool> gpsPipelineRunning(false);
+TaskHandle_t gpsPipelineConsumer = nullptr;
+SemaphoreHandle_t gpsPipelineStopped = nullptr;
+uint32_t gpsPipelineDropped = 0;  // Written by the GPS task, read after it stops
+
+/**
+ * GPS task (core 0): reads and parses NMEA and queues a sample for every
+ * RMC sentence with a fix. While it runs it owns the GPS; it must not
+ * log, since the binary log has a single producer (the main task).
+ */
+void gpsParseTask(void* param) {
+    uint32_t bytesRead = 0;
+
+    while (gpsPipelineRunning.load(std::memory_order_acquire)) {
+        GPS.read();
         if (GPS.newNMEAreceived()) {
-            if (!GPS.parse(GPS.lastNMEA())) {
-                continue;
+            char* sentence = GPS.lastNMEA();
+            bool parsed = GPS.parse(sentence);
+
+            // RMC closes the epoch: GGA (HDOP, satellites) is already parsed
+            if (parsed && GPS.fix && strstr(sentence, "RMC,") != nullptr) {
+                GpsSample sample = {gpsPosition(), GPS.HDOP, GPS.satellites};
+                if (gpsSamples.push(sample)) {
+                    xTaskNotifyGive(gpsPipelineConsumer);
+                } else {
+                    gpsPipelineDropped++;
+                }
             }
-            if (GPS.fix) {
-                return true;
+        }
+
+        // Leave room for the idle task (task watchdog)
+        if (++bytesRead >= GPS_PARSE_YIELD_BYTES) {
+            bytesRead = 0;
+            vTaskDelay(1);
+        }
+    }
+
+    xSemaphoreGive(gpsPipelineStopped);
+    vTaskDelete(nullptr);
+}
+
+/**
+ * Start the GPS task on core 0. The caller becomes the consumer.
+ */
+bool gpsPipelineStart() {
+    if (gpsPipelineStopped == nullptr) {
+        gpsPipelineStopped = xSemaphoreCreateBinary();
+        if (gpsPipelineStopped == nullptr) {
+            return false;
+        }
+    }
+
+    // Discard samples left from an earlier burst
+    GpsSample stale;
+    while (gpsSamples.pop(stale)) {
+    }
+    gpsPipelineConsumer = xTaskGetCurrentTaskHandle();
+    gpsPipelineDropped = 0;
+    ulTaskNotifyTake(pdTRUE, 0);
+
+    gpsPipelineRunning.store(true, std::memory_order_release);
+    if (xTaskCreatePinnedToCore(gpsParseTask, "gpsParse", 4096, nullptr,
+                                GPS_PARSE_TASK_PRIORITY, nullptr, 0) != pdPASS) {
+        gpsPipelineRunning.store(false, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Stop the GPS task and wait until it no longer touches the GPS
+ */
+void gpsPipelineStop() {
+    gpsPipelineRunning.store(false, std::memory_order_release);
+    xSemaphoreTake(gpsPipelineStopped, portMAX_DELAY);
+
+    if (gpsPipelineDropped > 0) {
+        binlog(LOG_GPS_PIPELINE_DROPPED, gpsPipelineDropped);
+    }
+}
+
+/**
+ * Wait for the next sample from the GPS task, sleeping (not spinning)
+ * in between. Returns false on timeout.
+ */
+bool gpsPipelineNext(GpsSample& sample, uint32_t timeoutMs) {
+    uint32_t startTime = millis();
+
+    while (!gpsSamples.pop(sample)) {
+        alertService();
+
+        uint32_t elapsed = millis() - startTime;
+        if (elapsed >= timeoutMs) {
+            return false;
+        }
+
+        // Wake up for the next alert step as well as for the next fix
+        uint32_t waitMs = timeoutMs - elapsed;
+        uint32_t alertMs = alertSequencerNextChangeMs(alertState, millis());
+        if (alertMs < waitMs) {
+            waitMs = alertMs > 0 ? alertMs : 1;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+    }
+    return true;
+}
+
+/**
+ * Stream fixes at the burst rate through the boundary alert while the dog
+ * is near the fence. Returns to 1 Hz once clear, after the burst cap, or
+ * when the fix is lost. Only the final position goes to the track log.
+ *
+ * Runs as a two-stage pipeline: the GPS task on core 0 reads and parses
+ * NMEA while this task (core 1) runs the fence check and alerts, so
+ * parsing the next fix overlaps with handling the current one.
+ *
+ * @param position       Latest fix, updated in place.
+ * @param signedDistance Its distance to the fence, updated in place.
+ * @return true if a burst ran (position changed).
+ */
+bool runGpsBurst(GeoPoint& position, float& signedDistance) {
+    if (boundary == nullptr ||
+        !gpsBurstUpdate(gpsBurst, GPS_BURST_CONFIG, signedDistance, wakeClockSec())) {
+        return false;
+    }
+
+    binlog(LOG_GPS_BURST_START, signedDistance);
+
+    // Configure before the GPS task takes over the module
+    gpsApplyRate(gpsBurstRateHz(gpsBurst, GPS_BURST_CONFIG));
+
+    uint32_t fixes = 0;
+    if (gpsPipelineStart()) {
+        GpsSample sample;
+        while (gpsBurst.active != 0) {
+            if (!gpsPipelineNext(sample, GPS_BURST_FIX_TIMEOUT_MS)) {
+                gpsBurstAbort(gpsBurst);
+                break;
             }
+
+            position = sample.position;
+            lastPosition.latitude = position.lat;
+            lastPosition.longitude = position.lon;
+            signedDistance = updateFenceAlert(position);
+            fixes++;
+
+            gpsBurstUpdate(gpsBurst, GPS_BURST_CONFIG, signedDistance, wakeClockSec());
         }
+        gpsPipelineStop();
+    } else {
+        gpsBurstAbort(gpsBurst);
     }
-    
-    return false;
+
+    gpsApplyRate(gpsBurstRateHz(gpsBurst, GPS_BURST_CONFIG));
+    binlog(LOG_GPS_BURST_END, fixes, signedDistance);
+    return true;
 }
 
 // ============================================
@@ -162,90 +1272,115 @@ bool waitForGpsFix(uint32_t timeoutMs) {
 // ============================================
 
 void setup() {
+    esp_sleep_wakeup_cause_t wakeCause = esp_sleep_get_wakeup_cause();
+
+    // Uneventful timer wake the wake stub did not handle: back to sleep
+    // before touching any peripheral (GPS is still in standby, the IMU
+    // still armed)
+    if (wakeCause == ESP_SLEEP_WAKEUP_TIMER && wakeGateTrySkip(wakeGate)) {
+        armWakeSources(imuWakeArmed);
+        esp_deep_sleep_start();
+    }
+
+    // Motion cancels the rest of the skip budget (the wake stub does the
+    // same where there is one)
+    if (wakeCause == ESP_SLEEP_WAKEUP_EXT0) {
+        wakeGateReportMotion(wakeGate);
+    }
+
+    // Records from earlier wakes are kept until drained
+    binlogInit(binlogState);
+    binlogAttach(&binlogState, logClockMs);
+    binlog(LOG_BOOT, static_cast<uint32_t>(wakeCause));
+
     #ifdef DEBUG_SERIAL
-    // Initialize serial port for debugging
-    Serial.begin(115200);
-    Serial.println("Uncollar GPS Collar - Power Optimized");
+    logDrainBegin();
     #endif
 
     // Initialize configuration from NVS (or defaults on first boot)
     if (!configManager.begin()) {
-        #ifdef DEBUG_SERIAL
-        Serial.println("Failed to initialize config manager!");
-        #endif
+        binlog(LOG_CONFIG_INIT_FAILED);
     }
     
-    // Get config values
-    const Config& cfg = configManager.getConfig();
+    // Build the geofence from the fence partition or NVS
+    fenceStore.begin(FENCE_STORE_PARTITION_LABEL);
+    loadBoundary();
     
+    // Open the track log (rescans flash only after a cold boot)
+    trackLogReady = trackLogStorage.begin(TRACK_LOG_PARTITION_LABEL) && trackLog.begin();
+    if (!trackLogReady) {
+        binlog(LOG_TRACK_LOG_UNAVAILABLE);
+    }
+
     // Initialize the I2C bus
     Wire1.begin(41, 40);
 
     // Disable unused peripherals first
     disableUnusedPeripherals();
 
+    // A stationary dog needs no new fix
+    imuBegin();
+    processImu(wakeCause);
+    bool needFix = motionNeedsFix();
+
     #ifdef DEBUG_LCD
     // Initialize the LCD
     lcd.begin(16, 2);
     lcd.backlight();
     #endif
     
-    #ifdef DEBUG_SERIAL
-    Serial.println("Initializing GPS...");
-    #endif
+    binlog(LOG_GPS_INIT);
 
     // Initialize the GPS
     GPS.begin(0x10);  // The I2C address to use is 0x10
-    
-    // Use RMC only for efficient latitude/longitude data
-    GPS.sendCommand(PMTK_SET_NMEA_OUTPUT_RMCONLY);
-    
-    // Set the update rate to 1 Hz
-    GPS.sendCommand(PMTK_SET_NMEA_UPDATE_1HZ);
 
-    // Wake GPS from any previous sleep
-    gpsWake();
-    
-    delay(100); // Give GPS time to respond
+    // After repeated failures, some wakes skip the search entirely
+    bool gotFix = false;
+    if (needFix && !fixPolicyShouldAttempt(fixPolicy)) {
+        binlog(LOG_FIX_BACKOFF, fixPolicy.backoffWakes);
+    } else if (needFix) {
+        // Wake GPS from standby; it keeps its settings there, so only
+        // changes are sent (1 Hz unless a burst was interrupted by a reset)
+        gpsWake();
+        gpsApplyRate(gpsBurstRateHz(gpsBurst, GPS_BURST_CONFIG));
 
-    #ifdef DEBUG_LCD
-    lcd.setCursor(0, 0);
-    lcd.print("Acquiring GPS...");
-    #endif
-   
-    #ifdef DEBUG_SERIAL
-    Serial.println("Waiting for GPS fix...");
-    #endif
+        #ifdef DEBUG_LCD
+        lcd.setCursor(0, 0);
+        lcd.print("Acquiring GPS...");
+        #endif
+       
+        binlog(LOG_GPS_WAITING);
 
-    // Wait for GPS fix with timeout
-    bool gotFix = waitForGpsFix(GPS_FIX_TIMEOUT_SEC * 1000);
+        // Wait for a fix good enough near the last known position
+        float expectedDistance = 0.0f;
+        if (lastPosition.hasValidFix) {
+            GeoPoint lastPos = {lastPosition.latitude, lastPosition.longitude};
+            expectedDistance = fenceDistance(lastPos);
+        }
+        gotFix = acquireGpsFix(expectedDistance);
+    }
     
     if (gotFix && GPS.fix) {
-        // Convert latitude from DDMM.MMMMM to decimal degrees
-        int lat_degrees = (int)(GPS.latitude / 100);
-        float lat_minutes = GPS.latitude - (lat_degrees * 100);
-        float lat_decimal = lat_degrees + (lat_minutes / 60.0);
-        if (GPS.lat == 'S') lat_decimal = -lat_decimal;
-        
-        // Convert longitude from DDMM.MMMMM to decimal degrees
-        int lon_degrees = (int)(GPS.longitude / 100);
-        float lon_minutes = GPS.longitude - (lon_degrees * 100);
-        float lon_decimal = lon_degrees + (lon_minutes / 60.0);
-        if (GPS.lon == 'W') lon_decimal = -lon_decimal;
+        GeoPoint currentPos = gpsPosition();
+        float lat_decimal = currentPos.lat;
+        float lon_decimal = currentPos.lon;
         
         // Store position for next hot-start
         storePosition(lat_decimal, lon_decimal);
+        motionGateFixAcquired(motionGate, wakeClockSec());
         
-        // Check if inside geofence boundary
-        GeoPoint currentPos = {lat_decimal, lon_decimal};
-        if (boundary != nullptr && boundary->contains(currentPos)) {
-            #ifdef DEBUG_SERIAL
-            Serial.println("Inside bounds");
-            #endif
-        } else {
-            #ifdef DEBUG_SERIAL
-            Serial.println("Outside bounds");
-            #endif
+        // Run the fix through the boundary alert state machine
+        float fenceDistance = updateFenceAlert(currentPos);
+
+        // Near the fence: stay awake and stream fixes until clear
+        if (runGpsBurst(currentPos, fenceDistance)) {
+            storePosition(currentPos.lat, currentPos.lon);
+        }
+        planWakeGate(true, fenceDistance);
+
+        // On air while the rest of the wake continues
+        if (!uplinkTrackBatch() && trackLogReady && trackLog.pendingCount() >= TRACK_UPLINK_BATCH) {
+            binlog(LOG_TRACK_BATCH_READY, trackLog.pendingCount());
         }
         
         #ifdef DEBUG_LCD
@@ -256,15 +1391,13 @@ void setup() {
         lcd.print(lon_decimal, 4);
         #endif
         
-        #ifdef DEBUG_SERIAL
-        Serial.print("Latitude: ");
-        Serial.print(lat_decimal, 6);
-        Serial.println(GPS.lat);
-        Serial.print("Longitude: ");
-        Serial.print(lon_decimal, 6);
-        Serial.println(GPS.lon);
-        Serial.println("Fix acquired!");
-        #endif
+        binlog(LOG_FIX_ACQUIRED, lat_decimal, lon_decimal);
+    } else if (!needFix) {
+        binlog(LOG_REUSING_POSITION);
+
+        // The dog has not moved, so the fence state cannot have changed
+        GeoPoint lastPos = {lastPosition.latitude, lastPosition.longitude};
+        planWakeGate(true, fenceDistance(lastPos));
     } else {
         #ifdef DEBUG_LCD
         lcd.clear();
@@ -274,21 +1407,13 @@ void setup() {
         lcd.print("last position");
         #endif
         
-        #ifdef DEBUG_SERIAL
-        Serial.println("No GPS fix - using last known position");
-        Serial.print("Last position: ");
-        Serial.print(lastPosition.latitude, 6);
-        Serial.print(", ");
-        Serial.println(lastPosition.longitude, 6);
-        
-        // Check if last known position is inside geofence boundary
-        GeoPoint lastPos = {lastPosition.latitude, lastPosition.longitude};
-        if (boundary != nullptr && boundary->contains(lastPos)) {
-            Serial.println("Inside bounds");
-        } else {
-            Serial.println("Outside bounds");
-        }
-        #endif
+        binlog(LOG_NO_FIX, lastPosition.latitude, lastPosition.longitude);
+
+        // A stale position must not confirm a crossing; report the current state
+        binlog(fenceAlertIsOutside(fenceAlert) ? LOG_FENCE_OUTSIDE : LOG_FENCE_INSIDE);
+
+        // Without a fresh fix the next wake must boot
+        planWakeGate(false, 0.0f);
     }
 
     // Enter deep sleep cycle
@@ -303,9 +1428,7 @@ void setup() {
 void loop() {
     // This should never be executed
     // ESP32 wakes from deep sleep and runs setup() again
-    #ifdef DEBUG_SERIAL
-    Serial.println("ERROR: Loop executed - this should not happen!");
-    #endif
+    binlog(LOG_LOOP_REACHED);
     
     // Emergency: re-enter deep sleep
     enterDeepSleep();
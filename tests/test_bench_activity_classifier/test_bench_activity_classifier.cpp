@@ -0,0 +1,97 @@
+/**
+ * @file test_bench_activity_classifier.cpp
+ * @brief Throughput benchmark for the activity classifier (portable path).
+ *
+ * Run with: pio test -e native_bench
+ *
+ * Classifies one hour of 100 Hz data in FIFO-sized blocks, as the collar
+ * would across wakes, and reports the cost per sample. The budget is
+ * loose: it only catches accidental algorithmic regressions on the host.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "activity_classifier.h"
+
+// ============================================================================
+// Benchmark Data
+// ============================================================================
+
+static const size_t FIFO_SAMPLES = 85;  // 512-byte FIFO / 6 bytes per sample
+static const size_t HOUR_SAMPLES = 3600UL * ACTIVITY_SAMPLE_RATE_HZ;
+
+// Host budget per sample; the ESP32-S3 is ~50x slower than a desktop core
+static const double BUDGET_NS_PER_SAMPLE = 500.0;
+
+ActivityState state;
+MotionSample block[FIFO_SAMPLES];
+
+static void fillBlock(uint32_t seed) {
+    // Cheap deterministic gait-like signal with noise
+    for (size_t i = 0; i < FIFO_SAMPLES; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        int16_t noise = static_cast<int16_t>((seed >> 24) & 0x1F) - 16;
+        int16_t phase = static_cast<int16_t>((i * 8) % 50) - 25;
+        block[i].x = static_cast<int16_t>(100 + noise);
+        block[i].y = static_cast<int16_t>(-50 + 4 * phase);
+        block[i].z = static_cast<int16_t>(1000 + 12 * phase + noise);
+    }
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+void bench_classifier_throughput(void) {
+    ActivityClassifier classifier(state);
+    fillBlock(1);
+
+    size_t windows = 0;
+    size_t samples = 0;
+    uint32_t now = 1;
+
+    auto start = std::chrono::steady_clock::now();
+    while (samples < HOUR_SAMPLES) {
+        classifier.beginStream();
+        windows += classifier.process(block, FIFO_SAMPLES, now);
+        samples += FIFO_SAMPLES;
+        now += 5;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    double ns = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    double nsPerSample = ns / static_cast<double>(samples);
+
+    char message[96];
+    snprintf(message, sizeof(message), "%.1f ns/sample, %lu windows, %.1f us per wake block",
+             nsPerSample, (unsigned long)windows, nsPerSample * FIFO_SAMPLES / 1e3);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_TRUE(windows > 0);
+    TEST_ASSERT_TRUE(nsPerSample < BUDGET_NS_PER_SAMPLE);
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    memset(&state, 0, sizeof(state));
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_classifier_throughput);
+
+    return UNITY_END();
+}
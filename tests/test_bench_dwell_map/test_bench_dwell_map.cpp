@@ -0,0 +1,169 @@
+/**
+ * @file test_bench_dwell_map.cpp
+ * @brief Update and query benchmark for the incremental dwell map.
+ *
+ * Run with: pio test -e native_bench
+ *
+ * A week of 5 s fixes for 50 collars, each wandering around its yard
+ * (with two fences), added once on one thread and once split into four
+ * stretches on four threads and merged. Reported: cost per fix, tiles
+ * held, merge time and heatmap reads at fine and coarse zoom. The budget
+ * is loose: it catches per-fix work growing with the history.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "dwell_map.h"
+
+// ============================================================================
+// Benchmark Data
+// ============================================================================
+
+static const uint32_t COLLARS = 50;
+static const uint32_t FIXES_PER_COLLAR = 7 * 24 * 720;
+static const size_t THREADS = 4;
+
+// Host budget per added fix
+static const double BUDGET_NS_PER_FIX = 500.0;
+
+static const GeoPoint YARD[] = {
+    {40.7000f, -74.0010f}, {40.7000f, -74.0000f}, {40.7010f, -74.0000f}, {40.7010f, -74.0010f}
+};
+static const GeoPoint PADDOCK[] = {
+    {40.7004f, -74.0003f}, {40.7004f, -73.9995f}, {40.7008f, -73.9995f}, {40.7008f, -74.0003f}
+};
+static const Polygon FENCES[] = {Polygon(YARD, 4), Polygon(PADDOCK, 4)};
+
+// A collar's week: a walk pulled back toward the yard centre
+static std::vector<PositionFix> makeTrack(uint32_t collar) {
+    std::vector<PositionFix> fixes;
+    fixes.reserve(FIXES_PER_COLLAR);
+    uint32_t seed = collar * 7919 + 1;
+    int32_t lat = 40700500;
+    int32_t lon = -74000500;
+    for (uint32_t i = 0; i < FIXES_PER_COLLAR; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        lat += static_cast<int32_t>((seed >> 8) % 41) - 20 + (40700500 - lat) / 200;
+        lon += static_cast<int32_t>((seed >> 16) % 61) - 30 + (-74000500 - lon) / 200;
+        PositionFix fix = {lat, lon, 1700000000 + i * 5};
+        fixes.push_back(fix);
+    }
+    return fixes;
+}
+
+static double nsSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+void bench_week_of_fleet_fixes(void) {
+    std::vector<std::vector<PositionFix> > tracks;
+    for (uint32_t c = 0; c < COLLARS; c++) {
+        tracks.push_back(makeTrack(c));
+    }
+    uint64_t fixes = static_cast<uint64_t>(COLLARS) * FIXES_PER_COLLAR;
+
+    // Single pass, fixes interleaved by time as they arrive
+    DwellMap single(FENCES, 2);
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < FIXES_PER_COLLAR; i++) {
+        for (uint32_t c = 0; c < COLLARS; c++) {
+            single.add(c, tracks[c][i]);
+        }
+    }
+    double nsPerFix = nsSince(start) / fixes;
+
+    // Four stretches of the week on four threads, then merged
+    std::vector<DwellMap*> parts;
+    std::vector<std::thread> threads;
+    start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < THREADS; t++) {
+        parts.push_back(new DwellMap(FENCES, 2));
+    }
+    for (size_t t = 0; t < THREADS; t++) {
+        threads.emplace_back([&, t]() {
+            uint32_t begin = static_cast<uint32_t>(FIXES_PER_COLLAR * t / THREADS);
+            uint32_t end = static_cast<uint32_t>(FIXES_PER_COLLAR * (t + 1) / THREADS);
+            for (uint32_t i = begin; i < end; i++) {
+                for (uint32_t c = 0; c < COLLARS; c++) {
+                    parts[t]->add(c, tracks[c][i]);
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double parallelMs = nsSince(start) / 1e6;
+    start = std::chrono::steady_clock::now();
+    for (size_t t = 1; t < THREADS; t++) {
+        TEST_ASSERT_TRUE(parts[0]->merge(*parts[t]));
+    }
+    double mergeMs = nsSince(start) / 1e6;
+
+    // Heatmaps of the whole yard, fine and coarse
+    std::vector<DwellHeatCell> fine;
+    std::vector<DwellHeatCell> coarse;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t c = 0; c < COLLARS; c++) {
+        fine.clear();
+        single.heatmap(c, 0, 40698000, -74003000, 40703000, -73998000, fine);
+    }
+    double fineUs = nsSince(start) / 1e3 / COLLARS;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t c = 0; c < COLLARS; c++) {
+        coarse.clear();
+        single.heatmap(c, 5, 40698000, -74003000, 40703000, -73998000, coarse);
+    }
+    double coarseUs = nsSince(start) / 1e3 / COLLARS;
+
+    char message[256];
+    snprintf(message, sizeof(message),
+             "%lu fixes: %.0f ns/fix, %lu tiles (%.1f MB); %lu threads %.0f ms + merge %.1f ms; "
+             "heatmap %lu cells in %.0f us (level 0), %lu cells in %.1f us (level 5)",
+             (unsigned long)fixes, nsPerFix, (unsigned long)single.tileCount(),
+             single.tileCount() * DWELL_TILE_SIZE * DWELL_TILE_SIZE * sizeof(DwellCell) / 1e6,
+             (unsigned long)THREADS, parallelMs, mergeMs, (unsigned long)fine.size(), fineUs,
+             (unsigned long)coarse.size(), coarseUs);
+    TEST_MESSAGE(message);
+
+    for (uint32_t c = 0; c < COLLARS; c++) {
+        TEST_ASSERT_EQUAL_UINT64(single.totals(c).seconds, parts[0]->totals(c).seconds);
+        TEST_ASSERT_EQUAL_UINT64(single.fenceSeconds(c, 1), parts[0]->fenceSeconds(c, 1));
+    }
+    TEST_ASSERT_TRUE(single.fenceSeconds(0, 0) > 0);
+    TEST_ASSERT_TRUE(nsPerFix < BUDGET_NS_PER_FIX);
+
+    for (DwellMap* part : parts) {
+        delete part;
+    }
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_week_of_fleet_fixes);
+
+    return UNITY_END();
+}
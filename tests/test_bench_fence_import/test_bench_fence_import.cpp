@@ -0,0 +1,189 @@
+/**
+ * @file test_bench_fence_import.cpp
+ * @brief Parse-throughput benchmark for the GeoJSON / KML fence importer.
+ *
+ * Run with: pio test -e native_bench
+ *
+ * A synthetic county parcel export: 15000 parcels of about 40 vertices at
+ * 7 decimals, with the property clutter real exports carry, written once
+ * as GeoJSON and once as KML and fed in 64 KB chunks as fenceImportFile()
+ * reads them. Reported: MB/s and parcels/s for each. The budget is loose:
+ * it catches a per-byte slow path, not small regressions.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "fence_import.h"
+
+// ============================================================================
+// Benchmark Data
+// ============================================================================
+
+static const uint32_t PARCELS = 15000;
+static const uint32_t VERTICES = 40;
+static const size_t CHUNK = 64 * 1024;
+
+// Host budget for either format
+static const double BUDGET_MB_PER_S = 20.0;
+
+// Parcel ring: a wobbly circle of about 100 m, clockwise as many exports are
+static void parcelRing(uint32_t parcel, std::vector<double>& lonLat) {
+    lonLat.clear();
+    double lat = 40.5 + (parcel / 150) * 0.002;
+    double lon = -74.5 + (parcel % 150) * 0.002;
+    uint32_t seed = parcel * 2654435761u + 1;
+    for (uint32_t v = 0; v < VERTICES; v++) {
+        seed = seed * 1664525u + 1013904223u;
+        double angle = -2.0 * M_PI * v / VERTICES;
+        double radius = 0.0008 + (seed >> 20) * 1e-10;
+        lonLat.push_back(lon + radius * cos(angle));
+        lonLat.push_back(lat + radius * sin(angle));
+    }
+    lonLat.push_back(lonLat[0]);
+    lonLat.push_back(lonLat[1]);
+}
+
+static std::string makeGeoJson() {
+    std::string text = "{\"type\":\"FeatureCollection\",\"name\":\"parcels\",\"features\":[\n";
+    std::vector<double> ring;
+    char buffer[256];
+    for (uint32_t p = 0; p < PARCELS; p++) {
+        parcelRing(p, ring);
+        snprintf(buffer, sizeof(buffer),
+                 "%s{\"type\":\"Feature\",\"properties\":{\"PARCEL_ID\":\"%07lu-0%03lu\","
+                 "\"OWNER\":\"Example Farms \\\"North\\\" LLC\",\"ACRES\":%.3f,\"ZONING\":\"AG-1\"},"
+                 "\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[",
+                 p == 0 ? "" : ",\n", (unsigned long)p, (unsigned long)(p % 1000), 4.9 + p % 17);
+        text += buffer;
+        for (size_t v = 0; v < ring.size(); v += 2) {
+            snprintf(buffer, sizeof(buffer), "%s[%.7f,%.7f]", v == 0 ? "" : ",", ring[v], ring[v + 1]);
+            text += buffer;
+        }
+        text += "]]}}";
+    }
+    text += "\n]}\n";
+    return text;
+}
+
+static std::string makeKml() {
+    std::string text =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document><name>parcels</name>\n";
+    std::vector<double> ring;
+    char buffer[256];
+    for (uint32_t p = 0; p < PARCELS; p++) {
+        parcelRing(p, ring);
+        snprintf(buffer, sizeof(buffer),
+                 "<Placemark><name>%07lu-0%03lu</name><ExtendedData>"
+                 "<Data name=\"ACRES\"><value>%.3f</value></Data></ExtendedData>\n"
+                 "<Polygon><outerBoundaryIs><LinearRing><coordinates>\n",
+                 (unsigned long)p, (unsigned long)(p % 1000), 4.9 + p % 17);
+        text += buffer;
+        for (size_t v = 0; v < ring.size(); v += 2) {
+            snprintf(buffer, sizeof(buffer), "%.7f,%.7f,0 ", ring[v], ring[v + 1]);
+            text += buffer;
+        }
+        text += "\n</coordinates></LinearRing></outerBoundaryIs></Polygon></Placemark>\n";
+    }
+    text += "</Document></kml>\n";
+    return text;
+}
+
+static double nsSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+// Best of a few runs; returns seconds
+static double importChunked(const std::string& text, FenceImporter*& result) {
+    double best = 1e9;
+    for (int run = 0; run < 3; run++) {
+        FenceImporter* importer = new FenceImporter();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset < text.size(); offset += CHUNK) {
+            size_t length = text.size() - offset < CHUNK ? text.size() - offset : CHUNK;
+            importer->feed(text.data() + offset, length);
+        }
+        importer->finish();
+        double seconds = nsSince(start) / 1e9;
+        if (seconds < best) {
+            best = seconds;
+        }
+        delete result;
+        result = importer;
+    }
+    return best;
+}
+
+static void checkParcels(const FenceImporter& importer) {
+    TEST_ASSERT_FALSE(importer.failed());
+    TEST_ASSERT_EQUAL_UINT32(PARCELS, importer.stats().polygons);
+    TEST_ASSERT_EQUAL_UINT32(PARCELS, importer.fences().size());
+    TEST_ASSERT_EQUAL_UINT32(PARCELS, importer.stats().reversed);
+    TEST_ASSERT_EQUAL_UINT32(VERTICES, importer.fences()[PARCELS / 2].vertices.size());
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+void bench_county_parcels_geojson(void) {
+    std::string text = makeGeoJson();
+    FenceImporter* importer = nullptr;
+    double seconds = importChunked(text, importer);
+    double mbPerS = text.size() / 1e6 / seconds;
+
+    char message[192];
+    snprintf(message, sizeof(message), "GeoJSON %.1f MB, %lu parcels: %.1f ms, %.0f MB/s, %.0f parcels/s",
+             text.size() / 1e6, (unsigned long)PARCELS, seconds * 1e3, mbPerS, PARCELS / seconds);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL(FenceImportFormat::GEOJSON, importer->format());
+    checkParcels(*importer);
+    TEST_ASSERT_TRUE(mbPerS > BUDGET_MB_PER_S);
+    delete importer;
+}
+
+void bench_county_parcels_kml(void) {
+    std::string text = makeKml();
+    FenceImporter* importer = nullptr;
+    double seconds = importChunked(text, importer);
+    double mbPerS = text.size() / 1e6 / seconds;
+
+    char message[192];
+    snprintf(message, sizeof(message), "KML %.1f MB, %lu parcels: %.1f ms, %.0f MB/s, %.0f parcels/s",
+             text.size() / 1e6, (unsigned long)PARCELS, seconds * 1e3, mbPerS, PARCELS / seconds);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL(FenceImportFormat::KML, importer->format());
+    checkParcels(*importer);
+    TEST_ASSERT_TRUE(mbPerS > BUDGET_MB_PER_S);
+    delete importer;
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_county_parcels_geojson);
+    RUN_TEST(bench_county_parcels_kml);
+
+    return UNITY_END();
+}
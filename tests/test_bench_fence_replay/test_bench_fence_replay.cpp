@@ -0,0 +1,149 @@
+/**
+ * @file test_bench_fence_replay.cpp
+ * @brief Throughput benchmark for the fence replay engine.
+ *
+ * Run with: pio test -e native_bench
+ *
+ * Replays a synthetic 100M-fix track (about three years of 1 Hz fixes)
+ * against four fences, streamed in batches as the replay tool reads a
+ * file: once on a single worker and once on every hardware thread. It
+ * reports fixes per second and the speedup; the budget is loose and only
+ * catches accidental algorithmic regressions.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "fence_replay.h"
+
+// ============================================================================
+// Benchmark Data
+// ============================================================================
+
+static const size_t TRACK_FIXES = 100000000UL;
+static const size_t BATCH_FIXES = 4UL * 1024 * 1024;
+
+// Host budget per fix and fence on one core
+static const double BUDGET_NS_PER_FIX_FENCE = 200.0;
+
+// A ~400 m yard, a paddock inside it, a neighbour's garden and a wide
+// outer boundary, around 40.7227 N, 74.0212 W
+static const GeoPoint YARD[] = {
+    {40.7245f, -74.0235f}, {40.7248f, -74.0212f}, {40.7240f, -74.0190f}, {40.7222f, -74.0186f},
+    {40.7208f, -74.0196f}, {40.7205f, -74.0220f}, {40.7212f, -74.0237f}, {40.7230f, -74.0240f}};
+static const GeoPoint PADDOCK[] = {
+    {40.7232f, -74.0220f}, {40.7232f, -74.0205f}, {40.7222f, -74.0205f}, {40.7222f, -74.0220f}};
+static const GeoPoint GARDEN[] = {
+    {40.7250f, -74.0185f}, {40.7255f, -74.0170f}, {40.7245f, -74.0165f}, {40.7240f, -74.0180f},
+    {40.7244f, -74.0184f}};
+static const GeoPoint OUTER[] = {
+    {40.7300f, -74.0300f}, {40.7310f, -74.0200f}, {40.7290f, -74.0100f}, {40.7200f, -74.0090f},
+    {40.7140f, -74.0150f}, {40.7150f, -74.0280f}};
+static const Polygon FENCES[] = {Polygon(YARD, 8), Polygon(PADDOCK, 4), Polygon(GARDEN, 5),
+                                 Polygon(OUTER, 6)};
+static const size_t FENCE_COUNT = sizeof(FENCES) / sizeof(FENCES[0]);
+
+/**
+ * Random walk pulled back towards the yard, so the track keeps crossing
+ * every fence. Deterministic: each run regenerates the same track.
+ */
+struct TrackWalker {
+    uint32_t seed = 1;
+    int32_t latE6 = 40722700;
+    int32_t lonE6 = -74021200;
+    uint32_t timestamp = 1700000000;
+
+    void fill(std::vector<PositionFix>& fixes, size_t count) {
+        fixes.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            latE6 += static_cast<int32_t>((seed >> 8) % 41) - 20 - (latE6 - 40722700) / 512;
+            lonE6 += static_cast<int32_t>((seed >> 20) % 41) - 20 - (lonE6 + 74021200) / 512;
+            timestamp++;
+            PositionFix fix = {latE6, lonE6, timestamp};
+            fixes[i] = fix;
+        }
+    }
+};
+
+struct ReplayRun {
+    double seconds;
+    size_t events;
+    uint64_t exits;
+};
+
+// Only the replay is timed, not generating the track
+static ReplayRun runReplay(size_t threads) {
+    WorkStealingPool pool(threads);
+    FenceReplay replay(FENCES, FENCE_COUNT);
+    TrackWalker walker;
+    std::vector<PositionFix> batch;
+    std::vector<FenceCrossingEvent> events;
+    ReplayRun run = {0.0, 0, 0};
+
+    for (size_t done = 0; done < TRACK_FIXES; done += batch.size()) {
+        walker.fill(batch, TRACK_FIXES - done < BATCH_FIXES ? TRACK_FIXES - done : BATCH_FIXES);
+        events.clear();
+
+        auto start = std::chrono::steady_clock::now();
+        replay.replay(pool, batch.data(), batch.size(), &events);
+        run.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        run.events += events.size();
+    }
+    replay.finish();
+
+    for (size_t f = 0; f < FENCE_COUNT; f++) {
+        run.exits += replay.stats(f).exits;
+    }
+    return run;
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+void bench_replay_throughput(void) {
+    size_t threads = WorkStealingPool::defaultThreads();
+    ReplayRun single = runReplay(1);
+    ReplayRun parallel = threads > 1 ? runReplay(threads) : single;
+
+    double nsPerFixFence = single.seconds * 1e9 / (static_cast<double>(TRACK_FIXES) * FENCE_COUNT);
+    double speedup = single.seconds / parallel.seconds;
+
+    char message[160];
+    snprintf(message, sizeof(message),
+             "1 thread: %.1f Mfix/s (%.1f ns/fix/fence), %lu threads: %.1f Mfix/s, "
+             "speedup %.2fx, %lu crossings",
+             TRACK_FIXES / single.seconds / 1e6, nsPerFixFence, (unsigned long)threads,
+             TRACK_FIXES / parallel.seconds / 1e6, speedup, (unsigned long)parallel.events);
+    TEST_MESSAGE(message);
+
+    // Same track, same answer regardless of the thread count
+    TEST_ASSERT_TRUE(single.events > 1000);
+    TEST_ASSERT_EQUAL_UINT(single.events, parallel.events);
+    TEST_ASSERT_EQUAL_UINT64(single.exits, parallel.exits);
+    TEST_ASSERT_TRUE(nsPerFixFence < BUDGET_NS_PER_FIX_FENCE);
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_replay_throughput);
+
+    return UNITY_END();
+}
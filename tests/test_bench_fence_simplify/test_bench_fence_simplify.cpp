@@ -0,0 +1,161 @@
+/**
+ * @file test_bench_fence_simplify.cpp
+ * @brief Vertex reduction and contains() speedup of the fence simplifier.
+ *
+ * Run with: pio test -e native_bench
+ *
+ * A surveyed-looking 600-vertex property boundary (about 400 m across,
+ * with a creek-side notch and a meter of survey jitter) simplified to the
+ * collar's 16 vertices in each mode. Reported: time to simplify, the
+ * reduction ratio, the boundary error, and contains() time per point
+ * before and after, over points spread across the bounding box.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "fence_simplify.h"
+
+// ============================================================================
+// Benchmark Data
+// ============================================================================
+
+static const size_t SURVEY_VERTICES = 600;
+static const size_t COLLAR_VERTICES = 16;      // MAX_BOUNDARY_VERTICES
+static const size_t QUERIES = 1000000;
+
+// Host budgets
+static const double BUDGET_SIMPLIFY_MS = 100.0;
+static const double MIN_SPEEDUP = 5.0;
+
+static std::vector<GeoPoint> makeBoundary() {
+    const double metersPerLon = 111320.0 * cos(40.7 * M_PI / 180.0);
+    std::vector<GeoPoint> ring;
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < SURVEY_VERTICES; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        double angle = 2.0 * M_PI * i / SURVEY_VERTICES;
+        double radius = 200.0 + 30.0 * sin(2.0 * angle) + 12.0 * cos(5.0 * angle) + (seed >> 24) / 255.0;
+        // The creek: a notch 60 m deep on the east side
+        double creek = angle < 0.4 || angle > 2.0 * M_PI - 0.4 ? 60.0 * cos(angle * M_PI / 0.8) : 0.0;
+        radius -= creek;
+        GeoPoint point = {static_cast<float>(40.7 + radius * sin(angle) / 111320.0),
+                          static_cast<float>(-74.0 + radius * cos(angle) / metersPerLon)};
+        ring.push_back(point);
+    }
+    return ring;
+}
+
+static std::vector<GeoPoint> makeQueries(const Polygon& fence) {
+    std::vector<GeoPoint> points;
+    points.reserve(QUERIES);
+    double latSpan = fence.maxLat() - fence.minLat();
+    double lonSpan = fence.maxLon() - fence.minLon();
+    uint32_t seed = 777;
+    for (size_t i = 0; i < QUERIES; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        double u = (seed >> 8) / 16777216.0;
+        seed = seed * 1664525u + 1013904223u;
+        double v = (seed >> 8) / 16777216.0;
+        GeoPoint point = {static_cast<float>(fence.minLat() + latSpan * (u * 1.2 - 0.1)),
+                          static_cast<float>(fence.minLon() + lonSpan * (v * 1.2 - 0.1))};
+        points.push_back(point);
+    }
+    return points;
+}
+
+static double nsSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+// ns per contains(); the inside count keeps the loop from being optimized away
+static double timeContains(const Polygon& fence, const std::vector<GeoPoint>& points, size_t& inside) {
+    inside = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const GeoPoint& point : points) {
+        inside += fence.contains(point) ? 1 : 0;
+    }
+    return nsSince(start) / points.size();
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+static void benchMode(FenceSimplifyMode mode, const char* name) {
+    std::vector<GeoPoint> survey = makeBoundary();
+    Polygon original(survey.data(), survey.size());
+    std::vector<GeoPoint> points = makeQueries(original);
+
+    FenceSimplifier simplifier;
+    FenceSimplifyOptions options = {COLLAR_VERTICES, 0.0f, mode};
+    std::vector<GeoPoint> collar;
+    auto start = std::chrono::steady_clock::now();
+    TEST_ASSERT_TRUE(simplifier.simplify(survey.data(), survey.size(), options, collar));
+    double simplifyMs = nsSince(start) / 1e6;
+    Polygon simplified(collar.data(), collar.size());
+
+    size_t insideBefore = 0;
+    size_t insideAfter = 0;
+    double nsBefore = timeContains(original, points, insideBefore);
+    double nsAfter = timeContains(simplified, points, insideAfter);
+    double speedup = nsBefore / nsAfter;
+
+    char message[256];
+    snprintf(message, sizeof(message),
+             "%s: %lu -> %lu vertices (%.1fx) in %.2f ms, error %.2f m; contains() %.1f -> %.1f ns (%.1fx), "
+             "inside %lu -> %lu of %lu",
+             name, (unsigned long)survey.size(), (unsigned long)collar.size(),
+             static_cast<double>(survey.size()) / collar.size(), simplifyMs, simplifier.stats().errorMeters,
+             nsBefore, nsAfter, speedup, (unsigned long)insideBefore, (unsigned long)insideAfter,
+             (unsigned long)QUERIES);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL_UINT32(COLLAR_VERTICES, collar.size());
+    if (mode == FenceSimplifyMode::INNER) {
+        TEST_ASSERT_TRUE(insideAfter <= insideBefore);
+    } else if (mode == FenceSimplifyMode::OUTER) {
+        TEST_ASSERT_TRUE(insideAfter >= insideBefore);
+    }
+    TEST_ASSERT_TRUE(simplifyMs < BUDGET_SIMPLIFY_MS);
+    TEST_ASSERT_TRUE(speedup > MIN_SPEEDUP);
+}
+
+void bench_simplify_any(void) {
+    benchMode(FenceSimplifyMode::ANY, "any");
+}
+
+void bench_simplify_inner(void) {
+    benchMode(FenceSimplifyMode::INNER, "inner");
+}
+
+void bench_simplify_outer(void) {
+    benchMode(FenceSimplifyMode::OUTER, "outer");
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_simplify_any);
+    RUN_TEST(bench_simplify_inner);
+    RUN_TEST(bench_simplify_outer);
+
+    return UNITY_END();
+}
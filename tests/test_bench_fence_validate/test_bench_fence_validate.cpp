@@ -0,0 +1,135 @@
+/**
+ * @file test_bench_fence_validate.cpp
+ * @brief Scaling of fence validation against an all-pairs edge check.
+ *
+ * Run with: pio test -e native_bench
+ *
+ * Lumpy parcel boundaries of 256 (the largest radio update) to 4096 (the
+ * largest FenceStore fence) vertices, each validated with the sweep line
+ * and with the obvious O(n^2) test of every pair of edges. Reported: time
+ * per fence for both and the ratio. The sweep should grow roughly
+ * linearly, the pairwise test by 4x per doubling.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "fence_validate.h"
+
+// ============================================================================
+// Benchmark Data
+// ============================================================================
+
+static const size_t SIZES[] = {256, 1024, 4096};
+static const int RUNS = 10;
+
+// Host budgets
+static const double BUDGET_4096_MS = 10.0;
+static const double MIN_SPEEDUP_4096 = 10.0;
+
+// About 1 km across; from 1024 vertices up a few neighbours round onto a line
+static std::vector<GeoPoint> makeBoundary(size_t count) {
+    const double metersPerLon = 111320.0 * cos(40.7 * M_PI / 180.0);
+    std::vector<GeoPoint> ring;
+    for (size_t i = 0; i < count; i++) {
+        double angle = 2.0 * M_PI * i / count;
+        double radius = 500.0 + 80.0 * sin(7.0 * angle) + 30.0 * cos(23.0 * angle);
+        GeoPoint point = {static_cast<float>(40.7 + radius * sin(angle) / 111320.0),
+                          static_cast<float>(-74.0 + radius * cos(angle) / metersPerLon)};
+        ring.push_back(point);
+    }
+    return ring;
+}
+
+static double nsSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+static double orient(const GeoPoint& a, const GeoPoint& b, const GeoPoint& c) {
+    return (static_cast<double>(b.lon) - a.lon) * (static_cast<double>(c.lat) - a.lat) -
+           (static_cast<double>(b.lat) - a.lat) * (static_cast<double>(c.lon) - a.lon);
+}
+
+// The check the sweep replaces: every pair of non-adjacent edges (proper
+// crossings only, which is all a clean ring can have)
+static bool pairwiseSimple(const std::vector<GeoPoint>& ring) {
+    size_t n = ring.size();
+    for (size_t i = 0; i < n; i++) {
+        const GeoPoint& a = ring[i];
+        const GeoPoint& b = ring[(i + 1) % n];
+        for (size_t j = i + 2; j < n; j++) {
+            if (i == 0 && j == n - 1) {
+                continue;
+            }
+            const GeoPoint& c = ring[j];
+            const GeoPoint& d = ring[(j + 1) % n];
+            if ((orient(a, b, c) > 0.0) != (orient(a, b, d) > 0.0) &&
+                (orient(c, d, a) > 0.0) != (orient(c, d, b) > 0.0)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+void bench_validate_scaling(void) {
+    for (size_t size : SIZES) {
+        std::vector<GeoPoint> ring = makeBoundary(size);
+
+        FenceValidation result = {};
+        auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < RUNS; run++) {
+            result = fenceValidate(ring.data(), ring.size());
+        }
+        double sweepMs = nsSince(start) / 1e6 / RUNS;
+
+        bool simple = false;
+        start = std::chrono::steady_clock::now();
+        for (int run = 0; run < RUNS; run++) {
+            simple = pairwiseSimple(ring);
+        }
+        double pairwiseMs = nsSince(start) / 1e6 / RUNS;
+
+        char message[192];
+        snprintf(message, sizeof(message), "%lu vertices (%s): sweep %.3f ms, all pairs %.3f ms (%.1fx)",
+                 (unsigned long)size, fenceVerdictName(result.verdict), sweepMs, pairwiseMs,
+                 pairwiseMs / sweepMs);
+        TEST_MESSAGE(message);
+
+        TEST_ASSERT_TRUE(fenceVerdictUsable(result.verdict));
+        TEST_ASSERT_TRUE(simple);
+        if (size == 4096) {
+            TEST_ASSERT_TRUE(sweepMs < BUDGET_4096_MS);
+            TEST_ASSERT_TRUE(pairwiseMs / sweepMs > MIN_SPEEDUP_4096);
+        }
+    }
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_validate_scaling);
+
+    return UNITY_END();
+}
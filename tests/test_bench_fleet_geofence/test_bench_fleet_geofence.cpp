@@ -0,0 +1,221 @@
+/**
+ * @file test_bench_fleet_geofence.cpp
+ * @brief Query benchmark for the base-station fleet geofence service.
+ *
+ * Run with: pio test -e native_bench
+ *
+ * A kennel-scale deployment: 10k fences (two or three per household)
+ * over a 50 x 50 km area and 1k collars, each walking around its home.
+ * Every collar's fix is checked against its household's fences through
+ * the index and, for comparison, by testing every fence. A second run
+ * checks the same fixes from several reader threads while fences are
+ * being updated. The budget is loose: it only catches the index
+ * degenerating into a linear scan.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "fleet_geofence.h"
+
+// ============================================================================
+// Benchmark Data
+// ============================================================================
+
+static const size_t FENCES = 10000;
+static const size_t COLLARS = 1000;
+static const size_t FIXES_PER_COLLAR = 1000;
+static const size_t READER_THREADS = 4;
+
+// Host budget per indexed check
+static const double BUDGET_NS_PER_CHECK = 2000.0;
+
+struct Collar {
+    uint32_t household;
+    GeoPoint home;
+};
+
+static uint32_t nextRandom(uint32_t& seed) {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+static float randomRange(uint32_t& seed, float low, float high) {
+    return low + (high - low) * static_cast<float>(nextRandom(seed) % 100000) / 100000.0f;
+}
+
+// Households of 2-3 fences: a ~200 m yard and smaller paddocks around it
+static std::vector<FleetFence> makeFleet(std::vector<Collar>& collars) {
+    std::vector<FleetFence> fences;
+    uint32_t seed = 2024;
+    uint32_t household = 0;
+    while (fences.size() < FENCES) {
+        GeoPoint home = {randomRange(seed, 40.0f, 40.45f), randomRange(seed, -74.6f, -74.0f)};
+        size_t count = 2 + nextRandom(seed) % 2;
+        for (size_t i = 0; i < count && fences.size() < FENCES; i++) {
+            float size = i == 0 ? 0.002f : 0.0008f;
+            float lat = home.lat + (i == 0 ? -0.001f : 0.0012f * i);
+            float lon = home.lon - 0.001f;
+            FleetFence fence = {static_cast<uint32_t>(fences.size() + 1), household, {}};
+            fence.vertices.push_back({lat, lon});
+            fence.vertices.push_back({lat, lon + size});
+            fence.vertices.push_back({lat + size * 0.8f, lon + size * 1.1f});
+            fence.vertices.push_back({lat + size, lon + size * 0.5f});
+            fence.vertices.push_back({lat + size * 0.9f, lon - size * 0.1f});
+            fences.push_back(fence);
+        }
+        if (collars.size() < COLLARS) {
+            collars.push_back({household, home});
+        }
+        household++;
+    }
+    return fences;
+}
+
+// Fixes within ~300 m of home, so some fall outside every fence
+static std::vector<GeoPoint> makeFixes(const std::vector<Collar>& collars) {
+    std::vector<GeoPoint> fixes;
+    uint32_t seed = 99;
+    for (size_t i = 0; i < FIXES_PER_COLLAR; i++) {
+        for (const Collar& collar : collars) {
+            fixes.push_back({collar.home.lat + randomRange(seed, -0.003f, 0.003f),
+                             collar.home.lon + randomRange(seed, -0.003f, 0.003f)});
+        }
+    }
+    return fixes;
+}
+
+static double nsSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+void bench_index_vs_linear_scan(void) {
+    std::vector<Collar> collars;
+    FleetGeofence service;
+    auto buildStart = std::chrono::steady_clock::now();
+    TEST_ASSERT_TRUE(service.loadFences(makeFleet(collars)));
+    double buildMs = nsSince(buildStart) / 1e6;
+    std::shared_ptr<const FleetFenceIndex> index = service.snapshot();
+    std::vector<GeoPoint> fixes = makeFixes(collars);
+
+    auto start = std::chrono::steady_clock::now();
+    size_t inside = 0;
+    for (size_t i = 0; i < fixes.size(); i++) {
+        inside += index->check(collars[i % COLLARS].household, fixes[i]).inside ? 1 : 0;
+    }
+    double nsPerCheck = nsSince(start) / fixes.size();
+
+    // Baseline: every fence of the fleet for a sample of the fixes
+    const std::vector<FleetFence>& fences = index->fences();
+    std::vector<Polygon> polygons;
+    for (const FleetFence& fence : fences) {
+        polygons.push_back(Polygon(fence.vertices.data(), fence.vertices.size()));
+    }
+    size_t sample = fixes.size() / 100;
+    size_t scanInside = 0;
+    size_t indexInside = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < sample; i++) {
+        uint32_t household = collars[i % COLLARS].household;
+        for (size_t f = 0; f < fences.size(); f++) {
+            if (fences[f].household == household && polygons[f].contains(fixes[i])) {
+                scanInside++;
+                break;
+            }
+        }
+    }
+    double nsPerScan = nsSince(start) / sample;
+    for (size_t i = 0; i < sample; i++) {
+        indexInside += index->check(collars[i % COLLARS].household, fixes[i]).inside ? 1 : 0;
+    }
+
+    char message[192];
+    snprintf(message, sizeof(message),
+             "%lu fences, depth %lu, built in %.1f ms; %.0f ns/check indexed, %.0f ns linear "
+             "(%.0fx); %.0f%% of fixes inside",
+             (unsigned long)fences.size(), (unsigned long)index->depth(), buildMs, nsPerCheck,
+             nsPerScan, nsPerScan / nsPerCheck, 100.0 * inside / fixes.size());
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL_UINT(scanInside, indexInside);
+    TEST_ASSERT_TRUE(inside > 0 && inside < fixes.size());
+    TEST_ASSERT_TRUE(nsPerCheck < BUDGET_NS_PER_CHECK);
+}
+
+void bench_readers_during_updates(void) {
+    std::vector<Collar> collars;
+    FleetGeofence service;
+    service.loadFences(makeFleet(collars));
+    std::vector<GeoPoint> fixes = makeFixes(collars);
+
+    std::atomic<bool> stop(false);
+    std::atomic<size_t> checks(0);
+    std::vector<std::thread> readers;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < READER_THREADS; r++) {
+        readers.emplace_back([&, r]() {
+            size_t done = 0;
+            for (size_t i = r; i < fixes.size(); i += READER_THREADS) {
+                service.check(collars[i % COLLARS].household, fixes[i]);
+                done++;
+            }
+            checks += done;
+        });
+    }
+
+    // One household redraws a paddock over and over while the readers run
+    size_t updates = 0;
+    std::thread writer([&]() {
+        FleetFence paddock = *service.snapshot()->find(2);
+        while (!stop.load()) {
+            paddock.vertices[0].lat += (updates % 2 == 0) ? 0.0001f : -0.0001f;
+            service.upsertFence(2, paddock.household, paddock.vertices.data(), paddock.vertices.size());
+            updates++;
+        }
+    });
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    double seconds = nsSince(start) / 1e9;
+    stop = true;
+    writer.join();
+
+    char message[128];
+    snprintf(message, sizeof(message), "%lu readers: %.2f M checks/s with %lu fence updates published",
+             (unsigned long)READER_THREADS, checks.load() / seconds / 1e6, (unsigned long)updates);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL_UINT(fixes.size(), checks.load());
+    TEST_ASSERT_TRUE(updates > 0);
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_index_vs_linear_scan);
+    RUN_TEST(bench_readers_during_updates);
+
+    return UNITY_END();
+}
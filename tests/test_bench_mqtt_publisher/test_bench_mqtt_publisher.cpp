@@ -0,0 +1,171 @@
+/**
+ * @file test_bench_mqtt_publisher.cpp
+ * @brief Throughput and traffic benchmark for the MQTT publishing stage.
+ *
+ * Run with: pio test -e native_bench
+ *
+ * A 1k-collar fleet sends a position every 5 s for one simulated hour:
+ * most dogs rest (GPS jitter of a few metres), some walk, a few cross
+ * their fence. The benchmark reports how many MQTT messages reach the
+ * broker compared with one per packet, and how many updates and messages
+ * per second the stage itself handles on the host. The budget is loose.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "mqtt_publisher.h"
+
+// ============================================================================
+// Benchmark Data
+// ============================================================================
+
+static const uint32_t COLLARS = 1000;
+static const uint32_t UPLINK_MS = 5000;
+static const uint32_t DURATION_MS = 3600UL * 1000;
+static const uint32_t POLL_MS = 100;
+
+// Host budget per update (update + its share of polls and publishing)
+static const double BUDGET_NS_PER_UPDATE = 2000.0;
+
+// Counts and sizes only, like a socket write that never blocks
+class NullSink : public MqttSink {
+public:
+    uint32_t messages = 0;
+    uint64_t bytes = 0;
+
+    bool publish(const char* topic, const char*, size_t length, bool) override {
+        messages++;
+        bytes += length + strlen(topic);
+        return true;
+    }
+};
+
+struct SimCollar {
+    int32_t latE6;
+    int32_t lonE6;
+    int32_t homeLatE6;
+    bool walking;
+    PacketFenceState state;
+};
+
+static uint32_t nextRandom(uint32_t& seed) {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+// One uplink: jitter at rest, ~7 m/s strides when walking; one dog in
+// ten walks at any time and fence state follows distance from home
+static CollarUpdate step(SimCollar& collar, uint32_t id, uint32_t nowMs, uint32_t& seed) {
+    if (nextRandom(seed) % 100 == 0) {
+        collar.walking = !collar.walking && nextRandom(seed) % 10 == 0;
+    }
+    int32_t stride = collar.walking ? 300 : 40;
+    collar.latE6 += static_cast<int32_t>(nextRandom(seed) % (2 * stride + 1)) - stride;
+    collar.lonE6 += static_cast<int32_t>(nextRandom(seed) % (2 * stride + 1)) - stride;
+    collar.latE6 -= (collar.latE6 - collar.homeLatE6) / 64;
+    collar.state = collar.latE6 - collar.homeLatE6 > 2000 ? PacketFenceState::OUTSIDE
+                                                          : PacketFenceState::INSIDE;
+
+    CollarUpdate update = {id, {collar.latE6, collar.lonE6, nowMs / 1000}, collar.state, 12};
+    return update;
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+void bench_fleet_hour(void) {
+    NullSink sink;
+    MqttPublisherConfig config = DEFAULT_MQTT_PUBLISHER_CONFIG;
+    config.maxMessagesPerSec = 0;   // Measure the stage, not the limit
+    MqttPublisher publisher(sink, config, COLLARS);
+
+    uint32_t seed = 5;
+    std::vector<SimCollar> collars(COLLARS);
+    for (uint32_t i = 0; i < COLLARS; i++) {
+        int32_t lat = 40000000 + static_cast<int32_t>(i) * 1000;
+        collars[i] = {lat, -74000000, lat, false, PacketFenceState::INSIDE};
+    }
+
+    uint32_t updates = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t now = 0; now < DURATION_MS; now += POLL_MS) {
+        // Uplinks are spread evenly over the interval
+        uint32_t slot = now % UPLINK_MS;
+        for (uint32_t id = slot * COLLARS / UPLINK_MS; id < (slot + POLL_MS) * COLLARS / UPLINK_MS; id++) {
+            publisher.update(step(collars[id], id, now, seed), now);
+            updates++;
+        }
+        publisher.poll(now);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double nsPerUpdate = seconds * 1e9 / updates;
+    const MqttPublisherStats& stats = publisher.stats();
+    char message[224];
+    snprintf(message, sizeof(message),
+             "%lu uplinks -> %lu messages (%.1f%%, %.1f msg/s to the broker, %lu KB); "
+             "host: %.0f ns/update, %.2f M updates/s, %.2f M msg/s",
+             (unsigned long)updates, (unsigned long)sink.messages, 100.0 * sink.messages / updates,
+             sink.messages / (DURATION_MS / 1000.0), (unsigned long)(sink.bytes / 1024), nsPerUpdate,
+             updates / seconds / 1e6, sink.messages / seconds / 1e6);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL_UINT32(updates, stats.updates);
+    TEST_ASSERT_TRUE(sink.messages < updates / 2);
+    TEST_ASSERT_TRUE(stats.discoveries == COLLARS);
+    TEST_ASSERT_TRUE(nsPerUpdate < BUDGET_NS_PER_UPDATE);
+}
+
+// Raw serialisation rate: every poll publishes every collar
+void bench_publish_rate(void) {
+    NullSink sink;
+    MqttPublisherConfig config = DEFAULT_MQTT_PUBLISHER_CONFIG;
+    config.maxMessagesPerSec = 0;
+    config.windowMs = 0;
+    config.minMoveMeters = 0.0f;
+    MqttPublisher publisher(sink, config, COLLARS);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t round = 0; round < 500; round++) {
+        for (uint32_t id = 0; id < COLLARS; id++) {
+            CollarUpdate update = {id, {40000000 + static_cast<int32_t>(round), -74000000, round},
+                                   round % 2 ? PacketFenceState::INSIDE : PacketFenceState::OUTSIDE, 9};
+            publisher.update(update, round);
+        }
+        publisher.poll(round);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    char message[96];
+    snprintf(message, sizeof(message), "%.2f M messages/s serialised (%lu messages)",
+             sink.messages / seconds / 1e6, (unsigned long)sink.messages);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(COLLARS + 500 * COLLARS * 2, sink.messages);
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_fleet_hour);
+    RUN_TEST(bench_publish_rate);
+
+    return UNITY_END();
+}
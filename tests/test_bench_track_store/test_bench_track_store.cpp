@@ -0,0 +1,190 @@
+/**
+ * @file test_bench_track_store.cpp
+ * @brief Compression and scan benchmark for the columnar track store.
+ *
+ * Run with: pio test -e native_bench
+ *
+ * A week of history for a small kennel: 20 collars uplinking every 5 s
+ * (every 60 s while the dog sleeps), each on a random walk around its
+ * home with GPS jitter and the occasional escape. Fixes go through
+ * TrackStore interleaved by time, as the base station receives them.
+ * Reported: bytes per fix against the raw 13-byte fix and a CSV line,
+ * append rate, full-scan decode rate, one-hour query latency and the
+ * cost of "time outside" over the week. The budgets are loose: they
+ * catch a broken encoding, not a slow machine.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <chrono>
+#include <vector>
+#include "track_store.h"
+
+// ============================================================================
+// Benchmark Data
+// ============================================================================
+
+static const uint32_t COLLARS = 20;
+static const uint32_t WEEK_SECONDS = 7 * 24 * 3600;
+static const uint32_t START_TIME = 1700000000;
+
+// Raw fix and state, and a "time,lat,lon,state" CSV line
+static const double RAW_BYTES_PER_FIX = 13.0;
+static const double CSV_BYTES_PER_FIX = 36.0;
+
+static const double BUDGET_BYTES_PER_FIX = 6.0;
+static const double BUDGET_MIN_DECODE_MFIX_S = 10.0;
+
+struct Walker {
+    int32_t homeLat;
+    int32_t homeLon;
+    int32_t latE6;
+    int32_t lonE6;
+    uint32_t nextTime;
+    uint32_t seed;
+};
+
+static uint32_t nextRandom(uint32_t& seed) {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+static int32_t jitter(uint32_t& seed, int32_t range) {
+    return static_cast<int32_t>(nextRandom(seed) % (2 * range + 1)) - range;
+}
+
+// Awake 06:00-22:00 at 5 s, asleep (60 s) otherwise
+static uint32_t cadence(uint32_t time) {
+    uint32_t hour = (time / 3600) % 24;
+    return hour >= 6 && hour < 22 ? 5 : 60;
+}
+
+// One step: ~1 m of wander pulled gently home, plus ~2 m of GPS jitter;
+// the dog is "out" beyond ~60 m
+static StoredFix step(Walker& walker) {
+    walker.latE6 += jitter(walker.seed, 12) + (walker.homeLat - walker.latE6) / 400;
+    walker.lonE6 += jitter(walker.seed, 16) + (walker.homeLon - walker.lonE6) / 400;
+    StoredFix stored;
+    stored.fix.latE6 = walker.latE6 + jitter(walker.seed, 15);
+    stored.fix.lonE6 = walker.lonE6 + jitter(walker.seed, 20);
+    stored.fix.timestamp = walker.nextTime;
+    int32_t north = walker.latE6 - walker.homeLat;
+    int32_t east = walker.lonE6 - walker.homeLon;
+    stored.fenceState = north * north + east * east > 550 * 550 ? PacketFenceState::OUTSIDE
+                                                                : PacketFenceState::INSIDE;
+    walker.nextTime += cadence(walker.nextTime);
+    return stored;
+}
+
+static double nsSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+void bench_week_of_fleet_history(void) {
+    TrackStore store(".");
+    std::vector<Walker> walkers;
+    uint32_t seed = 7;
+    for (uint32_t c = 0; c < COLLARS; c++) {
+        int32_t lat = 40700000 + static_cast<int32_t>(nextRandom(seed) % 100000);
+        int32_t lon = -74000000 - static_cast<int32_t>(nextRandom(seed) % 100000);
+        walkers.push_back({lat, lon, lat, lon, START_TIME + c, c + 1});
+        unlink(store.collarPath(c).c_str());
+    }
+
+    // Interleave the collars in time order, as uplinks arrive
+    uint64_t fixes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t t = START_TIME; t < START_TIME + WEEK_SECONDS; t += 5) {
+        for (uint32_t c = 0; c < COLLARS; c++) {
+            if (walkers[c].nextTime <= t) {
+                StoredFix stored = step(walkers[c]);
+                TEST_ASSERT_TRUE(store.append(c, stored.fix, stored.fenceState));
+                fixes++;
+            }
+        }
+    }
+    TEST_ASSERT_TRUE(store.flush());
+    double appendNs = nsSince(start);
+
+    // Full scan and queries, one collar file at a time
+    uint64_t bytes = 0;
+    uint64_t decoded = 0;
+    uint64_t outside = 0;
+    uint64_t queried = 0;
+    double scanNs = 0;
+    double outsideNs = 0;
+    double queryNs = 0;
+    std::vector<StoredFix> out;
+    for (uint32_t c = 0; c < COLLARS; c++) {
+        TrackStoreReader reader;
+        TEST_ASSERT_TRUE(reader.open(store.collarPath(c).c_str()));
+        TEST_ASSERT_FALSE(reader.truncated());
+        bytes += reader.fileSize();
+
+        start = std::chrono::steady_clock::now();
+        for (size_t b = 0; b < reader.blocks().size(); b++) {
+            TEST_ASSERT_TRUE(reader.decodeBlock(b, out));
+            decoded += out.size();
+        }
+        scanNs += nsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        outside += reader.countOutside(0, 0xFFFFFFFF);
+        outsideNs += nsSince(start);
+
+        // One-hour windows across the week
+        start = std::chrono::steady_clock::now();
+        for (uint32_t h = 0; h < 7 * 24; h += 7) {
+            out.clear();
+            uint32_t from = START_TIME + h * 3600;
+            queried += reader.query(from, from + 3599, out);
+        }
+        queryNs += nsSince(start);
+        unlink(store.collarPath(c).c_str());
+    }
+
+    double bytesPerFix = static_cast<double>(bytes) / fixes;
+    double decodeMfix = decoded / (scanNs / 1e9) / 1e6;
+    char message[256];
+    snprintf(message, sizeof(message),
+             "%lu fixes, %.2f bytes/fix (%.1fx vs raw, %.1fx vs CSV); append %.1f M fix/s; "
+             "scan %.1f M fix/s; 1 h query %.1f us; time outside %.1f%% in %.0f us",
+             (unsigned long)fixes, bytesPerFix, RAW_BYTES_PER_FIX / bytesPerFix,
+             CSV_BYTES_PER_FIX / bytesPerFix, fixes / (appendNs / 1e9) / 1e6, decodeMfix,
+             queryNs / 1e3 / (COLLARS * 24), 100.0 * outside / fixes, outsideNs / 1e3);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL_UINT64(fixes, decoded);
+    TEST_ASSERT_TRUE(queried > 0);
+    TEST_ASSERT_TRUE(outside > 0 && outside < fixes);
+    TEST_ASSERT_TRUE(bytesPerFix < BUDGET_BYTES_PER_FIX);
+    TEST_ASSERT_TRUE(decodeMfix > BUDGET_MIN_DECODE_MFIX_S);
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_week_of_fleet_history);
+
+    return UNITY_END();
+}
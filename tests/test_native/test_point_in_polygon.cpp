@@ -231,6 +231,34 @@ void test_point_near_edge_outside(void) {
     TEST_ASSERT_FALSE(fence.contains(nearEdgePoint));
 }
 
+// ============================================================================
+// Distance Tests
+// ============================================================================
+
+void test_distance_inside_center(void) {
+    Polygon fence(squarePolygon, squarePolygonCount);
+    
+    // Center is 0.0005 deg from every edge; longitude degrees are shorter
+    // at this latitude (cos(40.7125) ~= 0.758), so east/west is nearest (~42.2m)
+    GeoPoint center = {40.7125f, -74.0065f};
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 0.0005f * METERS_PER_DEGREE * 0.758f, fence.distanceToBoundary(center));
+}
+
+void test_distance_outside_north(void) {
+    Polygon fence(squarePolygon, squarePolygonCount);
+    
+    // 0.0001 deg north of the north edge (~11.1m)
+    GeoPoint north = {40.7131f, -74.0065f};
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0001f * METERS_PER_DEGREE, fence.distanceToBoundary(north));
+}
+
+void test_distance_invalid_polygon(void) {
+    Polygon fence(nullptr, 4);
+    
+    GeoPoint point = {40.7125f, -74.0065f};
+    TEST_ASSERT_TRUE(fence.distanceToBoundary(point) < 0.0f);
+}
+
 // ============================================================================
 // Test Runner
 // ============================================================================
@@ -281,5 +309,10 @@ int main(int argc, char **argv) {
     RUN_TEST(test_point_near_edge_inside);
     RUN_TEST(test_point_near_edge_outside);
 
+    // Distance tests
+    RUN_TEST(test_distance_inside_center);
+    RUN_TEST(test_distance_outside_north);
+    RUN_TEST(test_distance_invalid_polygon);
+
     return UNITY_END();
 }
@@ -0,0 +1,193 @@
+/**
+ * @file activity_traces.h
+ * @brief Reference accelerometer traces for the activity classifier tests.
+ *
+ * 200 samples (2 s) each at 100 Hz, +-2 g, in mg.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef ACTIVITY_TRACES_H
+#define ACTIVITY_TRACES_H
+
+#include "motion_gate.h"
+
+constexpr size_t ACTIVITY_TRACE_LEN = 200;
+
+// Lying down: gravity and sensor noise only
+static const MotionSample ACTIVITY_TRACE_REST[ACTIVITY_TRACE_LEN] = {
+    {21, -37, 992}, {22, -48, 998}, {27, -40, 993}, {30, -28, 990}, {27, -36, 995},
+    {26, -38, 997}, {25, -34, 998}, {29, -33, 993}, {37, -45, 998}, {36, -39, 995},
+    {23, -34, 992}, {28, -33, 985}, {30, -34, 988}, {21, -35, 999}, {36, -41, 993},
+    {21, -44, 994}, {24, -43, 989}, {38, -43, 999}, {30, -49, 1000}, {25, -40, 1004},
+    {36, -44, 995}, {24, -46, 995}, {34, -34, 996}, {27, -39, 987}, {31, -38, 992},
+    {28, -42, 1001}, {25, -46, 990}, {28, -37, 995}, {32, -34, 994}, {26, -49, 1002},
+    {23, -35, 989}, {25, -46, 995}, {29, -42, 998}, {20, -36, 995}, {30, -37, 999},
+    {35, -38, 996}, {34, -41, 989}, {28, -43, 999}, {32, -33, 994}, {32, -38, 999},
+    {36, -42, 1000}, {29, -40, 1002}, {36, -23, 991}, {32, -40, 999}, {44, -46, 991},
+    {28, -37, 995}, {27, -33, 988}, {23, -37, 990}, {27, -44, 994}, {26, -38, 994},
+    {26, -43, 995}, {27, -39, 994}, {29, -47, 991}, {29, -44, 998}, {30, -37, 998},
+    {24, -40, 1001}, {28, -42, 989}, {26, -36, 997}, {34, -44, 995}, {34, -47, 997},
+    {31, -41, 1000}, {31, -37, 995}, {31, -38, 993}, {28, -51, 989}, {35, -33, 992},
+    {28, -32, 992}, {22, -32, 1002}, {35, -38, 992}, {37, -44, 998}, {27, -40, 986},
+    {29, -38, 1000}, {30, -42, 994}, {28, -41, 989}, {30, -39, 996}, {38, -45, 993},
+    {29, -52, 992}, {30, -47, 1001}, {31, -38, 1009}, {33, -39, 996}, {28, -41, 999},
+    {35, -45, 997}, {28, -36, 997}, {30, -46, 1002}, {26, -36, 997}, {31, -36, 992},
+    {25, -39, 994}, {32, -41, 994}, {20, -33, 996}, {30, -40, 989}, {30, -42, 997},
+    {31, -36, 995}, {34, -30, 987}, {29, -38, 994}, {39, -36, 1001}, {33, -37, 998},
+    {36, -45, 1001}, {24, -40, 1004}, {31, -34, 996}, {38, -40, 987}, {39, -40, 1001},
+    {22, -43, 993}, {34, -45, 1004}, {29, -44, 996}, {23, -39, 1000}, {32, -38, 996},
+    {30, -47, 988}, {31, -43, 999}, {28, -42, 988}, {22, -38, 1000}, {25, -49, 994},
+    {29, -44, 1000}, {29, -27, 998}, {35, -42, 995}, {22, -32, 1000}, {21, -49, 991},
+    {30, -39, 988}, {31, -41, 990}, {19, -39, 996}, {22, -39, 990}, {25, -44, 1001},
+    {35, -40, 984}, {38, -37, 1000}, {34, -47, 994}, {22, -52, 999}, {35, -39, 987},
+    {32, -40, 998}, {23, -37, 984}, {28, -43, 995}, {26, -43, 1000}, {30, -34, 999},
+    {36, -44, 997}, {29, -35, 987}, {30, -34, 997}, {33, -44, 994}, {23, -34, 993},
+    {27, -47, 991}, {38, -38, 1000}, {30, -40, 995}, {36, -36, 994}, {36, -36, 1000},
+    {37, -43, 986}, {39, -42, 998}, {17, -33, 991}, {32, -46, 993}, {30, -47, 992},
+    {25, -53, 1000}, {21, -39, 994}, {30, -44, 998}, {27, -37, 995}, {31, -41, 989},
+    {34, -49, 995}, {21, -30, 988}, {34, -49, 985}, {43, -32, 989}, {34, -46, 989},
+    {27, -36, 993}, {22, -49, 994}, {32, -42, 1000}, {26, -40, 995}, {32, -42, 995},
+    {28, -37, 990}, {24, -37, 1013}, {27, -29, 993}, {36, -45, 991}, {25, -32, 990},
+    {25, -44, 995}, {23, -35, 990}, {14, -42, 979}, {28, -36, 1000}, {29, -48, 990},
+    {31, -38, 991}, {30, -32, 997}, {24, -41, 992}, {26, -43, 997}, {26, -44, 989},
+    {27, -41, 994}, {32, -50, 1002}, {33, -47, 991}, {31, -39, 988}, {28, -33, 1000},
+    {38, -33, 997}, {22, -37, 991}, {29, -40, 995}, {26, -31, 997}, {36, -37, 1001},
+    {28, -48, 992}, {29, -45, 1008}, {34, -40, 989}, {28, -43, 995}, {31, -45, 998},
+    {32, -38, 994}, {30, -38, 992}, {35, -43, 994}, {31, -41, 993}, {21, -24, 998},
+    {23, -45, 991}, {29, -50, 1003}, {36, -33, 994}, {29, -38, 994}, {31, -42, 988},
+};
+
+// Walking: ~1.9 Hz gait, ~260 mg vertical
+static const MotionSample ACTIVITY_TRACE_WALK[ACTIVITY_TRACE_LEN] = {
+    {84, 21, 916}, {84, 11, 894}, {95, 20, 882}, {98, 20, 870}, {109, 21, 858},
+    {110, 15, 846}, {118, 15, 833}, {133, 16, 821}, {138, 8, 800}, {132, 7, 796},
+    {142, 9, 780}, {152, -4, 771}, {158, -3, 761}, {163, -13, 754}, {172, -17, 756},
+    {174, -29, 747}, {173, -28, 755}, {182, -39, 768}, {190, -56, 788}, {188, -57, 810},
+    {184, -57, 843}, {187, -69, 873}, {197, -91, 905}, {195, -85, 952}, {198, -106, 976},
+    {203, -94, 1039}, {203, -110, 1079}, {202, -113, 1113}, {203, -113, 1159}, {196, -114, 1195},
+    {197, -117, 1240}, {194, -120, 1260}, {187, -128, 1287}, {191, -114, 1292}, {179, -119, 1305},
+    {188, -115, 1302}, {176, -109, 1307}, {174, -107, 1283}, {170, -96, 1277}, {169, -89, 1258},
+    {159, -80, 1224}, {159, -79, 1196}, {146, -63, 1170}, {144, -64, 1141}, {135, -59, 1111},
+    {138, -47, 1082}, {127, -35, 1060}, {119, -34, 1027}, {111, -11, 1008}, {103, -26, 980},
+    {100, -6, 951}, {94, 0, 945}, {89, 12, 922}, {75, 9, 902}, {65, 8, 901},
+    {61, 12, 886}, {60, 25, 863}, {51, 20, 857}, {42, 17, 841}, {38, 23, 834},
+    {22, 12, 818}, {19, 16, 802}, {8, 8, 793}, {7, 5, 783}, {8, -2, 776},
+    {-5, -11, 756}, {-4, -11, 761}, {-9, -24, 738}, {-28, -38, 754}, {-17, -33, 765},
+    {-37, -48, 776}, {-23, -54, 790}, {-32, -62, 826}, {-41, -69, 836}, {-35, -76, 877},
+    {-26, -88, 919}, {-36, -89, 948}, {-34, -92, 996}, {-39, -107, 1046}, {-43, -110, 1090},
+    {-37, -114, 1126}, {-43, -120, 1167}, {-44, -112, 1215}, {-39, -110, 1239}, {-27, -117, 1273},
+    {-28, -125, 1294}, {-17, -114, 1302}, {-25, -112, 1307}, {-13, -111, 1309}, {-20, -109, 1292},
+    {-15, -105, 1295}, {-11, -96, 1266}, {-12, -83, 1241}, {0, -76, 1218}, {6, -74, 1184},
+    {9, -57, 1162}, {15, -50, 1129}, {21, -45, 1099}, {33, -36, 1072}, {37, -32, 1039},
+    {32, -27, 1006}, {52, -15, 988}, {64, -5, 975}, {56, -4, 943}, {78, 0, 932},
+    {67, 15, 918}, {84, 11, 901}, {100, 9, 886}, {98, 24, 884}, {96, 11, 859},
+    {115, 21, 840}, {116, 21, 837}, {122, 18, 824}, {135, 7, 813}, {144, 20, 799},
+    {147, 7, 783}, {150, 5, 774}, {167, 1, 770}, {165, -11, 760}, {164, -15, 747},
+    {166, -15, 752}, {172, -35, 757}, {178, -28, 771}, {184, -41, 779}, {190, -56, 794},
+    {194, -62, 826}, {182, -69, 860}, {197, -87, 898}, {204, -95, 936}, {198, -90, 979},
+    {190, -94, 1013}, {195, -107, 1059}, {207, -116, 1110}, {191, -113, 1149}, {193, -111, 1189},
+    {207, -114, 1215}, {193, -119, 1252}, {190, -128, 1275}, {188, -121, 1296}, {185, -121, 1306},
+    {184, -114, 1304}, {177, -108, 1300}, {165, -110, 1304}, {176, -103, 1282}, {167, -89, 1263},
+    {160, -80, 1236}, {156, -70, 1201}, {147, -65, 1187}, {149, -62, 1147}, {142, -55, 1126},
+    {134, -51, 1080}, {127, -35, 1077}, {126, -28, 1033}, {111, -23, 1009}, {117, -15, 988},
+    {103, -6, 962}, {94, 6, 938}, {85, 2, 924}, {77, 11, 912}, {67, 12, 891},
+    {59, 19, 882}, {64, 18, 867}, {51, 20, 854}, {44, 17, 843}, {33, 18, 830},
+    {21, 22, 816}, {31, 8, 797}, {29, 13, 791}, {12, -1, 774}, {0, 0, 778},
+    {0, -8, 769}, {-6, -10, 755}, {-5, -12, 751}, {-25, -24, 753}, {-17, -32, 757},
+    {-18, -49, 779}, {-32, -57, 795}, {-35, -64, 812}, {-37, -69, 835}, {-42, -77, 868},
+    {-41, -85, 910}, {-36, -101, 952}, {-39, -98, 997}, {-43, -103, 1034}, {-41, -103, 1076},
+    {-39, -116, 1116}, {-43, -120, 1160}, {-39, -113, 1191}, {-31, -126, 1233}, {-30, -111, 1263},
+    {-25, -128, 1275}, {-35, -116, 1295}, {-17, -111, 1314}, {-25, -115, 1304}, {-17, -111, 1311},
+    {-12, -95, 1294}, {-12, -98, 1271}, {-5, -87, 1245}, {-2, -80, 1225}, {8, -85, 1192},
+};
+
+// Running: ~3.2 Hz gait, ~700 mg vertical
+static const MotionSample ACTIVITY_TRACE_RUN[ACTIVITY_TRACE_LEN] = {
+    {340, -62, 1557}, {378, -45, 1721}, {416, -20, 1829}, {438, -10, 1903}, {448, 13, 1914},
+    {449, 39, 1856}, {429, 50, 1752}, {407, 66, 1602}, {366, 79, 1415}, {323, 101, 1219},
+    {273, 103, 1018}, {213, 110, 844}, {160, 129, 680}, {94, 127, 574}, {33, 140, 501},
+    {-18, 135, 448}, {-54, 138, 431}, {-105, 136, 438}, {-127, 127, 464}, {-148, 115, 472},
+    {-154, 120, 501}, {-147, 112, 504}, {-118, 92, 512}, {-92, 82, 523}, {-54, 78, 565},
+    {-11, 55, 625}, {41, 41, 713}, {106, 24, 828}, {166, 8, 971}, {230, -18, 1149},
+    {281, -31, 1332}, {328, -63, 1517}, {378, -79, 1684}, {404, -94, 1812}, {439, -106, 1885},
+    {454, -122, 1915}, {448, -151, 1881}, {441, -173, 1781}, {422, -189, 1651}, {380, -209, 1467},
+    {337, -205, 1265}, {278, -223, 1068}, {235, -237, 874}, {175, -255, 722}, {117, -252, 604},
+    {63, -260, 511}, {0, -258, 456}, {-50, -270, 435}, {-102, -257, 448}, {-117, -255, 441},
+    {-135, -249, 464}, {-152, -246, 487}, {-137, -239, 495}, {-142, -225, 510}, {-104, -213, 528},
+    {-74, -196, 559}, {-18, -180, 610}, {31, -163, 683}, {86, -142, 786}, {158, -128, 941},
+    {209, -107, 1100}, {262, -97, 1286}, {320, -69, 1464}, {350, -44, 1642}, {412, -30, 1788},
+    {429, -8, 1877}, {436, 10, 1912}, {453, 22, 1898}, {446, 32, 1817}, {426, 64, 1676},
+    {394, 69, 1521}, {345, 88, 1314}, {310, 108, 1122}, {239, 113, 933}, {191, 121, 760},
+    {128, 131, 631}, {73, 127, 523}, {0, 144, 468}, {-30, 136, 442}, {-73, 141, 443},
+    {-113, 135, 444}, {-138, 131, 468}, {-153, 124, 487}, {-145, 115, 494}, {-135, 104, 503},
+    {-110, 100, 514}, {-77, 76, 544}, {-24, 58, 591}, {17, 46, 653}, {82, 27, 772},
+    {134, 14, 893}, {193, -12, 1053}, {258, -23, 1231}, {314, -39, 1416}, {354, -69, 1596},
+    {389, -87, 1753}, {417, -113, 1858}, {447, -121, 1916}, {448, -141, 1904}, {441, -159, 1838},
+    {426, -191, 1724}, {403, -188, 1557}, {360, -204, 1369}, {310, -215, 1161}, {268, -217, 977},
+    {198, -247, 791}, {146, -249, 654}, {92, -266, 555}, {29, -263, 484}, {-19, -265, 442},
+    {-69, -265, 443}, {-110, -252, 454}, {-127, -243, 465}, {-148, -244, 486}, {-154, -237, 493},
+    {-144, -224, 510}, {-109, -226, 525}, {-81, -210, 552}, {-46, -187, 576}, {9, -169, 649},
+    {55, -149, 736}, {124, -140, 858}, {176, -110, 1012}, {240, -105, 1187}, {297, -84, 1385},
+    {334, -49, 1554}, {382, -47, 1714}, {419, -15, 1833}, {436, 4, 1904}, {439, 24, 1920},
+    {460, 31, 1869}, {430, 58, 1752}, {416, 57, 1600}, {373, 84, 1405}, {331, 94, 1214},
+    {276, 111, 1015}, {220, 120, 842}, {156, 127, 684}, {90, 134, 571}, {37, 128, 495},
+    {-11, 138, 443}, {-65, 133, 432}, {-100, 143, 452}, {-126, 131, 457}, {-141, 127, 483},
+    {-148, 127, 494}, {-142, 112, 502}, {-131, 96, 508}, {-96, 84, 527}, {-53, 78, 562},
+    {-17, 58, 625}, {42, 40, 709}, {106, 20, 821}, {161, -2, 965}, {221, -17, 1144},
+    {281, -41, 1337}, {327, -60, 1526}, {362, -75, 1688}, {409, -95, 1815}, {434, -116, 1889},
+    {445, -132, 1919}, {448, -144, 1885}, {433, -171, 1795}, {412, -193, 1647}, {391, -204, 1460},
+    {345, -213, 1272}, {297, -226, 1061}, {236, -243, 883}, {168, -245, 712}, {118, -250, 593},
+    {46, -250, 509}, {-6, -261, 457}, {-56, -263, 434}, {-87, -264, 443}, {-119, -246, 461},
+    {-137, -253, 470}, {-149, -239, 495}, {-132, -234, 501}, {-138, -234, 510}, {-100, -214, 525},
+    {-73, -195, 562}, {-21, -186, 613}, {22, -169, 678}, {91, -154, 793}, {145, -128, 938},
+    {212, -103, 1102}, {260, -90, 1286}, {314, -73, 1473}, {360, -52, 1632}, {395, -33, 1787},
+    {438, -10, 1882}, {438, 11, 1923}, {447, 31, 1902}, {448, 53, 1811}, {411, 65, 1686},
+    {384, 79, 1504}, {357, 91, 1314}, {298, 106, 1108}, {251, 116, 929}, {188, 123, 758},
+};
+
+// Shaking off water: ~4.8 Hz body roll, up to 1.4 g lateral
+static const MotionSample ACTIVITY_TRACE_SHAKE[ACTIVITY_TRACE_LEN] = {
+    {-7, -554, 1099}, {55, -143, 1076}, {116, 273, 1011}, {150, 667, 915}, {188, 1011, 841},
+    {200, 1249, 802}, {191, 1379, 809}, {175, 1387, 874}, {134, 1264, 968}, {79, 1034, 1053},
+    {31, 710, 1091}, {-34, 322, 1094}, {-81, -96, 1041}, {-144, -507, 947}, {-179, -871, 863},
+    {-194, -1148, 817}, {-191, -1333, 803}, {-185, -1416, 850}, {-144, -1334, 930}, {-112, -1149, 1023},
+    {-53, -861, 1083}, {5, -491, 1097}, {67, -79, 1058}, {113, 332, 987}, {160, 724, 895},
+    {194, 1046, 824}, {195, 1278, 792}, {189, 1386, 831}, {169, 1371, 897}, {125, 1242, 980},
+    {67, 997, 1066}, {16, 660, 1089}, {-46, 250, 1081}, {-94, -164, 1024}, {-142, -576, 939},
+    {-176, -927, 864}, {-199, -1187, 805}, {-201, -1358, 814}, {-184, -1393, 856}, {-136, -1313, 945},
+    {-94, -1117, 1027}, {-45, -793, 1079}, {25, -424, 1101}, {78, -9, 1059}, {125, 397, 974},
+    {169, 795, 886}, {190, 1094, 831}, {203, 1294, 798}, {190, 1388, 834}, {156, 1362, 912},
+    {118, 1196, 996}, {57, 936, 1069}, {1, 582, 1091}, {-55, 196, 1076}, {-106, -233, 1004},
+    {-159, -637, 933}, {-193, -974, 847}, {-197, -1221, 803}, {-207, -1375, 810}, {-176, -1395, 876},
+    {-136, -1282, 956}, {-90, -1069, 1044}, {-30, -737, 1091}, {34, -358, 1091}, {85, 62, 1040},
+    {133, 479, 958}, {170, 838, 876}, {188, 1136, 812}, {204, 1335, 790}, {192, 1393, 836},
+    {153, 1331, 915}, {99, 1164, 1012}, {57, 888, 1083}, {-9, 525, 1100}, {-70, 116, 1068},
+    {-116, -305, 1006}, {-161, -706, 906}, {-181, -1024, 837}, {-196, -1263, 799}, {-189, -1380, 814},
+    {-177, -1388, 875}, {-126, -1254, 970}, {-77, -1008, 1045}, {-17, -687, 1090}, {36, -291, 1087},
+    {82, 125, 1024}, {144, 541, 937}, {180, 897, 854}, {195, 1176, 810}, {198, 1347, 809},
+    {183, 1402, 849}, {155, 1337, 930}, {100, 1127, 1025}, {63, 827, 1075}, {-13, 461, 1103},
+    {-70, 40, 1063}, {-124, -372, 973}, {-158, -760, 887}, {-186, -1070, 819}, {-194, -1298, 805},
+    {-191, -1385, 831}, {-163, -1367, 890}, {-122, -1219, 995}, {-70, -952, 1072}, {-13, -622, 1094},
+    {49, -224, 1079}, {99, 206, 1014}, {159, 603, 917}, {188, 959, 847}, {195, 1218, 800},
+    {197, 1369, 819}, {176, 1396, 876}, {148, 1300, 945}, {84, 1091, 1032}, {38, 768, 1095},
+    {-27, 390, 1087}, {-90, -20, 1047}, {-136, -445, 963}, {-172, -815, 877}, {-199, -1116, 813},
+    {-194, -1316, 795}, {-193, -1408, 835}, {-155, -1351, 908}, {-109, -1186, 1001}, {-63, -915, 1071},
+    {0, -552, 1106}, {52, -138, 1068}, {113, 272, 1009}, {153, 665, 920}, {185, 1002, 830},
+    {200, 1245, 807}, {192, 1383, 822}, {176, 1389, 880}, {134, 1261, 969}, {83, 1027, 1049},
+    {18, 703, 1087}, {-30, 327, 1089}, {-92, -90, 1031}, {-145, -499, 943}, {-175, -880, 863},
+    {-198, -1157, 810}, {-202, -1349, 798}, {-183, -1401, 855}, {-161, -1338, 930}, {-111, -1146, 1026},
+    {-46, -861, 1077}, {11, -494, 1106}, {62, -82, 1064}, {119, 339, 986}, {162, 722, 899},
+    {187, 1055, 818}, {197, 1271, 802}, {191, 1386, 821}, {165, 1370, 893}, {136, 1232, 978},
+    {82, 987, 1062}, {11, 649, 1108}, {-48, 268, 1087}, {-98, -167, 1020}, {-152, -567, 943},
+    {-176, -925, 845}, {-198, -1199, 807}, {-203, -1356, 806}, {-177, -1395, 857}, {-142, -1308, 946},
+    {-96, -1111, 1025}, {-38, -793, 1089}, {22, -417, 1098}, {84, -7, 1052}, {127, 409, 973},
+    {164, 794, 885}, {201, 1092, 812}, {197, 1307, 793}, {189, 1398, 833}, {160, 1364, 907},
+    {104, 1200, 995}, {55, 944, 1068}, {-1, 581, 1091}, {-57, 182, 1078}, {-110, -233, 1012},
+    {-158, -630, 923}, {-188, -965, 831}, {-192, -1237, 797}, {-197, -1370, 817}, {-173, -1387, 884},
+    {-131, -1287, 960}, {-83, -1058, 1049}, {-26, -745, 1099}, {27, -353, 1097}, {83, 67, 1038},
+    {136, 465, 955}, {172, 842, 871}, {195, 1146, 814}, {198, 1329, 796}, {187, 1410, 839},
+    {152, 1346, 920}, {107, 1160, 1010}, {48, 885, 1080}, {-4, 518, 1107}, {-62, 113, 1060},
+};
+
+#endif // ACTIVITY_TRACES_H
@@ -0,0 +1,208 @@
+/**
+ * @file test_activity_classifier.cpp
+ * @brief Unit tests for the activity_classifier library against reference traces.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "activity_classifier.h"
+#include "activity_traces.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+ActivityState state;
+
+// Filter warm-up plus one window
+static const size_t SAMPLES_PER_FIRST_WINDOW = ACTIVITY_FIR_TAPS - 1 + ACTIVITY_WINDOW;
+
+static void assertTraceIs(const MotionSample* trace, Activity expected) {
+    ActivityClassifier classifier(state);
+    classifier.beginStream();
+    size_t windows = classifier.process(trace, ACTIVITY_TRACE_LEN, 1000);
+
+    TEST_ASSERT_EQUAL_UINT(2, windows);
+    TEST_ASSERT_EQUAL_UINT16(2, state.current.windows[static_cast<uint8_t>(expected)]);
+    TEST_ASSERT_TRUE(classifier.lastWindow().activity == expected);
+}
+
+// ============================================================================
+// Trace Classification Tests
+// ============================================================================
+
+void test_rest_trace(void) {
+    assertTraceIs(ACTIVITY_TRACE_REST, Activity::REST);
+}
+
+void test_walk_trace(void) {
+    assertTraceIs(ACTIVITY_TRACE_WALK, Activity::WALK);
+    TEST_ASSERT_TRUE(state.current.strides >= 2);
+}
+
+void test_run_trace(void) {
+    assertTraceIs(ACTIVITY_TRACE_RUN, Activity::RUN);
+    TEST_ASSERT_TRUE(state.current.strides >= 4);
+}
+
+void test_shake_trace(void) {
+    assertTraceIs(ACTIVITY_TRACE_SHAKE, Activity::SHAKE);
+    TEST_ASSERT_EQUAL_UINT16(0, state.current.strides);
+}
+
+// ============================================================================
+// Streaming Tests
+// ============================================================================
+
+void test_block_size_does_not_change_result(void) {
+    ActivityClassifier whole(state);
+    whole.beginStream();
+    whole.process(ACTIVITY_TRACE_WALK, ACTIVITY_TRACE_LEN, 1000);
+    ActivityWindow expected = whole.lastWindow();
+
+    const size_t chunkSizes[] = {1, 7, 33, 85};
+    for (size_t c = 0; c < sizeof(chunkSizes) / sizeof(chunkSizes[0]); c++) {
+        ActivityState chunkedState;
+        memset(&chunkedState, 0, sizeof(chunkedState));
+        ActivityClassifier chunked(chunkedState);
+        chunked.beginStream();
+
+        size_t windows = 0;
+        for (size_t pos = 0; pos < ACTIVITY_TRACE_LEN; pos += chunkSizes[c]) {
+            size_t n = ACTIVITY_TRACE_LEN - pos < chunkSizes[c] ? ACTIVITY_TRACE_LEN - pos : chunkSizes[c];
+            windows += chunked.process(&ACTIVITY_TRACE_WALK[pos], n, 1000);
+        }
+
+        TEST_ASSERT_EQUAL_UINT(2, windows);
+        TEST_ASSERT_EQUAL_UINT32(expected.energy, chunked.lastWindow().energy);
+        TEST_ASSERT_EQUAL_UINT8(expected.crossings, chunked.lastWindow().crossings);
+    }
+}
+
+void test_filter_warm_up(void) {
+    ActivityClassifier classifier(state);
+    classifier.beginStream();
+    TEST_ASSERT_EQUAL_UINT(0, classifier.process(ACTIVITY_TRACE_WALK, SAMPLES_PER_FIRST_WINDOW - 1, 1000));
+
+    classifier.beginStream();
+    TEST_ASSERT_EQUAL_UINT(1, classifier.process(ACTIVITY_TRACE_WALK, SAMPLES_PER_FIRST_WINDOW, 1000));
+}
+
+void test_constant_input_has_no_energy(void) {
+    MotionSample still[SAMPLES_PER_FIRST_WINDOW];
+    for (size_t i = 0; i < SAMPLES_PER_FIRST_WINDOW; i++) {
+        still[i].x = 0;
+        still[i].y = 600;
+        still[i].z = 800;
+    }
+
+    ActivityClassifier classifier(state);
+    classifier.beginStream();
+    TEST_ASSERT_EQUAL_UINT(1, classifier.process(still, SAMPLES_PER_FIRST_WINDOW, 1000));
+    TEST_ASSERT_EQUAL_UINT32(0, classifier.lastWindow().energy);
+    TEST_ASSERT_TRUE(classifier.lastWindow().activity == Activity::REST);
+}
+
+// ============================================================================
+// Rule and Helper Tests
+// ============================================================================
+
+void test_classify_rules(void) {
+    const ActivityConfig& c = DEFAULT_ACTIVITY_CONFIG;
+    TEST_ASSERT_TRUE(ActivityClassifier::classify(c, c.restEnergy - 1, 20) == Activity::REST);
+    TEST_ASSERT_TRUE(ActivityClassifier::classify(c, c.restEnergy, 2) == Activity::WALK);
+    TEST_ASSERT_TRUE(ActivityClassifier::classify(c, c.restEnergy, c.runCrossings) == Activity::RUN);
+    TEST_ASSERT_TRUE(ActivityClassifier::classify(c, c.runEnergy, 2) == Activity::RUN);
+    TEST_ASSERT_TRUE(ActivityClassifier::classify(c, c.shakeEnergy, c.shakeCrossings) == Activity::SHAKE);
+}
+
+void test_isqrt(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, activityIsqrt(0));
+    TEST_ASSERT_EQUAL_UINT32(1, activityIsqrt(3));
+    TEST_ASSERT_EQUAL_UINT32(1000, activityIsqrt(1000000));
+    TEST_ASSERT_EQUAL_UINT32(999, activityIsqrt(999999));
+    TEST_ASSERT_EQUAL_UINT32(3464, activityIsqrt(3u * 2000 * 2000));
+    TEST_ASSERT_EQUAL_UINT32(65535, activityIsqrt(0xFFFFFFFF));
+}
+
+// ============================================================================
+// Summary Tests
+// ============================================================================
+
+void test_period_rolls_into_history(void) {
+    ActivityClassifier classifier(state);
+    uint32_t period = DEFAULT_ACTIVITY_CONFIG.periodSec;
+
+    classifier.beginStream();
+    classifier.process(ACTIVITY_TRACE_WALK, ACTIVITY_TRACE_LEN, 1000);
+    classifier.beginStream();
+    classifier.process(ACTIVITY_TRACE_REST, ACTIVITY_TRACE_LEN, 1000 + period);
+
+    ActivitySummary out[ACTIVITY_HISTORY_PERIODS];
+    TEST_ASSERT_EQUAL_UINT(1, activityTakeSummaries(state, out, ACTIVITY_HISTORY_PERIODS));
+    TEST_ASSERT_EQUAL_UINT32(1000, out[0].startSec);
+    TEST_ASSERT_EQUAL_UINT16(2, out[0].windows[static_cast<uint8_t>(Activity::WALK)]);
+    TEST_ASSERT_EQUAL_UINT16(0, out[0].windows[static_cast<uint8_t>(Activity::REST)]);
+
+    TEST_ASSERT_EQUAL_UINT32(1000 + period, state.current.startSec);
+    TEST_ASSERT_EQUAL_UINT16(2, state.current.windows[static_cast<uint8_t>(Activity::REST)]);
+    TEST_ASSERT_EQUAL_UINT(0, activityTakeSummaries(state, out, ACTIVITY_HISTORY_PERIODS));
+}
+
+void test_history_drops_oldest_when_full(void) {
+    ActivityClassifier classifier(state);
+    uint32_t period = DEFAULT_ACTIVITY_CONFIG.periodSec;
+
+    for (uint32_t i = 0; i <= ACTIVITY_HISTORY_PERIODS + 2; i++) {
+        classifier.beginStream();
+        classifier.process(ACTIVITY_TRACE_REST, ACTIVITY_TRACE_LEN, 1000 + i * period);
+    }
+
+    ActivitySummary out[ACTIVITY_HISTORY_PERIODS];
+    TEST_ASSERT_EQUAL_UINT(ACTIVITY_HISTORY_PERIODS,
+                           activityTakeSummaries(state, out, ACTIVITY_HISTORY_PERIODS));
+    TEST_ASSERT_EQUAL_UINT32(1000 + 2 * period, out[0].startSec);
+    TEST_ASSERT_EQUAL_UINT32(1000 + (ACTIVITY_HISTORY_PERIODS + 1) * period,
+                             out[ACTIVITY_HISTORY_PERIODS - 1].startSec);
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    memset(&state, 0, sizeof(state));
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Trace classification tests
+    RUN_TEST(test_rest_trace);
+    RUN_TEST(test_walk_trace);
+    RUN_TEST(test_run_trace);
+    RUN_TEST(test_shake_trace);
+
+    // Streaming tests
+    RUN_TEST(test_block_size_does_not_change_result);
+    RUN_TEST(test_filter_warm_up);
+    RUN_TEST(test_constant_input_has_no_energy);
+
+    // Rule and helper tests
+    RUN_TEST(test_classify_rules);
+    RUN_TEST(test_isqrt);
+
+    // Summary tests
+    RUN_TEST(test_period_rolls_into_history);
+    RUN_TEST(test_history_drops_oldest_when_full);
+
+    return UNITY_END();
+}
@@ -0,0 +1,196 @@
+/**
+ * @file test_alert_sequencer.cpp
+ * @brief Unit tests for the alert pattern sequencer and its timing.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "alert_sequencer.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+AlertSequencerState state;
+AlertOutput output;
+
+// Beep 100 ms, pause 50 ms, twice
+static const AlertStep TEST_STEPS[] = {
+    {3000, 80, 40, 100},
+    {0, 80, 0, 50},
+};
+static const AlertPattern TEST_PATTERN = {TEST_STEPS, 2, 2};
+
+// ============================================================================
+// Sequencing Tests
+// ============================================================================
+
+void test_idle_state_is_silent(void) {
+    TEST_ASSERT_FALSE(alertSequencerActive(state));
+    TEST_ASSERT_FALSE(alertSequencerUpdate(state, 1000, output));
+    TEST_ASSERT_EQUAL_UINT16(0, output.toneHz);
+    TEST_ASSERT_EQUAL_UINT32(ALERT_IDLE, alertSequencerNextChangeMs(state, 1000));
+}
+
+void test_steps_change_at_their_boundaries(void) {
+    alertSequencerStart(state, &TEST_PATTERN, 1000);
+
+    TEST_ASSERT_TRUE(alertSequencerUpdate(state, 1000, output));
+    TEST_ASSERT_EQUAL_UINT16(3000, output.toneHz);
+    TEST_ASSERT_EQUAL_UINT8(80, output.volumePercent);
+    TEST_ASSERT_EQUAL_UINT8(40, output.vibrationPercent);
+    TEST_ASSERT_EQUAL_UINT32(100, alertSequencerNextChangeMs(state, 1000));
+
+    // Nothing changes within a step
+    TEST_ASSERT_FALSE(alertSequencerUpdate(state, 1099, output));
+    TEST_ASSERT_EQUAL_UINT32(1, alertSequencerNextChangeMs(state, 1099));
+
+    // Silent step: volume reported as 0 even though the table says 80
+    TEST_ASSERT_TRUE(alertSequencerUpdate(state, 1100, output));
+    TEST_ASSERT_EQUAL_UINT16(0, output.toneHz);
+    TEST_ASSERT_EQUAL_UINT8(0, output.volumePercent);
+    TEST_ASSERT_EQUAL_UINT32(50, alertSequencerNextChangeMs(state, 1100));
+
+    // Second repetition
+    TEST_ASSERT_TRUE(alertSequencerUpdate(state, 1150, output));
+    TEST_ASSERT_EQUAL_UINT16(3000, output.toneHz);
+
+    // Ends after 2 x 150 ms
+    TEST_ASSERT_TRUE(alertSequencerUpdate(state, 1299, output));
+    TEST_ASSERT_TRUE(alertSequencerActive(state));
+    TEST_ASSERT_TRUE(alertSequencerUpdate(state, 1300, output));
+    TEST_ASSERT_FALSE(alertSequencerActive(state));
+    TEST_ASSERT_EQUAL_UINT16(0, output.toneHz);
+    TEST_ASSERT_EQUAL_UINT8(0, output.vibrationPercent);
+}
+
+void test_late_update_keeps_schedule(void) {
+    alertSequencerStart(state, &TEST_PATTERN, 0);
+    alertSequencerUpdate(state, 0, output);
+
+    // Woken 30 ms late: lands in the second beep, timed from the schedule
+    TEST_ASSERT_TRUE(alertSequencerUpdate(state, 180, output));
+    TEST_ASSERT_EQUAL_UINT16(3000, output.toneHz);
+    TEST_ASSERT_EQUAL_UINT32(70, alertSequencerNextChangeMs(state, 180));
+
+    // Far too late: the whole pattern is over
+    TEST_ASSERT_TRUE(alertSequencerUpdate(state, 5000, output));
+    TEST_ASSERT_FALSE(alertSequencerActive(state));
+}
+
+void test_restart_replaces_pattern(void) {
+    alertSequencerStart(state, &TEST_PATTERN, 0);
+    alertSequencerUpdate(state, 120, output);
+
+    alertSequencerStart(state, &ALERT_PATTERN_RETURN, 130);
+    TEST_ASSERT_TRUE(alertSequencerUpdate(state, 130, output));
+    TEST_ASSERT_EQUAL_UINT16(ALERT_PATTERN_RETURN.steps[0].toneHz, output.toneHz);
+}
+
+void test_stop_silences(void) {
+    alertSequencerStart(state, &TEST_PATTERN, 0);
+    alertSequencerUpdate(state, 10, output);
+
+    alertSequencerStop(state);
+    TEST_ASSERT_TRUE(alertSequencerUpdate(state, 20, output));
+    TEST_ASSERT_EQUAL_UINT16(0, output.toneHz);
+    TEST_ASSERT_FALSE(alertSequencerUpdate(state, 30, output));
+}
+
+void test_invalid_pattern_is_ignored(void) {
+    AlertPattern empty = {TEST_STEPS, 0, 1};
+    alertSequencerStart(state, &empty, 0);
+    TEST_ASSERT_FALSE(alertSequencerActive(state));
+    alertSequencerStart(state, nullptr, 0);
+    TEST_ASSERT_FALSE(alertSequencerActive(state));
+}
+
+void test_clock_wrap_around(void) {
+    alertSequencerStart(state, &TEST_PATTERN, 0xFFFFFFF0u);
+    alertSequencerUpdate(state, 0xFFFFFFF0u, output);
+    TEST_ASSERT_EQUAL_UINT16(3000, output.toneHz);
+    TEST_ASSERT_TRUE(alertSequencerUpdate(state, 0x00000054u, output));
+    TEST_ASSERT_EQUAL_UINT16(0, output.toneHz);
+}
+
+// ============================================================================
+// Pattern Tests
+// ============================================================================
+
+static uint8_t maxVolume(const AlertPattern& pattern) {
+    uint8_t max = 0;
+    for (uint8_t i = 0; i < pattern.stepCount; i++) {
+        if (pattern.steps[i].volumePercent > max) {
+            max = pattern.steps[i].volumePercent;
+        }
+    }
+    return max;
+}
+
+void test_patterns_for_events(void) {
+    TEST_ASSERT_NULL(alertPatternFor(FenceAlertEvent::NONE, 1));
+    TEST_ASSERT_EQUAL_PTR(&ALERT_PATTERN_EXIT_1, alertPatternFor(FenceAlertEvent::EXITED, 1));
+    TEST_ASSERT_EQUAL_PTR(&ALERT_PATTERN_EXIT_2, alertPatternFor(FenceAlertEvent::ESCALATED, 2));
+    TEST_ASSERT_EQUAL_PTR(&ALERT_PATTERN_EXIT_3, alertPatternFor(FenceAlertEvent::ESCALATED, 3));
+    TEST_ASSERT_EQUAL_PTR(&ALERT_PATTERN_EXIT_3, alertPatternFor(FenceAlertEvent::ESCALATED, 9));
+    TEST_ASSERT_EQUAL_PTR(&ALERT_PATTERN_RETURN, alertPatternFor(FenceAlertEvent::RETURNED, 0));
+}
+
+void test_exit_patterns_escalate(void) {
+    const AlertPattern* levels[] = {&ALERT_PATTERN_EXIT_1, &ALERT_PATTERN_EXIT_2, &ALERT_PATTERN_EXIT_3};
+    for (int i = 1; i < 3; i++) {
+        TEST_ASSERT_TRUE(maxVolume(*levels[i]) > maxVolume(*levels[i - 1]));
+        TEST_ASSERT_TRUE(alertPatternDurationMs(*levels[i]) >= alertPatternDurationMs(*levels[i - 1]));
+    }
+    TEST_ASSERT_EQUAL_UINT8(0, ALERT_PATTERN_EXIT_1.steps[0].vibrationPercent);
+    TEST_ASSERT_EQUAL_UINT8(100, ALERT_PATTERN_EXIT_3.steps[0].vibrationPercent);
+}
+
+void test_patterns_fit_between_wakes(void) {
+    // Shorter than the 5 s wake interval, so alerts never overlap
+    const AlertPattern* patterns[] = {&ALERT_PATTERN_EXIT_1, &ALERT_PATTERN_EXIT_2,
+                                      &ALERT_PATTERN_EXIT_3, &ALERT_PATTERN_RETURN};
+    for (int i = 0; i < 4; i++) {
+        uint32_t duration = alertPatternDurationMs(*patterns[i]);
+        TEST_ASSERT_TRUE(duration > 0);
+        TEST_ASSERT_TRUE(duration < 5000);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1200, alertPatternDurationMs(ALERT_PATTERN_EXIT_1));
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    memset(&state, 0, sizeof(state));
+    memset(&output, 0, sizeof(output));
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Sequencing tests
+    RUN_TEST(test_idle_state_is_silent);
+    RUN_TEST(test_steps_change_at_their_boundaries);
+    RUN_TEST(test_late_update_keeps_schedule);
+    RUN_TEST(test_restart_replaces_pattern);
+    RUN_TEST(test_stop_silences);
+    RUN_TEST(test_invalid_pattern_is_ignored);
+    RUN_TEST(test_clock_wrap_around);
+
+    // Pattern tests
+    RUN_TEST(test_patterns_for_events);
+    RUN_TEST(test_exit_patterns_escalate);
+    RUN_TEST(test_patterns_fit_between_wakes);
+
+    return UNITY_END();
+}
@@ -0,0 +1,259 @@
+/**
+ * @file test_binlog.cpp
+ * @brief Unit tests for the binlog ring buffer and decoder.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "binlog.h"
+#include "log_messages.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+BinLogState state;
+
+static const char* const FORMATS[] = {
+    "(%u dropped)",
+    "Boot",
+    "Position: %.6f, %.6f",
+    "Distance %.1f m, level %d, version %08X",
+    "Unsupported %s"
+};
+static const size_t FORMAT_COUNT = sizeof(FORMATS) / sizeof(FORMATS[0]);
+
+static uint32_t fakeClockMs = 0;
+
+static uint32_t fakeClock() {
+    return fakeClockMs;
+}
+
+// Drain the whole ring (handling wrap-around) into a flat buffer
+static size_t drain(uint8_t* out, size_t max) {
+    size_t total = 0;
+    const uint8_t* data;
+    size_t n;
+    while ((n = binlogPeek(state, &data)) > 0 && total + n <= max) {
+        memcpy(&out[total], data, n);
+        binlogConsume(state, n);
+        total += n;
+    }
+    return total;
+}
+
+static size_t parseAll(const uint8_t* data, size_t len, BinLogRecord* records, size_t max) {
+    size_t count = 0;
+    size_t pos = 0;
+    while (count < max) {
+        bool found;
+        size_t used = binlogParse(&data[pos], len - pos, records[count], found);
+        pos += used;
+        if (!found) {
+            break;
+        }
+        count++;
+    }
+    return count;
+}
+
+// ============================================================================
+// Ring Tests
+// ============================================================================
+
+void test_init_resets_invalid_state(void) {
+    memset(&state, 0xA5, sizeof(state));
+    binlogInit(state);
+    TEST_ASSERT_EQUAL_UINT32(BINLOG_MAGIC, state.magic);
+    TEST_ASSERT_EQUAL_UINT(0, binlogPending(state));
+}
+
+void test_init_keeps_records_across_sleep(void) {
+    uint32_t args[] = {7};
+    TEST_ASSERT_TRUE(binlogWrite(state, 3, 100, args, 1));
+    size_t pending = binlogPending(state);
+
+    binlogInit(state);
+    TEST_ASSERT_EQUAL_UINT(pending, binlogPending(state));
+}
+
+void test_write_and_parse_round_trip(void) {
+    uint32_t args[] = {1, 0xFFFFFFFF, 0x12345678};
+    TEST_ASSERT_TRUE(binlogWrite(state, 3, 123456, args, 3));
+    TEST_ASSERT_EQUAL_UINT(BINLOG_HEADER_SIZE + 12, binlogPending(state));
+
+    uint8_t bytes[64];
+    size_t len = drain(bytes, sizeof(bytes));
+    TEST_ASSERT_EQUAL_UINT(0, binlogPending(state));
+
+    BinLogRecord record;
+    bool found;
+    TEST_ASSERT_EQUAL_UINT(len, binlogParse(bytes, len, record, found));
+    TEST_ASSERT_TRUE(found);
+    TEST_ASSERT_EQUAL_UINT8(3, record.id);
+    TEST_ASSERT_EQUAL_UINT8(3, record.argc);
+    TEST_ASSERT_EQUAL_UINT32(123456, record.timeMs);
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, record.args[1]);
+    TEST_ASSERT_EQUAL_UINT32(0x12345678, record.args[2]);
+}
+
+void test_rejects_too_many_args(void) {
+    uint32_t args[BINLOG_MAX_ARGS + 1] = {0};
+    TEST_ASSERT_FALSE(binlogWrite(state, 1, 0, args, BINLOG_MAX_ARGS + 1));
+    TEST_ASSERT_EQUAL_UINT(0, binlogPending(state));
+}
+
+void test_full_ring_drops_and_reports(void) {
+    // Header-only records until the ring is full
+    size_t written = 0;
+    while (binlogWrite(state, 1, 0, nullptr, 0)) {
+        written++;
+    }
+    TEST_ASSERT_EQUAL_UINT(BINLOG_CAPACITY / BINLOG_HEADER_SIZE, written);
+    TEST_ASSERT_FALSE(binlogWrite(state, 1, 0, nullptr, 0));
+    TEST_ASSERT_EQUAL_UINT32(2, state.dropped);
+
+    // Free some space: the next write is preceded by the drop count
+    uint8_t bytes[BINLOG_CAPACITY];
+    drain(bytes, sizeof(bytes));
+    TEST_ASSERT_TRUE(binlogWrite(state, 2, 0, nullptr, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, state.dropped);
+
+    BinLogRecord records[2];
+    size_t len = drain(bytes, sizeof(bytes));
+    TEST_ASSERT_EQUAL_UINT(2, parseAll(bytes, len, records, 2));
+    TEST_ASSERT_EQUAL_UINT8(BINLOG_DROPPED_ID, records[0].id);
+    TEST_ASSERT_EQUAL_UINT32(2, records[0].args[0]);
+    TEST_ASSERT_EQUAL_UINT8(2, records[1].id);
+}
+
+void test_records_survive_wrap_around(void) {
+    uint8_t bytes[BINLOG_CAPACITY];
+    BinLogRecord records[4];
+
+    // Advance head and tail so records straddle the end of the buffer
+    for (uint32_t i = 0; i < 500; i++) {
+        uint32_t args[] = {i, i * 3};
+        TEST_ASSERT_TRUE(binlogWrite(state, 4, i, args, 2));
+        size_t len = drain(bytes, sizeof(bytes));
+        TEST_ASSERT_EQUAL_UINT(1, parseAll(bytes, len, records, 4));
+        TEST_ASSERT_EQUAL_UINT32(i, records[0].args[0]);
+        TEST_ASSERT_EQUAL_UINT32(i * 3, records[0].args[1]);
+    }
+}
+
+// ============================================================================
+// Default Log Tests
+// ============================================================================
+
+void test_binlog_template_encodes_arguments(void) {
+    binlogAttach(&state, fakeClock);
+    fakeClockMs = 4242;
+    binlog(3, 12.5f, -2, 0xABCDu);
+    binlogAttach(nullptr, nullptr);
+
+    binlog(1);  // Detached: discarded
+
+    uint8_t bytes[64];
+    size_t len = drain(bytes, sizeof(bytes));
+    BinLogRecord records[2];
+    TEST_ASSERT_EQUAL_UINT(1, parseAll(bytes, len, records, 2));
+    TEST_ASSERT_EQUAL_UINT32(4242, records[0].timeMs);
+
+    char text[80];
+    binlogFormat(records[0], FORMATS, FORMAT_COUNT, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("Distance 12.5 m, level -2, version 0000ABCD", text);
+}
+
+// ============================================================================
+// Decoder Tests
+// ============================================================================
+
+void test_parse_skips_noise_and_waits_for_partial(void) {
+    uint32_t args[] = {binlogArg(1.5f), binlogArg(-2.25f)};
+    binlogWrite(state, 2, 10, args, 2);
+
+    uint8_t stream[64] = {'E', 'S', 'P', '-', 'R', 'O', 'M', BINLOG_SYNC, 0x01, 0x09};
+    size_t noise = 10;
+    size_t len = noise + drain(&stream[noise], sizeof(stream) - noise);
+
+    BinLogRecord record;
+    bool found;
+
+    // Only part of the record has arrived: noise consumed, record kept
+    size_t used = binlogParse(stream, len - 1, record, found);
+    TEST_ASSERT_FALSE(found);
+    TEST_ASSERT_EQUAL_UINT(noise, used);
+
+    used = binlogParse(&stream[noise], len - noise, record, found);
+    TEST_ASSERT_TRUE(found);
+    TEST_ASSERT_EQUAL_UINT(len - noise, used);
+
+    char text[64];
+    binlogFormat(record, FORMATS, FORMAT_COUNT, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("Position: 1.500000, -2.250000", text);
+}
+
+void test_format_unknown_id_and_conversion(void) {
+    BinLogRecord record = {200, 1, 0, {0x10, 0, 0, 0}};
+    char text[64];
+    binlogFormat(record, FORMATS, FORMAT_COUNT, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("<unknown id 200> 0x00000010", text);
+
+    record.id = 4;
+    binlogFormat(record, FORMATS, FORMAT_COUNT, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("Unsupported %s", text);
+}
+
+void test_format_truncates(void) {
+    BinLogRecord record = {2, 2, 0, {binlogArg(1.0f), binlogArg(2.0f), 0, 0}};
+    char text[8];
+    TEST_ASSERT_EQUAL_UINT(7, binlogFormat(record, FORMATS, FORMAT_COUNT, text, sizeof(text)));
+    TEST_ASSERT_EQUAL_STRING("Positio", text);
+}
+
+void test_catalogue_ids(void) {
+    TEST_ASSERT_EQUAL_UINT8(BINLOG_DROPPED_ID, LOG_DROPPED);
+    TEST_ASSERT_TRUE(LOG_MESSAGE_COUNT > LOG_BOOT);
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    memset(&state, 0, sizeof(state));
+    binlogInit(state);
+    binlogAttach(nullptr, nullptr);
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Ring tests
+    RUN_TEST(test_init_resets_invalid_state);
+    RUN_TEST(test_init_keeps_records_across_sleep);
+    RUN_TEST(test_write_and_parse_round_trip);
+    RUN_TEST(test_rejects_too_many_args);
+    RUN_TEST(test_full_ring_drops_and_reports);
+    RUN_TEST(test_records_survive_wrap_around);
+
+    // Default log tests
+    RUN_TEST(test_binlog_template_encodes_arguments);
+
+    // Decoder tests
+    RUN_TEST(test_parse_skips_noise_and_waits_for_partial);
+    RUN_TEST(test_format_unknown_id_and_conversion);
+    RUN_TEST(test_format_truncates);
+    RUN_TEST(test_catalogue_ids);
+
+    return UNITY_END();
+}
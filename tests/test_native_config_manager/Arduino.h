@@ -0,0 +1,18 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the Arduino core, for the ConfigManager tests.
+ *
+ * ConfigManager only needs the C library from it.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef TEST_ARDUINO_H
+#define TEST_ARDUINO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#endif // TEST_ARDUINO_H
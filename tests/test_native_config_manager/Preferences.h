@@ -0,0 +1,160 @@
+/**
+ * @file Preferences.h
+ * @brief Host stand-in for NVS-backed Preferences, for the ConfigManager tests.
+ *
+ * Keys live in one process-wide table, so a second ConfigManager sees what
+ * the first one saved, like a reboot does. preferencesReset() erases NVS.
+ * preferencesLoseWritesAfter(n) plays a reset after n more writes: later
+ * writes are dropped.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef TEST_PREFERENCES_H
+#define TEST_PREFERENCES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+struct PreferencesEntry {
+    char key[16];
+    size_t size;
+    uint8_t value[160];
+};
+
+constexpr size_t PREFERENCES_MAX_ENTRIES = 64;
+
+inline PreferencesEntry* preferencesTable() {
+    static PreferencesEntry table[PREFERENCES_MAX_ENTRIES];
+    return table;
+}
+
+inline int& preferencesWriteBudget() {
+    static int budget = -1;
+    return budget;
+}
+
+inline void preferencesReset() {
+    memset(preferencesTable(), 0, sizeof(PreferencesEntry) * PREFERENCES_MAX_ENTRIES);
+    preferencesWriteBudget() = -1;
+}
+
+inline void preferencesLoseWritesAfter(int writes) {
+    preferencesWriteBudget() = writes;
+}
+
+inline PreferencesEntry* preferencesFind(const char* key) {
+    PreferencesEntry* table = preferencesTable();
+    for (size_t i = 0; i < PREFERENCES_MAX_ENTRIES; i++) {
+        if (strcmp(table[i].key, key) == 0) {
+            return &table[i];
+        }
+    }
+    return nullptr;
+}
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false) {
+        (void)name;
+        (void)readOnly;
+        return true;
+    }
+
+    void end() {}
+
+    bool isKey(const char* key) {
+        return find(key, false) != nullptr;
+    }
+
+    float getFloat(const char* key, float defaultValue = 0.0f) {
+        get(key, &defaultValue, sizeof(defaultValue));
+        return defaultValue;
+    }
+
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) {
+        get(key, &defaultValue, sizeof(defaultValue));
+        return defaultValue;
+    }
+
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) {
+        get(key, &defaultValue, sizeof(defaultValue));
+        return defaultValue;
+    }
+
+    size_t putFloat(const char* key, float value) {
+        return put(key, &value, sizeof(value));
+    }
+
+    size_t putUChar(const char* key, uint8_t value) {
+        return put(key, &value, sizeof(value));
+    }
+
+    size_t putUInt(const char* key, uint32_t value) {
+        return put(key, &value, sizeof(value));
+    }
+
+    size_t putBytes(const char* key, const void* value, size_t size) {
+        return put(key, value, size);
+    }
+
+    size_t getBytesLength(const char* key) {
+        PreferencesEntry* entry = find(key, false);
+        return entry != nullptr ? entry->size : 0;
+    }
+
+    size_t getBytes(const char* key, void* value, size_t maxSize) {
+        PreferencesEntry* entry = find(key, false);
+        if (entry == nullptr || entry->size > maxSize) {
+            return 0;
+        }
+        memcpy(value, entry->value, entry->size);
+        return entry->size;
+    }
+
+private:
+    PreferencesEntry* find(const char* key, bool create) {
+        PreferencesEntry* table = preferencesTable();
+        PreferencesEntry* unused = nullptr;
+        for (size_t i = 0; i < PREFERENCES_MAX_ENTRIES; i++) {
+            if (strcmp(table[i].key, key) == 0) {
+                return &table[i];
+            }
+            if (unused == nullptr && table[i].key[0] == '\0') {
+                unused = &table[i];
+            }
+        }
+        if (create && unused != nullptr && strlen(key) < sizeof(unused->key)) {
+            strcpy(unused->key, key);
+            return unused;
+        }
+        return nullptr;
+    }
+
+    void get(const char* key, void* value, size_t size) {
+        PreferencesEntry* entry = find(key, false);
+        if (entry != nullptr && entry->size == size) {
+            memcpy(value, entry->value, size);
+        }
+    }
+
+    size_t put(const char* key, const void* value, size_t size) {
+        int& budget = preferencesWriteBudget();
+        if (budget == 0) {
+            return 0;
+        }
+        if (budget > 0) {
+            budget--;
+        }
+        PreferencesEntry* entry = find(key, true);
+        if (entry == nullptr || size > sizeof(entry->value)) {
+            return 0;
+        }
+        memcpy(entry->value, value, size);
+        entry->size = size;
+        return size;
+    }
+};
+
+#endif // TEST_PREFERENCES_H
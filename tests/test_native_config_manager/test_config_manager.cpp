@@ -0,0 +1,259 @@
+/**
+ * @file test_config_manager.cpp
+ * @brief Unit tests for ConfigManager against an in-memory NVS.
+ *
+ * Run with: pio test -e native
+ *
+ * Arduino.h and Preferences.h next to this file stand in for the ESP32
+ * core. Each test starts from erased NVS; a second ConfigManager on the
+ * same NVS plays the next boot.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include "config_manager.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+// Pentagon around the default location, counter-clockwise
+static const GeoPoint pentagon[] = {
+    {40.7220f, -74.0220f},
+    {40.7220f, -74.0200f},
+    {40.7230f, -74.0195f},
+    {40.7240f, -74.0210f},
+    {40.7230f, -74.0225f}
+};
+static const size_t pentagonCount = 5;
+
+// Triangle, also counter-clockwise
+static const GeoPoint triangle[] = {
+    {40.7200f, -74.0230f},
+    {40.7200f, -74.0190f},
+    {40.7250f, -74.0210f}
+};
+static const size_t triangleCount = 3;
+
+static void saveFence(const GeoPoint* vertices, size_t count, uint32_t version) {
+    ConfigManager config;
+    TEST_ASSERT_TRUE(config.begin());
+    TEST_ASSERT_TRUE(config.setBoundaryVertices(vertices, count));
+    config.setFenceVersion(version);
+    TEST_ASSERT_TRUE(config.save());
+}
+
+// ============================================================================
+// Load Tests
+// ============================================================================
+
+void test_first_boot_uses_defaults(void) {
+    ConfigManager config;
+    TEST_ASSERT_TRUE(config.begin());
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_LATITUDE, config.getDefaultLatitude());
+    TEST_ASSERT_EQUAL_UINT(DEFAULT_BOUNDARY_VERTEX_COUNT, config.getBoundaryVertexCount());
+    TEST_ASSERT_EQUAL_UINT32(0, config.getFenceVersion());
+}
+
+void test_boundary_survives_reboot(void) {
+    {
+        ConfigManager config;
+        TEST_ASSERT_TRUE(config.begin());
+        TEST_ASSERT_TRUE(config.setBoundaryVertices(pentagon, pentagonCount));
+        config.setFenceVersion(0x00070001);
+        TEST_ASSERT_TRUE(config.save());
+    }
+
+    // load() once freed the boundary after reading its count, leaving none
+    ConfigManager config;
+    TEST_ASSERT_TRUE(config.begin());
+    TEST_ASSERT_EQUAL_UINT(pentagonCount, config.getBoundaryVertexCount());
+    TEST_ASSERT_NOT_NULL(config.getBoundaryVertices());
+    for (size_t i = 0; i < pentagonCount; i++) {
+        TEST_ASSERT_EQUAL_FLOAT(pentagon[i].lat, config.getBoundaryVertices()[i].lat);
+        TEST_ASSERT_EQUAL_FLOAT(pentagon[i].lon, config.getBoundaryVertices()[i].lon);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0x00070001, config.getFenceVersion());
+}
+
+void test_defaults_survive_reboot(void) {
+    {
+        ConfigManager config;
+        TEST_ASSERT_TRUE(config.begin());
+    }
+
+    ConfigManager config;
+    TEST_ASSERT_TRUE(config.begin());
+    TEST_ASSERT_EQUAL_UINT(DEFAULT_BOUNDARY_VERTEX_COUNT, config.getBoundaryVertexCount());
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_BOUNDARY_VERTICES[2].lat, config.getBoundaryVertices()[2].lat);
+}
+
+// ============================================================================
+// Atomic Save Tests
+// ============================================================================
+
+void test_interrupted_save_keeps_a_whole_fence(void) {
+    // A save is two floats, the staged record and the slot key
+    for (int writes = 0; writes <= 4; writes++) {
+        preferencesReset();
+        saveFence(pentagon, pentagonCount, 0x00070001);
+
+        {
+            ConfigManager config;
+            TEST_ASSERT_TRUE(config.begin());
+            TEST_ASSERT_TRUE(config.setBoundaryVertices(triangle, triangleCount));
+            config.setFenceVersion(0x00070002);
+            preferencesLoseWritesAfter(writes);
+            TEST_ASSERT_EQUAL(writes == 4, config.save());
+            preferencesLoseWritesAfter(-1);
+        }
+
+        // Next boot: the old fence and version, or the new ones, never a mix
+        ConfigManager config;
+        TEST_ASSERT_TRUE(config.begin());
+        if (writes < 4) {
+            TEST_ASSERT_EQUAL_UINT32(0x00070001, config.getFenceVersion());
+            TEST_ASSERT_EQUAL_UINT(pentagonCount, config.getBoundaryVertexCount());
+            TEST_ASSERT_EQUAL_FLOAT(pentagon[3].lat, config.getBoundaryVertices()[3].lat);
+        } else {
+            TEST_ASSERT_EQUAL_UINT32(0x00070002, config.getFenceVersion());
+            TEST_ASSERT_EQUAL_UINT(triangleCount, config.getBoundaryVertexCount());
+            TEST_ASSERT_EQUAL_FLOAT(triangle[2].lat, config.getBoundaryVertices()[2].lat);
+        }
+    }
+}
+
+void test_saves_alternate_records(void) {
+    saveFence(pentagon, pentagonCount, 0x00070001);
+    saveFence(triangle, triangleCount, 0x00070002);
+    saveFence(pentagon, pentagonCount, 0x00070003);
+
+    ConfigManager config;
+    TEST_ASSERT_TRUE(config.begin());
+    TEST_ASSERT_EQUAL_UINT32(0x00070003, config.getFenceVersion());
+    TEST_ASSERT_EQUAL_UINT(pentagonCount, config.getBoundaryVertexCount());
+}
+
+void test_corrupt_record_falls_back_to_previous(void) {
+    saveFence(pentagon, pentagonCount, 0x00070001);
+    saveFence(triangle, triangleCount, 0x00070002);
+
+    PreferencesEntry* slot = preferencesFind(KEY_FENCE_SLOT);
+    TEST_ASSERT_NOT_NULL(slot);
+    PreferencesEntry* active = preferencesFind(slot->value[0] ? KEY_FENCE_RECORD_B : KEY_FENCE_RECORD_A);
+    TEST_ASSERT_NOT_NULL(active);
+    active->value[10] ^= 0x40;
+
+    ConfigManager config;
+    TEST_ASSERT_TRUE(config.begin());
+    TEST_ASSERT_EQUAL_UINT32(0x00070001, config.getFenceVersion());
+    TEST_ASSERT_EQUAL_UINT(pentagonCount, config.getBoundaryVertexCount());
+}
+
+void test_migrates_per_vertex_keys(void) {
+    // Layout written by older firmware
+    Preferences prefs;
+    prefs.putFloat(KEY_LATITUDE, 40.0f);
+    prefs.putFloat(KEY_LONGITUDE, -74.0f);
+    prefs.putUChar(KEY_BOUNDARY_COUNT, triangleCount);
+    prefs.putUInt(KEY_FENCE_VERSION, 0x00050003);
+    char key[32];
+    for (size_t i = 0; i < triangleCount; i++) {
+        snprintf(key, sizeof(key), "%s%u_lat", KEY_BOUNDARY_PREFIX, static_cast<unsigned>(i));
+        prefs.putFloat(key, triangle[i].lat);
+        snprintf(key, sizeof(key), "%s%u_lon", KEY_BOUNDARY_PREFIX, static_cast<unsigned>(i));
+        prefs.putFloat(key, triangle[i].lon);
+    }
+
+    {
+        ConfigManager config;
+        TEST_ASSERT_TRUE(config.begin());
+        TEST_ASSERT_EQUAL_UINT32(0x00050003, config.getFenceVersion());
+        TEST_ASSERT_EQUAL_UINT(triangleCount, config.getBoundaryVertexCount());
+        TEST_ASSERT_EQUAL_FLOAT(triangle[1].lon, config.getBoundaryVertices()[1].lon);
+        TEST_ASSERT_TRUE(config.save());
+    }
+
+    ConfigManager config;
+    TEST_ASSERT_TRUE(config.begin());
+    TEST_ASSERT_TRUE(prefs.isKey(KEY_FENCE_SLOT));
+    TEST_ASSERT_EQUAL_UINT32(0x00050003, config.getFenceVersion());
+    TEST_ASSERT_EQUAL_UINT(triangleCount, config.getBoundaryVertexCount());
+}
+
+// ============================================================================
+// Verdict Tests
+// ============================================================================
+
+void test_verdict_describes_one_fence(void) {
+    ConfigManager config;
+    TEST_ASSERT_TRUE(config.begin());
+    TEST_ASSERT_TRUE(config.setBoundaryVertices(pentagon, pentagonCount));
+    uint32_t crc = config.getBoundaryCrc();
+    TEST_ASSERT_EQUAL(FenceVerdict::CLEAN, config.getFenceVerdict(FenceSource::NVS, crc));
+
+    // A partition fence, or other NVS contents, are not what was checked
+    TEST_ASSERT_EQUAL(FenceVerdict::UNCHECKED, config.getFenceVerdict(FenceSource::PARTITION, crc));
+    TEST_ASSERT_EQUAL(FenceVerdict::UNCHECKED, config.getFenceVerdict(FenceSource::NVS, crc ^ 1));
+}
+
+void test_verdict_survives_reboot(void) {
+    {
+        ConfigManager config;
+        TEST_ASSERT_TRUE(config.begin());
+        config.setFenceVerdict(FenceVerdict::SELF_INTERSECTING, FenceSource::PARTITION, 0x1234ABCD);
+        config.setFenceVersion(0x00090001);
+        TEST_ASSERT_TRUE(config.save());
+    }
+
+    ConfigManager config;
+    TEST_ASSERT_TRUE(config.begin());
+    TEST_ASSERT_EQUAL(FenceVerdict::SELF_INTERSECTING,
+                      config.getFenceVerdict(FenceSource::PARTITION, 0x1234ABCD));
+    // Falling back to the NVS fence does not inherit the partition verdict
+    TEST_ASSERT_EQUAL(FenceVerdict::UNCHECKED,
+                      config.getFenceVerdict(FenceSource::NVS, config.getBoundaryCrc()));
+}
+
+void test_first_boot_verdict_is_unchecked(void) {
+    ConfigManager config;
+    TEST_ASSERT_TRUE(config.begin());
+    TEST_ASSERT_EQUAL(FenceVerdict::UNCHECKED,
+                      config.getFenceVerdict(FenceSource::NVS, config.getBoundaryCrc()));
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    preferencesReset();
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Load tests
+    RUN_TEST(test_first_boot_uses_defaults);
+    RUN_TEST(test_boundary_survives_reboot);
+    RUN_TEST(test_defaults_survive_reboot);
+
+    // Atomic save tests
+    RUN_TEST(test_interrupted_save_keeps_a_whole_fence);
+    RUN_TEST(test_saves_alternate_records);
+    RUN_TEST(test_corrupt_record_falls_back_to_previous);
+    RUN_TEST(test_migrates_per_vertex_keys);
+
+    // Verdict tests
+    RUN_TEST(test_verdict_describes_one_fence);
+    RUN_TEST(test_verdict_survives_reboot);
+    RUN_TEST(test_first_boot_verdict_is_unchecked);
+
+    return UNITY_END();
+}
@@ -0,0 +1,227 @@
+/**
+ * @file test_containment_fuzz.cpp
+ * @brief Unit tests for the containment_fuzz library, and the seed corpus.
+ *
+ * Run with: pio test -e native
+ *
+ * The seed corpus test runs the same inputs libFuzzer starts from
+ * (tools/fuzz_containment.cpp --seed-corpus), so a kernel change that
+ * breaks containment fails here first.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "containment_fuzz.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+static const uint32_t SEED_CORPUS_SIZE = 20000;
+
+static const GeoPoint SQUARE[] = {
+    {0.0f, 0.0f}, {0.0f, 10.0f}, {10.0f, 10.0f}, {10.0f, 0.0f}
+};
+
+// A U opening north: two arms joined along the bottom
+static const GeoPoint U_SHAPE[] = {
+    {0.0f, 0.0f}, {0.0f, 30.0f}, {30.0f, 30.0f}, {30.0f, 20.0f},
+    {10.0f, 20.0f}, {10.0f, 10.0f}, {30.0f, 10.0f}, {30.0f, 0.0f}
+};
+
+static GeoPoint point(float lat, float lon) {
+    GeoPoint p = {lat, lon};
+    return p;
+}
+
+// Ray casting that forgets the closing edge, as an unrolled loop might
+static bool skipsClosingEdge(const GeoPoint& p, const GeoPoint* vertices, size_t count) {
+    bool inside = false;
+    for (size_t i = 1; i < count; i++) {
+        const GeoPoint& a = vertices[i];
+        const GeoPoint& b = vertices[i - 1];
+        if ((a.lat > p.lat) != (b.lat > p.lat) &&
+            p.lon < (b.lon - a.lon) * (p.lat - a.lat) / (b.lat - a.lat) + a.lon) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+static const ContainmentKernelInfo BROKEN_KERNEL = {
+    "skipsClosingEdge()", "skipsClosingEdge(point, fence, %lu)", skipsClosingEdge
+};
+
+// ============================================================================
+// Reference Tests
+// ============================================================================
+
+void test_reference_square(void) {
+    TEST_ASSERT_EQUAL(ContainmentTruth::INSIDE, containmentReference(point(5.0f, 5.0f), SQUARE, 4));
+    TEST_ASSERT_EQUAL(ContainmentTruth::OUTSIDE, containmentReference(point(5.0f, 15.0f), SQUARE, 4));
+    TEST_ASSERT_EQUAL(ContainmentTruth::OUTSIDE, containmentReference(point(-1.0f, 5.0f), SQUARE, 4));
+    TEST_ASSERT_EQUAL(ContainmentTruth::OUTSIDE, containmentReference(point(5.0f, 5.0f), SQUARE, 2));
+}
+
+void test_reference_u_shape(void) {
+    TEST_ASSERT_EQUAL(ContainmentTruth::INSIDE, containmentReference(point(20.0f, 5.0f), U_SHAPE, 8));
+    TEST_ASSERT_EQUAL(ContainmentTruth::INSIDE, containmentReference(point(20.0f, 25.0f), U_SHAPE, 8));
+    TEST_ASSERT_EQUAL(ContainmentTruth::OUTSIDE, containmentReference(point(20.0f, 15.0f), U_SHAPE, 8));
+    // The ray passes through the U's inner corners
+    TEST_ASSERT_EQUAL(ContainmentTruth::INSIDE, containmentReference(point(10.0f, 5.0f), U_SHAPE, 8));
+}
+
+void test_reference_edges_uncertain(void) {
+    TEST_ASSERT_EQUAL(ContainmentTruth::UNCERTAIN, containmentReference(point(5.0f, 10.0f), SQUARE, 4));
+    TEST_ASSERT_EQUAL(ContainmentTruth::UNCERTAIN, containmentReference(point(5.0f, 0.0f), SQUARE, 4));
+    TEST_ASSERT_EQUAL(ContainmentTruth::UNCERTAIN,
+                      containmentReference(point(5.0f, nextafterf(10.0f, 0.0f)), SQUARE, 4));
+    // Well clear of the band
+    TEST_ASSERT_EQUAL(ContainmentTruth::INSIDE, containmentReference(point(5.0f, 9.999f), SQUARE, 4));
+}
+
+// ============================================================================
+// Decoding Tests
+// ============================================================================
+
+void test_decode_rejects_short_input(void) {
+    ContainmentCase testCase;
+    uint8_t data[32] = {0};
+    TEST_ASSERT_FALSE(containmentDecode(nullptr, 0, testCase));
+    TEST_ASSERT_FALSE(containmentDecode(data, 5, testCase));
+    // Three vertices but no point
+    TEST_ASSERT_FALSE(containmentDecode(data, 6 + 9, testCase));
+    TEST_ASSERT_TRUE(containmentDecode(data, 6 + 9 + 3, testCase));
+    TEST_ASSERT_EQUAL(3, testCase.vertices.size());
+    TEST_ASSERT_EQUAL(1, testCase.points.size());
+}
+
+void test_seeds_decode(void) {
+    std::vector<uint8_t> bytes;
+    ContainmentCase testCase;
+    for (uint32_t seed = 0; seed < 400; seed++) {
+        containmentSeed(seed, bytes);
+        TEST_ASSERT_TRUE(containmentDecode(bytes.data(), bytes.size(), testCase));
+        TEST_ASSERT_TRUE(testCase.vertices.size() >= 3);
+        TEST_ASSERT_TRUE(testCase.vertices.size() <= CONTAINMENT_MAX_VERTICES);
+        TEST_ASSERT_TRUE(testCase.points.size() >= 32);
+    }
+    // Deterministic
+    std::vector<uint8_t> again;
+    containmentSeed(123, bytes);
+    containmentSeed(123, again);
+    TEST_ASSERT_TRUE(bytes == again);
+}
+
+// ============================================================================
+// Differential Tests
+// ============================================================================
+
+void test_seed_corpus_agrees(void) {
+    std::vector<uint8_t> bytes;
+    ContainmentMismatch mismatch;
+    uint32_t decided = 0;
+    for (uint32_t seed = 0; seed < SEED_CORPUS_SIZE; seed++) {
+        containmentSeed(seed, bytes);
+        if (!containmentFuzzOne(bytes.data(), bytes.size(), mismatch)) {
+            char text[2048];
+            containmentFormat(mismatch, text, sizeof(text));
+            TEST_MESSAGE(text);
+            TEST_FAIL_MESSAGE("containment kernel disagrees with the reference");
+        }
+
+        // Make sure most points are actually decided, not waved through
+        ContainmentCase testCase;
+        containmentDecode(bytes.data(), bytes.size(), testCase);
+        for (const GeoPoint& p : testCase.points) {
+            if (containmentReference(p, testCase.vertices.data(), testCase.vertices.size()) !=
+                ContainmentTruth::UNCERTAIN) {
+                decided++;
+            }
+        }
+    }
+    char message[96];
+    snprintf(message, sizeof(message), "%lu seeds, %lu decided points", static_cast<unsigned long>(SEED_CORPUS_SIZE),
+             static_cast<unsigned long>(decided));
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(decided > SEED_CORPUS_SIZE * 16);
+}
+
+void test_broken_kernel_found_and_minimized(void) {
+    std::vector<uint8_t> bytes;
+    ContainmentCase testCase;
+    ContainmentMismatch mismatch;
+    bool found = false;
+    for (uint32_t seed = 0; seed < 200 && !found; seed++) {
+        containmentSeed(seed, bytes);
+        containmentDecode(bytes.data(), bytes.size(), testCase);
+        found = !containmentCheck(testCase, &BROKEN_KERNEL, 1, mismatch);
+    }
+    TEST_ASSERT_TRUE(found);
+    TEST_ASSERT_EQUAL_PTR(&BROKEN_KERNEL, mismatch.kernel);
+
+    containmentMinimize(mismatch);
+    TEST_ASSERT_TRUE(mismatch.vertices.size() <= 4);
+
+    // The reproducer still fails, and only the broken kernel
+    ContainmentTruth truth = containmentReference(mismatch.point, mismatch.vertices.data(), mismatch.vertices.size());
+    TEST_ASSERT_NOT_EQUAL(ContainmentTruth::UNCERTAIN, truth);
+    TEST_ASSERT_NOT_EQUAL(truth == ContainmentTruth::INSIDE, mismatch.got);
+    TEST_ASSERT_EQUAL(truth == ContainmentTruth::INSIDE,
+                      pointInPolygon(mismatch.point, mismatch.vertices.data(), mismatch.vertices.size()));
+}
+
+void test_format_reproducer(void) {
+    ContainmentMismatch mismatch;
+    mismatch.kernel = &BROKEN_KERNEL;
+    mismatch.vertices.assign(SQUARE, SQUARE + 4);
+    mismatch.point = point(5.0f, 2.5f);
+    mismatch.got = false;
+
+    char text[1024];
+    size_t length = containmentFormat(mismatch, text, sizeof(text));
+    TEST_ASSERT_EQUAL(strlen(text), length);
+    TEST_ASSERT_NOT_NULL(strstr(text, "GeoPoint fence[] = {"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "{10.0f, 10.0f}"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "GeoPoint point = {5.0f, 2.5f};"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "TEST_ASSERT_TRUE(skipsClosingEdge(point, fence, 4));"));
+
+    // Truncates like snprintf
+    char small[16];
+    TEST_ASSERT_EQUAL(length, containmentFormat(mismatch, small, sizeof(small)));
+    TEST_ASSERT_EQUAL(15, strlen(small));
+}
+
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Reference tests
+    RUN_TEST(test_reference_square);
+    RUN_TEST(test_reference_u_shape);
+    RUN_TEST(test_reference_edges_uncertain);
+
+    // Decoding tests
+    RUN_TEST(test_decode_rejects_short_input);
+    RUN_TEST(test_seeds_decode);
+
+    // Differential tests
+    RUN_TEST(test_seed_corpus_agrees);
+    RUN_TEST(test_broken_kernel_found_and_minimized);
+    RUN_TEST(test_format_reproducer);
+
+    return UNITY_END();
+}
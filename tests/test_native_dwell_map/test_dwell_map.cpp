@@ -0,0 +1,307 @@
+/**
+ * @file test_dwell_map.cpp
+ * @brief Unit tests for the dwell_map library.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <thread>
+#include <vector>
+#include "dwell_map.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+// A yard of about 110 x 85 m, and a gate paddock overlapping its east side
+static const GeoPoint YARD[] = {
+    {40.7000f, -74.0010f}, {40.7000f, -74.0000f}, {40.7010f, -74.0000f}, {40.7010f, -74.0010f}
+};
+static const GeoPoint PADDOCK[] = {
+    {40.7004f, -74.0003f}, {40.7004f, -73.9995f}, {40.7008f, -73.9995f}, {40.7008f, -74.0003f}
+};
+static const Polygon FENCES[] = {Polygon(YARD, 4), Polygon(PADDOCK, 4)};
+
+static const uint32_t COLLAR = 7;
+
+static PositionFix fixAt(int32_t latE6, int32_t lonE6, uint32_t timestamp) {
+    PositionFix fix = {latE6, lonE6, timestamp};
+    return fix;
+}
+
+// A wandering track around the yard, with an hour-long gap every 500 fixes
+static std::vector<PositionFix> makeTrack(size_t count) {
+    std::vector<PositionFix> fixes;
+    uint32_t seed = 11;
+    int32_t lat = 40700500;
+    int32_t lon = -74000500;
+    uint32_t time = 1000;
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        lat += static_cast<int32_t>((seed >> 8) % 41) - 20 + (40700500 - lat) / 50;
+        lon += static_cast<int32_t>((seed >> 16) % 61) - 30 + (-74000500 - lon) / 50;
+        time += (i % 500 == 499) ? 3600 : 5;
+        fixes.push_back(fixAt(lat, lon, time));
+    }
+    return fixes;
+}
+
+static DwellTotals sumLevel(const DwellMap& map, uint8_t level) {
+    std::vector<DwellHeatCell> cells;
+    map.heatmap(COLLAR, level, -90000000, -180000000, 90000000, 180000000, cells);
+    DwellTotals sum = {0, 0};
+    for (const DwellHeatCell& cell : cells) {
+        sum.fixes += cell.value.fixes;
+        sum.seconds += cell.value.seconds;
+    }
+    return sum;
+}
+
+static void assertSameMaps(const DwellMap& expected, const DwellMap& actual) {
+    TEST_ASSERT_EQUAL_UINT64(expected.totals(COLLAR).fixes, actual.totals(COLLAR).fixes);
+    TEST_ASSERT_EQUAL_UINT64(expected.totals(COLLAR).seconds, actual.totals(COLLAR).seconds);
+    for (size_t f = 0; f < 2; f++) {
+        TEST_ASSERT_EQUAL_UINT64(expected.fenceSeconds(COLLAR, f), actual.fenceSeconds(COLLAR, f));
+    }
+    for (uint8_t level = 0; level < DWELL_LEVELS; level++) {
+        std::vector<DwellHeatCell> a;
+        std::vector<DwellHeatCell> b;
+        expected.heatmap(COLLAR, level, -90000000, -180000000, 90000000, 180000000, a);
+        actual.heatmap(COLLAR, level, -90000000, -180000000, 90000000, 180000000, b);
+        TEST_ASSERT_EQUAL(a.size(), b.size());
+        for (const DwellHeatCell& cell : a) {
+            DwellCell value = actual.cell(COLLAR, level, cell.latE6, cell.lonE6);
+            TEST_ASSERT_EQUAL_UINT32(cell.value.fixes, value.fixes);
+            TEST_ASSERT_EQUAL_UINT32(cell.value.seconds, value.seconds);
+        }
+    }
+}
+
+// ============================================================================
+// Grid Tests
+// ============================================================================
+
+void test_fix_counts_at_every_level(void) {
+    DwellMap map(FENCES, 2);
+    map.add(COLLAR, fixAt(40700500, -74000500, 100));
+
+    for (uint8_t level = 0; level < DWELL_LEVELS; level++) {
+        DwellCell cell = map.cell(COLLAR, level, 40700500, -74000500);
+        TEST_ASSERT_EQUAL_UINT32(1, cell.fixes);
+        TEST_ASSERT_EQUAL_UINT32(0, cell.seconds);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, map.cell(COLLAR, 0, 40701500, -74000500).fixes);
+    TEST_ASSERT_EQUAL_UINT32(0, map.cell(99, 0, 40700500, -74000500).fixes);
+}
+
+void test_time_goes_to_previous_fix(void) {
+    DwellMap map(FENCES, 2, 60);
+    map.add(COLLAR, fixAt(40700500, -74000500, 100));
+    map.add(COLLAR, fixAt(40700900, -74000500, 130));     // 30 s at the first fix
+    map.add(COLLAR, fixAt(40700500, -74000500, 1000));    // Capped at 60 s
+    map.add(COLLAR, fixAt(40700500, -74000500, 10));      // Clock restart: no time
+
+    TEST_ASSERT_EQUAL_UINT32(30, map.cell(COLLAR, 0, 40700500, -74000500).seconds);
+    TEST_ASSERT_EQUAL_UINT32(3, map.cell(COLLAR, 0, 40700500, -74000500).fixes);
+    TEST_ASSERT_EQUAL_UINT32(60, map.cell(COLLAR, 0, 40700900, -74000500).seconds);
+    TEST_ASSERT_EQUAL_UINT64(4, map.totals(COLLAR).fixes);
+    TEST_ASSERT_EQUAL_UINT64(90, map.totals(COLLAR).seconds);
+
+    // 400 microdegrees apart: one cell at level 3 (512) and above
+    TEST_ASSERT_EQUAL_UINT32(90, map.cell(COLLAR, 3, 40700500, -74000500).seconds);
+}
+
+void test_levels_sum_to_the_same_totals(void) {
+    DwellMap map(FENCES, 2);
+    std::vector<PositionFix> track = makeTrack(5000);
+    for (const PositionFix& fix : track) {
+        map.add(COLLAR, fix);
+    }
+
+    DwellTotals totals = map.totals(COLLAR);
+    TEST_ASSERT_EQUAL_UINT64(track.size(), totals.fixes);
+    for (uint8_t level = 0; level < DWELL_LEVELS; level++) {
+        DwellTotals sum = sumLevel(map, level);
+        TEST_ASSERT_EQUAL_UINT64(totals.fixes, sum.fixes);
+        TEST_ASSERT_EQUAL_UINT64(totals.seconds, sum.seconds);
+    }
+}
+
+void test_negative_coordinates_floor(void) {
+    DwellMap map(FENCES, 2);
+    map.add(COLLAR, fixAt(-1, -1, 0));
+    map.add(COLLAR, fixAt(0, 0, 10));
+
+    TEST_ASSERT_EQUAL_UINT32(10, map.cell(COLLAR, 0, -64, -64).seconds);
+    TEST_ASSERT_EQUAL_UINT32(0, map.cell(COLLAR, 0, 0, 0).seconds);
+    TEST_ASSERT_EQUAL_UINT32(1, map.cell(COLLAR, 0, 63, 63).fixes);
+
+    std::vector<DwellHeatCell> cells;
+    TEST_ASSERT_EQUAL(2, map.heatmap(COLLAR, 0, -10, -10, 10, 10, cells));
+    TEST_ASSERT_EQUAL_INT32(-64, cells[0].latE6 < cells[1].latE6 ? cells[0].latE6 : cells[1].latE6);
+}
+
+void test_heatmap_clips_to_box(void) {
+    // A diagonal of level 0 cells, starting on a cell corner
+    const int32_t baseLat = 40700032;
+    const int32_t baseLon = -74000000;
+    DwellMap map(FENCES, 2);
+    for (int32_t i = 0; i < 40; i++) {
+        map.add(COLLAR, fixAt(baseLat + i * 64, baseLon + i * 64, static_cast<uint32_t>(i) * 5));
+    }
+
+    std::vector<DwellHeatCell> cells;
+    TEST_ASSERT_EQUAL(40, map.heatmap(COLLAR, 0, baseLat, baseLon, baseLat + 3000, baseLon + 3000, cells));
+    cells.clear();
+    TEST_ASSERT_EQUAL(10, map.heatmap(COLLAR, 0, baseLat + 640, baseLon, baseLat + 1279, baseLon + 3000, cells));
+    for (const DwellHeatCell& cell : cells) {
+        TEST_ASSERT_TRUE(cell.latE6 >= baseLat + 640 && cell.latE6 < baseLat + 1280);
+        TEST_ASSERT_EQUAL_INT32(cell.latE6 - baseLat, cell.lonE6 - baseLon);
+        TEST_ASSERT_EQUAL_UINT32(1, cell.value.fixes);
+    }
+    cells.clear();
+    TEST_ASSERT_EQUAL(0, map.heatmap(COLLAR, 0, baseLat + 10000, baseLon, baseLat + 20000, baseLon + 3000, cells));
+}
+
+void test_resting_dog_allocates_nothing_new(void) {
+    DwellMap map(FENCES, 2);
+    map.add(COLLAR, fixAt(40700500, -74000500, 0));
+    size_t tiles = map.tileCount();
+    TEST_ASSERT_EQUAL(DWELL_LEVELS, tiles);
+
+    for (uint32_t i = 1; i < 10000; i++) {
+        map.add(COLLAR, fixAt(40700500 + static_cast<int32_t>(i % 3), -74000500, i * 5));
+    }
+    TEST_ASSERT_EQUAL(tiles, map.tileCount());
+    TEST_ASSERT_EQUAL_UINT32(10000, map.cell(COLLAR, 0, 40700500, -74000500).fixes);
+}
+
+// ============================================================================
+// Fence Tests
+// ============================================================================
+
+void test_fence_dwell(void) {
+    DwellMap map(FENCES, 2);
+    uint32_t time = 0;
+    for (int i = 0; i < 10; i++, time += 5) {
+        map.add(COLLAR, fixAt(40700200, -74000800, time));    // Yard only
+    }
+    for (int i = 0; i < 6; i++, time += 5) {
+        map.add(COLLAR, fixAt(40700600, -74000100, time));    // Yard and paddock
+    }
+    for (int i = 0; i < 4; i++, time += 5) {
+        map.add(COLLAR, fixAt(40702000, -74000500, time));    // Out
+    }
+
+    TEST_ASSERT_EQUAL_UINT64(80, map.fenceSeconds(COLLAR, 0));
+    TEST_ASSERT_EQUAL_UINT64(30, map.fenceSeconds(COLLAR, 1));
+    TEST_ASSERT_EQUAL_UINT64(95, map.totals(COLLAR).seconds);
+    TEST_ASSERT_EQUAL_UINT64(0, map.fenceSeconds(COLLAR, 2));
+}
+
+// ============================================================================
+// Merge Tests
+// ============================================================================
+
+void test_merged_stretches_match_single_pass(void) {
+    std::vector<PositionFix> track = makeTrack(8000);
+    DwellMap single(FENCES, 2);
+    for (const PositionFix& fix : track) {
+        single.add(COLLAR, fix);
+    }
+
+    // Four stretches on four threads, cut mid-track (and across a gap)
+    const size_t cuts[5] = {0, 1234, 3999, 5000, track.size()};
+    std::vector<DwellMap*> parts;
+    for (int p = 0; p < 4; p++) {
+        parts.push_back(new DwellMap(FENCES, 2));
+    }
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 4; p++) {
+        threads.emplace_back([&, p]() {
+            for (size_t i = cuts[p]; i < cuts[p + 1]; i++) {
+                parts[p]->add(COLLAR, track[i]);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Following, preceding and following again
+    TEST_ASSERT_TRUE(parts[1]->merge(*parts[2]));
+    TEST_ASSERT_TRUE(parts[1]->merge(*parts[0]));
+    TEST_ASSERT_TRUE(parts[1]->merge(*parts[3]));
+    assertSameMaps(single, *parts[1]);
+
+    // Further fixes continue from the merged last fix
+    PositionFix next = fixAt(track.back().latE6, track.back().lonE6, track.back().timestamp + 5);
+    single.add(COLLAR, next);
+    parts[1]->add(COLLAR, next);
+    assertSameMaps(single, *parts[1]);
+
+    for (DwellMap* part : parts) {
+        delete part;
+    }
+}
+
+void test_merge_separate_collars(void) {
+    DwellMap a(FENCES, 2);
+    DwellMap b(FENCES, 2);
+    a.add(1, fixAt(40700500, -74000500, 0));
+    a.add(1, fixAt(40700500, -74000500, 5));
+    b.add(2, fixAt(40700600, -74000100, 0));
+    b.add(2, fixAt(40700600, -74000100, 7));
+
+    TEST_ASSERT_TRUE(a.merge(b));
+    TEST_ASSERT_EQUAL(2, a.collarCount());
+    TEST_ASSERT_EQUAL_UINT64(5, a.fenceSeconds(1, 0));
+    TEST_ASSERT_EQUAL_UINT64(7, a.fenceSeconds(2, 1));
+    TEST_ASSERT_EQUAL_UINT32(2, a.cell(2, 0, 40700600, -74000100).fixes);
+}
+
+void test_merge_rejects_other_fences(void) {
+    DwellMap a(FENCES, 2);
+    DwellMap b(FENCES, 1);
+    DwellMap c(FENCES, 2, 60);
+    TEST_ASSERT_FALSE(a.merge(b));
+    TEST_ASSERT_FALSE(a.merge(c));
+    TEST_ASSERT_FALSE(a.merge(a));
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Grid tests
+    RUN_TEST(test_fix_counts_at_every_level);
+    RUN_TEST(test_time_goes_to_previous_fix);
+    RUN_TEST(test_levels_sum_to_the_same_totals);
+    RUN_TEST(test_negative_coordinates_floor);
+    RUN_TEST(test_heatmap_clips_to_box);
+    RUN_TEST(test_resting_dog_allocates_nothing_new);
+
+    // Fence tests
+    RUN_TEST(test_fence_dwell);
+
+    // Merge tests
+    RUN_TEST(test_merged_stretches_match_single_pass);
+    RUN_TEST(test_merge_separate_collars);
+    RUN_TEST(test_merge_rejects_other_fences);
+
+    return UNITY_END();
+}
@@ -0,0 +1,149 @@
+/**
+ * @file test_energy_model.cpp
+ * @brief Unit tests for the per-peripheral current model.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "energy_model.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+EnergyModelConfig config;
+EnergyTotals totals;
+
+static const PowerStates DEEP_SLEEP_STATES = {
+    SocPower::DEEP_SLEEP, GpsPower::STANDBY, RadioPower::SLEEP, 0, 0
+};
+
+static const PowerStates FIX_STATES = {
+    SocPower::ACTIVE, GpsPower::ACQUIRING, RadioPower::SLEEP, 0, 0
+};
+
+// ============================================================================
+// Current Tests
+// ============================================================================
+
+void test_current_sums_rails(void) {
+    float expected = config.socActiveMa + config.gpsAcquiringMa +
+                     config.radioSleepMa + config.boardMa;
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected, energyCurrentMa(config, FIX_STATES));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, config.gpsAcquiringMa,
+                             energyRailCurrentMa(config, FIX_STATES, ENERGY_RAIL_GPS));
+}
+
+void test_alert_scales_with_drive(void) {
+    PowerStates states = DEEP_SLEEP_STATES;
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, energyRailCurrentMa(config, states, ENERGY_RAIL_ALERT));
+
+    states.beeperPercent = 50;
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, config.beeperMa / 2,
+                             energyRailCurrentMa(config, states, ENERGY_RAIL_ALERT));
+
+    states.vibrationPercent = 100;
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, config.beeperMa / 2 + config.vibrationMa,
+                             energyRailCurrentMa(config, states, ENERGY_RAIL_ALERT));
+}
+
+void test_gps_off_draws_nothing(void) {
+    PowerStates states = DEEP_SLEEP_STATES;
+    states.gps = GpsPower::OFF;
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, energyRailCurrentMa(config, states, ENERGY_RAIL_GPS));
+}
+
+// ============================================================================
+// Accumulation Tests
+// ============================================================================
+
+void test_accumulate_charge_per_rail(void) {
+    // One hour acquiring: charge in mAh equals the current in mA
+    energyAccumulate(totals, config, FIX_STATES, 3600000000ULL);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, config.gpsAcquiringMa * 3600.0f,
+                             static_cast<float>(totals.chargeMas[ENERGY_RAIL_GPS]));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, energyCurrentMa(config, FIX_STATES),
+                             static_cast<float>(energyTotalMah(totals)));
+    TEST_ASSERT_EQUAL_UINT64(3600000000ULL, totals.socUs[static_cast<uint8_t>(SocPower::ACTIVE)]);
+}
+
+void test_average_and_daily_charge(void) {
+    // 1 s awake in every 10 s
+    for (int i = 0; i < 100; i++) {
+        energyAccumulate(totals, config, FIX_STATES, 1000000);
+        energyAccumulate(totals, config, DEEP_SLEEP_STATES, 9000000);
+    }
+
+    double expected = (energyCurrentMa(config, FIX_STATES) +
+                       9.0 * energyCurrentMa(config, DEEP_SLEEP_STATES)) / 10.0;
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, static_cast<float>(expected),
+                             static_cast<float>(energyAverageMa(totals)));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, static_cast<float>(expected * 24.0),
+                             static_cast<float>(energyMahPerDay(totals)));
+    TEST_ASSERT_EQUAL_UINT64(1000000000ULL, totals.elapsedUs);
+}
+
+void test_empty_totals(void) {
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, static_cast<float>(energyAverageMa(totals)));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, static_cast<float>(energyMahPerDay(totals)));
+}
+
+// ============================================================================
+// Config Tests
+// ============================================================================
+
+void test_set_by_name(void) {
+    TEST_ASSERT_TRUE(energyModelSet(config, "gpsStandbyMa", 0.2f));
+    TEST_ASSERT_EQUAL_FLOAT(0.2f, config.gpsStandbyMa);
+    TEST_ASSERT_TRUE(energyModelSet(config, "boardMa", 0.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, config.boardMa);
+
+    TEST_ASSERT_FALSE(energyModelSet(config, "gpsStandby", 1.0f));
+    TEST_ASSERT_FALSE(energyModelSet(config, "radioTxMa", -1.0f));
+    TEST_ASSERT_FALSE(energyModelSet(config, nullptr, 1.0f));
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_ENERGY_MODEL_CONFIG.radioTxMa, config.radioTxMa);
+}
+
+void test_rail_names(void) {
+    TEST_ASSERT_EQUAL_STRING("gps", energyRailName(ENERGY_RAIL_GPS));
+    TEST_ASSERT_EQUAL_STRING("board", energyRailName(ENERGY_RAIL_BOARD));
+    TEST_ASSERT_EQUAL_STRING("?", energyRailName(ENERGY_RAIL_COUNT));
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    config = DEFAULT_ENERGY_MODEL_CONFIG;
+    memset(&totals, 0, sizeof(totals));
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Current tests
+    RUN_TEST(test_current_sums_rails);
+    RUN_TEST(test_alert_scales_with_drive);
+    RUN_TEST(test_gps_off_draws_nothing);
+
+    // Accumulation tests
+    RUN_TEST(test_accumulate_charge_per_rail);
+    RUN_TEST(test_average_and_daily_charge);
+    RUN_TEST(test_empty_totals);
+
+    // Config tests
+    RUN_TEST(test_set_by_name);
+    RUN_TEST(test_rail_names);
+
+    return UNITY_END();
+}
@@ -0,0 +1,173 @@
+/**
+ * @file test_fence_alert.cpp
+ * @brief Unit tests for the fence_alert state machine.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include "fence_alert.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+// Margins of 3 m in / 5 m out, 10 s exit dwell, 15 s return dwell,
+// escalate every 30 s up to level 3
+const FenceAlertConfig config = DEFAULT_FENCE_ALERT_CONFIG;
+
+FenceAlertContext ctx;
+
+// ============================================================================
+// Hysteresis Tests
+// ============================================================================
+
+void test_starts_inside(void) {
+    TEST_ASSERT_TRUE(ctx.state == FenceAlertState::INSIDE);
+    TEST_ASSERT_FALSE(fenceAlertIsOutside(ctx));
+    TEST_ASSERT_EQUAL_UINT8(0, ctx.escalationLevel);
+}
+
+void test_noise_within_band_never_triggers(void) {
+    // Dog hovering on the fence line: -4 m .. +2 m, every 5 s for 10 minutes
+    const float noise[] = {2.0f, -4.0f, 1.0f, -3.5f, 0.0f, -4.9f, 1.5f};
+    for (uint32_t t = 0; t < 600; t += 5) {
+        float d = noise[(t / 5) % (sizeof(noise) / sizeof(noise[0]))];
+        TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, d, t) == FenceAlertEvent::NONE);
+    }
+    TEST_ASSERT_TRUE(ctx.state == FenceAlertState::INSIDE);
+}
+
+void test_exit_requires_dwell(void) {
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, -8.0f, 100) == FenceAlertEvent::NONE);
+    TEST_ASSERT_TRUE(ctx.state == FenceAlertState::EXIT_PENDING);
+    TEST_ASSERT_FALSE(fenceAlertIsOutside(ctx));
+
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, -8.0f, 105) == FenceAlertEvent::NONE);
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, -8.0f, 110) == FenceAlertEvent::EXITED);
+    TEST_ASSERT_TRUE(ctx.state == FenceAlertState::OUTSIDE);
+    TEST_ASSERT_EQUAL_UINT8(1, ctx.escalationLevel);
+}
+
+void test_short_excursion_is_cancelled(void) {
+    fenceAlertUpdate(ctx, config, -8.0f, 100);
+    fenceAlertUpdate(ctx, config, -8.0f, 105);
+    // Back inside the band before the dwell time elapsed
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, -2.0f, 108) == FenceAlertEvent::NONE);
+    TEST_ASSERT_TRUE(ctx.state == FenceAlertState::INSIDE);
+
+    // Dwell timer restarts on the next excursion
+    fenceAlertUpdate(ctx, config, -8.0f, 115);
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, -8.0f, 120) == FenceAlertEvent::NONE);
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, -8.0f, 125) == FenceAlertEvent::EXITED);
+}
+
+void test_zero_dwell_confirms_immediately(void) {
+    FenceAlertConfig fast = config;
+    fast.exitDwellSec = 0;
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, fast, -6.0f, 10) == FenceAlertEvent::EXITED);
+}
+
+// ============================================================================
+// Escalation Tests
+// ============================================================================
+
+void test_escalation_levels(void) {
+    fenceAlertUpdate(ctx, config, -20.0f, 0);
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, -20.0f, 10) == FenceAlertEvent::EXITED);
+
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, -20.0f, 35) == FenceAlertEvent::NONE);
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, -20.0f, 40) == FenceAlertEvent::ESCALATED);
+    TEST_ASSERT_EQUAL_UINT8(2, ctx.escalationLevel);
+
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, -20.0f, 70) == FenceAlertEvent::ESCALATED);
+    TEST_ASSERT_EQUAL_UINT8(3, ctx.escalationLevel);
+
+    // Capped at maxEscalationLevel
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, -20.0f, 500) == FenceAlertEvent::NONE);
+    TEST_ASSERT_EQUAL_UINT8(3, ctx.escalationLevel);
+}
+
+void test_escalation_continues_in_band_while_outside(void) {
+    fenceAlertUpdate(ctx, config, -20.0f, 0);
+    fenceAlertUpdate(ctx, config, -20.0f, 10);
+
+    // Walking back toward the fence but not yet clearly inside
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, 1.0f, 40) == FenceAlertEvent::ESCALATED);
+    TEST_ASSERT_TRUE(fenceAlertIsOutside(ctx));
+}
+
+// ============================================================================
+// Return Tests
+// ============================================================================
+
+void test_return_requires_dwell(void) {
+    fenceAlertUpdate(ctx, config, -20.0f, 0);
+    fenceAlertUpdate(ctx, config, -20.0f, 10);
+
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, 10.0f, 20) == FenceAlertEvent::NONE);
+    TEST_ASSERT_TRUE(ctx.state == FenceAlertState::RETURN_PENDING);
+    TEST_ASSERT_TRUE(fenceAlertIsOutside(ctx));
+
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, 10.0f, 30) == FenceAlertEvent::NONE);
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, 10.0f, 35) == FenceAlertEvent::RETURNED);
+    TEST_ASSERT_TRUE(ctx.state == FenceAlertState::INSIDE);
+    TEST_ASSERT_EQUAL_UINT8(0, ctx.escalationLevel);
+}
+
+void test_return_cancelled_by_noise(void) {
+    fenceAlertUpdate(ctx, config, -20.0f, 0);
+    fenceAlertUpdate(ctx, config, -20.0f, 10);
+    fenceAlertUpdate(ctx, config, 10.0f, 20);
+
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, 2.0f, 25) == FenceAlertEvent::NONE);
+    TEST_ASSERT_TRUE(ctx.state == FenceAlertState::OUTSIDE);
+}
+
+// ============================================================================
+// Robustness Tests
+// ============================================================================
+
+void test_corrupt_state_resets(void) {
+    ctx.state = static_cast<FenceAlertState>(0x7F);
+    TEST_ASSERT_TRUE(fenceAlertUpdate(ctx, config, -20.0f, 0) == FenceAlertEvent::NONE);
+    TEST_ASSERT_TRUE(ctx.state == FenceAlertState::INSIDE);
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    fenceAlertReset(ctx);
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Hysteresis tests
+    RUN_TEST(test_starts_inside);
+    RUN_TEST(test_noise_within_band_never_triggers);
+    RUN_TEST(test_exit_requires_dwell);
+    RUN_TEST(test_short_excursion_is_cancelled);
+    RUN_TEST(test_zero_dwell_confirms_immediately);
+
+    // Escalation tests
+    RUN_TEST(test_escalation_levels);
+    RUN_TEST(test_escalation_continues_in_band_while_outside);
+
+    // Return tests
+    RUN_TEST(test_return_requires_dwell);
+    RUN_TEST(test_return_cancelled_by_noise);
+
+    // Robustness tests
+    RUN_TEST(test_corrupt_state_resets);
+
+    return UNITY_END();
+}
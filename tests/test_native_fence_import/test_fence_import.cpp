@@ -0,0 +1,365 @@
+/**
+ * @file test_fence_import.cpp
+ * @brief Unit tests for the fence_import library.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "fence_import.h"
+#include "fence_store.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+static const char* IMPORT_PATH = "test_fence_import.geojson";
+
+// A yard drawn clockwise, closed as GeoJSON requires, with a hole (a pond)
+static const char* YARD_GEOJSON =
+    "{\"type\":\"FeatureCollection\",\"features\":[\n"
+    "  {\"type\":\"Feature\",\"properties\":{\"name\":\"Yard [main]\",\"note\":\"\\\"coordinates\\\": [1, 2]\"},\n"
+    "   \"geometry\":{\"type\":\"Polygon\",\"coordinates\":[\n"
+    "     [[-74.0010,40.7000],[-74.0010,40.7010],[-74.0000,40.7010],[-74.0000,40.7000],[-74.0010,40.7000]],\n"
+    "     [[-74.0006,40.7004],[-74.0004,40.7004],[-74.0004,40.7006],[-74.0006,40.7004]]\n"
+    "   ]}}\n"
+    "]}";
+
+static const char* YARD_KML =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>\n"
+    "  <!-- drawn in <Google Earth> -->\n"
+    "  <Placemark><name>Yard</name>\n"
+    "    <Point><coordinates>-74.0005,40.7005,0</coordinates></Point>\n"
+    "    <Polygon><extrude/><outerBoundaryIs><LinearRing>\n"
+    "      <coordinates>\n"
+    "        -74.0010,40.7000,0 -74.0010,40.7010,0\n"
+    "        -74.0000,40.7010,0\t-74.0000,40.7000,0 -74.0010,40.7000,0\n"
+    "      </coordinates>\n"
+    "    </LinearRing></outerBoundaryIs>\n"
+    "    <innerBoundaryIs><LinearRing><coordinates>-74.0006,40.7004 -74.0004,40.7004 "
+    "-74.0004,40.7006 -74.0006,40.7004</coordinates></LinearRing></innerBoundaryIs>\n"
+    "    </Polygon>\n"
+    "  </Placemark>\n"
+    "</Document></kml>\n";
+
+static FenceImporter* importString(const char* text, size_t chunk = 0) {
+    FenceImporter* importer = new FenceImporter();
+    size_t length = strlen(text);
+    if (chunk == 0) {
+        chunk = length;
+    }
+    for (size_t i = 0; i < length; i += chunk) {
+        importer->feed(text + i, i + chunk < length ? chunk : length - i);
+    }
+    importer->finish();
+    return importer;
+}
+
+// The yard after import: closing vertex gone, counter-clockwise
+static void assertYard(const FenceImporter& importer) {
+    TEST_ASSERT_FALSE(importer.failed());
+    TEST_ASSERT_EQUAL(1, importer.fences().size());
+    TEST_ASSERT_EQUAL_UINT32(1, importer.stats().polygons);
+    TEST_ASSERT_EQUAL_UINT32(1, importer.stats().holes);
+    TEST_ASSERT_EQUAL_UINT32(1, importer.stats().reversed);
+
+    const std::vector<GeoPoint>& ring = importer.fences()[0].vertices;
+    TEST_ASSERT_EQUAL(4, ring.size());
+    TEST_ASSERT_EQUAL_FLOAT(40.7000f, ring[0].lat);
+    TEST_ASSERT_EQUAL_FLOAT(-74.0000f, ring[0].lon);
+    TEST_ASSERT_EQUAL_FLOAT(40.7010f, ring[1].lat);
+    TEST_ASSERT_EQUAL_FLOAT(-74.0000f, ring[1].lon);
+    TEST_ASSERT_EQUAL_FLOAT(40.7000f, ring[3].lat);
+    TEST_ASSERT_EQUAL_FLOAT(-74.0010f, ring[3].lon);
+
+    Polygon polygon(ring.data(), ring.size());
+    GeoPoint inside = {40.7005f, -74.0005f};
+    TEST_ASSERT_TRUE(polygon.contains(inside));
+}
+
+// ============================================================================
+// Ring Tests
+// ============================================================================
+
+void test_normalize_strips_and_orients(void) {
+    std::vector<GeoPoint> ring = {
+        {0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}, {0.0f, 0.0f}
+    };
+    bool reversed;
+    TEST_ASSERT_TRUE(fenceImportNormalize(ring, reversed));
+    TEST_ASSERT_TRUE(reversed);     // North, east, south: clockwise
+    TEST_ASSERT_EQUAL(4, ring.size());
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, ring[0].lon);
+
+    TEST_ASSERT_TRUE(fenceImportNormalize(ring, reversed));
+    TEST_ASSERT_FALSE(reversed);
+}
+
+void test_normalize_rejects_degenerate(void) {
+    std::vector<GeoPoint> twoPoints = {{0.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f}};
+    std::vector<GeoPoint> collinear = {{0.0f, 0.0f}, {1.0f, 1.0f}, {2.0f, 2.0f}};
+    bool reversed;
+    TEST_ASSERT_FALSE(fenceImportNormalize(twoPoints, reversed));
+    TEST_ASSERT_FALSE(fenceImportNormalize(collinear, reversed));
+}
+
+// ============================================================================
+// GeoJSON Tests
+// ============================================================================
+
+void test_geojson_polygon(void) {
+    FenceImporter* importer = importString(YARD_GEOJSON);
+    TEST_ASSERT_TRUE(importer->format() == FenceImportFormat::GEOJSON);
+    assertYard(*importer);
+    delete importer;
+}
+
+void test_geojson_any_chunking(void) {
+    // One byte at a time and odd sizes split strings, numbers and escapes
+    const size_t chunks[] = {1, 2, 3, 7, 64};
+    for (size_t chunk : chunks) {
+        FenceImporter* importer = importString(YARD_GEOJSON, chunk);
+        assertYard(*importer);
+        delete importer;
+    }
+}
+
+void test_geojson_multipolygon_and_other_geometries(void) {
+    const char* text =
+        "{\"type\":\"GeometryCollection\",\"geometries\":["
+        "{\"type\":\"Point\",\"coordinates\":[-74.0,40.7]},"
+        "{\"type\":\"LineString\",\"coordinates\":[[-74.0,40.7],[-74.1,40.8]]},"
+        "{\"coordinates\":[[[[0,0],[0.001,0],[0.001,0.001],[0,0]]],"
+        "                  [[[1,1],[1.002,1],[1.002,1.002],[1,1]],[[1.0005,1.0005],[1.001,1.0005],[1.001,1.001]]],"
+        "                  [[[5,5],[5,5],[5,5]]]],"
+        "\"type\":\"MultiPolygon\",\"bbox\":[0,0,1.002,1.002]}]}";
+    FenceImporter* importer = importString(text);
+
+    TEST_ASSERT_FALSE(importer->failed());
+    TEST_ASSERT_EQUAL(2, importer->fences().size());
+    TEST_ASSERT_EQUAL_UINT32(3, importer->stats().polygons);
+    TEST_ASSERT_EQUAL_UINT32(1, importer->stats().holes);
+    TEST_ASSERT_EQUAL_UINT32(1, importer->stats().degenerate);
+    TEST_ASSERT_EQUAL_UINT32(0, importer->fences()[0].polygon);
+    TEST_ASSERT_EQUAL_UINT32(1, importer->fences()[1].polygon);
+    TEST_ASSERT_EQUAL_FLOAT(1.002f, importer->fences()[1].vertices[1].lon);
+    delete importer;
+}
+
+void test_geojson_number_forms(void) {
+    const char* text =
+        "{\"coordinates\":[[[-7.4e1,4.07E+1],[-73.9999e0,40.70],[-74,407.01e-1],[-74.0,40.70]]]}";
+    FenceImporter* importer = importString(text);
+    TEST_ASSERT_FALSE(importer->failed());
+    TEST_ASSERT_EQUAL(1, importer->fences().size());
+    const std::vector<GeoPoint>& ring = importer->fences()[0].vertices;
+    TEST_ASSERT_EQUAL(3, ring.size());      // The last equals the first
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 40.7f, ring[0].lat);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, -74.0f, ring[0].lon);
+    delete importer;
+}
+
+void test_geojson_malformed(void) {
+    const char* bad[] = {
+        "{\"coordinates\":[[[1,2],[3],[5,6]]]}",        // A position without lat
+        "{\"coordinates\":[[[1,2],[3,4],[5,--6]]]}",    // Not a number
+        "{\"coordinates\":[[[1,2],[3,4],[5,6]]]",       // Truncated
+        "{\"coordinates\":[[[1,2],[[3,4]],[5,6]]]}",    // Uneven nesting
+        "{\"a\":1}}",                                   // Unbalanced
+        "hello"
+    };
+    for (const char* text : bad) {
+        FenceImporter* importer = importString(text);
+        TEST_ASSERT_TRUE_MESSAGE(importer->failed(), text);
+        delete importer;
+    }
+
+    FenceImporter* importer = importString("{\"coordinates\":[[[1,2],[3,x4],[5,6]]]}");
+    TEST_ASSERT_EQUAL_UINT64(26, importer->errorOffset());
+    delete importer;
+}
+
+void test_geojson_projected_coordinates(void) {
+    // The yard in web mercator (EPSG:3857) metres, as some parcel exports are
+    const char* text =
+        "{\"type\":\"Polygon\",\"coordinates\":[[[-8237754.1,4970071.6],[-8237754.1,4970218.5],"
+        "[-8237642.8,4970218.5],[-8237754.1,4970071.6]]]}";
+    FenceImporter* importer = importString(text);
+    TEST_ASSERT_TRUE(importer->failed());
+    TEST_ASSERT_EQUAL(0, importer->fences().size());
+    TEST_ASSERT_EQUAL_UINT64(strstr(text, "-8237754.1") - text, importer->errorOffset());
+    delete importer;
+
+    // Out of range, or too large for a float
+    const char* bad[] = {
+        "{\"coordinates\":[[[0,0],[0.001,0],[0.001,91],[0,0]]]}",
+        "{\"coordinates\":[[[0,0],[180.5,0],[0.001,0.001],[0,0]]]}",
+        "{\"coordinates\":[[[0,0],[0.001,0],[1e300,0.001],[0,0]]]}"
+    };
+    for (const char* badText : bad) {
+        importer = importString(badText);
+        TEST_ASSERT_TRUE_MESSAGE(importer->failed(), badText);
+        delete importer;
+    }
+
+    // The limits themselves are positions
+    importer = importString("{\"coordinates\":[[[-180,-90],[180,-90],[180,90],[-180,-90]]]}");
+    TEST_ASSERT_FALSE(importer->failed());
+    TEST_ASSERT_EQUAL(1, importer->fences().size());
+    delete importer;
+}
+
+// ============================================================================
+// KML Tests
+// ============================================================================
+
+void test_kml_polygon(void) {
+    FenceImporter* importer = importString(YARD_KML);
+    TEST_ASSERT_TRUE(importer->format() == FenceImportFormat::KML);
+    assertYard(*importer);
+    delete importer;
+}
+
+void test_kml_any_chunking(void) {
+    const size_t chunks[] = {1, 2, 5, 13};
+    for (size_t chunk : chunks) {
+        FenceImporter* importer = importString(YARD_KML, chunk);
+        assertYard(*importer);
+        delete importer;
+    }
+}
+
+void test_kml_namespaces_and_multigeometry(void) {
+    const char* text =
+        "\xEF\xBB\xBF<kml:kml><kml:MultiGeometry>"
+        "<kml:Polygon><kml:outerBoundaryIs><kml:LinearRing><kml:coordinates>"
+        "0,0 0.001,0 0.001,0.001 0,0"
+        "</kml:coordinates></kml:LinearRing></kml:outerBoundaryIs></kml:Polygon>"
+        "<Polygon><outerBoundaryIs><LinearRing><coordinates attr='a>b'>"
+        "1,1,10 1.002,1,10 1.002,1.002,10"
+        "</coordinates></LinearRing></outerBoundaryIs></Polygon>"
+        "<LineString><coordinates>3,3 4,4</coordinates></LineString>"
+        "</kml:MultiGeometry></kml:kml>";
+    FenceImporter* importer = importString(text);
+    TEST_ASSERT_FALSE(importer->failed());
+    TEST_ASSERT_EQUAL(2, importer->fences().size());
+    TEST_ASSERT_EQUAL(3, importer->fences()[0].vertices.size());
+    TEST_ASSERT_EQUAL_FLOAT(1.002f, importer->fences()[1].vertices[2].lat);
+    delete importer;
+}
+
+void test_kml_malformed(void) {
+    FenceImporter* importer = importString(
+        "<kml><Polygon><coordinates>1,2 3 5,6</coordinates></Polygon></kml>");
+    TEST_ASSERT_TRUE(importer->failed());
+    delete importer;
+
+    importer = importString("<kml><Polygon><coordinates>1,2 3,4 5,6");
+    TEST_ASSERT_TRUE(importer->failed());
+    delete importer;
+}
+
+void test_kml_projected_coordinates(void) {
+    // New York Long Island state plane (EPSG:2263) feet
+    const char* text =
+        "<kml><Polygon><outerBoundaryIs><LinearRing><coordinates>"
+        "-74.0010,40.7000 981234.5,201234.5 981534.5,201234.5 981534.5,201534.5"
+        "</coordinates></LinearRing></outerBoundaryIs></Polygon></kml>";
+    const size_t chunks[] = {0, 1, 7};
+    for (size_t chunk : chunks) {
+        FenceImporter* importer = importString(text, chunk);
+        TEST_ASSERT_TRUE(importer->failed());
+        TEST_ASSERT_EQUAL(0, importer->fences().size());
+        TEST_ASSERT_EQUAL_UINT64(strstr(text, "981234.5") - text, importer->errorOffset());
+        delete importer;
+    }
+
+    // The last tuple is checked at the closing tag
+    FenceImporter* importer = importString(
+        "<kml><Polygon><coordinates>0,0 0.001,0 0.001,0.001 1e300,0</coordinates></Polygon></kml>");
+    TEST_ASSERT_TRUE(importer->failed());
+    delete importer;
+}
+
+// ============================================================================
+// Output Tests
+// ============================================================================
+
+void test_encode_blob(void) {
+    FenceImporter* importer = importString(YARD_GEOJSON);
+    std::vector<uint8_t> blob;
+    size_t size = fenceImportEncode(importer->fences()[0], 77, blob);
+    TEST_ASSERT_EQUAL(fenceBlobSize(4), size);
+
+    const FenceBlobHeader* header = fenceBlobValidate(blob.data(), blob.size());
+    TEST_ASSERT_NOT_NULL(header);
+    TEST_ASSERT_EQUAL_UINT32(77, header->fenceId);
+    TEST_ASSERT_EQUAL_UINT32(4, header->vertexCount);
+    TEST_ASSERT_EQUAL_MEMORY(importer->fences()[0].vertices.data(), fenceBlobVertices(header), 4 * sizeof(GeoPoint));
+
+    ImportedFence huge;
+    huge.vertices.assign(FENCE_STORE_MAX_VERTICES + 1, GeoPoint());
+    TEST_ASSERT_EQUAL(0, fenceImportEncode(huge, 1, blob));
+    delete importer;
+}
+
+void test_import_file(void) {
+    FILE* file = fopen(IMPORT_PATH, "w");
+    TEST_ASSERT_NOT_NULL(file);
+    fputs(YARD_GEOJSON, file);
+    fclose(file);
+
+    FenceImporter importer;
+    TEST_ASSERT_TRUE(fenceImportFile(IMPORT_PATH, importer));
+    assertYard(importer);
+
+    FenceImporter missing;
+    TEST_ASSERT_FALSE(fenceImportFile("does_not_exist.geojson", missing));
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    unlink(IMPORT_PATH);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Ring tests
+    RUN_TEST(test_normalize_strips_and_orients);
+    RUN_TEST(test_normalize_rejects_degenerate);
+
+    // GeoJSON tests
+    RUN_TEST(test_geojson_polygon);
+    RUN_TEST(test_geojson_any_chunking);
+    RUN_TEST(test_geojson_multipolygon_and_other_geometries);
+    RUN_TEST(test_geojson_number_forms);
+    RUN_TEST(test_geojson_malformed);
+    RUN_TEST(test_geojson_projected_coordinates);
+
+    // KML tests
+    RUN_TEST(test_kml_polygon);
+    RUN_TEST(test_kml_any_chunking);
+    RUN_TEST(test_kml_namespaces_and_multigeometry);
+    RUN_TEST(test_kml_malformed);
+    RUN_TEST(test_kml_projected_coordinates);
+
+    // Output tests
+    RUN_TEST(test_encode_blob);
+    RUN_TEST(test_import_file);
+
+    return UNITY_END();
+}
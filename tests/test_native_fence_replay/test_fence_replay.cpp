@@ -0,0 +1,258 @@
+/**
+ * @file test_fence_replay.cpp
+ * @brief Unit tests for the fence replay engine.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "fence_replay.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+// Fence 0: 1 x 1 degree square; fence 1: its southern half
+static const GeoPoint SQUARE[] = {{10.0f, 20.0f}, {10.0f, 21.0f}, {11.0f, 21.0f}, {11.0f, 20.0f}};
+static const GeoPoint HALF[] = {{10.0f, 20.0f}, {10.0f, 21.0f}, {10.5f, 21.0f}, {10.5f, 20.0f}};
+static const Polygon FENCES[] = {Polygon(SQUARE, 4), Polygon(HALF, 4)};
+
+static PositionFix fix(uint32_t timestamp, double lat, double lon) {
+    PositionFix f = {static_cast<int32_t>(lat * 1e6), static_cast<int32_t>(lon * 1e6), timestamp};
+    return f;
+}
+
+// Deterministic walk that keeps crossing both fences
+static std::vector<PositionFix> makeWalk(size_t count) {
+    std::vector<PositionFix> fixes;
+    uint32_t seed = 12345;
+    double lat = 10.4, lon = 20.5;
+    uint32_t t = 1000;
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        lat += (static_cast<int>((seed >> 8) % 2001) - 1000) * 0.00005 - (lat - 10.5) * 0.01;
+        lon += (static_cast<int>((seed >> 20) % 2001) - 1000) * 0.00005 - (lon - 20.5) * 0.01;
+        t += 1 + (seed >> 30);
+        fixes.push_back(fix(t, lat, lon));
+    }
+    return fixes;
+}
+
+static void assertSameStats(const FenceReplay& expected, const FenceReplay& actual) {
+    TEST_ASSERT_EQUAL_UINT64(expected.fixCount(), actual.fixCount());
+    for (size_t f = 0; f < expected.fenceCount(); f++) {
+        const FenceReplayStats& a = expected.stats(f);
+        const FenceReplayStats& b = actual.stats(f);
+        TEST_ASSERT_EQUAL_UINT64(a.insideFixes, b.insideFixes);
+        TEST_ASSERT_EQUAL_UINT64(a.outsideFixes, b.outsideFixes);
+        TEST_ASSERT_EQUAL_UINT32(a.exits, b.exits);
+        TEST_ASSERT_EQUAL_UINT32(a.entries, b.entries);
+        TEST_ASSERT_EQUAL_UINT64(a.outsideSec, b.outsideSec);
+        TEST_ASSERT_EQUAL_UINT32(a.longestExcursionSec, b.longestExcursionSec);
+    }
+}
+
+static void assertSameEvents(const std::vector<FenceCrossingEvent>& expected,
+                             const std::vector<FenceCrossingEvent>& actual) {
+    TEST_ASSERT_EQUAL_UINT(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        TEST_ASSERT_EQUAL_UINT64(expected[i].index, actual[i].index);
+        TEST_ASSERT_EQUAL_UINT8(expected[i].fence, actual[i].fence);
+        TEST_ASSERT_TRUE(expected[i].type == actual[i].type);
+        TEST_ASSERT_EQUAL_UINT32(expected[i].fix.timestamp, actual[i].fix.timestamp);
+    }
+}
+
+// Whole track as a single chunk
+static void replaySerial(FenceReplay& replay, const std::vector<PositionFix>& fixes,
+                         std::vector<FenceCrossingEvent>& events) {
+    FenceReplayChunk chunk;
+    fenceReplayEvaluate(FENCES, 2, fixes.data(), fixes.size(), chunk);
+    replay.merge(chunk, &events);
+    replay.finish();
+}
+
+// ============================================================================
+// Crossing and Statistics Tests
+// ============================================================================
+
+void test_exit_and_entry_events(void) {
+    std::vector<PositionFix> fixes = {
+        fix(0, 10.7, 20.5), fix(10, 10.7, 20.5),   // inside fence 0 only
+        fix(20, 12.0, 20.5), fix(30, 12.0, 20.5),  // outside both
+        fix(40, 10.2, 20.5), fix(50, 10.2, 20.5),  // inside both
+    };
+    FenceReplay replay(FENCES, 2);
+    std::vector<FenceCrossingEvent> events;
+    replaySerial(replay, fixes, events);
+
+    TEST_ASSERT_EQUAL_UINT(3, events.size());
+    TEST_ASSERT_EQUAL_UINT64(2, events[0].index);
+    TEST_ASSERT_EQUAL_UINT8(0, events[0].fence);
+    TEST_ASSERT_TRUE(events[0].type == FenceCrossing::EXIT);
+    TEST_ASSERT_EQUAL_UINT64(4, events[1].index);
+    TEST_ASSERT_EQUAL_UINT8(0, events[1].fence);
+    TEST_ASSERT_TRUE(events[1].type == FenceCrossing::ENTRY);
+    TEST_ASSERT_EQUAL_UINT8(1, events[2].fence);
+    TEST_ASSERT_TRUE(events[2].type == FenceCrossing::ENTRY);
+
+    const FenceReplayStats& outer = replay.stats(0);
+    TEST_ASSERT_EQUAL_UINT64(4, outer.insideFixes);
+    TEST_ASSERT_EQUAL_UINT64(2, outer.outsideFixes);
+    TEST_ASSERT_EQUAL_UINT32(1, outer.exits);
+    TEST_ASSERT_EQUAL_UINT32(1, outer.entries);
+    TEST_ASSERT_EQUAL_UINT64(20, outer.outsideSec);
+    TEST_ASSERT_EQUAL_UINT32(20, outer.longestExcursionSec);
+
+    // Fence 1 starts outside: no event for the first fix, the excursion
+    // runs from the start of the track
+    const FenceReplayStats& inner = replay.stats(1);
+    TEST_ASSERT_EQUAL_UINT32(0, inner.exits);
+    TEST_ASSERT_EQUAL_UINT32(1, inner.entries);
+    TEST_ASSERT_EQUAL_UINT64(40, inner.outsideSec);
+    TEST_ASSERT_EQUAL_UINT32(40, inner.longestExcursionSec);
+}
+
+void test_track_ending_outside(void) {
+    std::vector<PositionFix> fixes = {fix(100, 10.7, 20.5), fix(105, 12.0, 20.5),
+                                      fix(200, 12.0, 20.5), fix(230, 12.5, 20.5)};
+    FenceReplay replay(FENCES, 1);
+    std::vector<FenceCrossingEvent> events;
+    replaySerial(replay, fixes, events);
+
+    TEST_ASSERT_EQUAL_UINT(1, events.size());
+    TEST_ASSERT_EQUAL_UINT32(1, replay.stats(0).exits);
+    TEST_ASSERT_EQUAL_UINT64(125, replay.stats(0).outsideSec);
+    TEST_ASSERT_EQUAL_UINT32(125, replay.stats(0).longestExcursionSec);
+}
+
+// The collar clock restarting must not count as a huge excursion
+void test_clock_going_backwards_counts_no_time(void) {
+    std::vector<PositionFix> fixes = {fix(5000, 12.0, 20.5), fix(10, 12.0, 20.5),
+                                      fix(20, 10.7, 20.5)};
+    FenceReplay replay(FENCES, 1);
+    std::vector<FenceCrossingEvent> events;
+    replaySerial(replay, fixes, events);
+
+    TEST_ASSERT_EQUAL_UINT64(10, replay.stats(0).outsideSec);
+    TEST_ASSERT_EQUAL_UINT32(0, replay.stats(0).longestExcursionSec);
+}
+
+// ============================================================================
+// Chunking Tests
+// ============================================================================
+
+// Any split into chunks gives exactly the single-chunk result
+void test_chunk_boundaries_do_not_change_result(void) {
+    std::vector<PositionFix> fixes = makeWalk(20000);
+    FenceReplay reference(FENCES, 2);
+    std::vector<FenceCrossingEvent> expected;
+    replaySerial(reference, fixes, expected);
+    TEST_ASSERT_TRUE(expected.size() > 20);
+
+    static const size_t SIZES[] = {1, 2, 3, 7, 64, 1000, 4096};
+    for (size_t size : SIZES) {
+        FenceReplay replay(FENCES, 2);
+        std::vector<FenceCrossingEvent> events;
+        FenceReplayChunk chunk;
+        for (size_t first = 0; first < fixes.size(); first += size) {
+            size_t length = fixes.size() - first < size ? fixes.size() - first : size;
+            fenceReplayEvaluate(FENCES, 2, &fixes[first], length, chunk);
+            replay.merge(chunk, &events);
+        }
+        replay.finish();
+
+        assertSameStats(reference, replay);
+        assertSameEvents(expected, events);
+    }
+}
+
+void test_pool_replay_matches_serial(void) {
+    std::vector<PositionFix> fixes = makeWalk(5 * FENCE_REPLAY_CHUNK_FIXES + 123);
+    FenceReplay reference(FENCES, 2);
+    std::vector<FenceCrossingEvent> expected;
+    replaySerial(reference, fixes, expected);
+
+    // Two batches, as when streaming a file
+    WorkStealingPool pool(4);
+    FenceReplay replay(FENCES, 2);
+    std::vector<FenceCrossingEvent> events;
+    size_t split = 2 * FENCE_REPLAY_CHUNK_FIXES + 17;
+    replay.replay(pool, fixes.data(), split, &events);
+    replay.replay(pool, fixes.data() + split, fixes.size() - split, &events);
+    replay.finish();
+
+    assertSameStats(reference, replay);
+    assertSameEvents(expected, events);
+}
+
+// ============================================================================
+// CSV Tests
+// ============================================================================
+
+void test_parse_csv(void) {
+    const char* text =
+        "timestamp,lat,lon\n"
+        "# walk 1\n"
+        "100,40.722720,-74.021160\r\n"
+        "\n"
+        "  101.5, 40.7227204 ,-74.0211605,3.2\n"
+        "102,40.7,-74\n";
+    std::vector<PositionFix> fixes;
+    TEST_ASSERT_EQUAL_UINT(0, fenceReplayParseCsv(text, strlen(text), fixes));
+
+    TEST_ASSERT_EQUAL_UINT(3, fixes.size());
+    TEST_ASSERT_EQUAL_UINT32(100, fixes[0].timestamp);
+    TEST_ASSERT_EQUAL_INT32(40722720, fixes[0].latE6);
+    TEST_ASSERT_EQUAL_INT32(-74021160, fixes[0].lonE6);
+    TEST_ASSERT_EQUAL_UINT32(101, fixes[1].timestamp);
+    TEST_ASSERT_EQUAL_INT32(40722720, fixes[1].latE6);
+    TEST_ASSERT_EQUAL_INT32(-74021161, fixes[1].lonE6);
+    TEST_ASSERT_EQUAL_INT32(40700000, fixes[2].latE6);
+    TEST_ASSERT_EQUAL_INT32(-74000000, fixes[2].lonE6);
+}
+
+void test_parse_csv_counts_malformed_lines(void) {
+    const char* text = "1,40.5\n2,40.5,x\n3,400.0,20.0\n4,40.5,20.5\n5,40.5,20.5;\n6,1,2";
+    std::vector<PositionFix> fixes;
+    TEST_ASSERT_EQUAL_UINT(4, fenceReplayParseCsv(text, strlen(text), fixes));
+    TEST_ASSERT_EQUAL_UINT(2, fixes.size());
+    TEST_ASSERT_EQUAL_UINT32(4, fixes[0].timestamp);
+    TEST_ASSERT_EQUAL_UINT32(6, fixes[1].timestamp);  // No trailing newline
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Crossing and statistics tests
+    RUN_TEST(test_exit_and_entry_events);
+    RUN_TEST(test_track_ending_outside);
+    RUN_TEST(test_clock_going_backwards_counts_no_time);
+
+    // Chunking tests
+    RUN_TEST(test_chunk_boundaries_do_not_change_result);
+    RUN_TEST(test_pool_replay_matches_serial);
+
+    // CSV tests
+    RUN_TEST(test_parse_csv);
+    RUN_TEST(test_parse_csv_counts_malformed_lines);
+
+    return UNITY_END();
+}
@@ -0,0 +1,394 @@
+/**
+ * @file test_fence_simplify.cpp
+ * @brief Unit tests for the fence_simplify library.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <vector>
+#include "fence_simplify.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+static const double LAT0 = 40.7000;
+static const double LON0 = -74.0000;
+static const double METERS_PER_LON = 111320.0 * 0.7581;     // cos(40.7)
+
+static GeoPoint offsetPoint(double east, double north) {
+    GeoPoint point = {static_cast<float>(LAT0 + north / 111320.0),
+                      static_cast<float>(LON0 + east / METERS_PER_LON)};
+    return point;
+}
+
+// A surveyed-looking parcel: about 200 m across, lumpy, with a meter of jitter
+static std::vector<GeoPoint> makeParcel(size_t count, uint32_t seed) {
+    std::vector<GeoPoint> ring;
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        double angle = 2.0 * M_PI * i / count;
+        double radius = 100.0 + 15.0 * sin(3.0 * angle) + 6.0 * cos(7.0 * angle) + (seed >> 24) / 255.0;
+        ring.push_back(offsetPoint(radius * cos(angle), radius * sin(angle)));
+    }
+    return ring;
+}
+
+static std::vector<GeoPoint> makeStar(size_t points) {
+    std::vector<GeoPoint> ring;
+    for (size_t i = 0; i < 2 * points; i++) {
+        double angle = M_PI * i / points;
+        double radius = i % 2 == 0 ? 100.0 : 40.0;
+        ring.push_back(offsetPoint(radius * cos(angle), radius * sin(angle)));
+    }
+    return ring;
+}
+
+// A U with a slot narrower than its ragged inner walls are deep
+static std::vector<GeoPoint> makeSlot() {
+    std::vector<GeoPoint> ring;
+    ring.push_back(offsetPoint(0, 0));
+    ring.push_back(offsetPoint(60, 0));
+    for (int y = 10; y <= 200; y += 10) {
+        ring.push_back(offsetPoint(60 - (y % 20 == 0 ? 0 : 3), y));
+    }
+    for (int y = 200; y >= 20; y -= 10) {
+        ring.push_back(offsetPoint(34 - (y % 20 == 0 ? 0 : 3), y));
+    }
+    for (int y = 20; y <= 200; y += 10) {
+        ring.push_back(offsetPoint(26 + (y % 20 == 0 ? 0 : 3), y));
+    }
+    for (int y = 200; y >= 10; y -= 10) {
+        ring.push_back(offsetPoint(y % 20 == 0 ? 0 : 3, y));
+    }
+    return ring;
+}
+
+static double ringArea(const std::vector<GeoPoint>& ring) {
+    double area = 0.0;
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+        area += (static_cast<double>(ring[j].lon) - ring[i].lon) * (static_cast<double>(ring[j].lat) + ring[i].lat);
+    }
+    return area;
+}
+
+static double orientation(const GeoPoint& o, const GeoPoint& a, const GeoPoint& b) {
+    return (static_cast<double>(a.lon) - o.lon) * (static_cast<double>(b.lat) - o.lat) -
+           (static_cast<double>(a.lat) - o.lat) * (static_cast<double>(b.lon) - o.lon);
+}
+
+static bool onSegment(const GeoPoint& p, const GeoPoint& a, const GeoPoint& b) {
+    return orientation(a, b, p) == 0.0 && fmin(a.lat, b.lat) <= p.lat && p.lat <= fmax(a.lat, b.lat) &&
+           fmin(a.lon, b.lon) <= p.lon && p.lon <= fmax(a.lon, b.lon);
+}
+
+static bool segmentsMeet(const GeoPoint& a, const GeoPoint& b, const GeoPoint& c, const GeoPoint& d) {
+    if (orientation(a, b, c) * orientation(a, b, d) < 0.0 && orientation(c, d, a) * orientation(c, d, b) < 0.0) {
+        return true;
+    }
+    return onSegment(c, a, b) || onSegment(d, a, b) || onSegment(a, c, d) || onSegment(b, c, d);
+}
+
+static bool ringIsSimple(const std::vector<GeoPoint>& ring) {
+    size_t count = ring.size();
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = i + 2; j < count && (i != 0 || j != count - 1); j++) {
+            if (segmentsMeet(ring[i], ring[(i + 1) % count], ring[j], ring[(j + 1) % count])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Even-odd in double, for points off the boundary
+static bool inside(const std::vector<GeoPoint>& ring, double lat, double lon) {
+    bool in = false;
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+        double latI = ring[i].lat, lonI = ring[i].lon, latJ = ring[j].lat, lonJ = ring[j].lon;
+        if ((latI > lat) != (latJ > lat) && lon < lonI + (lat - latI) * (lonJ - lonI) / (latJ - latI)) {
+            in = !in;
+        }
+    }
+    return in;
+}
+
+static bool isVertex(const std::vector<GeoPoint>& ring, const GeoPoint& point) {
+    for (const GeoPoint& vertex : ring) {
+        if (vertex.lat == point.lat && vertex.lon == point.lon) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool insideOrOn(const std::vector<GeoPoint>& ring, const GeoPoint& point) {
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+        if (onSegment(point, ring[j], ring[i])) {
+            return true;
+        }
+    }
+    return inside(ring, point.lat, point.lon);
+}
+
+// Grid points inside the first ring that are outside the second
+static size_t pointsEscaping(const std::vector<GeoPoint>& from, const std::vector<GeoPoint>& to) {
+    Polygon polygon(from.data(), from.size());
+    size_t escaping = 0;
+    for (int i = -10; i <= 310; i++) {
+        for (int j = -10; j <= 310; j++) {
+            double lat = polygon.minLat() + (polygon.maxLat() - polygon.minLat()) * (i + 0.37) / 300.0;
+            double lon = polygon.minLon() + (polygon.maxLon() - polygon.minLon()) * (j + 0.61) / 300.0;
+            if (inside(from, lat, lon) && !inside(to, lat, lon)) {
+                escaping++;
+            }
+        }
+    }
+    return escaping;
+}
+
+static FenceSimplifyOptions options(size_t maxVertices, float toleranceMeters, FenceSimplifyMode mode) {
+    FenceSimplifyOptions result = {maxVertices, toleranceMeters, mode};
+    return result;
+}
+
+// ============================================================================
+// Basic Tests
+// ============================================================================
+
+void test_collinear_vertices_are_free(void) {
+    std::vector<GeoPoint> ring;
+    for (int i = 0; i < 4; i++) {
+        ring.push_back(offsetPoint(i * 25.0, 0));
+    }
+    for (int i = 0; i < 4; i++) {
+        ring.push_back(offsetPoint(100, i * 25.0));
+    }
+    ring.push_back(offsetPoint(100, 100));
+    ring.push_back(offsetPoint(0, 100));
+
+    FenceSimplifier simplifier;
+    std::vector<GeoPoint> out;
+    TEST_ASSERT_TRUE(simplifier.simplify(ring.data(), ring.size(), options(0, 0.05f, FenceSimplifyMode::ANY), out));
+    TEST_ASSERT_EQUAL_UINT32(4, out.size());
+    TEST_ASSERT_EQUAL_UINT32(6, simplifier.stats().removals);
+    TEST_ASSERT_TRUE(simplifier.stats().errorMeters < 0.05f);
+    TEST_ASSERT_TRUE(isVertex(out, offsetPoint(0, 0)));
+    TEST_ASSERT_TRUE(isVertex(out, offsetPoint(100, 100)));
+}
+
+void test_vertex_budget(void) {
+    std::vector<GeoPoint> ring = makeParcel(400, 1);
+    FenceSimplifier simplifier;
+    std::vector<GeoPoint> out;
+    TEST_ASSERT_TRUE(simplifier.simplify(ring.data(), ring.size(), options(16, 0.0f, FenceSimplifyMode::ANY), out));
+    TEST_ASSERT_EQUAL_UINT32(16, out.size());
+    TEST_ASSERT_EQUAL_UINT32(400, simplifier.stats().inputVertices);
+    TEST_ASSERT_EQUAL_UINT32(16, simplifier.stats().outputVertices);
+    TEST_ASSERT_TRUE(ringIsSimple(out));
+
+    // The reported error bounds every original vertex
+    float error = simplifier.stats().errorMeters;
+    TEST_ASSERT_TRUE(error > 0.5f && error < 15.0f);
+    Polygon simplified(out.data(), out.size());
+    for (const GeoPoint& vertex : ring) {
+        TEST_ASSERT_TRUE(simplified.distanceToBoundary(vertex) <= error + 0.1f);
+    }
+}
+
+void test_tolerance(void) {
+    std::vector<GeoPoint> ring = makeParcel(400, 2);
+    FenceSimplifier simplifier;
+    std::vector<GeoPoint> fine;
+    std::vector<GeoPoint> coarse;
+    TEST_ASSERT_TRUE(simplifier.simplify(ring.data(), ring.size(), options(0, 1.0f, FenceSimplifyMode::ANY), fine));
+    TEST_ASSERT_TRUE(simplifier.stats().errorMeters <= 1.0f);
+    TEST_ASSERT_TRUE(simplifier.simplify(ring.data(), ring.size(), options(0, 5.0f, FenceSimplifyMode::ANY), coarse));
+    TEST_ASSERT_TRUE(simplifier.stats().errorMeters <= 5.0f);
+
+    TEST_ASSERT_TRUE(fine.size() < 200);
+    TEST_ASSERT_TRUE(coarse.size() < fine.size());
+    TEST_ASSERT_TRUE(ringIsSimple(fine));
+    TEST_ASSERT_TRUE(ringIsSimple(coarse));
+
+    // A budget still applies on top of the tolerance
+    std::vector<GeoPoint> budget;
+    TEST_ASSERT_TRUE(simplifier.simplify(ring.data(), ring.size(), options(8, 5.0f, FenceSimplifyMode::ANY), budget));
+    TEST_ASSERT_EQUAL_UINT32(8, budget.size());
+}
+
+void test_orientation_kept(void) {
+    std::vector<GeoPoint> ring = makeParcel(200, 3);
+    std::vector<GeoPoint> clockwise(ring.rbegin(), ring.rend());
+    FenceSimplifier simplifier;
+    std::vector<GeoPoint> out;
+    std::vector<GeoPoint> outClockwise;
+    TEST_ASSERT_TRUE(simplifier.simplify(ring.data(), ring.size(), options(12, 0.0f, FenceSimplifyMode::INNER), out));
+    TEST_ASSERT_TRUE(simplifier.simplify(clockwise.data(), clockwise.size(),
+                                         options(12, 0.0f, FenceSimplifyMode::INNER), outClockwise));
+    TEST_ASSERT_TRUE(ringArea(out) > 0.0);
+    TEST_ASSERT_TRUE(ringArea(outClockwise) < 0.0);
+    TEST_ASSERT_EQUAL_UINT32(out.size(), outClockwise.size());
+}
+
+// ============================================================================
+// Conservative Mode Tests
+// ============================================================================
+
+void test_inner_mode_stays_inside(void) {
+    std::vector<GeoPoint> ring = makeParcel(400, 4);
+    FenceSimplifier simplifier;
+    std::vector<GeoPoint> out;
+    TEST_ASSERT_TRUE(simplifier.simplify(ring.data(), ring.size(), options(16, 0.0f, FenceSimplifyMode::INNER), out));
+    TEST_ASSERT_EQUAL_UINT32(16, out.size());
+    TEST_ASSERT_TRUE(ringIsSimple(out));
+    TEST_ASSERT_EQUAL_UINT32(0, pointsEscaping(out, ring));
+    TEST_ASSERT_TRUE(pointsEscaping(ring, out) > 0);
+
+    // Never further off than plain simplification allows, give or take
+    FenceSimplifyStats inner = simplifier.stats();
+    std::vector<GeoPoint> any;
+    TEST_ASSERT_TRUE(simplifier.simplify(ring.data(), ring.size(), options(16, 0.0f, FenceSimplifyMode::ANY), any));
+    TEST_ASSERT_TRUE(inner.errorMeters < 4.0f * simplifier.stats().errorMeters);
+}
+
+void test_outer_mode_contains(void) {
+    std::vector<GeoPoint> ring = makeParcel(400, 5);
+    FenceSimplifier simplifier;
+    std::vector<GeoPoint> out;
+    TEST_ASSERT_TRUE(simplifier.simplify(ring.data(), ring.size(), options(16, 0.0f, FenceSimplifyMode::OUTER), out));
+    TEST_ASSERT_EQUAL_UINT32(16, out.size());
+    TEST_ASSERT_TRUE(ringIsSimple(out));
+    TEST_ASSERT_EQUAL_UINT32(0, pointsEscaping(ring, out));
+    TEST_ASSERT_TRUE(pointsEscaping(out, ring) > 0);
+    for (const GeoPoint& vertex : ring) {
+        TEST_ASSERT_TRUE(insideOrOn(out, vertex));
+    }
+}
+
+void test_outer_mode_convex_needs_collapses(void) {
+    // A round paddock has no vertex that can go without cutting it
+    std::vector<GeoPoint> ring;
+    for (int i = 0; i < 64; i++) {
+        ring.push_back(offsetPoint(80.0 * cos(M_PI * i / 32), 80.0 * sin(M_PI * i / 32)));
+    }
+    FenceSimplifier simplifier;
+    std::vector<GeoPoint> out;
+    TEST_ASSERT_TRUE(simplifier.simplify(ring.data(), ring.size(), options(8, 0.0f, FenceSimplifyMode::OUTER), out));
+    TEST_ASSERT_EQUAL_UINT32(8, out.size());
+    TEST_ASSERT_TRUE(simplifier.stats().collapses > 0);
+    TEST_ASSERT_TRUE(ringIsSimple(out));
+    for (const GeoPoint& vertex : ring) {
+        TEST_ASSERT_TRUE(insideOrOn(out, vertex));
+    }
+
+    // The best octagon around a circle of 80 m reaches out 6.6 m; greedy
+    // steps stay within a few times that
+    float error = simplifier.stats().errorMeters;
+    TEST_ASSERT_TRUE(error > 6.6f && error < 20.0f);
+    Polygon simplified(out.data(), out.size());
+    for (const GeoPoint& vertex : ring) {
+        TEST_ASSERT_TRUE(simplified.distanceToBoundary(vertex) <= error + 0.1f);
+    }
+}
+
+void test_inner_mode_star(void) {
+    std::vector<GeoPoint> ring = makeStar(20);
+    FenceSimplifier simplifier;
+    std::vector<GeoPoint> out;
+    TEST_ASSERT_TRUE(simplifier.simplify(ring.data(), ring.size(), options(6, 0.0f, FenceSimplifyMode::INNER), out));
+    TEST_ASSERT_TRUE(out.size() <= 6);
+    TEST_ASSERT_TRUE(ringIsSimple(out));
+    TEST_ASSERT_EQUAL_UINT32(0, pointsEscaping(out, ring));
+
+    TEST_ASSERT_TRUE(simplifier.simplify(ring.data(), ring.size(), options(6, 0.0f, FenceSimplifyMode::OUTER), out));
+    TEST_ASSERT_TRUE(out.size() <= 6);
+    TEST_ASSERT_TRUE(ringIsSimple(out));
+    TEST_ASSERT_EQUAL_UINT32(0, pointsEscaping(ring, out));
+}
+
+// ============================================================================
+// Topology Tests
+// ============================================================================
+
+void test_narrow_slot_stays_open(void) {
+    std::vector<GeoPoint> ring = makeSlot();
+    TEST_ASSERT_TRUE(ringIsSimple(ring));
+    const FenceSimplifyMode modes[] = {FenceSimplifyMode::ANY, FenceSimplifyMode::INNER, FenceSimplifyMode::OUTER};
+    FenceSimplifier simplifier;
+    std::vector<GeoPoint> out;
+    uint32_t refused = 0;
+    for (FenceSimplifyMode mode : modes) {
+        simplifier.simplify(ring.data(), ring.size(), options(8, 0.0f, mode), out);
+        TEST_ASSERT_TRUE(out.size() >= 3 && out.size() < ring.size());
+        TEST_ASSERT_TRUE(ringIsSimple(out));
+        refused += simplifier.stats().refused;
+
+        // The slot stays outside
+        GeoPoint slot = offsetPoint(30, 150);
+        TEST_ASSERT_FALSE(inside(out, slot.lat, slot.lon));
+    }
+    TEST_ASSERT_TRUE(refused > 0);
+}
+
+void test_rejects_bad_input(void) {
+    FenceSimplifier simplifier;
+    std::vector<GeoPoint> out;
+
+    // Bow tie
+    GeoPoint bowTie[] = {offsetPoint(0, 0), offsetPoint(100, 100), offsetPoint(100, 0), offsetPoint(0, 100)};
+    TEST_ASSERT_FALSE(simplifier.simplify(bowTie, 4, options(3, 0.0f, FenceSimplifyMode::ANY), out));
+    TEST_ASSERT_EQUAL_UINT32(4, out.size());
+
+    // Closed ring: the repeated first vertex is a zero-length edge
+    GeoPoint closed[] = {offsetPoint(0, 0), offsetPoint(100, 0), offsetPoint(100, 100), offsetPoint(0, 100),
+                         offsetPoint(0, 0)};
+    TEST_ASSERT_FALSE(simplifier.simplify(closed, 5, options(4, 0.0f, FenceSimplifyMode::ANY), out));
+
+    // Too few vertices, or a budget under a triangle
+    TEST_ASSERT_FALSE(simplifier.simplify(closed, 2, options(0, 1.0f, FenceSimplifyMode::ANY), out));
+    TEST_ASSERT_FALSE(simplifier.simplify(closed, 4, options(2, 1.0f, FenceSimplifyMode::ANY), out));
+
+    // Already within budget: unchanged
+    TEST_ASSERT_TRUE(simplifier.simplify(closed, 4, options(4, 0.0f, FenceSimplifyMode::ANY), out));
+    TEST_ASSERT_EQUAL_UINT32(4, out.size());
+    TEST_ASSERT_EQUAL_UINT32(0, simplifier.stats().removals);
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Basic tests
+    RUN_TEST(test_collinear_vertices_are_free);
+    RUN_TEST(test_vertex_budget);
+    RUN_TEST(test_tolerance);
+    RUN_TEST(test_orientation_kept);
+
+    // Conservative mode tests
+    RUN_TEST(test_inner_mode_stays_inside);
+    RUN_TEST(test_outer_mode_contains);
+    RUN_TEST(test_outer_mode_convex_needs_collapses);
+    RUN_TEST(test_inner_mode_star);
+
+    // Topology tests
+    RUN_TEST(test_narrow_slot_stays_open);
+    RUN_TEST(test_rejects_bad_input);
+
+    return UNITY_END();
+}
@@ -0,0 +1,289 @@
+/**
+ * @file test_fence_store.cpp
+ * @brief Unit tests for the fence_store library (native mmap backend).
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "fence_store.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+static const char* STORE_PATH = "test_fence_store.bin";
+
+// Simple square polygon, same as the point_in_polygon tests
+GeoPoint squarePolygon[] = {
+    {40.7120f, -74.0070f},
+    {40.7120f, -74.0060f},
+    {40.7130f, -74.0060f},
+    {40.7130f, -74.0070f}
+};
+const size_t squarePolygonCount = 4;
+
+// Large circular fence, well above the NVS limit of MAX_BOUNDARY_VERTICES
+const size_t LARGE_FENCE_COUNT = 2000;
+GeoPoint largeFence[LARGE_FENCE_COUNT];
+
+static void buildLargeFence() {
+    const float centerLat = 40.7125f;
+    const float centerLon = -74.0065f;
+    const float radius = 0.001f;
+    for (size_t i = 0; i < LARGE_FENCE_COUNT; i++) {
+        float angle = 2.0f * 3.14159265f * i / LARGE_FENCE_COUNT;
+        largeFence[i].lat = centerLat + radius * sinf(angle);
+        largeFence[i].lon = centerLon + radius * cosf(angle);
+    }
+}
+
+// ============================================================================
+// Blob Tests
+// ============================================================================
+
+void test_blob_roundtrip(void) {
+    uint32_t buffer[64];  // 4-byte aligned storage
+    uint8_t* blob = reinterpret_cast<uint8_t*>(buffer);
+
+    size_t size = fenceBlobEncode(squarePolygon, squarePolygonCount, 42, blob, sizeof(buffer));
+    TEST_ASSERT_EQUAL_UINT(fenceBlobSize(squarePolygonCount), size);
+
+    const FenceBlobHeader* header = fenceBlobValidate(blob, size);
+    TEST_ASSERT_NOT_NULL(header);
+    TEST_ASSERT_EQUAL_UINT32(42, header->fenceId);
+    TEST_ASSERT_EQUAL_UINT32(squarePolygonCount, header->vertexCount);
+
+    const GeoPoint* vertices = fenceBlobVertices(header);
+    TEST_ASSERT_EQUAL_FLOAT(squarePolygon[2].lat, vertices[2].lat);
+    TEST_ASSERT_EQUAL_FLOAT(squarePolygon[2].lon, vertices[2].lon);
+}
+
+void test_blob_rejects_corruption(void) {
+    uint32_t buffer[64];
+    uint8_t* blob = reinterpret_cast<uint8_t*>(buffer);
+
+    size_t size = fenceBlobEncode(squarePolygon, squarePolygonCount, 1, blob, sizeof(buffer));
+    blob[size - 1] ^= 0x01;  // Flip a bit in the last vertex
+    TEST_ASSERT_NULL(fenceBlobValidate(blob, size));
+}
+
+void test_blob_rejects_truncation(void) {
+    uint32_t buffer[64];
+    uint8_t* blob = reinterpret_cast<uint8_t*>(buffer);
+
+    size_t size = fenceBlobEncode(squarePolygon, squarePolygonCount, 1, blob, sizeof(buffer));
+    TEST_ASSERT_NULL(fenceBlobValidate(blob, size - 1));
+}
+
+void test_blob_rejects_small_buffer(void) {
+    uint32_t buffer[4];
+    TEST_ASSERT_EQUAL_UINT(0, fenceBlobEncode(squarePolygon, squarePolygonCount, 1,
+                                              reinterpret_cast<uint8_t*>(buffer), sizeof(buffer)));
+}
+
+void test_blob_rejects_too_few_vertices(void) {
+    uint32_t buffer[64];
+    TEST_ASSERT_EQUAL_UINT(0, fenceBlobEncode(squarePolygon, 2, 1,
+                                              reinterpret_cast<uint8_t*>(buffer), sizeof(buffer)));
+}
+
+// ============================================================================
+// FenceStore Tests
+// ============================================================================
+
+void test_store_missing_file_is_invalid(void) {
+    FenceStore store;
+    TEST_ASSERT_TRUE(store.begin(STORE_PATH));
+    TEST_ASSERT_FALSE(store.isValid());
+    TEST_ASSERT_NULL(store.getVertices());
+    TEST_ASSERT_EQUAL_UINT(0, store.getVertexCount());
+}
+
+void test_store_write_and_map(void) {
+    FenceStore store;
+    TEST_ASSERT_TRUE(store.begin(STORE_PATH));
+    TEST_ASSERT_TRUE(store.write(squarePolygon, squarePolygonCount, 7));
+
+    TEST_ASSERT_TRUE(store.isValid());
+    TEST_ASSERT_EQUAL_UINT(squarePolygonCount, store.getVertexCount());
+    TEST_ASSERT_EQUAL_UINT32(7, store.getFenceId());
+
+    Polygon fence(store.getVertices(), store.getVertexCount());
+    GeoPoint inside = {40.7125f, -74.0065f};
+    GeoPoint outside = {40.7140f, -74.0065f};
+    TEST_ASSERT_TRUE(fence.contains(inside));
+    TEST_ASSERT_FALSE(fence.contains(outside));
+}
+
+void test_store_persists_across_reopen(void) {
+    {
+        FenceStore store;
+        store.begin(STORE_PATH);
+        TEST_ASSERT_TRUE(store.write(squarePolygon, squarePolygonCount, 9));
+    }
+
+    FenceStore reopened;
+    TEST_ASSERT_TRUE(reopened.begin(STORE_PATH));
+    TEST_ASSERT_TRUE(reopened.isValid());
+    TEST_ASSERT_EQUAL_UINT32(9, reopened.getFenceId());
+}
+
+void test_store_large_fence_zero_copy(void) {
+    buildLargeFence();
+
+    FenceStore store;
+    store.begin(STORE_PATH);
+    TEST_ASSERT_TRUE(store.write(largeFence, LARGE_FENCE_COUNT, 3));
+    TEST_ASSERT_EQUAL_UINT(LARGE_FENCE_COUNT, store.getVertexCount());
+
+    // Polygon points straight into the mapping, not at the source array
+    TEST_ASSERT_TRUE(store.getVertices() != largeFence);
+
+    Polygon fence(store.getVertices(), store.getVertexCount());
+    GeoPoint center = {40.7125f, -74.0065f};
+    GeoPoint outside = {40.7125f, -74.0040f};
+    TEST_ASSERT_TRUE(fence.contains(center));
+    TEST_ASSERT_FALSE(fence.contains(outside));
+}
+
+void test_store_rejects_oversized_fence(void) {
+    FenceStore store;
+    store.begin(STORE_PATH);
+    TEST_ASSERT_FALSE(store.write(largeFence, FENCE_STORE_MAX_VERTICES + 1, 1));
+}
+
+void test_store_corrupt_file_is_invalid(void) {
+    {
+        FenceStore store;
+        store.begin(STORE_PATH);
+        store.write(squarePolygon, squarePolygonCount, 5);
+    }
+
+    // Corrupt one byte of vertex data in place (a first write goes to slot 1)
+    FILE* f = fopen(STORE_PATH, "r+b");
+    TEST_ASSERT_NOT_NULL(f);
+    fseek(f, FENCE_STORE_SLOT_SIZE + sizeof(FenceBlobHeader) + 3, SEEK_SET);
+    fputc(0x5A, f);
+    fclose(f);
+
+    FenceStore store;
+    TEST_ASSERT_TRUE(store.begin(STORE_PATH));
+    TEST_ASSERT_FALSE(store.isValid());
+}
+
+void test_store_write_keeps_selected_fence(void) {
+    buildLargeFence();
+
+    FenceStore store;
+    store.begin(STORE_PATH);
+    TEST_ASSERT_TRUE(store.write(squarePolygon, squarePolygonCount, 1));
+    TEST_ASSERT_TRUE(store.write(largeFence, LARGE_FENCE_COUNT, 2));
+    TEST_ASSERT_EQUAL_UINT32(2, store.getFenceId());
+
+    // Both fences are still there, whichever one is committed
+    TEST_ASSERT_TRUE(store.selectFence(1));
+    TEST_ASSERT_EQUAL_UINT(squarePolygonCount, store.getVertexCount());
+    TEST_ASSERT_EQUAL_FLOAT(squarePolygon[2].lat, store.getVertices()[2].lat);
+    uint32_t squareCrc = store.getCrc();
+    TEST_ASSERT_TRUE(store.selectFence(2));
+    TEST_ASSERT_EQUAL_UINT(LARGE_FENCE_COUNT, store.getVertexCount());
+    TEST_ASSERT_TRUE(store.getCrc() != squareCrc);
+
+    // The next write replaces the fence that is not selected
+    TEST_ASSERT_TRUE(store.write(squarePolygon, squarePolygonCount, 3));
+    TEST_ASSERT_FALSE(store.selectFence(1));
+    TEST_ASSERT_TRUE(store.selectFence(2));
+    TEST_ASSERT_TRUE(store.selectFence(3));
+    TEST_ASSERT_FALSE(store.selectFence(4));
+    TEST_ASSERT_FALSE(store.isValid());
+}
+
+void test_store_interrupted_write_keeps_fence(void) {
+    buildLargeFence();
+
+    {
+        FenceStore store;
+        store.begin(STORE_PATH);
+        TEST_ASSERT_TRUE(store.write(squarePolygon, squarePolygonCount, 1));
+        TEST_ASSERT_TRUE(store.write(largeFence, LARGE_FENCE_COUNT, 2));
+    }
+
+    // Power lost while fence 2 was being written: its vertices are torn
+    FILE* f = fopen(STORE_PATH, "r+b");
+    TEST_ASSERT_NOT_NULL(f);
+    fseek(f, sizeof(FenceBlobHeader) + 1000, SEEK_SET);
+    fputc(0x5A, f);
+    fclose(f);
+
+    FenceStore store;
+    TEST_ASSERT_TRUE(store.begin(STORE_PATH));
+    TEST_ASSERT_FALSE(store.selectFence(2));
+    TEST_ASSERT_TRUE(store.selectFence(1));
+    TEST_ASSERT_EQUAL_UINT(squarePolygonCount, store.getVertexCount());
+}
+
+void test_store_host_fence_is_slot_zero(void) {
+    // A blob flashed from the host sits at offset 0
+    uint32_t buffer[64];
+    uint8_t* blob = reinterpret_cast<uint8_t*>(buffer);
+    size_t size = fenceBlobEncode(squarePolygon, squarePolygonCount, 42, blob, sizeof(buffer));
+    FILE* f = fopen(STORE_PATH, "wb");
+    TEST_ASSERT_NOT_NULL(f);
+    fwrite(blob, 1, size, f);
+    fclose(f);
+
+    FenceStore store;
+    TEST_ASSERT_TRUE(store.begin(STORE_PATH));
+    TEST_ASSERT_TRUE(store.selectFence(0));
+    TEST_ASSERT_EQUAL_UINT32(42, store.getFenceId());
+
+    // An update goes to slot 1 and does not count as the host fence
+    TEST_ASSERT_TRUE(store.write(largeFence, LARGE_FENCE_COUNT, 7));
+    TEST_ASSERT_TRUE(store.selectFence(0));
+    TEST_ASSERT_EQUAL_UINT32(42, store.getFenceId());
+    TEST_ASSERT_TRUE(store.selectFence(7));
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    unlink(STORE_PATH);
+}
+
+void tearDown(void) {
+    unlink(STORE_PATH);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Blob format tests
+    RUN_TEST(test_blob_roundtrip);
+    RUN_TEST(test_blob_rejects_corruption);
+    RUN_TEST(test_blob_rejects_truncation);
+    RUN_TEST(test_blob_rejects_small_buffer);
+    RUN_TEST(test_blob_rejects_too_few_vertices);
+
+    // Store tests
+    RUN_TEST(test_store_missing_file_is_invalid);
+    RUN_TEST(test_store_write_and_map);
+    RUN_TEST(test_store_persists_across_reopen);
+    RUN_TEST(test_store_large_fence_zero_copy);
+    RUN_TEST(test_store_rejects_oversized_fence);
+    RUN_TEST(test_store_corrupt_file_is_invalid);
+
+    // Slot tests
+    RUN_TEST(test_store_write_keeps_selected_fence);
+    RUN_TEST(test_store_interrupted_write_keeps_fence);
+    RUN_TEST(test_store_host_fence_is_slot_zero);
+
+    return UNITY_END();
+}
@@ -0,0 +1,337 @@
+/**
+ * @file test_fence_update.cpp
+ * @brief End-to-end tests for the fence_update protocol over a lossy link.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "fence_update.h"
+
+// ============================================================================
+// Test Doubles
+// ============================================================================
+
+/**
+ * @brief In-memory stand-in for ConfigManager / FenceStore.
+ */
+class MemoryTarget : public FenceUpdateTarget {
+public:
+    GeoPoint vertices[FENCE_UPDATE_MAX_VERTICES];
+    size_t count;
+    uint32_t version;
+    int commits;
+
+    void reset() {
+        // Default 4-vertex fence, version 0
+        const GeoPoint square[] = {{40.0f, -74.0f}, {40.0f, -73.9f}, {40.1f, -73.9f}, {40.1f, -74.0f}};
+        memcpy(vertices, square, sizeof(square));
+        count = 4;
+        version = 0;
+        commits = 0;
+    }
+
+    uint32_t currentVersion() const override { return version; }
+    const GeoPoint* currentVertices() const override { return vertices; }
+    size_t currentVertexCount() const override { return count; }
+
+    bool commit(const GeoPoint* v, size_t n, uint32_t ver) override {
+        memcpy(vertices, v, n * sizeof(GeoPoint));
+        count = n;
+        version = ver;
+        commits++;
+        return true;
+    }
+};
+
+/**
+ * @brief Deterministic lossy link: drops frames from a fixed LCG sequence.
+ */
+class LossyLink {
+public:
+    int dropped;
+
+    explicit LossyLink(uint32_t seed, uint8_t lossPercent)
+        : dropped(0), _seed(seed), _loss(lossPercent) {}
+
+    bool deliver() {
+        _seed = _seed * 1664525u + 1013904223u;
+        if ((_seed >> 24) % 100 < _loss) {
+            dropped++;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    uint32_t _seed;
+    uint8_t _loss;
+};
+
+FenceUpdateState state;
+MemoryTarget target;
+GeoPoint fence[FENCE_UPDATE_MAX_VERTICES];
+uint8_t msg[FENCE_MSG_MAX_SIZE];
+uint8_t reply[FENCE_MSG_STATUS_SIZE];
+
+static void buildFence(size_t count) {
+    // Roughly circular fence, distinct vertices
+    for (size_t i = 0; i < count; i++) {
+        fence[i].lat = 40.7f + 0.001f * static_cast<float>(i % 17);
+        fence[i].lon = -74.0f + 0.0001f * static_cast<float>(i);
+    }
+}
+
+/**
+ * @brief Run rounds over the link until the sender completes or gives up.
+ * @return Number of rounds used.
+ */
+static int runTransfer(FenceUpdateSender& sender, FenceUpdateReceiver& receiver,
+                       LossyLink& link, int maxRounds) {
+    int rounds = 0;
+    while (!sender.isComplete() && !sender.isRejected() && rounds < maxRounds) {
+        rounds++;
+        sender.startRound();
+        size_t len;
+        while ((len = sender.nextMessage(msg, sizeof(msg))) > 0) {
+            if (!link.deliver()) {
+                continue;
+            }
+            size_t replyLen = receiver.handle(msg, len, reply, sizeof(reply));
+            if (replyLen > 0 && link.deliver()) {
+                sender.handleStatus(reply, replyLen);
+            }
+        }
+    }
+    return rounds;
+}
+
+static void assertTargetHasFence(size_t count, uint32_t version) {
+    TEST_ASSERT_EQUAL_UINT32(version, target.version);
+    TEST_ASSERT_EQUAL_UINT(count, target.count);
+    TEST_ASSERT_EQUAL_MEMORY(fence, target.vertices, count * sizeof(GeoPoint));
+}
+
+// ============================================================================
+// Full Transfer Tests
+// ============================================================================
+
+void test_transfer_over_perfect_link(void) {
+    buildFence(50);
+    FenceUpdateSender sender;
+    FenceUpdateReceiver receiver(state, target);
+    LossyLink link(1, 0);
+
+    TEST_ASSERT_TRUE(sender.begin(fence, 50, fenceVersionMake(7, 1)));
+    TEST_ASSERT_EQUAL_UINT8(7, sender.chunkCount());
+    TEST_ASSERT_EQUAL_INT(1, runTransfer(sender, receiver, link, 10));
+    TEST_ASSERT_TRUE(sender.isComplete());
+    TEST_ASSERT_EQUAL_INT(1, target.commits);
+    TEST_ASSERT_FALSE(receiver.isReceiving());
+    assertTargetHasFence(50, fenceVersionMake(7, 1));
+}
+
+void test_transfer_over_lossy_link(void) {
+    buildFence(FENCE_UPDATE_MAX_VERTICES);
+    FenceUpdateSender sender;
+    FenceUpdateReceiver receiver(state, target);
+    LossyLink link(42, 30);
+
+    TEST_ASSERT_TRUE(sender.begin(fence, FENCE_UPDATE_MAX_VERTICES, fenceVersionMake(3, 9)));
+    int rounds = runTransfer(sender, receiver, link, 50);
+    TEST_ASSERT_TRUE(sender.isComplete());
+    TEST_ASSERT_TRUE(rounds > 1);
+    TEST_ASSERT_TRUE(link.dropped > 0);
+    TEST_ASSERT_EQUAL_INT(1, target.commits);
+    assertTargetHasFence(FENCE_UPDATE_MAX_VERTICES, fenceVersionMake(3, 9));
+}
+
+void test_transfer_resumes_after_interruption(void) {
+    buildFence(40);
+    uint32_t version = fenceVersionMake(2, 1);
+    FenceUpdateReceiver receiver(state, target);
+
+    // First session: only BEGIN and the first two chunks get through
+    FenceUpdateSender first;
+    TEST_ASSERT_TRUE(first.begin(fence, 40, version));
+    for (int i = 0; i < 3; i++) {
+        size_t len = first.nextMessage(msg, sizeof(msg));
+        receiver.handle(msg, len, reply, sizeof(reply));
+    }
+    TEST_ASSERT_TRUE(receiver.isReceiving());
+    TEST_ASSERT_EQUAL_UINT32(0x3, state.receivedMask);
+
+    // Next wake: a new sender instance learns the mask from the BEGIN reply
+    FenceUpdateSender second;
+    TEST_ASSERT_TRUE(second.begin(fence, 40, version));
+    size_t len = second.nextMessage(msg, sizeof(msg));
+    size_t replyLen = receiver.handle(msg, len, reply, sizeof(reply));
+    TEST_ASSERT_TRUE(second.handleStatus(reply, replyLen));
+
+    int chunksSent = 0;
+    while ((len = second.nextMessage(msg, sizeof(msg))) > 0) {
+        chunksSent++;
+        replyLen = receiver.handle(msg, len, reply, sizeof(reply));
+        if (replyLen > 0) {
+            second.handleStatus(reply, replyLen);
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(3, chunksSent);
+    TEST_ASSERT_TRUE(second.isComplete());
+    assertTargetHasFence(40, version);
+}
+
+void test_begin_for_current_version_reports_complete(void) {
+    buildFence(10);
+    uint32_t version = fenceVersionMake(1, 1);
+    target.commit(fence, 10, version);
+    target.commits = 0;
+
+    FenceUpdateSender sender;
+    FenceUpdateReceiver receiver(state, target);
+    LossyLink link(1, 0);
+    TEST_ASSERT_TRUE(sender.begin(fence, 10, version));
+    runTransfer(sender, receiver, link, 5);
+    TEST_ASSERT_TRUE(sender.isComplete());
+    TEST_ASSERT_EQUAL_INT(0, target.commits);
+}
+
+// ============================================================================
+// Patch Tests
+// ============================================================================
+
+void test_patch_set_insert_remove(void) {
+    FenceUpdateReceiver receiver(state, target);
+    GeoPoint p = {40.05f, -74.05f};
+
+    size_t len = FenceUpdateSender::buildPatch(0, 1, FencePatchOp::SET, 1, p, msg, sizeof(msg));
+    TEST_ASSERT_EQUAL_UINT(FENCE_MSG_PATCH_SIZE, len);
+    receiver.handle(msg, len, reply, sizeof(reply));
+    TEST_ASSERT_EQUAL_UINT32(1, target.version);
+    TEST_ASSERT_EQUAL_FLOAT(-74.05f, target.vertices[1].lon);
+
+    len = FenceUpdateSender::buildPatch(1, 2, FencePatchOp::INSERT, 4, p, msg, sizeof(msg));
+    receiver.handle(msg, len, reply, sizeof(reply));
+    TEST_ASSERT_EQUAL_UINT(5, target.count);
+    TEST_ASSERT_EQUAL_FLOAT(40.05f, target.vertices[4].lat);
+
+    len = FenceUpdateSender::buildPatch(2, 3, FencePatchOp::REMOVE, 0, p, msg, sizeof(msg));
+    receiver.handle(msg, len, reply, sizeof(reply));
+    TEST_ASSERT_EQUAL_UINT(4, target.count);
+    TEST_ASSERT_EQUAL_FLOAT(40.05f, target.vertices[0].lat);
+    TEST_ASSERT_EQUAL_UINT32(3, target.version);
+}
+
+void test_patch_with_wrong_base_rejected(void) {
+    FenceUpdateReceiver receiver(state, target);
+    FenceUpdateSender sender;
+    buildFence(4);
+    sender.begin(fence, 4, 99);
+
+    GeoPoint p = {1.0f, 1.0f};
+    size_t len = FenceUpdateSender::buildPatch(5, 99, FencePatchOp::SET, 0, p, msg, sizeof(msg));
+    size_t replyLen = receiver.handle(msg, len, reply, sizeof(reply));
+    TEST_ASSERT_TRUE(sender.handleStatus(reply, replyLen));
+    TEST_ASSERT_TRUE(sender.isRejected());
+    TEST_ASSERT_EQUAL_INT(0, target.commits);
+}
+
+void test_patch_cannot_shrink_below_triangle(void) {
+    FenceUpdateReceiver receiver(state, target);
+    GeoPoint p = {0, 0};
+
+    size_t len = FenceUpdateSender::buildPatch(0, 1, FencePatchOp::REMOVE, 0, p, msg, sizeof(msg));
+    receiver.handle(msg, len, reply, sizeof(reply));
+    TEST_ASSERT_EQUAL_UINT(3, target.count);
+
+    len = FenceUpdateSender::buildPatch(1, 2, FencePatchOp::REMOVE, 0, p, msg, sizeof(msg));
+    receiver.handle(msg, len, reply, sizeof(reply));
+    TEST_ASSERT_EQUAL_UINT(3, target.count);
+    TEST_ASSERT_EQUAL_UINT32(1, target.version);
+}
+
+// ============================================================================
+// Error Handling Tests
+// ============================================================================
+
+void test_corrupted_chunk_ignored(void) {
+    buildFence(16);
+    FenceUpdateSender sender;
+    FenceUpdateReceiver receiver(state, target);
+    sender.begin(fence, 16, 5);
+
+    size_t len = sender.nextMessage(msg, sizeof(msg));
+    receiver.handle(msg, len, reply, sizeof(reply));
+    len = sender.nextMessage(msg, sizeof(msg));
+    msg[10] ^= 0x01;
+    TEST_ASSERT_EQUAL_UINT(0, receiver.handle(msg, len, reply, sizeof(reply)));
+    TEST_ASSERT_EQUAL_UINT32(0, state.receivedMask);
+}
+
+void test_fence_crc_mismatch_rejected(void) {
+    buildFence(12);
+    FenceUpdateSender sender;
+    FenceUpdateReceiver receiver(state, target);
+    sender.begin(fence, 12, 8);
+
+    // Change the fence after BEGIN was built: chunks no longer match the CRC
+    size_t len = sender.nextMessage(msg, sizeof(msg));
+    receiver.handle(msg, len, reply, sizeof(reply));
+    fence[3].lat += 1.0f;
+
+    size_t replyLen = 0;
+    while ((len = sender.nextMessage(msg, sizeof(msg))) > 0) {
+        replyLen = receiver.handle(msg, len, reply, sizeof(reply));
+    }
+    TEST_ASSERT_TRUE(sender.handleStatus(reply, replyLen));
+    TEST_ASSERT_TRUE(sender.isRejected());
+    TEST_ASSERT_EQUAL_INT(0, target.commits);
+    TEST_ASSERT_FALSE(receiver.isReceiving());
+}
+
+void test_sender_rejects_bad_fences(void) {
+    FenceUpdateSender sender;
+    buildFence(FENCE_UPDATE_MAX_VERTICES);
+    TEST_ASSERT_FALSE(sender.begin(fence, 2, 1));
+    TEST_ASSERT_FALSE(sender.begin(fence, FENCE_UPDATE_MAX_VERTICES + 1, 1));
+    TEST_ASSERT_FALSE(sender.begin(fence, 10, 0));
+    TEST_ASSERT_FALSE(sender.begin(nullptr, 10, 1));
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    memset(&state, 0, sizeof(state));
+    target.reset();
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Full transfer tests
+    RUN_TEST(test_transfer_over_perfect_link);
+    RUN_TEST(test_transfer_over_lossy_link);
+    RUN_TEST(test_transfer_resumes_after_interruption);
+    RUN_TEST(test_begin_for_current_version_reports_complete);
+
+    // Patch tests
+    RUN_TEST(test_patch_set_insert_remove);
+    RUN_TEST(test_patch_with_wrong_base_rejected);
+    RUN_TEST(test_patch_cannot_shrink_below_triangle);
+
+    // Error handling tests
+    RUN_TEST(test_corrupted_chunk_ignored);
+    RUN_TEST(test_fence_crc_mismatch_rejected);
+    RUN_TEST(test_sender_rejects_bad_fences);
+
+    return UNITY_END();
+}
@@ -0,0 +1,307 @@
+/**
+ * @file test_fence_validate.cpp
+ * @brief Unit tests for the fence_validate library.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+#include "fence_validate.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+// Counter-clockwise square, about 100 m across
+static const GeoPoint SQUARE[] = {
+    {40.7000f, -74.0010f}, {40.7000f, -74.0000f}, {40.7010f, -74.0000f}, {40.7010f, -74.0010f}
+};
+
+// Vertices on a small integer grid: lots of shared latitudes, collinear
+// runs and repeated points
+static std::vector<GeoPoint> gridRing(size_t count, int size, uint32_t& seed) {
+    std::vector<GeoPoint> ring;
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        ring.push_back({static_cast<float>((seed >> 8) % size), static_cast<float>((seed >> 20) % size)});
+    }
+    return ring;
+}
+
+static double orient(const GeoPoint& a, const GeoPoint& b, const GeoPoint& c) {
+    return (static_cast<double>(b.lon) - a.lon) * (static_cast<double>(c.lat) - a.lat) -
+           (static_cast<double>(b.lat) - a.lat) * (static_cast<double>(c.lon) - a.lon);
+}
+
+static bool onSegment(const GeoPoint& a, const GeoPoint& b, const GeoPoint& p) {
+    return orient(a, b, p) == 0.0 &&
+           fminf(a.lon, b.lon) <= p.lon && p.lon <= fmaxf(a.lon, b.lon) &&
+           fminf(a.lat, b.lat) <= p.lat && p.lat <= fmaxf(a.lat, b.lat);
+}
+
+static bool segmentsMeet(const GeoPoint& a, const GeoPoint& b, const GeoPoint& c, const GeoPoint& d) {
+    double o1 = orient(a, b, c);
+    double o2 = orient(a, b, d);
+    double o3 = orient(c, d, a);
+    double o4 = orient(c, d, b);
+    if (((o1 > 0.0 && o2 < 0.0) || (o1 < 0.0 && o2 > 0.0)) && ((o3 > 0.0 && o4 < 0.0) || (o3 < 0.0 && o4 > 0.0))) {
+        return true;
+    }
+    return onSegment(a, b, c) || onSegment(a, b, d) || onSegment(c, d, a) || onSegment(c, d, b);
+}
+
+// Brute force: drop in-line vertices until none are left, then test every
+// pair of non-adjacent edges
+static FenceVerdict bruteForce(std::vector<GeoPoint> ring) {
+    bool dropped = true;
+    while (dropped && ring.size() >= 3) {
+        dropped = false;
+        size_t n = ring.size();
+        for (size_t i = 0; i < n; i++) {
+            if (orient(ring[(i + n - 1) % n], ring[i], ring[(i + 1) % n]) == 0.0) {
+                ring.erase(ring.begin() + static_cast<ptrdiff_t>(i));
+                dropped = true;
+                break;
+            }
+        }
+    }
+    size_t n = ring.size();
+    if (n < 3) {
+        return FenceVerdict::ZERO_AREA;
+    }
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i + 2; j < n; j++) {
+            if ((i == 0 && j == n - 1) || !segmentsMeet(ring[i], ring[i + 1], ring[j], ring[(j + 1) % n])) {
+                continue;
+            }
+            return FenceVerdict::SELF_INTERSECTING;
+        }
+    }
+    return FenceVerdict::CLEAN;
+}
+
+static double signedArea(const GeoPoint* ring, size_t count) {
+    double area = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        const GeoPoint& p = ring[i];
+        const GeoPoint& q = ring[(i + 1) % count];
+        area += static_cast<double>(p.lon) * q.lat - static_cast<double>(q.lon) * p.lat;
+    }
+    return area / 2.0;
+}
+
+// ============================================================================
+// Verdict Tests
+// ============================================================================
+
+void test_clean_square(void) {
+    FenceValidation result = fenceValidate(SQUARE, 4);
+    TEST_ASSERT_EQUAL(FenceVerdict::CLEAN, result.verdict);
+    TEST_ASSERT_EQUAL(4, result.vertexCount);
+    TEST_ASSERT_EQUAL(0, result.removed);
+    TEST_ASSERT_FALSE(result.reversed);
+    TEST_ASSERT_TRUE(fenceVerdictUsable(result.verdict));
+}
+
+void test_too_few_and_too_many(void) {
+    TEST_ASSERT_EQUAL(FenceVerdict::TOO_FEW_VERTICES, fenceValidate(SQUARE, 2).verdict);
+    TEST_ASSERT_EQUAL(FenceVerdict::TOO_FEW_VERTICES, fenceValidate(nullptr, 4).verdict);
+
+    std::vector<GeoPoint> large(FENCE_VALIDATE_MAX_VERTICES + 1, SQUARE[0]);
+    TEST_ASSERT_EQUAL(FenceVerdict::TOO_MANY_VERTICES, fenceValidate(large.data(), large.size()).verdict);
+}
+
+void test_bad_coordinates(void) {
+    GeoPoint ring[4];
+    for (size_t i = 0; i < 4; i++) {
+        ring[i] = SQUARE[i];
+    }
+    ring[2].lat = NAN;
+    TEST_ASSERT_EQUAL(FenceVerdict::BAD_COORDINATE, fenceValidate(ring, 4).verdict);
+    ring[2].lat = INFINITY;
+    TEST_ASSERT_EQUAL(FenceVerdict::BAD_COORDINATE, fenceValidate(ring, 4).verdict);
+    ring[2].lat = 40.7010f;
+    ring[1].lon = 181.0f;
+    TEST_ASSERT_EQUAL(FenceVerdict::BAD_COORDINATE, fenceValidate(ring, 4).verdict);
+    TEST_ASSERT_FALSE(fenceVerdictUsable(FenceVerdict::BAD_COORDINATE));
+}
+
+void test_zero_area(void) {
+    // All on one line, with a repeated point
+    const GeoPoint line[] = {{0.0f, 0.0f}, {1.0f, 1.0f}, {1.0f, 1.0f}, {3.0f, 3.0f}, {2.0f, 2.0f}};
+    FenceValidation result = fenceValidate(line, 5);
+    TEST_ASSERT_EQUAL(FenceVerdict::ZERO_AREA, result.verdict);
+
+    const GeoPoint same[] = {{5.0f, 5.0f}, {5.0f, 5.0f}, {5.0f, 5.0f}};
+    TEST_ASSERT_EQUAL(FenceVerdict::ZERO_AREA, fenceValidate(same, 3).verdict);
+}
+
+void test_self_intersecting(void) {
+    // Bow tie
+    const GeoPoint bowTie[] = {{0.0f, 0.0f}, {0.0f, 2.0f}, {2.0f, 0.0f}, {2.0f, 2.0f}};
+    TEST_ASSERT_EQUAL(FenceVerdict::SELF_INTERSECTING, fenceValidate(bowTie, 4).verdict);
+
+    // Two squares pinched at a shared corner
+    const GeoPoint pinch[] = {{0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {2.0f, 1.0f},
+                              {2.0f, 2.0f}, {1.0f, 2.0f}, {1.0f, 1.0f}, {1.0f, 0.0f}};
+    TEST_ASSERT_EQUAL(FenceVerdict::SELF_INTERSECTING, fenceValidate(pinch, 8).verdict);
+
+    // A vertex resting on another edge
+    const GeoPoint touch[] = {{0.0f, 0.0f}, {0.0f, 4.0f}, {4.0f, 4.0f}, {4.0f, 3.0f},
+                              {0.0f, 2.0f}, {4.0f, 1.0f}, {4.0f, 0.0f}};
+    TEST_ASSERT_EQUAL(FenceVerdict::SELF_INTERSECTING, fenceValidate(touch, 7).verdict);
+
+    // Collinear edges overlapping, not adjacent
+    const GeoPoint overlap[] = {{0.0f, 0.0f}, {0.0f, 3.0f}, {2.0f, 3.0f}, {2.0f, 2.0f},
+                                {0.0f, 2.0f}, {0.0f, 1.0f}, {2.0f, 1.0f}, {2.0f, 0.0f}};
+    TEST_ASSERT_EQUAL(FenceVerdict::SELF_INTERSECTING, fenceValidate(overlap, 8).verdict);
+}
+
+// ============================================================================
+// Repair Tests
+// ============================================================================
+
+void test_repair_drops_and_reverses(void) {
+    // Clockwise, with a duplicate, a collinear vertex, a spike, and the
+    // first vertex repeated at the end
+    GeoPoint ring[] = {
+        {0.0f, 0.0f}, {2.0f, 0.0f}, {2.0f, 0.0f}, {4.0f, 0.0f},
+        {4.0f, 4.0f}, {4.0f, 6.0f}, {4.0f, 4.0f}, {0.0f, 4.0f}, {0.0f, 0.0f}
+    };
+    size_t count = 9;
+    FenceValidation check = fenceValidate(ring, count);
+    TEST_ASSERT_EQUAL(FenceVerdict::REPAIRED, check.verdict);
+    TEST_ASSERT_TRUE(check.reversed);
+    TEST_ASSERT_EQUAL(4, check.vertexCount);
+    TEST_ASSERT_EQUAL(5, check.removed);
+
+    FenceValidation result = fenceValidateRepair(ring, count);
+    TEST_ASSERT_EQUAL(FenceVerdict::REPAIRED, result.verdict);
+    TEST_ASSERT_EQUAL(4, count);
+    TEST_ASSERT_TRUE(signedArea(ring, count) > 0.0);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, ring[0].lat);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, ring[0].lon);
+    // Counter-clockwise from the first vertex: east along the bottom
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, ring[1].lat);
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, ring[1].lon);
+
+    // Idempotent
+    FenceValidation again = fenceValidateRepair(ring, count);
+    TEST_ASSERT_EQUAL(FenceVerdict::CLEAN, again.verdict);
+    TEST_ASSERT_EQUAL(4, count);
+}
+
+void test_repair_leaves_unusable_fence(void) {
+    GeoPoint bowTie[] = {{0.0f, 0.0f}, {0.0f, 2.0f}, {2.0f, 0.0f}, {2.0f, 2.0f}, {2.0f, 2.0f}};
+    size_t count = 5;
+    TEST_ASSERT_EQUAL(FenceVerdict::SELF_INTERSECTING, fenceValidateRepair(bowTie, count).verdict);
+    TEST_ASSERT_EQUAL(5, count);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, bowTie[4].lat);
+}
+
+void test_comb_is_simple(void) {
+    // A rectilinear comb: every tooth shares its latitudes with the others
+    std::vector<GeoPoint> comb;
+    const size_t teeth = 200;
+    comb.push_back({0.0f, 0.0f});
+    comb.push_back({0.0f, 2 * teeth * 0.25f});
+    for (size_t i = 2 * teeth; i >= 1; i--) {
+        float height = i % 2 == 0 ? 10.0f : 2.0f;
+        comb.push_back({height, i * 0.25f});
+        comb.push_back({height, (i - 1) * 0.25f});
+    }
+    FenceValidation result = fenceValidate(comb.data(), comb.size());
+    TEST_ASSERT_EQUAL(FenceVerdict::CLEAN, result.verdict);
+
+    // Widen one gap under the next tooth: its corner lands on the tooth's side
+    comb[5].lon = comb[7].lon;
+    TEST_ASSERT_EQUAL(FenceVerdict::SELF_INTERSECTING, fenceValidate(comb.data(), comb.size()).verdict);
+}
+
+void test_matches_brute_force(void) {
+    uint32_t seed = 12345;
+    size_t verdicts[3] = {0, 0, 0};
+    for (int i = 0; i < 20000; i++) {
+        size_t count = 3 + i % 12;
+        std::vector<GeoPoint> ring = gridRing(count, 2 + i % 6, seed);
+        FenceVerdict expected = bruteForce(ring);
+        FenceVerdict verdict = fenceValidate(ring.data(), ring.size()).verdict;
+        if (verdict == FenceVerdict::REPAIRED) {
+            verdict = FenceVerdict::CLEAN;
+        }
+        TEST_ASSERT_EQUAL(expected, verdict);
+        verdicts[expected == FenceVerdict::CLEAN ? 0 : expected == FenceVerdict::ZERO_AREA ? 1 : 2]++;
+    }
+    // Every kind of ring was covered
+    TEST_ASSERT_TRUE(verdicts[0] > 1000);
+    TEST_ASSERT_TRUE(verdicts[1] > 1000);
+    TEST_ASSERT_TRUE(verdicts[2] > 1000);
+}
+
+void test_repair_keeps_containment(void) {
+    uint32_t seed = 777;
+    size_t repaired = 0;
+    for (int i = 0; i < 2000; i++) {
+        std::vector<GeoPoint> ring = gridRing(4 + i % 8, 4 + i % 5, seed);
+        std::vector<GeoPoint> fixed = ring;
+        size_t count = fixed.size();
+        if (fenceValidateRepair(fixed.data(), count).verdict != FenceVerdict::REPAIRED) {
+            continue;
+        }
+        repaired++;
+        TEST_ASSERT_TRUE(signedArea(fixed.data(), count) > 0.0);
+        // Points well clear of every edge between grid vertices
+        for (int lat = -1; lat <= 9; lat++) {
+            for (int lon = -1; lon <= 9; lon++) {
+                GeoPoint point = {lat + 0.31f, lon + 0.43f};
+                TEST_ASSERT_EQUAL(pointInPolygon(point, ring.data(), ring.size()),
+                                  pointInPolygon(point, fixed.data(), count));
+            }
+        }
+    }
+    TEST_ASSERT_TRUE(repaired > 100);
+}
+
+void test_verdict_names(void) {
+    TEST_ASSERT_EQUAL_STRING("clean", fenceVerdictName(FenceVerdict::CLEAN));
+    TEST_ASSERT_EQUAL_STRING("self-intersecting", fenceVerdictName(FenceVerdict::SELF_INTERSECTING));
+    TEST_ASSERT_FALSE(fenceVerdictUsable(FenceVerdict::UNCHECKED));
+    TEST_ASSERT_FALSE(fenceVerdictUsable(FenceVerdict::NO_MEMORY));
+}
+
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Verdict tests
+    RUN_TEST(test_clean_square);
+    RUN_TEST(test_too_few_and_too_many);
+    RUN_TEST(test_bad_coordinates);
+    RUN_TEST(test_zero_area);
+    RUN_TEST(test_self_intersecting);
+
+    // Repair tests
+    RUN_TEST(test_repair_drops_and_reverses);
+    RUN_TEST(test_repair_leaves_unusable_fence);
+
+    // Sweep line tests
+    RUN_TEST(test_comb_is_simple);
+    RUN_TEST(test_matches_brute_force);
+    RUN_TEST(test_repair_keeps_containment);
+    RUN_TEST(test_verdict_names);
+
+    return UNITY_END();
+}
@@ -0,0 +1,195 @@
+/**
+ * @file test_fix_policy.cpp
+ * @brief Unit tests for the fix_policy acquisition policy.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "fix_policy.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+FixPolicyState state;
+
+// 4 m range error; 5..40 m acceptable error at 25% of the fence distance
+const FixPolicyConfig config = DEFAULT_FIX_POLICY_CONFIG;
+
+// ============================================================================
+// Quality Tests
+// ============================================================================
+
+void test_needs_minimum_satellites(void) {
+    TEST_ASSERT_FALSE(fixPolicyAccept(config, 0.8f, config.minSatellites - 1, 1000.0f));
+    TEST_ASSERT_TRUE(fixPolicyAccept(config, 0.8f, config.minSatellites, 1000.0f));
+}
+
+void test_missing_hdop_is_rejected(void) {
+    TEST_ASSERT_FALSE(fixPolicyAccept(config, 0.0f, 10, 1000.0f));
+}
+
+void test_near_fence_needs_good_hdop(void) {
+    // At the fence line: 5 m -> HDOP 1.25
+    TEST_ASSERT_TRUE(fixPolicyAccept(config, 1.2f, 8, 0.0f));
+    TEST_ASSERT_FALSE(fixPolicyAccept(config, 1.5f, 8, 0.0f));
+    TEST_ASSERT_FALSE(fixPolicyAccept(config, 1.5f, 8, -10.0f));
+}
+
+void test_far_from_fence_accepts_rough_fix(void) {
+    // 100 m away: 25 m -> HDOP 6.25; capped at 40 m -> HDOP 10
+    TEST_ASSERT_TRUE(fixPolicyAccept(config, 6.0f, 5, 100.0f));
+    TEST_ASSERT_FALSE(fixPolicyAccept(config, 7.0f, 5, 100.0f));
+    TEST_ASSERT_TRUE(fixPolicyAccept(config, 9.9f, 5, 5000.0f));
+    TEST_ASSERT_FALSE(fixPolicyAccept(config, 10.5f, 5, 5000.0f));
+}
+
+// ============================================================================
+// Timeout Tests
+// ============================================================================
+
+void test_initial_timeout_without_history(void) {
+    TEST_ASSERT_EQUAL_UINT32(config.initialTimeoutMs, fixPolicyTimeoutMs(state, config));
+}
+
+void test_timeout_learned_from_slowest_recent_fix(void) {
+    fixPolicyRecordSuccess(state, 900);
+    fixPolicyRecordSuccess(state, 1600);
+    fixPolicyRecordSuccess(state, 1100);
+    TEST_ASSERT_EQUAL_UINT32(2400, fixPolicyTimeoutMs(state, config));
+}
+
+void test_timeout_is_clamped(void) {
+    fixPolicyRecordSuccess(state, 200);
+    TEST_ASSERT_EQUAL_UINT32(config.minTimeoutMs, fixPolicyTimeoutMs(state, config));
+
+    fixPolicyRecordSuccess(state, 60000);
+    TEST_ASSERT_EQUAL_UINT32(config.maxTimeoutMs, fixPolicyTimeoutMs(state, config));
+}
+
+void test_old_fix_times_age_out(void) {
+    fixPolicyRecordSuccess(state, 6000);
+    for (size_t i = 0; i < FIX_POLICY_HISTORY; i++) {
+        fixPolicyRecordSuccess(state, 1000);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1500, fixPolicyTimeoutMs(state, config));
+}
+
+void test_search_learns_time_to_first_fix(void) {
+    // First fix after 800 ms, a good one after 1500 ms
+    FixSearch search = {};
+    TEST_ASSERT_FALSE(fixPolicySearchAddFix(search, config, 800, 2.0f, 8, 0.0f));
+    TEST_ASSERT_TRUE(fixPolicySearchAddFix(search, config, 1500, 1.0f, 8, 0.0f));
+    fixPolicyRecordSearch(state, config, search);
+    TEST_ASSERT_EQUAL_UINT32(1200, fixPolicyTimeoutMs(state, config));
+}
+
+void test_rough_fixes_do_not_grow_timeout(void) {
+    // Tree cover at the fence line: fixes arrive but never reach HDOP 1.25
+    for (int wake = 0; wake < 20; wake++) {
+        uint32_t timeoutMs = fixPolicyTimeoutMs(state, config);
+        FixSearch search = {};
+        for (uint32_t elapsedMs = 900; elapsedMs < timeoutMs; elapsedMs += 1000) {
+            TEST_ASSERT_FALSE(fixPolicySearchAddFix(search, config, elapsedMs, 2.5f, 6, 0.0f));
+        }
+        TEST_ASSERT_FALSE(search.accepted);
+        fixPolicyRecordSearch(state, config, search);
+        TEST_ASSERT_TRUE(fixPolicyTimeoutMs(state, config) <= timeoutMs);
+    }
+    // 900 ms to first fix plus 50%, not the maximum
+    TEST_ASSERT_EQUAL_UINT32(1350, fixPolicyTimeoutMs(state, config));
+}
+
+void test_search_without_fix_is_a_failure(void) {
+    FixSearch search = {};
+    fixPolicyRecordSearch(state, config, search);
+    TEST_ASSERT_EQUAL_UINT8(1, state.failures);
+    TEST_ASSERT_EQUAL_UINT32(config.maxTimeoutMs, fixPolicyTimeoutMs(state, config));
+}
+
+// ============================================================================
+// Backoff Tests
+// ============================================================================
+
+static uint32_t skippedBeforeNextAttempt(void) {
+    uint32_t skipped = 0;
+    while (!fixPolicyShouldAttempt(state)) {
+        skipped++;
+    }
+    return skipped;
+}
+
+void test_backoff_grows_exponentially_and_caps(void) {
+    const uint32_t expected[] = {0, 1, 3, 7, 11, 11};
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        fixPolicyRecordFailure(state, config);
+        TEST_ASSERT_EQUAL_UINT32(expected[i], skippedBeforeNextAttempt());
+    }
+}
+
+void test_retry_after_failure_uses_longest_timeout(void) {
+    fixPolicyRecordSuccess(state, 1000);
+    fixPolicyRecordFailure(state, config);
+    TEST_ASSERT_EQUAL_UINT32(config.maxTimeoutMs, fixPolicyTimeoutMs(state, config));
+}
+
+void test_success_resets_backoff(void) {
+    for (int i = 0; i < 4; i++) {
+        fixPolicyRecordFailure(state, config);
+    }
+    fixPolicyRecordSuccess(state, 1000);
+    TEST_ASSERT_TRUE(fixPolicyShouldAttempt(state));
+    TEST_ASSERT_EQUAL_UINT8(0, state.failures);
+    TEST_ASSERT_EQUAL_UINT32(1500, fixPolicyTimeoutMs(state, config));
+}
+
+void test_many_failures_do_not_overflow(void) {
+    for (int i = 0; i < 300; i++) {
+        fixPolicyRecordFailure(state, config);
+    }
+    TEST_ASSERT_EQUAL_UINT8(255, state.failures);
+    TEST_ASSERT_EQUAL_UINT8(config.maxBackoffWakes, state.backoffWakes);
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    memset(&state, 0, sizeof(state));
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Quality tests
+    RUN_TEST(test_needs_minimum_satellites);
+    RUN_TEST(test_missing_hdop_is_rejected);
+    RUN_TEST(test_near_fence_needs_good_hdop);
+    RUN_TEST(test_far_from_fence_accepts_rough_fix);
+
+    // Timeout tests
+    RUN_TEST(test_initial_timeout_without_history);
+    RUN_TEST(test_timeout_learned_from_slowest_recent_fix);
+    RUN_TEST(test_timeout_is_clamped);
+    RUN_TEST(test_old_fix_times_age_out);
+    RUN_TEST(test_search_learns_time_to_first_fix);
+    RUN_TEST(test_rough_fixes_do_not_grow_timeout);
+    RUN_TEST(test_search_without_fix_is_a_failure);
+
+    // Backoff tests
+    RUN_TEST(test_backoff_grows_exponentially_and_caps);
+    RUN_TEST(test_retry_after_failure_uses_longest_timeout);
+    RUN_TEST(test_success_resets_backoff);
+    RUN_TEST(test_many_failures_do_not_overflow);
+
+    return UNITY_END();
+}
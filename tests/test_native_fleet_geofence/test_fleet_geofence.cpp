@@ -0,0 +1,283 @@
+/**
+ * @file test_fleet_geofence.cpp
+ * @brief Unit and thread tests for the base-station fleet geofence service.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "fleet_geofence.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+static const GeoPoint HOME[] = {{40.0f, -74.0f}, {40.0f, -73.99f}, {40.01f, -73.99f}, {40.01f, -74.0f}};
+static const GeoPoint INSIDE_HOME = {40.005f, -73.995f};
+static const GeoPoint OUTSIDE_HOME = {40.02f, -73.995f};
+
+static uint32_t nextRandom(uint32_t& seed) {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+static float randomRange(uint32_t& seed, float low, float high) {
+    return low + (high - low) * static_cast<float>(nextRandom(seed) % 100000) / 100000.0f;
+}
+
+// Triangles and quads of 50-500 m scattered over a 0.5 x 0.5 degree area
+static std::vector<FleetFence> makeFences(size_t count, uint32_t seed) {
+    std::vector<FleetFence> fences;
+    for (size_t i = 0; i < count; i++) {
+        float lat = randomRange(seed, 40.0f, 40.5f);
+        float lon = randomRange(seed, -74.5f, -74.0f);
+        float size = randomRange(seed, 0.0005f, 0.005f);
+        FleetFence fence = {static_cast<uint32_t>(i + 1), static_cast<uint32_t>(i / 3), {}};
+        fence.vertices.push_back({lat, lon});
+        fence.vertices.push_back({lat + size * 0.3f, lon + size});
+        fence.vertices.push_back({lat + size, lon + size * 0.6f});
+        if (i % 2 == 0) {
+            fence.vertices.push_back({lat + size * 0.7f, lon - size * 0.2f});
+        }
+        fences.push_back(fence);
+    }
+    return fences;
+}
+
+// ============================================================================
+// Index Tests
+// ============================================================================
+
+void test_empty_index(void) {
+    FleetFenceIndex index((std::vector<FleetFence>()));
+    const FleetFence* hits[4];
+    TEST_ASSERT_EQUAL_UINT(0, index.query(INSIDE_HOME, hits, 4));
+    TEST_ASSERT_EQUAL_UINT(0, index.depth());
+    TEST_ASSERT_FALSE(index.check(1, INSIDE_HOME).hasFences);
+}
+
+void test_single_fence(void) {
+    std::vector<FleetFence> fences(1);
+    fences[0] = {7, 1, std::vector<GeoPoint>(HOME, HOME + 4)};
+    FleetFenceIndex index(fences);
+    const FleetFence* hits[4];
+
+    TEST_ASSERT_EQUAL_UINT(1, index.depth());
+    TEST_ASSERT_EQUAL_UINT(1, index.query(INSIDE_HOME, hits, 4));
+    TEST_ASSERT_EQUAL_UINT32(7, hits[0]->id);
+    TEST_ASSERT_EQUAL_UINT(0, index.query(OUTSIDE_HOME, hits, 4));
+    TEST_ASSERT_NOT_NULL(index.find(7));
+    TEST_ASSERT_NULL(index.find(8));
+}
+
+// Every query answers exactly what testing every fence would
+void test_index_matches_linear_scan(void) {
+    std::vector<FleetFence> fences = makeFences(3000, 42);
+    std::vector<Polygon> polygons;
+    for (const FleetFence& fence : fences) {
+        polygons.push_back(Polygon(fence.vertices.data(), fence.vertices.size()));
+    }
+    FleetFenceIndex index(fences);
+    TEST_ASSERT_EQUAL_UINT(3000, index.fenceCount());
+    TEST_ASSERT_EQUAL_UINT(3, index.depth());   // 188 leaves, 12 nodes, root
+
+    uint32_t seed = 7;
+    size_t totalHits = 0;
+    for (int i = 0; i < 5000; i++) {
+        GeoPoint point = {randomRange(seed, 39.99f, 40.51f), randomRange(seed, -74.51f, -73.99f)};
+
+        std::vector<uint32_t> expected;
+        for (size_t f = 0; f < fences.size(); f++) {
+            if (polygons[f].contains(point)) {
+                expected.push_back(fences[f].id);
+            }
+        }
+
+        const FleetFence* hits[64];
+        size_t count = index.query(point, hits, 64);
+        std::vector<uint32_t> actual;
+        for (size_t h = 0; h < count; h++) {
+            actual.push_back(hits[h]->id);
+        }
+        std::sort(actual.begin(), actual.end());
+
+        TEST_ASSERT_EQUAL_UINT(expected.size(), actual.size());
+        TEST_ASSERT_TRUE(expected == actual);
+        totalHits += count;
+    }
+    TEST_ASSERT_TRUE(totalHits > 20);
+}
+
+void test_query_stops_at_max_hits(void) {
+    std::vector<FleetFence> fences;
+    for (uint32_t id = 1; id <= 5; id++) {
+        fences.push_back({id, id, std::vector<GeoPoint>(HOME, HOME + 4)});
+    }
+    FleetFenceIndex index(fences);
+    const FleetFence* hits[5];
+    TEST_ASSERT_EQUAL_UINT(5, index.query(INSIDE_HOME, hits, 5));
+    TEST_ASSERT_EQUAL_UINT(2, index.query(INSIDE_HOME, hits, 2));
+}
+
+// A neighbour's overlapping fence does not count for this household
+void test_check_only_uses_own_household(void) {
+    static const GeoPoint NEIGHBOUR[] = {{40.005f, -73.995f}, {40.005f, -73.98f},
+                                         {40.03f, -73.98f}, {40.03f, -73.995f}};
+    std::vector<FleetFence> fences;
+    fences.push_back({1, 10, std::vector<GeoPoint>(HOME, HOME + 4)});
+    fences.push_back({2, 20, std::vector<GeoPoint>(NEIGHBOUR, NEIGHBOUR + 4)});
+    FleetFenceIndex index(fences);
+
+    FleetCheck check = index.check(10, INSIDE_HOME);
+    TEST_ASSERT_TRUE(check.hasFences);
+    TEST_ASSERT_TRUE(check.inside);
+    TEST_ASSERT_EQUAL_UINT32(1, check.fenceId);
+
+    check = index.check(10, OUTSIDE_HOME);   // Inside the neighbour's only
+    TEST_ASSERT_TRUE(check.hasFences);
+    TEST_ASSERT_FALSE(check.inside);
+
+    check = index.check(20, OUTSIDE_HOME);
+    TEST_ASSERT_TRUE(check.inside);
+    TEST_ASSERT_EQUAL_UINT32(2, check.fenceId);
+
+    TEST_ASSERT_FALSE(index.check(30, INSIDE_HOME).hasFences);
+}
+
+// ============================================================================
+// Service Tests
+// ============================================================================
+
+void test_upsert_and_remove(void) {
+    FleetGeofence service;
+    TEST_ASSERT_TRUE(service.upsertFence(1, 10, HOME, 4));
+    TEST_ASSERT_TRUE(service.check(10, INSIDE_HOME).inside);
+    TEST_ASSERT_EQUAL_UINT32(1, service.version());
+
+    // Replacing fence 1 moves it away from the fix
+    static const GeoPoint MOVED[] = {{41.0f, -74.0f}, {41.0f, -73.99f}, {41.01f, -73.99f}};
+    TEST_ASSERT_TRUE(service.upsertFence(1, 10, MOVED, 3));
+    TEST_ASSERT_EQUAL_UINT(1, service.snapshot()->fenceCount());
+    TEST_ASSERT_FALSE(service.check(10, INSIDE_HOME).inside);
+
+    TEST_ASSERT_TRUE(service.upsertFence(2, 10, HOME, 4));
+    TEST_ASSERT_TRUE(service.upsertFence(3, 11, HOME, 4));
+    TEST_ASSERT_TRUE(service.removeFence(2));
+    TEST_ASSERT_FALSE(service.removeFence(2));
+    TEST_ASSERT_FALSE(service.check(10, INSIDE_HOME).inside);
+
+    TEST_ASSERT_EQUAL_UINT(1, service.removeHousehold(10));
+    TEST_ASSERT_EQUAL_UINT(0, service.removeHousehold(10));
+    TEST_ASSERT_FALSE(service.check(10, INSIDE_HOME).hasFences);
+    TEST_ASSERT_TRUE(service.check(11, INSIDE_HOME).inside);
+    TEST_ASSERT_EQUAL_UINT32(6, service.version());
+}
+
+void test_invalid_fences_rejected(void) {
+    FleetGeofence service;
+    static const GeoPoint BAD[] = {{40.0f, -74.0f}, {95.0f, -73.99f}, {40.01f, -73.99f}};
+    TEST_ASSERT_FALSE(service.upsertFence(1, 1, HOME, 2));
+    TEST_ASSERT_FALSE(service.upsertFence(1, 1, nullptr, 4));
+    TEST_ASSERT_FALSE(service.upsertFence(1, 1, BAD, 3));
+
+    std::vector<FleetFence> duplicates;
+    duplicates.push_back({1, 1, std::vector<GeoPoint>(HOME, HOME + 4)});
+    duplicates.push_back({1, 2, std::vector<GeoPoint>(HOME, HOME + 4)});
+    TEST_ASSERT_FALSE(service.loadFences(duplicates));
+    TEST_ASSERT_EQUAL_UINT32(0, service.version());
+
+    TEST_ASSERT_TRUE(service.loadFences(makeFences(100, 1)));
+    TEST_ASSERT_EQUAL_UINT(100, service.snapshot()->fenceCount());
+}
+
+// A snapshot keeps answering for the fence set it was taken from
+void test_snapshot_outlives_update(void) {
+    FleetGeofence service;
+    service.upsertFence(1, 10, HOME, 4);
+    std::shared_ptr<const FleetFenceIndex> before = service.snapshot();
+
+    service.removeFence(1);
+    TEST_ASSERT_FALSE(service.check(10, INSIDE_HOME).inside);
+    TEST_ASSERT_TRUE(before->check(10, INSIDE_HOME).inside);
+}
+
+// Readers never block and never see a half-built index while a writer
+// keeps changing other households' fences
+void test_concurrent_readers_during_updates(void) {
+    FleetGeofence service;
+    service.loadFences(makeFences(2000, 3));
+    service.upsertFence(100000, 99999, HOME, 4);
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> wrongAnswers(0);
+    std::atomic<long> queries(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                FleetCheck inside = service.check(99999, INSIDE_HOME);
+                FleetCheck outside = service.check(99999, OUTSIDE_HOME);
+                if (!inside.inside || inside.fenceId != 100000 || outside.inside) {
+                    wrongAnswers++;
+                }
+                queries++;
+            }
+        });
+    }
+
+    std::vector<FleetFence> extra = makeFences(200, 9);
+    for (size_t i = 0; i < extra.size(); i++) {
+        const FleetFence& fence = extra[i];
+        service.upsertFence(fence.id + 50000, fence.household + 50000,
+                            fence.vertices.data(), fence.vertices.size());
+        if (i % 2 == 1) {
+            service.removeFence(fence.id + 50000 - 1);
+        }
+    }
+    stop = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, wrongAnswers.load());
+    TEST_ASSERT_TRUE(queries.load() > 0);
+    TEST_ASSERT_EQUAL_UINT(2001 + 100, service.snapshot()->fenceCount());
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Index tests
+    RUN_TEST(test_empty_index);
+    RUN_TEST(test_single_fence);
+    RUN_TEST(test_index_matches_linear_scan);
+    RUN_TEST(test_query_stops_at_max_hits);
+    RUN_TEST(test_check_only_uses_own_household);
+
+    // Service tests
+    RUN_TEST(test_upsert_and_remove);
+    RUN_TEST(test_invalid_fences_rejected);
+    RUN_TEST(test_snapshot_outlives_update);
+    RUN_TEST(test_concurrent_readers_during_updates);
+
+    return UNITY_END();
+}
@@ -0,0 +1,97 @@
+/**
+ * @file test_gps_burst.cpp
+ * @brief Unit tests for the gps_burst mode decision.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "gps_burst.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+GpsBurstState state;
+
+// Enter within 8 m, exit beyond 15 m, 120 s cap, 60 s cooldown
+const GpsBurstConfig config = DEFAULT_GPS_BURST_CONFIG;
+
+// ============================================================================
+// Mode Tests
+// ============================================================================
+
+void test_far_from_fence_stays_normal(void) {
+    TEST_ASSERT_FALSE(gpsBurstUpdate(state, config, 50.0f, 100));
+    TEST_ASSERT_FALSE(gpsBurstUpdate(state, config, -50.0f, 105));
+    TEST_ASSERT_EQUAL_UINT8(config.normalRateHz, gpsBurstRateHz(state, config));
+}
+
+void test_near_fence_starts_burst_on_either_side(void) {
+    TEST_ASSERT_TRUE(gpsBurstUpdate(state, config, 5.0f, 100));
+    TEST_ASSERT_EQUAL_UINT8(config.burstRateHz, gpsBurstRateHz(state, config));
+
+    memset(&state, 0, sizeof(state));
+    TEST_ASSERT_TRUE(gpsBurstUpdate(state, config, -3.0f, 100));
+}
+
+void test_hysteresis_between_enter_and_exit(void) {
+    TEST_ASSERT_FALSE(gpsBurstUpdate(state, config, 10.0f, 100));
+    TEST_ASSERT_TRUE(gpsBurstUpdate(state, config, 7.0f, 101));
+    TEST_ASSERT_TRUE(gpsBurstUpdate(state, config, 12.0f, 102));
+    TEST_ASSERT_TRUE(gpsBurstUpdate(state, config, -14.0f, 103));
+    TEST_ASSERT_FALSE(gpsBurstUpdate(state, config, 15.0f, 104));
+    TEST_ASSERT_FALSE(gpsBurstUpdate(state, config, 12.0f, 105));
+}
+
+void test_burst_is_capped_then_cools_down(void) {
+    TEST_ASSERT_TRUE(gpsBurstUpdate(state, config, 1.0f, 1000));
+    TEST_ASSERT_TRUE(gpsBurstUpdate(state, config, 1.0f, 1000 + config.maxBurstSec - 1));
+    TEST_ASSERT_FALSE(gpsBurstUpdate(state, config, 1.0f, 1000 + config.maxBurstSec));
+
+    uint32_t capped = 1000 + config.maxBurstSec;
+    TEST_ASSERT_FALSE(gpsBurstUpdate(state, config, 1.0f, capped + config.cooldownSec - 1));
+    TEST_ASSERT_TRUE(gpsBurstUpdate(state, config, 1.0f, capped + config.cooldownSec));
+}
+
+void test_clean_exit_has_no_cooldown(void) {
+    TEST_ASSERT_TRUE(gpsBurstUpdate(state, config, 1.0f, 1000));
+    TEST_ASSERT_FALSE(gpsBurstUpdate(state, config, 20.0f, 1010));
+    TEST_ASSERT_TRUE(gpsBurstUpdate(state, config, 1.0f, 1011));
+}
+
+void test_abort_ends_burst_without_cooldown(void) {
+    TEST_ASSERT_TRUE(gpsBurstUpdate(state, config, 1.0f, 1000));
+    gpsBurstAbort(state);
+    TEST_ASSERT_EQUAL_UINT8(config.normalRateHz, gpsBurstRateHz(state, config));
+    TEST_ASSERT_TRUE(gpsBurstUpdate(state, config, 1.0f, 1001));
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    memset(&state, 0, sizeof(state));
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Mode tests
+    RUN_TEST(test_far_from_fence_stays_normal);
+    RUN_TEST(test_near_fence_starts_burst_on_either_side);
+    RUN_TEST(test_hysteresis_between_enter_and_exit);
+    RUN_TEST(test_burst_is_capped_then_cools_down);
+    RUN_TEST(test_clean_exit_has_no_cooldown);
+    RUN_TEST(test_abort_ends_burst_without_cooldown);
+
+    return UNITY_END();
+}
@@ -0,0 +1,160 @@
+/**
+ * @file test_gps_config.cpp
+ * @brief Unit tests for GPS settings tracking and PMTK sentences.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "gps_config.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+GpsConfigState state;
+
+const GpsSettings RMC_GGA_1HZ = {GPS_NMEA_RMC | GPS_NMEA_GGA, 1000};
+const GpsSettings RMC_GGA_5HZ = {GPS_NMEA_RMC | GPS_NMEA_GGA, 200};
+
+// ============================================================================
+// Settings Tracking Tests
+// ============================================================================
+
+void test_zero_state_needs_everything(void) {
+    TEST_ASSERT_EQUAL_UINT8(GPS_CONFIG_ALL, gpsConfigPending(state, RMC_GGA_1HZ));
+}
+
+void test_applied_settings_are_not_resent(void) {
+    gpsConfigApplied(state, GPS_CONFIG_OUTPUT, RMC_GGA_1HZ);
+    TEST_ASSERT_EQUAL_UINT8(GPS_CONFIG_RATE, gpsConfigPending(state, RMC_GGA_1HZ));
+
+    gpsConfigApplied(state, GPS_CONFIG_RATE, RMC_GGA_1HZ);
+    TEST_ASSERT_EQUAL_UINT8(0, gpsConfigPending(state, RMC_GGA_1HZ));
+}
+
+void test_only_changed_setting_is_pending(void) {
+    gpsConfigApplied(state, GPS_CONFIG_ALL, RMC_GGA_1HZ);
+    TEST_ASSERT_EQUAL_UINT8(GPS_CONFIG_RATE, gpsConfigPending(state, RMC_GGA_5HZ));
+
+    GpsSettings rmcOnly = {GPS_NMEA_RMC, 1000};
+    TEST_ASSERT_EQUAL_UINT8(GPS_CONFIG_OUTPUT, gpsConfigPending(state, rmcOnly));
+}
+
+void test_invalidate_and_corrupt_state(void) {
+    gpsConfigApplied(state, GPS_CONFIG_ALL, RMC_GGA_1HZ);
+    gpsConfigInvalidate(state);
+    TEST_ASSERT_EQUAL_UINT8(GPS_CONFIG_ALL, gpsConfigPending(state, RMC_GGA_1HZ));
+
+    // Undefined RTC memory after power-on
+    memset(&state, 0x5A, sizeof(state));
+    TEST_ASSERT_EQUAL_UINT8(GPS_CONFIG_ALL, gpsConfigPending(state, RMC_GGA_1HZ));
+    gpsConfigApplied(state, GPS_CONFIG_RATE, RMC_GGA_1HZ);
+    TEST_ASSERT_EQUAL_UINT8(GPS_CONFIG_OUTPUT, gpsConfigPending(state, RMC_GGA_1HZ));
+}
+
+// ============================================================================
+// Sentence Tests
+// ============================================================================
+
+void test_commands_match_known_sentences(void) {
+    char out[GPS_CONFIG_MAX_COMMAND];
+
+    // Same sentences as Adafruit_GPS's PMTK_SET_NMEA_* constants
+    TEST_ASSERT_TRUE(gpsConfigCommand(GPS_CONFIG_OUTPUT, RMC_GGA_1HZ, out, sizeof(out)) > 0);
+    TEST_ASSERT_EQUAL_STRING("$PMTK314,0,1,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0*28", out);
+
+    GpsSettings rmcOnly = {GPS_NMEA_RMC, 1000};
+    gpsConfigCommand(GPS_CONFIG_OUTPUT, rmcOnly, out, sizeof(out));
+    TEST_ASSERT_EQUAL_STRING("$PMTK314,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0*29", out);
+
+    gpsConfigCommand(GPS_CONFIG_RATE, RMC_GGA_1HZ, out, sizeof(out));
+    TEST_ASSERT_EQUAL_STRING("$PMTK220,1000*1F", out);
+
+    gpsConfigCommand(GPS_CONFIG_RATE, RMC_GGA_5HZ, out, sizeof(out));
+    TEST_ASSERT_EQUAL_STRING("$PMTK220,200*2C", out);
+}
+
+void test_command_ids_and_unknown_item(void) {
+    char out[GPS_CONFIG_MAX_COMMAND];
+    TEST_ASSERT_EQUAL_UINT16(314, gpsConfigCommandId(GPS_CONFIG_OUTPUT));
+    TEST_ASSERT_EQUAL_UINT16(220, gpsConfigCommandId(GPS_CONFIG_RATE));
+    TEST_ASSERT_EQUAL_UINT16(0, gpsConfigCommandId(GPS_CONFIG_ALL));
+    TEST_ASSERT_EQUAL_UINT(0, gpsConfigCommand(GPS_CONFIG_ALL, RMC_GGA_1HZ, out, sizeof(out)));
+}
+
+void test_format_rejects_small_buffer(void) {
+    char out[17];
+    TEST_ASSERT_EQUAL_UINT(0, pmtkFormat("PMTK220,1000", out, sizeof(out) - 1));
+    TEST_ASSERT_EQUAL_UINT(16, pmtkFormat("PMTK220,1000", out, sizeof(out)));
+}
+
+// ============================================================================
+// ACK Tests
+// ============================================================================
+
+void test_parse_ack_flags(void) {
+    char ack[GPS_CONFIG_MAX_COMMAND];
+    pmtkFormat("PMTK001,220,3", ack, sizeof(ack));
+    TEST_ASSERT_TRUE(pmtkParseAck(ack, 220) == PmtkAck::SUCCESS);
+
+    pmtkFormat("PMTK001,314,2", ack, sizeof(ack));
+    TEST_ASSERT_TRUE(pmtkParseAck(ack, 314) == PmtkAck::FAILED);
+
+    pmtkFormat("PMTK001,314,1", ack, sizeof(ack));
+    TEST_ASSERT_TRUE(pmtkParseAck(ack, 314) == PmtkAck::UNSUPPORTED);
+
+    pmtkFormat("PMTK001,314,0", ack, sizeof(ack));
+    TEST_ASSERT_TRUE(pmtkParseAck(ack, 314) == PmtkAck::INVALID);
+}
+
+void test_parse_ack_ignores_other_sentences(void) {
+    TEST_ASSERT_TRUE(pmtkParseAck("$PMTK001,220,3*30", 314) == PmtkAck::NONE);
+    TEST_ASSERT_TRUE(pmtkParseAck("$PMTK001,2200,3*00", 220) == PmtkAck::NONE);
+    TEST_ASSERT_TRUE(pmtkParseAck("$GPRMC,,V,,,,,,,,,,N*53", 220) == PmtkAck::NONE);
+    TEST_ASSERT_TRUE(pmtkParseAck(nullptr, 220) == PmtkAck::NONE);
+}
+
+void test_parse_ack_checks_checksum(void) {
+    TEST_ASSERT_TRUE(pmtkParseAck("$PMTK001,220,3*30", 220) == PmtkAck::SUCCESS);
+    TEST_ASSERT_TRUE(pmtkParseAck("$PMTK001,220,3*31", 220) == PmtkAck::NONE);
+    TEST_ASSERT_TRUE(pmtkParseAck("$PMTK001,220,3", 220) == PmtkAck::NONE);
+    TEST_ASSERT_TRUE(pmtkParseAck("\n$PMTK001,220,3*30\r", 220) == PmtkAck::SUCCESS);
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    memset(&state, 0, sizeof(state));
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Settings tracking tests
+    RUN_TEST(test_zero_state_needs_everything);
+    RUN_TEST(test_applied_settings_are_not_resent);
+    RUN_TEST(test_only_changed_setting_is_pending);
+    RUN_TEST(test_invalidate_and_corrupt_state);
+
+    // Sentence tests
+    RUN_TEST(test_commands_match_known_sentences);
+    RUN_TEST(test_command_ids_and_unknown_item);
+    RUN_TEST(test_format_rejects_small_buffer);
+
+    // ACK tests
+    RUN_TEST(test_parse_ack_flags);
+    RUN_TEST(test_parse_ack_ignores_other_sentences);
+    RUN_TEST(test_parse_ack_checks_checksum);
+
+    return UNITY_END();
+}
@@ -0,0 +1,180 @@
+/**
+ * @file test_motion_gate.cpp
+ * @brief Unit tests for the motion_gate library, driven by recorded IMU traces.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "motion_gate.h"
+
+// ============================================================================
+// Recorded Traces (ICM-20948, +-2 g, 100 Hz, mg)
+// ============================================================================
+
+// Asleep on the lawn: gravity on Z plus sensor noise
+const MotionSample TRACE_ASLEEP[] = {
+    {18, -32, 997}, {18, -38, 997}, {24, -33, 1002}, {20, -33, 998},
+    {13, -31, 1000}, {21, -41, 991}, {16, -36, 999}, {19, -32, 995},
+    {21, -33, 995}, {26, -32, 1002}, {17, -37, 996}, {19, -32, 998},
+    {18, -38, 995}, {24, -38, 998}, {21, -40, 998}, {25, -43, 996},
+};
+
+// Trotting: ~2 Hz gait
+const MotionSample TRACE_TROTTING[] = {
+    {59, -7, 1136}, {93, 4, 1173}, {131, 25, 1209}, {162, 17, 1222},
+    {194, 0, 1251}, {211, -23, 1270}, {252, -58, 1278}, {268, -70, 1300},
+    {274, -130, 1302}, {296, -159, 1303}, {318, -185, 1291}, {320, -207, 1280},
+    {323, -236, 1249}, {324, -248, 1238}, {298, -263, 1213}, {287, -256, 1182},
+};
+
+// Slow roll onto the side while asleep
+const MotionSample TRACE_ROLL_OVER[] = {
+    {-5, 6, 1002}, {34, 1, 1001}, {70, 4, 994}, {102, 4, 994},
+    {135, 3, 996}, {171, -5, 984}, {207, -1, 983}, {237, 5, 965},
+    {272, 2, 965}, {312, 1, 951}, {342, 2, 938}, {375, 2, 927},
+    {409, 2, 921}, {439, -1, 897}, {469, 3, 881}, {501, 7, 855},
+};
+
+#define TRACE_LEN(t) (sizeof(t) / sizeof((t)[0]))
+
+MotionGateState state;
+const MotionGateConfig config = DEFAULT_MOTION_GATE_CONFIG;
+
+// Collar has been running a while and just took a fix
+static const uint32_t T0 = 10000;
+
+static void startWithFix(void) {
+    motionGateFixAcquired(state, T0);
+}
+
+// ============================================================================
+// Decision Tests
+// ============================================================================
+
+void test_first_wake_acquires(void) {
+    TEST_ASSERT_TRUE(motionGateDecide(state, config, T0) == MotionGateDecision::ACQUIRE);
+}
+
+void test_asleep_reuses_position(void) {
+    startWithFix();
+    motionGateAddSamples(state, config, TRACE_ASLEEP, TRACE_LEN(TRACE_ASLEEP), T0 + 5);
+    TEST_ASSERT_EQUAL_UINT16(0, state.score);
+    TEST_ASSERT_TRUE(motionGateDecide(state, config, T0 + 5) == MotionGateDecision::REUSE);
+}
+
+void test_trotting_acquires(void) {
+    startWithFix();
+    motionGateAddSamples(state, config, TRACE_TROTTING, TRACE_LEN(TRACE_TROTTING), T0 + 5);
+    TEST_ASSERT_TRUE(state.score >= config.movingScore);
+    TEST_ASSERT_TRUE(motionGateDecide(state, config, T0 + 5) == MotionGateDecision::ACQUIRE);
+}
+
+void test_roll_over_is_not_moving(void) {
+    startWithFix();
+    motionGateAddSamples(state, config, TRACE_ROLL_OVER, TRACE_LEN(TRACE_ROLL_OVER), T0 + 5);
+    TEST_ASSERT_TRUE(state.score < config.movingScore);
+    TEST_ASSERT_TRUE(motionGateDecide(state, config, T0 + 5) == MotionGateDecision::REUSE);
+}
+
+void test_motion_interrupt_acquires(void) {
+    startWithFix();
+    motionGateAddEvent(state, config, T0 + 5);
+    TEST_ASSERT_TRUE(motionGateDecide(state, config, T0 + 5) == MotionGateDecision::ACQUIRE);
+}
+
+void test_settles_after_dwell(void) {
+    startWithFix();
+    motionGateAddSamples(state, config, TRACE_TROTTING, TRACE_LEN(TRACE_TROTTING), T0);
+
+    // Lying down again: still acquiring until the dwell time has passed
+    uint32_t t = T0 + 5;
+    for (; t < T0 + config.stillDwellSec; t += 5) {
+        motionGateAddSamples(state, config, TRACE_ASLEEP, TRACE_LEN(TRACE_ASLEEP), t);
+        TEST_ASSERT_TRUE(motionGateDecide(state, config, t) == MotionGateDecision::ACQUIRE);
+        motionGateFixAcquired(state, t);
+    }
+
+    motionGateAddSamples(state, config, TRACE_ASLEEP, TRACE_LEN(TRACE_ASLEEP), t);
+    TEST_ASSERT_TRUE(motionGateDecide(state, config, t) == MotionGateDecision::REUSE);
+}
+
+void test_max_fix_age_forces_acquire(void) {
+    startWithFix();
+    TEST_ASSERT_TRUE(motionGateDecide(state, config, T0 + config.maxFixAgeSec - 1) ==
+                     MotionGateDecision::REUSE);
+    TEST_ASSERT_TRUE(motionGateDecide(state, config, T0 + config.maxFixAgeSec) ==
+                     MotionGateDecision::ACQUIRE);
+}
+
+// ============================================================================
+// Score Tests
+// ============================================================================
+
+void test_score_halves_per_half_life(void) {
+    startWithFix();
+    motionGateAddEvent(state, config, T0);
+    motionGateAddEvent(state, config, T0);
+    TEST_ASSERT_EQUAL_UINT16(200, state.score);
+
+    motionGateDecide(state, config, T0 + config.halfLifeSec - 1);
+    TEST_ASSERT_EQUAL_UINT16(200, state.score);
+    motionGateDecide(state, config, T0 + config.halfLifeSec);
+    TEST_ASSERT_EQUAL_UINT16(100, state.score);
+
+    // Partial half-lives accumulate across calls
+    motionGateDecide(state, config, T0 + config.halfLifeSec + config.halfLifeSec / 2);
+    motionGateDecide(state, config, T0 + 2 * config.halfLifeSec);
+    TEST_ASSERT_EQUAL_UINT16(50, state.score);
+
+    motionGateDecide(state, config, T0 + 100 * config.halfLifeSec);
+    TEST_ASSERT_EQUAL_UINT16(0, state.score);
+}
+
+void test_score_saturates(void) {
+    for (int i = 0; i < 1000; i++) {
+        motionGateAddEvent(state, config, T0);
+    }
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, state.score);
+}
+
+void test_short_trace_ignored(void) {
+    motionGateAddSamples(state, config, TRACE_TROTTING, 1, T0);
+    motionGateAddSamples(state, config, nullptr, 16, T0);
+    TEST_ASSERT_EQUAL_UINT16(0, state.score);
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    memset(&state, 0, sizeof(state));
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Decision tests
+    RUN_TEST(test_first_wake_acquires);
+    RUN_TEST(test_asleep_reuses_position);
+    RUN_TEST(test_trotting_acquires);
+    RUN_TEST(test_roll_over_is_not_moving);
+    RUN_TEST(test_motion_interrupt_acquires);
+    RUN_TEST(test_settles_after_dwell);
+    RUN_TEST(test_max_fix_age_forces_acquire);
+
+    // Score tests
+    RUN_TEST(test_score_halves_per_half_life);
+    RUN_TEST(test_score_saturates);
+    RUN_TEST(test_short_trace_ignored);
+
+    return UNITY_END();
+}
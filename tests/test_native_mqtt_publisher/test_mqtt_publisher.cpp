@@ -0,0 +1,319 @@
+/**
+ * @file test_mqtt_publisher.cpp
+ * @brief Unit tests for the base-station MQTT publishing stage.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <string>
+#include "mqtt_publisher.h"
+
+// ============================================================================
+// Allocation Counting
+// ============================================================================
+
+// Every allocation in the test binary goes through here. The set of
+// replacements is complete (arrays and sized delete included), so each
+// new is paired with a delete from the same set.
+static size_t allocations = 0;
+
+static void* countedAlloc(size_t size) {
+    allocations++;
+    void* p = malloc(size > 0 ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(size_t size) {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size) {
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+static MqttPublisherConfig config;
+static MemoryMqttBroker* broker;
+
+// Sink that keeps only counts, so it allocates nothing itself
+class CountingSink : public MqttSink {
+public:
+    uint32_t messages = 0;
+
+    bool publish(const char*, const char*, size_t, bool) override {
+        messages++;
+        return true;
+    }
+};
+
+// Broker that refuses the state topic only (e.g. an ACL or a full queue)
+class StateRefusingBroker : public MemoryMqttBroker {
+public:
+    bool refuseState = true;
+
+    bool publish(const char* topic, const char* payload, size_t length, bool retain) override {
+        size_t topicLength = strlen(topic);
+        if (refuseState && topicLength >= 6 && strcmp(topic + topicLength - 6, "/state") == 0) {
+            return false;
+        }
+        return MemoryMqttBroker::publish(topic, payload, length, retain);
+    }
+};
+
+// 0.0001 degrees of latitude is ~11 m
+static CollarUpdate collarAt(uint32_t id, int32_t latE6, PacketFenceState state = PacketFenceState::INSIDE,
+                             uint8_t battery = 15) {
+    CollarUpdate update = {id, {latE6, -74021160, 1000}, state, battery};
+    return update;
+}
+
+static const std::string* payload(const char* topic) {
+    return broker->lastPayload(topic);
+}
+
+// ============================================================================
+// Publishing Tests
+// ============================================================================
+
+void test_first_update_publishes_discovery_and_state(void) {
+    MqttPublisher publisher(*broker, config, 8);
+    TEST_ASSERT_TRUE(publisher.update(collarAt(12, 40722720), 0));
+    TEST_ASSERT_EQUAL_UINT(3, publisher.poll(0));
+
+    const std::string* discovery = payload("homeassistant/device_tracker/uncollar_12/config");
+    TEST_ASSERT_NOT_NULL(discovery);
+    TEST_ASSERT_TRUE(discovery->find("\"json_attributes_topic\":\"uncollar/12/attributes\"") != std::string::npos);
+    TEST_ASSERT_TRUE(discovery->find("\"state_topic\":\"uncollar/12/state\"") != std::string::npos);
+
+    TEST_ASSERT_EQUAL_STRING("home", payload("uncollar/12/state")->c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"latitude\":40.722720,\"longitude\":-74.021160,\"fence\":\"inside\","
+                             "\"battery_level\":100,\"fix_time\":1000}",
+                             payload("uncollar/12/attributes")->c_str());
+    TEST_ASSERT_EQUAL_UINT32(3, broker->retainedCount());
+    TEST_ASSERT_EQUAL_UINT(0, publisher.pendingCount());
+}
+
+void test_updates_coalesce_within_window(void) {
+    MqttPublisher publisher(*broker, config, 8);
+    publisher.update(collarAt(1, 40000000), 0);
+    publisher.poll(0);
+    uint32_t before = broker->messageCount();
+
+    // Walking north ~110 m per update, all within one window
+    for (uint32_t i = 1; i <= 5; i++) {
+        publisher.update(collarAt(1, 40000000 + i * 1000), i * 1000);
+        TEST_ASSERT_EQUAL_UINT(0, publisher.poll(i * 1000));
+    }
+    TEST_ASSERT_EQUAL_UINT(0, publisher.poll(config.windowMs));   // Window opened at 1000
+    TEST_ASSERT_EQUAL_UINT(1, publisher.poll(1000 + config.windowMs));
+
+    TEST_ASSERT_EQUAL_UINT32(before + 1, broker->messageCount());
+    TEST_ASSERT_TRUE(payload("uncollar/1/attributes")->find("\"latitude\":40.005000") != std::string::npos);
+    TEST_ASSERT_EQUAL_UINT32(4, publisher.stats().coalesced);
+}
+
+void test_small_moves_are_suppressed(void) {
+    MqttPublisher publisher(*broker, config, 8);
+    publisher.update(collarAt(1, 40000000), 0);
+    publisher.poll(0);
+    uint32_t before = broker->messageCount();
+
+    publisher.update(collarAt(1, 40000090), 1000);   // ~10 m
+    publisher.poll(20000);
+    TEST_ASSERT_EQUAL_UINT32(before, broker->messageCount());
+    TEST_ASSERT_EQUAL_UINT32(1, publisher.stats().suppressed);
+
+    // Still measured from the last published fix: 10 + 10 m is published
+    publisher.update(collarAt(1, 40000180), 21000);
+    TEST_ASSERT_EQUAL_UINT(1, publisher.poll(40000));
+}
+
+void test_fence_change_skips_window(void) {
+    MqttPublisher publisher(*broker, config, 8);
+    publisher.update(collarAt(1, 40000000), 0);
+    publisher.poll(0);
+
+    publisher.update(collarAt(1, 40000000, PacketFenceState::OUTSIDE), 500);
+    TEST_ASSERT_EQUAL_UINT(2, publisher.poll(600));
+    TEST_ASSERT_EQUAL_STRING("not_home", payload("uncollar/1/state")->c_str());
+    TEST_ASSERT_TRUE(payload("uncollar/1/attributes")->find("\"fence\":\"outside\"") != std::string::npos);
+}
+
+void test_battery_change_and_heartbeat(void) {
+    MqttPublisher publisher(*broker, config, 8);
+    publisher.update(collarAt(1, 40000000), 0);
+    publisher.poll(0);
+
+    publisher.update(collarAt(1, 40000000, PacketFenceState::INSIDE, 14), 1000);
+    TEST_ASSERT_EQUAL_UINT(1, publisher.poll(11000));
+    TEST_ASSERT_TRUE(payload("uncollar/1/attributes")->find("\"battery_level\":93") != std::string::npos);
+
+    // Nothing changed, but the last message is a heartbeat period old
+    publisher.update(collarAt(1, 40000000, PacketFenceState::INSIDE, 14), 11000 + config.heartbeatMs);
+    TEST_ASSERT_EQUAL_UINT(1, publisher.poll(21000 + config.heartbeatMs));
+}
+
+// ============================================================================
+// Rate Limit and Failure Tests
+// ============================================================================
+
+void test_rate_limit_serves_every_collar(void) {
+    config.maxMessagesPerSec = 10;
+    config.burstMessages = 10;
+    MqttPublisher publisher(*broker, config, 64);
+    for (uint32_t id = 1; id <= 40; id++) {
+        publisher.update(collarAt(id, 40000000), 0);
+    }
+
+    // 40 collars x 3 messages at 10/s: 12 s of budget, never faster
+    uint32_t now = 0;
+    TEST_ASSERT_EQUAL_UINT(10, publisher.poll(now));
+    while (publisher.pendingCount() > 0 && now < 60000) {
+        now += 100;
+        TEST_ASSERT_TRUE(publisher.poll(now) <= 2);
+    }
+    TEST_ASSERT_EQUAL_UINT(0, publisher.pendingCount());
+    TEST_ASSERT_EQUAL_UINT32(120, broker->messageCount());
+    TEST_ASSERT_TRUE(now >= 10000);
+    TEST_ASSERT_TRUE(publisher.stats().deferred > 0);
+    for (uint32_t id = 1; id <= 40; id++) {
+        char topic[32];
+        snprintf(topic, sizeof(topic), "uncollar/%u/state", (unsigned)id);
+        TEST_ASSERT_NOT_NULL(payload(topic));
+    }
+}
+
+void test_broker_offline_retries(void) {
+    MqttPublisher publisher(*broker, config, 8);
+    broker->setOffline(true);
+    publisher.update(collarAt(1, 40000000), 0);
+    TEST_ASSERT_EQUAL_UINT(0, publisher.poll(0));
+    TEST_ASSERT_EQUAL_UINT32(1, publisher.stats().sinkErrors);
+    TEST_ASSERT_EQUAL_UINT(1, publisher.pendingCount());
+
+    broker->setOffline(false);
+    TEST_ASSERT_EQUAL_UINT(3, publisher.poll(100));
+    TEST_ASSERT_EQUAL_STRING("home", payload("uncollar/1/state")->c_str());
+}
+
+void test_failed_state_retries_state_only(void) {
+    StateRefusingBroker refusing;
+    MqttPublisher publisher(refusing, config, 8);
+    publisher.update(collarAt(1, 40000000), 0);
+
+    // Discovery and attributes go out, the state does not
+    TEST_ASSERT_EQUAL_UINT(2, publisher.poll(0));
+    TEST_ASSERT_EQUAL_UINT(1, publisher.pendingCount());
+    TEST_ASSERT_EQUAL_UINT(0, publisher.poll(100));
+    TEST_ASSERT_EQUAL_UINT32(2, refusing.messageCount());
+    TEST_ASSERT_EQUAL_UINT32(2, publisher.stats().sinkErrors);
+
+    refusing.refuseState = false;
+    TEST_ASSERT_EQUAL_UINT(1, publisher.poll(200));
+    TEST_ASSERT_EQUAL_UINT32(3, refusing.messageCount());
+    TEST_ASSERT_EQUAL_STRING("home", refusing.lastPayload("uncollar/1/state")->c_str());
+    TEST_ASSERT_EQUAL_UINT(0, publisher.pendingCount());
+
+    // A newer update while the state is owed carries new attributes
+    refusing.refuseState = true;
+    publisher.update(collarAt(1, 40000000, PacketFenceState::OUTSIDE), 300);
+    TEST_ASSERT_EQUAL_UINT(1, publisher.poll(300));
+    publisher.update(collarAt(1, 40002000, PacketFenceState::OUTSIDE), 400);
+    refusing.refuseState = false;
+    TEST_ASSERT_EQUAL_UINT(2, publisher.poll(400));
+    TEST_ASSERT_TRUE(refusing.lastPayload("uncollar/1/attributes")->find("\"latitude\":40.002000") !=
+                     std::string::npos);
+    TEST_ASSERT_EQUAL_STRING("not_home", refusing.lastPayload("uncollar/1/state")->c_str());
+}
+
+void test_collar_table_full(void) {
+    MqttPublisher publisher(*broker, config, 2);
+    TEST_ASSERT_TRUE(publisher.update(collarAt(1, 40000000), 0));
+    TEST_ASSERT_TRUE(publisher.update(collarAt(2, 40000000), 0));
+    TEST_ASSERT_FALSE(publisher.update(collarAt(3, 40000000), 0));
+    TEST_ASSERT_TRUE(publisher.update(collarAt(1, 40001000), 0));
+    TEST_ASSERT_EQUAL_UINT32(1, publisher.stats().tableFull);
+}
+
+// Steady state: updates and polls never touch the heap
+void test_publishing_does_not_allocate(void) {
+    CountingSink sink;
+    config.maxMessagesPerSec = 0;
+    size_t start = allocations;
+    MqttPublisher publisher(sink, config, 256);
+    TEST_ASSERT_TRUE(allocations > start);   // The table, once
+
+    size_t before = allocations;
+    for (uint32_t step = 0; step < 100; step++) {
+        for (uint32_t id = 1; id <= 200; id++) {
+            PacketFenceState state = (step + id) % 17 == 0 ? PacketFenceState::OUTSIDE
+                                                           : PacketFenceState::INSIDE;
+            publisher.update(collarAt(id, 40000000 + step * 500, state, id % 16), step * 1000);
+        }
+        publisher.poll(step * 1000);
+    }
+    TEST_ASSERT_EQUAL_UINT(before, allocations);
+    TEST_ASSERT_TRUE(sink.messages > 1000);
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    config = DEFAULT_MQTT_PUBLISHER_CONFIG;
+    broker = new MemoryMqttBroker();
+}
+
+void tearDown(void) {
+    delete broker;
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Publishing tests
+    RUN_TEST(test_first_update_publishes_discovery_and_state);
+    RUN_TEST(test_updates_coalesce_within_window);
+    RUN_TEST(test_small_moves_are_suppressed);
+    RUN_TEST(test_fence_change_skips_window);
+    RUN_TEST(test_battery_change_and_heartbeat);
+
+    // Rate limit and failure tests
+    RUN_TEST(test_rate_limit_serves_every_collar);
+    RUN_TEST(test_broker_offline_retries);
+    RUN_TEST(test_failed_state_retries_state_only);
+    RUN_TEST(test_collar_table_full);
+    RUN_TEST(test_publishing_does_not_allocate);
+
+    return UNITY_END();
+}
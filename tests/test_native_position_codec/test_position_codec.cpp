@@ -0,0 +1,196 @@
+/**
+ * @file test_position_codec.cpp
+ * @brief Unit tests for the position_codec library (collar encode, base station decode).
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "position_codec.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+PositionPacket packet;
+PositionPacket decoded;
+uint8_t buffer[POSITION_PACKET_MAX_SIZE];
+
+// A dog trotting north-east: ~1.5 m per 5 s fix
+static void buildWalk(uint8_t count) {
+    memset(&packet, 0, sizeof(packet));
+    packet.sequence = 0x123;
+    packet.fenceState = PacketFenceState::INSIDE;
+    packet.battery = 12;
+    packet.fixCount = count;
+    for (uint8_t i = 0; i < count; i++) {
+        packet.fixes[i].latE6 = 40722720 + i * 11;
+        packet.fixes[i].lonE6 = -74021160 + i * 9;
+        packet.fixes[i].timestamp = 86400 + i * 5;
+    }
+}
+
+static void assertFixesEqual(const PositionPacket& a, const PositionPacket& b) {
+    TEST_ASSERT_EQUAL_UINT8(a.fixCount, b.fixCount);
+    for (uint8_t i = 0; i < a.fixCount; i++) {
+        TEST_ASSERT_EQUAL_INT32(a.fixes[i].latE6, b.fixes[i].latE6);
+        TEST_ASSERT_EQUAL_INT32(a.fixes[i].lonE6, b.fixes[i].lonE6);
+        TEST_ASSERT_EQUAL_UINT32(a.fixes[i].timestamp, b.fixes[i].timestamp);
+    }
+}
+
+// ============================================================================
+// Roundtrip Tests
+// ============================================================================
+
+void test_single_fix_roundtrip(void) {
+    buildWalk(1);
+    size_t size = positionPacketEncode(packet, buffer, sizeof(buffer));
+
+    // 3 header + 8 keyframe + 3 byte timestamp varint
+    TEST_ASSERT_EQUAL_UINT(14, size);
+    TEST_ASSERT_TRUE(positionPacketDecode(buffer, size, decoded));
+    assertFixesEqual(packet, decoded);
+}
+
+void test_header_fields_roundtrip(void) {
+    buildWalk(2);
+    packet.fenceState = PacketFenceState::ALERT;
+    packet.battery = 7;
+    packet.sequence = 0xABC;
+
+    size_t size = positionPacketEncode(packet, buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(positionPacketDecode(buffer, size, decoded));
+    TEST_ASSERT_TRUE(decoded.fenceState == PacketFenceState::ALERT);
+    TEST_ASSERT_EQUAL_UINT8(7, decoded.battery);
+    TEST_ASSERT_EQUAL_UINT16(0xABC, decoded.sequence);
+}
+
+void test_sequence_wraps_to_12_bits(void) {
+    buildWalk(1);
+    packet.sequence = 0x1005;
+
+    size_t size = positionPacketEncode(packet, buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(positionPacketDecode(buffer, size, decoded));
+    TEST_ASSERT_EQUAL_UINT16(0x005, decoded.sequence);
+}
+
+void test_batch_is_compact(void) {
+    buildWalk(POSITION_PACKET_MAX_FIXES);
+    size_t size = positionPacketEncode(packet, buffer, sizeof(buffer));
+
+    // Each small delta is 3 bytes, against 12 bytes for a raw fix
+    TEST_ASSERT_EQUAL_UINT(14 + 15 * 3, size);
+    TEST_ASSERT_TRUE(positionPacketDecode(buffer, size, decoded));
+    assertFixesEqual(packet, decoded);
+}
+
+void test_large_and_negative_deltas(void) {
+    buildWalk(4);
+    packet.fixes[1].latE6 = packet.fixes[0].latE6 - 5000000;
+    packet.fixes[2].lonE6 = 180000000;
+    packet.fixes[3].lonE6 = -180000000;
+    packet.fixes[3].timestamp = packet.fixes[2].timestamp + 100000;
+
+    size_t size = positionPacketEncode(packet, buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(size > 0);
+    TEST_ASSERT_TRUE(positionPacketDecode(buffer, size, decoded));
+    assertFixesEqual(packet, decoded);
+}
+
+void test_degree_conversion(void) {
+    TEST_ASSERT_EQUAL_INT32(40722720, degreesToE6(40.72272f));
+    TEST_ASSERT_INT32_WITHIN(8, -74021160, degreesToE6(-74.02116f));
+    TEST_ASSERT_FLOAT_WITHIN(0.00001f, 40.72272f, e6ToDegrees(40722720));
+}
+
+void test_battery_levels(void) {
+    TEST_ASSERT_EQUAL_UINT8(0, batteryPercentToLevel(0));
+    TEST_ASSERT_EQUAL_UINT8(8, batteryPercentToLevel(50));
+    TEST_ASSERT_EQUAL_UINT8(15, batteryPercentToLevel(100));
+    TEST_ASSERT_EQUAL_UINT8(15, batteryPercentToLevel(255));
+}
+
+// ============================================================================
+// Error Handling Tests
+// ============================================================================
+
+void test_encode_rejects_small_buffer(void) {
+    buildWalk(4);
+    TEST_ASSERT_EQUAL_UINT(0, positionPacketEncode(packet, buffer, 10));
+}
+
+void test_encode_rejects_bad_fix_count(void) {
+    buildWalk(1);
+    packet.fixCount = 0;
+    TEST_ASSERT_EQUAL_UINT(0, positionPacketEncode(packet, buffer, sizeof(buffer)));
+    packet.fixCount = POSITION_PACKET_MAX_FIXES + 1;
+    TEST_ASSERT_EQUAL_UINT(0, positionPacketEncode(packet, buffer, sizeof(buffer)));
+}
+
+void test_encode_rejects_time_going_backwards(void) {
+    buildWalk(2);
+    packet.fixes[1].timestamp = packet.fixes[0].timestamp - 1;
+    TEST_ASSERT_EQUAL_UINT(0, positionPacketEncode(packet, buffer, sizeof(buffer)));
+}
+
+void test_decode_rejects_truncation(void) {
+    buildWalk(5);
+    size_t size = positionPacketEncode(packet, buffer, sizeof(buffer));
+    for (size_t len = 0; len < size; len++) {
+        TEST_ASSERT_FALSE(positionPacketDecode(buffer, len, decoded));
+    }
+}
+
+void test_decode_rejects_trailing_bytes(void) {
+    buildWalk(2);
+    size_t size = positionPacketEncode(packet, buffer, sizeof(buffer));
+    buffer[size] = 0;
+    TEST_ASSERT_FALSE(positionPacketDecode(buffer, size + 1, decoded));
+}
+
+void test_decode_rejects_wrong_version(void) {
+    buildWalk(1);
+    size_t size = positionPacketEncode(packet, buffer, sizeof(buffer));
+    buffer[0] = (buffer[0] & 0x3F) | (2 << 6);
+    TEST_ASSERT_FALSE(positionPacketDecode(buffer, size, decoded));
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    memset(buffer, 0, sizeof(buffer));
+    memset(&decoded, 0, sizeof(decoded));
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Roundtrip tests
+    RUN_TEST(test_single_fix_roundtrip);
+    RUN_TEST(test_header_fields_roundtrip);
+    RUN_TEST(test_sequence_wraps_to_12_bits);
+    RUN_TEST(test_batch_is_compact);
+    RUN_TEST(test_large_and_negative_deltas);
+    RUN_TEST(test_degree_conversion);
+    RUN_TEST(test_battery_levels);
+
+    // Error handling tests
+    RUN_TEST(test_encode_rejects_small_buffer);
+    RUN_TEST(test_encode_rejects_bad_fix_count);
+    RUN_TEST(test_encode_rejects_time_going_backwards);
+    RUN_TEST(test_decode_rejects_truncation);
+    RUN_TEST(test_decode_rejects_trailing_bytes);
+    RUN_TEST(test_decode_rejects_wrong_version);
+
+    return UNITY_END();
+}
@@ -0,0 +1,325 @@
+/**
+ * @file test_radio.cpp
+ * @brief Unit tests for the queued radio layer, over the loopback radio.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "radio.h"
+#include "position_codec.h"
+#include "fence_update.h"
+
+// ============================================================================
+// Test Doubles
+// ============================================================================
+
+static uint32_t fakeClockUs = 0;
+
+static uint32_t fakeClock() {
+    return fakeClockUs;
+}
+
+/**
+ * @brief In-memory stand-in for the collar's fence storage.
+ */
+class MemoryTarget : public FenceUpdateTarget {
+public:
+    GeoPoint vertices[FENCE_UPDATE_MAX_VERTICES];
+    size_t count;
+    uint32_t version;
+
+    uint32_t currentVersion() const override { return version; }
+    const GeoPoint* currentVertices() const override { return vertices; }
+    size_t currentVertexCount() const override { return count; }
+
+    bool commit(const GeoPoint* v, size_t n, uint32_t ver) override {
+        memcpy(vertices, v, n * sizeof(GeoPoint));
+        count = n;
+        version = ver;
+        return true;
+    }
+};
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+const LoraModemConfig modem = DEFAULT_LORA_MODEM_CONFIG;
+
+LoopbackRadio* collar;
+LoopbackRadio* base;
+
+// Each test links its own pair (on the stack: the queues are cache-line
+// aligned, which plain C++11 new does not honour)
+#define RADIO_PAIR()                                  \
+    LoopbackRadio collarRadio(modem, fakeClock);      \
+    LoopbackRadio baseRadio(modem, fakeClock);        \
+    link(collarRadio, baseRadio)
+
+static void link(LoopbackRadio& c, LoopbackRadio& b) {
+    collar = &c;
+    base = &b;
+    collar->connect(*base);
+    base->listen(true);
+    collar->listen(true);
+}
+
+// Advance the shared clock in 1 ms steps, servicing both radios
+static void run(uint32_t ms) {
+    for (uint32_t i = 0; i < ms; i++) {
+        fakeClockUs += 1000;
+        collar->poll();
+        base->poll();
+    }
+}
+
+// ============================================================================
+// Airtime Tests
+// ============================================================================
+
+void test_airtime_matches_semtech_calculator(void) {
+    // SF7/125 kHz, 4/5, 8 symbol preamble, CRC, 10 bytes: 41.22 ms
+    LoraModemConfig sf7 = {7, 125, 5, 8, true};
+    TEST_ASSERT_EQUAL_UINT32(41216, loraAirtimeUs(sf7, 10));
+
+    // SF12 enables low data rate optimization: 991.23 ms
+    LoraModemConfig sf12 = {12, 125, 5, 8, true};
+    TEST_ASSERT_EQUAL_UINT32(991232, loraAirtimeUs(sf12, 10));
+
+    // Longer frames take longer; invalid settings report nothing
+    TEST_ASSERT_TRUE(loraAirtimeUs(modem, 100) > loraAirtimeUs(modem, 10));
+    LoraModemConfig invalid = {13, 125, 5, 8, true};
+    TEST_ASSERT_EQUAL_UINT32(0, loraAirtimeUs(invalid, 10));
+}
+
+// ============================================================================
+// Queue Tests
+// ============================================================================
+
+void test_send_returns_before_airtime(void) {
+    RADIO_PAIR();
+
+    const uint8_t frame[] = {1, 2, 3, 4};
+    uint32_t airtime = loraAirtimeUs(modem, sizeof(frame));
+
+    TEST_ASSERT_TRUE(collar->send(frame, sizeof(frame)));
+    TEST_ASSERT_TRUE(collar->isTransmitting());
+    TEST_ASSERT_EQUAL_UINT32(airtime, collar->remainingAirtimeUs());
+
+    // Half of the airtime later the frame is still on air
+    run(airtime / 2000);
+    TEST_ASSERT_TRUE(collar->isTransmitting());
+    uint8_t out[RADIO_MAX_FRAME];
+    TEST_ASSERT_EQUAL_UINT(0, base->receive(out, sizeof(out)));
+
+    run(airtime / 2000 + 2);
+    TEST_ASSERT_FALSE(collar->isTransmitting());
+    TEST_ASSERT_EQUAL_UINT32(0, collar->remainingAirtimeUs());
+    TEST_ASSERT_EQUAL_UINT(sizeof(frame), base->receive(out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(frame, out, sizeof(frame));
+    TEST_ASSERT_EQUAL_UINT32(1, collar->framesSent());
+}
+
+void test_queued_frames_go_out_in_order(void) {
+    RADIO_PAIR();
+
+    uint8_t frame[8];
+    for (uint8_t i = 0; i < RADIO_TX_QUEUE_DEPTH; i++) {
+        memset(frame, i, sizeof(frame));
+        TEST_ASSERT_TRUE(collar->send(frame, sizeof(frame)));
+    }
+    TEST_ASSERT_EQUAL_UINT32(RADIO_TX_QUEUE_DEPTH * loraAirtimeUs(modem, sizeof(frame)),
+                             collar->remainingAirtimeUs());
+
+    // One frame on air, the rest queued: room for exactly one more
+    memset(frame, RADIO_TX_QUEUE_DEPTH, sizeof(frame));
+    TEST_ASSERT_TRUE(collar->send(frame, sizeof(frame)));
+    TEST_ASSERT_FALSE(collar->send(frame, sizeof(frame)));
+
+    // The base reads each frame as it arrives (its FIFO holds one)
+    uint8_t out[RADIO_MAX_FRAME];
+    uint8_t expected = 0;
+    for (int ms = 0; ms < 5000 && collar->isTransmitting(); ms++) {
+        run(1);
+        if (base->receive(out, sizeof(out)) == sizeof(frame)) {
+            TEST_ASSERT_EQUAL_UINT8(expected, out[0]);
+            expected++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT8(RADIO_TX_QUEUE_DEPTH + 1, expected);
+    TEST_ASSERT_EQUAL_UINT32(RADIO_TX_QUEUE_DEPTH + 1, collar->framesSent());
+}
+
+void test_rejects_invalid_frames(void) {
+    RADIO_PAIR();
+
+    uint8_t frame[RADIO_MAX_FRAME + 1] = {0};
+    TEST_ASSERT_FALSE(collar->send(frame, 0));
+    TEST_ASSERT_FALSE(collar->send(nullptr, 4));
+    TEST_ASSERT_FALSE(collar->send(frame, sizeof(frame)));
+    TEST_ASSERT_FALSE(collar->isTransmitting());
+}
+
+void test_frames_to_a_deaf_peer_are_lost(void) {
+    RADIO_PAIR();
+
+    const uint8_t frame[] = {9, 9};
+    uint8_t out[RADIO_MAX_FRAME];
+
+    base->listen(false);
+    collar->send(frame, sizeof(frame));
+    run(200);
+    TEST_ASSERT_FALSE(collar->isTransmitting());
+    TEST_ASSERT_EQUAL_UINT(0, base->receive(out, sizeof(out)));
+
+    // Out of range: TX completes, nothing arrives
+    base->listen(true);
+    collar->setLinkDown(true);
+    collar->send(frame, sizeof(frame));
+    run(200);
+    TEST_ASSERT_EQUAL_UINT(0, base->receive(out, sizeof(out)));
+    TEST_ASSERT_EQUAL_UINT32(2, collar->framesSent());
+}
+
+void test_half_duplex_resumes_listening(void) {
+    RADIO_PAIR();
+
+    const uint8_t frame[] = {1};
+    collar->listen(true);
+    TEST_ASSERT_TRUE(collar->isListening());
+
+    collar->send(frame, sizeof(frame));
+    TEST_ASSERT_FALSE(collar->isListening());
+    run(200);
+    TEST_ASSERT_TRUE(collar->isListening());
+
+    collar->listen(false);
+    TEST_ASSERT_FALSE(collar->isListening());
+}
+
+// ============================================================================
+// End-to-End Tests
+// ============================================================================
+
+void test_position_uplink_decodes_at_base(void) {
+    RADIO_PAIR();
+
+    PositionPacket packet = {};
+    packet.sequence = 77;
+    packet.fenceState = PacketFenceState::OUTSIDE;
+    packet.fixCount = 8;
+    for (uint8_t i = 0; i < packet.fixCount; i++) {
+        PositionFix fix = {40712800 + i * 12, -74006000 - i * 7, 1000u + i * 5};
+        packet.fixes[i] = fix;
+    }
+
+    uint8_t frame[POSITION_PACKET_MAX_SIZE];
+    size_t length = positionPacketEncode(packet, frame, sizeof(frame));
+    TEST_ASSERT_TRUE(length > 0);
+    TEST_ASSERT_TRUE(collar->send(frame, length));
+    run(loraAirtimeUs(modem, length) / 1000 + 2);
+
+    uint8_t received[RADIO_MAX_FRAME];
+    size_t receivedLength = base->receive(received, sizeof(received));
+    TEST_ASSERT_EQUAL_UINT(length, receivedLength);
+
+    PositionPacket decoded;
+    TEST_ASSERT_TRUE(positionPacketDecode(received, receivedLength, decoded));
+    TEST_ASSERT_EQUAL_UINT16(77, decoded.sequence);
+    TEST_ASSERT_EQUAL_UINT8(8, decoded.fixCount);
+    TEST_ASSERT_EQUAL_INT32(packet.fixes[7].lonE6, decoded.fixes[7].lonE6);
+}
+
+void test_fence_update_downlink_with_replies(void) {
+    RADIO_PAIR();
+
+    static MemoryTarget target;
+    static FenceUpdateState state;
+    target.count = 0;
+    target.version = 0;
+    memset(&state, 0, sizeof(state));
+    FenceUpdateReceiver receiver(state, target);
+
+    GeoPoint fence[20];
+    for (size_t i = 0; i < 20; i++) {
+        fence[i].lat = 40.7f + 0.001f * static_cast<float>(i % 7);
+        fence[i].lon = -74.0f + 0.0001f * static_cast<float>(i);
+    }
+    FenceUpdateSender sender;
+    TEST_ASSERT_TRUE(sender.begin(fence, 20, fenceVersionMake(5, 2)));
+
+    uint8_t msg[FENCE_MSG_MAX_SIZE];
+    uint8_t frame[RADIO_MAX_FRAME];
+    uint8_t reply[FENCE_MSG_STATUS_SIZE];
+    int rounds = 0;
+
+    while (!sender.isComplete() && rounds < 5) {
+        rounds++;
+        sender.startRound();
+        size_t length;
+        while ((length = sender.nextMessage(msg, sizeof(msg))) > 0) {
+            TEST_ASSERT_TRUE(base->send(msg, length));
+
+            // Until the base has sent and a reply could have come back
+            for (int ms = 0; ms < 1000; ms++) {
+                run(1);
+                size_t n = collar->receive(frame, sizeof(frame));
+                if (n > 0) {
+                    size_t replyLength = receiver.handle(frame, n, reply, sizeof(reply));
+                    if (replyLength > 0) {
+                        collar->send(reply, replyLength);
+                    }
+                }
+                n = base->receive(frame, sizeof(frame));
+                if (n > 0) {
+                    sender.handleStatus(frame, n);
+                }
+                if (!base->isTransmitting() && !collar->isTransmitting() && ms > 300) {
+                    break;
+                }
+            }
+        }
+    }
+
+    TEST_ASSERT_TRUE(sender.isComplete());
+    TEST_ASSERT_EQUAL_UINT32(fenceVersionMake(5, 2), target.version);
+    TEST_ASSERT_EQUAL_UINT(20, target.count);
+    TEST_ASSERT_EQUAL_MEMORY(fence, target.vertices, sizeof(fence));
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    fakeClockUs = 0;
+}
+
+void tearDown(void) {
+    collar = nullptr;
+    base = nullptr;
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Airtime tests
+    RUN_TEST(test_airtime_matches_semtech_calculator);
+
+    // Queue tests
+    RUN_TEST(test_send_returns_before_airtime);
+    RUN_TEST(test_queued_frames_go_out_in_order);
+    RUN_TEST(test_rejects_invalid_frames);
+    RUN_TEST(test_frames_to_a_deaf_peer_are_lost);
+    RUN_TEST(test_half_duplex_resumes_listening);
+
+    // End-to-end tests
+    RUN_TEST(test_position_uplink_decodes_at_base);
+    RUN_TEST(test_fence_update_downlink_with_replies);
+
+    return UNITY_END();
+}
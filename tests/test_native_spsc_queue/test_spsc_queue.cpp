@@ -0,0 +1,223 @@
+/**
+ * @file test_spsc_queue.cpp
+ * @brief Unit and thread stress tests for the lock-free SPSC queue.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include "spsc_queue.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+// Shaped like a parsed fix: several fields that must arrive together
+struct Item {
+    uint32_t sequence;
+    int32_t lat;
+    int32_t lon;
+    uint32_t check;
+};
+
+static Item makeItem(uint32_t sequence) {
+    Item item = {sequence, static_cast<int32_t>(sequence * 7), -static_cast<int32_t>(sequence), 0};
+    item.check = item.sequence ^ static_cast<uint32_t>(item.lat) ^ static_cast<uint32_t>(item.lon);
+    return item;
+}
+
+static bool itemIntact(const Item& item) {
+    return item.check == (item.sequence ^ static_cast<uint32_t>(item.lat) ^ static_cast<uint32_t>(item.lon));
+}
+
+static const uint32_t STRESS_ITEMS = 1000000;
+
+// ============================================================================
+// Single-Thread Tests
+// ============================================================================
+
+void test_new_queue_is_empty(void) {
+    SpscQueue<Item, 8> queue;
+    Item item;
+    TEST_ASSERT_TRUE(queue.empty());
+    TEST_ASSERT_EQUAL_UINT(0, queue.size());
+    TEST_ASSERT_FALSE(queue.pop(item));
+    TEST_ASSERT_EQUAL_UINT(8, queue.capacity());
+}
+
+void test_fifo_order(void) {
+    SpscQueue<Item, 8> queue;
+    for (uint32_t i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(queue.push(makeItem(i)));
+    }
+    TEST_ASSERT_EQUAL_UINT(5, queue.size());
+
+    Item item;
+    for (uint32_t i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(queue.pop(item));
+        TEST_ASSERT_EQUAL_UINT32(i, item.sequence);
+    }
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_full_queue_rejects_push(void) {
+    SpscQueue<Item, 4> queue;
+    for (uint32_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(queue.push(makeItem(i)));
+    }
+    TEST_ASSERT_FALSE(queue.push(makeItem(99)));
+    TEST_ASSERT_EQUAL_UINT(4, queue.size());
+
+    // The rejected item was not stored; one pop makes room again
+    Item item;
+    TEST_ASSERT_TRUE(queue.pop(item));
+    TEST_ASSERT_EQUAL_UINT32(0, item.sequence);
+    TEST_ASSERT_TRUE(queue.push(makeItem(4)));
+
+    for (uint32_t i = 1; i <= 4; i++) {
+        TEST_ASSERT_TRUE(queue.pop(item));
+        TEST_ASSERT_EQUAL_UINT32(i, item.sequence);
+    }
+}
+
+void test_wraps_around_many_times(void) {
+    SpscQueue<Item, 4> queue;
+    Item item;
+    for (uint32_t i = 0; i < 1000; i++) {
+        TEST_ASSERT_TRUE(queue.push(makeItem(i)));
+        TEST_ASSERT_TRUE(queue.push(makeItem(i + 1000)));
+        TEST_ASSERT_TRUE(queue.pop(item));
+        TEST_ASSERT_EQUAL_UINT32(i, item.sequence);
+        TEST_ASSERT_TRUE(queue.pop(item));
+        TEST_ASSERT_EQUAL_UINT32(i + 1000, item.sequence);
+    }
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+// ============================================================================
+// Thread Stress Tests
+// ============================================================================
+
+// Producer retries when full: every item arrives, in order, intact
+void test_threads_deliver_every_item_in_order(void) {
+    static SpscQueue<Item, 16> queue;
+    std::atomic<bool> corrupted(false);
+    std::atomic<bool> outOfOrder(false);
+    uint32_t received = 0;
+
+    std::thread consumer([&]() {
+        Item item;
+        while (received < STRESS_ITEMS) {
+            if (!queue.pop(item)) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (!itemIntact(item)) {
+                corrupted = true;
+            }
+            if (item.sequence != received) {
+                outOfOrder = true;
+            }
+            received++;
+        }
+    });
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < STRESS_ITEMS; i++) {
+            Item item = makeItem(i);
+            while (!queue.push(item)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(STRESS_ITEMS, received);
+    TEST_ASSERT_FALSE(corrupted);
+    TEST_ASSERT_FALSE(outOfOrder);
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+// Producer drops when full (like the GPS task): what arrives is a strictly
+// increasing, intact subsequence, and pushed = received + dropped
+void test_threads_drop_when_full(void) {
+    static SpscQueue<Item, 4> queue;
+    std::atomic<bool> done(false);
+    std::atomic<bool> corrupted(false);
+    std::atomic<bool> outOfOrder(false);
+    uint32_t received = 0;
+    uint32_t dropped = 0;
+
+    std::thread consumer([&]() {
+        Item item;
+        int64_t last = -1;
+        for (;;) {
+            bool finished = done.load();
+            if (!queue.pop(item)) {
+                if (finished) {
+                    break;
+                }
+                continue;
+            }
+            if (!itemIntact(item)) {
+                corrupted = true;
+            }
+            if (static_cast<int64_t>(item.sequence) <= last) {
+                outOfOrder = true;
+            }
+            last = item.sequence;
+            received++;
+        }
+    });
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < STRESS_ITEMS; i++) {
+            if (!queue.push(makeItem(i))) {
+                dropped++;
+            }
+        }
+        done = true;
+    });
+
+    producer.join();
+    consumer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(STRESS_ITEMS, received + dropped);
+    TEST_ASSERT_FALSE(corrupted);
+    TEST_ASSERT_FALSE(outOfOrder);
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Single-thread tests
+    RUN_TEST(test_new_queue_is_empty);
+    RUN_TEST(test_fifo_order);
+    RUN_TEST(test_full_queue_rejects_push);
+    RUN_TEST(test_wraps_around_many_times);
+
+    // Thread stress tests
+    RUN_TEST(test_threads_deliver_every_item_in_order);
+    RUN_TEST(test_threads_drop_when_full);
+
+    return UNITY_END();
+}
@@ -0,0 +1,336 @@
+/**
+ * @file test_track_log.cpp
+ * @brief Unit tests for the track_log library (native file backend).
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <unistd.h>
+#include "track_log.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+static const char* LOG_PATH = "test_track_log.bin";
+
+// Two sectors: the smallest valid ring (512 records)
+static const size_t SMALL_SIZE = 2 * TRACK_LOG_SECTOR_SIZE;
+static const size_t SMALL_CAPACITY = SMALL_SIZE / sizeof(TrackRecord);
+
+TrackLogStorage storage;
+TrackLogState state;
+TrackEntry entries[1024];
+
+static PositionFix fixAt(uint32_t i) {
+    PositionFix fix;
+    fix.latE6 = 40722720 + static_cast<int32_t>(i);
+    fix.lonE6 = -74021160 - static_cast<int32_t>(i);
+    fix.timestamp = i * 5;
+    return fix;
+}
+
+static void appendFixes(TrackLog& log, uint32_t first, uint32_t count) {
+    for (uint32_t i = first; i < first + count; i++) {
+        TEST_ASSERT_TRUE(log.append(fixAt(i)));
+    }
+}
+
+/**
+ * Simulate a cold boot: RTC memory is lost and flash is re-opened.
+ */
+static void powerCycle() {
+    memset(&state, 0, sizeof(state));
+    storage.end();
+    TEST_ASSERT_TRUE(storage.begin(LOG_PATH));
+}
+
+// ============================================================================
+// Basic Tests
+// ============================================================================
+
+void test_empty_log(void) {
+    TrackLog log(storage, state);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_EQUAL_UINT32(1, log.nextSeq());
+    TEST_ASSERT_EQUAL_UINT32(0, log.pendingCount());
+    TEST_ASSERT_EQUAL_UINT(0, log.readPending(entries, 16));
+}
+
+void test_staged_fixes_are_readable(void) {
+    TrackLog log(storage, state);
+    log.begin();
+    appendFixes(log, 0, 5);
+
+    TEST_ASSERT_EQUAL_UINT8(5, log.stagedCount());
+    TEST_ASSERT_EQUAL_UINT32(5, log.pendingCount());
+    TEST_ASSERT_EQUAL_UINT(5, log.readPending(entries, 16));
+    TEST_ASSERT_EQUAL_UINT32(1, entries[0].seq);
+    TEST_ASSERT_EQUAL_INT32(fixAt(4).latE6, entries[4].fix.latE6);
+}
+
+void test_full_page_flushes(void) {
+    TrackLog log(storage, state);
+    log.begin();
+    appendFixes(log, 0, TRACK_LOG_STAGING_RECORDS);
+
+    TEST_ASSERT_EQUAL_UINT8(0, log.stagedCount());
+    TEST_ASSERT_EQUAL_UINT(TRACK_LOG_STAGING_RECORDS, log.readPending(entries, 64));
+    TEST_ASSERT_EQUAL_UINT32(fixAt(0).timestamp, entries[0].fix.timestamp);
+}
+
+void test_read_spans_flash_and_staging(void) {
+    TrackLog log(storage, state);
+    log.begin();
+    appendFixes(log, 0, 20);
+
+    TEST_ASSERT_EQUAL_UINT(20, log.readPending(entries, 64));
+    for (uint32_t i = 0; i < 20; i++) {
+        TEST_ASSERT_EQUAL_UINT32(i + 1, entries[i].seq);
+        TEST_ASSERT_EQUAL_INT32(fixAt(i).lonE6, entries[i].fix.lonE6);
+    }
+}
+
+void test_read_respects_max(void) {
+    TrackLog log(storage, state);
+    log.begin();
+    appendFixes(log, 0, 20);
+    TEST_ASSERT_EQUAL_UINT(8, log.readPending(entries, 8));
+    TEST_ASSERT_EQUAL_UINT32(8, entries[7].seq);
+}
+
+// ============================================================================
+// Acknowledgement Tests
+// ============================================================================
+
+void test_acknowledge_advances_cursor(void) {
+    TrackLog log(storage, state);
+    log.begin();
+    appendFixes(log, 0, 40);
+
+    TEST_ASSERT_TRUE(log.acknowledge(25));
+    TEST_ASSERT_EQUAL_UINT32(25, log.ackedSeq());
+    TEST_ASSERT_EQUAL_UINT32(15, log.pendingCount());
+    TEST_ASSERT_EQUAL_UINT(15, log.readPending(entries, 64));
+    TEST_ASSERT_EQUAL_UINT32(26, entries[0].seq);
+}
+
+void test_acknowledge_is_monotonic(void) {
+    TrackLog log(storage, state);
+    log.begin();
+    appendFixes(log, 0, 10);
+
+    log.acknowledge(8);
+    TEST_ASSERT_TRUE(log.acknowledge(3));
+    TEST_ASSERT_EQUAL_UINT32(8, log.ackedSeq());
+    TEST_ASSERT_EQUAL_UINT32(2, log.pendingCount());
+}
+
+void test_acknowledge_all(void) {
+    TrackLog log(storage, state);
+    log.begin();
+    appendFixes(log, 0, 33);
+
+    TEST_ASSERT_EQUAL_UINT(33, log.readPending(entries, 64));
+    log.acknowledge(entries[32].seq);
+    TEST_ASSERT_EQUAL_UINT32(0, log.pendingCount());
+    TEST_ASSERT_EQUAL_UINT(0, log.readPending(entries, 64));
+
+    // New fixes after a full acknowledgement are picked up
+    appendFixes(log, 33, 3);
+    TEST_ASSERT_EQUAL_UINT(3, log.readPending(entries, 64));
+    TEST_ASSERT_EQUAL_INT32(fixAt(33).latE6, entries[0].fix.latE6);
+}
+
+// ============================================================================
+// Wraparound Tests
+// ============================================================================
+
+void test_wraparound_drops_oldest(void) {
+    TrackLog log(storage, state);
+    log.begin();
+
+    const uint32_t total = 3 * SMALL_CAPACITY + 7;
+    appendFixes(log, 0, total);
+    log.flush();
+
+    size_t count = log.readPending(entries, 1024);
+    TEST_ASSERT_TRUE(count > 0);
+    TEST_ASSERT_TRUE(count <= SMALL_CAPACITY);
+    TEST_ASSERT_EQUAL_UINT32(count, log.pendingCount());
+
+    // Newest fix is last, and sequence numbers are contiguous
+    TEST_ASSERT_EQUAL_UINT32(total, entries[count - 1].seq);
+    for (size_t i = 1; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT32(entries[i - 1].seq + 1, entries[i].seq);
+    }
+}
+
+void test_wraparound_with_partial_ack(void) {
+    TrackLog log(storage, state);
+    log.begin();
+
+    appendFixes(log, 0, SMALL_CAPACITY - 100);
+    log.acknowledge(SMALL_CAPACITY - 200);
+    appendFixes(log, SMALL_CAPACITY - 100, 300);
+    log.flush();
+
+    size_t count = log.readPending(entries, 1024);
+    TEST_ASSERT_EQUAL_UINT32(count, log.pendingCount());
+    TEST_ASSERT_EQUAL_UINT32(400, count);
+    TEST_ASSERT_EQUAL_UINT32(SMALL_CAPACITY - 200 + 1, entries[0].seq);
+    // The ACK marker consumed one sequence number
+    TEST_ASSERT_EQUAL_UINT32(SMALL_CAPACITY + 201, entries[count - 1].seq);
+}
+
+// ============================================================================
+// Crash Recovery Tests
+// ============================================================================
+
+void test_recovery_after_power_loss(void) {
+    {
+        TrackLog log(storage, state);
+        log.begin();
+        appendFixes(log, 0, 40);
+        log.acknowledge(20);
+        log.flush();
+        appendFixes(log, 40, 3);  // Staged only - lost on power loss
+    }
+
+    powerCycle();
+
+    TrackLog log(storage, state);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_EQUAL_UINT32(20, log.ackedSeq());
+    TEST_ASSERT_EQUAL_UINT32(20, log.pendingCount());
+    TEST_ASSERT_EQUAL_UINT(20, log.readPending(entries, 64));
+    TEST_ASSERT_EQUAL_UINT32(21, entries[0].seq);
+
+    // Sequence numbers continue after the newest record on flash
+    TEST_ASSERT_EQUAL_UINT32(42, log.nextSeq());
+}
+
+void test_recovery_skips_torn_record(void) {
+    {
+        TrackLog log(storage, state);
+        log.begin();
+        appendFixes(log, 0, TRACK_LOG_STAGING_RECORDS);
+
+        // Power lost mid-write: the next slot is half programmed
+        TrackRecord torn;
+        memset(&torn, 0xFF, sizeof(torn));
+        torn.seqCrc = (17u << 8) | 0x00;
+        torn.timestamp = 0x12345678;
+        TEST_ASSERT_TRUE(storage.write(state.writeOffset, &torn, 8));
+    }
+
+    powerCycle();
+
+    TrackLog log(storage, state);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_EQUAL_UINT32(TRACK_LOG_STAGING_RECORDS, log.pendingCount());
+
+    // New records go after the torn slot and read back cleanly
+    appendFixes(log, 100, TRACK_LOG_STAGING_RECORDS);
+    size_t count = log.readPending(entries, 64);
+    TEST_ASSERT_EQUAL_UINT(2 * TRACK_LOG_STAGING_RECORDS, count);
+    TEST_ASSERT_EQUAL_INT32(fixAt(100).latE6, entries[TRACK_LOG_STAGING_RECORDS].fix.latE6);
+}
+
+void test_recovery_after_wraparound(void) {
+    const uint32_t total = 2 * SMALL_CAPACITY + 48;
+    {
+        TrackLog log(storage, state);
+        log.begin();
+        appendFixes(log, 0, total);
+        log.flush();
+    }
+
+    powerCycle();
+
+    TrackLog log(storage, state);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_EQUAL_UINT32(total + 1, log.nextSeq());
+
+    size_t count = log.readPending(entries, 1024);
+    TEST_ASSERT_EQUAL_UINT32(count, log.pendingCount());
+    TEST_ASSERT_EQUAL_UINT32(total, entries[count - 1].seq);
+    for (size_t i = 1; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT32(entries[i - 1].seq + 1, entries[i].seq);
+    }
+}
+
+void test_warm_wake_keeps_staging(void) {
+    {
+        TrackLog log(storage, state);
+        log.begin();
+        appendFixes(log, 0, 5);
+    }
+
+    // Deep sleep: RTC state survives, a new TrackLog picks it up
+    TrackLog log(storage, state);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_EQUAL_UINT8(5, log.stagedCount());
+    TEST_ASSERT_EQUAL_UINT(5, log.readPending(entries, 64));
+}
+
+void test_format_clears_log(void) {
+    TrackLog log(storage, state);
+    log.begin();
+    appendFixes(log, 0, 50);
+    TEST_ASSERT_TRUE(log.format());
+    TEST_ASSERT_EQUAL_UINT32(0, log.pendingCount());
+
+    powerCycle();
+    TrackLog reopened(storage, state);
+    reopened.begin();
+    TEST_ASSERT_EQUAL_UINT32(1, reopened.nextSeq());
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    unlink(LOG_PATH);
+    memset(&state, 0, sizeof(state));
+    storage.begin(LOG_PATH, SMALL_SIZE);
+}
+
+void tearDown(void) {
+    storage.end();
+    unlink(LOG_PATH);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Basic tests
+    RUN_TEST(test_empty_log);
+    RUN_TEST(test_staged_fixes_are_readable);
+    RUN_TEST(test_full_page_flushes);
+    RUN_TEST(test_read_spans_flash_and_staging);
+    RUN_TEST(test_read_respects_max);
+
+    // Acknowledgement tests
+    RUN_TEST(test_acknowledge_advances_cursor);
+    RUN_TEST(test_acknowledge_is_monotonic);
+    RUN_TEST(test_acknowledge_all);
+
+    // Wraparound tests
+    RUN_TEST(test_wraparound_drops_oldest);
+    RUN_TEST(test_wraparound_with_partial_ack);
+
+    // Crash recovery tests
+    RUN_TEST(test_recovery_after_power_loss);
+    RUN_TEST(test_recovery_skips_torn_record);
+    RUN_TEST(test_recovery_after_wraparound);
+    RUN_TEST(test_warm_wake_keeps_staging);
+    RUN_TEST(test_format_clears_log);
+
+    return UNITY_END();
+}
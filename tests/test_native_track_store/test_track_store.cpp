@@ -0,0 +1,375 @@
+/**
+ * @file test_track_store.cpp
+ * @brief Unit tests for the track_store library.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "track_store.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+static const char* STORE_PATH = "test_track_store.uct";
+
+static StoredFix fixAt(uint32_t i) {
+    StoredFix stored;
+    stored.fix.latE6 = 40722720 + static_cast<int32_t>(i % 97) * 3;
+    stored.fix.lonE6 = -74021160 - static_cast<int32_t>(i % 89) * 2;
+    stored.fix.timestamp = 1000 + i * 5 + (i % 7 == 0 ? 1 : 0);
+    stored.fenceState = (i / 50) % 3 == 2 ? PacketFenceState::OUTSIDE : PacketFenceState::INSIDE;
+    return stored;
+}
+
+static void writeFixes(TrackStoreWriter& writer, uint32_t first, uint32_t count) {
+    for (uint32_t i = first; i < first + count; i++) {
+        StoredFix stored = fixAt(i);
+        TEST_ASSERT_TRUE(writer.append(stored.fix, stored.fenceState));
+    }
+}
+
+static void assertSameFix(const StoredFix& expected, const StoredFix& actual) {
+    TEST_ASSERT_EQUAL_INT32(expected.fix.latE6, actual.fix.latE6);
+    TEST_ASSERT_EQUAL_INT32(expected.fix.lonE6, actual.fix.lonE6);
+    TEST_ASSERT_EQUAL_UINT32(expected.fix.timestamp, actual.fix.timestamp);
+    TEST_ASSERT_EQUAL(static_cast<int>(expected.fenceState), static_cast<int>(actual.fenceState));
+}
+
+static off_t fileSize(const char* path) {
+    int fd = open(path, O_RDONLY);
+    off_t size = lseek(fd, 0, SEEK_END);
+    close(fd);
+    return size;
+}
+
+// ============================================================================
+// Block Codec Tests
+// ============================================================================
+
+void test_block_round_trip_extremes(void) {
+    // Worst-case deltas: full-range coordinate jumps and timestamp gaps
+    StoredFix fixes[6] = {
+        {{90000000, 180000000, 0}, PacketFenceState::UNKNOWN},
+        {{-90000000, -180000000, 0}, PacketFenceState::INSIDE},
+        {{INT32_MAX, INT32_MIN, 0xFFFFFFFF}, PacketFenceState::OUTSIDE},
+        {{INT32_MIN, INT32_MAX, 0xFFFFFFFF}, PacketFenceState::ALERT},
+        {{0, 0, 0xFFFFFFFF}, PacketFenceState::INSIDE},
+        {{1, -1, 0xFFFFFFFF}, PacketFenceState::ALERT},
+    };
+    std::vector<uint8_t> block;
+    TEST_ASSERT_TRUE(trackBlockEncode(fixes, 6, block));
+
+    TrackBlockInfo info;
+    TEST_ASSERT_EQUAL(block.size(), trackBlockCheck(block.data(), block.size(), info));
+    TEST_ASSERT_EQUAL_UINT32(6, info.fixCount);
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, info.minLatE6);
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, info.maxLonE6);
+
+    StoredFix decoded[6];
+    TEST_ASSERT_TRUE(trackBlockDecode(block.data(), decoded));
+    for (int i = 0; i < 6; i++) {
+        assertSameFix(fixes[i], decoded[i]);
+    }
+}
+
+void test_steady_walk_compresses(void) {
+    std::vector<StoredFix> fixes;
+    for (uint32_t i = 0; i < TRACK_STORE_BLOCK_FIXES; i++) {
+        StoredFix stored = {{40722720 + static_cast<int32_t>(i), -74021160 + static_cast<int32_t>(i / 2),
+                             i * 5}, PacketFenceState::INSIDE};
+        fixes.push_back(stored);
+    }
+    std::vector<uint8_t> block;
+    TEST_ASSERT_TRUE(trackBlockEncode(fixes.data(), fixes.size(), block));
+
+    // One byte each for time, latitude and longitude, plus the bit-planes
+    TEST_ASSERT_LESS_THAN(3 * TRACK_STORE_BLOCK_FIXES + TRACK_STORE_BLOCK_FIXES / 4 + 64, block.size());
+}
+
+void test_encode_rejects_bad_input(void) {
+    StoredFix fixes[2] = {fixAt(1), fixAt(0)};
+    std::vector<uint8_t> block;
+    TEST_ASSERT_FALSE(trackBlockEncode(fixes, 2, block));
+    TEST_ASSERT_FALSE(trackBlockEncode(fixes, 0, block));
+}
+
+void test_corrupt_block_fails_check(void) {
+    StoredFix fixes[100];
+    for (uint32_t i = 0; i < 100; i++) {
+        fixes[i] = fixAt(i);
+    }
+    std::vector<uint8_t> block;
+    TEST_ASSERT_TRUE(trackBlockEncode(fixes, 100, block));
+
+    TrackBlockInfo info;
+    TEST_ASSERT_EQUAL(0, trackBlockCheck(block.data(), block.size() - 1, info));
+    block[TRACK_STORE_HEADER_SIZE + 3] ^= 0x10;
+    TEST_ASSERT_EQUAL(0, trackBlockCheck(block.data(), block.size(), info));
+}
+
+// ============================================================================
+// Reader / Writer Tests
+// ============================================================================
+
+void test_query_across_blocks(void) {
+    const uint32_t count = 3 * TRACK_STORE_BLOCK_FIXES + 100;
+    TrackStoreWriter writer;
+    TEST_ASSERT_TRUE(writer.begin(STORE_PATH));
+    writeFixes(writer, 0, count);
+    TEST_ASSERT_EQUAL(100, writer.pendingCount());
+    TEST_ASSERT_TRUE(writer.flush());
+
+    TrackStoreReader reader;
+    TEST_ASSERT_TRUE(reader.open(STORE_PATH));
+    TEST_ASSERT_EQUAL(4, reader.blocks().size());
+    TEST_ASSERT_EQUAL_UINT64(count, reader.fixCount());
+    TEST_ASSERT_FALSE(reader.truncated());
+
+    // A range starting and ending mid-block, spanning a whole one
+    uint32_t first = TRACK_STORE_BLOCK_FIXES - 10;
+    uint32_t last = 2 * TRACK_STORE_BLOCK_FIXES + 10;
+    std::vector<StoredFix> out;
+    size_t found = reader.query(fixAt(first).fix.timestamp, fixAt(last).fix.timestamp, out);
+    TEST_ASSERT_EQUAL(last - first + 1, found);
+    for (uint32_t i = 0; i < found; i++) {
+        assertSameFix(fixAt(first + i), out[i]);
+    }
+
+    out.clear();
+    TEST_ASSERT_EQUAL(count, reader.query(0, 0xFFFFFFFF, out));
+    out.clear();
+    TEST_ASSERT_EQUAL(0, reader.query(0, 999, out));
+    TEST_ASSERT_EQUAL(0, reader.query(fixAt(count).fix.timestamp, 0xFFFFFFFF, out));
+}
+
+void test_count_outside_matches_decode(void) {
+    const uint32_t count = 2 * TRACK_STORE_BLOCK_FIXES + 500;
+    TrackStoreWriter writer;
+    TEST_ASSERT_TRUE(writer.begin(STORE_PATH));
+    writeFixes(writer, 0, count);
+    TEST_ASSERT_TRUE(writer.flush());
+
+    TrackStoreReader reader;
+    TEST_ASSERT_TRUE(reader.open(STORE_PATH));
+
+    uint32_t ranges[3][2] = {{0, count - 1}, {17, 2 * TRACK_STORE_BLOCK_FIXES + 3}, {4100, 4200}};
+    for (int r = 0; r < 3; r++) {
+        uint64_t expected = 0;
+        for (uint32_t i = ranges[r][0]; i <= ranges[r][1]; i++) {
+            expected += fixAt(i).fenceState == PacketFenceState::OUTSIDE ? 1 : 0;
+        }
+        TEST_ASSERT_EQUAL_UINT64(expected, reader.countOutside(fixAt(ranges[r][0]).fix.timestamp,
+                                                               fixAt(ranges[r][1]).fix.timestamp));
+    }
+}
+
+void test_writer_continues_file(void) {
+    {
+        TrackStoreWriter writer;
+        TEST_ASSERT_TRUE(writer.begin(STORE_PATH));
+        writeFixes(writer, 0, 300);
+        TEST_ASSERT_TRUE(writer.flush());
+    }
+
+    TrackStoreWriter writer;
+    TEST_ASSERT_TRUE(writer.begin(STORE_PATH));
+    StoredFix old = fixAt(100);
+    TEST_ASSERT_FALSE(writer.append(old.fix, old.fenceState));
+    writeFixes(writer, 300, 200);
+    TEST_ASSERT_TRUE(writer.flush());
+
+    TrackStoreReader reader;
+    TEST_ASSERT_TRUE(reader.open(STORE_PATH));
+    TEST_ASSERT_EQUAL(2, reader.blocks().size());
+    std::vector<StoredFix> out;
+    TEST_ASSERT_EQUAL(500, reader.query(0, 0xFFFFFFFF, out));
+    assertSameFix(fixAt(499), out[499]);
+}
+
+void test_torn_block_is_dropped(void) {
+    {
+        TrackStoreWriter writer;
+        TEST_ASSERT_TRUE(writer.begin(STORE_PATH));
+        writeFixes(writer, 0, 300);
+        TEST_ASSERT_TRUE(writer.flush());
+        writeFixes(writer, 300, 300);
+        TEST_ASSERT_TRUE(writer.flush());
+    }
+    off_t full = fileSize(STORE_PATH);
+    TEST_ASSERT_EQUAL(0, truncate(STORE_PATH, full - 7));
+
+    {
+        TrackStoreReader reader;
+        TEST_ASSERT_TRUE(reader.open(STORE_PATH));
+        TEST_ASSERT_TRUE(reader.truncated());
+        TEST_ASSERT_EQUAL_UINT64(300, reader.fixCount());
+    }
+
+    // The writer cuts the torn block off and carries on after fix 299
+    TrackStoreWriter writer;
+    TEST_ASSERT_TRUE(writer.begin(STORE_PATH));
+    TEST_ASSERT_LESS_THAN(full - 7, fileSize(STORE_PATH));
+    writeFixes(writer, 300, 10);
+    TEST_ASSERT_TRUE(writer.flush());
+
+    TrackStoreReader reader;
+    TEST_ASSERT_TRUE(reader.open(STORE_PATH));
+    TEST_ASSERT_FALSE(reader.truncated());
+    TEST_ASSERT_EQUAL_UINT64(310, reader.fixCount());
+}
+
+void test_corrupt_block_ends_file(void) {
+    {
+        TrackStoreWriter writer;
+        TEST_ASSERT_TRUE(writer.begin(STORE_PATH));
+        writeFixes(writer, 0, 3 * TRACK_STORE_BLOCK_FIXES);
+    }
+
+    TrackStoreReader first;
+    TEST_ASSERT_TRUE(first.open(STORE_PATH));
+    size_t second = first.blocks()[1].offset;
+    first.close();
+
+    // Flip a column byte in the second block
+    int fd = open(STORE_PATH, O_RDWR);
+    uint8_t byte;
+    TEST_ASSERT_EQUAL(1, pread(fd, &byte, 1, second + TRACK_STORE_HEADER_SIZE + 5));
+    byte ^= 0x01;
+    TEST_ASSERT_EQUAL(1, pwrite(fd, &byte, 1, second + TRACK_STORE_HEADER_SIZE + 5));
+    close(fd);
+
+    TrackStoreReader reader;
+    TEST_ASSERT_TRUE(reader.open(STORE_PATH));
+    TEST_ASSERT_TRUE(reader.truncated());
+    TEST_ASSERT_EQUAL(1, reader.blocks().size());
+}
+
+void test_empty_and_missing_files(void) {
+    TrackStoreReader reader;
+    TEST_ASSERT_FALSE(reader.open("does_not_exist.uct"));
+
+    TrackStoreWriter writer;
+    TEST_ASSERT_TRUE(writer.begin(STORE_PATH));
+    TEST_ASSERT_TRUE(writer.flush());
+    TEST_ASSERT_TRUE(reader.open(STORE_PATH));
+    TEST_ASSERT_EQUAL(0, reader.blocks().size());
+    std::vector<StoredFix> out;
+    TEST_ASSERT_EQUAL(0, reader.query(0, 0xFFFFFFFF, out));
+}
+
+// ============================================================================
+// Store Tests
+// ============================================================================
+
+void test_store_keeps_collars_apart(void) {
+    TrackStore store(".");
+    for (uint32_t i = 0; i < 1000; i++) {
+        StoredFix stored = fixAt(i);
+        TEST_ASSERT_TRUE(store.append(0xA1, stored.fix, stored.fenceState));
+        if (i % 2 == 0) {
+            stored.fix.latE6 = -stored.fix.latE6;
+            TEST_ASSERT_TRUE(store.append(0xB2, stored.fix, stored.fenceState));
+        }
+    }
+    TEST_ASSERT_TRUE(store.flush());
+
+    TrackStoreReader a;
+    TrackStoreReader b;
+    TEST_ASSERT_TRUE(a.open(store.collarPath(0xA1).c_str()));
+    TEST_ASSERT_TRUE(b.open(store.collarPath(0xB2).c_str()));
+    TEST_ASSERT_EQUAL_UINT64(1000, a.fixCount());
+    TEST_ASSERT_EQUAL_UINT64(500, b.fixCount());
+    TEST_ASSERT_LESS_THAN(0, b.blocks()[0].maxLatE6);
+
+    unlink(store.collarPath(0xA1).c_str());
+    unlink(store.collarPath(0xB2).c_str());
+}
+
+void test_store_starts_segment_after_reboot(void) {
+    TrackStore store(".");
+    unlink(store.collarPath(0xC3, 0).c_str());
+    unlink(store.collarPath(0xC3, 1).c_str());
+
+    // 200 fixes, then the collar reboots and its wake clock starts over
+    for (uint32_t i = 0; i < 200; i++) {
+        StoredFix stored = fixAt(i);
+        TEST_ASSERT_TRUE(store.append(0xC3, stored.fix, stored.fenceState));
+    }
+    for (uint32_t i = 0; i < 100; i++) {
+        StoredFix stored = fixAt(i);
+        TEST_ASSERT_TRUE(store.append(0xC3, stored.fix, stored.fenceState));
+    }
+    TEST_ASSERT_TRUE(store.flush());
+    TEST_ASSERT_EQUAL_UINT32(2, store.segmentCount(0xC3));
+
+    TrackStoreReader before;
+    TrackStoreReader after;
+    TEST_ASSERT_TRUE(before.open(store.collarPath(0xC3, 0).c_str()));
+    TEST_ASSERT_TRUE(after.open(store.collarPath(0xC3, 1).c_str()));
+    TEST_ASSERT_EQUAL_UINT64(200, before.fixCount());
+    TEST_ASSERT_EQUAL_UINT64(100, after.fixCount());
+    std::vector<StoredFix> out;
+    TEST_ASSERT_EQUAL(100, after.query(0, 0xFFFFFFFF, out));
+    assertSameFix(fixAt(0), out[0]);
+    assertSameFix(fixAt(99), out[99]);
+
+    // After a base station restart the collar carries on in its newest segment
+    {
+        TrackStore restarted(".");
+        for (uint32_t i = 100; i < 150; i++) {
+            StoredFix stored = fixAt(i);
+            TEST_ASSERT_TRUE(restarted.append(0xC3, stored.fix, stored.fenceState));
+        }
+        TEST_ASSERT_TRUE(restarted.flush());
+        TEST_ASSERT_EQUAL_UINT32(2, restarted.segmentCount(0xC3));
+    }
+    TEST_ASSERT_TRUE(after.open(store.collarPath(0xC3, 1).c_str()));
+    TEST_ASSERT_EQUAL_UINT64(150, after.fixCount());
+
+    unlink(store.collarPath(0xC3, 0).c_str());
+    unlink(store.collarPath(0xC3, 1).c_str());
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    unlink(STORE_PATH);
+}
+
+void tearDown(void) {
+    unlink(STORE_PATH);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Block codec tests
+    RUN_TEST(test_block_round_trip_extremes);
+    RUN_TEST(test_steady_walk_compresses);
+    RUN_TEST(test_encode_rejects_bad_input);
+    RUN_TEST(test_corrupt_block_fails_check);
+
+    // Reader / writer tests
+    RUN_TEST(test_query_across_blocks);
+    RUN_TEST(test_count_outside_matches_decode);
+    RUN_TEST(test_writer_continues_file);
+    RUN_TEST(test_torn_block_is_dropped);
+    RUN_TEST(test_corrupt_block_ends_file);
+    RUN_TEST(test_empty_and_missing_files);
+
+    // Store tests
+    RUN_TEST(test_store_keeps_collars_apart);
+    RUN_TEST(test_store_starts_segment_after_reboot);
+
+    return UNITY_END();
+}
@@ -0,0 +1,123 @@
+/**
+ * @file test_wake_gate.cpp
+ * @brief Unit tests for the wake_gate skip budget.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "wake_gate.h"
+
+// ============================================================================
+// Test Data
+// ============================================================================
+
+WakeGateState state;
+
+// 10 m/s at 5 s per wake: 50 m of travel per wake, 10 m margin
+const WakeGateConfig config = DEFAULT_WAKE_GATE_CONFIG;
+
+// ============================================================================
+// Planning Tests
+// ============================================================================
+
+void test_zero_state_never_skips(void) {
+    TEST_ASSERT_FALSE(wakeGateTrySkip(state));
+}
+
+void test_near_fence_gives_no_budget(void) {
+    TEST_ASSERT_EQUAL_UINT16(0, wakeGatePlan(state, config, 5.0f, true));
+    TEST_ASSERT_EQUAL_UINT16(0, wakeGatePlan(state, config, 100.0f, true));
+    TEST_ASSERT_FALSE(wakeGateTrySkip(state));
+}
+
+void test_outside_gives_no_budget(void) {
+    TEST_ASSERT_EQUAL_UINT16(0, wakeGatePlan(state, config, -20.0f, true));
+}
+
+void test_budget_grows_with_distance(void) {
+    // (210 - 10) / 50 - 1 = 3
+    TEST_ASSERT_EQUAL_UINT16(3, wakeGatePlan(state, config, 210.0f, true));
+    // (400 - 10) / 50 - 1 = 6.8
+    TEST_ASSERT_EQUAL_UINT16(6, wakeGatePlan(state, config, 400.0f, true));
+}
+
+void test_budget_is_capped(void) {
+    TEST_ASSERT_EQUAL_UINT16(config.maxSkippedWakes, wakeGatePlan(state, config, 5000.0f, true));
+}
+
+void test_disallowed_gives_no_budget(void) {
+    TEST_ASSERT_EQUAL_UINT16(0, wakeGatePlan(state, config, 5000.0f, false));
+    TEST_ASSERT_FALSE(wakeGateTrySkip(state));
+}
+
+// ============================================================================
+// Wake Stub Tests
+// ============================================================================
+
+void test_skip_spends_budget(void) {
+    wakeGatePlan(state, config, 210.0f, true);
+    TEST_ASSERT_TRUE(wakeGateTrySkip(state));
+    TEST_ASSERT_TRUE(wakeGateTrySkip(state));
+    TEST_ASSERT_TRUE(wakeGateTrySkip(state));
+    TEST_ASSERT_FALSE(wakeGateTrySkip(state));
+    TEST_ASSERT_EQUAL_UINT32(3, state.skippedWakes);
+}
+
+void test_motion_cancels_budget(void) {
+    wakeGatePlan(state, config, 5000.0f, true);
+    TEST_ASSERT_TRUE(wakeGateTrySkip(state));
+    wakeGateReportMotion(state);
+    TEST_ASSERT_FALSE(wakeGateTrySkip(state));
+}
+
+void test_plan_resets_counters(void) {
+    wakeGatePlan(state, config, 5000.0f, true);
+    wakeGateTrySkip(state);
+    wakeGateReportMotion(state);
+
+    wakeGatePlan(state, config, 5000.0f, true);
+    TEST_ASSERT_EQUAL_UINT32(0, state.skippedWakes);
+    TEST_ASSERT_TRUE(wakeGateTrySkip(state));
+}
+
+void test_corrupt_state_never_skips(void) {
+    wakeGatePlan(state, config, 5000.0f, true);
+    state.magic = 0xDEADBEEF;
+    TEST_ASSERT_FALSE(wakeGateTrySkip(state));
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    memset(&state, 0, sizeof(state));
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Planning tests
+    RUN_TEST(test_zero_state_never_skips);
+    RUN_TEST(test_near_fence_gives_no_budget);
+    RUN_TEST(test_outside_gives_no_budget);
+    RUN_TEST(test_budget_grows_with_distance);
+    RUN_TEST(test_budget_is_capped);
+    RUN_TEST(test_disallowed_gives_no_budget);
+
+    // Wake stub tests
+    RUN_TEST(test_skip_spends_budget);
+    RUN_TEST(test_motion_cancels_budget);
+    RUN_TEST(test_plan_resets_counters);
+    RUN_TEST(test_corrupt_state_never_skips);
+
+    return UNITY_END();
+}
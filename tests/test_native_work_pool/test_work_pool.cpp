@@ -0,0 +1,115 @@
+/**
+ * @file test_work_pool.cpp
+ * @brief Unit and thread tests for the work-stealing pool.
+ *
+ * Run with: pio test -e native
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <unity.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "work_pool.h"
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+void test_every_task_runs_exactly_once(void) {
+    WorkStealingPool pool(4);
+    std::vector<std::atomic<int>> runs(1000);
+    for (std::atomic<int>& count : runs) {
+        count = 0;
+    }
+
+    pool.run(runs.size(), [&](size_t task) { runs[task]++; });
+
+    for (size_t i = 0; i < runs.size(); i++) {
+        TEST_ASSERT_EQUAL_INT(1, runs[i].load());
+    }
+}
+
+void test_fewer_tasks_than_threads(void) {
+    WorkStealingPool pool(8);
+    std::atomic<int> total(0);
+    pool.run(3, [&](size_t task) { total += static_cast<int>(task) + 1; });
+    TEST_ASSERT_EQUAL_INT(6, total.load());
+
+    // An empty batch returns at once
+    pool.run(0, [&](size_t) { total = -1; });
+    TEST_ASSERT_EQUAL_INT(6, total.load());
+}
+
+void test_single_thread_runs_in_order(void) {
+    WorkStealingPool pool(1);
+    std::vector<size_t> order;
+    pool.run(50, [&](size_t task) { order.push_back(task); });
+
+    TEST_ASSERT_EQUAL_UINT(50, order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        TEST_ASSERT_EQUAL_UINT(i, order[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT(0, pool.stealCount());
+}
+
+// The first worker's block is slow: the others finish theirs and steal it
+void test_idle_workers_steal(void) {
+    WorkStealingPool pool(4);
+    std::atomic<int> done(0);
+
+    pool.run(64, [&](size_t task) {
+        if (task < 16) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        done++;
+    });
+
+    TEST_ASSERT_EQUAL_INT(64, done.load());
+    TEST_ASSERT_TRUE(pool.stealCount() > 0);
+}
+
+// Batches run back to back see only their own function
+void test_many_batches(void) {
+    WorkStealingPool pool(4);
+    for (int batch = 0; batch < 500; batch++) {
+        std::atomic<int> sum(0);
+        size_t tasks = static_cast<size_t>(batch % 7) + 1;
+        pool.run(tasks, [&sum, batch](size_t) { sum += batch; });
+        TEST_ASSERT_EQUAL_INT(batch * static_cast<int>(tasks), sum.load());
+    }
+}
+
+void test_default_thread_count(void) {
+    WorkStealingPool pool;
+    TEST_ASSERT_TRUE(pool.threadCount() >= 1);
+    TEST_ASSERT_EQUAL_UINT(WorkStealingPool::defaultThreads(), pool.threadCount());
+}
+
+// ============================================================================
+// Test Runner
+// ============================================================================
+
+void setUp(void) {
+    // Set up code before each test (if needed)
+}
+
+void tearDown(void) {
+    // Clean up code after each test (if needed)
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_every_task_runs_exactly_once);
+    RUN_TEST(test_fewer_tasks_than_threads);
+    RUN_TEST(test_single_thread_runs_in_order);
+    RUN_TEST(test_idle_workers_steal);
+    RUN_TEST(test_many_batches);
+    RUN_TEST(test_default_thread_count);
+
+    return UNITY_END();
+}
@@ -0,0 +1,67 @@
+/**
+ * @file binlog_decode.cpp
+ * @brief Host-side decoder for the collar's binary log.
+ *
+ * Reads the raw byte stream drained over USB serial (a file or stdin) and
+ * prints one line per record, formatted with the message catalogue.
+ *
+ * Build and run:
+ *   g++ -std=c++11 -O2 -o binlog_decode tools/binlog_decode.cpp lib/binlog/binlog.cpp
+ *   ./binlog_decode /dev/ttyACM0
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "../lib/binlog/binlog.h"
+#include "../lib/binlog/log_messages.h"
+
+static const char* const LOG_FORMATS[] = {
+#define LOG_MESSAGE_FORMAT(id, format) format,
+    LOG_MESSAGES(LOG_MESSAGE_FORMAT)
+#undef LOG_MESSAGE_FORMAT
+};
+
+int main(int argc, char** argv) {
+    FILE* in = stdin;
+    if (argc > 1 && (in = fopen(argv[1], "rb")) == nullptr) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    uint8_t buffer[4096];
+    size_t len = 0;
+    char line[256];
+
+    for (;;) {
+        size_t n = fread(&buffer[len], 1, sizeof(buffer) - len, in);
+        if (n == 0) {
+            break;
+        }
+        len += n;
+
+        size_t pos = 0;
+        for (;;) {
+            BinLogRecord record;
+            bool found;
+            size_t used = binlogParse(&buffer[pos], len - pos, record, found);
+            pos += used;
+            if (!found) {
+                break;
+            }
+            binlogFormat(record, LOG_FORMATS, LOG_MESSAGE_COUNT, line, sizeof(line));
+            printf("[%10.3f] %s\n", record.timeMs / 1000.0, line);
+            fflush(stdout);
+        }
+
+        // Keep a partial record for the next read
+        memmove(buffer, &buffer[pos], len - pos);
+        len -= pos;
+    }
+
+    if (in != stdin) {
+        fclose(in);
+    }
+    return 0;
+}
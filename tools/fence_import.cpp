@@ -0,0 +1,240 @@
+/**
+ * @file fence_import.cpp
+ * @brief Host-side import of GeoJSON / KML fences into collar blobs.
+ *
+ * Stream-parses a GeoJSON or KML file (a drawn fence or a county parcel
+ * export), lists the polygons found and writes one of them as a
+ * CRC-checked FenceStore blob for the collar's fence partition. The
+ * format is taken from the first character of the file. Fences can be
+ * simplified on the way to fit the collar's vertex budget, and are
+ * repaired (see fence_validate.h) before they are written.
+ *
+ * Build and run:
+ *   g++ -std=c++11 -O2 -o fence_import tools/fence_import.cpp \
+ *       lib/fence_import/fence_import.cpp lib/fence_store/fence_store.cpp \
+ *       lib/fence_simplify/fence_simplify.cpp lib/checksum/checksum.cpp \
+ *       lib/fence_validate/fence_validate.cpp lib/point_in_polygon/point_in_polygon.cpp
+ *   ./fence_import parcels.geojson --list
+ *   ./fence_import pasture.kml --fence 0 --id 7 --max-vertices 16 --mode inner --out pasture.bin
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "../lib/fence_import/fence_import.h"
+#include "../lib/fence_simplify/fence_simplify.h"
+#include "../lib/fence_validate/fence_validate.h"
+#include "../lib/fence_store/fence_store.h"
+
+// ============================================================================
+// Options
+// ============================================================================
+
+struct ImportOptions {
+    const char* inputPath;
+    const char* outPath;
+    bool list;
+    size_t fence;               ///< Index among the imported fences
+    uint32_t id;
+    FenceSimplifyOptions simplify;
+};
+
+static void usage() {
+    fprintf(stderr,
+            "usage: fence_import [options] file\n"
+            "  --list             print every imported fence\n"
+            "  --fence N          fence to write (default: 0, the first)\n"
+            "  --id ID            fence id stored in the blob (default: 1)\n"
+            "  --out FILE         write the fence as a FenceStore blob\n"
+            "  --max-vertices N   simplify every fence to at most N vertices\n"
+            "  --tolerance M      simplify while the boundary moves at most M meters\n"
+            "  --mode MODE        any, inner (inside the original) or outer (default: any)\n"
+            "file is GeoJSON or KML; holes are skipped, rings turned counter-clockwise\n");
+}
+
+static bool parseArgs(int argc, char** argv, ImportOptions& options) {
+    options.inputPath = nullptr;
+    options.outPath = nullptr;
+    options.list = false;
+    options.fence = 0;
+    options.id = 1;
+    options.simplify.maxVertices = 0;
+    options.simplify.toleranceMeters = 0.0f;
+    options.simplify.mode = FenceSimplifyMode::ANY;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(arg, "--list") == 0) {
+            options.list = true;
+        } else if (strcmp(arg, "--fence") == 0 && hasValue) {
+            options.fence = static_cast<size_t>(atol(argv[++i]));
+        } else if (strcmp(arg, "--id") == 0 && hasValue) {
+            options.id = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 0));
+        } else if (strcmp(arg, "--out") == 0 && hasValue) {
+            options.outPath = argv[++i];
+        } else if (strcmp(arg, "--max-vertices") == 0 && hasValue) {
+            options.simplify.maxVertices = static_cast<size_t>(atol(argv[++i]));
+        } else if (strcmp(arg, "--tolerance") == 0 && hasValue) {
+            options.simplify.toleranceMeters = static_cast<float>(atof(argv[++i]));
+        } else if (strcmp(arg, "--mode") == 0 && hasValue) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "inner") == 0) {
+                options.simplify.mode = FenceSimplifyMode::INNER;
+            } else if (strcmp(mode, "outer") == 0) {
+                options.simplify.mode = FenceSimplifyMode::OUTER;
+            } else if (strcmp(mode, "any") != 0) {
+                return false;
+            }
+        } else if (arg[0] != '-' && options.inputPath == nullptr) {
+            options.inputPath = arg;
+        } else {
+            return false;
+        }
+    }
+    return options.inputPath != nullptr;
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+static void printFence(size_t index, const ImportedFence& fence) {
+    const Polygon polygon(fence.vertices.data(), fence.vertices.size());
+    printf("%6lu  polygon %-6lu %5lu vertices  lat %.6f..%.6f  lon %.6f..%.6f\n",
+           (unsigned long)index, (unsigned long)fence.polygon,
+           (unsigned long)fence.vertices.size(), polygon.minLat(), polygon.maxLat(),
+           polygon.minLon(), polygon.maxLon());
+}
+
+/**
+ * Simplify every fence in place; false if a fence is not simple or cannot
+ * meet the vertex budget
+ */
+static bool simplifyFences(std::vector<ImportedFence>& fences, const FenceSimplifyOptions& options) {
+    FenceSimplifier simplifier;
+    std::vector<GeoPoint> simplified;
+    size_t before = 0;
+    size_t after = 0;
+    float worst = 0.0f;
+    bool ok = true;
+    for (size_t f = 0; f < fences.size(); f++) {
+        std::vector<GeoPoint>& vertices = fences[f].vertices;
+        if (!simplifier.simplify(vertices.data(), vertices.size(), options, simplified)) {
+            fprintf(stderr, "fence %lu: over the vertex budget with %lu vertices (or not a simple ring)\n",
+                    (unsigned long)f, (unsigned long)simplified.size());
+            ok = false;
+        }
+        before += vertices.size();
+        after += simplified.size();
+        worst = std::max(worst, simplifier.stats().errorMeters);
+        vertices.swap(simplified);
+    }
+    fprintf(stderr, "simplified: %lu -> %lu vertices, boundary moved up to %.2f m\n", (unsigned long)before,
+            (unsigned long)after, worst);
+    return ok;
+}
+
+static bool writeBlob(const char* path, const std::vector<uint8_t>& blob) {
+    FILE* out = fopen(path, "wb");
+    if (out == nullptr) {
+        perror(path);
+        return false;
+    }
+    bool ok = fwrite(blob.data(), 1, blob.size(), out) == blob.size();
+    ok = fclose(out) == 0 && ok;
+    if (!ok) {
+        fprintf(stderr, "%s: write error\n", path);
+    }
+    return ok;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ImportOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    FenceImporter importer;
+    auto start = std::chrono::steady_clock::now();
+    bool ok = fenceImportFile(options.inputPath, importer);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!ok) {
+        if (importer.failed()) {
+            fprintf(stderr, "%s: malformed input at byte %llu\n", options.inputPath,
+                    (unsigned long long)importer.errorOffset());
+        } else {
+            fprintf(stderr, "%s: cannot read\n", options.inputPath);
+        }
+        return 1;
+    }
+
+    const FenceImportStats& stats = importer.stats();
+    std::vector<ImportedFence> fences = importer.fences();
+    fprintf(stderr,
+            "%s: %s, %.1f MB in %.3f s; %lu polygons, %lu fences, %lu holes skipped, "
+            "%lu degenerate, %lu reversed\n",
+            options.inputPath, importer.format() == FenceImportFormat::KML ? "KML" : "GeoJSON",
+            stats.bytes / 1e6, seconds, (unsigned long)stats.polygons, (unsigned long)fences.size(),
+            (unsigned long)stats.holes, (unsigned long)stats.degenerate,
+            (unsigned long)stats.reversed);
+
+    if (options.simplify.maxVertices != 0 || options.simplify.toleranceMeters > 0.0f) {
+        if (!simplifyFences(fences, options.simplify)) {
+            return 1;
+        }
+    }
+
+    if (options.list) {
+        for (size_t f = 0; f < fences.size(); f++) {
+            printFence(f, fences[f]);
+        }
+    }
+
+    if (options.outPath != nullptr) {
+        if (options.fence >= fences.size()) {
+            fprintf(stderr, "fence %lu: only %lu imported\n", (unsigned long)options.fence,
+                    (unsigned long)fences.size());
+            return 1;
+        }
+        // Repair here, so the collar keeps the fence as written and PATCH
+        // indices from the base station line up with its copy
+        std::vector<GeoPoint>& vertices = fences[options.fence].vertices;
+        size_t count = vertices.size();
+        FenceValidation validation = fenceValidateRepair(vertices.data(), count);
+        if (!fenceVerdictUsable(validation.verdict)) {
+            fprintf(stderr, "fence %lu: rejected (%s)\n", (unsigned long)options.fence,
+                    fenceVerdictName(validation.verdict));
+            return 1;
+        }
+        vertices.resize(count);
+        if (validation.verdict == FenceVerdict::REPAIRED) {
+            fprintf(stderr, "fence %lu: repaired, %lu vertices dropped%s\n", (unsigned long)options.fence,
+                    (unsigned long)validation.removed, validation.reversed ? ", reversed to counter-clockwise" : "");
+        }
+        std::vector<uint8_t> blob;
+        if (fenceImportEncode(fences[options.fence], options.id, blob) == 0) {
+            fprintf(stderr, "fence %lu: %lu vertices, the store holds up to %lu\n",
+                    (unsigned long)options.fence,
+                    (unsigned long)fences[options.fence].vertices.size(),
+                    (unsigned long)FENCE_STORE_MAX_VERTICES);
+            return 1;
+        }
+        if (!writeBlob(options.outPath, blob)) {
+            return 1;
+        }
+        fprintf(stderr, "%s: fence %lu (id %lu), %lu bytes\n", options.outPath,
+                (unsigned long)options.fence, (unsigned long)options.id,
+                (unsigned long)blob.size());
+    }
+    return 0;
+}
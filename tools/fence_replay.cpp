@@ -0,0 +1,307 @@
+/**
+ * @file fence_replay.cpp
+ * @brief Host-side replay of a recorded track against candidate fences.
+ *
+ * Streams a track through the fence replay engine on every core and
+ * prints per-fence statistics; crossings can be written out as CSV. Use it
+ * to check a new fence against months of recorded fixes before sending it
+ * to the collar.
+ *
+ * The track is either CSV ("timestamp,lat,lon" in decimal degrees, a
+ * header line is allowed) or, for any other extension, raw PositionFix
+ * records (latE6, lonE6, timestamp; 12 bytes, little-endian).
+ *
+ * Build and run:
+ *   g++ -std=c++11 -O2 -pthread -o fence_replay tools/fence_replay.cpp \
+ *       lib/fence_replay/fence_replay.cpp lib/point_in_polygon/point_in_polygon.cpp \
+ *       lib/position_codec/position_codec.cpp
+ *   ./fence_replay --fence yard.txt --fence paddock.txt --events crossings.csv track.csv
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "../lib/fence_replay/fence_replay.h"
+
+// Bytes read per batch; CSV batches are cut back to the last full line
+static const size_t READ_BYTES = 64UL * 1024 * 1024;
+
+// CSV parse tasks per batch and thread, so uneven lines still balance
+static const size_t PARSE_TASKS_PER_THREAD = 4;
+
+// ============================================================================
+// Options
+// ============================================================================
+
+struct ReplayOptions {
+    const char* trackPath;
+    const char* eventsPath;
+    std::vector<const char*> fencePaths;
+    size_t threads;             ///< 0: every hardware thread
+};
+
+static void usage() {
+    fprintf(stderr,
+            "usage: fence_replay [options] --fence FILE [--fence FILE ...] track\n"
+            "  --fence FILE       fence polygon, one 'lat,lon' vertex per line (up to 32)\n"
+            "  --events FILE      write every crossing as CSV\n"
+            "  --threads N        worker threads (default: all hardware threads)\n"
+            "track is 'timestamp,lat,lon' CSV (.csv) or raw 12-byte PositionFix records\n");
+}
+
+static bool parseArgs(int argc, char** argv, ReplayOptions& options) {
+    options.trackPath = nullptr;
+    options.eventsPath = nullptr;
+    options.threads = 0;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(arg, "--fence") == 0 && hasValue) {
+            options.fencePaths.push_back(argv[++i]);
+        } else if (strcmp(arg, "--events") == 0 && hasValue) {
+            options.eventsPath = argv[++i];
+        } else if (strcmp(arg, "--threads") == 0 && hasValue) {
+            options.threads = static_cast<size_t>(atoi(argv[++i]));
+        } else if (arg[0] != '-' && options.trackPath == nullptr) {
+            options.trackPath = arg;
+        } else {
+            return false;
+        }
+    }
+    return options.trackPath != nullptr && !options.fencePaths.empty() &&
+           options.fencePaths.size() <= FENCE_REPLAY_MAX_FENCES;
+}
+
+// ============================================================================
+// Fences
+// ============================================================================
+
+static char* trim(char* s) {
+    while (*s == ' ' || *s == '\t') {
+        s++;
+    }
+    char* end = s + strlen(s);
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+        *--end = '\0';
+    }
+    return s;
+}
+
+static bool loadFence(const char* path, std::vector<GeoPoint>& vertices) {
+    FILE* in = fopen(path, "r");
+    if (in == nullptr) {
+        perror(path);
+        return false;
+    }
+
+    char line[128];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), in) != nullptr) {
+        lineNumber++;
+        char* text = trim(line);
+        if (*text == '\0' || *text == '#') {
+            continue;
+        }
+        GeoPoint point;
+        if (sscanf(text, "%f , %f", &point.lat, &point.lon) != 2) {
+            fprintf(stderr, "%s:%d: expected 'lat,lon'\n", path, lineNumber);
+            fclose(in);
+            return false;
+        }
+        vertices.push_back(point);
+    }
+    fclose(in);
+
+    if (vertices.size() < 3) {
+        fprintf(stderr, "%s: a fence needs at least 3 vertices\n", path);
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Track Reading
+// ============================================================================
+
+static bool isCsv(const char* path) {
+    size_t length = strlen(path);
+    return length >= 4 && strcmp(path + length - 4, ".csv") == 0;
+}
+
+/**
+ * Next batch of raw PositionFix records; false at the end of the file
+ */
+static bool readBinary(FILE* in, std::vector<PositionFix>& fixes) {
+    fixes.resize(READ_BYTES / sizeof(PositionFix));
+    fixes.resize(fread(fixes.data(), sizeof(PositionFix), fixes.size(), in));
+    return !fixes.empty();
+}
+
+/**
+ * Next batch of CSV fixes, parsed on the pool; false at the end of the file
+ *
+ * A partial last line stays in @p text for the next batch.
+ */
+static bool readCsv(FILE* in, WorkStealingPool& pool, std::vector<char>& text, size_t& carried,
+                    std::vector<PositionFix>& fixes, size_t& malformed) {
+    text.resize(READ_BYTES);
+    size_t length = carried + fread(text.data() + carried, 1, text.size() - carried, in);
+    if (length == 0) {
+        return false;
+    }
+
+    // Whole lines only, unless this is the end of the file
+    size_t usable = length;
+    if (length == text.size()) {
+        while (usable > 0 && text[usable - 1] != '\n') {
+            usable--;
+        }
+        if (usable == 0) {
+            usable = length;    // One line longer than a batch: not a track
+        }
+    }
+
+    // Split at line starts and parse the pieces in parallel
+    size_t taskCount = pool.threadCount() * PARSE_TASKS_PER_THREAD;
+    std::vector<size_t> bounds(1, 0);
+    for (size_t i = 1; i < taskCount; i++) {
+        size_t at = usable * i / taskCount;
+        if (at < bounds.back()) {
+            at = bounds.back();
+        }
+        while (at < usable && text[at - 1] != '\n') {
+            at++;
+        }
+        bounds.push_back(at);
+    }
+    bounds.push_back(usable);
+
+    std::vector<std::vector<PositionFix>> parts(taskCount);
+    std::vector<size_t> partMalformed(taskCount, 0);
+    pool.run(taskCount, [&](size_t i) {
+        partMalformed[i] = fenceReplayParseCsv(text.data() + bounds[i], bounds[i + 1] - bounds[i],
+                                               parts[i]);
+    });
+
+    fixes.clear();
+    for (size_t i = 0; i < taskCount; i++) {
+        fixes.insert(fixes.end(), parts[i].begin(), parts[i].end());
+        malformed += partMalformed[i];
+    }
+
+    carried = length - usable;
+    memmove(text.data(), text.data() + usable, carried);
+    return true;
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+static void writeEvents(FILE* out, const std::vector<FenceCrossingEvent>& events) {
+    for (const FenceCrossingEvent& event : events) {
+        fprintf(out, "%llu,%lu,%u,%s,%.6f,%.6f\n", (unsigned long long)event.index,
+                (unsigned long)event.fix.timestamp, event.fence,
+                event.type == FenceCrossing::ENTRY ? "entry" : "exit",
+                event.fix.latE6 / 1e6, event.fix.lonE6 / 1e6);
+    }
+}
+
+static void printStats(const FenceReplay& replay, const ReplayOptions& options) {
+    printf("\n%-3s %-24s %8s %8s %8s %12s %12s\n", "#", "fence", "inside", "exits", "entries",
+           "outside h", "longest h");
+    for (size_t f = 0; f < replay.fenceCount(); f++) {
+        const FenceReplayStats& stats = replay.stats(f);
+        const char* name = strrchr(options.fencePaths[f], '/');
+        name = name != nullptr ? name + 1 : options.fencePaths[f];
+        printf("%-3lu %-24.24s %7.2f%% %8lu %8lu %12.2f %12.2f\n", (unsigned long)f, name,
+               100.0 * stats.insideFixes / (stats.insideFixes + stats.outsideFixes),
+               (unsigned long)stats.exits, (unsigned long)stats.entries,
+               stats.outsideSec / 3600.0, stats.longestExcursionSec / 3600.0);
+    }
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ReplayOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    // Loaded first: the polygons point into these vectors
+    std::vector<std::vector<GeoPoint>> vertices(options.fencePaths.size());
+    std::vector<Polygon> fences;
+    for (size_t f = 0; f < options.fencePaths.size(); f++) {
+        if (!loadFence(options.fencePaths[f], vertices[f])) {
+            return 1;
+        }
+    }
+    for (const std::vector<GeoPoint>& fence : vertices) {
+        fences.push_back(Polygon(fence.data(), fence.size()));
+    }
+
+    FILE* in = fopen(options.trackPath, "rb");
+    if (in == nullptr) {
+        perror(options.trackPath);
+        return 1;
+    }
+    FILE* eventsOut = nullptr;
+    if (options.eventsPath != nullptr) {
+        if ((eventsOut = fopen(options.eventsPath, "w")) == nullptr) {
+            perror(options.eventsPath);
+            fclose(in);
+            return 1;
+        }
+        fprintf(eventsOut, "index,timestamp,fence,type,lat,lon\n");
+    }
+
+    WorkStealingPool pool(options.threads);
+    FenceReplay replay(fences.data(), fences.size());
+    bool csv = isCsv(options.trackPath);
+    std::vector<char> text;
+    size_t carried = 0;
+    size_t malformed = 0;
+    std::vector<PositionFix> fixes;
+    std::vector<FenceCrossingEvent> events;
+
+    auto start = std::chrono::steady_clock::now();
+    while (csv ? readCsv(in, pool, text, carried, fixes, malformed) : readBinary(in, fixes)) {
+        events.clear();
+        replay.replay(pool, fixes.data(), fixes.size(), eventsOut != nullptr ? &events : nullptr);
+        if (eventsOut != nullptr) {
+            writeEvents(eventsOut, events);
+        }
+    }
+    replay.finish();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool readError = ferror(in) != 0;
+    fclose(in);
+    if (eventsOut != nullptr) {
+        fclose(eventsOut);
+    }
+    if (readError) {
+        fprintf(stderr, "%s: read error\n", options.trackPath);
+        return 1;
+    }
+
+    printf("%llu fixes, %lu fences, %lu threads, %.2f s (%.1f Mfix/s)\n",
+           (unsigned long long)replay.fixCount(), (unsigned long)fences.size(),
+           (unsigned long)pool.threadCount(), seconds,
+           seconds > 0 ? replay.fixCount() / seconds / 1e6 : 0.0);
+    if (malformed > 0) {
+        printf("%lu malformed lines skipped\n", (unsigned long)malformed);
+    }
+    if (replay.fixCount() > 0) {
+        printStats(replay, options);
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file fuzz_containment.cpp
+ * @brief libFuzzer target comparing the containment kernels to a reference.
+ *
+ * Each input is decoded into a polygon and a set of points (see
+ * containmentDecode()), and Polygon::contains() and pointInPolygon() are
+ * checked against the double-precision reference. A disagreement is
+ * minimized, printed as a Unity test body, and aborts so libFuzzer keeps
+ * the input.
+ *
+ * Fuzz (clang):
+ *   clang++ -std=c++11 -O1 -g -fsanitize=fuzzer,address,undefined -o fuzz_containment \
+ *       tools/fuzz_containment.cpp lib/containment_fuzz/containment_fuzz.cpp \
+ *       lib/point_in_polygon/point_in_polygon.cpp
+ *   ./fuzz_containment corpus/
+ *
+ * Replay crashes or write the seed corpus (any compiler):
+ *   g++ -std=c++11 -O2 -DCONTAINMENT_FUZZ_REPLAY -o fuzz_containment \
+ *       tools/fuzz_containment.cpp lib/containment_fuzz/containment_fuzz.cpp \
+ *       lib/point_in_polygon/point_in_polygon.cpp
+ *   ./fuzz_containment --seed-corpus corpus/ 2000
+ *   ./fuzz_containment crash-1234abcd
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "../lib/containment_fuzz/containment_fuzz.h"
+
+static void report(const ContainmentMismatch& mismatch) {
+    char text[4096];
+    containmentFormat(mismatch, text, sizeof(text));
+    fputs(text, stderr);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    ContainmentMismatch mismatch;
+    if (!containmentFuzzOne(data, size, mismatch)) {
+        report(mismatch);
+        abort();
+    }
+    return 0;
+}
+
+#ifdef CONTAINMENT_FUZZ_REPLAY
+
+// ============================================================================
+// Options
+// ============================================================================
+
+struct ReplayOptions {
+    const char* corpusDir;      ///< Write the seed corpus here instead of replaying
+    uint32_t seeds;
+    int firstInput;             ///< argv index of the first input to replay
+};
+
+static void usage() {
+    fprintf(stderr,
+            "usage: fuzz_containment file...           replay inputs\n"
+            "       fuzz_containment --seed-corpus DIR N  write seed inputs 0 to N-1\n");
+}
+
+static bool parseArgs(int argc, char** argv, ReplayOptions& options) {
+    options.corpusDir = nullptr;
+    options.seeds = 0;
+    options.firstInput = 1;
+    if (argc >= 2 && strcmp(argv[1], "--seed-corpus") == 0) {
+        if (argc != 4) {
+            return false;
+        }
+        options.corpusDir = argv[2];
+        options.seeds = static_cast<uint32_t>(strtoul(argv[3], nullptr, 0));
+        return options.seeds > 0;
+    }
+    return argc >= 2 && argv[1][0] != '-';
+}
+
+// ============================================================================
+// Corpus
+// ============================================================================
+
+static bool writeSeedCorpus(const char* dir, uint32_t seeds) {
+    std::vector<uint8_t> bytes;
+    char path[1024];
+    for (uint32_t seed = 0; seed < seeds; seed++) {
+        containmentSeed(seed, bytes);
+        snprintf(path, sizeof(path), "%s/seed-%05lu", dir, (unsigned long)seed);
+        FILE* out = fopen(path, "wb");
+        if (out == nullptr) {
+            fprintf(stderr, "%s: cannot write\n", path);
+            return false;
+        }
+        bool ok = fwrite(bytes.data(), 1, bytes.size(), out) == bytes.size();
+        ok = fclose(out) == 0 && ok;
+        if (!ok) {
+            fprintf(stderr, "%s: write error\n", path);
+            return false;
+        }
+    }
+    fprintf(stderr, "%s: %lu seed inputs\n", dir, (unsigned long)seeds);
+    return true;
+}
+
+static bool readFile(const char* path, std::vector<uint8_t>& bytes) {
+    FILE* in = fopen(path, "rb");
+    if (in == nullptr) {
+        return false;
+    }
+    bytes.clear();
+    uint8_t buffer[4096];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + got);
+    }
+    bool ok = !ferror(in);
+    fclose(in);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    ReplayOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+    if (options.corpusDir != nullptr) {
+        return writeSeedCorpus(options.corpusDir, options.seeds) ? 0 : 1;
+    }
+
+    int failures = 0;
+    std::vector<uint8_t> bytes;
+    for (int i = options.firstInput; i < argc; i++) {
+        if (!readFile(argv[i], bytes)) {
+            fprintf(stderr, "%s: cannot read\n", argv[i]);
+            return 1;
+        }
+        ContainmentMismatch mismatch;
+        if (containmentFuzzOne(bytes.data(), bytes.size(), mismatch)) {
+            printf("%s: ok\n", argv[i]);
+        } else {
+            printf("%s: mismatch\n", argv[i]);
+            report(mismatch);
+            failures++;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+#endif // CONTAINMENT_FUZZ_REPLAY
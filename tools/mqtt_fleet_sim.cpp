@@ -0,0 +1,346 @@
+/**
+ * @file mqtt_fleet_sim.cpp
+ * @brief Drives the base-station MQTT publisher with a simulated fleet.
+ *
+ * Generates position uplinks for a fleet of collars, feeds them through
+ * MqttPublisher and publishes to a real broker (a local mosquitto) or,
+ * without --host, to the in-process MemoryMqttBroker. Use it to see the
+ * topics and discovery in Home Assistant, or to watch what the coalescing
+ * and rate limit settings do to the broker's load.
+ *
+ * The broker connection is a minimal MQTT 3.1.1 client (CONNECT, QoS 0
+ * PUBLISH, PINGREQ) over a POSIX socket.
+ *
+ * Build and run:
+ *   g++ -std=c++11 -O2 -o mqtt_fleet_sim tools/mqtt_fleet_sim.cpp \
+ *       lib/mqtt_publisher/mqtt_publisher.cpp
+ *   mosquitto -v &
+ *   ./mqtt_fleet_sim --host 127.0.0.1 --collars 50 --minutes 10 --realtime
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../lib/mqtt_publisher/mqtt_publisher.h"
+
+static const uint32_t POLL_MS = 100;
+static const uint16_t KEEPALIVE_SEC = 60;
+
+// ============================================================================
+// MQTT Socket Client
+// ============================================================================
+
+/**
+ * Just enough MQTT 3.1.1 to publish at QoS 0
+ */
+class SocketMqttSink : public MqttSink {
+public:
+    SocketMqttSink() : _fd(-1), _lastSendMs(0), _nowMs(0) {}
+
+    ~SocketMqttSink() {
+        if (_fd >= 0) {
+            static const uint8_t DISCONNECT[] = {0xE0, 0x00};
+            writeAll(DISCONNECT, sizeof(DISCONNECT));
+            close(_fd);
+        }
+    }
+
+    bool connect(const char* host, const char* port, const char* clientId) {
+        addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* addresses = nullptr;
+        if (getaddrinfo(host, port, &hints, &addresses) != 0) {
+            fprintf(stderr, "mqtt: cannot resolve %s\n", host);
+            return false;
+        }
+        for (addrinfo* a = addresses; a != nullptr && _fd < 0; a = a->ai_next) {
+            _fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+            if (_fd >= 0 && ::connect(_fd, a->ai_addr, a->ai_addrlen) != 0) {
+                close(_fd);
+                _fd = -1;
+            }
+        }
+        freeaddrinfo(addresses);
+        if (_fd < 0) {
+            perror("mqtt: connect");
+            return false;
+        }
+
+        // CONNECT: protocol "MQTT" level 4, clean session, keepalive
+        size_t idLength = strlen(clientId);
+        uint8_t packet[64];
+        size_t length = 0;
+        static const uint8_t HEADER[] = {0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0x02};
+        memcpy(packet, HEADER, sizeof(HEADER));
+        length = sizeof(HEADER);
+        packet[length++] = KEEPALIVE_SEC >> 8;
+        packet[length++] = KEEPALIVE_SEC & 0xFF;
+        if (idLength > sizeof(packet) - length - 2) {
+            return false;
+        }
+        packet[length++] = static_cast<uint8_t>(idLength >> 8);
+        packet[length++] = static_cast<uint8_t>(idLength);
+        memcpy(packet + length, clientId, idLength);
+        length += idLength;
+        if (!writePacket(0x10, packet, length, nullptr, 0)) {
+            return false;
+        }
+
+        uint8_t connack[4];
+        if (!readAll(connack, sizeof(connack)) || connack[0] != 0x20 || connack[3] != 0) {
+            fprintf(stderr, "mqtt: broker refused the connection\n");
+            return false;
+        }
+        return true;
+    }
+
+    bool publish(const char* topic, const char* payload, size_t length, bool retain) override {
+        size_t topicLength = strlen(topic);
+        uint8_t header[2 + MQTT_TOPIC_MAX];
+        header[0] = static_cast<uint8_t>(topicLength >> 8);
+        header[1] = static_cast<uint8_t>(topicLength);
+        memcpy(header + 2, topic, topicLength);
+        return writePacket(retain ? 0x31 : 0x30, header, 2 + topicLength,
+                           reinterpret_cast<const uint8_t*>(payload), length);
+    }
+
+    /**
+     * Keep the connection alive while nothing else is sent
+     */
+    bool keepAlive(uint32_t nowMs) {
+        if (nowMs - _lastSendMs < KEEPALIVE_SEC * 500UL) {
+            return true;
+        }
+        _lastSendMs = nowMs;
+        static const uint8_t PINGREQ[] = {0xC0, 0x00};
+        return writeAll(PINGREQ, sizeof(PINGREQ));
+    }
+
+    void setClock(uint32_t nowMs) { _nowMs = nowMs; }
+
+private:
+    int _fd;
+    uint32_t _lastSendMs;
+    uint32_t _nowMs;
+
+    bool writeAll(const uint8_t* data, size_t length) {
+        while (length > 0) {
+            ssize_t written = write(_fd, data, length);
+            if (written <= 0) {
+                return false;
+            }
+            data += written;
+            length -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    bool readAll(uint8_t* data, size_t length) {
+        while (length > 0) {
+            ssize_t got = read(_fd, data, length);
+            if (got <= 0) {
+                return false;
+            }
+            data += got;
+            length -= static_cast<size_t>(got);
+        }
+        return true;
+    }
+
+    bool writePacket(uint8_t type, const uint8_t* head, size_t headLength,
+                     const uint8_t* body, size_t bodyLength) {
+        // Fixed header: type, then the remaining length as a varint
+        uint8_t fixed[5];
+        size_t fixedLength = 0;
+        size_t remaining = headLength + bodyLength;
+        fixed[fixedLength++] = type;
+        do {
+            uint8_t digit = remaining % 128;
+            remaining /= 128;
+            fixed[fixedLength++] = remaining > 0 ? (digit | 0x80) : digit;
+        } while (remaining > 0);
+
+        _lastSendMs = _nowMs;
+        return writeAll(fixed, fixedLength) && writeAll(head, headLength) &&
+               (bodyLength == 0 || writeAll(body, bodyLength));
+    }
+};
+
+// ============================================================================
+// Fleet
+// ============================================================================
+
+struct FleetOptions {
+    const char* host;
+    const char* port;
+    uint32_t collars;
+    double minutes;
+    uint32_t uplinkSec;
+    bool realtime;
+    MqttPublisherConfig config;
+};
+
+struct SimCollar {
+    int32_t latE6;
+    int32_t lonE6;
+    int32_t homeLatE6;
+    bool walking;
+};
+
+static uint32_t nextRandom(uint32_t& seed) {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+// Rest with GPS jitter, sometimes walk; beyond ~200 m north is outside
+static CollarUpdate stepCollar(SimCollar& collar, uint32_t id, uint32_t nowMs, uint32_t& seed) {
+    if (nextRandom(seed) % 50 == 0) {
+        collar.walking = !collar.walking && nextRandom(seed) % 5 == 0;
+    }
+    int32_t stride = collar.walking ? 300 : 40;
+    collar.latE6 += static_cast<int32_t>(nextRandom(seed) % (2 * stride + 1)) - stride;
+    collar.lonE6 += static_cast<int32_t>(nextRandom(seed) % (2 * stride + 1)) - stride;
+    collar.latE6 -= (collar.latE6 - collar.homeLatE6) / 64;
+
+    PacketFenceState state = collar.latE6 - collar.homeLatE6 > 2000 ? PacketFenceState::OUTSIDE
+                                                                    : PacketFenceState::INSIDE;
+    CollarUpdate update = {id, {collar.latE6, collar.lonE6, nowMs / 1000}, state,
+                           static_cast<uint8_t>(POSITION_BATTERY_MAX - nowMs / 3600000 % 4)};
+    return update;
+}
+
+static void usage() {
+    fprintf(stderr,
+            "usage: mqtt_fleet_sim [options]\n"
+            "  --host HOST        broker address (default: in-process broker)\n"
+            "  --port PORT        broker port (default 1883)\n"
+            "  --collars N        fleet size (default 100)\n"
+            "  --minutes M        simulated time (default 60)\n"
+            "  --uplink SEC       seconds between a collar's uplinks (default 5)\n"
+            "  --window MS        coalescing window (default %lu)\n"
+            "  --move M           minimum move in metres (default %.0f)\n"
+            "  --rate N           messages per second, 0 for no limit (default %lu)\n"
+            "  --realtime         run at wall-clock speed\n",
+            (unsigned long)DEFAULT_MQTT_PUBLISHER_CONFIG.windowMs,
+            DEFAULT_MQTT_PUBLISHER_CONFIG.minMoveMeters,
+            (unsigned long)DEFAULT_MQTT_PUBLISHER_CONFIG.maxMessagesPerSec);
+}
+
+static bool parseArgs(int argc, char** argv, FleetOptions& options) {
+    options.host = nullptr;
+    options.port = "1883";
+    options.collars = 100;
+    options.minutes = 60;
+    options.uplinkSec = 5;
+    options.realtime = false;
+    options.config = DEFAULT_MQTT_PUBLISHER_CONFIG;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(arg, "--host") == 0 && hasValue) {
+            options.host = argv[++i];
+        } else if (strcmp(arg, "--port") == 0 && hasValue) {
+            options.port = argv[++i];
+        } else if (strcmp(arg, "--collars") == 0 && hasValue) {
+            options.collars = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (strcmp(arg, "--minutes") == 0 && hasValue) {
+            options.minutes = atof(argv[++i]);
+        } else if (strcmp(arg, "--uplink") == 0 && hasValue) {
+            options.uplinkSec = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (strcmp(arg, "--window") == 0 && hasValue) {
+            options.config.windowMs = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (strcmp(arg, "--move") == 0 && hasValue) {
+            options.config.minMoveMeters = static_cast<float>(atof(argv[++i]));
+        } else if (strcmp(arg, "--rate") == 0 && hasValue) {
+            options.config.maxMessagesPerSec = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (strcmp(arg, "--realtime") == 0) {
+            options.realtime = true;
+        } else {
+            return false;
+        }
+    }
+    return options.collars > 0 && options.minutes > 0 && options.uplinkSec > 0;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+    FleetOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    MemoryMqttBroker memory;
+    SocketMqttSink socketSink;
+    MqttSink* sink = &memory;
+    if (options.host != nullptr) {
+        if (!socketSink.connect(options.host, options.port, "uncollar-fleet-sim")) {
+            return 1;
+        }
+        sink = &socketSink;
+    }
+
+    MqttPublisher publisher(*sink, options.config, options.collars);
+    std::vector<SimCollar> collars(options.collars);
+    for (uint32_t i = 0; i < options.collars; i++) {
+        int32_t lat = 40700000 + static_cast<int32_t>(i % 100) * 5000;
+        int32_t lon = -74000000 - static_cast<int32_t>(i / 100) * 5000;
+        collars[i] = {lat, lon, lat, false};
+    }
+
+    uint32_t seed = 1;
+    uint32_t uplinkMs = options.uplinkSec * 1000;
+    uint32_t endMs = static_cast<uint32_t>(options.minutes * 60000.0);
+    uint32_t uplinks = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t now = 0; now < endMs; now += POLL_MS) {
+        // Uplinks spread evenly over the interval
+        uint32_t slot = now % uplinkMs;
+        uint64_t first = static_cast<uint64_t>(slot) * options.collars / uplinkMs;
+        uint64_t last = static_cast<uint64_t>(slot + POLL_MS) * options.collars / uplinkMs;
+        for (uint64_t id = first; id < last && id < options.collars; id++) {
+            publisher.update(stepCollar(collars[id], static_cast<uint32_t>(id), now, seed), now);
+            uplinks++;
+        }
+
+        socketSink.setClock(now);
+        publisher.poll(now);
+        if (options.host != nullptr && !socketSink.keepAlive(now)) {
+            fprintf(stderr, "mqtt: connection lost\n");
+            return 1;
+        }
+        if (options.realtime) {
+            std::this_thread::sleep_until(start + std::chrono::milliseconds(now + POLL_MS));
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const MqttPublisherStats& stats = publisher.stats();
+    double simSeconds = endMs / 1000.0;
+    printf("%lu collars, %.0f min simulated in %.2f s\n", (unsigned long)options.collars,
+           simSeconds / 60, seconds);
+    printf("uplinks     %8lu  (%.1f/s)\n", (unsigned long)uplinks, uplinks / simSeconds);
+    printf("messages    %8lu  (%.1f/s, %.1f%% of uplinks)\n", (unsigned long)stats.messages,
+           stats.messages / simSeconds, 100.0 * stats.messages / uplinks);
+    printf("discoveries %8lu\n", (unsigned long)stats.discoveries);
+    printf("coalesced   %8lu\n", (unsigned long)stats.coalesced);
+    printf("suppressed  %8lu\n", (unsigned long)stats.suppressed);
+    printf("deferred    %8lu  (polls that hit the rate limit)\n", (unsigned long)stats.deferred);
+    printf("errors      %8lu\n", (unsigned long)stats.sinkErrors);
+    if (options.host == nullptr) {
+        printf("topics      %8lu  (in-process broker)\n", (unsigned long)memory.topicCount());
+    }
+    return 0;
+}
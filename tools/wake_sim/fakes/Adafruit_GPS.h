@@ -0,0 +1,51 @@
+/**
+ * @file Adafruit_GPS.h
+ * @brief Wake simulator stand-in for the Adafruit GPS library, talking to
+ *        the simulated PA1010D.
+ *
+ * The module replays an NMEA trace (tools/wake_sim/sim_gps.cpp); this
+ * class reads it byte by byte and parses GGA and RMC into the same public
+ * fields the real library fills in.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_SIM_ADAFRUIT_GPS_H
+#define WAKE_SIM_ADAFRUIT_GPS_H
+
+#include <stdint.h>
+#include "Wire.h"
+
+#define PMTK_STANDBY "$PMTK161,0*28"
+#define PMTK_AWAKE "$PMTK010,002*2D"
+
+#define MAXLINELENGTH 120
+
+class Adafruit_GPS {
+public:
+    explicit Adafruit_GPS(TwoWire* wire);
+
+    bool begin(uint32_t address);
+    void sendCommand(const char* command);
+
+    char read();
+    bool newNMEAreceived();
+    char* lastNMEA();
+    bool parse(char* nmea);
+
+    bool fix;
+    float latitude;     ///< DDMM.MMMM
+    float longitude;    ///< DDDMM.MMMM
+    char lat;           ///< 'N' or 'S'
+    char lon;           ///< 'E' or 'W'
+    float HDOP;
+    uint8_t satellites;
+
+private:
+    char _lines[2][MAXLINELENGTH];
+    uint8_t _current;
+    uint8_t _length;
+    bool _received;
+};
+
+#endif // WAKE_SIM_ADAFRUIT_GPS_H
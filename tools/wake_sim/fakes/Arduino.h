@@ -0,0 +1,77 @@
+/**
+ * @file Arduino.h
+ * @brief Wake simulator stand-in for the Arduino-ESP32 core.
+ *
+ * Only what the firmware and its libraries use. Time comes from the
+ * simulator's virtual clock: millis() restarts on every wake, and
+ * gettimeofday() keeps counting across deep sleep like the RTC timer.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_SIM_ARDUINO_H
+#define WAKE_SIM_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// ============================================
+// ATTRIBUTES
+// ============================================
+
+// RTC slow memory: a named section the simulator saves on deep sleep and
+// restores on the next wake; everything else starts from scratch
+#define RTC_DATA_ATTR __attribute__((section("rtc_sim")))
+#define RTC_IRAM_ATTR
+#define IRAM_ATTR
+
+// ============================================
+// GPIO
+// ============================================
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define RISING 0x01
+#define FALLING 0x02
+
+#define digitalPinToInterrupt(pin) (pin)
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+// ============================================
+// TIME
+// ============================================
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// Virtual RTC time (see file comment)
+int simGettimeofday(struct timeval* tv, void* tz);
+#define gettimeofday simGettimeofday
+
+// ============================================
+// MISC
+// ============================================
+
+bool btStop();
+
+void setup();
+void loop();
+
+#endif // WAKE_SIM_ARDUINO_H
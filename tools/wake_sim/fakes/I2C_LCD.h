@@ -0,0 +1,25 @@
+/**
+ * @file I2C_LCD.h
+ * @brief Wake simulator stand-in for the debug LCD (not fitted).
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_SIM_I2C_LCD_H
+#define WAKE_SIM_I2C_LCD_H
+
+#include <stdint.h>
+#include "Wire.h"
+
+class I2C_LCD {
+public:
+    I2C_LCD(uint8_t address, TwoWire* wire) {}
+    bool begin(uint8_t columns, uint8_t rows) { return false; }
+    void backlight() {}
+    void clear() {}
+    void setCursor(uint8_t column, uint8_t row) {}
+    size_t print(const char*) { return 0; }
+    size_t print(double, int = 2) { return 0; }
+};
+
+#endif // WAKE_SIM_I2C_LCD_H
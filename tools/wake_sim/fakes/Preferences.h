@@ -0,0 +1,45 @@
+/**
+ * @file Preferences.h
+ * @brief Wake simulator stand-in for NVS-backed Preferences.
+ *
+ * Values live in the simulator's shared state, so they persist across
+ * simulated wakes like NVS does across deep sleep.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_SIM_PREFERENCES_H
+#define WAKE_SIM_PREFERENCES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Preferences {
+public:
+    Preferences();
+
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+    bool isKey(const char* key);
+    bool clear();
+
+    float getFloat(const char* key, float defaultValue = 0.0f);
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0);
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+
+    size_t putFloat(const char* key, float value);
+    size_t putUChar(const char* key, uint8_t value);
+    size_t putUInt(const char* key, uint32_t value);
+    size_t putBytes(const char* key, const void* value, size_t len);
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+private:
+    bool get(const char* key, void* value, size_t size);
+    size_t put(const char* key, const void* value, size_t size);
+
+    char _namespace[16];
+    bool _open;
+};
+
+#endif // WAKE_SIM_PREFERENCES_H
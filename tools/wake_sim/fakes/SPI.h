@@ -0,0 +1,34 @@
+/**
+ * @file SPI.h
+ * @brief Wake simulator stand-in for the Arduino SPI API.
+ *
+ * Transfers go to the simulated SX1276 while its chip select (pin 9, as
+ * wired in src/main.cpp) is low.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_SIM_SPI_H
+#define WAKE_SIM_SPI_H
+
+#include <stdint.h>
+
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+class SPISettings {
+public:
+    SPISettings(uint32_t clockHz, uint8_t bitOrder, uint8_t dataMode) {}
+};
+
+class SPIClass {
+public:
+    void begin() {}
+    void beginTransaction(const SPISettings&) {}
+    void endTransaction() {}
+    uint8_t transfer(uint8_t value);
+};
+
+extern SPIClass SPI;
+
+#endif // WAKE_SIM_SPI_H
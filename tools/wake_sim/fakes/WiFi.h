@@ -0,0 +1,21 @@
+/**
+ * @file WiFi.h
+ * @brief Wake simulator stand-in; WiFi is never modelled (always off).
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_SIM_WIFI_H
+#define WAKE_SIM_WIFI_H
+
+typedef enum { WIFI_OFF = 0, WIFI_STA } wifi_mode_t;
+
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t) { return true; }
+    bool disconnect(bool = false) { return true; }
+};
+
+extern WiFiClass WiFi;
+
+#endif // WAKE_SIM_WIFI_H
@@ -0,0 +1,32 @@
+/**
+ * @file Wire.h
+ * @brief Wake simulator stand-in for the Arduino I2C API.
+ *
+ * The simulated bus has no devices on it except the GPS, which is modelled
+ * at the Adafruit_GPS level: every other address NACKs, so the optional
+ * IMU and the LCD are absent.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_SIM_WIRE_H
+#define WAKE_SIM_WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class TwoWire {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) { return true; }
+    void beginTransmission(uint8_t address) {}
+    size_t write(uint8_t value) { return 1; }
+    uint8_t endTransmission(bool sendStop = true) { return 2; }    // Address NACK
+    uint8_t requestFrom(uint8_t address, uint8_t length) { return 0; }
+    int available() { return 0; }
+    int read() { return -1; }
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif // WAKE_SIM_WIRE_H
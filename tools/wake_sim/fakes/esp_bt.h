@@ -0,0 +1,12 @@
+/**
+ * @file esp_bt.h
+ * @brief Wake simulator stand-in; Bluetooth is never modelled (btStop()
+ *        is declared in Arduino.h, as in the real core).
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_SIM_ESP_BT_H
+#define WAKE_SIM_ESP_BT_H
+
+#endif // WAKE_SIM_ESP_BT_H
@@ -0,0 +1,16 @@
+/**
+ * @file esp_err.h
+ * @brief Wake simulator stand-in for ESP-IDF error codes.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_SIM_ESP_ERR_H
+#define WAKE_SIM_ESP_ERR_H
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+#endif // WAKE_SIM_ESP_ERR_H
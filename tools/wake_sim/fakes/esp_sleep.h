@@ -0,0 +1,51 @@
+/**
+ * @file esp_sleep.h
+ * @brief Wake simulator stand-in for the ESP-IDF sleep API.
+ *
+ * Light sleep advances the virtual clock with the SoC in light sleep.
+ * Deep sleep ends the simulated wake: RTC memory is saved and the
+ * simulator schedules the next wake from the enabled timer.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_SIM_ESP_SLEEP_H
+#define WAKE_SIM_ESP_SLEEP_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+typedef enum {
+    ESP_SLEEP_WAKEUP_UNDEFINED = 0,
+    ESP_SLEEP_WAKEUP_ALL,
+    ESP_SLEEP_WAKEUP_EXT0,
+    ESP_SLEEP_WAKEUP_EXT1,
+    ESP_SLEEP_WAKEUP_TIMER,
+} esp_sleep_wakeup_cause_t;
+
+typedef enum {
+    ESP_PD_DOMAIN_RTC_PERIPH = 0,
+    ESP_PD_DOMAIN_RTC8M,
+    ESP_PD_DOMAIN_RC_FAST = ESP_PD_DOMAIN_RTC8M,
+    ESP_PD_DOMAIN_XTAL,
+} esp_sleep_pd_domain_t;
+
+typedef enum {
+    ESP_PD_OPTION_OFF = 0,
+    ESP_PD_OPTION_ON,
+    ESP_PD_OPTION_AUTO
+} esp_sleep_pd_option_t;
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause();
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs);
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t gpio, int level);
+esp_err_t esp_sleep_pd_config(esp_sleep_pd_domain_t domain, esp_sleep_pd_option_t option);
+esp_err_t esp_light_sleep_start();
+void esp_deep_sleep_start() __attribute__((noreturn));
+
+// Deep sleep wake stub, defined by the firmware when it has one
+void esp_wake_deep_sleep(void);
+void esp_default_wake_deep_sleep(void);
+
+#endif // WAKE_SIM_ESP_SLEEP_H
@@ -0,0 +1,50 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Wake simulator stand-in for the FreeRTOS task, notification and
+ *        semaphore API.
+ *
+ * Tasks are host threads run in lock-step on the virtual clock: exactly
+ * one runs at a time, and the clock only moves while every task waits
+ * (see tools/wake_sim/sim_rtos.cpp). The tick is 1 ms, as on the collar.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_SIM_FREERTOS_H
+#define WAKE_SIM_FREERTOS_H
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef void (*TaskFunction_t)(void*);
+
+struct SimTask;
+struct SimSemaphore;
+typedef SimTask* TaskHandle_t;
+typedef SimSemaphore* SemaphoreHandle_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFFu
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+
+SemaphoreHandle_t xSemaphoreCreateBinary();
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+
+#endif // WAKE_SIM_FREERTOS_H
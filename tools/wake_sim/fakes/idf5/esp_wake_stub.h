@@ -0,0 +1,24 @@
+/**
+ * @file esp_wake_stub.h
+ * @brief Wake simulator stand-in for the ESP-IDF 5.1 wake stub helpers.
+ *
+ * Only on the include path when simulating an IDF 5.1+ build (see the
+ * wake simulator README); without it the firmware skips wakes from
+ * setup(), after a full boot.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_SIM_ESP_WAKE_STUB_H
+#define WAKE_SIM_ESP_WAKE_STUB_H
+
+#include <stdint.h>
+#include <esp_sleep.h>
+
+typedef void (*esp_deep_sleep_wake_stub_fn_t)(void);
+
+uint32_t esp_wake_stub_get_wakeup_cause(void);
+void esp_wake_stub_set_wakeup_time(uint64_t timeUs);
+void esp_wake_stub_sleep(esp_deep_sleep_wake_stub_fn_t stub) __attribute__((noreturn));
+
+#endif // WAKE_SIM_ESP_WAKE_STUB_H
@@ -0,0 +1,14 @@
+/**
+ * @file rtc.h
+ * @brief Wake simulator stand-in for the RTC wakeup cause bits.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_SIM_SOC_RTC_H
+#define WAKE_SIM_SOC_RTC_H
+
+#define RTC_EXT0_TRIG_EN 0x1
+#define RTC_TIMER_TRIG_EN 0x8
+
+#endif // WAKE_SIM_SOC_RTC_H
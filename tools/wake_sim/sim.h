@@ -0,0 +1,185 @@
+/**
+ * @file sim.h
+ * @brief Shared state and hardware models of the wake-cycle simulator.
+ *
+ * Every simulated wake runs the real setup() in a forked child, so all
+ * ordinary globals start from scratch as after a reset. What survives
+ * deep sleep on the collar lives here instead, in memory shared with the
+ * parent: the virtual clock, the state of the GPS module and the radio
+ * (they stay powered while the ESP32 sleeps), NVS, the energy totals and
+ * the image of RTC memory.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#ifndef WAKE_SIM_SIM_H
+#define WAKE_SIM_SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <esp_sleep.h>
+#include "../../lib/energy_model/energy_model.h"
+
+// ============================================
+// CONFIGURATION
+// ============================================
+
+// Pins as wired in src/main.cpp
+constexpr uint8_t SIM_RADIO_CS_PIN = 9;
+constexpr uint8_t SIM_RADIO_DIO0_PIN = 17;
+
+// Beeper full volume is a 50% duty cycle (10-bit LEDC), as in src/main.cpp
+constexpr uint32_t SIM_BEEPER_FULL_DUTY = 512;
+constexpr uint32_t SIM_VIBRATION_FULL_DUTY = 1023;
+
+/**
+ * @brief Timing and hardware options (read-only once the run starts).
+ */
+struct SimConfig {
+    EnergyModelConfig energy;
+    uint32_t bootMs;            ///< ROM, bootloader and app start before setup()
+    uint32_t wakeStubUs;        ///< Wake stub run on a skipped wake
+    uint32_t gpsHotStartMs;     ///< Time to fix after standby
+    uint32_t gpsColdStartMs;    ///< Time to fix after power-on or a long standby
+    uint32_t gpsHotStartMaxSec; ///< Standby longer than this needs a cold start
+    bool radioFitted;
+};
+
+constexpr SimConfig DEFAULT_SIM_CONFIG = {
+    DEFAULT_ENERGY_MODEL_CONFIG,
+    150,        // bootMs
+    500,        // wakeStubUs
+    1000,       // gpsHotStartMs
+    35000,      // gpsColdStartMs
+    4 * 3600,   // gpsHotStartMaxSec (ephemeris age)
+    true        // radioFitted
+};
+
+extern SimConfig simConfig;
+
+// ============================================
+// SHARED STATE
+// ============================================
+
+constexpr size_t SIM_GPS_BUFFER = 1024;
+constexpr size_t SIM_NVS_ENTRIES = 64;
+
+struct SimGpsState {
+    bool awake;
+    uint64_t fixAtUs;           ///< First fix once awake
+    uint64_t standbySinceUs;
+    uint64_t searchLeftUs;      ///< Search time still needed when standby began
+    uint32_t intervalMs;        ///< PMTK220 update interval
+    uint64_t nextEpochUs;
+    char out[SIM_GPS_BUFFER];   ///< Bytes waiting to be read by the host
+    size_t outHead;
+    size_t outLength;
+    uint32_t epochs;
+};
+
+struct SimRadioState {
+    uint8_t regs[128];
+    uint8_t fifo[256];
+    bool selected;              ///< Chip select low
+    bool addressed;             ///< Address byte received
+    uint8_t address;
+    bool writing;
+    uint64_t txDoneAtUs;        ///< 0 when not transmitting
+    uint32_t framesSent;
+    uint64_t txUs;
+};
+
+struct SimNvsEntry {
+    char name[32];              ///< "namespace/key", empty when free
+    uint8_t size;
+    uint8_t value[160];     ///< Room for ConfigManager's fence record
+};
+
+struct SimShared {
+    uint64_t nowUs;             ///< Virtual time since power-on
+    uint64_t wakeStartUs;
+    esp_sleep_wakeup_cause_t wakeCause;
+    uint64_t timerWakeupUs;
+    PowerStates power;
+    EnergyTotals energy;
+    SimGpsState gps;
+    SimRadioState radio;
+    SimNvsEntry nvs[SIM_NVS_ENTRIES];
+    uint32_t ledcDuty[2];       ///< Beeper, vibration
+    uint32_t rtcSize;
+    uint8_t rtc[1];             ///< RTC memory image, rtcSize bytes
+};
+
+extern SimShared* sim;
+
+// ============================================
+// CLOCK
+// ============================================
+
+/**
+ * @brief Move the virtual clock forward, charging the energy model and
+ *        applying hardware events (GPS epochs, end of a transmission) on
+ *        the way.
+ */
+void simAdvanceTo(uint64_t timeUs);
+
+/**
+ * @brief The calling task is busy for durationUs (other tasks may run).
+ */
+void simBusyUs(uint64_t durationUs);
+
+/**
+ * @brief Start the task scheduler in a wake; the caller becomes the main task.
+ */
+void simRtosBegin();
+
+// ============================================
+// RTC MEMORY
+// ============================================
+
+size_t simRtcSize();
+void simRtcSave();
+void simRtcRestore();
+
+// ============================================
+// GPS MODULE
+// ============================================
+
+/**
+ * @brief Load an NMEA trace (GGA and RMC sentences).
+ * @param loop Replay from the start once the trace ends.
+ */
+bool simGpsLoadTrace(const char* path, bool loop);
+
+/**
+ * @brief Trace length in microseconds.
+ */
+uint64_t simGpsTraceDurationUs();
+
+void simGpsPowerOn();
+uint64_t simGpsNextEventUs();
+void simGpsUpdate();
+
+/**
+ * @brief Send bytes to the module (PMTK commands).
+ */
+void simGpsWrite(const char* data);
+
+/**
+ * @brief Read one byte from the module.
+ * @return false if nothing is waiting.
+ */
+bool simGpsRead(char& c);
+
+// ============================================
+// RADIO
+// ============================================
+
+void simRadioPowerOn();
+uint64_t simRadioNextEventUs();
+void simRadioUpdate();
+void simRadioSelect(bool selected);
+uint8_t simRadioTransfer(uint8_t value);
+bool simRadioDio0();
+
+#endif // WAKE_SIM_SIM_H
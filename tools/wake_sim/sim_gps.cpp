@@ -0,0 +1,403 @@
+/**
+ * @file sim_gps.cpp
+ * @brief Simulated PA1010D replaying an NMEA trace, and the Adafruit_GPS
+ *        stand-in that reads it.
+ *
+ * The module runs on its own: while awake it emits one GGA and one RMC
+ * sentence per update interval, taken from the trace at the current
+ * virtual time. The first fix takes a cold start after power-on, and a
+ * hot start after standby (cold again once the ephemeris is stale). PMTK
+ * commands are acknowledged like the real module does.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <Arduino.h>
+#include <Adafruit_GPS.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "sim.h"
+#include "../../lib/gps_config/gps_config.h"
+
+// ============================================================================
+// Trace
+// ============================================================================
+
+struct TraceEpoch {
+    uint64_t offsetMs;      ///< Since the first epoch
+    std::string gga;
+    std::string rmc;
+};
+
+// Loaded before the first wake; children only read it
+static std::vector<TraceEpoch> trace;
+static bool traceLoop = false;
+
+// A fix older than this is not repeated (gap in the recording)
+constexpr uint64_t TRACE_MAX_GAP_MS = 2000;
+
+// Cost of reading over I2C: one byte, or an empty poll
+constexpr uint64_t GPS_BYTE_US = 25;
+constexpr uint64_t GPS_IDLE_POLL_US = 1000;
+
+static bool parseTimeOfDay(const char* field, uint64_t& ms) {
+    if (strlen(field) < 6) {
+        return false;
+    }
+    int hh = (field[0] - '0') * 10 + (field[1] - '0');
+    int mm = (field[2] - '0') * 10 + (field[3] - '0');
+    double ss = atof(field + 4);
+    ms = static_cast<uint64_t>(((hh * 60 + mm) * 60 + ss) * 1000.0 + 0.5);
+    return true;
+}
+
+bool simGpsLoadTrace(const char* path, bool loop) {
+    FILE* in = fopen(path, "r");
+    if (in == nullptr) {
+        return false;
+    }
+
+    trace.clear();
+    traceLoop = loop;
+
+    char line[256];
+    uint64_t firstMs = 0;
+    uint64_t previousMs = 0;
+    uint64_t dayOffsetMs = 0;
+
+    while (fgets(line, sizeof(line), in) != nullptr) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] != '$' || strlen(line) < 8) {
+            continue;
+        }
+        bool gga = strncmp(line + 3, "GGA,", 4) == 0;
+        bool rmc = strncmp(line + 3, "RMC,", 4) == 0;
+        uint64_t timeMs;
+        if ((!gga && !rmc) || !parseTimeOfDay(line + 7, timeMs)) {
+            continue;
+        }
+
+        if (trace.empty()) {
+            firstMs = timeMs;
+        } else if (timeMs + 12 * 3600000ULL < previousMs) {
+            dayOffsetMs += 24 * 3600000ULL;
+        }
+        previousMs = timeMs;
+
+        uint64_t offsetMs = dayOffsetMs + timeMs - firstMs;
+        if (trace.empty() || trace.back().offsetMs != offsetMs) {
+            TraceEpoch epoch;
+            epoch.offsetMs = offsetMs;
+            trace.push_back(epoch);
+        }
+        (gga ? trace.back().gga : trace.back().rmc) = line;
+    }
+    fclose(in);
+    return !trace.empty();
+}
+
+uint64_t simGpsTraceDurationUs() {
+    return trace.empty() ? 0 : (trace.back().offsetMs + 1000) * 1000;
+}
+
+static const TraceEpoch* traceAt(uint64_t timeUs) {
+    uint64_t duration = simGpsTraceDurationUs();
+    if (duration == 0 || (!traceLoop && timeUs >= duration)) {
+        return nullptr;
+    }
+    uint64_t offsetMs = (timeUs % duration) / 1000;
+
+    auto it = std::upper_bound(trace.begin(), trace.end(), offsetMs,
+                               [](uint64_t ms, const TraceEpoch& epoch) { return ms < epoch.offsetMs; });
+    if (it == trace.begin()) {
+        return nullptr;
+    }
+    --it;
+    return offsetMs - it->offsetMs <= TRACE_MAX_GAP_MS ? &*it : nullptr;
+}
+
+// ============================================================================
+// Module
+// ============================================================================
+
+static void emit(const char* sentence) {
+    SimGpsState& gps = sim->gps;
+    size_t length = strlen(sentence);
+
+    // Full buffer: the module drops what the host did not read in time
+    if (gps.outHead > 0) {
+        memmove(gps.out, gps.out + gps.outHead, gps.outLength);
+        gps.outHead = 0;
+    }
+    if (gps.outLength + length + 2 > SIM_GPS_BUFFER) {
+        return;
+    }
+    memcpy(gps.out + gps.outLength, sentence, length);
+    memcpy(gps.out + gps.outLength + length, "\r\n", 2);
+    gps.outLength += length + 2;
+}
+
+static void emitBody(const char* body) {
+    char sentence[MAXLINELENGTH];
+    if (pmtkFormat(body, sentence, sizeof(sentence)) > 0) {
+        emit(sentence);
+    }
+}
+
+static void emitEpoch() {
+    const TraceEpoch* epoch = sim->nowUs >= sim->gps.fixAtUs ? traceAt(sim->nowUs) : nullptr;
+    if (epoch != nullptr && (!epoch->gga.empty() || !epoch->rmc.empty())) {
+        if (!epoch->gga.empty()) {
+            emit(epoch->gga.c_str());
+        }
+        if (!epoch->rmc.empty()) {
+            emit(epoch->rmc.c_str());
+        }
+    } else {
+        emitBody("GPGGA,,,,,,0,00,99.99,,,,,,");
+        emitBody("GPRMC,,V,,,,,,,,,,N");
+    }
+    sim->gps.epochs++;
+}
+
+static void updatePower() {
+    const SimGpsState& gps = sim->gps;
+    if (!gps.awake) {
+        sim->power.gps = GpsPower::STANDBY;
+    } else {
+        sim->power.gps = sim->nowUs < gps.fixAtUs ? GpsPower::ACQUIRING : GpsPower::TRACKING;
+    }
+}
+
+static uint64_t nextEpochAfter(uint64_t timeUs) {
+    uint64_t intervalUs = static_cast<uint64_t>(sim->gps.intervalMs) * 1000;
+    return (timeUs / intervalUs + 1) * intervalUs;
+}
+
+void simGpsPowerOn() {
+    SimGpsState& gps = sim->gps;
+    memset(&gps, 0, sizeof(gps));
+    gps.awake = true;
+    gps.intervalMs = 1000;
+    gps.fixAtUs = sim->nowUs + static_cast<uint64_t>(simConfig.gpsColdStartMs) * 1000;
+    gps.nextEpochUs = nextEpochAfter(sim->nowUs);
+    updatePower();
+}
+
+uint64_t simGpsNextEventUs() {
+    const SimGpsState& gps = sim->gps;
+    if (!gps.awake) {
+        return UINT64_MAX;
+    }
+    return gps.fixAtUs > sim->nowUs && gps.fixAtUs < gps.nextEpochUs ? gps.fixAtUs : gps.nextEpochUs;
+}
+
+void simGpsUpdate() {
+    SimGpsState& gps = sim->gps;
+    if (gps.awake && sim->nowUs >= gps.nextEpochUs) {
+        emitEpoch();
+        gps.nextEpochUs = nextEpochAfter(sim->nowUs);
+    }
+    updatePower();
+}
+
+static void wake() {
+    SimGpsState& gps = sim->gps;
+    uint64_t standbyUs = sim->nowUs - gps.standbySinceUs;
+
+    // Standby keeps the module's RAM: a search interrupted by standby
+    // resumes, and a fix is followed by a hot start while the ephemeris
+    // is fresh
+    uint64_t startUs = gps.searchLeftUs;
+    if (startUs == 0) {
+        bool hot = standbyUs <= static_cast<uint64_t>(simConfig.gpsHotStartMaxSec) * 1000000;
+        startUs = static_cast<uint64_t>(hot ? simConfig.gpsHotStartMs : simConfig.gpsColdStartMs) * 1000;
+    }
+
+    gps.awake = true;
+    gps.fixAtUs = sim->nowUs + startUs;
+    gps.nextEpochUs = nextEpochAfter(sim->nowUs);
+    emitBody("PMTK010,002");
+}
+
+void simGpsWrite(const char* data) {
+    SimGpsState& gps = sim->gps;
+
+    bool pmtk = strncmp(data, "$PMTK", 5) == 0;
+    int command = pmtk ? atoi(data + 5) : 0;
+
+    // Any byte wakes the module from standby
+    if (!gps.awake) {
+        if (command == 161) {
+            return;
+        }
+        wake();
+    }
+
+    if (pmtk) {
+        if (command == 161) {
+            gps.awake = false;
+            gps.standbySinceUs = sim->nowUs;
+            gps.searchLeftUs = gps.fixAtUs > sim->nowUs ? gps.fixAtUs - sim->nowUs : 0;
+            gps.outHead = 0;
+            gps.outLength = 0;
+        } else if (command != 10) {
+            if (command == 220) {
+                int intervalMs = atoi(data + 9);
+                if (intervalMs >= 100 && intervalMs <= 10000) {
+                    gps.intervalMs = static_cast<uint32_t>(intervalMs);
+                    gps.nextEpochUs = nextEpochAfter(sim->nowUs);
+                }
+            }
+            char ack[32];
+            snprintf(ack, sizeof(ack), "PMTK001,%d,3", command);
+            emitBody(ack);
+        }
+    }
+    updatePower();
+}
+
+bool simGpsRead(char& c) {
+    SimGpsState& gps = sim->gps;
+    if (gps.outLength == 0) {
+        return false;
+    }
+    c = gps.out[gps.outHead++];
+    gps.outLength--;
+    if (gps.outLength == 0) {
+        gps.outHead = 0;
+    }
+    return true;
+}
+
+// ============================================================================
+// Adafruit_GPS
+// ============================================================================
+
+Adafruit_GPS::Adafruit_GPS(TwoWire* wire)
+    : fix(false)
+    , latitude(0.0f)
+    , longitude(0.0f)
+    , lat('N')
+    , lon('E')
+    , HDOP(0.0f)
+    , satellites(0)
+    , _current(0)
+    , _length(0)
+    , _received(false) {
+    memset(_lines, 0, sizeof(_lines));
+}
+
+bool Adafruit_GPS::begin(uint32_t address) {
+    return true;
+}
+
+void Adafruit_GPS::sendCommand(const char* command) {
+    simBusyUs(GPS_BYTE_US * (strlen(command) + 2));
+    simGpsWrite(command);
+}
+
+char Adafruit_GPS::read() {
+    char c;
+    if (!simGpsRead(c)) {
+        // Nothing buffered: an empty I2C read, or until the next epoch
+        uint64_t next = simGpsNextEventUs();
+        uint64_t waitUs = GPS_IDLE_POLL_US;
+        if (next > sim->nowUs && next - sim->nowUs < waitUs) {
+            waitUs = next - sim->nowUs;
+        }
+        simBusyUs(waitUs);
+        return 0;
+    }
+    simBusyUs(GPS_BYTE_US);
+
+    if (c == '\n') {
+        _lines[_current][_length] = '\0';
+        _current ^= 1;
+        _length = 0;
+        _received = true;
+    } else if (c != '\r' && _length < MAXLINELENGTH - 1) {
+        _lines[_current][_length++] = c;
+    }
+    return c;
+}
+
+bool Adafruit_GPS::newNMEAreceived() {
+    return _received;
+}
+
+char* Adafruit_GPS::lastNMEA() {
+    _received = false;
+    return _lines[_current ^ 1];
+}
+
+static bool checksumValid(const char* nmea) {
+    const char* star = strchr(nmea, '*');
+    if (nmea[0] != '$' || star == nullptr || strlen(star) < 3) {
+        return false;
+    }
+    uint8_t sum = 0;
+    for (const char* p = nmea + 1; p < star; p++) {
+        sum ^= static_cast<uint8_t>(*p);
+    }
+    return sum == static_cast<uint8_t>(strtoul(star + 1, nullptr, 16));
+}
+
+/**
+ * Split a copy of the sentence at commas; empty fields stay empty
+ */
+static size_t splitFields(const char* nmea, char* copy, size_t copySize, char** fields, size_t maxFields) {
+    strncpy(copy, nmea, copySize - 1);
+    copy[copySize - 1] = '\0';
+    char* star = strchr(copy, '*');
+    if (star != nullptr) {
+        *star = '\0';
+    }
+
+    size_t count = 0;
+    char* p = copy;
+    while (count < maxFields) {
+        fields[count++] = p;
+        p = strchr(p, ',');
+        if (p == nullptr) {
+            break;
+        }
+        *p++ = '\0';
+    }
+    return count;
+}
+
+bool Adafruit_GPS::parse(char* nmea) {
+    if (nmea == nullptr || !checksumValid(nmea) || strlen(nmea) < 7) {
+        return false;
+    }
+
+    char copy[MAXLINELENGTH];
+    char* fields[20];
+    size_t count = splitFields(nmea, copy, sizeof(copy), fields, 20);
+
+    if (strncmp(nmea + 3, "GGA,", 4) == 0 && count >= 9) {
+        fix = atoi(fields[6]) > 0;
+        if (fix) {
+            latitude = static_cast<float>(atof(fields[2]));
+            lat = fields[3][0];
+            longitude = static_cast<float>(atof(fields[4]));
+            lon = fields[5][0];
+        }
+        satellites = static_cast<uint8_t>(atoi(fields[7]));
+        HDOP = static_cast<float>(atof(fields[8]));
+        return true;
+    }
+    if (strncmp(nmea + 3, "RMC,", 4) == 0 && count >= 7) {
+        fix = fields[2][0] == 'A';
+        if (fix) {
+            latitude = static_cast<float>(atof(fields[3]));
+            lat = fields[4][0];
+            longitude = static_cast<float>(atof(fields[5]));
+            lon = fields[6][0];
+        }
+        return true;
+    }
+    return false;
+}
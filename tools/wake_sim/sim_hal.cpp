@@ -0,0 +1,340 @@
+/**
+ * @file sim_hal.cpp
+ * @brief Virtual clock, sleep, GPIO, LEDC, NVS and RTC memory of the
+ *        wake-cycle simulator.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <SPI.h>
+#include <WiFi.h>
+#include <Wire.h>
+#include <driver/gpio.h>
+#include <driver/ledc.h>
+#include <esp_sleep.h>
+#include <unistd.h>
+#include "sim.h"
+
+// Undo the Arduino.h redirect: the real one is not needed here
+#undef gettimeofday
+
+SimConfig simConfig = DEFAULT_SIM_CONFIG;
+SimShared* sim = nullptr;
+
+TwoWire Wire;
+TwoWire Wire1;
+SPIClass SPI;
+WiFiClass WiFi;
+
+// Linker-generated bounds of the RTC_DATA_ATTR section
+extern "C" uint8_t __start_rtc_sim[];
+extern "C" uint8_t __stop_rtc_sim[];
+
+// ============================================================================
+// Clock
+// ============================================================================
+
+void simAdvanceTo(uint64_t timeUs) {
+    simGpsUpdate();
+    simRadioUpdate();
+
+    while (sim->nowUs < timeUs) {
+        uint64_t next = timeUs;
+        uint64_t gpsEvent = simGpsNextEventUs();
+        uint64_t radioEvent = simRadioNextEventUs();
+        if (gpsEvent > sim->nowUs && gpsEvent < next) {
+            next = gpsEvent;
+        }
+        if (radioEvent > sim->nowUs && radioEvent < next) {
+            next = radioEvent;
+        }
+
+        energyAccumulate(sim->energy, simConfig.energy, sim->power, next - sim->nowUs);
+        sim->nowUs = next;
+
+        simGpsUpdate();
+        simRadioUpdate();
+    }
+}
+
+unsigned long millis() {
+    return sim != nullptr ? static_cast<unsigned long>((sim->nowUs - sim->wakeStartUs) / 1000) : 0;
+}
+
+unsigned long micros() {
+    return sim != nullptr ? static_cast<unsigned long>(sim->nowUs - sim->wakeStartUs) : 0;
+}
+
+void delay(uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    simBusyUs(us);
+}
+
+int simGettimeofday(struct timeval* tv, void* tz) {
+    (void)tz;
+    uint64_t now = sim != nullptr ? sim->nowUs : 0;
+    tv->tv_sec = static_cast<time_t>(now / 1000000);
+    tv->tv_usec = static_cast<suseconds_t>(now % 1000000);
+    return 0;
+}
+
+// ============================================================================
+// GPIO
+// ============================================================================
+
+void pinMode(uint8_t pin, uint8_t mode) {
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin == SIM_RADIO_CS_PIN) {
+        simRadioSelect(value == LOW);
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin == SIM_RADIO_DIO0_PIN) {
+        return simRadioDio0() ? HIGH : LOW;
+    }
+    return LOW;
+}
+
+// The DIO0 level is polled as well, so the edge interrupt is not needed
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+}
+
+void detachInterrupt(uint8_t pin) {
+}
+
+esp_err_t gpio_sleep_sel_dis(gpio_num_t gpio) {
+    return ESP_OK;
+}
+
+bool btStop() {
+    return true;
+}
+
+uint8_t SPIClass::transfer(uint8_t value) {
+    return simRadioTransfer(value);
+}
+
+// ============================================================================
+// LEDC
+// ============================================================================
+
+static uint32_t ledcPendingDuty[2];
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t* config) {
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t* config) {
+    if (config->channel < 2) {
+        ledcPendingDuty[config->channel] = config->duty;
+        return ledc_update_duty(config->speed_mode, config->channel);
+    }
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_freq(ledc_mode_t mode, ledc_timer_t timer, uint32_t freqHz) {
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t channel, uint32_t duty) {
+    if (channel < 2) {
+        ledcPendingDuty[channel] = duty;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t channel) {
+    if (channel >= 2) {
+        return ESP_OK;
+    }
+    sim->ledcDuty[channel] = ledcPendingDuty[channel];
+
+    uint32_t beeper = sim->ledcDuty[0] * 100 / SIM_BEEPER_FULL_DUTY;
+    uint32_t vibration = sim->ledcDuty[1] * 100 / SIM_VIBRATION_FULL_DUTY;
+    sim->power.beeperPercent = static_cast<uint8_t>(beeper > 100 ? 100 : beeper);
+    sim->power.vibrationPercent = static_cast<uint8_t>(vibration > 100 ? 100 : vibration);
+    return ESP_OK;
+}
+
+// ============================================================================
+// Sleep
+// ============================================================================
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+    return sim->wakeCause;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs) {
+    sim->timerWakeupUs = timeUs;
+    return ESP_OK;
+}
+
+// No IMU on the simulated bus, so motion never wakes the collar
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t gpio, int level) {
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_pd_config(esp_sleep_pd_domain_t domain, esp_sleep_pd_option_t option) {
+    return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start() {
+    sim->power.soc = SocPower::LIGHT_SLEEP;
+    simAdvanceTo(sim->nowUs + sim->timerWakeupUs);
+    sim->power.soc = SocPower::ACTIVE;
+    return ESP_OK;
+}
+
+void esp_deep_sleep_start() {
+    simRtcSave();
+    fflush(nullptr);
+    _exit(0);
+}
+
+void esp_default_wake_deep_sleep(void) {
+}
+
+// ============================================================================
+// RTC Memory
+// ============================================================================
+
+size_t simRtcSize() {
+    return static_cast<size_t>(__stop_rtc_sim - __start_rtc_sim);
+}
+
+void simRtcSave() {
+    memcpy(sim->rtc, __start_rtc_sim, sim->rtcSize);
+}
+
+void simRtcRestore() {
+    memcpy(__start_rtc_sim, sim->rtc, sim->rtcSize);
+}
+
+// ============================================================================
+// Preferences (NVS)
+// ============================================================================
+
+Preferences::Preferences()
+    : _open(false) {
+    _namespace[0] = '\0';
+}
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    if (name == nullptr || strlen(name) >= sizeof(_namespace)) {
+        return false;
+    }
+    strcpy(_namespace, name);
+    _open = true;
+    return true;
+}
+
+void Preferences::end() {
+    _open = false;
+}
+
+static SimNvsEntry* nvsFind(const char* ns, const char* key, bool create) {
+    char name[sizeof(SimNvsEntry::name)];
+    if (snprintf(name, sizeof(name), "%s/%s", ns, key) >= static_cast<int>(sizeof(name))) {
+        return nullptr;
+    }
+
+    SimNvsEntry* free = nullptr;
+    for (size_t i = 0; i < SIM_NVS_ENTRIES; i++) {
+        if (strcmp(sim->nvs[i].name, name) == 0) {
+            return &sim->nvs[i];
+        }
+        if (free == nullptr && sim->nvs[i].name[0] == '\0') {
+            free = &sim->nvs[i];
+        }
+    }
+    if (create && free != nullptr) {
+        strcpy(free->name, name);
+        return free;
+    }
+    return nullptr;
+}
+
+bool Preferences::isKey(const char* key) {
+    return _open && nvsFind(_namespace, key, false) != nullptr;
+}
+
+bool Preferences::clear() {
+    size_t prefix = strlen(_namespace);
+    for (size_t i = 0; i < SIM_NVS_ENTRIES; i++) {
+        if (strncmp(sim->nvs[i].name, _namespace, prefix) == 0 && sim->nvs[i].name[prefix] == '/') {
+            memset(&sim->nvs[i], 0, sizeof(sim->nvs[i]));
+        }
+    }
+    return _open;
+}
+
+bool Preferences::get(const char* key, void* value, size_t size) {
+    SimNvsEntry* entry = _open ? nvsFind(_namespace, key, false) : nullptr;
+    if (entry == nullptr || entry->size != size) {
+        return false;
+    }
+    memcpy(value, entry->value, size);
+    return true;
+}
+
+size_t Preferences::put(const char* key, const void* value, size_t size) {
+    SimNvsEntry* entry = _open ? nvsFind(_namespace, key, true) : nullptr;
+    if (entry == nullptr || size > sizeof(entry->value)) {
+        return 0;
+    }
+    memcpy(entry->value, value, size);
+    entry->size = static_cast<uint8_t>(size);
+    return size;
+}
+
+float Preferences::getFloat(const char* key, float defaultValue) {
+    float value;
+    return get(key, &value, sizeof(value)) ? value : defaultValue;
+}
+
+uint8_t Preferences::getUChar(const char* key, uint8_t defaultValue) {
+    uint8_t value;
+    return get(key, &value, sizeof(value)) ? value : defaultValue;
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+    uint32_t value;
+    return get(key, &value, sizeof(value)) ? value : defaultValue;
+}
+
+size_t Preferences::putFloat(const char* key, float value) {
+    return put(key, &value, sizeof(value));
+}
+
+size_t Preferences::putUChar(const char* key, uint8_t value) {
+    return put(key, &value, sizeof(value));
+}
+
+size_t Preferences::putUInt(const char* key, uint32_t value) {
+    return put(key, &value, sizeof(value));
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    return put(key, value, len);
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    SimNvsEntry* entry = _open ? nvsFind(_namespace, key, false) : nullptr;
+    return entry != nullptr ? entry->size : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    size_t size = getBytesLength(key);
+    if (size == 0 || size > maxLen) {
+        return 0;
+    }
+    return get(key, buf, size) ? size : 0;
+}
@@ -0,0 +1,190 @@
+/**
+ * @file sim_radio.cpp
+ * @brief Simulated RFM95W (SX1276) at the SPI register level.
+ *
+ * Enough of the chip for the rfm95 driver: the register file, the FIFO,
+ * operating modes and TX_DONE after the LoRa airtime of the frame, which
+ * also raises DIO0. Nothing is ever received (no base station).
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <Arduino.h>
+#include "sim.h"
+#include "../../lib/radio/radio.h"
+
+// ============================================================================
+// Registers (LoRa mode subset, as in lib/rfm95)
+// ============================================================================
+
+constexpr uint8_t REG_FIFO = 0x00;
+constexpr uint8_t REG_OP_MODE = 0x01;
+constexpr uint8_t REG_FIFO_ADDR_PTR = 0x0D;
+constexpr uint8_t REG_IRQ_FLAGS = 0x12;
+constexpr uint8_t REG_MODEM_CONFIG_1 = 0x1D;
+constexpr uint8_t REG_MODEM_CONFIG_2 = 0x1E;
+constexpr uint8_t REG_PREAMBLE_MSB = 0x20;
+constexpr uint8_t REG_PREAMBLE_LSB = 0x21;
+constexpr uint8_t REG_PAYLOAD_LENGTH = 0x22;
+constexpr uint8_t REG_DIO_MAPPING_1 = 0x40;
+constexpr uint8_t REG_VERSION = 0x42;
+
+constexpr uint8_t MODE_MASK = 0x07;
+constexpr uint8_t MODE_SLEEP = 0x00;
+constexpr uint8_t MODE_STDBY = 0x01;
+constexpr uint8_t MODE_TX = 0x03;
+constexpr uint8_t MODE_RX_CONTINUOUS = 0x05;
+constexpr uint8_t MODE_RX_SINGLE = 0x06;
+
+constexpr uint8_t IRQ_RX_DONE = 0x40;
+constexpr uint8_t IRQ_TX_DONE = 0x08;
+
+// ============================================================================
+// Model
+// ============================================================================
+
+static void updatePower() {
+    switch (sim->radio.regs[REG_OP_MODE] & MODE_MASK) {
+        case MODE_SLEEP:
+            sim->power.radio = RadioPower::SLEEP;
+            break;
+        case MODE_TX:
+            sim->power.radio = RadioPower::TX;
+            break;
+        case MODE_RX_CONTINUOUS:
+        case MODE_RX_SINGLE:
+            sim->power.radio = RadioPower::RX;
+            break;
+        default:
+            sim->power.radio = RadioPower::STANDBY;
+            break;
+    }
+}
+
+static uint32_t frameAirtimeUs() {
+    const uint8_t* regs = sim->radio.regs;
+    static const uint16_t BANDWIDTHS_KHZ[] = {125, 250, 500};
+    uint8_t bandwidth = regs[REG_MODEM_CONFIG_1] >> 4;
+
+    LoraModemConfig modem;
+    modem.spreadingFactor = regs[REG_MODEM_CONFIG_2] >> 4;
+    modem.bandwidthKhz = bandwidth >= 7 && bandwidth <= 9 ? BANDWIDTHS_KHZ[bandwidth - 7] : 125;
+    modem.codingRate = static_cast<uint8_t>(((regs[REG_MODEM_CONFIG_1] >> 1) & 0x07) + 4);
+    modem.preambleLength = static_cast<uint16_t>(regs[REG_PREAMBLE_MSB] << 8 | regs[REG_PREAMBLE_LSB]);
+    modem.crc = (regs[REG_MODEM_CONFIG_2] & 0x04) != 0;
+    return loraAirtimeUs(modem, regs[REG_PAYLOAD_LENGTH]);
+}
+
+static void setMode(uint8_t value) {
+    SimRadioState& radio = sim->radio;
+    radio.regs[REG_OP_MODE] = value;
+    radio.txDoneAtUs = 0;
+
+    if ((value & MODE_MASK) == MODE_TX) {
+        radio.txDoneAtUs = sim->nowUs + frameAirtimeUs();
+    }
+    updatePower();
+}
+
+void simRadioPowerOn() {
+    SimRadioState& radio = sim->radio;
+    memset(&radio, 0, sizeof(radio));
+
+    // Reset values of the registers the driver relies on
+    radio.regs[REG_OP_MODE] = MODE_STDBY;
+    radio.regs[REG_MODEM_CONFIG_1] = 0x72;
+    radio.regs[REG_MODEM_CONFIG_2] = 0x70;
+    radio.regs[REG_PREAMBLE_LSB] = 0x08;
+    radio.regs[REG_PAYLOAD_LENGTH] = 0x01;
+    radio.regs[REG_VERSION] = 0x12;
+    updatePower();
+
+    // Not fitted: nothing draws current (sleep is the closest state)
+    if (!simConfig.radioFitted) {
+        sim->power.radio = RadioPower::SLEEP;
+    }
+}
+
+uint64_t simRadioNextEventUs() {
+    return sim->radio.txDoneAtUs != 0 ? sim->radio.txDoneAtUs : UINT64_MAX;
+}
+
+void simRadioUpdate() {
+    SimRadioState& radio = sim->radio;
+    if (radio.txDoneAtUs == 0 || sim->nowUs < radio.txDoneAtUs) {
+        return;
+    }
+
+    radio.txUs += frameAirtimeUs();
+    radio.framesSent++;
+    radio.regs[REG_IRQ_FLAGS] |= IRQ_TX_DONE;
+    setMode(static_cast<uint8_t>((radio.regs[REG_OP_MODE] & ~MODE_MASK) | MODE_STDBY));
+}
+
+void simRadioSelect(bool selected) {
+    sim->radio.selected = selected;
+    sim->radio.addressed = false;
+}
+
+static uint8_t readRegister(uint8_t address) {
+    SimRadioState& radio = sim->radio;
+    if (address == REG_FIFO) {
+        return radio.fifo[radio.regs[REG_FIFO_ADDR_PTR]++];
+    }
+    return radio.regs[address];
+}
+
+static void writeRegister(uint8_t address, uint8_t value) {
+    SimRadioState& radio = sim->radio;
+    switch (address) {
+        case REG_FIFO:
+            radio.fifo[radio.regs[REG_FIFO_ADDR_PTR]++] = value;
+            break;
+        case REG_OP_MODE:
+            setMode(value);
+            break;
+        case REG_IRQ_FLAGS:
+            radio.regs[REG_IRQ_FLAGS] &= static_cast<uint8_t>(~value);
+            break;
+        case REG_VERSION:
+            break;
+        default:
+            radio.regs[address] = value;
+            break;
+    }
+}
+
+uint8_t simRadioTransfer(uint8_t value) {
+    SimRadioState& radio = sim->radio;
+
+    // Not fitted: MISO floats low and the version check fails
+    if (!simConfig.radioFitted || !radio.selected) {
+        return 0;
+    }
+
+    if (!radio.addressed) {
+        radio.addressed = true;
+        radio.address = value & 0x7F;
+        radio.writing = (value & 0x80) != 0;
+        return 0;
+    }
+
+    // Burst access: the address increments, except for the FIFO
+    uint8_t result = 0;
+    if (radio.writing) {
+        writeRegister(radio.address, value);
+    } else {
+        result = readRegister(radio.address);
+    }
+    if (radio.address != REG_FIFO) {
+        radio.address = (radio.address + 1) & 0x7F;
+    }
+    return result;
+}
+
+bool simRadioDio0() {
+    const uint8_t* regs = sim->radio.regs;
+    uint8_t mapping = regs[REG_DIO_MAPPING_1] >> 6;
+    uint8_t flags = regs[REG_IRQ_FLAGS];
+    return mapping == 1 ? (flags & IRQ_TX_DONE) != 0 : (flags & IRQ_RX_DONE) != 0;
+}
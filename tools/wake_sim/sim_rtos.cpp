@@ -0,0 +1,309 @@
+/**
+ * @file sim_rtos.cpp
+ * @brief Lock-step FreeRTOS stand-in for the wake-cycle simulator.
+ *
+ * Each task is a host thread, but only one runs at a time. A task hands
+ * over whenever it waits (delay, notification, semaphore) or is busy for
+ * a while; the next task is the first one, round-robin, that can run at
+ * the current virtual time. When none can, the clock jumps to the
+ * earliest timeout. Busy time is charged without a hand-over when no
+ * other task could run before it ends, which keeps single-task stretches
+ * fast.
+ *
+ * The two cores are not modelled separately: tasks interleave on the one
+ * virtual clock, which is what matters for timing and energy.
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <Arduino.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "sim.h"
+
+// ============================================================================
+// Types
+// ============================================================================
+
+enum class SimWait : uint8_t {
+    NONE,
+    TIME,
+    NOTIFY,
+    SEMAPHORE
+};
+
+struct SimSemaphore {
+    uint32_t count;
+};
+
+struct SimTask {
+    pthread_t thread;
+    TaskFunction_t function;
+    void* param;
+    const char* name;
+    bool finished;
+    SimWait wait;
+    uint64_t wakeAtUs;          ///< Timeout, UINT64_MAX for none
+    uint32_t notifications;
+    SimSemaphore* semaphore;
+};
+
+constexpr size_t SIM_MAX_TASKS = 8;
+constexpr size_t SIM_MAX_SEMAPHORES = 8;
+constexpr uint64_t SIM_FOREVER = UINT64_MAX;
+
+static SimTask simTasks[SIM_MAX_TASKS];
+static size_t simTaskCount = 0;
+static SimTask* simRunning = nullptr;
+static SimSemaphore simSemaphores[SIM_MAX_SEMAPHORES];
+static size_t simSemaphoreCount = 0;
+
+static pthread_mutex_t simLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t simTurn = PTHREAD_COND_INITIALIZER;
+
+// ============================================================================
+// Scheduler
+// ============================================================================
+
+static bool canRun(const SimTask& task) {
+    if (task.finished) {
+        return false;
+    }
+    switch (task.wait) {
+        case SimWait::NONE:
+            return true;
+        case SimWait::NOTIFY:
+            if (task.notifications > 0) {
+                return true;
+            }
+            break;
+        case SimWait::SEMAPHORE:
+            if (task.semaphore->count > 0) {
+                return true;
+            }
+            break;
+        case SimWait::TIME:
+            break;
+    }
+    return task.wakeAtUs <= sim->nowUs;
+}
+
+static uint64_t timeout(TickType_t ticks) {
+    return ticks == portMAX_DELAY ? SIM_FOREVER : sim->nowUs + static_cast<uint64_t>(ticks) * 1000;
+}
+
+/**
+ * Hand over from self (lock held) and return once self runs again.
+ * A finished task returns right away.
+ */
+static void handOver(SimTask* self) {
+    size_t start = static_cast<size_t>(self - simTasks);
+    SimTask* next = nullptr;
+
+    while (next == nullptr) {
+        for (size_t i = 1; i <= simTaskCount; i++) {
+            SimTask& task = simTasks[(start + i) % simTaskCount];
+            if (canRun(task)) {
+                next = &task;
+                break;
+            }
+        }
+        if (next != nullptr) {
+            break;
+        }
+
+        uint64_t earliest = SIM_FOREVER;
+        for (size_t i = 0; i < simTaskCount; i++) {
+            if (!simTasks[i].finished && simTasks[i].wakeAtUs < earliest) {
+                earliest = simTasks[i].wakeAtUs;
+            }
+        }
+        if (earliest == SIM_FOREVER) {
+            fprintf(stderr, "wake_sim: all tasks blocked forever (deadlock)\n");
+            _exit(3);
+        }
+        simAdvanceTo(earliest);
+    }
+
+    simRunning = next;
+    pthread_cond_broadcast(&simTurn);
+    while (!self->finished && simRunning != self) {
+        pthread_cond_wait(&simTurn, &simLock);
+    }
+    self->wait = SimWait::NONE;
+}
+
+static void block(SimTask* self, SimWait wait, uint64_t wakeAtUs) {
+    self->wait = wait;
+    self->wakeAtUs = wakeAtUs;
+    handOver(self);
+}
+
+static void* taskEntry(void* param) {
+    SimTask* self = static_cast<SimTask*>(param);
+
+    pthread_mutex_lock(&simLock);
+    while (simRunning != self) {
+        pthread_cond_wait(&simTurn, &simLock);
+    }
+    pthread_mutex_unlock(&simLock);
+
+    self->function(self->param);
+    vTaskDelete(nullptr);
+    return nullptr;
+}
+
+void simRtosBegin() {
+    memset(simTasks, 0, sizeof(simTasks));
+    simTasks[0].thread = pthread_self();
+    simTasks[0].name = "loopTask";
+    simTasks[0].wakeAtUs = SIM_FOREVER;
+    simTaskCount = 1;
+    simRunning = &simTasks[0];
+    simSemaphoreCount = 0;
+}
+
+void simBusyUs(uint64_t durationUs) {
+    if (simRunning == nullptr) {
+        simAdvanceTo(sim->nowUs + durationUs);
+        return;
+    }
+
+    pthread_mutex_lock(&simLock);
+    uint64_t end = sim->nowUs + durationUs;
+
+    bool othersWaiting = false;
+    for (size_t i = 0; i < simTaskCount && !othersWaiting; i++) {
+        SimTask& task = simTasks[i];
+        othersWaiting = &task != simRunning && (canRun(task) || (!task.finished && task.wakeAtUs < end));
+    }
+
+    if (othersWaiting) {
+        block(simRunning, SimWait::TIME, end);
+    } else {
+        simAdvanceTo(end);
+    }
+    pthread_mutex_unlock(&simLock);
+}
+
+// ============================================================================
+// Tasks
+// ============================================================================
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                   void* param, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+    pthread_mutex_lock(&simLock);
+    if (simRunning == nullptr || simTaskCount >= SIM_MAX_TASKS) {
+        pthread_mutex_unlock(&simLock);
+        return pdFAIL;
+    }
+
+    SimTask* task = &simTasks[simTaskCount++];
+    memset(task, 0, sizeof(*task));
+    task->function = function;
+    task->param = param;
+    task->name = name;
+    task->wakeAtUs = SIM_FOREVER;
+
+    if (pthread_create(&task->thread, nullptr, taskEntry, task) != 0) {
+        simTaskCount--;
+        pthread_mutex_unlock(&simLock);
+        return pdFAIL;
+    }
+    if (handle != nullptr) {
+        *handle = task;
+    }
+    pthread_mutex_unlock(&simLock);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    pthread_mutex_lock(&simLock);
+    SimTask* self = simRunning;
+    if (task != nullptr && task != self) {
+        // Only self-deletion is used by the firmware
+        task->finished = true;
+        pthread_mutex_unlock(&simLock);
+        return;
+    }
+
+    self->finished = true;
+    handOver(self);
+    pthread_mutex_unlock(&simLock);
+    pthread_exit(nullptr);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    simBusyUs(static_cast<uint64_t>(ticks) * 1000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return simRunning;
+}
+
+// ============================================================================
+// Notifications
+// ============================================================================
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&simLock);
+    task->notifications++;
+    pthread_mutex_unlock(&simLock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    pthread_mutex_lock(&simLock);
+    SimTask* self = simRunning;
+    if (self->notifications == 0 && ticks > 0) {
+        block(self, SimWait::NOTIFY, timeout(ticks));
+    }
+
+    uint32_t value = self->notifications;
+    if (value > 0) {
+        self->notifications = clearOnExit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&simLock);
+    return value;
+}
+
+// ============================================================================
+// Semaphores
+// ============================================================================
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    pthread_mutex_lock(&simLock);
+    SimSemaphore* semaphore = nullptr;
+    if (simSemaphoreCount < SIM_MAX_SEMAPHORES) {
+        semaphore = &simSemaphores[simSemaphoreCount++];
+        semaphore->count = 0;
+    }
+    pthread_mutex_unlock(&simLock);
+    return semaphore;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    pthread_mutex_lock(&simLock);
+    BaseType_t given = semaphore->count == 0 ? pdTRUE : pdFALSE;
+    semaphore->count = 1;
+    pthread_mutex_unlock(&simLock);
+    return given;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    pthread_mutex_lock(&simLock);
+    SimTask* self = simRunning;
+    if (semaphore->count == 0 && ticks > 0) {
+        self->semaphore = semaphore;
+        block(self, SimWait::SEMAPHORE, timeout(ticks));
+    }
+
+    BaseType_t taken = pdFALSE;
+    if (semaphore->count > 0) {
+        semaphore->count = 0;
+        taken = pdTRUE;
+    }
+    pthread_mutex_unlock(&simLock);
+    return taken;
+}
@@ -0,0 +1,459 @@
+/**
+ * @file wake_sim.cpp
+ * @brief Host simulation of the collar's wake cycle for energy budgeting.
+ *
+ * Runs the real firmware (src/main.cpp and the libraries) against
+ * simulated hardware on a virtual clock: a GPS module replaying an NMEA
+ * trace, an RFM95W, the beeper and vibration motor, NVS and RTC memory.
+ * Every wake forks a child that runs setup() from a fresh process, like a
+ * reset; deep sleep ends the child and hands RTC memory back. Sleep costs
+ * nothing in real time, so a day of wakes takes seconds.
+ *
+ * Build and run (see tools/wake_sim/README.md):
+ *   g++ -std=c++11 -O2 -pthread -DWAKE_SIM -Itools/wake_sim/fakes -o wake_sim \
+ *       src/main.cpp lib/\*\/\*.cpp tools/wake_sim/\*.cpp
+ *   ./wake_sim --hours 24 tools/wake_sim/traces/sample_walk.nmea
+ *
+ * @copyright Apache 2.0 License
+ */
+
+#include <Arduino.h>
+#include <errno.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "sim.h"
+#include "../../lib/fence_store/fence_store.h"
+#include "../../lib/track_log/track_log.h"
+
+#undef gettimeofday
+
+// Flash partition sizes from partitions.csv
+constexpr size_t TRACK_LOG_PARTITION_SIZE = 0x100000;
+
+// ============================================================================
+// Wake Stub (IDF 5.1+ builds only)
+// ============================================================================
+
+#if __has_include(<esp_wake_stub.h>)
+#include <esp_wake_stub.h>
+#include <soc/rtc.h>
+#define SIM_HAVE_WAKE_STUB
+
+static jmp_buf stubReturn;
+
+uint32_t esp_wake_stub_get_wakeup_cause(void) {
+    return sim->wakeCause == ESP_SLEEP_WAKEUP_TIMER ? RTC_TIMER_TRIG_EN : 0;
+}
+
+void esp_wake_stub_set_wakeup_time(uint64_t timeUs) {
+    sim->timerWakeupUs = timeUs;
+}
+
+void esp_wake_stub_sleep(esp_deep_sleep_wake_stub_fn_t stub) {
+    (void)stub;
+    longjmp(stubReturn, 1);
+}
+
+/**
+ * Run the firmware's wake stub in place of a boot.
+ * @return true if the stub put the chip straight back to sleep.
+ */
+static bool runWakeStub() {
+    simAdvanceTo(sim->nowUs + simConfig.wakeStubUs);
+    if (setjmp(stubReturn) != 0) {
+        return true;
+    }
+    esp_wake_deep_sleep();
+    return false;
+}
+#endif
+
+// ============================================================================
+// Options
+// ============================================================================
+
+struct SimOptions {
+    const char* tracePath;
+    const char* modelPath;
+    const char* fencePath;
+    double hours;               ///< 0: the trace once
+    double batteryMah;          ///< 0: no battery life estimate
+    bool verbose;               ///< One line per wake
+};
+
+static void usage() {
+    fprintf(stderr,
+            "usage: wake_sim [options] trace.nmea\n"
+            "  --hours H          simulate H hours, replaying the trace in a loop\n"
+            "  --model FILE       'name = value' overrides of the current model and timings\n"
+            "  --fence FILE       fence polygon, one 'lat,lon' vertex per line\n"
+            "  --no-radio         no RFM95W fitted\n"
+            "  --battery MAH      estimate battery life for this capacity\n"
+            "  --verbose          print one line per wake\n");
+}
+
+/**
+ * Sim timing keys of a model file (the currents go through energyModelSet)
+ */
+static bool simConfigSet(SimConfig& config, const char* name, double value) {
+    struct Key {
+        const char* name;
+        uint32_t SimConfig::*field;
+    };
+    static const Key KEYS[] = {
+        {"bootMs", &SimConfig::bootMs},
+        {"wakeStubUs", &SimConfig::wakeStubUs},
+        {"gpsHotStartMs", &SimConfig::gpsHotStartMs},
+        {"gpsColdStartMs", &SimConfig::gpsColdStartMs},
+        {"gpsHotStartMaxSec", &SimConfig::gpsHotStartMaxSec},
+    };
+
+    if (value < 0) {
+        return false;
+    }
+    for (const Key& key : KEYS) {
+        if (strcmp(key.name, name) == 0) {
+            config.*key.field = static_cast<uint32_t>(value);
+            return true;
+        }
+    }
+    return false;
+}
+
+static char* trim(char* s) {
+    while (*s == ' ' || *s == '\t') {
+        s++;
+    }
+    char* end = s + strlen(s);
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+        *--end = '\0';
+    }
+    return s;
+}
+
+static bool loadModel(const char* path, SimConfig& config) {
+    FILE* in = fopen(path, "r");
+    if (in == nullptr) {
+        perror(path);
+        return false;
+    }
+
+    char line[256];
+    int lineNumber = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), in) != nullptr) {
+        lineNumber++;
+        char* comment = strchr(line, '#');
+        if (comment != nullptr) {
+            *comment = '\0';
+        }
+        char* text = trim(line);
+        if (*text == '\0') {
+            continue;
+        }
+
+        char* equals = strchr(text, '=');
+        char* end = nullptr;
+        double value = 0;
+        if (equals != nullptr) {
+            *equals = '\0';
+            value = strtod(equals + 1, &end);
+        }
+        char* name = trim(text);
+        if (equals == nullptr || end == equals + 1 || *trim(end) != '\0' ||
+            !(energyModelSet(config.energy, name, static_cast<float>(value)) ||
+              simConfigSet(config, name, value))) {
+            fprintf(stderr, "%s:%d: bad setting\n", path, lineNumber);
+            ok = false;
+        }
+    }
+    fclose(in);
+    return ok;
+}
+
+static bool loadFence(const char* path, std::vector<GeoPoint>& vertices) {
+    FILE* in = fopen(path, "r");
+    if (in == nullptr) {
+        perror(path);
+        return false;
+    }
+
+    char line[128];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), in) != nullptr) {
+        lineNumber++;
+        char* text = trim(line);
+        if (*text == '\0' || *text == '#') {
+            continue;
+        }
+        GeoPoint point;
+        if (sscanf(text, "%f , %f", &point.lat, &point.lon) != 2) {
+            fprintf(stderr, "%s:%d: expected 'lat,lon'\n", path, lineNumber);
+            fclose(in);
+            return false;
+        }
+        vertices.push_back(point);
+    }
+    fclose(in);
+    return true;
+}
+
+static bool parseArgs(int argc, char** argv, SimOptions& options) {
+    memset(&options, 0, sizeof(options));
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(arg, "--hours") == 0 && hasValue) {
+            options.hours = atof(argv[++i]);
+        } else if (strcmp(arg, "--model") == 0 && hasValue) {
+            options.modelPath = argv[++i];
+        } else if (strcmp(arg, "--fence") == 0 && hasValue) {
+            options.fencePath = argv[++i];
+        } else if (strcmp(arg, "--battery") == 0 && hasValue) {
+            options.batteryMah = atof(argv[++i]);
+        } else if (strcmp(arg, "--verbose") == 0) {
+            options.verbose = true;
+        } else if (strcmp(arg, "--no-radio") == 0) {
+            simConfig.radioFitted = false;
+        } else if (arg[0] != '-' && options.tracePath == nullptr) {
+            options.tracePath = arg;
+        } else {
+            return false;
+        }
+    }
+    return options.tracePath != nullptr && options.hours >= 0 && options.batteryMah >= 0;
+}
+
+// ============================================================================
+// Flash
+// ============================================================================
+
+/**
+ * Create the flash partitions in the working directory, as after flashing
+ */
+static bool prepareFlash(const std::vector<GeoPoint>& fence) {
+    TrackLogStorage storage;
+    if (!storage.begin(TRACK_LOG_PARTITION_LABEL, TRACK_LOG_PARTITION_SIZE)) {
+        fprintf(stderr, "wake_sim: cannot create the track log partition\n");
+        return false;
+    }
+    storage.end();
+
+    if (!fence.empty()) {
+        // As flashed from the host: one blob in slot 0
+        std::vector<uint32_t> blob((fenceBlobSize(fence.size()) + 3) / 4);
+        size_t size = fenceBlobEncode(fence.data(), fence.size(), 1,
+                                      reinterpret_cast<uint8_t*>(blob.data()), blob.size() * 4);
+        FILE* file = size != 0 ? fopen(FENCE_STORE_PARTITION_LABEL, "wb") : nullptr;
+        bool ok = file != nullptr && fwrite(blob.data(), 1, size, file) == size;
+        if (file != nullptr) {
+            ok = fclose(file) == 0 && ok;
+        }
+        if (!ok) {
+            fprintf(stderr, "wake_sim: invalid fence\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+static void removeFlash(const char* dir) {
+    unlink(TRACK_LOG_PARTITION_LABEL);
+    unlink(FENCE_STORE_PARTITION_LABEL);
+    if (chdir("/") == 0) {
+        rmdir(dir);
+    }
+}
+
+// ============================================================================
+// Wake Cycle
+// ============================================================================
+
+struct SimCounters {
+    uint32_t wakes;
+    uint32_t booted;
+    uint32_t stubSkipped;
+};
+
+/**
+ * One boot: run setup() in a child until it deep sleeps
+ */
+static bool boot() {
+    simAdvanceTo(sim->nowUs + static_cast<uint64_t>(simConfig.bootMs) * 1000);
+
+    fflush(nullptr);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return false;
+    }
+    if (pid == 0) {
+        // loop() is only a safety net on the collar: reaching it is a bug
+        simRtosBegin();
+        setup();
+        fprintf(stderr, "wake_sim: setup() returned without deep sleep\n");
+        fflush(nullptr);
+        _exit(2);
+    }
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        if (WIFSIGNALED(status)) {
+            fprintf(stderr, "wake_sim: wake at %.3f s died with signal %d\n",
+                    sim->nowUs / 1e6, WTERMSIG(status));
+        } else {
+            fprintf(stderr, "wake_sim: wake at %.3f s exited with status %d\n",
+                    sim->nowUs / 1e6, WEXITSTATUS(status));
+        }
+        return false;
+    }
+
+    simRtcRestore();
+    return true;
+}
+
+static bool run(uint64_t endUs, bool verbose, SimCounters& counters) {
+    while (sim->nowUs < endUs) {
+        sim->wakeStartUs = sim->nowUs;
+        sim->power.soc = SocPower::ACTIVE;
+        counters.wakes++;
+
+        bool skipped = false;
+#ifdef SIM_HAVE_WAKE_STUB
+        if (sim->wakeCause == ESP_SLEEP_WAKEUP_TIMER) {
+            skipped = runWakeStub();
+        }
+#endif
+        if (skipped) {
+            counters.stubSkipped++;
+        } else {
+            if (!boot()) {
+                return false;
+            }
+            counters.booted++;
+        }
+
+        if (verbose) {
+            printf("%10.3f s  %-7s awake %8.1f ms, sleeping %u s\n", sim->wakeStartUs / 1e6,
+                   skipped ? "stub" : "boot", (sim->nowUs - sim->wakeStartUs) / 1e3,
+                   static_cast<unsigned>(sim->timerWakeupUs / 1000000));
+        }
+        if (sim->timerWakeupUs == 0) {
+            fprintf(stderr, "wake_sim: deep sleep without a wakeup timer\n");
+            return false;
+        }
+        sim->power.soc = SocPower::DEEP_SLEEP;
+        simAdvanceTo(sim->nowUs + sim->timerWakeupUs);
+        sim->wakeCause = ESP_SLEEP_WAKEUP_TIMER;
+    }
+    return true;
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+
+static void report(const SimOptions& options, const SimCounters& counters, double wallSec) {
+    const EnergyTotals& totals = sim->energy;
+    double simSec = totals.elapsedUs / 1e6;
+    double activeSec = totals.socUs[static_cast<size_t>(SocPower::ACTIVE)] / 1e6;
+    double lightSec = totals.socUs[static_cast<size_t>(SocPower::LIGHT_SLEEP)] / 1e6;
+
+    printf("Simulated:    %.2f h, %u wakes (%u booted, %u skipped by the wake stub)\n",
+           simSec / 3600, counters.wakes, counters.booted, counters.stubSkipped);
+    printf("Speed:        %.2f s real time, %.0f wakes/s\n",
+           wallSec, wallSec > 0 ? counters.wakes / wallSec : 0.0);
+    printf("Awake:        %.1f s active (%.2f %%), %.1f s light sleep, %.0f ms per wake\n",
+           activeSec, simSec > 0 ? 100 * activeSec / simSec : 0.0, lightSec,
+           counters.wakes > 0 ? 1000 * activeSec / counters.wakes : 0.0);
+    printf("Radio:        %u frames, %.2f s on air\n",
+           sim->radio.framesSent, sim->radio.txUs / 1e6);
+
+    printf("Charge:      ");
+    for (size_t rail = 0; rail < ENERGY_RAIL_COUNT; rail++) {
+        printf(" %s %.3f mAh%s", energyRailName(static_cast<EnergyRail>(rail)),
+               totals.chargeMas[rail] / 3600, rail + 1 < ENERGY_RAIL_COUNT ? "," : "\n");
+    }
+
+    double mahPerDay = energyMahPerDay(totals);
+    printf("Average:      %.3f mA, %.1f mAh/day\n", energyAverageMa(totals), mahPerDay);
+    if (options.batteryMah > 0 && mahPerDay > 0) {
+        printf("Battery:      %.0f mAh lasts %.1f days\n", options.batteryMah,
+               options.batteryMah / mahPerDay);
+    }
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+    SimOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+    if (options.modelPath != nullptr && !loadModel(options.modelPath, simConfig)) {
+        return 1;
+    }
+    std::vector<GeoPoint> fence;
+    if (options.fencePath != nullptr && !loadFence(options.fencePath, fence)) {
+        return 1;
+    }
+    if (!simGpsLoadTrace(options.tracePath, options.hours > 0)) {
+        return 1;
+    }
+
+    // Shared with every wake's child; RTC memory starts as the power-on image
+    size_t rtcSize = simRtcSize();
+    size_t sharedSize = offsetof(SimShared, rtc) + (rtcSize > 0 ? rtcSize : 1);
+    void* shared = mmap(nullptr, sharedSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    sim = static_cast<SimShared*>(shared);
+    sim->rtcSize = static_cast<uint32_t>(rtcSize);
+    simRtcSave();
+
+    char workDir[] = "/tmp/wake_sim.XXXXXX";
+    if (mkdtemp(workDir) == nullptr || chdir(workDir) != 0) {
+        perror("wake_sim: work directory");
+        return 1;
+    }
+    if (!prepareFlash(fence)) {
+        removeFlash(workDir);
+        return 1;
+    }
+
+    sim->wakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+    sim->power.soc = SocPower::ACTIVE;
+    simGpsPowerOn();
+    simRadioPowerOn();
+
+    uint64_t endUs = options.hours > 0 ? static_cast<uint64_t>(options.hours * 3600e6)
+                                       : simGpsTraceDurationUs();
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    SimCounters counters = {};
+    bool ok = run(endUs, options.verbose, counters);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    removeFlash(workDir);
+    if (!ok) {
+        return 1;
+    }
+
+    double wallSec = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    report(options, counters, wallSec);
+    return 0;
+}